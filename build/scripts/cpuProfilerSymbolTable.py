@@ -0,0 +1,178 @@
+#!/usr/bin/python
+
+#============================================================================
+#
+# cpuProfilerSymbolTable main script
+#
+# GENERAL DESCRIPTION
+#    Writes the CPU profiler symbol table into an application ELF.
+#
+#    The application reserves g_cpu_profiler_symbol_table in read-only data
+#    (see quartz/demo/QCLI_demo/src/cpu_profiler/cpu_profiler_symbols.h).
+#    After linking, this script collects the functions of the ELF and of the
+#    ROM symbol files, sorts them by address and writes the table over the
+#    reserved space, so the profiler can name samples without a PC tool.
+#
+#    Table layout, little endian:
+#       header      magic, symbols_count, table_size, reserved
+#       symbols     symbols_count x (address, size, name_offset)
+#       names       NUL terminated strings, name_offset counts from the header
+#
+# Copyright (c) 2018 by Qualcomm Technologies Incorporated.
+# All Rights Reserved.
+# QUALCOMM Proprietary/GTDR
+#================================================================================
+
+import elfManipulator.include.elfFileClass as elfFileClass
+import elfManipulator.include.elfConstants as const
+import optparse
+import re
+import struct
+from os.path import exists as pe
+
+TABLE_SYMBOL = 'g_cpu_profiler_symbol_table'
+TABLE_MAGIC = 0x4d595350
+TABLE_EMPTY_MAGIC = 0x59544d45
+
+HEADER_FORMAT = '<IIII'
+SYMBOL_FORMAT = '<III'
+
+# ROM symbol files list one "name = 0xaddress;" per line
+SYM_FILE_LINE = re.compile(r'^\s*(\S+)\s*=\s*(0x[0-9a-fA-F]+)\s*;')
+
+
+#----------------------------------------------------------------------------
+# Returns (address, size, name) of every function defined in the ELF
+#----------------------------------------------------------------------------
+def getElfFunctions(elfObject):
+   symtab = elfObject.getSectionByName(".symtab")
+   strtab = elfObject.getSectionByName(".strtab")
+   if symtab == const.RC_ERROR or strtab == const.RC_ERROR:
+      print "cpuProfilerSymbolTable: Missing .symtab and/or .strtab section"
+      exit(1)
+
+   functions = []
+   for symbol in elfFileClass.Elf32_SymGenerator(symtab, strtab):
+      if ((symbol.st_info & 0xf) == const.symbolTypes.STT_FUNC and
+          symbol.st_shndx != const.specialSectionsIndexes.SHN_UNDEF and
+          symbol.st_value != 0 and symbol.st_nameStr):
+         functions.append((symbol.st_value & ~1, symbol.st_size, symbol.st_nameStr))
+   return functions
+
+
+#----------------------------------------------------------------------------
+# Returns (address, 0, name) of every symbol listed in a ROM symbol file, the
+# sizes are filled in from the next symbol when the table is built
+#----------------------------------------------------------------------------
+def getSymFileFunctions(symFile):
+   functions = []
+   with open(symFile, 'r') as f:
+      for line in f:
+         match = SYM_FILE_LINE.match(line)
+         if match and int(match.group(2), 16) != 0:
+            functions.append((int(match.group(2), 16) & ~1, 0, match.group(1)))
+   return functions
+
+
+#----------------------------------------------------------------------------
+# Builds the table. Aliases of an address keep the first name given, sizes
+# that are not known run up to the next function.
+#----------------------------------------------------------------------------
+def buildTable(functions):
+   byAddress = {}
+   for address, size, name in functions:
+      if address not in byAddress:
+         byAddress[address] = [address, size, name]
+      elif byAddress[address][1] == 0:
+         byAddress[address][1] = size
+
+   symbols = sorted(byAddress.values())
+   for i in range(len(symbols) - 1):
+      if symbols[i][1] == 0 or symbols[i][0] + symbols[i][1] > symbols[i + 1][0]:
+         symbols[i][1] = symbols[i + 1][0] - symbols[i][0]
+
+   namesOffset = struct.calcsize(HEADER_FORMAT) + len(symbols) * struct.calcsize(SYMBOL_FORMAT)
+   names = ''
+   nameOffsets = {}
+   entries = ''
+   for address, size, name in symbols:
+      if name not in nameOffsets:
+         nameOffsets[name] = namesOffset + len(names)
+         names += name + '\0'
+      entries += struct.pack(SYMBOL_FORMAT, address, size, nameOffsets[name])
+
+   tableSize = namesOffset + len(names)
+   header = struct.pack(HEADER_FORMAT, TABLE_MAGIC, len(symbols), tableSize, 0)
+   return header + entries + names, len(symbols)
+
+
+#----------------------------------------------------------------------------
+# Overwrites the reserved table in the loadable section holding it
+#----------------------------------------------------------------------------
+def writeTable(elfObject, tableSymbol, table):
+   for section in elfObject.sectionHeaderTable:
+      if (section.sh_type != const.sectionTypes.SHT_NOBITS and
+          (section.sh_flags & const.sectionFlags.SHF_ALLOC) and
+          section.sh_addr <= tableSymbol.st_value < section.sh_addr + section.sh_size):
+         offset = tableSymbol.st_value - section.sh_addr
+         magic = struct.unpack('<I', section.contents[offset:offset + 4])[0]
+         if magic != TABLE_EMPTY_MAGIC and magic != TABLE_MAGIC:
+            print "cpuProfilerSymbolTable: " + TABLE_SYMBOL + " does not hold a symbol table"
+            exit(1)
+         section.contents = "".join([section.contents[:offset],
+                                     table,
+                                     section.contents[offset + len(table):]])
+         return
+   print "cpuProfilerSymbolTable: " + TABLE_SYMBOL + " is not in a loadable section"
+   exit(1)
+
+
+def cpu_profiler_symbol_table_modify_elf(targetElf, sourceElf, symFiles):
+   sourceElfObject = elfFileClass.elfFile(sourceElf)
+
+   tableSymbol = sourceElfObject.getSymbolByName(TABLE_SYMBOL)
+   if tableSymbol == const.RC_ERROR:
+      print "cpuProfilerSymbolTable: " + TABLE_SYMBOL + " not found, is the CPU profiler built in?"
+      exit(1)
+
+   elfFunctions = getElfFunctions(sourceElfObject)
+   romFunctions = []
+   for symFile in symFiles:
+      romFunctions += getSymFileFunctions(symFile)
+
+   # the application functions come first, the ROM ones are left out when
+   # they do not fit in the space reserved by the build
+   table, count = buildTable(elfFunctions + romFunctions)
+   if len(table) > tableSymbol.st_size and romFunctions:
+      print "cpuProfilerSymbolTable: %d bytes needed with ROM functions, %d reserved, leaving them out" % (len(table), tableSymbol.st_size)
+      table, count = buildTable(elfFunctions)
+   if len(table) > tableSymbol.st_size:
+      print "cpuProfilerSymbolTable: %d bytes needed, %d reserved, increase CPU_PROFILER_SYMBOL_TABLE_SIZE" % (len(table), tableSymbol.st_size)
+      exit(1)
+
+   writeTable(sourceElfObject, tableSymbol, table)
+   print "cpuProfilerSymbolTable: %d functions, %d of %d bytes" % (count, len(table), tableSymbol.st_size)
+
+   sourceElfObject.writeOutELF(targetElf)
+
+
+def main():
+   use = "Usage: python %prog <Output ELF> <Input ELF> [<ROM symbol file> ...]"
+   parser = optparse.OptionParser(usage = use, version="%prog 1.0")
+   options, arguments = parser.parse_args()
+
+   if len(arguments) < 2:
+      parser.error("Unexpected argument length")
+      exit(1)
+
+   for f in arguments[1:]:
+      if not pe(f):
+         parser.error("Specified file " + f + " does not exist.")
+         exit(1)
+
+   cpu_profiler_symbol_table_modify_elf(arguments[0], arguments[1], arguments[2:])
+   exit(0)
+
+#Needed so the main() will execute if run from a python debugger and not when it is imported
+if __name__ == "__main__":
+    main()
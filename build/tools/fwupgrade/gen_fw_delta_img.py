@@ -0,0 +1,209 @@
+#!/usr/bin/python
+'''
+ Copyright (c) 2018
+ Qualcomm Technologies Incorporated.
+ All Rights Reserved.
+ Qualcomm Confidential and Proprietary
+
+This script generates a delta image that rebuilds a new firmware image from
+the image currently running on the device.
+
+A delta image is a header followed by a list of commands:
+
+Delta Header
+Little endian         <
+uint32 magic          I     'FDLT'
+uint32 source_length  I     length of the image the delta applies to
+uint32 target_length  I     length of the rebuilt image
+uint8  source_hash    B*32  SHA256 of the source image
+
+Delta Command
+Little endian         <
+uint8  op             B     0: END, 1: COPY, 2: INSERT, 3: FILL
+uint32 offset         I     COPY: source offset, FILL: byte value
+uint32 length         I     number of target bytes produced
+
+INSERT commands are followed by length literal bytes.
+
+The device applies the commands in order and writes the target image
+sequentially, so the source is never overwritten while it is being read.
+'''
+
+import struct
+import hashlib
+import logging
+import sys
+
+DELTA_MAGIC = 0x544C4446
+
+DELTA_OP_END = 0
+DELTA_OP_COPY = 1
+DELTA_OP_INSERT = 2
+DELTA_OP_FILL = 3
+
+DELTA_HDR_FORMAT = '<III32s'
+DELTA_CMD_FORMAT = '<BII'
+
+# source blocks are indexed at this granularity, shorter matches are sent as literals
+DELTA_BLOCK_SIZE = 32
+
+# shortest run of one byte value worth a FILL command
+DELTA_MIN_FILL = 16
+
+class Fw_Upgrade_Delta_Encoder:
+    ''' Greedy block matching encoder, every DELTA_BLOCK_SIZE aligned source
+    block is indexed and matches are extended in both directions '''
+
+    def __init__ (self, source, target):
+        self.source = bytes(source)
+        self.target = bytes(target)
+        self.cmds = bytearray()
+        self.copy_bytes = 0
+        self.insert_bytes = 0
+        self.fill_bytes = 0
+
+    def build_index (self):
+        index = {}
+        src = self.source
+        for off in range(0, len(src) - DELTA_BLOCK_SIZE + 1, DELTA_BLOCK_SIZE):
+            key = src[off:off + DELTA_BLOCK_SIZE]
+            if key not in index:
+                index[key] = off
+        return index
+
+    def emit (self, op, offset, length, data=b''):
+        self.cmds += struct.pack(DELTA_CMD_FORMAT, op, offset, length)
+        self.cmds += data
+
+    def emit_literal (self, start, end):
+        ''' Send target[start:end] as INSERT commands, long runs of one
+        byte value become FILL commands '''
+        tgt = self.target
+        lit = start
+        pos = start
+        while pos < end:
+            run = pos + 1
+            while run < end and tgt[run:run + 1] == tgt[pos:pos + 1]:
+                run += 1
+            if run - pos >= DELTA_MIN_FILL:
+                if pos > lit:
+                    self.emit(DELTA_OP_INSERT, 0, pos - lit, tgt[lit:pos])
+                    self.insert_bytes += pos - lit
+                self.emit(DELTA_OP_FILL, bytearray(tgt[pos:pos + 1])[0], run - pos)
+                self.fill_bytes += run - pos
+                lit = run
+            pos = run
+        if end > lit:
+            self.emit(DELTA_OP_INSERT, 0, end - lit, tgt[lit:end])
+            self.insert_bytes += end - lit
+
+    def encode (self):
+        src = self.source
+        tgt = self.target
+        index = self.build_index()
+
+        lit = 0
+        pos = 0
+        while pos + DELTA_BLOCK_SIZE <= len(tgt):
+            off = index.get(tgt[pos:pos + DELTA_BLOCK_SIZE])
+            if off is None:
+                pos += 1
+                continue
+
+            # extend the match forwards
+            length = DELTA_BLOCK_SIZE
+            while (pos + length < len(tgt)) and (off + length < len(src)) and (tgt[pos + length] == src[off + length]):
+                length += 1
+
+            # and backwards into the pending literal bytes
+            while (pos > lit) and (off > 0) and (tgt[pos - 1] == src[off - 1]):
+                pos -= 1
+                off -= 1
+                length += 1
+
+            self.emit_literal(lit, pos)
+            self.emit(DELTA_OP_COPY, off, length)
+            self.copy_bytes += length
+            pos += length
+            lit = pos
+
+        self.emit_literal(lit, len(tgt))
+        self.emit(DELTA_OP_END, 0, 0)
+
+        hdr = struct.pack(DELTA_HDR_FORMAT, DELTA_MAGIC, len(src), len(tgt), hashlib.sha256(src).digest())
+        return bytearray(hdr) + self.cmds
+
+def apply_delta (source, delta):
+    ''' Rebuild the target from source and delta the way the device does,
+    used to check a generated delta before it is shipped '''
+    source = bytes(source)
+    delta = bytes(delta)
+    hdr_size = struct.calcsize(DELTA_HDR_FORMAT)
+    cmd_size = struct.calcsize(DELTA_CMD_FORMAT)
+
+    magic, source_length, target_length, source_hash = struct.unpack(DELTA_HDR_FORMAT, delta[:hdr_size])
+    if magic != DELTA_MAGIC or source_length != len(source) or hashlib.sha256(source).digest() != source_hash:
+        raise AssertionError('delta does not apply to this source image')
+
+    target = bytearray()
+    pos = hdr_size
+    while True:
+        op, offset, length = struct.unpack(DELTA_CMD_FORMAT, delta[pos:pos + cmd_size])
+        pos += cmd_size
+        if op == DELTA_OP_END:
+            break
+        elif op == DELTA_OP_COPY:
+            target += source[offset:offset + length]
+        elif op == DELTA_OP_INSERT:
+            target += delta[pos:pos + length]
+            pos += length
+        elif op == DELTA_OP_FILL:
+            target += bytearray([offset & 0xFF] * length)
+        else:
+            raise AssertionError('unknown delta command %d' % op)
+
+    if pos != len(delta) or len(target) != target_length:
+        raise AssertionError('delta length is not correct')
+    return target
+
+def gen_delta (source, target):
+    ''' Generate a delta from source to target and check it rebuilds target '''
+    encoder = Fw_Upgrade_Delta_Encoder(source, target)
+    delta = encoder.encode()
+    if apply_delta(source, delta) != bytearray(target):
+        raise AssertionError('generated delta does not rebuild the target image')
+
+    logging.info('delta %d bytes for %d byte image: copy %d, insert %d, fill %d' %
+                 (len(delta), len(target), encoder.copy_bytes, encoder.insert_bytes, encoder.fill_bytes))
+    return delta
+
+def main():
+    import argparse
+
+    tool_verbose_description = """Tool to generate a delta image between two firmware images.
+
+Example Usage:
+Run: python gen_fw_delta_img.py --source old/Quartz_HASHED.elf --target Quartz_HASHED.elf --output Quartz_HASHED.elf.delta
+
+"""
+
+    parser = argparse.ArgumentParser(description=tool_verbose_description, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--source', type=str, required=True, help='The image currently running on the device')
+    parser.add_argument('--target', type=str, required=True, help='The new image')
+    parser.add_argument('--output', type=str, required=True, help='The output file where to store the delta image')
+    args = parser.parse_args()
+
+    logging.basicConfig(format='%(message)s', level=logging.INFO)
+
+    with open(args.source, 'rb') as f:
+        source = f.read()
+    with open(args.target, 'rb') as f:
+        target = f.read()
+
+    delta = gen_delta(source, target)
+
+    with open(args.output, 'wb') as out:
+        out.write(delta)
+
+if __name__ == '__main__':
+    main()
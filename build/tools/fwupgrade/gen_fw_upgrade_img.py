@@ -24,6 +24,10 @@ import hashlib
 import logging
 import os
 import sys
+import gen_fw_delta_img
+
+# set at HASH_TYPE when the image data is a delta against the running image
+FW_UPGRADE_IMAGE_FLAG_DELTA = 0x80000000
 
 class Fw_Upgrade_Img_Descriptor_Entry:
     ''' Firmware Upgrade Image Descriptor Entry, stores the data and translates it into
@@ -56,6 +60,7 @@ class Fw_Upgrade_Img_Descriptor_Entry:
         self.image_len = 0
         self.hash_type = 0
         self.hash = bytearray([0x00]*32)
+        self.delta_from = ""
 		
     def update_image_len (self, image_len):
         ''' Update the block size used for the entry. Changing the block size
@@ -86,6 +91,25 @@ class Fw_Upgrade_Img_Descriptor_Entry:
         self.hash = m.digest()
         return
 
+    def read_image (self):
+        ''' Read the image, when delta_from is set the data sent is a delta
+        against that image and the hash still covers the full image.
+        Returns the full image and the data to send '''
+        with open(self.filename, 'rb') as f:
+            data = f.read()
+        if len(self.delta_from) == 0:
+            return data, data
+
+        with open(self.delta_from, 'rb') as f:
+            source = f.read()
+        delta = gen_fw_delta_img.gen_delta(source, data)
+        if len(delta) >= len(data):
+            print 'delta for %s is not smaller than the image, send full image' % (self.filename)
+            return data, data
+
+        self.hash_type = self.hash_type | FW_UPGRADE_IMAGE_FLAG_DELTA
+        return data, delta
+
     def to_binary (self):
         ''' Convert the firmware descriptor entry into a packed binary
         form '''
@@ -103,6 +127,7 @@ class Fw_Upgrade_Img_Descriptor_Entry:
         ''' Parses the XML Root from an ElementTree, the XML data should
         look like:
 		<partition filename="ioe_ram_m4_free_rtos.mbn" signature="0x54445746" image_id="10" ver="1" HASH_TYPE="1"/>
+        an optional delta_from="old_image.mbn" sends a delta against the image running on the device
         '''
         if xml_root.tag != 'partition':
             raise AssertionError("Trying to parse something that is not a partition." % (size))
@@ -113,6 +138,7 @@ class Fw_Upgrade_Img_Descriptor_Entry:
         self.disk_size = int(xml_root.attrib['size_in_kb'], 0) * 1024
         self.signature = int(xml_root.attrib['signature'], 0)
         self.hash_type = int(xml_root.attrib['HASH_TYPE'], 0)
+        self.delta_from = xml_root.attrib.get('delta_from', "")
 
         if self.image_id == 0:
             print '0 is not valid image id'
@@ -273,34 +299,24 @@ class Fw_Upgrade_Img_Descriptor:
                 if len(entry.filename) > 0:
                     logging.debug('Will try to open file %s' % (entry.filename))
                     try:
-                        with open(entry.filename , 'rb') as f:
-                            # get file size
-                            f.seek(0,2)
-                            size = f.tell()
-
-                            # Append 0xFF to each image before calculating hash to make total disk size a multiple of 4KB.
-                            # Copy data from input file and appended bytes into a temporary file.
-                            temp = open('temp_file', 'wb+')
-                            f.seek(0,0)
-                            data = f.read(size)
-                            temp.write(data)
-                            size_0xff = 4096 - (size % 4096)
-                            total_size = size + size_0xff
-                            temp.write(bytearray([0xFF] * size_0xff))
-
-                            # Read data from temporary file to update hash, image length and disk size at partition entry. 
-                            temp.seek(0,0)
-                            total_data = temp.read(total_size)
-                            entry.update_hash(total_data)
-                            entry.update_image_len(size)
-                            entry.update_disk_size(total_size)
-
-                            #close the temporary file and delete it.
-                            temp.close()
-                            os.remove('temp_file')
-
-                            #close input file
-                            f.close()
+                        data, image = entry.read_image()
+                        if image is not data:
+                            # the server hosts the delta, the device asks for it by name
+                            entry.filename = entry.filename + '.delta'
+                            with open(entry.filename, 'wb') as f:
+                                f.write(image)
+                        size = len(image)
+
+                        # Append 0xFF to each image before calculating hash to make total disk size a multiple of 4KB.
+                        # The hash always covers the full image, also when a delta is sent.
+                        size_0xff = 4096 - (len(data) % 4096)
+                        total_size = len(data) + size_0xff
+                        total_data = data + bytearray([0xFF] * size_0xff)
+
+                        # update hash, image length and disk size at partition entry.
+                        entry.update_hash(total_data)
+                        entry.update_image_len(size)
+                        entry.update_disk_size(total_size)
                     except IOError as e:
                         logging.exception("Unable to open the file '%s'\n" % (entry.filename))
                         print "Can't open file %s" % (entry.filename)
@@ -311,30 +327,23 @@ class Fw_Upgrade_Img_Descriptor:
                 if len(entry.filename) > 0:
                     logging.debug('Will try to open file %s' % (entry.filename))
                     try:
-                        with open(entry.filename , 'rb') as f:
-                            # get file size
-                            f.seek(0,2)
-                            size = f.tell()
-                            #read data from input file.
-                            f.seek(0,0)
-                            data = f.read(size)
-
-                            #place it on the output file
-                            out.write(data)
-
-                            #update image len at partion entry
-                            entry.update_image_len(size)
-                            
-                            #update HASH at parttion entry
-                            entry.update_hash(data)
-
-                            logging.debug('Read %d bytes from input, out of %d' % (len(data), size))
-
-                            #close input file    
-                            f.close()
-                            
-                            #clear fileanme
-                            entry.clear_filename()
+                        data, image = entry.read_image()
+                        size = len(image)
+
+                        #place it on the output file
+                        out.write(image)
+
+                        #update image len at partion entry
+                        entry.update_image_len(size)
+                        entry.update_disk_size(len(data))
+
+                        #update HASH at parttion entry
+                        entry.update_hash(data)
+
+                        logging.debug('Read %d bytes from input, out of %d' % (len(data), size))
+
+                        #clear fileanme
+                        entry.clear_filename()
                     except IOError as e:
                         logging.exception("Unable to open the file '%s'\n" % (entry.filename))
                         print "Can't open file %s" % (entry.filename)
@@ -14,10 +14,166 @@
 #include "qmesh_model_config.h"
 #include "qmesh_model_common.h"
 
+/* Empty slot in the hash index */
+#define CACHE_HASH_SLOT_EMPTY           (0u)
+
+/* Index of the next ring slot after 'i' */
+#define CACHE_RING_NEXT(i)              (((i) + 1) % QMESH_MODEL_MSG_CACHE_SIZE)
+
 /* This can be moved to other places later if required */
 int16_t g_current_index = 0; /* index where last message added */
-/* Model message cache */
+/* Model message cache, kept in the order the messages were added */
 static QMESH_MODEL_CACHE_NODE_T g_message_cache[QMESH_MODEL_MSG_CACHE_SIZE] = {};
+/* Number of cached messages still inside the 6 second window */
+static uint16_t g_cache_count = 0;
+/* Open-addressed hash index over the cache, holding (cache index + 1) */
+static uint16_t g_cache_hash[QMESH_MODEL_MSG_CACHE_HASH_SIZE] = {};
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      cacheMsgEqual
+ *
+ *  DESCRIPTION
+ *      Compares the fields of two messages that identify a transaction.
+ *
+ *  RETURNS/MODIFIES
+ *      TRUE if the messages are the same
+ *
+ *----------------------------------------------------------------------------*/
+static bool cacheMsgEqual (const QMESH_MODEL_MSG_COMMON_T *a,
+                           const QMESH_MODEL_MSG_COMMON_T *b)
+{
+    return ((a->opcode == b->opcode) && (a->src == b->src) && (a->dst == b->dst) &&
+            (a->tid == b->tid) && (a->elem_id == b->elem_id));
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      cacheHashSlot
+ *
+ *  DESCRIPTION
+ *      Returns the home slot in the hash index for a message.
+ *
+ *  RETURNS/MODIFIES
+ *      Hash index slot
+ *
+ *----------------------------------------------------------------------------*/
+static uint16_t cacheHashSlot (const QMESH_MODEL_MSG_COMMON_T *msg)
+{
+    uint32_t h;
+
+    h = msg->opcode;
+    h = (h * 0x9E3779B1u) ^ (((uint32_t)msg->src << 16) | msg->dst);
+    h = (h * 0x9E3779B1u) ^ (((uint32_t)msg->elem_id << 8) | msg->tid);
+    h = h * 0x9E3779B1u;
+
+    return (uint16_t)((h >> 16) & (QMESH_MODEL_MSG_CACHE_HASH_SIZE - 1));
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      cacheHashFind
+ *
+ *  DESCRIPTION
+ *      Finds the hash index slot holding 'msg', or the empty slot where it
+ *      would be inserted.
+ *
+ *  RETURNS/MODIFIES
+ *      Hash index slot
+ *
+ *----------------------------------------------------------------------------*/
+static uint16_t cacheHashFind (const QMESH_MODEL_MSG_COMMON_T *msg)
+{
+    uint16_t slot = cacheHashSlot (msg);
+
+    /* The index is never more than half full, so an empty slot is always found */
+    while ((g_cache_hash[slot] != CACHE_HASH_SLOT_EMPTY) &&
+           (!cacheMsgEqual (&g_message_cache[g_cache_hash[slot] - 1].msg, msg)))
+    {
+        slot = (slot + 1) & (QMESH_MODEL_MSG_CACHE_HASH_SIZE - 1);
+    }
+
+    return slot;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      cacheHashRemove
+ *
+ *  DESCRIPTION
+ *      Removes the cache entry at 'index' from the hash index if the index
+ *      still refers to it. Following entries of the probe chain are shifted
+ *      back so that no tombstones are needed.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void cacheHashRemove (uint16_t index)
+{
+    uint16_t slot = cacheHashFind (&g_message_cache[index].msg);
+    uint16_t next;
+    uint16_t home;
+
+    /* A newer transactional copy of the message may own the slot */
+    if (g_cache_hash[slot] != (uint16_t)(index + 1))
+    {
+        return;
+    }
+
+    next = slot;
+    while (TRUE)
+    {
+        next = (next + 1) & (QMESH_MODEL_MSG_CACHE_HASH_SIZE - 1);
+        if (g_cache_hash[next] == CACHE_HASH_SLOT_EMPTY)
+        {
+            break;
+        }
+
+        /* Move the entry back if its home slot is not between the hole and it */
+        home = cacheHashSlot (&g_message_cache[g_cache_hash[next] - 1].msg);
+        if (((next - home) & (QMESH_MODEL_MSG_CACHE_HASH_SIZE - 1)) >=
+            ((next - slot) & (QMESH_MODEL_MSG_CACHE_HASH_SIZE - 1)))
+        {
+            g_cache_hash[slot] = g_cache_hash[next];
+            slot = next;
+        }
+    }
+
+    g_cache_hash[slot] = CACHE_HASH_SLOT_EMPTY;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      cacheExpire
+ *
+ *  DESCRIPTION
+ *      Drops messages older than the 6 second window, oldest first. Since
+ *      the cache is time ordered, this stops at the first message inside
+ *      the window.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void cacheExpire (uint32_t now)
+{
+    uint16_t oldest;
+
+    while (g_cache_count != 0)
+    {
+        oldest = (uint16_t)((g_current_index + QMESH_MODEL_MSG_CACHE_SIZE + 1 - g_cache_count) %
+                            QMESH_MODEL_MSG_CACHE_SIZE);
+
+        if ((uint32_t)(now - g_message_cache[oldest].ts) < QMESH_MODEL_MSG_CACHE_WINDOW_MS)
+        {
+            break;
+        }
+
+        cacheHashRemove (oldest);
+        g_cache_count--;
+    }
+}
 
 /*----------------------------------------------------------------------------*
  *  NAME
@@ -49,7 +205,9 @@ void QmeshModelInitMsgCache (void)
     }
 #endif /* QMESH_POOL_BASED_MEM_MGR */
 
-    g_current_index = 0; /* Set current index to 0 */        
+    g_current_index = 0; /* Set current index to 0 */
+    g_cache_count = 0;
+    QmeshMemSet (g_cache_hash, 0, sizeof (g_cache_hash));
     model_timer_ghdl = QmeshTimerCreateGroup(QMESH_NUM_MODEL_SOFT_TIMERS);
     if(model_timer_ghdl == QMESH_TIMER_INVALID_GROUP_HANDLE)
     {
@@ -67,8 +225,9 @@ void QmeshModelInitMsgCache (void)
  *
  *  DESCRIPTION
  *      The function adds the 'msg' into the cache if the 'msg' is not found in the 6 seconds timestamp
- * window. If the 'msg' is not found, the 'msg' will be added/overwriten in the next slot. The search is
- * limited to messages with timestamp not greater than 6 seconds old. This reduces the search time.
+ * window. If the 'msg' is not found, the 'msg' will be added/overwriten in the next slot. Messages are
+ * found through the hash index, and messages that leave the 6 seconds window are dropped from the
+ * oldest end of the cache, so both lookup and insert take constant time.
  *
  * If 'transactional' is TRUE, the message will be added into the cache in the next slot even if a message 
  * exists with same TID in the last 6 seconds window. This is required for 'Transactional' messages like
@@ -83,150 +242,44 @@ void QmeshModelInitMsgCache (void)
 bool QmeshModelCacheAddMsg (QMESH_MODEL_MSG_COMMON_T *msg,
                                      bool transactional)
 {
-    int16_t i;
     uint16_t curTime[3] = {0};
-    uint16_t temp[3] = {0};
-    uint32_t diffSec = 0;
-    
+    uint32_t now;
+    uint16_t slot;
+
     /* Get the current time in milliseconds */
-    QmeshGetCurrentTimeInMs((uint16_t *)&curTime);
+    QmeshGetCurrentTimeInMs ((uint16_t *)&curTime);
+    now = ((uint32_t)curTime[1] << 16) | (uint32_t)curTime[0];
 
-    /* Check if the slot pointed by 'cur' is empty */
-    if (0 == QmeshMemCmp (temp, g_message_cache[g_current_index].ts, sizeof (temp)))
-    {
-        /* Add the message into the cache */
-        QmeshMemCpy (&g_message_cache[g_current_index].msg, msg,
-                   sizeof (QMESH_MODEL_MSG_COMMON_T));
-        QmeshMemCpy (g_message_cache[g_current_index].ts, curTime, sizeof (curTime));
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "%s %d Msg added into the cache at index=%d\n", __FUNCTION__, __LINE__,
-                          g_current_index);
-        return TRUE;
-    }
+    cacheExpire (now);
 
-    /* If the message is transactional, add into the cache */
-    if (transactional)
-    {
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "%s %d transactional or empty - jumping to 'add'  \n", __FUNCTION__, __LINE__);
-        goto add;
-    }
+    slot = cacheHashFind (msg);
 
-    /* Search if the 'msg' exists in the cache in the last 6 seconds - that is search messages 
-         with  '(current_time-6)>=timestamp' */
-    /* Check if message pointed to by 'cur' index matches */
+    /* Message exists in the 6 seconds window - do not add into the cache */
+    if ((g_cache_hash[slot] != CACHE_HASH_SLOT_EMPTY) && (!transactional))
     {
-        /* Calculate time difference between curret time and the timestamp of the message */
-        QmeshTimeSub (temp, curTime, g_message_cache[g_current_index].ts);
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "%s %d current time =0x%04x:0x%04x:0x%04x\n", __FUNCTION__, __LINE__,
-                          curTime[2], curTime[1], curTime[0]);
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "%s %d old time =0x%04x:0x%04x:0x%04x\n", __FUNCTION__, __LINE__,
-                          g_message_cache[g_current_index].ts[2],
-                          g_message_cache[g_current_index].ts[1],
-                          g_message_cache[g_current_index].ts[0]);
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "%s %d Diff time =0x%04x:0x%04x:0x%04x\n", __FUNCTION__, __LINE__, temp[2],
-                          temp[1], temp[0]);
-        /* Conver the difference from milli seconds into 'seconds' */
-        diffSec = (((uint32_t)temp[1] << 16) | (uint32_t)temp[0]) /1000;
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "%s %d Time stamp difference=%d \n", __FUNCTION__, __LINE__, diffSec);
-
-        /* timestamp is older than 6 seconds - stop searching since any message beyond this will be 
-             older than this message */
-        if (diffSec >= 6)
-        {
-            DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                              "%s %d Message with timestamp older than 6 seconds reached - Add the message \n",
-                              __FUNCTION__, __LINE__);
-            goto add;
-        }
-
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "%s %d Cur.msg, elm=0x%x, opcode=0x%08x, src=0x%x, dst=0x%x, tid=0x%x \n",
-                          __FUNCTION__, __LINE__,
-                          g_message_cache[g_current_index].msg.elem_id,
-                          g_message_cache[g_current_index].msg.opcode,
-                          g_message_cache[g_current_index].msg.src,
-                          g_message_cache[g_current_index].msg.dst,
-                          g_message_cache[g_current_index].msg.tid);
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "%s %d Cur.msg, elm=0x%x, opcode=0x%08x, src=0x%x, dst=0x%x, tid=0x%x \n",
-                          __FUNCTION__, __LINE__,
-                          msg->elem_id, msg->opcode, msg->src, msg->dst, msg->tid);
-
-        /* Check if the message is same */
-        if (0 == QmeshMemCmp (&g_message_cache[g_current_index].msg, msg,
-                            sizeof (QMESH_MODEL_MSG_COMMON_T)))
-        {
-            /* Message exists in the cache - do not add into the cache */
-            DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-              "%s %d Message exists at index=%d and msg not older than 6 seconds - Drop the message\n",
-              __FUNCTION__, __LINE__, g_current_index);
-            return FALSE;
-        }
+        return FALSE;
     }
-    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                      "%s %d ----- start searching backwards ----------\n", __FUNCTION__, __LINE__);
-    /* Start searching from 'cur' -1 position and search backwards until 'cur' positoin is reached */
-    i = g_current_index - 1;
 
-    /* Wrap the index */
-    if (i < 0)
-    {
-        i = QMESH_MODEL_MSG_CACHE_SIZE - 1;
-    }
+    /* Message does not exist - add message into the cache in the next slot,
+     * replacing the oldest message if the cache is full */
+    g_current_index = CACHE_RING_NEXT (g_current_index);
 
-    /* Search if the 'msg' exists in the cache in the last 6 seconds */
-    while (i != g_current_index)
+    if (g_cache_count == QMESH_MODEL_MSG_CACHE_SIZE)
     {
-        QmeshTimeSub (temp, curTime, g_message_cache[i].ts);
-        diffSec = (((uint32_t)temp[1] << 16) | (uint32_t)temp[0]) /1000;
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "%s %d Time stamp difference=%d \n", __FUNCTION__, __LINE__, diffSec);
+        cacheHashRemove ((uint16_t)g_current_index);
+        g_cache_count--;
 
-        /* Timestamp of the message is less than 6 seconds */
-        if (diffSec < 6)
-        {
-            /* Compare the incoming message */
-            if (0 == QmeshMemCmp (&g_message_cache[i].msg, msg,
-                                sizeof (QMESH_MODEL_MSG_COMMON_T)))
-            {
-                /* Message exists */
-                DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                                  "%s %d Msg exists in 6 sec window at i=%d\n", __FUNCTION__, __LINE__, i);
-                return FALSE;
-            }
-        }
-        else
-        {
-            /* Messages with timestamp older than 6 secs - stop searching and add the message */
-            DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                              "%s %d Msg not found in 6 sec window - Add the message \n", __FUNCTION__,
-                              __LINE__);
-            break;
-        }
+        /* The removal may have moved entries of the probe chain */
+        slot = cacheHashFind (msg);
+    }
 
-        i --;
+    g_message_cache[g_current_index].msg = *msg;
+    g_message_cache[g_current_index].ts = now;
+    g_cache_count++;
 
-        /* Wrap the index */
-        if (i < 0)
-        {
-            i = QMESH_MODEL_MSG_CACHE_SIZE - 1;
-        }
-    }
+    /* A newer transactional copy takes over the existing slot */
+    g_cache_hash[slot] = (uint16_t)(g_current_index + 1);
 
-add:
-    /* Message does not exist - add message into the cache in the next slot */
-    g_current_index = (g_current_index + 1) % QMESH_MODEL_MSG_CACHE_SIZE;
-    QmeshMemCpy (& (g_message_cache[g_current_index].msg), msg,
-               sizeof (QMESH_MODEL_MSG_COMMON_T));
-    QmeshMemCpy (g_message_cache[g_current_index].ts, curTime, sizeof (curTime));
-    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                      "%s %d Message added into the cache at index=%d \n", __FUNCTION__, __LINE__,
-                      g_current_index);
     return TRUE;
 }
 
@@ -243,37 +296,15 @@ add:
  *----------------------------------------------------------------------------*/
 void QmeshModelCacheDump (void)
 {
-    int16_t i = 0;
-    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE, "QmeshModelCacheDump \n");
-    i = g_current_index;
+    int16_t i = g_current_index;
+    uint16_t n;
 
-    /* Condition added for Klocwork */
-    if (i >= 0)
-    {
-        /* Message pointing by 'g_current_index' */
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE, "Timestamp: %ld:%ld:%ld\n",
-                          g_message_cache[i].ts[2], g_message_cache[i].ts[1], g_message_cache[i].ts[0]);
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
-                          "Element Addr=%d, Opcode=0x%x, Src=0x%x, Dst=ox%x, TID=0x%x\n",
-                          g_message_cache[i].msg.elem_id,
-                          g_message_cache[i].msg.opcode, g_message_cache[i].msg.src,
-                          g_message_cache[i].msg.dst, g_message_cache[i].msg.tid);
-    }
-
-    /* Wrap the index */
-    if ((g_current_index - 1) < 0)
-    {
-        i = QMESH_MODEL_MSG_CACHE_SIZE - 1;
-    }
-    else
-    {
-        i = g_current_index - 1;
-    }
+    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE, "QmeshModelCacheDump \n");
 
-    while (i != g_current_index)
+    for (n = 0; n < g_cache_count; n++)
     {
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE, "Timestamp: %ld:%ld:%ld\n",
-                          g_message_cache[i].ts[2], g_message_cache[i].ts[1], g_message_cache[i].ts[0]);
+        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE, "Timestamp: %lu\n",
+                          (unsigned long)g_message_cache[i].ts);
         DEBUG_MODEL_INFO (DBUG_MODEL_MASK_DELAY_CACHE,
                           "Element Addr=%d, Opcode=0x%x, Src=0x%x, Dst=ox%x, TID=0x%x\n",
                           g_message_cache[i].msg.elem_id,
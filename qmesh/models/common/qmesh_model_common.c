@@ -26,11 +26,137 @@
 #include "qmesh_generic_powerlevel_handler.h"
 #endif
 
+#if (QMESH_MODEL_CONTEXT_INDEX_SIZE & (QMESH_MODEL_CONTEXT_INDEX_SIZE - 1)) != 0
+#error "QMESH_MODEL_CONTEXT_INDEX_SIZE must be a power of two"
+#endif
+
+/*! \brief Entry of the (element, model) to model data index. */
+typedef struct
+{
+    QMESH_MODEL_DATA_T *model_data;     /*!< Model data, NULL if the slot is empty */
+    uint16_t            model_id;       /*!< Bluetooth SIG model identifier */
+    uint8_t             elm_idx;        /*!< Index of the element in the composition data */
+} QMESH_MODEL_CONTEXT_INDEX_ENTRY_T;
+
 const QMESH_DEVICE_COMPOSITION_DATA_T* server_composition;
 
 QMESH_TIMER_GROUP_HANDLE_T model_timer_ghdl;     /* Model Timer group handle */
 QmeshAppCallback QmeshAppMsgHandler;
 
+/* Index over the composition data, built when the composition is registered */
+static QMESH_MODEL_CONTEXT_INDEX_ENTRY_T model_context_index[QMESH_MODEL_CONTEXT_INDEX_SIZE];
+static bool model_context_index_valid = FALSE;
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      modelContextIndexSlot
+ *
+ *  DESCRIPTION
+ *      Returns the home slot in the model context index for an element
+ *      index and model identifier.
+ *
+ *  RETURNS/MODIFIES
+ *      Index slot
+ *
+ *----------------------------------------------------------------------------*/
+static uint16_t modelContextIndexSlot (uint8_t elm_idx, uint16_t model_id)
+{
+    uint32_t h = (((uint32_t)elm_idx << 16) | model_id) * 0x9E3779B1u;
+
+    return (uint16_t)((h >> 16) & (QMESH_MODEL_CONTEXT_INDEX_SIZE - 1));
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      modelContextIndexBuild
+ *
+ *  DESCRIPTION
+ *      Builds the (element, model) to model data index for the registered
+ *      composition data. If the composition does not fit, the index is left
+ *      invalid and lookups scan the composition data instead.
+ *
+ *  RETURNS/MODIFIES
+ *      Nothing
+ *
+ *----------------------------------------------------------------------------*/
+static void modelContextIndexBuild (void)
+{
+    uint16_t elm_idx, mdl_idx, slot, count = 0;
+    const QMESH_ELEMENT_CONFIG_T *elem_config;
+
+    model_context_index_valid = FALSE;
+    QmeshMemSet (model_context_index, 0, sizeof (model_context_index));
+
+    if (server_composition == NULL)
+        return;
+
+    for (elm_idx = 0; elm_idx < server_composition->num_elements; elm_idx++)
+    {
+        elem_config = &server_composition->elements[elm_idx];
+
+        for (mdl_idx = 0; mdl_idx < elem_config->num_btsig_models; mdl_idx++)
+        {
+            /* Keep the index at most half full so probe chains stay short */
+            if (++count > (QMESH_MODEL_CONTEXT_INDEX_SIZE / 2))
+            {
+                DEBUG_MODEL_INFO (DBUG_MODEL_MASK_MODEL_COMMON,
+                                  "Model context index too small, using composition scan\n");
+                QmeshMemSet (model_context_index, 0, sizeof (model_context_index));
+                return;
+            }
+
+            slot = modelContextIndexSlot ((uint8_t)elm_idx, elem_config->btsig_model_ids[mdl_idx]);
+
+            /* Duplicate model identifiers resolve to the first one, like the scan */
+            while ((model_context_index[slot].model_data != NULL) &&
+                   ((model_context_index[slot].elm_idx != elm_idx) ||
+                    (model_context_index[slot].model_id != elem_config->btsig_model_ids[mdl_idx])))
+            {
+                slot = (slot + 1) & (QMESH_MODEL_CONTEXT_INDEX_SIZE - 1);
+            }
+
+            if (model_context_index[slot].model_data == NULL)
+            {
+                model_context_index[slot].model_data = &elem_config->element_data->model_data[mdl_idx];
+                model_context_index[slot].model_id   = elem_config->btsig_model_ids[mdl_idx];
+                model_context_index[slot].elm_idx    = (uint8_t)elm_idx;
+            }
+        }
+    }
+
+    model_context_index_valid = TRUE;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      modelContextIndexFind
+ *
+ *  DESCRIPTION
+ *      Looks up the model data for an element index and model identifier
+ *      in the model context index.
+ *
+ *  RETURNS/MODIFIES
+ *      Model data, or NULL if the element does not have the model
+ *
+ *----------------------------------------------------------------------------*/
+static QMESH_MODEL_DATA_T *modelContextIndexFind (uint8_t elm_idx, uint16_t model_id)
+{
+    uint16_t slot = modelContextIndexSlot (elm_idx, model_id);
+
+    while (model_context_index[slot].model_data != NULL)
+    {
+        if ((model_context_index[slot].elm_idx == elm_idx) &&
+            (model_context_index[slot].model_id == model_id))
+        {
+            return model_context_index[slot].model_data;
+        }
+
+        slot = (slot + 1) & (QMESH_MODEL_CONTEXT_INDEX_SIZE - 1);
+    }
+
+    return NULL;
+}
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      QmeshInitModelCommon
@@ -47,6 +173,8 @@ extern void QmeshInitModelCommon (QmeshAppCallback app_model_msg_handler,
 {
     server_composition = server_device_composition;
     QmeshAppMsgHandler= app_model_msg_handler;
+
+    modelContextIndexBuild ();
 }
 
 /*----------------------------------------------------------------------------*
@@ -246,6 +374,15 @@ extern QMESH_MODEL_DATA_T *QmeshGetModelData (const QMESH_ELEMENT_CONFIG_T *elem
 {
     uint8_t mdl_idx;
 
+    /* Use the index for elements of the registered composition */
+    if ((elem_config) && (model_context_index_valid) && (model_id <= 0xFFFF) &&
+        (elem_config >= server_composition->elements) &&
+        (elem_config < &server_composition->elements[server_composition->num_elements]))
+    {
+        return modelContextIndexFind ((uint8_t)(elem_config - server_composition->elements),
+                                      (uint16_t)model_id);
+    }
+
     if (elem_config)
     {
         for (mdl_idx = 0; mdl_idx < elem_config->num_btsig_models; mdl_idx++ )
@@ -331,12 +468,45 @@ extern uint8_t QmeshGetGenericDTT (const QMESH_ELEMENT_CONFIG_T
 extern void* QmeshGetModelContextFromComp (uint16_t elem_addr, uint16_t model_id)
 {
     uint8_t mdl_idx, elm_idx;
+    QMESH_MODEL_DATA_T *model_data;
     
     if(server_composition == NULL)
         return NULL;
     
     const QMESH_ELEMENT_CONFIG_T *const elem_config = server_composition->elements;
 
+    if (model_context_index_valid)
+    {
+        /* Elements are assigned consecutive unicast addresses starting from the
+         * primary element, so the element index is normally the address offset */
+        elm_idx = (uint8_t)(elem_addr - elem_config[0].element_data->unicast_addr);
+
+        if (((uint16_t)(elem_addr - elem_config[0].element_data->unicast_addr) < server_composition->num_elements) &&
+            (elem_config[elm_idx].element_data->unicast_addr == elem_addr))
+        {
+            model_data = modelContextIndexFind (elm_idx, model_id);
+            if (model_data != NULL)
+                return model_data->model_priv_data;
+
+            /* Assigned unicast addresses are unique to one element */
+            if (elem_addr != QMESH_UNASSIGNED_ADDRESS)
+                return NULL;
+        }
+
+        /* Otherwise check every element with this address */
+        for (elm_idx = 0; elm_idx < server_composition->num_elements; elm_idx++)
+        {
+            if (elem_config[elm_idx].element_data->unicast_addr == elem_addr)
+            {
+                model_data = modelContextIndexFind (elm_idx, model_id);
+                if (model_data != NULL)
+                    return model_data->model_priv_data;
+            }
+        }
+
+        return NULL;
+    }
+
     for (elm_idx = 0; elm_idx < server_composition->num_elements; elm_idx++)
     {
         if (elem_config[elm_idx].element_data->unicast_addr == elem_addr)
@@ -3,10 +3,46 @@
 #include "qmesh_model_common.h"
 #include "qmesh_model_debug.h"
 
+/* Largest model state stored under a single PS key */
+typedef union
+{
+    QMESH_MODEL_GEN_ONOFF_NVM_STATE_T       onoff;
+    QMESH_MODEL_GEN_LEVEL_NVM_STATE_T       level[QMESH_MAX_GENERIC_LEVEL_INSTANCES];
+    QMESH_MODEL_GEN_PWR_ONOFF_NVM_STATE_T   pwr_onoff;
+    QMESH_MODEL_GEN_DTT_NVM_STATE_T         dtt;
+    QMESH_MODEL_LIGHTNESS_NVM_STATE_T       lightness;
+    QMESH_MODEL_LIGHT_HSL_NVM_STATE_T       hsl;
+    QMESH_MODEL_LIGHT_HUE_NVM_STATE_T       hue;
+    QMESH_MODEL_LIGHT_SAT_NVM_STATE_T       sat;
+#ifdef QMESH_POWERLEVEL_SERVER_MODEL_ENABLE
+    QMESH_MODEL_GEN_PWR_LEVEL_NVM_STATE_T   pwr_level;
+#endif
+} NVM_MODEL_STATE_T;
 
+/* RAM copy of a model PS key */
+typedef struct
+{
+    NVM_MODEL_STATE_T   pending;        /* Latest state written by the model */
+    NVM_MODEL_STATE_T   stored;         /* State last written to or read from NVM */
+    bool                dirty;          /* 'pending' has not been written to NVM yet */
+    bool                stored_valid;   /* 'stored' holds the NVM contents */
+} NVM_MODEL_CACHE_ENTRY_T;
 
 const QMESH_DEVICE_COMPOSITION_DATA_T *nvm_server_composition;
 
+/* Write-back cache of the model PS keys, in the order of qmesh_model_ps_keys */
+static NVM_MODEL_CACHE_ENTRY_T nvm_model_cache[QMESH_MODEL_PS_KEY_LIST_SIZE];
+static QMESH_TIMER_HANDLE_T nvm_flush_timer = QMESH_TIMER_INVALID_HANDLE;
+
+/* Guards nvm_model_cache and nvm_flush_timer, which are shared by the model
+ * handlers and the soft timer thread. Not held while writing to NVM. */
+static QMESH_MUTEX_T nvm_cache_mutex;
+static bool nvm_cache_mutex_created = FALSE;
+
+/* Generic Level contexts in composition order, collected by NVMModelInit */
+static QMESH_GENERIC_LEVEL_CONTEXT_T *nvm_level_context[QMESH_MAX_GENERIC_LEVEL_INSTANCES];
+static uint8_t nvm_level_count = 0;
+
 const QMESH_PS_KEY_INFO_T qmesh_model_ps_keys[QMESH_MODEL_PS_KEY_LIST_SIZE] =
 {
     {
@@ -75,6 +111,148 @@ const QMESH_PS_KEY_INFO_T qmesh_model_ps_keys[QMESH_MODEL_PS_KEY_LIST_SIZE] =
 #endif
 };
 
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      nvmModelCacheEntry
+ *
+ *  DESCRIPTION
+ *      This function returns the cache entry and key size for a model PS key.
+ *
+ *  RETURNS/MODIFIES
+ *       Cache entry, or NULL if the key is not a model key
+ *
+ *----------------------------------------------------------------------------*/
+static NVM_MODEL_CACHE_ENTRY_T *nvmModelCacheEntry (QMESH_PS_KEY_T key, size_t *len)
+{
+    uint16_t i;
+
+    for (i = 0; i < QMESH_MODEL_PS_KEY_LIST_SIZE; i++)
+    {
+        if (qmesh_model_ps_keys[i].key == key)
+        {
+            *len = qmesh_model_ps_keys[i].entry_size;
+            return &nvm_model_cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      nvmModelFlushTimerCb
+ *
+ *  DESCRIPTION
+ *      Flush timer callback. Writes the pending model state to NVM.
+ *
+ *  RETURNS/MODIFIES
+ *       Nothing
+ *
+ *----------------------------------------------------------------------------*/
+static void nvmModelFlushTimerCb (QMESH_TIMER_HANDLE_T timerHandle, void *context)
+{
+    QmeshMutexLock (&nvm_cache_mutex);
+    nvm_flush_timer = QMESH_TIMER_INVALID_HANDLE;
+    QmeshMutexUnlock (&nvm_cache_mutex);
+
+    NVMModelFlush ();
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      nvmModelWrite
+ *
+ *  DESCRIPTION
+ *      This function records new state for a model PS key. The state is
+ *      written to NVM when the flush timer expires, so repeated changes are
+ *      combined into a single write. State that matches NVM is not written.
+ *      If the flush timer can not be started the state is written at once.
+ *
+ *  RETURNS/MODIFIES
+ *       Nothing
+ *
+ *----------------------------------------------------------------------------*/
+static void nvmModelWrite (QMESH_PS_KEY_T key, const void *state)
+{
+    NVM_MODEL_CACHE_ENTRY_T *entry;
+    size_t len;
+    bool flush_now = FALSE;
+
+    entry = nvmModelCacheEntry (key, &len);
+    if (entry == NULL)
+        return;
+
+    QmeshMutexLock (&nvm_cache_mutex);
+
+    QmeshMemCpy (&entry->pending, state, len);
+
+    /* Nothing to write if NVM already holds this state */
+    entry->dirty = !(entry->stored_valid && (QmeshMemCmp (&entry->stored, &entry->pending, len) == 0));
+
+    if ((entry->dirty) && (nvm_flush_timer == QMESH_TIMER_INVALID_HANDLE))
+    {
+        /* The timer is not restarted by later changes, so state is never held
+         * for longer than the flush delay */
+        nvm_flush_timer = QmeshTimerCreate (&model_timer_ghdl, nvmModelFlushTimerCb, NULL,
+                                            QMESH_MODEL_NVM_FLUSH_DELAY_MS);
+
+        flush_now = (nvm_flush_timer == QMESH_TIMER_INVALID_HANDLE);
+    }
+
+    QmeshMutexUnlock (&nvm_cache_mutex);
+
+    if (flush_now)
+    {
+        NVMModelFlush ();
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      nvmModelRead
+ *
+ *  DESCRIPTION
+ *      This function reads the state of a model PS key. State that has not
+ *      been written to NVM yet is returned from the cache.
+ *
+ *  RETURNS/MODIFIES
+ *       QMESH_RESULT_T
+ *
+ *----------------------------------------------------------------------------*/
+static QMESH_RESULT_T nvmModelRead (QMESH_PS_KEY_T key, void *state, size_t *len)
+{
+    NVM_MODEL_CACHE_ENTRY_T *entry;
+    size_t key_len;
+    QMESH_RESULT_T result;
+
+    entry = nvmModelCacheEntry (key, &key_len);
+
+    /* Held across the NVM read, so 'stored' can not be overwritten with
+     * contents older than a flush that completes meanwhile */
+    QmeshMutexLock (&nvm_cache_mutex);
+
+    if ((entry != NULL) && (entry->dirty) && (*len >= key_len))
+    {
+        QmeshMemCpy (state, &entry->pending, key_len);
+        *len = key_len;
+        QmeshMutexUnlock (&nvm_cache_mutex);
+        return QMESH_RESULT_SUCCESS;
+    }
+
+    result = QmeshPsReadKeyData (key, state, len);
+
+    /* Remember the NVM contents so unchanged state is not written again */
+    if ((entry != NULL) && (result == QMESH_RESULT_SUCCESS) && (*len == key_len))
+    {
+        QmeshMemCpy (&entry->stored, state, key_len);
+        entry->stored_valid = TRUE;
+    }
+
+    QmeshMutexUnlock (&nvm_cache_mutex);
+
+    return result;
+}
+
 /*----------------------------------------------------------------------------*
  *  NAME
  *      NVMAddModelKeys
@@ -128,7 +306,111 @@ QMESH_RESULT_T NVMAddModelKeys (void)
  *----------------------------------------------------------------------------*/
 extern void NVMModelInit (const QMESH_DEVICE_COMPOSITION_DATA_T *server_device_composition)
 {
+    uint8_t elm_idx;
+    uint8_t mdl_idx;
+
     nvm_server_composition = server_device_composition;
+
+    if (!nvm_cache_mutex_created)
+    {
+        if (QmeshMutexCreate (&nvm_cache_mutex) != QMESH_RESULT_SUCCESS)
+        {
+            DEBUG_MODEL_INFO (DBUG_MODEL_MASK_MODEL_COMMON,
+                              "NVMModelInit:Creating mutex Failed\n");
+        }
+        else
+        {
+            nvm_cache_mutex_created = TRUE;
+        }
+    }
+
+    QmeshMutexLock (&nvm_cache_mutex);
+    nvm_flush_timer = QMESH_TIMER_INVALID_HANDLE;
+    QmeshMemSet (nvm_model_cache, 0, sizeof (nvm_model_cache));
+    QmeshMutexUnlock (&nvm_cache_mutex);
+
+    /* Collect the Generic Level contexts once, so level writes do not need to
+     * scan the composition data */
+    nvm_level_count = 0;
+
+    const QMESH_ELEMENT_CONFIG_T *const elem_config = nvm_server_composition->elements;
+
+    for (elm_idx = 0; elm_idx < nvm_server_composition->num_elements; elm_idx++)
+    {
+        for (mdl_idx = 0; mdl_idx < elem_config[elm_idx].num_btsig_models; mdl_idx++ )
+        {
+            if ((elem_config[elm_idx].btsig_model_ids[mdl_idx] == QMESH_MODEL_GENERIC_LEVEL) &&
+                (nvm_level_count < QMESH_MAX_GENERIC_LEVEL_INSTANCES))
+            {
+                nvm_level_context[nvm_level_count++] =
+                      elem_config[elm_idx].element_data->model_data[mdl_idx].model_priv_data;
+                break;
+            }
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      NVMModelFlush
+ *
+ *  DESCRIPTION
+ *      This function writes all pending model state changes to NVM.
+ *
+ *  RETURNS/MODIFIES
+ *       Nothing
+ *
+ *----------------------------------------------------------------------------*/
+extern void NVMModelFlush (void)
+{
+    uint16_t i;
+    size_t len;
+    NVM_MODEL_STATE_T written;
+
+    QmeshMutexLock (&nvm_cache_mutex);
+
+    if (nvm_flush_timer != QMESH_TIMER_INVALID_HANDLE)
+    {
+        QmeshTimerDelete (&model_timer_ghdl, &nvm_flush_timer);
+        nvm_flush_timer = QMESH_TIMER_INVALID_HANDLE;
+    }
+
+    for (i = 0; i < QMESH_MODEL_PS_KEY_LIST_SIZE; i++)
+    {
+        if (!nvm_model_cache[i].dirty)
+            continue;
+
+        /* Write a snapshot, so the models are not held off by the NVM write */
+        QmeshMemCpy (&written, &nvm_model_cache[i].pending, qmesh_model_ps_keys[i].entry_size);
+        QmeshMutexUnlock (&nvm_cache_mutex);
+
+        len = qmesh_model_ps_keys[i].entry_size;
+
+        if (QmeshPsAddKeyData (qmesh_model_ps_keys[i].key, &written, &len) == QMESH_RESULT_SUCCESS)
+        {
+            QmeshMutexLock (&nvm_cache_mutex);
+
+            QmeshMemCpy (&nvm_model_cache[i].stored, &written, qmesh_model_ps_keys[i].entry_size);
+            nvm_model_cache[i].stored_valid = TRUE;
+
+            /* State written meanwhile is still pending for the next flush */
+            if (QmeshMemCmp (&nvm_model_cache[i].pending, &written,
+                             qmesh_model_ps_keys[i].entry_size) == 0)
+            {
+                nvm_model_cache[i].dirty = FALSE;
+            }
+        }
+        else
+        {
+            /* Keep the state pending if the write fails, so it is retried */
+            DEBUG_MODEL_INFO (DBUG_MODEL_MASK_MODEL_COMMON,
+                              "NVM write failed for key 0x%x\n", qmesh_model_ps_keys[i].key);
+
+            QmeshMutexLock (&nvm_cache_mutex);
+        }
+    }
+
+    QmeshMutexUnlock (&nvm_cache_mutex);
 }
 
 /*----------------------------------------------------------------------------*
@@ -148,7 +430,7 @@ extern void NvmReadOnOffModel(QMESH_GENERIC_ONOFF_MODEL_CONTEXT_T* onoff_model_c
     QMESH_MODEL_GEN_ONOFF_NVM_STATE_T state;
     
     /*Read Generic OnOff server state */
-    if (QmeshPsReadKeyData (QMESH_PS_KEY_MODEL_GENERIC_ONOFF, 
+    if (nvmModelRead (QMESH_PS_KEY_MODEL_GENERIC_ONOFF, 
                             &state, &len) == QMESH_RESULT_SUCCESS)
     {
         /* Set the Generic OnOff state from NVM data */
@@ -174,34 +456,21 @@ extern void NvmReadOnOffModel(QMESH_GENERIC_ONOFF_MODEL_CONTEXT_T* onoff_model_c
 extern void NvmReadGenericModelLevel()
 {
     uint8_t i = 0;
-    uint8_t elm_idx = 0;
-    uint8_t mdl_idx = 0;
     QMESH_MODEL_GEN_LEVEL_NVM_STATE_T state[QMESH_MAX_GENERIC_LEVEL_INSTANCES];
     size_t len = sizeof(QMESH_MODEL_GEN_LEVEL_NVM_STATE_T) * QMESH_MAX_GENERIC_LEVEL_INSTANCES;
     /* Read Generic Level server state */
-    if (QmeshPsReadKeyData (QMESH_PS_KEY_MODEL_GENERIC_LEVEL, 
+    if (nvmModelRead (QMESH_PS_KEY_MODEL_GENERIC_LEVEL, 
                             &state[0], &len) == QMESH_RESULT_SUCCESS)
     {
-        const QMESH_ELEMENT_CONFIG_T *const elem_config = nvm_server_composition->elements;
-
-        for (elm_idx = 0; elm_idx < nvm_server_composition->num_elements; elm_idx++)
+        for (i = 0; i < nvm_level_count; i++)
         {
-          for (mdl_idx = 0; mdl_idx < elem_config[elm_idx].num_btsig_models; mdl_idx++ )
-          {
-                if (elem_config[elm_idx].btsig_model_ids[mdl_idx] == QMESH_MODEL_GENERIC_LEVEL)
-                {
-                    QMESH_GENERIC_LEVEL_CONTEXT_T *lvl_context = \
-                          elem_config[elm_idx].element_data->model_data[mdl_idx].model_priv_data;
-      
-                   /* Set the Generic Level state from NVM data */
-                   lvl_context->cur_level = state[i].cur_level;
-                   lvl_context->target_level = state[i].target_level;
-                   lvl_context->last_msg_seq_no =state[i].last_msg_seq_no;
-                   lvl_context->last_src_addr =state[i].last_src_addr;
-                   i++;
-                   break;
-                }
-          }
+            QMESH_GENERIC_LEVEL_CONTEXT_T *lvl_context = nvm_level_context[i];
+
+            /* Set the Generic Level state from NVM data */
+            lvl_context->cur_level = state[i].cur_level;
+            lvl_context->target_level = state[i].target_level;
+            lvl_context->last_msg_seq_no =state[i].last_msg_seq_no;
+            lvl_context->last_src_addr =state[i].last_src_addr;
         }
     }
 }
@@ -222,7 +491,7 @@ extern void NvmReadGenericPowerOnOffState(QMESH_GEN_POWERONOFF_DATA_T* pwronoff_
     QMESH_MODEL_GEN_PWR_ONOFF_NVM_STATE_T state;
     size_t len = sizeof(QMESH_MODEL_GEN_PWR_ONOFF_NVM_STATE_T);
     /* Read Generic Power OnOff server state */
-    if (QmeshPsReadKeyData (QMESH_PS_KEY_MODEL_GENERIC_POWER_ONOFF, 
+    if (nvmModelRead (QMESH_PS_KEY_MODEL_GENERIC_POWER_ONOFF, 
                             &state, &len) == QMESH_RESULT_SUCCESS)
     {
         /* Set the Generic Power OnOff state from NVM data */
@@ -248,7 +517,7 @@ extern void NvmReadGenericDefaultTimeTransitionServerState(QMESH_GENERIC_DTT_CON
     QMESH_MODEL_GEN_DTT_NVM_STATE_T state;
     size_t len = sizeof(QMESH_MODEL_GEN_DTT_NVM_STATE_T);
     /* Read Generic Default Time Transition server state */
-    if (QmeshPsReadKeyData (QMESH_PS_KEY_MODEL_GENERIC_DTT, 
+    if (nvmModelRead (QMESH_PS_KEY_MODEL_GENERIC_DTT, 
                             &state, &len) == QMESH_RESULT_SUCCESS)
     {
         /* Set the Generic Default Time Transition state from NVM data */
@@ -275,7 +544,7 @@ extern void NvmReadLightnessServerState(QMESH_LIGHTNESS_MODEL_CONTEXT_T* lightne
     QMESH_MODEL_LIGHTNESS_NVM_STATE_T nvm_state;
 
     /* Read Lightness server state */
-    if (QmeshPsReadKeyData (QMESH_PS_KEY_MODEL_LIGHTNESS, 
+    if (nvmModelRead (QMESH_PS_KEY_MODEL_LIGHTNESS, 
                             &nvm_state, &len) == QMESH_RESULT_SUCCESS)
     {
          lightness_context->lightness_linear = nvm_state.lightness_linear; 
@@ -307,7 +576,7 @@ extern void NvmReadReadHSLServerState(QMESH_LIGHT_HSL_MODEL_CONTEXT_T* hsl_conte
     size_t len = sizeof(QMESH_MODEL_LIGHT_HSL_NVM_STATE_T);
 
     /* Read HSL server state */
-    if (QmeshPsReadKeyData (QMESH_PS_KEY_MODEL_LIGHT_HSL, 
+    if (nvmModelRead (QMESH_PS_KEY_MODEL_LIGHT_HSL, 
                             &nvm_state, &len) == QMESH_RESULT_SUCCESS)
     {
          hsl_context->light_hsl_lightness = nvm_state.light_hsl_lightness; 
@@ -342,7 +611,7 @@ extern void NvmReadModelLightHueServerState(QMESH_LIGHT_HSL_HUE_MODEL_CONTEXT_T*
     size_t len = sizeof(QMESH_MODEL_LIGHT_HUE_NVM_STATE_T);
 
     /* Read Hue server state */
-    if (QmeshPsReadKeyData (QMESH_PS_KEY_MODEL_LIGHT_HUE, 
+    if (nvmModelRead (QMESH_PS_KEY_MODEL_LIGHT_HUE, 
                             &nvm_state, &len) == QMESH_RESULT_SUCCESS)
     {
 
@@ -370,7 +639,7 @@ extern void NvmReadSaturationServerState(QMESH_LIGHT_HSL_SAT_MODEL_CONTEXT_T* sa
     size_t len = sizeof(QMESH_MODEL_LIGHT_SAT_NVM_STATE_T);
 
     /* Read Saturation server state */
-    if (QmeshPsReadKeyData (QMESH_PS_KEY_MODEL_LIGHT_SAT, 
+    if (nvmModelRead (QMESH_PS_KEY_MODEL_LIGHT_SAT, 
                             &nvm_state, &len) == QMESH_RESULT_SUCCESS)
     {
         sat_context->light_hsl_sat = nvm_state.light_hsl_sat; 
@@ -398,7 +667,7 @@ extern void NvmReadGenericPowerLevelServerState(QMESH_GENERIC_POWERLEVEL_CONTEXT
     size_t len = sizeof(QMESH_MODEL_GEN_PWR_LEVEL_NVM_STATE_T);
 
     /* Read Generic Power Level server state */
-    if (QmeshPsReadKeyData (QMESH_PS_KEY_MODEL_GENERIC_POWER_LEVEL, 
+    if (nvmModelRead (QMESH_PS_KEY_MODEL_GENERIC_POWER_LEVEL, 
                              &state, &len) == QMESH_RESULT_SUCCESS)
     {
         /* Set the Generic Power Level state from NVM data */
@@ -429,8 +698,7 @@ extern void NvmReadGenericPowerLevelServerState(QMESH_GENERIC_POWERLEVEL_CONTEXT
  *----------------------------------------------------------------------------*/
 void  NVMWrite_ModelGenOnOffState(uint8_t* state)
 {
-    size_t len = sizeof(QMESH_MODEL_GEN_ONOFF_NVM_STATE_T);
-    QmeshPsAddKeyData (QMESH_PS_KEY_MODEL_GENERIC_ONOFF, (uint16_t*)state, &len);
+    nvmModelWrite (QMESH_PS_KEY_MODEL_GENERIC_ONOFF, state);
 }
 
 /*----------------------------------------------------------------------------*
@@ -446,36 +714,24 @@ void  NVMWrite_ModelGenOnOffState(uint8_t* state)
  *----------------------------------------------------------------------------*/
 extern void NVMWrite_ModelGenWriteLevelState ()
 {
-    int i = 0;
-    uint8_t elm_idx = 0;
-    uint8_t mdl_idx = 0;
-    
+    uint8_t i;
     QMESH_MODEL_GEN_LEVEL_NVM_STATE_T state[QMESH_MAX_GENERIC_LEVEL_INSTANCES];
-    
-    const QMESH_ELEMENT_CONFIG_T *const elem_config = nvm_server_composition->elements;
 
-    for (elm_idx = 0; elm_idx < nvm_server_composition->num_elements; elm_idx++)
+    /* Clear unused entries so unchanged state compares equal */
+    QmeshMemSet (state, 0, sizeof (state));
+
+    for (i = 0; i < nvm_level_count; i++)
     {
-        for (mdl_idx = 0; mdl_idx < elem_config[elm_idx].num_btsig_models; mdl_idx++ )
-        {
-                if (elem_config[elm_idx].btsig_model_ids[mdl_idx] == QMESH_MODEL_GENERIC_LEVEL)
-                {
-                    QMESH_GENERIC_LEVEL_CONTEXT_T *lvl_context = \
-                          elem_config[elm_idx].element_data->model_data[mdl_idx].model_priv_data;
-                          
-                    /* Set the Generic Level state from NVM data */
-                    state[i].cur_level = lvl_context->cur_level;
-                    state[i].target_level = lvl_context->target_level;
-                    state[i].last_msg_seq_no = lvl_context->last_msg_seq_no;
-                    state[i].last_src_addr = lvl_context->last_src_addr;
-                    i++;
-                    break;
-                }
-        }
+        QMESH_GENERIC_LEVEL_CONTEXT_T *lvl_context = nvm_level_context[i];
+
+        /* Set the Generic Level state from NVM data */
+        state[i].cur_level = lvl_context->cur_level;
+        state[i].target_level = lvl_context->target_level;
+        state[i].last_msg_seq_no = lvl_context->last_msg_seq_no;
+        state[i].last_src_addr = lvl_context->last_src_addr;
     }
-               
-    size_t len = sizeof(QMESH_MODEL_GEN_LEVEL_NVM_STATE_T) * QMESH_MAX_GENERIC_LEVEL_INSTANCES;
-    QmeshPsAddKeyData (QMESH_PS_KEY_MODEL_GENERIC_LEVEL, (uint16_t*)state, &len);
+
+    nvmModelWrite (QMESH_PS_KEY_MODEL_GENERIC_LEVEL, state);
 }
 
 /*----------------------------------------------------------------------------*
@@ -491,8 +747,7 @@ extern void NVMWrite_ModelGenWriteLevelState ()
  *----------------------------------------------------------------------------*/
 void  NVMWrite_ModelGenPowerOnOffState(uint8_t* state)
 {
-    size_t len = sizeof(QMESH_MODEL_GEN_PWR_ONOFF_NVM_STATE_T);
-    QmeshPsAddKeyData (QMESH_PS_KEY_MODEL_GENERIC_POWER_ONOFF, (uint16_t*)state, &len);
+    nvmModelWrite (QMESH_PS_KEY_MODEL_GENERIC_POWER_ONOFF, state);
 }
 
 /*----------------------------------------------------------------------------*
@@ -509,8 +764,7 @@ void  NVMWrite_ModelGenPowerOnOffState(uint8_t* state)
 /*Write the Generic Default Time Transition model state to NVM*/
 void  NVMWrite_ModelGenDTTState(uint8_t* state)
 {
-    size_t len = sizeof(QMESH_MODEL_GEN_DTT_NVM_STATE_T);
-    QmeshPsAddKeyData (QMESH_PS_KEY_MODEL_GENERIC_DTT, (uint16_t*)state, &len);
+    nvmModelWrite (QMESH_PS_KEY_MODEL_GENERIC_DTT, state);
 }
 
 /*----------------------------------------------------------------------------*
@@ -526,8 +780,7 @@ void  NVMWrite_ModelGenDTTState(uint8_t* state)
  *----------------------------------------------------------------------------*/
 void NVMWrite_ModelLightnessState(uint8_t* state)
 {
-    size_t len = sizeof(QMESH_MODEL_LIGHTNESS_NVM_STATE_T);
-    QmeshPsAddKeyData (QMESH_PS_KEY_MODEL_LIGHTNESS, (uint16_t*)state, &len);
+    nvmModelWrite (QMESH_PS_KEY_MODEL_LIGHTNESS, state);
 }
 
 /*----------------------------------------------------------------------------*
@@ -543,8 +796,7 @@ void NVMWrite_ModelLightnessState(uint8_t* state)
  *----------------------------------------------------------------------------*/
 void NVMWrite_ModelLightHslState(uint8_t* state)
 {
-    size_t len = sizeof(QMESH_MODEL_LIGHT_HSL_NVM_STATE_T);
-    QmeshPsAddKeyData (QMESH_PS_KEY_MODEL_LIGHT_HSL, (uint16_t*)state, &len);  
+    nvmModelWrite (QMESH_PS_KEY_MODEL_LIGHT_HSL, state);
 }
 
 /*----------------------------------------------------------------------------*
@@ -560,8 +812,7 @@ void NVMWrite_ModelLightHslState(uint8_t* state)
  *----------------------------------------------------------------------------*/
 void NVMWrite_ModelLightSatState(uint8_t* state)
 {
-    size_t len = sizeof(QMESH_MODEL_LIGHT_SAT_NVM_STATE_T);
-    QmeshPsAddKeyData (QMESH_PS_KEY_MODEL_LIGHT_SAT, (uint16_t*)state, &len);
+    nvmModelWrite (QMESH_PS_KEY_MODEL_LIGHT_SAT, state);
 }
 
 /*----------------------------------------------------------------------------*
@@ -577,8 +828,7 @@ void NVMWrite_ModelLightSatState(uint8_t* state)
  *----------------------------------------------------------------------------*/
 void NVMWrite_ModelLightHueState(uint8_t* state)
 {
-    size_t len = sizeof(QMESH_MODEL_LIGHT_HUE_NVM_STATE_T);
-    QmeshPsAddKeyData (QMESH_PS_KEY_MODEL_LIGHT_HUE, (uint16_t*)state, &len);
+    nvmModelWrite (QMESH_PS_KEY_MODEL_LIGHT_HUE, state);
 }
 
 #ifdef QMESH_POWERLEVEL_SERVER_MODEL_ENABLE
@@ -595,7 +845,6 @@ void NVMWrite_ModelLightHueState(uint8_t* state)
  *----------------------------------------------------------------------------*/
 void  NVMWrite_ModelGenPowerLevelState(uint8_t* state)
 {
-    size_t len = sizeof(QMESH_MODEL_GEN_PWR_LEVEL_NVM_STATE_T);
-    QmeshPsAddKeyData (QMESH_PS_KEY_MODEL_GENERIC_POWER_LEVEL, (uint16_t*)state, &len);
+    nvmModelWrite (QMESH_PS_KEY_MODEL_GENERIC_POWER_LEVEL, state);
 }
 #endif
@@ -0,0 +1,551 @@
+/******************************************************************************
+ Copyright (c) 2018 Qualcomm Technologies International, Ltd.
+ All Rights Reserved.
+ Qualcomm Technologies International, Ltd. Confidential and Proprietary.
+ *****************************************************************************/
+/*! \file qmesh_transition_engine.c
+ *  \brief Implements the shared transition engine
+ *
+ *   This file implements the table of running state transitions. A single
+ *   soft timer is armed to the earliest moment at which any ramp changes its
+ *   value. On expiry every ramp due within the coalescing window is stepped,
+ *   the bound states are updated once per element and finished ramps are
+ *   completed.
+ */
+/*****************************************************************************/
+
+/*============================================================================*
+ *  Local Header Files
+ *============================================================================*/
+
+#include "qmesh_transition_engine.h"
+
+/*============================================================================*
+ *  Private Data Types
+ *============================================================================*/
+
+/* Transition table entry */
+typedef struct
+{
+    QMESH_TRANSITION_PARAMS_T params;   /* Ramp parameters */
+    uint64_t start_time;                /* Time in ms at which the ramp started */
+    uint64_t next_time;                 /* Time in ms of the next value change */
+    uint16_t step;                      /* Last step applied */
+    uint8_t gen;                        /* Generation of the entry, part of the handle */
+    bool active;                        /* Entry in use */
+} QMESH_TRANSITION_RAMP_T;
+
+/* Ramp stepped on a tick. Only what the callbacks need is copied out of the
+ * table, so that they run without the table lock and the soft timer stack
+ * does not carry whole ramp parameters.
+ */
+typedef struct
+{
+    void *context;
+    QMESH_TRANSITION_STEP_CB_T step_cb;
+    QMESH_TRANSITION_NOTIFY_CB_T notify_cb;
+    QMESH_TRANSITION_DONE_CB_T done_cb;
+    int32_t value[QMESH_TRANSITION_MAX_VALUES];
+    QMESH_TRANSITION_HANDLE_T handle;
+    uint16_t elm_addr;
+    uint16_t rem_steps;
+    bool done;
+} QMESH_TRANSITION_DUE_T;
+
+/* Transition engine internal data */
+typedef struct
+{
+    QMESH_TIMER_HANDLE_T timer;         /* Engine timer */
+    uint64_t timer_time;                /* Expiry time of the engine timer */
+    QMESH_MUTEX_T mutex;                /* Protects the table */
+} QMESH_TRANSITION_INTERNAL_DATA_T;
+
+/*============================================================================*
+ *  Private Data
+ *============================================================================*/
+
+/* Transition engine internal data */
+static QMESH_TRANSITION_INTERNAL_DATA_T g_trans;
+
+/* Transition table */
+static QMESH_TRANSITION_RAMP_T g_trans_ramp[QMESH_MAX_TRANSITION_RAMPS];
+
+/*============================================================================*
+ *  Private Function Prototypes
+ *============================================================================*/
+
+/* This function returns the current time in milliseconds */
+static uint64_t transitionNow (void);
+
+/* This function returns the value of a ramp at a step */
+static int32_t transitionValue (const QMESH_TRANSITION_PARAMS_T *params,
+                                uint8_t idx, uint16_t step);
+
+/* This function returns the first step after 'step' at which a value changes */
+static uint16_t transitionNextStep (const QMESH_TRANSITION_PARAMS_T *params,
+                                    uint16_t step);
+
+/* This function arms the engine timer for the earliest ramp */
+static void transitionArmTimer (uint64_t now);
+
+/* This function handles the engine timer expiry */
+static void transitionTimerCb (QMESH_TIMER_HANDLE_T timerHandle, void *context);
+
+/*============================================================================*
+ *  Private Function Implementations
+ *============================================================================*/
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      transitionNow
+*
+*  DESCRIPTION
+*      This function returns the current time in milliseconds
+*
+*  RETURNS/MODIFIES
+*      Current time
+*
+*----------------------------------------------------------------------------*/
+static uint64_t transitionNow (void)
+{
+    uint16_t current_time[3];
+
+    QmeshGetCurrentTimeInMs (current_time);
+    return ((uint64_t)current_time[2] << 32) |
+           ((uint64_t)current_time[1] << 16) |
+           (uint64_t)current_time[0];
+}
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      transitionValue
+*
+*  DESCRIPTION
+*      This function returns the value of a ramp at a step. The value is
+*      computed from the start value, so the rounding error does not add up
+*      over the steps and the last step lands exactly on the target.
+*
+*  RETURNS/MODIFIES
+*      Value at the step
+*
+*----------------------------------------------------------------------------*/
+static int32_t transitionValue (const QMESH_TRANSITION_PARAMS_T *params,
+                                uint8_t idx, uint16_t step)
+{
+    int64_t delta = (int64_t)params->target[idx] - params->start[idx];
+
+    return params->start[idx] +
+           (int32_t)((delta * step) / params->num_steps);
+}
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      transitionNextStep
+*
+*  DESCRIPTION
+*      This function returns the first step after 'step' at which any of the
+*      values changes. Steps which would not change a value are skipped, so a
+*      small change over many steps does not wake the engine on every step.
+*
+*  RETURNS/MODIFIES
+*      Step number, at most 'num_steps'
+*
+*----------------------------------------------------------------------------*/
+static uint16_t transitionNextStep (const QMESH_TRANSITION_PARAMS_T *params,
+                                    uint16_t step)
+{
+    uint16_t next = params->num_steps;
+    uint64_t delta, quot, cand;
+    uint8_t idx;
+
+    for (idx = 0; idx < params->num_values; idx++)
+    {
+        delta = (params->target[idx] > params->start[idx]) ?
+                (uint64_t)((int64_t)params->target[idx] - params->start[idx]) :
+                (uint64_t)((int64_t)params->start[idx] - params->target[idx]);
+
+        if (delta == 0)
+            continue;
+
+        /* Value changes when delta * k / num_steps reaches the next integer */
+        quot = (delta * step) / params->num_steps;
+        cand = ((quot + 1) * params->num_steps + delta - 1) / delta;
+
+        if (cand < next)
+            next = (uint16_t)cand;
+    }
+
+    return next;
+}
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      transitionArmTimer
+*
+*  DESCRIPTION
+*      This function arms the engine timer for the earliest value change of
+*      all running ramps. Must be called with the table lock held.
+*
+*  RETURNS/MODIFIES
+*      Nothing
+*
+*----------------------------------------------------------------------------*/
+static void transitionArmTimer (uint64_t now)
+{
+    uint64_t next_time = 0;
+    bool found = FALSE;
+    uint8_t idx;
+
+    for (idx = 0; idx < QMESH_MAX_TRANSITION_RAMPS; idx++)
+    {
+        if (g_trans_ramp[idx].active &&
+            (!found || g_trans_ramp[idx].next_time < next_time))
+        {
+            next_time = g_trans_ramp[idx].next_time;
+            found = TRUE;
+        }
+    }
+
+    /* Keep the timer if it already expires at the right time */
+    if (g_trans.timer != QMESH_TIMER_INVALID_HANDLE)
+    {
+        if (found && g_trans.timer_time == next_time)
+            return;
+
+        QmeshTimerDelete (&model_timer_ghdl, &g_trans.timer);
+    }
+
+    if (!found)
+        return;
+
+    g_trans.timer_time = next_time;
+    g_trans.timer = QmeshTimerCreate (&model_timer_ghdl,
+                                      transitionTimerCb,
+                                      NULL,
+                                      (next_time > now) ?
+                                      (uint32_t)(next_time - now) : 1);
+
+    if (g_trans.timer == QMESH_TIMER_INVALID_HANDLE)
+    {
+        DEBUG_MODEL_ERROR (DBUG_MODEL_MASK_TRANSITION,
+                           "Transition Timer Creation Failed\n");
+    }
+}
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      transitionTimerCb
+*
+*  DESCRIPTION
+*      This function handles the engine timer expiry. All ramps changing
+*      within the coalescing window are stepped on this tick. The model
+*      callbacks are called after the table lock is released, so they are
+*      free to start and stop ramps.
+*
+*  RETURNS/MODIFIES
+*      Nothing
+*
+*----------------------------------------------------------------------------*/
+static void transitionTimerCb (QMESH_TIMER_HANDLE_T timerHandle, void *context)
+{
+    QMESH_TRANSITION_DUE_T due[QMESH_MAX_TRANSITION_RAMPS];
+    QMESH_TRANSITION_RAMP_T *ramp;
+    uint64_t now, eval_time;
+    uint16_t step;
+    uint8_t idx, val, num_due = 0, prev;
+
+    QmeshMutexLock (&g_trans.mutex);
+
+    /* A timer re-armed by QmeshTransitionStart may have fired already */
+    if (g_trans.timer == timerHandle)
+        g_trans.timer = QMESH_TIMER_INVALID_HANDLE;
+
+    now = transitionNow();
+    eval_time = now + QMESH_TRANSITION_COALESCE_MS;
+
+    for (idx = 0; idx < QMESH_MAX_TRANSITION_RAMPS; idx++)
+    {
+        ramp = &g_trans_ramp[idx];
+
+        if (!ramp->active || ramp->next_time > eval_time)
+            continue;
+
+        /* Step reached at the end of the coalescing window */
+        if (ramp->params.step_ms == 0)
+        {
+            step = ramp->params.num_steps;
+        }
+        else
+        {
+            uint64_t elapsed = (eval_time - ramp->start_time) / ramp->params.step_ms;
+            step = (elapsed < ramp->params.num_steps) ?
+                   (uint16_t)elapsed : ramp->params.num_steps;
+        }
+
+        ramp->step = step;
+        due[num_due].context = ramp->params.context;
+        due[num_due].step_cb = ramp->params.step_cb;
+        due[num_due].notify_cb = ramp->params.notify_cb;
+        due[num_due].done_cb = ramp->params.done_cb;
+        due[num_due].elm_addr = ramp->params.elm_addr;
+        due[num_due].handle = (QMESH_TRANSITION_HANDLE_T)((ramp->gen << 8) | (idx + 1));
+        due[num_due].rem_steps = ramp->params.num_steps - step;
+        due[num_due].done = (step == ramp->params.num_steps);
+
+        for (val = 0; val < ramp->params.num_values; val++)
+            due[num_due].value[val] = transitionValue (&ramp->params, val, step);
+
+        if (due[num_due].done)
+        {
+            ramp->active = FALSE;
+        }
+        else
+        {
+            ramp->next_time = ramp->start_time +
+                              (uint64_t)transitionNextStep (&ramp->params, step) *
+                              ramp->params.step_ms;
+        }
+
+        num_due++;
+    }
+
+    transitionArmTimer (now);
+    QmeshMutexUnlock (&g_trans.mutex);
+
+    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_TRANSITION,
+                      "Transition tick: %d ramps\n", num_due);
+
+    /* Apply the new values */
+    for (idx = 0; idx < num_due; idx++)
+    {
+        due[idx].step_cb (due[idx].handle, due[idx].context,
+                          due[idx].value, due[idx].rem_steps);
+    }
+
+    /* Update the bound states once per element */
+    for (idx = 0; idx < num_due; idx++)
+    {
+        if (due[idx].notify_cb == NULL)
+            continue;
+
+        for (prev = 0; prev < idx; prev++)
+        {
+            if (due[prev].elm_addr == due[idx].elm_addr &&
+                due[prev].notify_cb == due[idx].notify_cb)
+                break;
+        }
+
+        if (prev == idx)
+        {
+            due[idx].notify_cb (due[idx].elm_addr, due[idx].context);
+        }
+    }
+
+    /* Complete the finished ramps */
+    for (idx = 0; idx < num_due; idx++)
+    {
+        if (due[idx].done && due[idx].done_cb != NULL)
+        {
+            due[idx].done_cb (due[idx].handle, due[idx].context);
+        }
+    }
+}
+
+/*============================================================================*
+ *  Public Function Implementations
+ *============================================================================*/
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      QmeshTransitionStart
+*
+*  DESCRIPTION
+*      This function adds a new ramp to the transition table
+*
+*  RETURNS/MODIFIES
+*      Transition handle
+*
+*----------------------------------------------------------------------------*/
+extern QMESH_TRANSITION_HANDLE_T QmeshTransitionStart (const QMESH_TRANSITION_PARAMS_T *params)
+{
+    QMESH_TRANSITION_HANDLE_T handle = QMESH_TRANSITION_INVALID_HANDLE;
+    QMESH_TRANSITION_RAMP_T *ramp;
+    uint64_t now;
+    uint8_t idx;
+
+    if (params == NULL || params->step_cb == NULL ||
+        params->num_values == 0 ||
+        params->num_values > QMESH_TRANSITION_MAX_VALUES)
+    {
+        return QMESH_TRANSITION_INVALID_HANDLE;
+    }
+
+    QmeshMutexLock (&g_trans.mutex);
+
+    for (idx = 0; idx < QMESH_MAX_TRANSITION_RAMPS; idx++)
+    {
+        if (!g_trans_ramp[idx].active)
+            break;
+    }
+
+    if (idx < QMESH_MAX_TRANSITION_RAMPS)
+    {
+        now = transitionNow();
+        ramp = &g_trans_ramp[idx];
+        QmeshMemCpy (&ramp->params, params, sizeof (QMESH_TRANSITION_PARAMS_T));
+
+        /* An immediate change is a single step due right away */
+        if (ramp->params.num_steps == 0)
+        {
+            ramp->params.num_steps = 1;
+            ramp->params.step_ms = 0;
+        }
+
+        ramp->start_time = now;
+        ramp->step = 0;
+        ramp->next_time = now + (uint64_t)transitionNextStep (&ramp->params, 0) *
+                          ramp->params.step_ms;
+        ramp->active = TRUE;
+
+        /* Generation 0 is skipped so that a handle is never 0 */
+        if (++ramp->gen == 0)
+            ramp->gen = 1;
+
+        handle = (QMESH_TRANSITION_HANDLE_T)((ramp->gen << 8) | (idx + 1));
+        transitionArmTimer (now);
+    }
+    else
+    {
+        DEBUG_MODEL_ERROR (DBUG_MODEL_MASK_TRANSITION,
+                           "Transition table full\n");
+    }
+
+    QmeshMutexUnlock (&g_trans.mutex);
+    return handle;
+}
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      QmeshTransitionStop
+*
+*  DESCRIPTION
+*      This function removes a ramp from the transition table
+*
+*  RETURNS/MODIFIES
+*      Invalidates the handle
+*
+*----------------------------------------------------------------------------*/
+extern void QmeshTransitionStop (QMESH_TRANSITION_HANDLE_T *handle)
+{
+    uint8_t idx = (uint8_t)(*handle & 0xFF);
+
+    if (*handle == QMESH_TRANSITION_INVALID_HANDLE)
+        return;
+
+    QmeshMutexLock (&g_trans.mutex);
+
+    if (idx >= 1 && idx <= QMESH_MAX_TRANSITION_RAMPS &&
+        g_trans_ramp[idx - 1].active &&
+        g_trans_ramp[idx - 1].gen == (uint8_t)(*handle >> 8))
+    {
+        /* The engine timer is left running, the tick re-arms it */
+        g_trans_ramp[idx - 1].active = FALSE;
+    }
+
+    QmeshMutexUnlock (&g_trans.mutex);
+    *handle = QMESH_TRANSITION_INVALID_HANDLE;
+}
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      QmeshTransitionGetRemainingTime
+*
+*  DESCRIPTION
+*      This function returns the time left until a ramp reaches its target
+*
+*  RETURNS/MODIFIES
+*      Remaining time in milliseconds
+*
+*----------------------------------------------------------------------------*/
+extern uint32_t QmeshTransitionGetRemainingTime (QMESH_TRANSITION_HANDLE_T handle)
+{
+    QMESH_TRANSITION_RAMP_T *ramp;
+    uint64_t end_time, now;
+    uint32_t remaining = 0;
+    uint8_t idx = (uint8_t)(handle & 0xFF);
+
+    if (handle == QMESH_TRANSITION_INVALID_HANDLE)
+        return 0;
+
+    QmeshMutexLock (&g_trans.mutex);
+
+    if (idx >= 1 && idx <= QMESH_MAX_TRANSITION_RAMPS &&
+        g_trans_ramp[idx - 1].active &&
+        g_trans_ramp[idx - 1].gen == (uint8_t)(handle >> 8))
+    {
+        ramp = &g_trans_ramp[idx - 1];
+        end_time = ramp->start_time +
+                   (uint64_t)ramp->params.num_steps * ramp->params.step_ms;
+        now = transitionNow();
+
+        if (end_time > now)
+            remaining = (uint32_t)(end_time - now);
+    }
+
+    QmeshMutexUnlock (&g_trans.mutex);
+    return remaining;
+}
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      QmeshInitTransitionEngine
+*
+*  DESCRIPTION
+*      This function initialises the transition table
+*
+*  RETURNS/MODIFIES
+*      Nothing
+*
+*----------------------------------------------------------------------------*/
+extern void QmeshInitTransitionEngine (void)
+{
+    QmeshMemSet (g_trans_ramp, 0, sizeof (g_trans_ramp));
+    g_trans.timer = QMESH_TIMER_INVALID_HANDLE;
+    g_trans.timer_time = 0;
+    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_TRANSITION,
+                      "QmeshInitTransitionEngine:Creating mutex\n");
+
+    if (QmeshMutexCreate (&g_trans.mutex) != QMESH_RESULT_SUCCESS)
+    {
+        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_TRANSITION,
+                          "QmeshInitTransitionEngine:Creating mutex Failed\n");
+    }
+}
+
+/*-----------------------------------------------------------------------------*
+*  NAME
+*      QmeshDeInitTransitionEngine
+*
+*  DESCRIPTION
+*      This function stops all transitions and de-initialises the engine
+*
+*  RETURNS/MODIFIES
+*      Nothing
+*
+*----------------------------------------------------------------------------*/
+extern void QmeshDeInitTransitionEngine (void)
+{
+    uint8_t idx;
+
+    QmeshMutexLock (&g_trans.mutex);
+
+    for (idx = 0; idx < QMESH_MAX_TRANSITION_RAMPS; idx++)
+        g_trans_ramp[idx].active = FALSE;
+
+    if (g_trans.timer != QMESH_TIMER_INVALID_HANDLE)
+        QmeshTimerDelete (&model_timer_ghdl, &g_trans.timer);
+
+    QmeshMutexUnlock (&g_trans.mutex);
+    /* Destroy the mutex for the table */
+    QmeshMutexDestroy (&g_trans.mutex);
+}
@@ -21,12 +21,29 @@
 */
 
 /* Number of model messages to store per element */
+#ifndef NUM_OF_CACHE_MSG_PER_ELEMENT
 #define NUM_OF_CACHE_MSG_PER_ELEMENT        (10)
+#endif
 
 /* Maximum number of model messages stored in the cache */
 #define QMESH_MODEL_MSG_CACHE_SIZE   \
                   (QMESH_NUMBER_OF_ELEMENTS * NUM_OF_CACHE_MSG_PER_ELEMENT)
 
+/* Number of slots in the hash index over the cache. Must be a power of two
+ * and at least twice QMESH_MODEL_MSG_CACHE_SIZE to keep probe chains short.
+ */
+#ifndef QMESH_MODEL_MSG_CACHE_HASH_SIZE
+#define QMESH_MODEL_MSG_CACHE_HASH_SIZE     (64)
+#endif
+
+#if (QMESH_MODEL_MSG_CACHE_HASH_SIZE < (2 * QMESH_MODEL_MSG_CACHE_SIZE)) || \
+    ((QMESH_MODEL_MSG_CACHE_HASH_SIZE & (QMESH_MODEL_MSG_CACHE_HASH_SIZE - 1)) != 0)
+#error "QMESH_MODEL_MSG_CACHE_HASH_SIZE must be a power of two >= 2 * QMESH_MODEL_MSG_CACHE_SIZE"
+#endif
+
+/* Window (in milliseconds) in which duplicate messages are dropped */
+#define QMESH_MODEL_MSG_CACHE_WINDOW_MS     (6000u)
+
 /* Maximum number of delay cache entries */
 #define NUM_DELAY_CACHE_ENTRIES 10u
 #define MODEL_CACHE_ENTRY_SIZE  16u
@@ -37,7 +54,7 @@
 /*! \brief Structure representing an entry in the 6 second cache list.*/
 typedef struct
 {
-    uint16_t    ts[3];                  /*!< Time stamp when the message is added into the cache */
+    uint32_t    ts;                     /*!< Time stamp (lower 32 bits, in milliseconds) when the message is added into the cache */
     QMESH_MODEL_MSG_COMMON_T    msg;    /*!< Model Message */
 }QMESH_MODEL_CACHE_NODE_T;
 
@@ -87,8 +104,9 @@ void QmeshModelInitMsgCache(void);
  * QmeshModelCacheAddMsg
  */
 /*! \brief The function adds the 'msg' into the cache if the 'msg' is not found in the 6 seconds timestamp
- *        window. If the 'msg' is not found, the 'msg' will be added/overwriten in the next slot. The search is
- *        limited to messages with timestamp not greater than 6 seconds old. This reduces the search time.
+ *        window. If the 'msg' is not found, the 'msg' will be added/overwriten in the next slot. Messages are
+ *        looked up through a hash of (opcode, element, src, dst, TID), so the cost does not depend on the
+ *        cache size.
  *        If 'transactional' is TRUE, the message will be added into the cache in the next slot even if a message
  *        exists with same TID in the last 6 seconds window. This is required for 'Transactional' messages like
  *        'Generic Delta Set' which will have same TID but 'level' param will have delta change. Such message
@@ -20,6 +20,7 @@
 
 #include "qmesh_model_common.h"
 #include "qmesh_cache_mgmt.h"
+#include "qmesh_transition_engine.h"
 
 /** \addtogroup Model_Generic_Level_Server
  * @{
@@ -108,13 +109,10 @@ DELTA_LEVEL_SIZE : LEVEL_SIZE)
 /*!\brief Transition data type.This structure contains all variables used during transition time */
 typedef struct
 {
-    uint8_t rem_count;              /*!< Remaining number of times the current value need
-                                          to be incremented/decremented by 'linearValue'*/
-    int32_t linear_value;           /*!< Value by which the current 'state' value need to be incremented/decremented linearly */
-    uint32_t step_resolution;       /*!< Periodic timer value */
-    bool adjust_step_resolution;    /*!< Check remaining transition time or linear value to adjust the current value at the end of transition */
+    uint32_t step_resolution;       /*!< Duration of one transition step in milliseconds */
+    bool indefinite;                /*!< MOVE_SET transition, the remaining time is unknown */
     uint8_t transition_time;        /*!< Transition Time with format LSB 0-5: Num of Steps, 6-7: Step Resolution */
-    QMESH_TIMER_HANDLE_T trans_timer;/*!< Current Linear transition timer handle.This timer is used to send linear values as status during transition */
+    QMESH_TRANSITION_HANDLE_T trans_ramp;/*!< Current transition in the transition engine */
     uint32_t trans_time_ms;          /*!< Transition time in milliseconds */
 } QMESH_GENERIC_LEVEL_TRANSITION_DATA_T;
 
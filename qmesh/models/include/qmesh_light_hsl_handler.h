@@ -22,6 +22,7 @@
 #include "qmesh_hal_ifce.h"
 #include "qmesh_types.h"
 #include "qmesh_cache_mgmt.h"
+#include "qmesh_transition_engine.h"
 #include "qmesh_model_common.h"
 #include "qmesh_light_hsl_hue_handler.h"
 #include "qmesh_light_hsl_saturation_handler.h"
@@ -57,17 +58,15 @@
 typedef struct
 {
   uint16_t  transition_state;               /*!< Transition State Information */
-  uint16_t  progress_time;                  /*!<  Time duration for each step  */
   uint32_t  transition_duration;            /*!<  Total transition duration    */
-  int16_t   linear_value[3];                /*!<  Value to add for each step   */
   uint16_t  target_value[3];                /*!<  Target value of the state    */
-  uint16_t  no_of_steps;                    /*!<  Total Number of steps        */
+  uint16_t  no_of_steps;                    /*!<  Remaining Number of steps    */
   uint16_t  opcode;                         /*!<  Model Opcode                 */
   uint16_t  elm_id;                         /*!<  Element address              */
   uint16_t  src_addr;                       /*!<  Source address               */
   uint8_t   step_resolution;                /*!<  Step resolution from client  */
   void*   state_data;                       /*!<  Current context information  */
-  QMESH_TIMER_HANDLE_T  timer_handle;       /*!<  Transition timer handler     */
+  QMESH_TRANSITION_HANDLE_T trans_ramp;     /*!<  Transition engine handle     */
   QMESH_ACCESS_PAYLOAD_KEY_INFO_T key_info; /*!<  Transport key information    */
 }QMESH_HSL_SERVER_TRANSITION_INFO;
 
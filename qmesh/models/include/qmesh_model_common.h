@@ -151,7 +151,7 @@ typedef void (*QMESH_MODEL_APP_CALLBACK_T) (const QMESH_NW_HEADER_INFO_T
 /* Vender Client Model IDs */
 #define QMESH_VENDOR_MODEL_CLIENT                          (0x003F002B)
 
-#define QMESH_NUM_MODEL_SOFT_TIMERS                        (35)
+#define QMESH_NUM_MODEL_SOFT_TIMERS                        (36)
 extern QMESH_TIMER_GROUP_HANDLE_T model_timer_ghdl;     /* Model Timer group handle */
 
 #define QMESH_MODELS_TOTAL_POOL_SIZE                       (MODEL_CACHE_ENTRY_SIZE * NUM_DELAY_CACHE_ENTRIES)
@@ -26,6 +26,14 @@
 #define QMESH_MAX_GENERIC_POWER_ONOFF_INSTANCES (1)
 #define QMESH_MAX_LIGHTNESS_INSTANCES           (1)
 
+/*!\brief Number of slots in the (element, model) to model context index. Must be a
+ * power of two and at least twice the number of Bluetooth SIG models in the composition
+ * data, otherwise model lookups fall back to scanning the composition data.
+ * The default of 64 indexes up to 32 models across all elements. With more, the index
+ * is not used at all and every lookup scans, so raise this with the composition.
+ */
+#define QMESH_MODEL_CONTEXT_INDEX_SIZE          (64)
+
 /* If Power Level Model is supported as part of composition data, following flag should be enabled */
 #undef QMESH_POWERLEVEL_SERVER_MODEL_ENABLE
 
@@ -27,6 +27,7 @@
 #define DBUG_MODEL_MASK_DELAY_CACHE          (1UL << 6)
 #define DBUG_MODEL_MASK_MODEL_COMMON         (1UL << 7)
 #define DBUG_MODEL_MASK_VENDOR_MODEL         (1UL << 8)
+#define DBUG_MODEL_MASK_TRANSITION           (1UL << 9)
 
 #ifndef DBUG_MODEL_MASK
 #define DBUG_MODEL_MASK ( /*DBUG_MODEL_MASK_GEN_ONOFF_SERVER |*/\
@@ -39,6 +40,7 @@
                           /*DBUG_MODEL_MASK_POWERONOFF_SERVER | */\
                           /*DBUG_MODEL_MASK_GDTT_SERVER |*/ \
                           /*DBUG_MODEL_MASK_VENDOR_MODEL |*/ \
+                          /*DBUG_MODEL_MASK_TRANSITION |*/ \
                                                    0)
 #endif
 
@@ -60,6 +60,13 @@ typedef enum {
 #define QMESH_MODEL_PS_KEY_LIST_SIZE                       (8)
 #endif /* QMESH_POWERLEVEL_SERVER_MODEL_ENABLE */
 
+/* Time (in milliseconds) model state changes are held in RAM before they are
+ * written to NVM. Changes made within this time are combined into one write.
+ */
+#ifndef QMESH_MODEL_NVM_FLUSH_DELAY_MS
+#define QMESH_MODEL_NVM_FLUSH_DELAY_MS                     (2000)
+#endif
+
 extern const QMESH_PS_KEY_INFO_T qmesh_model_ps_keys[QMESH_MODEL_PS_KEY_LIST_SIZE];
 
 /*----------------------------------------------------------------------------*
@@ -267,6 +274,17 @@ void NVMWrite_ModelLightHueState(uint8_t* state);
 void  NVMWrite_ModelGenPowerLevelState(uint8_t* state);
 #endif
 
+/*----------------------------------------------------------------------------*
+ * NVMModelFlush
+ */
+/*! \brief This function writes all pending model state changes to NVM. It must
+ *         be called before the device is reset or powered down.
+ *
+ *  \return Nothing
+ */
+/*---------------------------------------------------------------------------*/
+extern void NVMModelFlush (void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,141 @@
+/*=============================================================================
+ Copyright (c) 2018 Qualcomm Technologies International, Ltd.
+ All Rights Reserved.
+ Qualcomm Technologies International, Ltd. Confidential and Proprietary.
+============================================================================*/
+
+/*! \file qmesh_transition_engine.h
+ *  \brief Shared transition engine for the server model state ramps.
+ *   All running transitions are kept in one table and advanced from a single
+ *   soft timer. Values are computed in closed form from the start time, so a
+ *   ramp always ends exactly on its target, and ramps that change within the
+ *   same tick share one timer callback.
+ */
+/******************************************************************************/
+#ifndef __QMESH_TRANSITION_ENGINE_H__
+#define __QMESH_TRANSITION_ENGINE_H__
+
+#include "qmesh_model_common.h"
+
+/** \addtogroup Model_Transition_Engine
+* @{
+*/
+
+/* Maximum number of transitions running at the same time */
+#ifndef QMESH_MAX_TRANSITION_RAMPS
+#define QMESH_MAX_TRANSITION_RAMPS          (2 * QMESH_NUMBER_OF_ELEMENTS + 2)
+#endif
+
+/* Ramps changing within this window (in milliseconds) of the earliest one
+ * are advanced on the same tick
+ */
+#ifndef QMESH_TRANSITION_COALESCE_MS
+#define QMESH_TRANSITION_COALESCE_MS        (20u)
+#endif
+
+/* Maximum number of states moved by one ramp */
+#define QMESH_TRANSITION_MAX_VALUES         (3)
+
+/* Invalid transition handle */
+#define QMESH_TRANSITION_INVALID_HANDLE     (0)
+
+/*! \brief Transition handle. Carries a generation so a stale handle never
+ *  matches a reused table entry.
+ */
+typedef uint16_t QMESH_TRANSITION_HANDLE_T;
+
+/*! \brief Called with the interpolated values whenever one of them changes.
+ *  rem_steps is the number of steps left until the target is reached.
+ */
+typedef void (*QMESH_TRANSITION_STEP_CB_T) (QMESH_TRANSITION_HANDLE_T handle,
+                                            void *context,
+                                            const int32_t *value,
+                                            uint16_t rem_steps);
+
+/*! \brief Called once per tick per element after all of its ramps have been
+ *  stepped. Used to run the bound state update for the element.
+ */
+typedef void (*QMESH_TRANSITION_NOTIFY_CB_T) (uint16_t elm_addr, void *context);
+
+/*! \brief Called after the last step of a ramp. The handle is no longer valid. */
+typedef void (*QMESH_TRANSITION_DONE_CB_T) (QMESH_TRANSITION_HANDLE_T handle,
+                                            void *context);
+
+/*! \brief Parameters of a new ramp */
+typedef struct
+{
+    uint16_t elm_addr;                                  /*!< Element owning the states */
+    uint8_t num_values;                                 /*!< Number of states moved */
+    int32_t start[QMESH_TRANSITION_MAX_VALUES];         /*!< Values at the start of the transition */
+    int32_t target[QMESH_TRANSITION_MAX_VALUES];        /*!< Values at the end of the transition */
+    uint16_t num_steps;                                 /*!< Number of steps, 0 for an immediate change */
+    uint32_t step_ms;                                   /*!< Duration of a step in milliseconds */
+    void *context;                                      /*!< Passed back to the callbacks */
+    QMESH_TRANSITION_STEP_CB_T step_cb;                 /*!< Applies the values to the model */
+    QMESH_TRANSITION_NOTIFY_CB_T notify_cb;             /*!< Bound state update, may be NULL */
+    QMESH_TRANSITION_DONE_CB_T done_cb;                 /*!< Transition complete, may be NULL */
+} QMESH_TRANSITION_PARAMS_T;
+
+/*----------------------------------------------------------------------------*
+ *  QmeshInitTransitionEngine
+ */
+/*! \brief This function initialises the transition table
+ *
+ * \return None
+ *
+ *----------------------------------------------------------------------------*/
+extern void QmeshInitTransitionEngine(void);
+
+/*----------------------------------------------------------------------------*
+ *  QmeshDeInitTransitionEngine
+ */
+/*! \brief This function stops all transitions and de-initialises the engine
+ *
+ * \return None
+ *
+ *----------------------------------------------------------------------------*/
+extern void QmeshDeInitTransitionEngine(void);
+
+/*----------------------------------------------------------------------------*
+ *  QmeshTransitionStart
+ */
+/*! \brief This function starts a new ramp. The callbacks are always called
+ *  from the engine timer, never from this function, and without any engine
+ *  lock held. The model must check the handle under its own lock before
+ *  applying the values, as a ramp may be stopped while its tick is running.
+ *
+ * \param [in] params               Pointer to ramp parameters \ref QMESH_TRANSITION_PARAMS_T
+ *
+ * \return Transition handle or QMESH_TRANSITION_INVALID_HANDLE if the table is full
+ *
+ *----------------------------------------------------------------------------*/
+extern QMESH_TRANSITION_HANDLE_T QmeshTransitionStart(const QMESH_TRANSITION_PARAMS_T *params);
+
+/*----------------------------------------------------------------------------*
+ *  QmeshTransitionStop
+ */
+/*! \brief This function stops a ramp and invalidates the handle. The states
+ *  keep the values applied by the last step.
+ *
+ * \param [in,out] handle           Pointer to transition handle
+ *
+ * \return None
+ *
+ *----------------------------------------------------------------------------*/
+extern void QmeshTransitionStop(QMESH_TRANSITION_HANDLE_T *handle);
+
+/*----------------------------------------------------------------------------*
+ *  QmeshTransitionGetRemainingTime
+ */
+/*! \brief This function returns the time left until a ramp reaches its target
+ *
+ * \param [in] handle               Transition handle
+ *
+ * \return Remaining time in milliseconds, 0 if the handle is not running
+ *
+ *----------------------------------------------------------------------------*/
+extern uint32_t QmeshTransitionGetRemainingTime(QMESH_TRANSITION_HANDLE_T handle);
+
+/*!@} */
+
+#endif
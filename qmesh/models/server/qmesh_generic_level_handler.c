@@ -39,17 +39,24 @@ static void resetStateTransitionContext (QMESH_GENERIC_LEVEL_CONTEXT_T
  */
 static void levelPublishTimerCb (QMESH_TIMER_HANDLE_T timerHandle, void *context);
 
-/* This function is called on expiry of linear timer and changes current value
- * to target value linearly
- */
-static void levelLinearTransitionTimerCb (QMESH_TIMER_HANDLE_T timerHandle,
-        void *context);
+/* This function applies the level computed by the transition engine */
+static void levelTransitionStepCb (QMESH_TRANSITION_HANDLE_T handle,
+                                   void *context, const int32_t *value,
+                                   uint16_t rem_steps);
+
+/* This function updates the bound states after a transition step */
+static void levelTransitionNotifyCb (uint16_t elm_addr, void *context);
+
+/* This function is called when the transition engine completes a transition */
+static void levelTransitionDoneCb (QMESH_TRANSITION_HANDLE_T handle,
+                                   void *context);
 
 /* This function starts a new transition or updates the level state
  * instantaneously
  */
 static void updateLevel (QMESH_GENERIC_LEVEL_CONTEXT_T *model_context,
-                         int32_t delta_level);
+                         int32_t delta_level,
+                         const QAPP_GET_LVL_RANGE_T *range);
 
 /* The function sets the current level value */
 static void setCurrentLevel (QMESH_GENERIC_LEVEL_CONTEXT_T *model_context,
@@ -90,12 +97,10 @@ static void qmeshLevelUpdateNvm(void)
 static void resetStateTransitionContext (QMESH_GENERIC_LEVEL_CONTEXT_T
         *model_context)
 {
-    model_context->trans_data.trans_timer = QMESH_TIMER_INVALID_HANDLE;
-    model_context->trans_data.rem_count = 0;
+    model_context->trans_data.trans_ramp = QMESH_TRANSITION_INVALID_HANDLE;
+    model_context->trans_data.indefinite = FALSE;
     model_context->trans_data.step_resolution = 0;
-    model_context->trans_data.linear_value = 0;
     model_context->trans_data.trans_time_ms = 0;
-    model_context->trans_data.adjust_step_resolution = FALSE;
     model_context->trans_data.transition_time =
         QMESH_MODEL_TRANSITION_NOT_INPROGRESS;
 }
@@ -244,139 +249,124 @@ static void levelPublishTimerCb (QMESH_TIMER_HANDLE_T timerHandle, void *context
 
 /*----------------------------------------------------------------------------*
  *  NAME
- *     levelLinearTransitionTimerCb
+ *     levelTransitionStepCb
  *
  *  DESCRIPTION
- *      This function is called on the expiry of linear timer and changes
- *      current value to target value linearly
+ *      This function is called by the transition engine whenever the level
+ *      computed for the running transition changes
  *
  *  RETURNS/MODIFIES
  *      None
  *
  *----------------------------------------------------------------------------*/
-static void levelLinearTransitionTimerCb (QMESH_TIMER_HANDLE_T timerHandle,
-        void *context)
+static void levelTransitionStepCb (QMESH_TRANSITION_HANDLE_T handle,
+                                   void *context, const int32_t *value,
+                                   uint16_t rem_steps)
 {
-    QAPP_GET_LVL_RANGE_T range = {MAX_LEVEL, MIN_LEVEL};
     /* Retrieve the context */
     QMESH_GENERIC_LEVEL_CONTEXT_T *model_context =
         (QMESH_GENERIC_LEVEL_CONTEXT_T *)context;
     /* Lock the mutex */
     QmeshMutexLock (&model_context->level_mutex);
-    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_GEN_LEVEL_SERVER, "Linear Timer Expired \n");
-    /* Increment the level by the 'linear_value' value */
-    setCurrentLevel (model_context, (model_context->cur_level +
-                                     model_context->trans_data.linear_value));
 
-    /* For "MOVE_SET" messages, value should be changed indefinitely and
-     * should stop changing on reaching MAX or MIN values
-     */
-    if (model_context->trans_data.rem_count == 0xFF)
+    /* Ignore a step of a transition aborted during this tick */
+    if (model_context->trans_data.trans_ramp == handle)
     {
-        /* Call application callback handler to adjust level value as per
-        * extended model min and max values.
-        */
-        QmeshUpdateBoundStates (model_context->elm_addr, QAPP_GET_LVL_RANGE,
-                                &range);
-        /* Check if current value has reached its max or min level */
-        int32_t temp = (int32_t) model_context->cur_level +
-                     model_context->trans_data.linear_value;
-
-        if ((temp > (int32_t) range.max_val) ||
-            (temp < (int32_t) range.min_val))
-        {
-            /* As next linear value change can result in value going beyond
-             * MAX and MIN levels, stop changing now
-             */
-            model_context->trans_data.rem_count = 0;
-        }
+        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_GEN_LEVEL_SERVER,
+                          "Level step: %d, rem steps: %d\n",
+                          value[0], rem_steps);
+        model_context->cur_level = (int16_t)value[0];
     }
-    else /* For other messages, decrement the rem_count and adjust the
-          * linear_value or step_resolution if rem_count is 1
-          */
-    {
-        /* Decrement 'trans_time_ms' by 'step_resolution' and
-         * 'rem_count' by 1
-         */
-        model_context->trans_data.trans_time_ms -=
-            model_context->trans_data.step_resolution;
-        model_context->trans_data.rem_count--;
 
-        /* If rem_count is 1,adjust the linear_value or step_resolution
-         * according to 'adjust_step_resolution' flag
-         */
-        if (model_context->trans_data.rem_count == 1)
-        {
-            /* If 'adjust_step_resolution' is TRUE, make 'step_resolution'
-             * equal to remaining transition time 'trans_time_ms'
-             */
-            if (model_context->trans_data.adjust_step_resolution)
-            {
-                if (model_context->trans_data.step_resolution !=
-                    model_context->trans_data.trans_time_ms)
-                {
-                    model_context->trans_data.step_resolution =
-                        model_context->trans_data.trans_time_ms;
-                }
-            }
-            else /* Make 'linear_value' equal to remaining level 'rem_level'
-                  */
-            {
-                int16_t rem_level = model_context->target_level -
-                                  model_context->cur_level;
+    /* Unlock the mutex */
+    QmeshMutexUnlock (&model_context->level_mutex);
+}
 
-                if (model_context->trans_data.linear_value != rem_level)
-                    model_context->trans_data.linear_value = rem_level;
-            }
-        }
-    }
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *     levelTransitionNotifyCb
+ *
+ *  DESCRIPTION
+ *      This function writes the level to NVM and updates the bound states
+ *      once per transition engine tick
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void levelTransitionNotifyCb (uint16_t elm_addr, void *context)
+{
+    /* Retrieve the context */
+    QMESH_GENERIC_LEVEL_CONTEXT_T *model_context =
+        (QMESH_GENERIC_LEVEL_CONTEXT_T *)context;
+    /* Lock the mutex */
+    QmeshMutexLock (&model_context->level_mutex);
+    /* Update NVM */
+    qmeshLevelUpdateNvm();
+    /* Call Application Callback handler. Send the event to the hardware */
+    QmeshUpdateBoundStates (elm_addr, QAPP_LVL_UPDATED,
+                            (void *) (&model_context->cur_level));
+    /* Unlock the mutex */
+    QmeshMutexUnlock (&model_context->level_mutex);
+}
 
-    /* If 'rem_count' is non-zero, restart the transition timer for
-     * 'step_resolution' time
-     */
-    if (model_context->trans_data.rem_count)
-    {
-       /* Start the timer of time value 'step_resolution'*/
-        model_context->trans_data.trans_timer = QmeshTimerCreate (&model_timer_ghdl,
-                                                                  levelLinearTransitionTimerCb,
-                                                                  (void *)model_context,
-                                                                  model_context->trans_data.step_resolution);
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *     levelTransitionDoneCb
+ *
+ *  DESCRIPTION
+ *      This function is called when the transition engine reaches the target
+ *      level. Resets the transition and sends status message to assigned
+ *      publication address
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void levelTransitionDoneCb (QMESH_TRANSITION_HANDLE_T handle,
+                                   void *context)
+{
+    /* Retrieve the context */
+    QMESH_GENERIC_LEVEL_CONTEXT_T *model_context =
+        (QMESH_GENERIC_LEVEL_CONTEXT_T *)context;
+    /* Lock the mutex */
+    QmeshMutexLock (&model_context->level_mutex);
 
-        if(model_context->trans_data.trans_timer == QMESH_TIMER_INVALID_HANDLE)
-        {
-            DEBUG_MODEL_ERROR (DBUG_MODEL_MASK_GEN_LEVEL_SERVER,
-                               "Linear Transition Timer Creation Failed\n");
-        }
-    }
-    else /* If 'rem_count' is zero, transition is complete. Reset transition
-          * related variables and send status message to assigned
-          * publication address
-          */
+    if (model_context->trans_data.trans_ramp != handle)
     {
-        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_GEN_LEVEL_SERVER,
-                          "Linear Transition complete\n");
-        /* Reset transition related variables */
-        resetStateTransitionContext (model_context);
-
-        /* Publish status message after transition is complete */
-        if (model_context->publish_state->publish_addr != QMESH_UNASSIGNED_ADDRESS)
-            QmeshGenericLevelStatusPublish (model_context);
-
-        if (model_context ->publish_timer != QMESH_TIMER_INVALID_HANDLE)
-            QmeshTimerDelete (&model_timer_ghdl,&model_context->publish_timer);
+        /* Transition was aborted during this tick */
+        QmeshMutexUnlock (&model_context->level_mutex);
+        return;
+    }
 
-        /* If publish time is valid (non-zero) start the publish timer */
-        if (model_context->publish_interval != 0 &&
-            model_context->publish_state->publish_addr != QMESH_UNASSIGNED_ADDRESS &&
-            ((model_context->publish_timer = QmeshTimerCreate (&model_timer_ghdl,
-                   levelPublishTimerCb,
-                   (void *)model_context,
-                   model_context->publish_interval))
-                   == QMESH_TIMER_INVALID_HANDLE))
-        {
-            DEBUG_MODEL_ERROR (DBUG_MODEL_MASK_GEN_LEVEL_SERVER,
-                               "Publish Timer Creation Failed > 2 secs\n");
-        }
+    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_GEN_LEVEL_SERVER,
+                      "Linear Transition complete\n");
+
+    /* A MOVE_SET stops short of the range limit it was heading to */
+    if (model_context->trans_data.indefinite)
+        model_context->target_level = model_context->cur_level;
+
+    /* Reset transition related variables */
+    resetStateTransitionContext (model_context);
+
+    /* Publish status message after transition is complete */
+    if (model_context->publish_state->publish_addr != QMESH_UNASSIGNED_ADDRESS)
+        QmeshGenericLevelStatusPublish (model_context);
+
+    if (model_context ->publish_timer != QMESH_TIMER_INVALID_HANDLE)
+        QmeshTimerDelete (&model_timer_ghdl,&model_context->publish_timer);
+
+    /* If publish time is valid (non-zero) start the publish timer */
+    if (model_context->publish_interval != 0 &&
+        model_context->publish_state->publish_addr != QMESH_UNASSIGNED_ADDRESS &&
+        ((model_context->publish_timer = QmeshTimerCreate (&model_timer_ghdl,
+               levelPublishTimerCb,
+               (void *)model_context,
+               model_context->publish_interval))
+               == QMESH_TIMER_INVALID_HANDLE))
+    {
+        DEBUG_MODEL_ERROR (DBUG_MODEL_MASK_GEN_LEVEL_SERVER,
+                           "Publish Timer Creation Failed > 2 secs\n");
     }
 
     /* Unlock the mutex */
@@ -396,8 +386,10 @@ static void levelLinearTransitionTimerCb (QMESH_TIMER_HANDLE_T timerHandle,
  *
  *----------------------------------------------------------------------------*/
 static void updateLevel (QMESH_GENERIC_LEVEL_CONTEXT_T *model_context,
-                         int32_t delta_level)
+                         int32_t delta_level,
+                         const QAPP_GET_LVL_RANGE_T *range)
 {
+    QMESH_TRANSITION_PARAMS_T params;
     uint8_t num_steps, step_resolution;
     /* Retrieve 'num_steps' from 'transition_time' */
     num_steps =
@@ -445,47 +437,49 @@ static void updateLevel (QMESH_GENERIC_LEVEL_CONTEXT_T *model_context,
         model_context->trans_data.trans_time_ms =
             num_steps * (model_context->trans_data.step_resolution);
 
-        /* Set transition values for'MOVE_SET' messages.As 'MOVE_SET is
-         * indefinite, rem_count is set to 0xFF
+        QmeshMemSet (&params, 0, sizeof (params));
+        params.elm_addr = model_context->elm_addr;
+        params.num_values = 1;
+        params.start[0] = model_context->cur_level;
+        params.context = (void *)model_context;
+        params.step_cb = levelTransitionStepCb;
+        params.notify_cb = levelTransitionNotifyCb;
+        params.done_cb = levelTransitionDoneCb;
+
+        /* 'MOVE_SET' is indefinite: the level moves by 'delta_level' every
+         * 'trans_time_ms' until the next move would leave the level range.
+         * The range is read once here, so the move is a ramp with a known
+         * number of steps.
          */
-        if (model_context->trans_data.rem_count == INVALID_INDEX)
+        if (model_context->trans_data.indefinite)
         {
-            /* Set 'step_resolution' equal to 'trans_time_ms'in milliseconds */
-            model_context->trans_data.step_resolution =
-                model_context->trans_data.trans_time_ms;
-            /* Set 'linear_value' equal to 'delta_level' */
-            model_context->trans_data.linear_value = delta_level;
+            int32_t bound = (delta_level > 0) ? (int32_t)range->max_val :
+                                                (int32_t)range->min_val;
+            int32_t moves = (bound - (int32_t)model_context->cur_level) /
+                            delta_level;
+
+            if (moves < 0)
+                moves = 0;
+
+            params.num_steps = (uint16_t)moves;
+            params.step_ms = model_context->trans_data.trans_time_ms;
+            params.target[0] = (int32_t)model_context->cur_level +
+                               delta_level * moves;
         }
-        else /* Set transition values for other level messages */
+        else
         {
-            if (ABS_VAL (delta_level) >= num_steps)
-            {
-                model_context->trans_data.rem_count = num_steps;
-                model_context->trans_data.linear_value = delta_level / num_steps;
-                model_context->trans_data.adjust_step_resolution = FALSE;
-            }
-            else
-            {
-                model_context->trans_data.rem_count =  ABS_VAL (delta_level);
-                model_context->trans_data.linear_value =
-                    (delta_level < 0 ? -1 : 1);
-                model_context->trans_data.step_resolution *=
-                    (num_steps / ABS_VAL (delta_level));
-                model_context->trans_data.adjust_step_resolution = TRUE;
-            }
+            params.num_steps = num_steps;
+            params.step_ms = model_context->trans_data.step_resolution;
+            params.target[0] = model_context->target_level;
         }
 
-        /* Start the transition timer of time 'step_resolution' for
-         * 'rem_count' number of times
-         */
-        model_context->trans_data.trans_timer = QmeshTimerCreate(&model_timer_ghdl,
-                                                       levelLinearTransitionTimerCb, (void *)model_context,
-                                                       model_context->trans_data.step_resolution);
+        /* Hand the transition over to the transition engine */
+        model_context->trans_data.trans_ramp = QmeshTransitionStart (&params);
 
-        if (model_context->trans_data.trans_timer == QMESH_TIMER_INVALID_HANDLE)
+        if (model_context->trans_data.trans_ramp == QMESH_TRANSITION_INVALID_HANDLE)
         {
             DEBUG_MODEL_ERROR (DBUG_MODEL_MASK_GEN_LEVEL_SERVER,
-                               "Linear Transition Timer Creation Failed\n");
+                               "Linear Transition Start Failed\n");
         }
 
         /* Send additional status message if transition time is greater than or equal to 2 secs.
@@ -553,7 +547,7 @@ static void getGenericLevelStatus (QMESH_GENERIC_LEVEL_CONTEXT_T
     }
     else  /* Transition in progress */
     {
-        if (model_context->trans_data.rem_count == INVALID_INDEX)
+        if (model_context->trans_data.indefinite)
         {
             model_context->status[6] = QMESH_MODEL_UNKNOWN_TRANSITION_TIME;
         }
@@ -561,7 +555,8 @@ static void getGenericLevelStatus (QMESH_GENERIC_LEVEL_CONTEXT_T
         {
             model_context->status[6] =
                 QmeshConvertTimeToTransitionTimeFormat (
-                    model_context->trans_data.trans_time_ms);
+                    QmeshTransitionGetRemainingTime (
+                        model_context->trans_data.trans_ramp));
         }
     }
 
@@ -1151,8 +1146,8 @@ extern void QmeshGenericLevelTransitionHandler (QMESH_MODEL_MSG_T *model_msg,
                      model_context->trans_data.transition_time)) &&
                 (move_set_level != 0))
             {
-                /* Set 'rem_count' as 0xFF as it is indefinite */
-                model_context->trans_data.rem_count = INVALID_INDEX;
+                /* 'MOVE_SET' is indefinite */
+                model_context->trans_data.indefinite = TRUE;
                 /* Set 'delta_level' value */
                 delta_level = (int32_t) move_set_level;
                 /* Adjust delta level value */
@@ -1185,7 +1180,7 @@ extern void QmeshGenericLevelTransitionHandler (QMESH_MODEL_MSG_T *model_msg,
     /* Update level */
     if (delta_level != 0)
     {
-        updateLevel (model_context, delta_level);
+        updateLevel (model_context, delta_level, &range);
     }
 
     /* Send the level status */
@@ -1217,11 +1212,11 @@ extern void QmeshGenericLevelAbortTransition (QMESH_GENERIC_LEVEL_CONTEXT_T
         DEBUG_MODEL_INFO (DBUG_MODEL_MASK_GEN_LEVEL_SERVER,
                           "Transition aborted\n");
 
-        /* Delete the currently running transition timer */
-        if (model_context->trans_data.trans_timer != QMESH_TIMER_INVALID_HANDLE)
+        /* Stop the currently running transition */
+        if (model_context->trans_data.trans_ramp != QMESH_TRANSITION_INVALID_HANDLE)
         {
-            /* Delete the linear transition timer */
-            QmeshTimerDelete (&model_timer_ghdl,&model_context->trans_data.trans_timer);
+            /* Remove the transition from the transition engine */
+            QmeshTransitionStop (&model_context->trans_data.trans_ramp);
             /* Delete the publication timer */
             QmeshTimerDelete (&model_timer_ghdl,&model_context->publish_timer);
             /* Delete the publication retransmission timer */
@@ -181,143 +181,134 @@ static void qmeshLightHslPublishTimerCb (QMESH_TIMER_HANDLE_T timerHandle,
 
 /*----------------------------------------------------------------------------*
  *  NAME
- *      lightHslServerTransitionTimer
+ *      lightHslTransitionStepCb
  *
  *  DESCRIPTION
- *      This function lineraly increments the value after transition timer
- *      expiry and restarts the transition timer for next linear value change.
+ *      This function is called by the transition engine whenever the
+ *      lightness, hue or saturation computed for the running transition
+ *      changes.
  *
  *  RETURNS/MODIFIES
  *      None
  *
  *----------------------------------------------------------------------------*/
-static void lightHslServerTransitionTimer (QMESH_TIMER_HANDLE_T timerHandle,
-        void *context)
+static void lightHslTransitionStepCb (QMESH_TRANSITION_HANDLE_T handle,
+                                      void *context, const int32_t *value,
+                                      uint16_t rem_steps)
 {
     /* Extract transition state information and lightness context data */
     QMESH_LIGHT_HSL_MODEL_CONTEXT_T *model_context = \
             (QMESH_LIGHT_HSL_MODEL_CONTEXT_T *)context;
     QMESH_HSL_SERVER_TRANSITION_INFO *p_info = \
             (QMESH_HSL_SERVER_TRANSITION_INFO *) (&model_context->hsl_transition);
-    /* Delete the current transition timer */
-    QmeshTimerDelete(&model_timer_ghdl,&p_info->timer_handle);
-    /* Print that a transition is in progress */
-    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER, "Transition In Progress\n");
-    /* Decrement the step count */
-    p_info->no_of_steps--;
 
-    /* check what is the present state of the transition & update context*/
-    switch (p_info->transition_state)
+    QmeshMutexLock (&model_context->mutex_handle);
+
+    /* Ignore a step of a transition aborted during this tick */
+    if (p_info->trans_ramp != handle)
     {
-        case QMESH_TRANSITION_BEGIN:
-        case QMESH_TRANSITION_IN_PROGRESS:
-        {
-            /* Update NVM with transition information */
-            qmeshLightHslUpdateNvm(model_context);
-             
-            /* Stop publishing status messages */
-            if (model_context ->publish_timer != QMESH_TIMER_INVALID_HANDLE)
-                QmeshTimerDelete (&model_timer_ghdl,&model_context->publish_timer);
-
-            if (model_context ->publish_retrans_timer != QMESH_TIMER_INVALID_HANDLE)
-                QmeshTimerDelete (&model_timer_ghdl,&model_context->publish_retrans_timer);
-
-            /* Initiate transition to the target state and send 'status' */
-            QmeshMutexLock (&model_context->mutex_handle);
-            model_context->light_hsl_lightness = (int16_t) (
-                    model_context->light_hsl_lightness) + \
-                                                 p_info->linear_value[0];
-            model_context->hue_context->light_hsl_hue = (int16_t) (
-                        model_context->hue_context->light_hsl_hue) + \
-                    p_info->linear_value[1];
-            model_context->sat_context->light_hsl_sat = (int16_t) (
-                        model_context->sat_context->light_hsl_sat) + \
-                    p_info->linear_value[2];
-            QmeshMutexUnlock (&model_context->mutex_handle);
-
-            /* Check whether we have reached the final step */
-            if (p_info->no_of_steps == 1)
-            {
-                /* Set the transition state to End */
-                p_info->transition_state = QMESH_TRANSITION_END;
-            }
-            else
-            {
-                /* Set the transition state to in progress */
-                p_info->transition_state = QMESH_TRANSITION_IN_PROGRESS;
-            }
+        QmeshMutexUnlock (&model_context->mutex_handle);
+        return;
+    }
 
-            /* Restart the timer */
-            p_info->timer_handle = QmeshTimerCreate (&model_timer_ghdl,
-                                                     lightHslServerTransitionTimer,
-                                                     (void *)model_context,
-                                                     p_info->progress_time);
+    /* Print that a transition is in progress */
+    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER, "Transition In Progress\n");
+    model_context->light_hsl_lightness = (uint16_t)value[0];
+    model_context->hue_context->light_hsl_hue = (uint16_t)value[1];
+    model_context->sat_context->light_hsl_sat = (uint16_t)value[2];
+    p_info->no_of_steps = rem_steps;
+    p_info->transition_state = QMESH_TRANSITION_IN_PROGRESS;
+    QmeshMutexUnlock (&model_context->mutex_handle);
+
+    /* Update NVM with transition information */
+    qmeshLightHslUpdateNvm(model_context);
 
-            if(p_info->timer_handle == QMESH_TIMER_INVALID_HANDLE)
-            {
-                DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER, "Transition Timer Failed\n");
-            }
+    /* Stop publishing status messages */
+    if (model_context ->publish_timer != QMESH_TIMER_INVALID_HANDLE)
+        QmeshTimerDelete (&model_timer_ghdl,&model_context->publish_timer);
 
-            /* Update Bound States for other models*/
-            QmeshUpdateBoundStates (model_context->elm_id,
-                                    QAPP_LIGHT_HSL_UPDATED,
-                                    &model_context->light_hsl_lightness);
-        }
-        break;
+    if (model_context ->publish_retrans_timer != QMESH_TIMER_INVALID_HANDLE)
+        QmeshTimerDelete (&model_timer_ghdl,&model_context->publish_retrans_timer);
+}
 
-        case QMESH_TRANSITION_END:
-        {
-            /* Mark the transition state to idles */
-            p_info->transition_state = QMESH_TRANSITION_IDLE;
-            DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER, "Transition Ended\n");
-            QmeshMutexLock (&model_context->mutex_handle);
-            model_context->light_hsl_lightness = p_info->target_value[0];
-            QmeshLightHslHueUpdate (model_context->hue_context, p_info->target_value[1]);
-            QmeshLightHslSatUpdate (model_context->sat_context, p_info->target_value[2]);
-            QmeshMutexUnlock (&model_context->mutex_handle);
-            /* reset g_hsltrans_time */
-            g_hsltrans_time = 0;
-            /* Update Bound States for other models*/
-            QmeshUpdateBoundStates (model_context->elm_id,
-                                    QAPP_LIGHT_HSL_UPDATED,
-                                    &model_context->light_hsl_lightness);
-            /* Reset all the target values to zero as transition is complete */
-            model_context->light_target_hsl = 0;            
-            model_context->light_target_hue = 0;            
-            model_context->light_target_sat = 0;            
-            qmeshLightHslUpdateNvm(model_context);                                    
-
-            /* If publish time is valid (non-zero) start the publish timer */
-            if (model_context->publish_interval != 0 &&
-                model_context->publish_state->publish_addr != QMESH_UNASSIGNED_ADDRESS &&
-                ((model_context->publish_timer = QmeshTimerCreate (&model_timer_ghdl,
-                   qmeshLightHslPublishTimerCb,
-                   (void *)model_context,
-                   model_context->publish_interval))
-                   == QMESH_TIMER_INVALID_HANDLE))
-            {
-                DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER,
-                                  "Publish Timer Creation Failed \n");
-            }
-        }
-        break;
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      lightHslTransitionNotifyCb
+ *
+ *  DESCRIPTION
+ *      This function updates the bound states once per transition engine
+ *      tick.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void lightHslTransitionNotifyCb (uint16_t elm_addr, void *context)
+{
+    QMESH_LIGHT_HSL_MODEL_CONTEXT_T *model_context = \
+            (QMESH_LIGHT_HSL_MODEL_CONTEXT_T *)context;
 
-        case QMESH_TRANSITION_ABORTING:
-        {
+    /* Update Bound States for other models*/
+    QmeshUpdateBoundStates (elm_addr,
+                            QAPP_LIGHT_HSL_UPDATED,
+                            &model_context->light_hsl_lightness);
+}
 
-            /* No more transition. Update g_trans_time */
-            g_hsltrans_time = 0;
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      lightHslTransitionDoneCb
+ *
+ *  DESCRIPTION
+ *      This function is called when the transition engine reaches the target
+ *      state. Ends the transition and restarts the periodic publication.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void lightHslTransitionDoneCb (QMESH_TRANSITION_HANDLE_T handle,
+                                      void *context)
+{
+    QMESH_LIGHT_HSL_MODEL_CONTEXT_T *model_context = \
+            (QMESH_LIGHT_HSL_MODEL_CONTEXT_T *)context;
+    QMESH_HSL_SERVER_TRANSITION_INFO *p_info = \
+            (QMESH_HSL_SERVER_TRANSITION_INFO *) (&model_context->hsl_transition);
 
-            /* Set the transition state back to idle */
-            model_context->hsl_transition.transition_state = QMESH_TRANSITION_IDLE;
+    QmeshMutexLock (&model_context->mutex_handle);
 
-            DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER,
-                              "HSL Transition Aborted\n");
-        }
-        break;
+    if (p_info->trans_ramp != handle)
+    {
+        /* Transition was aborted during this tick */
+        QmeshMutexUnlock (&model_context->mutex_handle);
+        return;
+    }
 
-        default:
-            break;
+    /* Mark the transition state to idles */
+    p_info->trans_ramp = QMESH_TRANSITION_INVALID_HANDLE;
+    p_info->transition_state = QMESH_TRANSITION_IDLE;
+    DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER, "Transition Ended\n");
+    QmeshLightHslHueUpdate (model_context->hue_context, p_info->target_value[1]);
+    QmeshLightHslSatUpdate (model_context->sat_context, p_info->target_value[2]);
+    QmeshMutexUnlock (&model_context->mutex_handle);
+    /* reset g_hsltrans_time */
+    g_hsltrans_time = 0;
+    /* Reset all the target values to zero as transition is complete */
+    model_context->light_target_hsl = 0;
+    model_context->light_target_hue = 0;
+    model_context->light_target_sat = 0;
+    qmeshLightHslUpdateNvm(model_context);
+
+    /* If publish time is valid (non-zero) start the publish timer */
+    if (model_context->publish_interval != 0 &&
+        model_context->publish_state->publish_addr != QMESH_UNASSIGNED_ADDRESS &&
+        ((model_context->publish_timer = QmeshTimerCreate (&model_timer_ghdl,
+           qmeshLightHslPublishTimerCb,
+           (void *)model_context,
+           model_context->publish_interval))
+           == QMESH_TIMER_INVALID_HANDLE))
+    {
+        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER,
+                          "Publish Timer Creation Failed \n");
     }
 }
 
@@ -557,12 +548,10 @@ static void qmeshLightHSLServerTransitionHandler (QMESH_MODEL_MSG_T *model_msg,
     /* Retreive opcode */
     uint16_t opcode = model_msg->cmn_msg.opcode;
 
+    QMESH_TRANSITION_PARAMS_T params;
+
     /* Abort any previous transition if ongoing */
-    if (model_context->hsl_transition.transition_state ==
-        QMESH_TRANSITION_IN_PROGRESS)
-    {
-        QmeshLightHSLAbortTransition (model_context);
-    }
+    QmeshLightHSLAbortTransition (model_context);
 
     if (model_context->publish_timer != QMESH_TIMER_INVALID_HANDLE)
         QmeshTimerDelete (&model_timer_ghdl,&model_context->publish_timer);
@@ -633,22 +622,26 @@ static void qmeshLightHSLServerTransitionHandler (QMESH_MODEL_MSG_T *model_msg,
 
     /* preserve the context data to be used in transition */
     model_context->hsl_transition.state_data          = (void *)model_context;
-    /* Calculate interpolated value for HSL Light State */
-    model_context->hsl_transition.linear_value[0]  = \
-            ((model_context->hsl_transition.target_value[0] - model_context-> \
-              light_hsl_lightness ) / model_context->hsl_transition.no_of_steps);
-    /* Calculate interpolated value for HSL Hue State */
-    model_context->hsl_transition.linear_value[1]  = \
-            ((model_context->hsl_transition.target_value[1] - model_context-> \
-              hue_context->light_hsl_hue ) / model_context->hsl_transition.no_of_steps);
-    /* Calculate interpolated value for HSL Sat State */
-    model_context->hsl_transition.linear_value[2]  = \
-            ((model_context->hsl_transition.target_value[2] - model_context-> \
-              sat_context->light_hsl_sat ) / model_context->hsl_transition.no_of_steps);
-    /* Find the progress time for each step based on transition duration and no of steps*/
-    model_context->hsl_transition.progress_time = \
-            model_context->hsl_transition.transition_duration /
-            model_context->hsl_transition.no_of_steps;
+    /* The transition engine interpolates lightness, hue and saturation
+     * together from the values at the start of the transition
+     */
+    QmeshMemSet (&params, 0, sizeof (params));
+    params.elm_addr = model_context->elm_id;
+    params.num_values = 3;
+    params.start[0] = model_context->light_hsl_lightness;
+    params.start[1] = model_context->hue_context->light_hsl_hue;
+    params.start[2] = model_context->sat_context->light_hsl_sat;
+    params.target[0] = model_context->hsl_transition.target_value[0];
+    params.target[1] = model_context->hsl_transition.target_value[1];
+    params.target[2] = model_context->hsl_transition.target_value[2];
+    params.num_steps = model_context->hsl_transition.no_of_steps;
+    params.step_ms = (params.num_steps) ?
+                     (model_context->hsl_transition.transition_duration /
+                      params.num_steps) : 0;
+    params.context = (void *)model_context;
+    params.step_cb = lightHslTransitionStepCb;
+    params.notify_cb = lightHslTransitionNotifyCb;
+    params.done_cb = lightHslTransitionDoneCb;
     /* Preserve the key info to transmit status information during transition */
     QmeshMemCpy (&model_context->hsl_transition.key_info,
                  &model_msg->key_info,
@@ -669,10 +662,15 @@ static void qmeshLightHSLServerTransitionHandler (QMESH_MODEL_MSG_T *model_msg,
     }
 
     /* Begin the transition Process finally */
-    model_context->hsl_transition.timer_handle = QmeshTimerCreate (&model_timer_ghdl,
-                      lightHslServerTransitionTimer,
-                      (void *)model_context,
-                      model_context->hsl_transition.progress_time);
+    QmeshMutexLock (&model_context->mutex_handle);
+    model_context->hsl_transition.trans_ramp = QmeshTransitionStart (&params);
+    QmeshMutexUnlock (&model_context->mutex_handle);
+
+    if (model_context->hsl_transition.trans_ramp == QMESH_TRANSITION_INVALID_HANDLE)
+    {
+        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER, "Transition Start Failed\n");
+        model_context->hsl_transition.transition_state = QMESH_TRANSITION_IDLE;
+    }
 }
 
 /*============================================================================*
@@ -1078,11 +1076,18 @@ extern void QmeshLightHSLAbortTransition (QMESH_LIGHT_HSL_MODEL_CONTEXT_T
        QmeshTimerDelete (&model_timer_ghdl,&model_context->publish_retrans_timer);
 
     /* Abort any previous transition if ongoing */
+    QmeshMutexLock (&model_context->mutex_handle);
+
     if (model_context->hsl_transition.transition_state == QMESH_TRANSITION_IN_PROGRESS ||
         model_context->hsl_transition.transition_state == QMESH_TRANSITION_BEGIN)
     {
-      model_context->hsl_transition.transition_state = QMESH_TRANSITION_ABORTING;
+        QmeshTransitionStop (&model_context->hsl_transition.trans_ramp);
+        model_context->hsl_transition.transition_state = QMESH_TRANSITION_IDLE;
+        DEBUG_MODEL_INFO (DBUG_MODEL_MASK_LIGHTNESS_SERVER,
+                          "HSL Transition Aborted\n");
     }
+
+    QmeshMutexUnlock (&model_context->mutex_handle);
 }
 
 /*----------------------------------------------------------------------------*
@@ -1099,7 +1104,10 @@ extern QMESH_RESULT_T QmeshLightHSLServerAppInit (QMESH_LIGHT_HSL_MODEL_CONTEXT_
         *context)
 {
     if (context)
+    {
         context->hsl_transition.transition_state = QMESH_TRANSITION_IDLE;
+        context->hsl_transition.trans_ramp = QMESH_TRANSITION_INVALID_HANDLE;
+    }
 
     if (QmeshMutexCreate (&context->mutex_handle) != QMESH_RESULT_SUCCESS)
     {
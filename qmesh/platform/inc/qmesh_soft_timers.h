@@ -10,8 +10,10 @@
  *
  *  DESCRIPTION
  *      This file provides functionality to maintain a groups of virtual timers.
- *      1 system timer is used for one group. Max. no. of timers can be set
- *      using - MAX_VIRTUAL_TIMERS (64 default)
+ *      1 system timer is used for one group. The number of timers in a group
+ *      is set when the group is created. QCA402x builds made with
+ *      CFG_FEATURE_QMESH_TIMER_WHEEL=true keep the timers of a group in a
+ *      hierarchical timing wheel (O(1) start and delete).
  *****************************************************************************/
 #ifndef __QMESH_SOFT_TIMERS_H__
 #define __QMESH_SOFT_TIMERS_H__
@@ -22,7 +24,7 @@
 /******************************************************************************
  *Timer Configurations
  *****************************************************************************/
-#define MAX_VIRTUAL_TIMERS           (64)   /* Total virtual timers supported */
+#define MAX_VIRTUAL_TIMERS           (64)   /* Total virtual timers supported by pool based memory */
 #define MAX_TIMER_GROUPS             (4)    /* MAX hardware timers */
 
 /*! \brief Handle for a timer group*/
@@ -72,7 +74,8 @@ void QmeshDeinitializeTimerContext (void);
  * QmeshTimerCreateGroup
  */
 /*! \brief This function creates a timer group. Each timer groups uses a single
- *         system timer for all its soft timers.
+ *         system timer for all its soft timers. Memory for \p no_of_timers
+ *         timers is reserved when the group is created.
  *
  *  \param[in] no_of_timers Number of timers to be reserved for this group.
  *
@@ -0,0 +1,893 @@
+/******************************************************************************
+ Copyright (c) 2017-2018 Qualcomm Technologies International, Ltd.
+ All Rights Reserved.
+ Qualcomm Technologies International, Ltd. Confidential and Proprietary.
+ ******************************************************************************/
+/*! \file qmesh_soft_timers.c
+ *  \brief Soft timers for the QCA402x platform
+ *
+ *   Each timer group keeps its soft timers in a hierarchical timing wheel with
+ *   a millisecond tick. Four levels of 64 slots cover about 4.6 hours; longer
+ *   timers are parked in the top level and re-filed as the wheel turns.
+ *   Starting and cancelling a timer is O(1). One system timer per group is
+ *   armed for the next slot that has work, and a single dispatch thread
+ *   collects all due timers of a group in one pass before invoking their
+ *   callbacks. The number of timers in a group is set when it is created.
+ *
+ *   The stock soft timers are part of the prebuilt qmesh.lib. This file is
+ *   only built with CFG_FEATURE_QMESH_TIMER_WHEEL=true, in which case its
+ *   object is linked ahead of the library and its symbols are used instead.
+ *   The whole qmesh_soft_timers.h API must then stay defined here, and the
+ *   link map should be checked to confirm no library timer object is pulled
+ *   in as well.
+ */
+/******************************************************************************/
+#include "qmesh_data_types.h"
+#include "qmesh_hal_ifce.h"
+#include "qmesh_soft_timers.h"
+#include "qurt_error.h"
+#include "qurt_signal.h"
+#include "qurt_thread.h"
+#include "qurt_timer.h"
+#include "qapi_timer.h"
+
+/* Wheel geometry: TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots */
+#define TIMER_WHEEL_SLOT_BITS           (6u)
+#define TIMER_WHEEL_SLOTS               (1u << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK           (TIMER_WHEEL_SLOTS - 1u)
+#define TIMER_WHEEL_LEVELS              (4u)
+
+/* List ids: wheel slots first, then the list of expired timers */
+#define TIMER_LIST_EXPIRED              (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS)
+#define TIMER_LIST_COUNT                (TIMER_LIST_EXPIRED + 1u)
+#define TIMER_LIST_NONE                 (0xFFFFu)
+
+/* End of a timer list */
+#define TIMER_NIL                       (0xFFFFu)
+
+/* Largest number of timers in a group, limited by the 16 bit list links */
+#define TIMER_GROUP_MAX_TIMERS          (0xFFFEu)
+
+/* Returned by timerNextEvent when the wheel is empty */
+#define TIMER_NO_EVENT                  (0xFFFFFFFFFFFFFFFFull)
+
+/* Dispatch thread configuration */
+#define TIMER_THREAD_PRIORITY           (9)
+#define TIMER_THREAD_STACK_SIZE         (3072)
+
+/* Event bit per group, one bit per entry of the group table */
+#define TIMER_GROUP_EVENT(id)           (1u << (id))
+#define TIMER_ALL_GROUP_EVENTS          ((1u << MAX_TIMER_GROUPS) - 1u)
+
+#if (MAX_TIMER_GROUPS > 31)
+#error "MAX_TIMER_GROUPS must fit in the dispatch thread event mask"
+#endif
+
+/* Soft timer */
+typedef struct
+{
+    QMESH_TIMER_CALLBACK_T  cb;         /* Callback, NULL when the timer is free */
+    void                   *params;     /* Callback data */
+    uint64_t                expiry;     /* Absolute expiry in wheel ticks (ms) */
+    uint16_t                next;       /* Next timer in the list */
+    uint16_t                prev;       /* Previous timer in the list */
+    uint16_t                list;       /* List holding the timer or TIMER_LIST_NONE */
+    uint16_t                gen;        /* Bumped on release to invalidate stale handles */
+} QMESH_SOFT_TIMER_T;
+
+/* Timer group */
+typedef struct
+{
+    QMESH_SOFT_TIMER_T     *timers;                             /* Timers reserved for the group */
+    uint16_t                capacity;                           /* Number of entries in 'timers' */
+    uint16_t                free_head;                          /* First free timer */
+    uint16_t                head[TIMER_LIST_COUNT];             /* First timer in every list */
+    uint64_t                occupied[TIMER_WHEEL_LEVELS];       /* Non-empty slots per level */
+    uint64_t                cur;                                /* Last processed wheel tick */
+    uint64_t                armed;                              /* Tick the system timer is set for */
+    qapi_TIMER_handle_t     hw_timer;                           /* System timer of the group */
+    uint8_t                 id;                                 /* Index in the group table */
+} QMESH_TIMER_GROUP_T;
+
+/* Timer context */
+typedef struct
+{
+    bool                    initialized;
+    bool                    thread_started;
+    QMESH_MUTEX_T           mutex;                              /* Protects all groups */
+    qurt_signal_t           event;                              /* Group expiry events */
+    QMESH_TIMER_GROUP_T    *group[MAX_TIMER_GROUPS];
+    uint64_t                clock_ticks;                        /* Extended system tick count */
+    qurt_time_t             last_ticks;                         /* Last raw system tick count */
+    uint32_t                ticks_per_sec;
+} QMESH_TIMER_CONTEXT_T;
+
+static QMESH_TIMER_CONTEXT_T timer_ctx;
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerNow
+ *
+ *  DESCRIPTION
+ *      Returns the current time in milliseconds. The 32 bit system tick count
+ *      is extended to 64 bits so that the wheel never wraps.
+ *
+ *  RETURNS/MODIFIES
+ *      Current time in milliseconds
+ *
+ *----------------------------------------------------------------------------*/
+static uint64_t timerNow (void)
+{
+    qurt_time_t ticks = qurt_timer_get_ticks();
+
+    timer_ctx.clock_ticks += (uint32_t)(ticks - timer_ctx.last_ticks);
+    timer_ctx.last_ticks = ticks;
+
+    return (timer_ctx.clock_ticks * 1000u) / timer_ctx.ticks_per_sec;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerLowestBit
+ *
+ *  DESCRIPTION
+ *      Returns the position of the least significant set bit of a non-zero
+ *      value.
+ *
+ *  RETURNS/MODIFIES
+ *      Bit position
+ *
+ *----------------------------------------------------------------------------*/
+static uint8_t timerLowestBit (uint64_t v)
+{
+    uint8_t n = 0;
+
+    if ((uint32_t)v == 0) { v >>= 32; n += 32; }
+    if ((v & 0xFFFFu) == 0) { v >>= 16; n += 16; }
+    if ((v & 0xFFu) == 0) { v >>= 8; n += 8; }
+    if ((v & 0xFu) == 0) { v >>= 4; n += 4; }
+    if ((v & 0x3u) == 0) { v >>= 2; n += 2; }
+    if ((v & 0x1u) == 0) { n += 1; }
+
+    return n;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerListAdd
+ *
+ *  DESCRIPTION
+ *      Adds a timer to the head of a list.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void timerListAdd (QMESH_TIMER_GROUP_T *g, uint16_t idx, uint16_t list)
+{
+    QMESH_SOFT_TIMER_T *t = &g->timers[idx];
+
+    t->list = list;
+    t->prev = TIMER_NIL;
+    t->next = g->head[list];
+    if (t->next != TIMER_NIL)
+    {
+        g->timers[t->next].prev = idx;
+    }
+    g->head[list] = idx;
+
+    if (list < TIMER_LIST_EXPIRED)
+    {
+        g->occupied[list / TIMER_WHEEL_SLOTS] |= (1ull << (list & TIMER_WHEEL_SLOT_MASK));
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerListRemove
+ *
+ *  DESCRIPTION
+ *      Unlinks a timer from the list holding it.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void timerListRemove (QMESH_TIMER_GROUP_T *g, uint16_t idx)
+{
+    QMESH_SOFT_TIMER_T *t = &g->timers[idx];
+    uint16_t list = t->list;
+
+    if (t->prev != TIMER_NIL)
+    {
+        g->timers[t->prev].next = t->next;
+    }
+    else
+    {
+        g->head[list] = t->next;
+    }
+
+    if (t->next != TIMER_NIL)
+    {
+        g->timers[t->next].prev = t->prev;
+    }
+
+    if ((list < TIMER_LIST_EXPIRED) && (g->head[list] == TIMER_NIL))
+    {
+        g->occupied[list / TIMER_WHEEL_SLOTS] &= ~(1ull << (list & TIMER_WHEEL_SLOT_MASK));
+    }
+
+    t->list = TIMER_LIST_NONE;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerWheelInsert
+ *
+ *  DESCRIPTION
+ *      Files a timer in the wheel slot covering its expiry. A timer in level
+ *      'k' is re-filed when the wheel reaches the start of its slot, which is
+ *      always after the current tick. The expiry must not be before the
+ *      current tick.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void timerWheelInsert (QMESH_TIMER_GROUP_T *g, uint16_t idx)
+{
+    uint64_t expiry = g->timers[idx].expiry;
+    uint64_t delta = expiry - g->cur;
+    uint8_t level;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if (delta < (1ull << (TIMER_WHEEL_SLOT_BITS * (level + 1))))
+        {
+            timerListAdd(g, idx, (uint16_t)(level * TIMER_WHEEL_SLOTS +
+                         ((expiry >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK)));
+            return;
+        }
+    }
+
+    /* Beyond the wheel range: park in the top level slot turned last */
+    level = TIMER_WHEEL_LEVELS - 1;
+    timerListAdd(g, idx, (uint16_t)(level * TIMER_WHEEL_SLOTS +
+                 ((g->cur >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK)));
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerNextEvent
+ *
+ *  DESCRIPTION
+ *      Finds the next tick at which a level 0 slot expires or a higher level
+ *      slot has to be re-filed. Empty slots are skipped using the occupancy
+ *      bitmaps.
+ *
+ *  RETURNS/MODIFIES
+ *      Tick of the next event or TIMER_NO_EVENT
+ *
+ *----------------------------------------------------------------------------*/
+static uint64_t timerNextEvent (const QMESH_TIMER_GROUP_T *g)
+{
+    uint64_t next = TIMER_NO_EVENT;
+    uint64_t bits;
+    uint64_t base;
+    uint64_t tick;
+    uint8_t rot;
+    uint8_t level;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if (g->occupied[level] == 0)
+        {
+            continue;
+        }
+
+        /* Rotate so that bit 0 is the slot turned after the current one */
+        base = g->cur >> (TIMER_WHEEL_SLOT_BITS * level);
+        rot = (uint8_t)((base + 1) & TIMER_WHEEL_SLOT_MASK);
+        bits = g->occupied[level];
+        if (rot != 0)
+        {
+            bits = (bits >> rot) | (bits << (TIMER_WHEEL_SLOTS - rot));
+        }
+
+        tick = (base + 1 + timerLowestBit(bits)) << (TIMER_WHEEL_SLOT_BITS * level);
+        if (tick < next)
+        {
+            next = tick;
+        }
+    }
+
+    return next;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerWheelAdvance
+ *
+ *  DESCRIPTION
+ *      Moves the wheel forward to 'now', re-filing higher level slots as
+ *      their start is reached and moving every due timer to the expired list.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void timerWheelAdvance (QMESH_TIMER_GROUP_T *g, uint64_t now)
+{
+    uint64_t tick;
+    uint16_t list;
+    uint16_t idx;
+    uint8_t level;
+
+    while ((tick = timerNextEvent(g)) <= now)
+    {
+        g->cur = tick;
+
+        /* Re-file from the top down so that nothing skips level 0 */
+        for (level = TIMER_WHEEL_LEVELS - 1; level > 0; level--)
+        {
+            if ((tick & ((1ull << (TIMER_WHEEL_SLOT_BITS * level)) - 1)) != 0)
+            {
+                continue;
+            }
+
+            list = (uint16_t)(level * TIMER_WHEEL_SLOTS +
+                   ((tick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK));
+            while ((idx = g->head[list]) != TIMER_NIL)
+            {
+                timerListRemove(g, idx);
+                timerWheelInsert(g, idx);
+            }
+        }
+
+        list = (uint16_t)(tick & TIMER_WHEEL_SLOT_MASK);
+        while ((idx = g->head[list]) != TIMER_NIL)
+        {
+            timerListRemove(g, idx);
+            timerListAdd(g, idx, TIMER_LIST_EXPIRED);
+        }
+    }
+
+    if (now > g->cur)
+    {
+        g->cur = now;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerGroupArm
+ *
+ *  DESCRIPTION
+ *      Sets the system timer of the group for the next wheel event. Nothing
+ *      is done while expired timers are pending, as the dispatch thread arms
+ *      the group once they have been delivered.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void timerGroupArm (QMESH_TIMER_GROUP_T *g, uint64_t now)
+{
+    qapi_TIMER_set_attr_t attr;
+    uint64_t next;
+
+    if (g->head[TIMER_LIST_EXPIRED] != TIMER_NIL)
+    {
+        return;
+    }
+
+    next = timerNextEvent(g);
+    if (next == g->armed)
+    {
+        return;
+    }
+
+    qapi_Timer_Stop(g->hw_timer);
+    g->armed = next;
+
+    if (next == TIMER_NO_EVENT)
+    {
+        return;
+    }
+
+    if (next <= now)
+    {
+        qurt_signal_set(&timer_ctx.event, TIMER_GROUP_EVENT(g->id));
+        return;
+    }
+
+    attr.time = next - now;
+    attr.reload = FALSE;
+    attr.max_deferrable_timeout = 0;
+    attr.unit = QAPI_TIMER_UNIT_MSEC;
+    if (qapi_Timer_Set(g->hw_timer, &attr) != QAPI_OK)
+    {
+        /* Let the dispatch thread retry rather than lose the event */
+        g->armed = TIMER_NO_EVENT;
+        qurt_signal_set(&timer_ctx.event, TIMER_GROUP_EVENT(g->id));
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerGroupFromHandle
+ *
+ *  DESCRIPTION
+ *      Validates a group handle against the group table.
+ *
+ *  RETURNS/MODIFIES
+ *      Group or NULL
+ *
+ *----------------------------------------------------------------------------*/
+static QMESH_TIMER_GROUP_T *timerGroupFromHandle (const QMESH_TIMER_GROUP_HANDLE_T *ghdl)
+{
+    uint8_t i;
+
+    if ((ghdl == NULL) || (*ghdl == QMESH_TIMER_INVALID_GROUP_HANDLE) || (*ghdl == NULL))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < MAX_TIMER_GROUPS; i++)
+    {
+        if (timer_ctx.group[i] == (QMESH_TIMER_GROUP_T *)*ghdl)
+        {
+            return timer_ctx.group[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerFromHandle
+ *
+ *  DESCRIPTION
+ *      Decodes a timer handle. The handle holds the timer index plus one and
+ *      the generation of the timer when it was started.
+ *
+ *  RETURNS/MODIFIES
+ *      Timer index or TIMER_NIL if the handle is not an active timer
+ *
+ *----------------------------------------------------------------------------*/
+static uint16_t timerFromHandle (const QMESH_TIMER_GROUP_T *g, const QMESH_TIMER_HANDLE_T *thdl)
+{
+    uint32_t value;
+    uint16_t idx;
+
+    if ((thdl == NULL) || (*thdl == QMESH_TIMER_INVALID_HANDLE))
+    {
+        return TIMER_NIL;
+    }
+
+    value = (uint32_t)(uintptr_t)*thdl;
+    idx = (uint16_t)((value & 0xFFFFu) - 1u);
+
+    if ((idx >= g->capacity) || (g->timers[idx].gen != (uint16_t)(value >> 16)) ||
+        (g->timers[idx].list == TIMER_LIST_NONE))
+    {
+        return TIMER_NIL;
+    }
+
+    return idx;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerRelease
+ *
+ *  DESCRIPTION
+ *      Returns a timer that is in no list to the free list.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void timerRelease (QMESH_TIMER_GROUP_T *g, uint16_t idx)
+{
+    QMESH_SOFT_TIMER_T *t = &g->timers[idx];
+
+    t->cb = NULL;
+    t->params = NULL;
+    t->gen++;
+    t->next = g->free_head;
+    g->free_head = idx;
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerDispatchGroup
+ *
+ *  DESCRIPTION
+ *      Moves all due timers of a group to the expired list in one pass of the
+ *      wheel and then calls them one by one with the lock released. The group
+ *      is looked up again after each callback as a callback may delete it.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void timerDispatchGroup (uint8_t id)
+{
+    QMESH_TIMER_GROUP_T *g;
+    QMESH_TIMER_CALLBACK_T cb;
+    QMESH_TIMER_HANDLE_T thdl;
+    void *params;
+    uint64_t now;
+    uint16_t idx;
+
+    QmeshMutexLock(&timer_ctx.mutex);
+
+    if ((g = timer_ctx.group[id]) != NULL)
+    {
+        now = timerNow();
+        g->armed = TIMER_NO_EVENT;
+        timerWheelAdvance(g, now);
+    }
+
+    while ((g = timer_ctx.group[id]) != NULL)
+    {
+        idx = g->head[TIMER_LIST_EXPIRED];
+        if (idx == TIMER_NIL)
+        {
+            timerGroupArm(g, timerNow());
+            break;
+        }
+
+        timerListRemove(g, idx);
+        cb = g->timers[idx].cb;
+        params = g->timers[idx].params;
+        thdl = (QMESH_TIMER_HANDLE_T)(uintptr_t)(((uint32_t)g->timers[idx].gen << 16) | (idx + 1u));
+        timerRelease(g, idx);
+
+        QmeshMutexUnlock(&timer_ctx.mutex);
+        cb(thdl, params);
+        QmeshMutexLock(&timer_ctx.mutex);
+    }
+
+    QmeshMutexUnlock(&timer_ctx.mutex);
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerThread
+ *
+ *  DESCRIPTION
+ *      Dispatch thread. System timers only set an event bit for their group;
+ *      all wheel processing and callbacks run here.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void timerThread (void *param)
+{
+    uint32_t events;
+    uint8_t id;
+
+    (void)param;
+
+    for (;;)
+    {
+        events = qurt_signal_wait(&timer_ctx.event, TIMER_ALL_GROUP_EVENTS,
+                                  QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+
+        for (id = 0; id < MAX_TIMER_GROUPS; id++)
+        {
+            if (events & TIMER_GROUP_EVENT(id))
+            {
+                timerDispatchGroup(id);
+            }
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ *  NAME
+ *      timerGroupDestroy
+ *
+ *  DESCRIPTION
+ *      Stops the system timer of a group and frees it. Must be called with
+ *      the context lock held.
+ *
+ *  RETURNS/MODIFIES
+ *      None
+ *
+ *----------------------------------------------------------------------------*/
+static void timerGroupDestroy (QMESH_TIMER_GROUP_T *g)
+{
+    timer_ctx.group[g->id] = NULL;
+
+    qapi_Timer_Stop(g->hw_timer);
+    qapi_Timer_Undef(g->hw_timer);
+    QmeshFree(g);
+}
+
+QMESH_RESULT_T QmeshInitializeTimerContext (void)
+{
+    qurt_thread_attr_t attr;
+    qurt_thread_t thread;
+
+    if (timer_ctx.initialized)
+    {
+        return QMESH_RESULT_SUCCESS;
+    }
+
+    /* The mutex, event and dispatch thread are kept across a deinitialize */
+    if (!timer_ctx.thread_started)
+    {
+        if (QmeshMutexCreate(&timer_ctx.mutex) != QMESH_RESULT_SUCCESS)
+        {
+            return QMESH_RESULT_FAILURE;
+        }
+
+        if (qurt_signal_create(&timer_ctx.event) != QURT_EOK)
+        {
+            QmeshMutexDestroy(&timer_ctx.mutex);
+            return QMESH_RESULT_FAILURE;
+        }
+
+        timer_ctx.ticks_per_sec = qurt_timer_convert_time_to_ticks(1000, QURT_TIME_MSEC);
+        timer_ctx.last_ticks = qurt_timer_get_ticks();
+        timer_ctx.clock_ticks = 0;
+
+        qurt_thread_attr_init(&attr);
+        qurt_thread_attr_set_name(&attr, "QMeshTmr");
+        qurt_thread_attr_set_priority(&attr, TIMER_THREAD_PRIORITY);
+        qurt_thread_attr_set_stack_size(&attr, TIMER_THREAD_STACK_SIZE);
+
+        if (qurt_thread_create(&thread, &attr, timerThread, NULL) != QURT_EOK)
+        {
+            qurt_signal_delete(&timer_ctx.event);
+            QmeshMutexDestroy(&timer_ctx.mutex);
+            return QMESH_RESULT_FAILURE;
+        }
+
+        timer_ctx.thread_started = TRUE;
+    }
+
+    QmeshMemSet(timer_ctx.group, 0, sizeof(timer_ctx.group));
+    timer_ctx.initialized = TRUE;
+
+    return QMESH_RESULT_SUCCESS;
+}
+
+void QmeshDeinitializeTimerContext (void)
+{
+    uint8_t i;
+
+    if (!timer_ctx.initialized)
+    {
+        return;
+    }
+
+    QmeshMutexLock(&timer_ctx.mutex);
+
+    for (i = 0; i < MAX_TIMER_GROUPS; i++)
+    {
+        if (timer_ctx.group[i] != NULL)
+        {
+            timerGroupDestroy(timer_ctx.group[i]);
+        }
+    }
+
+    timer_ctx.initialized = FALSE;
+
+    QmeshMutexUnlock(&timer_ctx.mutex);
+}
+
+QMESH_TIMER_GROUP_HANDLE_T QmeshTimerCreateGroup (uint16_t no_of_timers)
+{
+    qapi_TIMER_define_attr_t attr;
+    QMESH_TIMER_GROUP_T *g = NULL;
+    uint16_t i;
+    uint8_t id;
+
+    if ((!timer_ctx.initialized) || (no_of_timers == 0) || (no_of_timers > TIMER_GROUP_MAX_TIMERS))
+    {
+        return QMESH_TIMER_INVALID_GROUP_HANDLE;
+    }
+
+    QmeshMutexLock(&timer_ctx.mutex);
+
+    for (id = 0; id < MAX_TIMER_GROUPS; id++)
+    {
+        if (timer_ctx.group[id] == NULL)
+        {
+            break;
+        }
+    }
+
+    if (id < MAX_TIMER_GROUPS)
+    {
+        /* The group and its timers are a single allocation */
+        g = (QMESH_TIMER_GROUP_T *)QmeshMalloc(QMESH_MM_SECTION_UTILS_LAYER,
+                                               sizeof(QMESH_TIMER_GROUP_T) +
+                                               (no_of_timers * sizeof(QMESH_SOFT_TIMER_T)));
+    }
+
+    if (g != NULL)
+    {
+        QmeshMemSet(g, 0, sizeof(QMESH_TIMER_GROUP_T));
+        g->timers = (QMESH_SOFT_TIMER_T *)(g + 1);
+        g->capacity = no_of_timers;
+        g->id = id;
+        g->cur = timerNow();
+        g->armed = TIMER_NO_EVENT;
+
+        for (i = 0; i < TIMER_LIST_COUNT; i++)
+        {
+            g->head[i] = TIMER_NIL;
+        }
+
+        for (i = 0; i < no_of_timers; i++)
+        {
+            g->timers[i].cb = NULL;
+            g->timers[i].params = NULL;
+            g->timers[i].list = TIMER_LIST_NONE;
+            g->timers[i].gen = 0;
+            g->timers[i].next = ((i + 1u) < no_of_timers) ? (uint16_t)(i + 1u) : TIMER_NIL;
+        }
+        g->free_head = 0;
+
+        attr.deferrable = TRUE;     /* Mesh timers must wake the processor */
+        attr.cb_type = QAPI_TIMER_NATIVE_OS_SIGNAL_TYPE;
+        attr.sigs_func_ptr = &timer_ctx.event;
+        attr.sigs_mask_data = TIMER_GROUP_EVENT(id);
+
+        if (qapi_Timer_Def(&g->hw_timer, &attr) != QAPI_OK)
+        {
+            QmeshFree(g);
+            g = NULL;
+        }
+        else
+        {
+            timer_ctx.group[id] = g;
+        }
+    }
+
+    QmeshMutexUnlock(&timer_ctx.mutex);
+
+    return (g != NULL) ? (QMESH_TIMER_GROUP_HANDLE_T)g : QMESH_TIMER_INVALID_GROUP_HANDLE;
+}
+
+void QmeshTimerDeleteGroup (QMESH_TIMER_GROUP_HANDLE_T *ghdl)
+{
+    QMESH_TIMER_GROUP_T *g;
+
+    if (!timer_ctx.initialized)
+    {
+        return;
+    }
+
+    QmeshMutexLock(&timer_ctx.mutex);
+
+    if ((g = timerGroupFromHandle(ghdl)) != NULL)
+    {
+        timerGroupDestroy(g);
+        *ghdl = QMESH_TIMER_INVALID_GROUP_HANDLE;
+    }
+
+    QmeshMutexUnlock(&timer_ctx.mutex);
+}
+
+QMESH_TIMER_HANDLE_T QmeshTimerCreate (const QMESH_TIMER_GROUP_HANDLE_T *ghdl,
+                                       QMESH_TIMER_CALLBACK_T timerCb,
+                                       void *timerParams,
+                                       uint32_t timeInMs)
+{
+    QMESH_TIMER_HANDLE_T thdl = QMESH_TIMER_INVALID_HANDLE;
+    QMESH_TIMER_GROUP_T *g;
+    QMESH_SOFT_TIMER_T *t;
+    uint64_t now;
+    uint16_t idx;
+
+    if ((!timer_ctx.initialized) || (timerCb == NULL))
+    {
+        return QMESH_TIMER_INVALID_HANDLE;
+    }
+
+    QmeshMutexLock(&timer_ctx.mutex);
+
+    g = timerGroupFromHandle(ghdl);
+    if ((g != NULL) && ((idx = g->free_head) != TIMER_NIL))
+    {
+        t = &g->timers[idx];
+        g->free_head = t->next;
+
+        now = timerNow();
+        t->cb = timerCb;
+        t->params = timerParams;
+        t->expiry = now + timeInMs;
+
+        /* The wheel may lag 'now' until the next dispatch. A timer due on
+         * the current tick is filed for the next one, as the slot of the
+         * current tick has already been processed.
+         */
+        if (t->expiry <= g->cur)
+        {
+            t->expiry = g->cur + 1;
+        }
+
+        timerWheelInsert(g, idx);
+        timerGroupArm(g, now);
+
+        thdl = (QMESH_TIMER_HANDLE_T)(uintptr_t)(((uint32_t)t->gen << 16) | (idx + 1u));
+    }
+
+    QmeshMutexUnlock(&timer_ctx.mutex);
+
+    return thdl;
+}
+
+QMESH_RESULT_T QmeshTimerDelete (const QMESH_TIMER_GROUP_HANDLE_T *ghdl,
+                                 QMESH_TIMER_HANDLE_T *thdl)
+{
+    QMESH_RESULT_T result = QMESH_RESULT_FAILURE;
+    QMESH_TIMER_GROUP_T *g;
+    uint16_t idx;
+
+    if (!timer_ctx.initialized)
+    {
+        return QMESH_RESULT_FAILURE;
+    }
+
+    QmeshMutexLock(&timer_ctx.mutex);
+
+    g = timerGroupFromHandle(ghdl);
+    if ((g != NULL) && ((idx = timerFromHandle(g, thdl)) != TIMER_NIL))
+    {
+        /* The system timer is left armed; a spurious wake re-arms the group */
+        timerListRemove(g, idx);
+        timerRelease(g, idx);
+        *thdl = QMESH_TIMER_INVALID_HANDLE;
+        result = QMESH_RESULT_SUCCESS;
+    }
+
+    QmeshMutexUnlock(&timer_ctx.mutex);
+
+    return result;
+}
+
+QMESH_RESULT_T QmeshTimerGetRemainingTime (const QMESH_TIMER_GROUP_HANDLE_T *ghdl,
+                                           const QMESH_TIMER_HANDLE_T *thdl,
+                                           uint32_t *remainingTimeInMs)
+{
+    QMESH_RESULT_T result = QMESH_RESULT_FAILURE;
+    QMESH_TIMER_GROUP_T *g;
+    uint64_t now;
+    uint16_t idx;
+
+    if ((!timer_ctx.initialized) || (remainingTimeInMs == NULL))
+    {
+        return QMESH_RESULT_FAILURE;
+    }
+
+    QmeshMutexLock(&timer_ctx.mutex);
+
+    g = timerGroupFromHandle(ghdl);
+    if ((g != NULL) && ((idx = timerFromHandle(g, thdl)) != TIMER_NIL))
+    {
+        now = timerNow();
+        if (g->timers[idx].expiry > now)
+        {
+            now = g->timers[idx].expiry - now;
+            *remainingTimeInMs = (now > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)now;
+        }
+        else
+        {
+            *remainingTimeInMs = 0;
+        }
+        result = QMESH_RESULT_SUCCESS;
+    }
+
+    QmeshMutexUnlock(&timer_ctx.mutex);
+
+    return result;
+}
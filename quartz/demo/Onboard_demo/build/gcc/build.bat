@@ -322,6 +322,7 @@ SET CSrcs=%CSrcs% utils\led_utils.c
 SET CSrcs=%CSrcs% utils\wifi_util.c
 SET CSrcs=%CSrcs% utils\net_util.c
 SET CSrcs=%CSrcs% utils\ble_util.c
+SET CSrcs=%CSrcs% utils\json_writer.c
 SET CSrcs=%CSrcs% ble\ble_zigbee_service.c
 SET CSrcs=%CSrcs% ble\ble_thread_service.c
 IF /I "%ONBOARD_VIA%" == "WIFI" (
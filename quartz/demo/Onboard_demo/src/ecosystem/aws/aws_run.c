@@ -86,7 +86,6 @@ qurt_signal_t aws_signal;
 qurt_mutex_t  shadow_update_lock;
 char remote_buf[256] = { 0 };
 static int32_t Remote_delta_update(char *device_name, char *jsonbuf);
-int32_t read_onboard_sensors(char *json_buffer, sensor_info_t *sensor_val);
 uint32_t Process_Dimmable_Light(char *, int);
 char remote_breach_buf[256];
 char remote_shdow_buf[256];
@@ -520,9 +519,11 @@ int32_t Notify_breach_update_from_remote_device(char *buf)
 
 int32_t notify_thermostat_breach(char *buf, uint32_t size)
 {
-    snprintf(buf, size, "{\"%s\":{", THING_NAME);
-    size = size - strlen(buf); 
-    fill_breach_message(buf,"Thermostat threshold breached",size);
+    json_writer_t jw;
+
+    json_writer_init(&jw, buf, size);
+    JSON_WRITER_APPEND_LIT(&jw, "{\"" THING_NAME "\":{");
+    fill_breach_message(&jw, "Thermostat threshold breached");
     return Notify_breach_update_to_aws(buf); 
 }
 
@@ -36,7 +36,6 @@
 #define BUF_SIZE_128 128
 #define BUF_SIZE_256 256
 #define BUF_SIZE_512 512
-#define MAX_LENGTH_OF_UPDATE_JSON_BUFFER   600
 
 #define OFFLINE_INFO        LOG_INFO
 #define OFFLINE_ERROR       LOG_ERROR
@@ -47,20 +46,6 @@
 #define DIMMER_ID         "dimmer_id_1"
 #define THRMSTAT          "thermostat"
 
-#define VALIDATE_AND_RETURN(js_buf, ret_val)  \
-{ \
-    if (ret_val < 0) \
-    { \
-        OFFLINE_ERROR("%s:%d JSON BUF error\n", __func__, __LINE__); \
-        return FAILURE; \
-    } \
-    if (strlen(js_buf) >= MAX_LENGTH_OF_UPDATE_JSON_BUFFER) \
-    { \
-        OFFLINE_ERROR("%s:%d JSON BUF overun\n", __func__, __LINE__); \
-        return FAILURE; \
-    } \
-}
-
 
 int notify_thermo_breach = 0;
 char offline_recv_buf[512];
@@ -79,7 +64,6 @@ static char localdevice_name[BUF_SIZE_128];
 static uint8_t PIR_Payload[100] = {0};
 static uint8_t board_name[32] = { 0};
 static char ch;
-int32_t read_onboard_sensors(char *json_buffer, sensor_info_t *sensor_val);
 static int32_t Remote_delta_update(char *device_name, char *jsonbuf);
 uint32_t Process_Dimmable_Light(char *, int);
 
@@ -249,25 +233,22 @@ int32_t update_temp_data(char *buffer)
  * @func  : fill_devices_list 
  * @breif : fills the device list info 
  */
-int32_t fill_devices_list(char *JsonDocumentBuffer, uint32_t size)
+int32_t fill_devices_list(json_writer_t *jw)
 {
-    int32_t ret_val;
     char local_device_name[128] = { 0 };
     get_localdevice_name(local_device_name, sizeof(local_device_name));
 
-    ret_val = snprintf((JsonDocumentBuffer + strlen(JsonDocumentBuffer)), size, "[{\"dName\":%s},", local_device_name);
-    VALIDATE_AND_RETURN(JsonDocumentBuffer, ret_val);
-
-    size = MAX_OFFLINE_BUF_SIZE - strlen(JsonDocumentBuffer);
+    JSON_WRITER_APPEND_LIT(jw, "[{\"dName\":");
+    json_writer_append_str(jw, local_device_name);
+    JSON_WRITER_APPEND_LIT(jw, "},");
 
-    fill_remote_device_info(JsonDocumentBuffer, size);
+    fill_remote_device_info(jw);
 
-    size = MAX_OFFLINE_BUF_SIZE - strlen(JsonDocumentBuffer);
+    /* replaces the trailing ',' of the last entry */
+    json_writer_unput(jw, 1);
+    JSON_WRITER_APPEND_LIT(jw, "]");
 
-    ret_val = snprintf((JsonDocumentBuffer + strlen(JsonDocumentBuffer)-1), size, "]");
-    VALIDATE_AND_RETURN(JsonDocumentBuffer, ret_val);
-
-    return SUCCESS;
+    return json_writer_finish(jw);
 }
 
 /**  
@@ -277,16 +258,17 @@ int32_t fill_devices_list(char *JsonDocumentBuffer, uint32_t size)
 int32_t construct_dlist_response(void)
 {
     OFFLINE_INFO("%s\n", __func__);
-    uint32_t ret_val;
-    uint32_t rem_size = sizeof(offline_send_buf);
-    memset(offline_send_buf, 0, sizeof(offline_send_buf));
+    json_writer_t jw;
 
-    ret_val = snprintf(offline_send_buf, rem_size, "{\"dList\":");
-    VALIDATE_AND_RETURN(offline_send_buf, ret_val);
-
-    rem_size = MAX_OFFLINE_BUF_SIZE - strlen(offline_send_buf);
-    fill_devices_list(offline_send_buf, rem_size); 
-    ret_val = snprintf((offline_send_buf + strlen(offline_send_buf)), rem_size, "}");
+    json_writer_init(&jw, offline_send_buf, sizeof(offline_send_buf));
+    JSON_WRITER_APPEND_LIT(&jw, "{\"dList\":");
+    fill_devices_list(&jw); 
+    JSON_WRITER_APPEND_LIT(&jw, "}");
+    if (SUCCESS != json_writer_finish(&jw))
+    {
+        OFFLINE_ERROR("%s:%d JSON BUF overun\n", __func__, __LINE__);
+        return FAILURE;
+    }
 
     OFFLINE_INFO("offline_send_buf : %s\n", offline_send_buf); 
     return SUCCESS;
@@ -299,11 +281,13 @@ int32_t construct_dlist_response(void)
  */
 int32_t prepare_thermostat_breach_message(char *buf, int32_t size)
 {
-    memset(buf, 0, size);
-    snprintf(buf, size, "{");
-    size = size - strlen(buf);
-    fill_breach_message(buf,"Thermostat threshold breached",size);
-    *(buf + strlen(buf) -1) = '\0';
+    json_writer_t jw;
+
+    json_writer_init(&jw, buf, size);
+    JSON_WRITER_APPEND_LIT(&jw, "{");
+    fill_breach_message(&jw, "Thermostat threshold breached");
+    /* drops the closing brace of the report object */
+    json_writer_unput(&jw, 1);
     OFFLINE_WARN("Breach buf: %s\n", buf);
     update_breach_message(buf); 
     return 0;
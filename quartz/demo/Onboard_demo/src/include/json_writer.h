@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#ifndef __JSON_WRITER_H__
+#define __JSON_WRITER_H__
+
+#include <stdint.h>
+
+/*
+ * Streaming writer for the json reports. The write cursor is tracked in
+ * len, so appends never rescan the buffer with strlen. len keeps counting
+ * past size so an overrun can be reported once, at the end of the report.
+ * A writer initialized with a NULL buffer only counts, which gives the exact
+ * size of a piece of json before it is written.
+ */
+typedef struct json_writer {
+    char     *buf;      /* destination, NULL when only measuring */
+    uint32_t  size;     /* capacity of buf including the terminator */
+    uint32_t  len;      /* bytes produced so far */
+} json_writer_t;
+
+/* Appends a string literal without a strlen */
+#define JSON_WRITER_APPEND_LIT(jw, lit)    json_writer_append_mem((jw), (lit), sizeof(lit) - 1)
+
+void json_writer_init(json_writer_t *jw, char *buf, uint32_t size);
+void json_writer_append_mem(json_writer_t *jw, const char *data, uint32_t len);
+void json_writer_append_str(json_writer_t *jw, const char *str);
+void json_writer_append_uint(json_writer_t *jw, uint32_t val);
+void json_writer_append_int(json_writer_t *jw, int32_t val);
+void json_writer_append_fixed2(json_writer_t *jw, float val);
+void json_writer_unput(json_writer_t *jw, uint32_t count);
+int32_t json_writer_has_room(const json_writer_t *jw, uint32_t count);
+int32_t json_writer_finish(json_writer_t *jw);
+
+#endif
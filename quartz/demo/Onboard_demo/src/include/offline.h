@@ -6,6 +6,8 @@
 #ifndef _OFF_LINE_H_
 #define _OFF_LINE_H_
 
+#include "json_writer.h"
+
 #define MAX_OFFLINE_BUF_SIZE      512
 #define OFFLINE_THREAD_PRIORITY   10
 #define OFFLINE_THREAD_STACK_SIZE 2048
@@ -19,7 +21,7 @@
 #define DESIRED        "desired"
 int32_t Start_offline_thread(void);
 void process_request_data(char *, uint32_t data);
-int32_t fill_remote_device_info(char *, uint32_t);
+int32_t fill_remote_device_info(json_writer_t *);
 int32_t process_offline_data(char *);
 int32_t update_temp_data(char *);
 int32_t Notify_breach_update_offline(char *);
@@ -7,6 +7,8 @@
 #ifndef _SENSOR_H_
 #define _SENSOR_H_
 
+#include "json_writer.h"
+
 struct thermo_stat {
     uint8_t actual;
     uint8_t desired;
@@ -106,7 +108,7 @@ int32_t Notify_breach_update_from_remote_device(char *);
 int32_t fill_thermo_stat_result(sensor_info_t *);
 int32_t Intial_sensor_values(void);
 int32_t Get_thermostat_threshhold_values(char *, char *);
-int32_t fill_breach_message(char *, char *, uint32_t);
+int32_t fill_breach_message(json_writer_t *, char *);
 int32_t process_light_localdevice(char *);
 void pir_register_intr();
 int32_t parse_recived_data(char *jsonbuf);
@@ -24,6 +24,7 @@
 #include "onboard.h"
 #include "jsmn.h"
 #include "sensor_json.h"
+#include "json_writer.h"
 
 /*-------------------------------------------------------------------------
   - Preprocessor Definitions and Constants
@@ -56,26 +57,13 @@
 
 #define THERMO_STAT_FILE        "/spinor/sensors/thermostat.txt"
 
-#define VALIDATE_AND_RETURN(js_buf, ret_val)  \
-{ \
-    if (ret_val < 0) \
-    { \
-        IOT_ERROR("%s:%d JSON BUF error\n", __func__, __LINE__); \
-        return FAILURE; \
-    } \
-    if (strlen(js_buf) >= MAX_LENGTH_OF_UPDATE_JSON_BUFFER) \
-    { \
-        IOT_ERROR("%s:%d JSON BUF overun\n", __func__, __LINE__); \
-        return FAILURE; \
-    } \
-}
-
+#define LOCAL_DEVICE_NAME_LEN   64
 
 #define LIGHT_ID          "light_id_1"
 #define THRMSTAT          "thermostat"
 #define DIMMER_ID         "dimmer_id_1"
 
-int32_t read_onboard_sensors(char *json_buffer, sensor_info_t *sensor_val, uint32_t flag);
+int32_t read_onboard_sensors(json_writer_t *jw, sensor_info_t *sensor_val, uint32_t flag);
 int32_t Read_remote_devices_data(char *json_buf, uint32_t size);
 int32_t Notify_sensors_update_from_remote_device(char *buf);
 int32_t write_thermo_val(struct thermo_stat *sens);
@@ -242,14 +230,28 @@ int32_t update_thermostat_states(char **op_mode, char **state)
     return 0;
 }
 
+/**
+ * @func  : append_localdevice_name  
+ * @breif : appends the quoted local device name to the json 
+ */
+static void append_localdevice_name(json_writer_t *jw)
+{
+    char localdevice_name[LOCAL_DEVICE_NAME_LEN] = { 0 };
+
+    if (SUCCESS != get_localdevice_name(localdevice_name, sizeof(localdevice_name)))
+    {
+        IOT_WARN("Mac address is not appended to the Local device name !!!\n");
+    }
+    json_writer_append_str(jw, localdevice_name);
+}
+
 /**
  * @func  : Update_json  
  * @breif : updates the constructed json from the device 
  */
 int32_t Update_json(char *JsonDocumentBuffer, uint32_t Max_size_aws_buf)
 {
-    uint32_t rem_size;
-    int32_t ret_val;
+    json_writer_t jw;
     sensor_info_t sensor_data;
     uint32_t flag = 2;
 
@@ -278,112 +280,147 @@ int32_t Update_json(char *JsonDocumentBuffer, uint32_t Max_size_aws_buf)
 #endif
         }
     }
-    rem_size = Max_size_aws_buf - strlen(JsonDocumentBuffer);
+
+    json_writer_init(&jw, JsonDocumentBuffer, Max_size_aws_buf);
 #ifndef OFFLINE
-    ret_val = snprintf(JsonDocumentBuffer, rem_size, "{\"state\":{\"reported\":{");
+    JSON_WRITER_APPEND_LIT(&jw, "{\"state\":{\"reported\":{");
 #else
-    ret_val = snprintf(JsonDocumentBuffer, rem_size, "{\"reported\":{");
+    JSON_WRITER_APPEND_LIT(&jw, "{\"reported\":{");
 #endif
-    VALIDATE_AND_RETURN(JsonDocumentBuffer, ret_val);
-
-    rem_size = Max_size_aws_buf - strlen(JsonDocumentBuffer);
+    append_localdevice_name(&jw);
+    JSON_WRITER_APPEND_LIT(&jw, ":{");
 
-    if (SUCCESS != get_localdevice_name(JsonDocumentBuffer, rem_size))
-    {
-        IOT_WARN("Mac address is not appended to the Local device name !!!\n");
-    }
-    rem_size = Max_size_aws_buf - strlen(JsonDocumentBuffer);
-    ret_val = snprintf((JsonDocumentBuffer + strlen(JsonDocumentBuffer)), rem_size, ":{");
-    VALIDATE_AND_RETURN(JsonDocumentBuffer, ret_val);
-
-    rem_size = Max_size_aws_buf - strlen(JsonDocumentBuffer);
-    if (FAILURE == read_onboard_sensors(JsonDocumentBuffer, &sensor_data, flag))
+    if (FAILURE == read_onboard_sensors(&jw, &sensor_data, flag))
     {
         return FAILURE;
     }
 
-
-    rem_size = Max_size_aws_buf - strlen(JsonDocumentBuffer);
+    /* the last sensor entry leaves a trailing ',' */
+    json_writer_unput(&jw, 1);
 #ifndef OFFLINE
-    ret_val = snprintf((JsonDocumentBuffer + strlen(JsonDocumentBuffer)-1), rem_size, "}}}}");
+    JSON_WRITER_APPEND_LIT(&jw, "}}}}");
 #else
-    ret_val = snprintf((JsonDocumentBuffer + strlen(JsonDocumentBuffer)-1), rem_size, "}}}");
+    JSON_WRITER_APPEND_LIT(&jw, "}}}");
 #endif
-    VALIDATE_AND_RETURN(JsonDocumentBuffer, ret_val);
+    if (SUCCESS != json_writer_finish(&jw))
+    {
+        IOT_ERROR("%s:%d JSON BUF overun\n", __func__, __LINE__);
+        return FAILURE;
+    }
     return SUCCESS;
 }
 
 /**
- * @func  : add_sensor_entry  
- * @breif : adds the each sensor entry into the json 
+ * @func  : write_sensor_entry  
+ * @breif : writes one sensor entry, also used to measure the entry 
  */
-int add_sensor_entry(char *json_buf, sensor_info_t *sens_info)
+static void write_sensor_entry(json_writer_t *jw, sensor_info_t *sens_info)
 {
-    int ret_val;
-    int remaining_size;
     char *therm_op = "\"AUTO\"";
     char *therm_state = "\"ON\"";
-    remaining_size = MAX_LENGTH_OF_UPDATE_JSON_BUFFER - strlen(json_buf);
+
     switch (sens_info->sensor_type)
     {
         case SENSOR_TEMPERATURE:
-            ret_val = snprintf(json_buf +strlen(json_buf), remaining_size, "%s:{\"temp_id1\":%u.%u},",
-                    TEMP_SENSOR, (unsigned int)sens_info->s.temp.mantissa, (unsigned int)sens_info->s.temp.exponent);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, TEMP_SENSOR ":{\"temp_id1\":");
+            json_writer_append_uint(jw, sens_info->s.temp.mantissa);
+            JSON_WRITER_APPEND_LIT(jw, ".");
+            json_writer_append_uint(jw, sens_info->s.temp.exponent);
+            JSON_WRITER_APPEND_LIT(jw, "},");
             break;
 
         case SENSOR_HUMIDITY:
-            ret_val = snprintf(json_buf + strlen(json_buf), remaining_size,"%s:{\"humidity_id1\":%u.%u},",
-                    HUMIDITY_SENSOR, (unsigned int)sens_info->s.hum.mantissa, (unsigned int)sens_info->s.hum.exponent);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, HUMIDITY_SENSOR ":{\"humidity_id1\":");
+            json_writer_append_uint(jw, sens_info->s.hum.mantissa);
+            JSON_WRITER_APPEND_LIT(jw, ".");
+            json_writer_append_uint(jw, sens_info->s.hum.exponent);
+            JSON_WRITER_APPEND_LIT(jw, "},");
             break;
         case SENSOR_LIGHT:
-            ret_val = snprintf(json_buf + strlen(json_buf), remaining_size, "%s:{\"light_senor_id1\":%u},",
-                    LIGHT_SENSOR, (unsigned int)sens_info->s.lux.val);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, LIGHT_SENSOR ":{\"light_senor_id1\":");
+            json_writer_append_uint(jw, sens_info->s.lux.val);
+            JSON_WRITER_APPEND_LIT(jw, "},");
             break;
         case SENSOR_PRESSURE:
-            ret_val = snprintf(json_buf + strlen(json_buf), remaining_size, "%s:{\"pressure_sensor_id1\":%.02f},",
-                    PRESSURE_SENSOR, (float)sens_info->s.pressure.val);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, PRESSURE_SENSOR ":{\"pressure_sensor_id1\":");
+            json_writer_append_fixed2(jw, sens_info->s.pressure.val);
+            JSON_WRITER_APPEND_LIT(jw, "},");
             break;
         case SENSOR_COMPASS:
-            ret_val = snprintf(json_buf + strlen(json_buf), remaining_size, "%s:{\"compass_id1\":{\"X\":%d,\"Y\":%d,\"Z\":%d}},",
-                    COMPASS_SENSOR, (int) sens_info->s.compass.x, (int) sens_info->s.compass.y, (int) sens_info->s.compass.z);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, COMPASS_SENSOR ":{\"compass_id1\":{\"X\":");
+            json_writer_append_int(jw, sens_info->s.compass.x);
+            JSON_WRITER_APPEND_LIT(jw, ",\"Y\":");
+            json_writer_append_int(jw, sens_info->s.compass.y);
+            JSON_WRITER_APPEND_LIT(jw, ",\"Z\":");
+            json_writer_append_int(jw, sens_info->s.compass.z);
+            JSON_WRITER_APPEND_LIT(jw, "}},");
             break;
         case SENSOR_GYROSCOPE:
-            ret_val = snprintf(json_buf + strlen(json_buf), remaining_size, "%s:{\"gyro_id1\":{\"X\":%.02f,\"Y\":%.02f,\"Z\":%.02f}},",
-                    GYROSCOPE_SENSOR, (float)sens_info->s.gyro_val.x_g, (float)sens_info->s.gyro_val.y_g, (float)sens_info->s.gyro_val.z_g);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, GYROSCOPE_SENSOR ":{\"gyro_id1\":{\"X\":");
+            json_writer_append_fixed2(jw, sens_info->s.gyro_val.x_g);
+            JSON_WRITER_APPEND_LIT(jw, ",\"Y\":");
+            json_writer_append_fixed2(jw, sens_info->s.gyro_val.y_g);
+            JSON_WRITER_APPEND_LIT(jw, ",\"Z\":");
+            json_writer_append_fixed2(jw, sens_info->s.gyro_val.z_g);
+            JSON_WRITER_APPEND_LIT(jw, "}},");
             break;
         case SENSOR_ACCELROMETER:
-            ret_val = snprintf(json_buf + strlen(json_buf), remaining_size, "%s:{\"accelerometer_id1\":{\"X\":%.02f,\"Y\":%.02f,\"Z\":%0.02f}},",                      ACCELEROMETER_SENSOR, (float)sens_info->s.acc_val.x_xl, (float) sens_info->s.acc_val.y_xl, (float)sens_info->s.acc_val.z_xl);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, ACCELEROMETER_SENSOR ":{\"accelerometer_id1\":{\"X\":");
+            json_writer_append_fixed2(jw, sens_info->s.acc_val.x_xl);
+            JSON_WRITER_APPEND_LIT(jw, ",\"Y\":");
+            json_writer_append_fixed2(jw, sens_info->s.acc_val.y_xl);
+            JSON_WRITER_APPEND_LIT(jw, ",\"Z\":");
+            json_writer_append_fixed2(jw, sens_info->s.acc_val.z_xl);
+            JSON_WRITER_APPEND_LIT(jw, "}},");
             break;
         case AMBIENT_LIGHT:
             sens_info->s.light.val = light_state.val;
-            ret_val = snprintf(json_buf + strlen(json_buf), remaining_size, "%s:{\"light_id_1\":%d},",
-                    LIGHT, (int) sens_info->s.light.val);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, LIGHT ":{\"light_id_1\":");
+            json_writer_append_int(jw, (int32_t) sens_info->s.light.val);
+            JSON_WRITER_APPEND_LIT(jw, "},");
             break;
         case THERMO_STAT:
             sens_info->s.thermostat = thermostat;
             update_thermostat_states(&therm_op, &therm_state);
-            ret_val = snprintf(json_buf + strlen(json_buf), remaining_size, "%s:{\"thermostat_id1\":"
-                    "{\"actual\":%d,\"op_mode\":%s,\"desired\":%d,\"op_state\":%s,\"threshold\":%d}},",
-                    THERMOSTAT, (int) sens_info->s.thermostat.actual, therm_op, (int) sens_info->s.thermostat.desired, therm_state,
-                         (int) sens_info->s.thermostat.threshhold);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, THERMOSTAT ":{\"thermostat_id1\":{\"actual\":");
+            json_writer_append_int(jw, sens_info->s.thermostat.actual);
+            JSON_WRITER_APPEND_LIT(jw, ",\"op_mode\":");
+            json_writer_append_str(jw, therm_op);
+            JSON_WRITER_APPEND_LIT(jw, ",\"desired\":");
+            json_writer_append_int(jw, sens_info->s.thermostat.desired);
+            JSON_WRITER_APPEND_LIT(jw, ",\"op_state\":");
+            json_writer_append_str(jw, therm_state);
+            JSON_WRITER_APPEND_LIT(jw, ",\"threshold\":");
+            json_writer_append_int(jw, sens_info->s.thermostat.threshhold);
+            JSON_WRITER_APPEND_LIT(jw, "}},");
             break;
         case DIMMER_LIGHT:
             sens_info->s.dimmer.val = dim_val.val;
-            ret_val = snprintf(json_buf + strlen(json_buf), remaining_size, "%s:{\"dimmer_id_1\":%d},",
-                    DIMMER, (int) sens_info->s.dimmer.val);
-            VALIDATE_AND_RETURN(json_buf, ret_val);
+            JSON_WRITER_APPEND_LIT(jw, DIMMER ":{\"dimmer_id_1\":");
+            json_writer_append_int(jw, (int32_t) sens_info->s.dimmer.val);
+            JSON_WRITER_APPEND_LIT(jw, "},");
 
             break;
     }
+}
+
+/**
+ * @func  : add_sensor_entry  
+ * @breif : adds the each sensor entry into the json, an entry that does 
+ *          not fit is not written at all 
+ */
+int add_sensor_entry(json_writer_t *jw, sensor_info_t *sens_info)
+{
+    json_writer_t probe;
+
+    json_writer_init(&probe, NULL, 0);
+    write_sensor_entry(&probe, sens_info);
+    if (!json_writer_has_room(jw, probe.len))
+    {
+        IOT_ERROR("%s:%d JSON BUF overun\n", __func__, __LINE__);
+        return FAILURE;
+    }
+    write_sensor_entry(jw, sens_info);
     return 0;
 }
 
@@ -392,21 +429,17 @@ int add_sensor_entry(char *json_buf, sensor_info_t *sens_info)
  * @func  : fill_breach_message  
  * @breif : fills the breach message 
  */
-int32_t fill_breach_message(char *json_buf, char *msg, uint32_t size)
+int32_t fill_breach_message(json_writer_t *jw, char *msg)
 {
-    uint32_t rem_size;
-    int32_t ret_val;
-
-    rem_size = size - strlen(json_buf);
-
-    if (SUCCESS != get_localdevice_name(json_buf, rem_size))
+    append_localdevice_name(jw);
+    JSON_WRITER_APPEND_LIT(jw, ":{\"message\": \"");
+    json_writer_append_str(jw, msg);
+    JSON_WRITER_APPEND_LIT(jw, "\"}}}");
+    if (SUCCESS != json_writer_finish(jw))
     {
-        IOT_WARN("Mac address is not appended to the Local device name !!!\n");
+        IOT_ERROR("%s:%d JSON BUF overun\n", __func__, __LINE__);
+        return FAILURE;
     }
-    rem_size = size - strlen(json_buf);
-    ret_val = snprintf((json_buf + strlen(json_buf)), rem_size,
-             ":{\"message\": \"%s\"}}}", msg);
-    VALIDATE_AND_RETURN(json_buf, ret_val);
 
     return 0;
 }
@@ -45,7 +45,7 @@ int32_t sensors_humidity_get_measured_value(sensor_info_t *sensor_data);
 void sensors_pressure_get_measured_values(sensor_info_t *sensor_data);
 void sensors_compass_get_measured_values(sensor_info_t *sensor_data);
 void sensors_gyroscope_get_measured_values(sensor_info_t *sensor_data);
-int add_sensor_entry(char *json_buf, sensor_info_t *sens_info);
+int add_sensor_entry(json_writer_t *jw, sensor_info_t *sens_info);
 
 void *h1; /**< I2C Handle */
 
@@ -628,11 +628,11 @@ int32_t deactivate_onboard_sensors()
 /**
  * func: sensors_read_all() reads all the sensors values
  */
-int32_t read_remote_sensors(char *json_buf, sensor_info_t *sensor_val)
+int32_t read_remote_sensors(json_writer_t *jw, sensor_info_t *sensor_val)
 {
     sensor_val->sensor_type = AMBIENT_LIGHT;
     sensor_val->s.light.val = 0;
-    if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+    if(FAILURE == add_sensor_entry(jw, sensor_val))
     {
         SENSOR_ERROR("Sensor entry is failed\n");
         return FAILURE;
@@ -642,7 +642,7 @@ int32_t read_remote_sensors(char *json_buf, sensor_info_t *sensor_val)
 
 extern int notify_thermo_breach;
 //extern struct thermo_stat thermostat;
-int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t update_flag)
+int32_t read_onboard_sensors(json_writer_t *jw, sensor_info_t *sensor_val, uint32_t update_flag)
 {
     static int lux = 0;
     static int flag = 0;
@@ -651,7 +651,7 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
     //Temperature sensor reading
     sensor_val->sensor_type = SENSOR_TEMPERATURE;
     sensors_humidity_get_measured_value(sensor_val);
-    if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+    if(FAILURE == add_sensor_entry(jw, sensor_val))
     {
         SENSOR_ERROR("Sensor entry is failed\n");
         return FAILURE;
@@ -660,7 +660,7 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
     //Humidity sensor reading
     sensor_val->sensor_type = SENSOR_HUMIDITY;
     sensors_humidity_get_measured_value(sensor_val);
-    if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+    if(FAILURE == add_sensor_entry(jw, sensor_val))
     {
         SENSOR_ERROR("Sensor entry is failed\n");
         return FAILURE;
@@ -669,7 +669,7 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
     //Light_sensor reading
     sensor_val->sensor_type = SENSOR_LIGHT;
     sensors_light_LTR303ALS_get_measured_values(sensor_val);
-    if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+    if(FAILURE == add_sensor_entry(jw, sensor_val))
     {
         SENSOR_ERROR("Sensor entry is failed\n");
         return FAILURE;
@@ -699,14 +699,14 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
         }
 #if BOARD_SUPPORTS_WIFI
         sensor_val->sensor_type = THERMO_STAT;
-        if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+        if(FAILURE == add_sensor_entry(jw, sensor_val))
         {
             SENSOR_ERROR("Sensor entry is failed\n");
             return FAILURE;
         }
 #elif OFFLINE
 		sensor_val->sensor_type = THERMO_STAT;
-        if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+        if(FAILURE == add_sensor_entry(jw, sensor_val))
         {
             SENSOR_ERROR("Sensor entry is failed\n");
             return FAILURE;
@@ -717,7 +717,7 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
     //Pressure_sensor_reading
     sensor_val->sensor_type = SENSOR_PRESSURE;
     sensors_pressure_get_measured_values(sensor_val);
-    if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+    if(FAILURE == add_sensor_entry(jw, sensor_val))
     {
         SENSOR_ERROR("Sensor entry is failed\n");
         return FAILURE;
@@ -726,7 +726,7 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
     //Compass sensor reading
     sensor_val->sensor_type = SENSOR_COMPASS;
     sensors_compass_get_measured_values(sensor_val);
-    if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+    if(FAILURE == add_sensor_entry(jw, sensor_val))
     {
         SENSOR_ERROR("Sensor entry is failed\n");
         return FAILURE;
@@ -735,7 +735,7 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
     //Gyroscope sensor reading
     sensor_val->sensor_type = SENSOR_GYROSCOPE;
     sensors_gyroscope_get_measured_values(sensor_val);
-    if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+    if(FAILURE == add_sensor_entry(jw, sensor_val))
     {
         SENSOR_ERROR("Sensor entry is failed\n");
         return FAILURE;
@@ -744,7 +744,7 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
     //ACCELROMETER sensor reading
     sensor_val->sensor_type = SENSOR_ACCELROMETER;
     sensors_gyroscope_get_measured_values(sensor_val);
-    if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+    if(FAILURE == add_sensor_entry(jw, sensor_val))
     {
         SENSOR_ERROR("Sensor entry is failed\n");
         return FAILURE;
@@ -753,7 +753,7 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
     if (update_flag &1)
     {
         sensor_val->sensor_type = AMBIENT_LIGHT;
-        if (FAILURE == add_sensor_entry(json_buf, sensor_val))
+        if (FAILURE == add_sensor_entry(jw, sensor_val))
         {
             SENSOR_ERROR("Sensor entry is failed\n");
             return FAILURE;
@@ -763,7 +763,7 @@ int32_t read_onboard_sensors(char *json_buf, sensor_info_t *sensor_val, uint32_t
     {
 #if ENABLE_DIMMER
         sensor_val->sensor_type = DIMMER_LIGHT;
-        if(FAILURE == add_sensor_entry(json_buf, sensor_val))
+        if(FAILURE == add_sensor_entry(jw, sensor_val))
         {
             SENSOR_ERROR("Sensor entry is failed\n");
             return FAILURE;
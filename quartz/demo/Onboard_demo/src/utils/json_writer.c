@@ -0,0 +1,175 @@
+/*
+* Copyright (c) 2018 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+* Confidential and Proprietary - Qualcomm Technologies, Inc.
+*/
+
+/**
+ * @file json_writer.c
+ * @brief File contains the streaming writer used to build the json reports.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <qcli_api.h>
+
+#include "log_util.h"
+#include "json_writer.h"
+
+/* Largest value*100 that still converts to an integer exactly */
+#define FIXED2_MAX_SCALED    9007199254740992.0
+
+/**
+ * @func  : json_writer_init
+ * @breif : starts a report at the beginning of buf, buf NULL only measures
+ */
+void json_writer_init(json_writer_t *jw, char *buf, uint32_t size)
+{
+    jw->buf  = buf;
+    jw->size = (buf) ? size : 0;
+    jw->len  = 0;
+    if (jw->size)
+        jw->buf[0] = '\0';
+}
+
+/**
+ * @func  : json_writer_append_mem
+ * @breif : appends len bytes at the cursor, the output is truncated at size
+ */
+void json_writer_append_mem(json_writer_t *jw, const char *data, uint32_t len)
+{
+    uint32_t room;
+
+    if (jw->len + 1 < jw->size)
+    {
+        room = jw->size - 1 - jw->len;
+        memcpy(jw->buf + jw->len, data, (len < room) ? len : room);
+        jw->buf[jw->len + ((len < room) ? len : room)] = '\0';
+    }
+    jw->len += len;
+}
+
+/**
+ * @func  : json_writer_append_str
+ * @breif : appends a NUL terminated string
+ */
+void json_writer_append_str(json_writer_t *jw, const char *str)
+{
+    json_writer_append_mem(jw, str, strlen(str));
+}
+
+/**
+ * @func  : json_writer_append_uint
+ * @breif : appends val in decimal, same output as "%u"
+ */
+void json_writer_append_uint(json_writer_t *jw, uint32_t val)
+{
+    char digits[10];
+    uint32_t pos = sizeof(digits);
+
+    do
+    {
+        digits[--pos] = '0' + (val % 10);
+        val /= 10;
+    } while (val);
+
+    json_writer_append_mem(jw, &digits[pos], sizeof(digits) - pos);
+}
+
+/**
+ * @func  : json_writer_append_int
+ * @breif : appends val in decimal, same output as "%d"
+ */
+void json_writer_append_int(json_writer_t *jw, int32_t val)
+{
+    if (val < 0)
+    {
+        JSON_WRITER_APPEND_LIT(jw, "-");
+        json_writer_append_uint(jw, 0 - (uint32_t)val);
+    }
+    else
+    {
+        json_writer_append_uint(jw, (uint32_t)val);
+    }
+}
+
+/**
+ * @func  : json_writer_append_fixed2
+ * @breif : appends val with two decimals, same output as "%.02f"
+ */
+void json_writer_append_fixed2(json_writer_t *jw, float val)
+{
+    /* A float has a 24 bit mantissa, so val*100 is exact in a double and
+     * the rounding below sees the same value printf does */
+    double   scaled = (double)val * 100.0;
+    double   frac;
+    uint64_t whole;
+    char     digits[20];
+    uint32_t pos = sizeof(digits);
+
+    if (!(scaled < FIXED2_MAX_SCALED && scaled > -FIXED2_MAX_SCALED))
+    {
+        /* nan, inf and huge values are not worth a second formatter */
+        char tmp[48];
+        int32_t ret_val = snprintf(tmp, sizeof(tmp), "%.02f", val);
+
+        if (ret_val > 0)
+            json_writer_append_mem(jw, tmp, ((uint32_t)ret_val < sizeof(tmp)) ? (uint32_t)ret_val : sizeof(tmp) - 1);
+        return;
+    }
+
+    if (signbit(scaled))
+    {
+        JSON_WRITER_APPEND_LIT(jw, "-");
+        scaled = -scaled;
+    }
+
+    /* round half to even, like printf does on an exact tie */
+    whole = (uint64_t)scaled;
+    frac  = scaled - (double)whole;
+    if (frac > 0.5 || (frac == 0.5 && (whole & 1)))
+        whole++;
+
+    digits[--pos] = '0' + (whole % 10);
+    whole /= 10;
+    digits[--pos] = '0' + (whole % 10);
+    whole /= 10;
+    digits[--pos] = '.';
+    do
+    {
+        digits[--pos] = '0' + (whole % 10);
+        whole /= 10;
+    } while (whole);
+
+    json_writer_append_mem(jw, &digits[pos], sizeof(digits) - pos);
+}
+
+/**
+ * @func  : json_writer_unput
+ * @breif : drops the last count bytes, used to strip a trailing separator
+ */
+void json_writer_unput(json_writer_t *jw, uint32_t count)
+{
+    jw->len = (count < jw->len) ? jw->len - count : 0;
+    if (jw->len < jw->size)
+        jw->buf[jw->len] = '\0';
+}
+
+/**
+ * @func  : json_writer_has_room
+ * @breif : checks whether count more bytes still fit with the terminator
+ */
+int32_t json_writer_has_room(const json_writer_t *jw, uint32_t count)
+{
+    return (jw->len + count < jw->size);
+}
+
+/**
+ * @func  : json_writer_finish
+ * @breif : returns FAILURE when the report did not fit into the buffer
+ */
+int32_t json_writer_finish(json_writer_t *jw)
+{
+    return (jw->len < jw->size) ? SUCCESS : FAILURE;
+}
@@ -376,17 +376,15 @@ void Zigbee_device_update(char *device_name, char *jsonbuf, uint32_t size)
     }
 }
 
-int32_t fill_remote_device_info(char *json_buf, uint32_t Max_size)
+int32_t fill_remote_device_info(json_writer_t *jw)
 {
     uint8_t Enddev_shortmac[7] = {0};
     char device_name[128] = { 0 };
     uint32_t Index;
-    uint32_t rem_size;
     for(Index = 1; Index <= DEV_ID_LIST_SIZE; Index++)
     {
         if ((ZigBee_Demo_Context.DevIDList[Index].InUse == TRUE) && ZigBee_Demo_Context.DevIDList[Index].Endpoint == CUSTOM_CLUSTER_ENDPOINT)
         {
-            rem_size = Max_size - strlen(json_buf);
             memset(device_name, 0, sizeof(device_name));
             memset(Enddev_shortmac, 0, sizeof(Enddev_shortmac));
             snprintf((char *) Enddev_shortmac, 7, "%06llx", ((~(~0 << 24)) & ZigBee_Demo_Context.DevIDList[Index].Address.ExtendedAddress));
@@ -395,7 +393,9 @@ int32_t fill_remote_device_info(char *json_buf, uint32_t Max_size)
             {
                 extract_device_name((char *)ZigBee_Demo_Context.DevIDList[Index].EndDevBuf, device_name);
                 LOG_INFO("device_name : %s\n", device_name);
-                snprintf((json_buf + strlen(json_buf)), rem_size,"{\"dName\":\"%s\"},", device_name);
+                JSON_WRITER_APPEND_LIT(jw, "{\"dName\":\"");
+                json_writer_append_str(jw, device_name);
+                JSON_WRITER_APPEND_LIT(jw, "\"},");
             }
         }
     }
@@ -147,6 +147,41 @@ static const HCIHeaderInformation_t HCIHeaderInformation[] =
    { 2, 1, 0 }  /* QPKTZR_PACKET_TYPE_HCI_EVENT     - EventCode[1], Length[1] */
 } ;
 
+   /* The following constant is used in the Start Byte table to flag    */
+   /* the TABI Version 2 Start Packet Delimeter.                        */
+#define START_BYTE_TABI_VERSION_2                           0xFF
+
+   /* The following MACRO defines a row of 16 Start Byte table entries  */
+   /* of the same value.                                                */
+#define START_BYTE_ROW(_x)                                  _x, _x, _x, _x, _x, _x, _x, _x, _x, _x, _x, _x, _x, _x, _x, _x
+
+   /* The following table maps every stream byte value to the packet    */
+   /* that it starts while we are looking for a packet.  Zero means the */
+   /* byte does not start a packet.                                     */
+   /* * NOTE * HCI Packet bytes map to their Packetizer Packet Type and */
+   /*          every TABI Version 1 start byte (see                     */
+   /*          TABI_VERSION_1_CHECK_START_BYTE()) maps to the 15.4      */
+   /*          Packet Type.                                             */
+static const uint8_t StartByteTable[256] =
+{
+   0, QPKTZR_PACKET_TYPE_HCI_COMMAND, QPKTZR_PACKET_TYPE_HCI_ACL_DATA, QPKTZR_PACKET_TYPE_HCI_SCO_DATA, QPKTZR_PACKET_TYPE_HCI_EVENT, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+   START_BYTE_ROW(QPKTZR_PACKET_TYPE_15_4),
+   START_BYTE_ROW(QPKTZR_PACKET_TYPE_15_4),
+   START_BYTE_ROW(QPKTZR_PACKET_TYPE_15_4),
+   START_BYTE_ROW(QPKTZR_PACKET_TYPE_15_4),
+   QPKTZR_PACKET_TYPE_15_4, START_BYTE_TABI_VERSION_2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+   START_BYTE_ROW(0),
+   START_BYTE_ROW(0),
+   START_BYTE_ROW(0),
+   START_BYTE_ROW(0),
+   START_BYTE_ROW(0),
+   START_BYTE_ROW(0),
+   START_BYTE_ROW(0),
+   START_BYTE_ROW(0),
+   START_BYTE_ROW(0),
+   START_BYTE_ROW(0)
+} ;
+
    /* ***************************************************************** */
    /* **                                                             ** */
    /* **               PACKETIZER STATE INFORMATION                  ** */
@@ -192,17 +227,23 @@ static QPKTZR_Packet_t *Packet;
    /* ***************************************************************** */
 
 static int ParseStream(unsigned int StreamBufferSize, unsigned char *StreamBuffer, QPKTZR_Packet_t **ParsedPacket);
+static QPKTZR_Packet_t *ProcessPacketHeader(void);
 static uint8_t CalculateTABIChecksum(unsigned int Length, unsigned char *Data);
 static QPKTZR_Packet_t *VerifyParsedPacket(void);
 
    /* The following function is responsible for parsing the specified   */
    /* input stream data and trying to parse it into a packetized packet.*/
+   /* * NOTE * Only the search for the start of a packet looks at single*/
+   /*          bytes (through the Start Byte table).  Once a packet has */
+   /*          started, its header and its data are copied as far as    */
+   /*          the stream buffer holds them in one copy each, so a      */
+   /*          packet that arrives in one buffer costs two copies.      */
 static int ParseStream(unsigned int StreamBufferSize, unsigned char *StreamBuffer, QPKTZR_Packet_t **ParsedPacket)
 {
    int          ret_val = 0;
    unsigned int Length;
    unsigned int DataLength;
-   unsigned int TabiGroup;
+   unsigned int StartByte;
 
    /* First, verify that the input parameters appear to be semi-valid.  */
    if((StreamBufferSize) && (StreamBuffer) && (ParsedPacket))
@@ -215,92 +256,87 @@ static int ParseStream(unsigned int StreamBufferSize, unsigned char *StreamBuffe
 
       while((DataLength) && (!ret_val))
       {
-         if(ParseState == psLOOKING)
+         switch(ParseState)
          {
-            /* While we are looking, check for a valid Packet ID.  When */
-            /* a Packet ID is found, we must save the Packet type.  We  */
-            /* can Check to see if this is a TABI Version 1 packet by   */
-            /* simply looking at the byte value we encounter.           */
-            /* * NOTE * We are doing this because:                      */
-            /*             - All TABI group ID's are outside the range  */
-            /*               of Bluetooth HCI packets.                  */
-            /*             - TABI packets are in little endian format   */
-            /*               (so the first byte will be the least       */
-            /*               significant byte).                         */
-            /* * NOTE * For this to work TABI has guarantee that the    */
-            /*          least significant byte of any TABI Group ID     */
-            /*          will never match a Bluetooth HCI defined        */
-            /*          packet.  This is noot really a problem because  */
-            /*          TABI is aware of this limitation (and it is an  */
-            /*          internal protocol that is completely controlled */
-            /*          by Qualcomm).                                   */
-            if((*StreamBuffer == QPKTZR_PACKET_TYPE_HCI_COMMAND) || (*StreamBuffer == QPKTZR_PACKET_TYPE_HCI_ACL_DATA) || (*StreamBuffer == QPKTZR_PACKET_TYPE_HCI_SCO_DATA) || (*StreamBuffer == QPKTZR_PACKET_TYPE_HCI_EVENT) || TABI_VERSION_1_CHECK_START_BYTE(*StreamBuffer))
-            {
-               ParseState         = psWAIT_HEADER;
-               PacketIndex        = 0;
-               PacketBuffer       = PacketHeader;
-               PacketType         = *StreamBuffer;
-               UnknownTABIGroupID = 0;
-
-               /* Process TABI packets specially due to V1/V2           */
-               /* differences.                                          */
-               if(TABI_VERSION_1_CHECK_START_BYTE(*StreamBuffer))
-               {
-                  /* Note we will treat all packets as 15.4 Group ID so */
-                  /* as to not confuse the packetizer (we will not      */
-                  /* dispatch the built packet, however, so as to not   */
-                  /* confuse the caller.                                */
-                  PacketType   = QPKTZR_PACKET_TYPE_15_4;
-
-                  PacketLength = TABI_VERSION_1_HEADER_SIZE;
-
-                  if(TABIVersion2)
-                     PacketLength++;
-
-                  /* We need to include this byte in the Packet Header. */
-                  PacketHeader[PacketIndex++] = *StreamBuffer;
-               }
-               else
+            case psLOOKING:
+               /* Skip every byte that does not start a packet (this is */
+               /* also how we resynchronize after bad data).            */
+               while((DataLength) && (!StartByteTable[*StreamBuffer]))
                {
-                  /* HCI Packet, note the Header Length.                */
-                  PacketLength = HCIHeaderInformation[*StreamBuffer].HeaderLength;
+                  StreamBuffer++;
+                  DataLength--;
                }
-            }
-            else
-            {
-               /* Not an HCI, 15.4, or Coex TABI packet, check for TABI */
-               /* Version 2.                                            */
-               if(*StreamBuffer == TABI_VERSION_2_START_BYTE)
+
+               if(DataLength)
                {
-                  /* Flag that we have found a TABI Version 2 packet.   */
-                  /* * NOTE * We do not change the state because we     */
-                  /*          we can deal with the extra Checksum when  */
-                  /*          we get to it by processing the rest as a  */
-                  /*          TABI Version 1 packet.                    */
-                  TABIVersion2 = 1;
-               }
-            }
+                  /* While we are looking, check for a valid Packet ID. */
+                  /* When a Packet ID is found, we must save the Packet */
+                  /* type.  We can Check to see if this is a TABI       */
+                  /* Version 1 packet by simply looking at the byte     */
+                  /* value we encounter.                                */
+                  /* * NOTE * We are doing this because:                */
+                  /*             - All TABI group ID's are outside the  */
+                  /*               range of Bluetooth HCI packets.      */
+                  /*             - TABI packets are in little endian    */
+                  /*               format (so the first byte will be the*/
+                  /*               least significant byte).             */
+                  /* * NOTE * For this to work TABI has guarantee that  */
+                  /*          the least significant byte of any TABI    */
+                  /*          Group ID will never match a Bluetooth HCI */
+                  /*          defined packet.  This is noot really a    */
+                  /*          problem because TABI is aware of this     */
+                  /*          limitation (and it is an internal protocol*/
+                  /*          that is completely controlled by          */
+                  /*          Qualcomm).                                */
+                  StartByte = StartByteTable[*StreamBuffer];
+
+                  if(StartByte == START_BYTE_TABI_VERSION_2)
+                  {
+                     /* Flag that we have found a TABI Version 2 packet.*/
+                     /* * NOTE * We do not change the state because we  */
+                     /*          we can deal with the extra Checksum    */
+                     /*          when we get to it by processing the    */
+                     /*          rest as a TABI Version 1 packet.       */
+                     TABIVersion2 = 1;
+                  }
+                  else
+                  {
+                     ParseState         = psWAIT_HEADER;
+                     PacketIndex        = 0;
+                     PacketBuffer       = PacketHeader;
+                     PacketType         = StartByte;
+                     UnknownTABIGroupID = 0;
+
+                     /* Process TABI packets specially due to V1/V2     */
+                     /* differences.                                    */
+                     if(StartByte == QPKTZR_PACKET_TYPE_15_4)
+                     {
+                        /* Note we will treat all packets as 15.4 Group */
+                        /* ID so as to not confuse the packetizer (we   */
+                        /* will not dispatch the built packet, however, */
+                        /* so as to not confuse the caller.             */
+                        PacketLength = TABI_VERSION_1_HEADER_SIZE;
+
+                        if(TABIVersion2)
+                           PacketLength++;
+
+                        /* We need to include this byte in the Packet   */
+                        /* Header.                                      */
+                        PacketHeader[PacketIndex++] = *StreamBuffer;
+                     }
+                     else
+                     {
+                        /* HCI Packet, note the Header Length.          */
+                        PacketLength = HCIHeaderInformation[StartByte].HeaderLength;
+                     }
+                  }
 
-            StreamBuffer++;
-            DataLength--;
-         }
-         else
-         {
-            /* Go ahead and place the next byte in our current packet   */
-            /* buffer.                                                  */
-            PacketBuffer[PacketIndex++] = *StreamBuffer;
-
-            StreamBuffer++;
-            DataLength--;
-
-            /* Compile as much of the header that is needed for each    */
-            /* packet type.                                             */
-            if(ParseState == psWAIT_HEADER)
-            {
-               /* Check to see if the Event Packet can be processed.    */
-               /* * NOTE * We will key off the length of data that we   */
-               /*          have received (take note that we have already*/
-               /*          incremented the packet index).               */
+                  StreamBuffer++;
+                  DataLength--;
+               }
+               break;
+            case psWAIT_HEADER:
+               /* Copy as much of the header as the stream holds.       */
                /* * NOTE * The length of each packet header (for each   */
                /*          packet type) is:                             */
                /*             - HCI Commmand - 3 bytes                  */
@@ -309,168 +345,58 @@ static int ParseStream(unsigned int StreamBufferSize, unsigned char *StreamBuffe
                /*             - HCI SCO Data - 3 bytes                  */
                /*             - TABI V. 1    - 8 bytes                  */
                /*             - TABI V. 2    - 9 bytes                  */
-               if(PacketIndex == PacketLength)
-               {
-                  /* Header has been completely read, process the       */
-                  /* packet:                                            */
-                  /*    - Verify checksum (TABI V2 only)                */
-                  /*    - Allocate space to hold the packet data        */
-                  /*    - Copy required header information to the       */
-                  /*      newly allocated packet                        */
-                  if((PacketType == QPKTZR_PACKET_TYPE_15_4) || (PacketType == QPKTZR_PACKET_TYPE_COEX) || (PacketType == QPKTZR_PACKET_TYPE_UART))
-                  {
-                     /* TABI packet.                                    */
-                     if(TABIVersion2)
-                     {
-                        /* Verify the Checksum.                         */
-                        /* * NOTE * We cannot include the Checksum      */
-                        /*          byte in our testing of the          */
-                        /*          Checksum.                           */
-                        if(PacketHeader[TABI_VERSION_1_HEADER_SIZE] != CalculateTABIChecksum(TABI_VERSION_1_HEADER_SIZE, PacketHeader))
-                        {
-                           /* Checksum doesn't match, go ahead and toss */
-                           /* it.                                       */
-                           PacketLength = 0;
-                        }
-                     }
+               Length = (PacketLength - PacketIndex);
+               if(Length > DataLength)
+                  Length = DataLength;
 
-                     /* Note the Packet Length of the actual data.      */
-                     PacketLength = READ_UNALIGNED_LITTLE_ENDIAN_UINT32(&(PacketHeader[TABI_VERSION_1_HEADER_LENGTH_OFFSET]));
-
-                     /* Verify the Group ID and pull out the Length.    */
-                     /* * NOTE * TABI Version 1 and Version 2 both      */
-                     /*          start with the same format:            */
-                     /*             - Group ID                          */
-                     /*             - Length                            */
-                     TabiGroup = READ_UNALIGNED_LITTLE_ENDIAN_UINT32(PacketHeader);
-                     if(TabiGroup == TABI_GROUP_ID_15_4)
-                        PacketType = QPKTZR_PACKET_TYPE_15_4;
-                     else if(TabiGroup == TABI_GROUP_ID_COEX)
-                        PacketType = QPKTZR_PACKET_TYPE_COEX;
-                     else if(TabiGroup == TABI_GROUP_ID_UART)
-                        PacketType = QPKTZR_PACKET_TYPE_UART;
-                     else
-                        UnknownTABIGroupID = 1;
-                  }
-                  else
-                  {
-                     /* HCI Packet, go ahead and determine the header   */
-                     /* length.                                         */
-                     if(HCIHeaderInformation[PacketType].Length16)
-                        PacketLength = READ_UNALIGNED_LITTLE_ENDIAN_UINT16(&(PacketHeader[HCIHeaderInformation[PacketType].LengthOffset]));
-                     else
-                        PacketLength = PacketHeader[HCIHeaderInformation[PacketType].LengthOffset];
+               _COPY_PACKETIZER_MEMORY(&(PacketBuffer[PacketIndex]), StreamBuffer, Length);
 
-                     /* We need to adjust the length of the data to     */
-                     /* account for the bytes that occurred BEFORE the  */
-                     /* Length in the HCI Packets.                      */
-                     if(PacketLength)
-                        PacketLength += HCIHeaderInformation[PacketType].HeaderLength;
-                  }
+               PacketIndex  += Length;
+               StreamBuffer += Length;
+               DataLength   -= Length;
 
-                  /* If we have determined that the packet is valid then*/
-                  /* the length of the packet will be contained in      */
-                  /* PacketLength.                                      */
-                  /* * NOTE * There is no way for an HCI packet to have */
-                  /*          a non-zero packet length because there    */
-                  /*          will always be an HCI header.  We cannot  */
-                  /*          accept a zero length TABI packet, though. */
-                  if(((PacketLength) && ((PacketType == QPKTZR_PACKET_TYPE_15_4) || (PacketType == QPKTZR_PACKET_TYPE_COEX) || (PacketType == QPKTZR_PACKET_TYPE_UART))) || ((PacketType != QPKTZR_PACKET_TYPE_15_4) && (PacketType != QPKTZR_PACKET_TYPE_COEX) && (PacketType != QPKTZR_PACKET_TYPE_UART)))
+               if(PacketIndex == PacketLength)
+               {
+                  /* Header has been completely read, process the       */
+                  /* packet.  A packet without data is complete already.*/
+                  if((*ParsedPacket = ProcessPacketHeader()) != NULL)
                   {
-                     /* Allocate the memory to hold the packet.         */
-                     if((Packet = _ALLOCATE_PACKETIZER_MEMORY(sizeof(QPKTZR_Packet_t) + PacketLength)) != NULL)
-                     {
-                        /* Flag that we are now in the compiling packet */
-                        /* state.                                       */
-                        ParseState           = psCOMPILING;
-
-                        /* Initialize the packet information.           */
-                        Packet->PacketType   = PacketType;
-                        Packet->PacketLength = 0;
-                        Packet->PacketData   = ((unsigned char *)Packet) + sizeof(QPKTZR_Packet_t);
-
-                        PacketBuffer         = Packet->PacketData;
-
-                        /* Now, go ahead and copy the header over and   */
-                        /* fix up the remaining length of expected data.*/
-                        if((PacketType == QPKTZR_PACKET_TYPE_15_4) || (PacketType == QPKTZR_PACKET_TYPE_COEX) || (PacketType == QPKTZR_PACKET_TYPE_UART))
-                        {
-                           /* Simply set the Packet Index to zero, the  */
-                           /* Packet Length will be the length that was */
-                           /* already read (i.e.  no need to copy any   */
-                           /* header).                                  */
-                           PacketIndex  = 0;
-                        }
-                        else
-                        {
-                           /* Bluetooth HCI Packet, we need to copy over*/
-                           /* the existing header and fix up the packet */
-                           /* buffer.                                   */
-                           /* * NOTE * Keep in mind that we are actually*/
-                           /*          copying the header size PLUS the */
-                           /*          next byte we already consumed.   */
-                           _COPY_PACKETIZER_MEMORY(PacketBuffer, PacketHeader, HCIHeaderInformation[PacketType].HeaderLength);
-
-                           /* Check to see if the packet has been       */
-                           /* completely received.                      */
-                           if(!PacketLength)
-                           {
-                              if((*ParsedPacket = VerifyParsedPacket()) != NULL)
-                              {
-                                 /* Flag that the remaining data has NOT*/
-                                 /* been consumed (i.e.  we processed a */
-                                 /* packet).                            */
-                                 ret_val = DataLength;
-                              }
-                           }
-                        }
-                     }
-                     else
-                     {
-                        /* Unable to allocate memory, go ahead and      */
-                        /* silently fail and try to recover.            */
-                        ParseState = psLOOKING;
-                     }
+                     /* Flag that the remaining data has NOT been       */
+                     /* consumed (i.e.  we processed a packet).         */
+                     ret_val = DataLength;
                   }
-                  else
-                     ParseState = psLOOKING;
                }
-            }
-            else
-            {
+               break;
+            case psCOMPILING:
                /* Keep saving the data until all data is received.      */
-               if(ParseState == psCOMPILING)
+               /* Bulk copy any remaining data that is required and     */
+               /* might be present in the stream buffer.                */
+               if(PacketIndex < PacketLength)
                {
-                  /* Optimization to bulk copy any remaining data that  */
-                  /* is required and might be present in the stream     */
-                  /* buffer.                                            */
-                  if(PacketIndex < PacketLength)
-                  {
-                     /* Calculate how many bytes remain in this packet. */
-                     Length = (PacketLength - PacketIndex);
-                     if(Length > DataLength)
-                        Length = DataLength;
+                  /* Calculate how many bytes remain in this packet.    */
+                  Length = (PacketLength - PacketIndex);
+                  if(Length > DataLength)
+                     Length = DataLength;
 
-                     _COPY_PACKETIZER_MEMORY(&(PacketBuffer[PacketIndex]), StreamBuffer, Length);
+                  _COPY_PACKETIZER_MEMORY(&(PacketBuffer[PacketIndex]), StreamBuffer, Length);
 
-                     PacketIndex  += Length;
-                     StreamBuffer += Length;
-                     DataLength   -= Length;
-                  }
+                  PacketIndex  += Length;
+                  StreamBuffer += Length;
+                  DataLength   -= Length;
+               }
 
-                  /* Check to see if the packet has been completely     */
-                  /* received.                                          */
-                  if(PacketIndex == PacketLength)
+               /* Check to see if the packet has been completely        */
+               /* received.                                             */
+               if(PacketIndex == PacketLength)
+               {
+                  if((*ParsedPacket = VerifyParsedPacket()) != NULL)
                   {
-                     if((*ParsedPacket = VerifyParsedPacket()) != NULL)
-                     {
-                        /* Flag that the remaining data has NOT been    */
-                        /* consumed (i.e.  we processed a packet).      */
-                        ret_val = DataLength;
-                     }
+                     /* Flag that the remaining data has NOT been       */
+                     /* consumed (i.e.  we processed a packet).         */
+                     ret_val = DataLength;
                   }
                }
-            }
+               break;
          }
       }
    }
@@ -481,22 +407,166 @@ static int ParseStream(unsigned int StreamBufferSize, unsigned char *StreamBuffe
    return(ret_val);
 }
 
+   /* The following function is an internal function that processes a   */
+   /* completely read packet header (in PacketHeader).  It verifies the */
+   /* header, allocates the packet and moves to the compiling state, or */
+   /* back to the looking state if the header is not valid.  This       */
+   /* function returns the parsed packet if the header completed the    */
+   /* packet (an HCI packet without data), or NULL otherwise.           */
+static QPKTZR_Packet_t *ProcessPacketHeader(void)
+{
+   QPKTZR_Packet_t *ret_val = NULL;
+   unsigned int     TabiGroup;
+
+   /* Header has been completely read, process the                      */
+   /* packet:                                                           */
+   /*    - Verify checksum (TABI V2 only)                               */
+   /*    - Allocate space to hold the packet data                       */
+   /*    - Copy required header information to the                      */
+   /*      newly allocated packet                                       */
+   if((PacketType == QPKTZR_PACKET_TYPE_15_4) || (PacketType == QPKTZR_PACKET_TYPE_COEX) || (PacketType == QPKTZR_PACKET_TYPE_UART))
+   {
+      /* TABI packet.                                                   */
+      if(TABIVersion2)
+      {
+         /* Verify the Checksum.                                        */
+         /* * NOTE * We cannot include the Checksum                     */
+         /*          byte in our testing of the                         */
+         /*          Checksum.                                          */
+         if(PacketHeader[TABI_VERSION_1_HEADER_SIZE] != CalculateTABIChecksum(TABI_VERSION_1_HEADER_SIZE, PacketHeader))
+         {
+            /* Checksum doesn't match, go ahead and toss                */
+            /* it.                                                      */
+            PacketLength = 0;
+         }
+      }
+
+      /* Note the Packet Length of the actual data.                     */
+      PacketLength = READ_UNALIGNED_LITTLE_ENDIAN_UINT32(&(PacketHeader[TABI_VERSION_1_HEADER_LENGTH_OFFSET]));
+
+      /* Verify the Group ID and pull out the Length.                   */
+      /* * NOTE * TABI Version 1 and Version 2 both                     */
+      /*          start with the same format:                           */
+      /*             - Group ID                                         */
+      /*             - Length                                           */
+      TabiGroup = READ_UNALIGNED_LITTLE_ENDIAN_UINT32(PacketHeader);
+      if(TabiGroup == TABI_GROUP_ID_15_4)
+         PacketType = QPKTZR_PACKET_TYPE_15_4;
+      else if(TabiGroup == TABI_GROUP_ID_COEX)
+         PacketType = QPKTZR_PACKET_TYPE_COEX;
+      else if(TabiGroup == TABI_GROUP_ID_UART)
+         PacketType = QPKTZR_PACKET_TYPE_UART;
+      else
+         UnknownTABIGroupID = 1;
+   }
+   else
+   {
+      /* HCI Packet, go ahead and determine the header                  */
+      /* length.                                                        */
+      if(HCIHeaderInformation[PacketType].Length16)
+         PacketLength = READ_UNALIGNED_LITTLE_ENDIAN_UINT16(&(PacketHeader[HCIHeaderInformation[PacketType].LengthOffset]));
+      else
+         PacketLength = PacketHeader[HCIHeaderInformation[PacketType].LengthOffset];
+
+      /* We need to adjust the length of the data to                    */
+      /* account for the bytes that occurred BEFORE the                 */
+      /* Length in the HCI Packets.                                     */
+      if(PacketLength)
+         PacketLength += HCIHeaderInformation[PacketType].HeaderLength;
+   }
+
+   /* If we have determined that the packet is valid then               */
+   /* the length of the packet will be contained in                     */
+   /* PacketLength.                                                     */
+   /* * NOTE * There is no way for an HCI packet to have                */
+   /*          a non-zero packet length because there                   */
+   /*          will always be an HCI header.  We cannot                 */
+   /*          accept a zero length TABI packet, though.                */
+   if(((PacketLength) && ((PacketType == QPKTZR_PACKET_TYPE_15_4) || (PacketType == QPKTZR_PACKET_TYPE_COEX) || (PacketType == QPKTZR_PACKET_TYPE_UART))) || ((PacketType != QPKTZR_PACKET_TYPE_15_4) && (PacketType != QPKTZR_PACKET_TYPE_COEX) && (PacketType != QPKTZR_PACKET_TYPE_UART)))
+   {
+      /* Allocate the memory to hold the packet.                        */
+      if((Packet = _ALLOCATE_PACKETIZER_MEMORY(sizeof(QPKTZR_Packet_t) + PacketLength)) != NULL)
+      {
+         /* Flag that we are now in the compiling packet                */
+         /* state.                                                      */
+         ParseState           = psCOMPILING;
+
+         /* Initialize the packet information.                          */
+         Packet->PacketType   = PacketType;
+         Packet->PacketLength = 0;
+         Packet->PacketData   = ((unsigned char *)Packet) + sizeof(QPKTZR_Packet_t);
+
+         PacketBuffer         = Packet->PacketData;
+
+         /* Now, go ahead and copy the header over and                  */
+         /* fix up the remaining length of expected data.               */
+         if((PacketType == QPKTZR_PACKET_TYPE_15_4) || (PacketType == QPKTZR_PACKET_TYPE_COEX) || (PacketType == QPKTZR_PACKET_TYPE_UART))
+         {
+            /* Simply set the Packet Index to zero, the                 */
+            /* Packet Length will be the length that was                */
+            /* already read (i.e.  no need to copy any                  */
+            /* header).                                                 */
+            PacketIndex  = 0;
+         }
+         else
+         {
+            /* Bluetooth HCI Packet, we need to copy over               */
+            /* the existing header and fix up the packet                */
+            /* buffer.                                                  */
+            /* * NOTE * Keep in mind that we are actually               */
+            /*          copying the header size PLUS the                */
+            /*          next byte we already consumed.                  */
+            _COPY_PACKETIZER_MEMORY(PacketBuffer, PacketHeader, HCIHeaderInformation[PacketType].HeaderLength);
+
+            /* Check to see if the packet has been completely received. */
+            if(!PacketLength)
+               ret_val = VerifyParsedPacket();
+         }
+      }
+      else
+      {
+         /* Unable to allocate memory, go ahead and                     */
+         /* silently fail and try to recover.                           */
+         ParseState = psLOOKING;
+      }
+   }
+   else
+      ParseState = psLOOKING;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
    /* The following function is a utility function that exists to       */
    /* calculate the Checksum for a TABI packet given the specified data.*/
+   /* * NOTE * The checksum is the negated sum of the bytes, so the     */
+   /*          bytes are summed a word at a time (the four byte lanes   */
+   /*          are folded into one) and the sum is negated at the end.  */
 static uint8_t CalculateTABIChecksum(unsigned int Length, unsigned char *Data)
 {
-   uint8_t ret_val = 0;
+   uint32_t Sum = 0;
+   uint32_t Word;
 
    /* Loop through data and calculate the TABI checksum.                */
+   while(Length >= sizeof(uint32_t))
+   {
+      Word    = READ_UNALIGNED_LITTLE_ENDIAN_UINT32(Data);
+      Word    = (Word & 0x00FF00FF) + ((Word >> 8) & 0x00FF00FF);
+      Sum    += Word + (Word >> 16);
+
+      Data   += sizeof(uint32_t);
+      Length -= sizeof(uint32_t);
+   }
+
    while(Length--)
    {
-      ret_val -= *Data;
+      Sum += *Data;
 
       Data++;
    }
 
    /* Return the result to the caller.                                  */
-   return(ret_val);
+   return((uint8_t)(0 - Sum));
 }
 
    /* The following function is an internal function that exists to     */
@@ -24,6 +24,7 @@ IF /I "%CFG_FEATURE_PERIPHERALS%" == "" (SET CFG_FEATURE_PERIPHERALS=true)
 IF /I "%CFG_FEATURE_PLATFORM%" == ""    (SET CFG_FEATURE_PLATFORM=true)
 IF /I "%CFG_FEATURE_ECOSYSTEM%" == ""   (SET CFG_FEATURE_ECOSYSTEM=true)
 IF /I "%CFG_FEATURE_KPI_DEMO%" == ""    (SET CFG_FEATURE_KPI_DEMO=false)
+IF /I "%CFG_FEATURE_QMESH_TIMER_WHEEL%" == "" (SET CFG_FEATURE_QMESH_TIMER_WHEEL=false)
 IF /I "%CFG_FEATURE_JSON%" == ""        (SET CFG_FEATURE_JSON=true)
 IF /I "%CFG_FEATURE_NET%" == ""         (SET CFG_FEATURE_NET=true)
 IF /I "%CFG_FEATURE_NET_PING%" == ""    (SET CFG_FEATURE_NET_PING=true)
@@ -50,6 +51,7 @@ IF /I "%CFG_FEATURE_CRYPTO_UNIT_TEST%" == "" (SET CFG_FEATURE_CRYPTO_UNIT_TEST=t
 IF /I "%CFG_FEATURE_CRYPTO_BASE64%" == ""    (SET CFG_FEATURE_CRYPTO_BASE64=true)
 IF /I "%CFG_FEATURE_CRYPTO_PERSISTENT_OBJECT%" == ""   (SET CFG_FEATURE_CRYPTO_PERSISTENT_OBJECT=true)
 IF /I "%CFG_FEATURE_CRYPTO_ATTESTATION%" == ""   (SET CFG_FEATURE_CRYPTO_ATTESTATION=true)
+IF /I "%CFG_FEATURE_CRYPTO_BENCH%" == ""   (SET CFG_FEATURE_CRYPTO_BENCH=true)
 
 REM Determine the RTOS to build. Default to freertos.
 IF /I "%~1" == "" (
@@ -163,6 +165,7 @@ SET LIBSFILE="%OutDir%\LinkerLibs.txt"
 SET ThirdpartyDir=..\..\..\..
 SET EcosystemRoot=..\..\..\ecosystem
 SET MeshModelsCommonCode=..\..\..\..\qmesh\models\common
+SET MeshPlatformCode=..\..\..\..\qmesh\platform\qca402x\src
 SET MeshClientModels=..\..\..\..\qmesh\models\client
 SET MeshServerModels=..\..\..\..\qmesh\models\server
 
@@ -195,6 +198,7 @@ SET CWallSrcs=
 SET CSrcs=sbrk.c
 SET CSrcs=%CSrcs% qcli\qcli.c
 SET CSrcs=%CSrcs% qcli\qcli_util.c
+SET CSrcs=%CSrcs% qcli\qcli_log.c
 SET CSrcs=%CSrcs% qcli\pal.c
 
 IF /I "%CFG_FEATURE_THREAD%" == "true" (
@@ -232,6 +236,7 @@ IF /I "%CFG_FEATURE_ZIGBEE%" == "true" (
    SET CSrcs=!CSrcs! zigbee\clusters\zcl_relhumid_demo.c
 )
 SET CSrcs=%CSrcs% spple\spple_demo.c
+SET CSrcs=%CSrcs% spple\ble_conn_table.c
 SET CSrcs=%CSrcs% spple\ota\ble_ota_service.c
 SET CSrcs=%CSrcs% hmi\hmi_demo.c
 SET CSrcs=%CSrcs% coex\coex_demo.c
@@ -300,16 +305,19 @@ SET CWallSrcs=%CWallSrcs% fs\fs_demo.c
 SET CWallSrcs=%CWallSrcs% securefs\securefs_demo.c
 SET CWallSrcs=%CWallSrcs% crypto\crypto_demo.c
 SET CWallSrcs=%CWallSrcs% crypto\crypto_helper.c
+SET CWallSrcs=%CWallSrcs% crypto\crypto_bench.c
 SET CWallSrcs=%CWallSrcs% crypto\persistent_obj_demo.c
 SET CWallSrcs=%CWallSrcs% platform\platform_demo.c
 REM SET CSrcs=%CSrcs% thread\thread_demo.c
 SET CSrcs=%CSrcs% sensors\sensors_demo.c
 SET CSrcs=%CSrcs% sensors\sensors.c
+SET CSrcs=%CSrcs% sensors\sensors_sampler.c
 SET CSrcs=%CSrcs% sensors\aws_sensors.c
 SET CSrcs=%CSrcs% adc\adc_demo.c
 SET CSrcs=%CSrcs% adc\adc.c
 SET CSrcs=%CSrcs% pwm\pwm_demo.c
 SET CSrcs=%CSrcs% pwm\pwm.c
+SET CSrcs=%CSrcs% pwm\lock_actuator.c
 SET CSrcs=%CSrcs% keypad\keypad_demo.c
 SET CSrcs=%CSrcs% keypad\keypad.c
 SET CSrcs=%CSrcs% peripherals\peripherals_demo.c
@@ -352,10 +360,13 @@ IF /I "%QMESH%"=="true" (
    SET CSrcs=!CSrcs! !MeshClientModels!\generic_power_level_client.c
    SET CSrcs=!CSrcs! !MeshClientModels!\light_lightness_client.c
    SET CSrcs=!CSrcs! !MeshClientModels!\light_hsl_client.c
+   REM The timing wheel soft timers replace the ones of the prebuilt qmesh.lib.
+   IF /I "%CFG_FEATURE_QMESH_TIMER_WHEEL%" == "true" (SET CSrcs=!CSrcs! !MeshPlatformCode!\qmesh_soft_timers.c)
    SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_cache_mgmt.c
    SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_delay_cache.c
    SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_model_common.c
    SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_model_debug.c
+   SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_transition_engine.c
    SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_model_nvm.c
    SET CWallSrcs=!CWallSrcs! !MeshModelsCommonCode!\qmesh_light_utilities.c
    SET CSrcs=!CSrcs! !MeshServerModels!\qmesh_generic_default_transition_time_handler.c
@@ -378,6 +389,8 @@ IF /I "%QMESH%"=="true" (
 IF "%ENABLE_CPU_PROFILER%"=="1" (
     SET CSrcs=!CSrcs! cpu_profiler\cpu_profiler_demo.c
     SET CSrcs=!CSrcs! cpu_profiler\cpu_profiler_demo_ram.c
+    SET CSrcs=!CSrcs! cpu_profiler\cpu_profiler_stack.c
+    SET CSrcs=!CSrcs! cpu_profiler\cpu_profiler_symbols.c
     SET CSrcs=!CSrcs! cpu_profiler\cpu_profiler_interrupt_asm.S
 )
 
@@ -694,6 +707,7 @@ IF /I "%CFG_FEATURE_CRYPTO_UNIT_TEST%" == "true"      (SET Defines=!Defines! "-D
 IF /I "%CFG_FEATURE_CRYPTO_BASE64%" == "true"  (SET Defines=!Defines! "-D CONFIG_CRYPTO_BASE64_DEMO")
 IF /I "%CFG_FEATURE_CRYPTO_PERSISTENT_OBJECT%" == "true" (SET Defines=!Defines! "-D CONFIG_CRYPTO_PERSISTENT_OBJECT_DEMO")
 IF /I "%CFG_FEATURE_CRYPTO_ATTESTATION%" == "true"  (SET Defines=!Defines! "-D CONFIG_CRYPTO_ATTESTATION_DEMO")
+IF /I "%CFG_FEATURE_CRYPTO_BENCH%" == "true"  (SET Defines=!Defines! "-D CONFIG_CRYPTO_BENCH_DEMO")
 
 IF /I "%QMESH%"=="true" (
   SET Defines=!Defines! "-D CONFIG_QMESH_DEMO"
@@ -889,6 +903,8 @@ IF "%ENABLE_CPU_PROFILER%"=="1" (
     for /f "usebackq" %%A in (`TYPE %SymFileUnpatched% ^| find /v /c "" `) do set libs_numlines=%%A
     set /a "numlines=%demo_numlines%+%libs_numlines%"
     python %ScriptDir%\update_uint32_symbol_value_by_name.py %OutDir%\%Project%_orig.elf %OutDir%\%Project%.elf g_cpu_profiler_number_of_functions %numlines%
+    copy /y %OutDir%\%Project%.elf %OutDir%\%Project%_nosymtab.elf
+    python %ScriptDir%\cpuProfilerSymbolTable.py %OutDir%\%Project%.elf %OutDir%\%Project%_nosymtab.elf %SymFileUnpatched%
 )
 
 REM Hash
@@ -42,16 +42,6 @@ ADSS_RET_STATUS adss_playOnWifi_Init()
         return ADSS_NO_MEMORY;
     }
     memset(adss_ftp_session, '\0', sizeof(ADSS_FTP_SESSION_t));
-	
-	qurt_signal_init(&adss_ftp_session->buf_signal);
-	
-	qurt_mutex_init(&adss_ftp_session->buf_empty_mutex);
-	qurt_signal_init(&adss_ftp_session->buf_empty_signal);
-	
-	qurt_mutex_init(&adss_ftp_session->buf_data_mutex);
-	qurt_signal_init(&adss_ftp_session->buf_data_signal);
-
-	qurt_mutex_init(&adss_ftp_session->buf_free_link_mutex);
 
     return ADSS_SUCCESS;
 }
@@ -77,13 +67,8 @@ ADSS_RET_STATUS adss_Ftp_Fin(void)
     /* Clean up and free all resources */
     if(adss_ftp_session != NULL) {
 		
-		qurt_signal_delete(&adss_ftp_session->buf_signal);
-		qurt_signal_delete(&adss_ftp_session->buf_empty_signal);
-		qurt_signal_delete(&adss_ftp_session->buf_data_signal);
-	
-		qurt_mutex_delete(&adss_ftp_session->buf_empty_mutex);	
-		qurt_mutex_delete(&adss_ftp_session->buf_data_mutex);
-		qurt_mutex_delete(&adss_ftp_session->buf_free_link_mutex);
+		adss_buf_ring_deinit(&adss_ftp_session->empty_ring);
+		adss_buf_ring_deinit(&adss_ftp_session->data_ring);
 		
         free(adss_ftp_session);
         adss_ftp_session = NULL;
@@ -849,204 +834,31 @@ qapi_Status_t adss_Send_Speaker_Init(uint32_t buf_len, uint32_t pkt_count)
  */
 ADSS_RET_STATUS  init_buf_link(int size)
 {
-	Data_Buf_Link_t  *p;
-	uint32_t   i;
-	
-    adss_ftp_session->m_pFreeLink = malloc(sizeof(Data_Buf_Link_t) * size);
-
-    if (adss_ftp_session->m_pFreeLink == NULL) {
-        return ADSS_NO_MEMORY;
-    }
-
-	p = adss_ftp_session->m_pFreeLink;
-	p->next = NULL;
-	p++;
-	
-	for (i=0; i < size - 1; i++, p++)
-		release_buf_link(p);
-
-	return ADSS_SUCCESS;
-}
-
-Data_Buf_Link_t  *get_buf_link()
-{
-	Data_Buf_Link_t  *p;
-	
-	qurt_mutex_lock(&adss_ftp_session->buf_free_link_mutex);	
-	p = adss_ftp_session->m_pFreeLink;
-	if (p)	
-		adss_ftp_session->m_pFreeLink = p->next;	
-	qurt_mutex_unlock(&adss_ftp_session->buf_free_link_mutex);	/* unlock */
-	return p;
-}
-
-void release_buf_link(Data_Buf_Link_t *p)
-{
-	qurt_mutex_lock(&adss_ftp_session->buf_free_link_mutex);	
-	p->next = adss_ftp_session->m_pFreeLink;
-	adss_ftp_session->m_pFreeLink = p;	
-	qurt_mutex_unlock(&adss_ftp_session->buf_free_link_mutex);	/* unlock */
-} 
-
-uint8_t *get_ftp_data_buf()
-{
-	uint32_t num = 0;
-	uint32_t  signals;
-	Data_Buf_Link_t  *p;
-	uint8_t *pdata;
-	
-	do {
-		qurt_mutex_lock(&adss_ftp_session->buf_data_mutex);
-		if (adss_ftp_session->m_pDataLink != NULL)
-		{
-			p = adss_ftp_session->m_pDataLink;
-			adss_ftp_session->m_pDataLink = p->next;
-			num = 1;
-		}	
-		qurt_mutex_unlock(&adss_ftp_session->buf_data_mutex);	/* unlock */
-		if (num != 0)
-		{
-			pdata = p->buf_ptr;
-			release_buf_link(p);
-
-			return pdata;			
-		}
-				
-		signals = qurt_signal_wait(&adss_ftp_session->buf_data_signal, ADSS_DATA_BUF_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);	
-	} while (signals & ADSS_DATA_BUF_AVAIL_SIG_MASK);
-
-    return NULL;	
-}
-
-uint8_t *peek_get_ftp_data_buf()
-{
-	uint32_t num = 0;
-	Data_Buf_Link_t  *p;
-	uint8_t *pdata;
-	
-	do {
-		qurt_mutex_lock(&adss_ftp_session->buf_data_mutex);
-		if (adss_ftp_session->m_pDataLink != NULL)
-		{
-			p = adss_ftp_session->m_pDataLink;
-			adss_ftp_session->m_pDataLink = p->next;
-			num = 1;
-		}	
-		qurt_mutex_unlock(&adss_ftp_session->buf_data_mutex);	/* unlock */
-		if (num != 0)
-		{
-			pdata = p->buf_ptr;
-			release_buf_link(p);
-
-			return pdata;			
-		}				
-	} while (0);
-	
-    return NULL;	
-}
+	ADSS_RET_STATUS rtn;
 
-uint8_t *put_ftp_data_buf(uint8_t *pbuf)
-{
-	Data_Buf_Link_t  *p;
+	rtn = adss_buf_ring_init(&adss_ftp_session->empty_ring, size);
+	if (rtn != ADSS_SUCCESS)
+		return rtn;
 
-	p = get_buf_link();	
-    p->buf_ptr = pbuf;
-	
-	p->next = NULL;			
-	qurt_mutex_lock(&adss_ftp_session->buf_data_mutex);
-	if (adss_ftp_session->m_pDataLink != NULL)
+	rtn = adss_buf_ring_init(&adss_ftp_session->data_ring, size);
+	if (rtn != ADSS_SUCCESS)
 	{
-		adss_ftp_session->m_pDataLink_Trail->next = p;
-		adss_ftp_session->m_pDataLink_Trail = p;	
-	}
-	else 
-	{
-		adss_ftp_session->m_pDataLink = p;		
-		adss_ftp_session->m_pDataLink_Trail = p;		
+		adss_buf_ring_deinit(&adss_ftp_session->empty_ring);
+		return rtn;
 	}
-		
-	qurt_mutex_unlock(&adss_ftp_session->buf_data_mutex);	/* unlock */
-				
-	qurt_signal_set(&adss_ftp_session->buf_data_signal, ADSS_DATA_BUF_AVAIL_SIG_MASK);
-	return  NULL;
-}
-
-uint8_t *get_ftp_empty_buf()
-{
-	uint32_t num = 0;
-	uint32_t  signals;
-	Data_Buf_Link_t  *p;
-	uint8_t  *pempty;
-	
-	do {
-		qurt_mutex_lock(&adss_ftp_session->buf_empty_mutex);
-		if (adss_ftp_session->m_pEmptyLink != NULL)
-		{
-			p = adss_ftp_session->m_pEmptyLink;
-			adss_ftp_session->m_pEmptyLink = p->next;
-			num = 1;
-		}	
-		qurt_mutex_unlock(&adss_ftp_session->buf_empty_mutex);	/* unlock */
-		if (num != 0)
-		{
-			pempty = p->buf_ptr;
-			release_buf_link(p);
-			return 	pempty;		
-		}
-				
-		signals = qurt_signal_wait(&adss_ftp_session->buf_empty_signal, ADSS_EMPTY_BUF_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);	
-	} while (signals & ADSS_EMPTY_BUF_AVAIL_SIG_MASK);
 
-    return NULL;	
+	return ADSS_SUCCESS;
 }
 
-uint8_t *peek_get_ftp_empty_buf()
+void adss_ftp_print_buf_stats(void)
 {
-	uint32_t num = 0;
-	Data_Buf_Link_t  *p;
-	uint8_t  *pempty;
-	
-	do {
-		qurt_mutex_lock(&adss_ftp_session->buf_empty_mutex);
-		if (adss_ftp_session->m_pEmptyLink != NULL)
-		{
-			p = adss_ftp_session->m_pEmptyLink;
-			adss_ftp_session->m_pEmptyLink = p->next;
-			num = 1;
-		}	
-		qurt_mutex_unlock(&adss_ftp_session->buf_empty_mutex);	/* unlock */
-		if (num != 0)
-		{
-			pempty = p->buf_ptr;
-			release_buf_link(p);
-			return 	pempty;		
-		}			
-	} while (0);
-	
-	return NULL;
-}
+	ADSS_BUF_RING_STATS_t  data, empty;
 
-void put_ftp_empty_buf(uint8_t *pbuf)
-{
-	Data_Buf_Link_t  *p;
-	
-    p = get_buf_link();	
-	p->buf_ptr = pbuf;
-	
-	qurt_mutex_lock(&adss_ftp_session->buf_empty_mutex);
-	if (adss_ftp_session->m_pEmptyLink != NULL)
-	{
-		p->next = adss_ftp_session->m_pEmptyLink;
-	}
-	else
-	{
-		p->next = NULL;
-	}
-	adss_ftp_session->m_pEmptyLink = p;
-	
-	qurt_mutex_unlock(&adss_ftp_session->buf_empty_mutex);	/* unlock */
-		
-	qurt_signal_set(&adss_ftp_session->buf_empty_signal, ADSS_EMPTY_BUF_AVAIL_SIG_MASK);	
+	adss_buf_ring_get_stats(&adss_ftp_session->data_ring, &data);
+	adss_buf_ring_get_stats(&adss_ftp_session->empty_ring, &empty);
+
+	ADSS_FTP_DEBUG_PRINTF("data ring: underrun:%d overrun:%d max level:%d\r\n", data.underruns, data.overruns, data.max_level);
+	ADSS_FTP_DEBUG_PRINTF("empty ring: underrun:%d overrun:%d max level:%d\r\n", empty.underruns, empty.overruns, empty.max_level);
 }
 
 void ftp_data_receive_task(void *param)
@@ -1071,16 +883,19 @@ void ftp_data_receive_task(void *param)
 	rtn = adss_Ftp_Recv_Data((uint8_t *)&adss_ftp_session->wav_fmt, sizeof(adss_ftp_session->wav_fmt), &ret_size);
 	
 	do {
-		pbuf = get_ftp_empty_buf();
+		pbuf = adss_buf_ring_wait_get(&adss_ftp_session->empty_ring);
 		if (pbuf == NULL)
 			break;
 		
 		rtn = adss_Ftp_Recv_Data(pbuf, buf_len, &ret_size);
 		if (rtn != ADSS_SUCCESS)
 			break;
-		put_ftp_data_buf(pbuf);
+		adss_buf_ring_put(&adss_ftp_session->data_ring, pbuf);
 	} while (1);
 	
+	/* release a player still prefetching */
+	adss_buf_ring_abort(&adss_ftp_session->data_ring);
+
 	adss_ftp_session->thread_id = 0;
 	
 	qurt_signal_set(&adss_ftp_session->adss_dma_cb_signal, ADSS_WAV_FILE_DL_DONE_SIG_MASK);
@@ -1142,16 +957,22 @@ ADSS_RET_STATUS adss_Ftp_play_wifi(const char* interface_name, char *url, uint32
 	for (i=0; i < pkt_count; i++)
 	{
 		status = qapi_I2S_Get_Buffer(&pbuf);
-		put_ftp_empty_buf(pbuf);
+		adss_buf_ring_put(&adss_ftp_session->empty_ring, pbuf);
 	}
 
+	/* prefetch a full set of descriptors before starting DMA */
+	adss_buf_ring_wait_level(&adss_ftp_session->data_ring, pkt_count);
+
 	for (i=0; i < pkt_count; i++)
 	{
-		pbuf_v[i] = get_ftp_data_buf();
+		pbuf_v[i] = adss_buf_ring_get(&adss_ftp_session->data_ring);
+		if (pbuf_v[i] == NULL)
+			break;
 	    ADSS_FTP_DEBUG_PRINTF("Data buffer: %p\r\n", pbuf_v[i]);
 	}
 	
-	qapi_I2S_Send_Receive(hdI2S, pbuf_v, pkt_count, NULL, NULL, 0);
+	if (i != 0)
+		qapi_I2S_Send_Receive(hdI2S, pbuf_v, i, NULL, NULL, 0);
 
 	do
 	{
@@ -1160,9 +981,10 @@ ADSS_RET_STATUS adss_Ftp_play_wifi(const char* interface_name, char *url, uint32
 			break;
 		
 		status = qapi_I2S_Get_Buffer(&pbuf);
-		put_ftp_empty_buf(pbuf);
+		if (adss_buf_ring_put(&adss_ftp_session->empty_ring, pbuf) != ADSS_SUCCESS)
+			qapi_I2S_Release_Buffer(pbuf);
 
-		pbuf = peek_get_ftp_data_buf();
+		pbuf = adss_buf_ring_get(&adss_ftp_session->data_ring);
 
 		if (pbuf != NULL)
 		{
@@ -1172,7 +994,7 @@ ADSS_RET_STATUS adss_Ftp_play_wifi(const char* interface_name, char *url, uint32
 
 	audio_echo_loop_flag = 0;
 	
-	qurt_signal_set(&adss_ftp_session->buf_empty_signal, ADSS_USR_TASK_DONE_SIG_MASK);
+	adss_buf_ring_abort(&adss_ftp_session->empty_ring);
 	while (adss_ftp_session->thread_id != 0)
 	{
 		qurt_thread_sleep (duration);		
@@ -1180,6 +1002,7 @@ ADSS_RET_STATUS adss_Ftp_play_wifi(const char* interface_name, char *url, uint32
 
 	qurt_signal_delete(&adss_ftp_session->adss_dma_cb_signal);
 	
+	adss_ftp_print_buf_stats();
 	adss_Ftp_Fin();
 
 	qapi_I2S_Deinit (hdI2S);
@@ -12,6 +12,8 @@
 #ifndef __ADSS_FTP__H__
 #define __ADSS_FTP__H__
 
+#include "adss_mem.h"
+
 #define		FTP_THREAD_STACK_SIZE       2048
 #define		FTP_THREAD_PRIORITY         9
 #define     FTP_THREAD_NAME             "ftp_audio"
@@ -32,11 +34,6 @@ typedef struct wave_fmt_s {
 	uint32_t  SubChunk2Size;
 } ADSS_WAVE_FMT_t;
 
-typedef struct data_buf_link_s {
-	struct data_buf_link_s  *next;
-	uint8_t   *buf_ptr;
-} Data_Buf_Link_t;
-
 #define ADSS_FTP_CMD_BUF_MAX                 256
 
 #define ADSS_EMPTY_BUF_AVAIL_SIG_MASK          0x01
@@ -91,19 +88,9 @@ typedef struct adss_ftp_session_s {
 	
 	qurt_thread_t thread_id;
 	qurt_thread_attr_t attr;
-	qurt_signal_t  buf_signal;
-	
-	Data_Buf_Link_t  *m_pEmptyLink;
-	qurt_mutex_t  buf_empty_mutex;
-	qurt_signal_t  buf_empty_signal;
-	
-	Data_Buf_Link_t  *m_pDataLink;
-	Data_Buf_Link_t  *m_pDataLink_Trail;
-	qurt_mutex_t  buf_data_mutex;
-	qurt_signal_t  buf_data_signal;
 
-	Data_Buf_Link_t  *m_pFreeLink;
-	qurt_mutex_t  buf_free_link_mutex;
+	ADSS_BUF_RING_t  empty_ring;       /* free I2S buffers waiting to be filled   */
+	ADSS_BUF_RING_t  data_ring;        /* filled I2S buffers                      */
 
 	qurt_signal_t  adss_dma_cb_signal;
 	
@@ -127,15 +114,10 @@ ADSS_RET_STATUS adss_Ftp_Close_Control_Sock(void);
 ADSS_RET_STATUS adss_Ftp_Close_Data_Connect_Sock(void);
 
 ADSS_RET_STATUS adss_Ftp_Send_Cmd_Resp(char *cmd, char *param, int *resp_code);
-void release_buf_link(Data_Buf_Link_t *p);
-uint8_t *get_ftp_empty_buf();
-uint8_t *get_ftp_data_buf();
-uint8_t *peek_get_ftp_empty_buf();
 ADSS_RET_STATUS adss_Ftp_Recv_Data(uint8_t *buffer, uint32_t buf_len, uint32_t *ret_size);
-uint8_t *put_ftp_data_buf(uint8_t *pbuf);
-void put_ftp_empty_buf(uint8_t *pbuf);
 ADSS_RET_STATUS adss_playOnWifi_Init();
 ADSS_RET_STATUS  init_buf_link(int size);
+void adss_ftp_print_buf_stats(void);
 ADSS_RET_STATUS adss_Ftp_Fin(void);
 
 void tcp_socket_data_send_task(void *param);
@@ -139,7 +139,8 @@ void adss_mbox_ftp_rec_dma_callback(void *hd, uint32_t status, void *param)
 {
     send_count++;
 
-	put_ftp_data_buf(param);
+	if (adss_buf_ring_put(&adss_ftp_session->data_ring, param) != ADSS_SUCCESS)
+		qapi_I2S_Release_Buffer(param);
 
 	qurt_signal_set(&adss_ftp_session->adss_dma_cb_signal, ADSS_DMA_CALLBACK_SIG_MASK);
 }
@@ -181,7 +182,7 @@ void tcp_socket_data_send_task(void *param)
  */
  
 	do {
-		pbuf = get_ftp_data_buf();
+		pbuf = adss_buf_ring_wait_get(&adss_ftp_session->data_ring);
 	    if (pbuf == NULL)
 			break;
 		
@@ -189,7 +190,7 @@ void tcp_socket_data_send_task(void *param)
 		
 		if (rtn != ADSS_SUCCESS)
 			break;
-		put_ftp_empty_buf(pbuf);
+		adss_buf_ring_put(&adss_ftp_session->empty_ring, pbuf);
 	} while (1);
 	
 	adss_ftp_session->thread_id = 0;
@@ -257,7 +258,7 @@ ADSS_RET_STATUS adss_Tcp_socket_rec_wifi(char* srv_ip_addr, uint16_t port, uint3
 	do
 	{
 		qurt_signal_wait(&adss_ftp_session->adss_dma_cb_signal, ADSS_DMA_CALLBACK_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);		
-		pbuf = peek_get_ftp_empty_buf();
+		pbuf = adss_buf_ring_get(&adss_ftp_session->empty_ring);
 		if (pbuf != NULL)
 		{
 			status = qapi_I2S_Receive_Data(hdI2S, pbuf, buf_len, &sent_len);	  			
@@ -265,7 +266,7 @@ ADSS_RET_STATUS adss_Tcp_socket_rec_wifi(char* srv_ip_addr, uint16_t port, uint3
 	} while (audio_echo_loop_flag);
 	 
 
-	qurt_signal_set(&adss_ftp_session->buf_data_signal, ADSS_USR_TASK_DONE_SIG_MASK);
+	adss_buf_ring_abort(&adss_ftp_session->data_ring);
 	while (adss_ftp_session->thread_id != 0)
 	{
 		qurt_thread_sleep (duration);		
@@ -273,6 +274,7 @@ ADSS_RET_STATUS adss_Tcp_socket_rec_wifi(char* srv_ip_addr, uint16_t port, uint3
 
 	qurt_signal_delete(&adss_ftp_session->adss_dma_cb_signal);
 
+	adss_ftp_print_buf_stats();
 	adss_Ftp_Fin();
 	
 	qapi_I2S_Deinit (hdI2S);
@@ -10,12 +10,9 @@
 #include <stdint.h>
 #include <string.h>
 #include "qurt_signal.h"
-#include "qurt_mutex.h"
 #include "qurt_thread.h"
 #include "qapi/qapi_types.h"
 #include "qapi/qapi_status.h"
-#include "qapi/qapi_socket.h"
-#include "qapi/qapi_netservices.h"
 #include "qapi_i2s.h"
 #include <qcli_api.h>
 
@@ -23,8 +20,6 @@
 #include "adss_demo.h"
 #include "adss_mem.h"
 
-#include "netutils.h"
-
 
 extern QCLI_Group_Handle_t qcli_adss_group;              /* Handle for our QCLI Command Group. */
 
@@ -38,303 +33,160 @@ extern QCLI_Group_Handle_t qcli_adss_group;              /* Handle for our QCLI
 #endif
 
 /*
- *  buffer management
+ *  buffer ring
  */
 
-ADSS_MEM_SESSION_t  *m_pAdssMem=NULL;
+#define ADSS_BUF_RING_BARRIER()     __sync_synchronize()
 
-ADSS_RET_STATUS  adss_init_buf_link(int head_count)
+ADSS_RET_STATUS adss_buf_ring_init(ADSS_BUF_RING_t *ring, uint32_t count)
 {
-	ADSS_DATA_BUF_LINK_t  *p;
-	uint32_t   i;
+	uint32_t   size = 1;
+
+	while (size < count)
+		size <<= 1;
 
-    ADSS_DEBUG_PRINTF("Mem Init head count:%d\r\n", head_count);
-	if (m_pAdssMem != NULL)
+	memset(ring, 0, sizeof(ADSS_BUF_RING_t));
+
+	ring->slots = (uint8_t **)malloc(sizeof(uint8_t *) * size);
+	if (ring->slots == NULL)
 	{
-		ADSS_DEBUG_PRINTF("more than one time Mem Init\r\n");
+		ADSS_DEBUG_PRINTF("No Mem\r\n");
 		return ADSS_NO_MEMORY;
 	}
-	
-    m_pAdssMem = (ADSS_MEM_SESSION_t *)malloc(sizeof(ADSS_MEM_SESSION_t));
-    if (m_pAdssMem == NULL) {
-        ADSS_DEBUG_PRINTF("No Mem\r\n");
-        return ADSS_NO_MEMORY;
-    }
-	memset(m_pAdssMem, 0, sizeof(ADSS_MEM_SESSION_t));
-	
-    m_pAdssMem->m_pLinkBuffAddr = (ADSS_DATA_BUF_LINK_t *)malloc(sizeof(ADSS_DATA_BUF_LINK_t) * head_count);
-
-    if (m_pAdssMem->m_pLinkBuffAddr == NULL) {
-        ADSS_DEBUG_PRINTF("No Mem\r\n");
-		free(m_pAdssMem);
-		m_pAdssMem = NULL;
-        return ADSS_NO_MEMORY;
-    }
-	
-	qurt_signal_init(&m_pAdssMem->buf_signal);	
-	qurt_mutex_init(&m_pAdssMem->buf_empty_mutex);
-	qurt_signal_init(&m_pAdssMem->buf_empty_signal);	
-	qurt_mutex_init(&m_pAdssMem->buf_data_mutex);
-	qurt_signal_init(&m_pAdssMem->buf_data_signal);
-	qurt_mutex_init(&m_pAdssMem->buf_free_link_mutex);
-
-//	p = m_pAdssMem->m_pFreeLink;
-//	p->next = NULL;
-//	p++;
-
-	p = m_pAdssMem->m_pLinkBuffAddr;
-	m_pAdssMem->m_pFreeLink = NULL;
-	for (i=0; i < head_count; i++, p++)
-	{
-        ADSS_DEBUG_PRINTF("link head addr:%p\r\n", p);		
-		adss_release_buf_link(p);
-	}	
+	ring->mask = size - 1;
 
-	return 0;
+	qurt_signal_init(&ring->signal);
+
+	return ADSS_SUCCESS;
 }
 
-ADSS_RET_STATUS  adss_Deinit_buf_link()
+void adss_buf_ring_deinit(ADSS_BUF_RING_t *ring)
 {
-    ADSS_DEBUG_PRINTF("Mem Deinit\r\n");
-	if (m_pAdssMem == NULL)
-	{
-		ADSS_DEBUG_PRINTF("mem no initializing\r\n");
-		return ADSS_NO_MEMORY;
-	}
-	
-    if (m_pAdssMem->m_pLinkBuffAddr != NULL) {
-		free(m_pAdssMem->m_pLinkBuffAddr);
-    }
-	
-	qurt_signal_delete(&m_pAdssMem->buf_signal);	
-	qurt_signal_delete(&m_pAdssMem->buf_empty_signal);	
-	qurt_signal_delete(&m_pAdssMem->buf_data_signal);
-	
-	qurt_mutex_delete(&m_pAdssMem->buf_empty_mutex);
-	qurt_mutex_delete(&m_pAdssMem->buf_data_mutex);
-	qurt_mutex_delete(&m_pAdssMem->buf_free_link_mutex);
-
-	free(m_pAdssMem);
-	m_pAdssMem = NULL;
-	
-	return 0;
+	if (ring->slots == NULL)
+		return;
+
+	qurt_signal_delete(&ring->signal);
+
+	free(ring->slots);
+	ring->slots = NULL;
 }
 
-ADSS_DATA_BUF_LINK_t  *adss_get_buf_link()
+uint32_t adss_buf_ring_level(ADSS_BUF_RING_t *ring)
 {
-	ADSS_DATA_BUF_LINK_t  *p;
-	
-	qurt_mutex_lock(&m_pAdssMem->buf_free_link_mutex);	
-	p = m_pAdssMem->m_pFreeLink;
-	if (p)	
-		m_pAdssMem->m_pFreeLink = p->next;	
-	qurt_mutex_unlock(&m_pAdssMem->buf_free_link_mutex);	/* unlock */
-	return p;
+	return ring->head - ring->tail;
 }
 
-void adss_release_buf_link(ADSS_DATA_BUF_LINK_t *p)
+/*
+ * Called by the producer only. Never blocks, so it may be called from a
+ * DMA callback. The consumer is only signalled once the level it waits
+ * for has been reached.
+ */
+ADSS_RET_STATUS adss_buf_ring_put(ADSS_BUF_RING_t *ring, uint8_t *pbuf)
 {
-	qurt_mutex_lock(&m_pAdssMem->buf_free_link_mutex);	
-	p->next = m_pAdssMem->m_pFreeLink;
-	m_pAdssMem->m_pFreeLink = p;	
-	qurt_mutex_unlock(&m_pAdssMem->buf_free_link_mutex);	/* unlock */
-} 
+	uint32_t   head = ring->head;
+	uint32_t   level = head - ring->tail;
+	uint32_t   wait_level;
 
-uint8_t *adss_get_tcp_data_buf()
-{
-	uint32_t num = 0;
-	uint32_t  signals;
-	ADSS_DATA_BUF_LINK_t  *p;
-	uint8_t *pdata;
-	
-	if(m_pAdssMem == NULL)
+	if (level > ring->mask)
 	{
-		ADSS_DEBUG_PRINTF("m_pAdssMem == NULL\r\n");
-		
-		do {
-		} while(1);
+		ring->overruns++;
+		return ADSS_FAILURE;
 	}
 
-	do {
-		qurt_mutex_lock(&m_pAdssMem->buf_data_mutex);
-		if (m_pAdssMem->m_pDataLink != NULL)
-		{
-			p = m_pAdssMem->m_pDataLink;
-			m_pAdssMem->m_pDataLink = p->next;
-			num = 1;
-			
-#if  defined(STREAM_SPEED_CONTROL)
-			m_pAdssMem->buf_data_count --;
-#endif
-		}	
-		qurt_mutex_unlock(&m_pAdssMem->buf_data_mutex);	/* unlock */
-		if (num != 0)
-		{
-			pdata = p->buf_ptr;
-			adss_release_buf_link(p);
+	ring->slots[head & ring->mask] = pbuf;
+	ADSS_BUF_RING_BARRIER();
+	ring->head = head + 1;
 
-			return pdata;			
-		}
-				
-		signals = qurt_signal_wait(&m_pAdssMem->buf_data_signal, ADSS_DATA_BUF_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);	
-	} while (signals & ADSS_DATA_BUF_AVAIL_SIG_MASK);
+	if (++level > ring->max_level)
+		ring->max_level = level;
 
-    return NULL;	
-}
+	ADSS_BUF_RING_BARRIER();
+	wait_level = ring->wait_level;
+	if ((wait_level != 0) && (level >= wait_level))
+		qurt_signal_set(&ring->signal, ADSS_BUF_RING_AVAIL_SIG_MASK);
 
-uint8_t *adss_peek_get_tcp_data_buf()
-{
-	uint32_t num = 0;
-	ADSS_DATA_BUF_LINK_t  *p;
-	uint8_t *pdata;
-	
-	do {
-		qurt_mutex_lock(&m_pAdssMem->buf_data_mutex);
-		if (m_pAdssMem->m_pDataLink != NULL)
-		{
-			p = m_pAdssMem->m_pDataLink;
-			m_pAdssMem->m_pDataLink = p->next;
-			num = 1;
-		}	
-		qurt_mutex_unlock(&m_pAdssMem->buf_data_mutex);	/* unlock */
-		if (num != 0)
-		{
-			pdata = p->buf_ptr;
-			adss_release_buf_link(p);
-
-			return pdata;			
-		}				
-	} while (0);
-	
-    return NULL;	
+	return ADSS_SUCCESS;
 }
 
-uint8_t *adss_put_tcp_data_buf(uint8_t *pbuf)
+/*
+ * Called by the consumer only. Returns NULL and counts an underrun when
+ * the ring is empty.
+ */
+uint8_t *adss_buf_ring_get(ADSS_BUF_RING_t *ring)
 {
-	ADSS_DATA_BUF_LINK_t  *p;
-
-	p = adss_get_buf_link();	
-    p->buf_ptr = pbuf;
-	
-	p->next = NULL;			
-	qurt_mutex_lock(&m_pAdssMem->buf_data_mutex);
-	if (m_pAdssMem->m_pDataLink != NULL)
-	{
-		m_pAdssMem->m_pDataLink_Trail->next = p;
-		m_pAdssMem->m_pDataLink_Trail = p;	
-	}
-	else 
+	uint32_t   tail = ring->tail;
+	uint8_t    *pbuf;
+
+	if (ring->head == tail)
 	{
-		m_pAdssMem->m_pDataLink = p;		
-		m_pAdssMem->m_pDataLink_Trail = p;		
+		ring->underruns++;
+		return NULL;
 	}
-#if  defined(STREAM_SPEED_CONTROL)
-	m_pAdssMem->buf_data_count ++;
-#endif
-		
-	qurt_mutex_unlock(&m_pAdssMem->buf_data_mutex);	/* unlock */
-				
-	qurt_signal_set(&m_pAdssMem->buf_data_signal, ADSS_DATA_BUF_AVAIL_SIG_MASK);
-	return  NULL;
-}
 
-uint8_t *adss_get_tcp_empty_buf()
-{
-	uint32_t num = 0;
-	uint32_t  signals;
-	ADSS_DATA_BUF_LINK_t  *p;
-	uint8_t  *pempty;
-	
-	do {
-		qurt_mutex_lock(&m_pAdssMem->buf_empty_mutex);
-		if (m_pAdssMem->m_pEmptyLink != NULL)
-		{
-			p = m_pAdssMem->m_pEmptyLink;
-			m_pAdssMem->m_pEmptyLink = p->next;
-#if  defined(STREAM_SPEED_CONTROL)
-			m_pAdssMem->buf_empty_count --;
-#endif
-			num = 1;
-		}	
-		qurt_mutex_unlock(&m_pAdssMem->buf_empty_mutex);	/* unlock */
-		if (num != 0)
-		{
-			pempty = p->buf_ptr;
-			adss_release_buf_link(p);
-			return 	pempty;		
-		}
-				
-		signals = qurt_signal_wait(&m_pAdssMem->buf_empty_signal, ADSS_EMPTY_BUF_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);	
-	} while (signals & ADSS_EMPTY_BUF_AVAIL_SIG_MASK);
+	ADSS_BUF_RING_BARRIER();
+	pbuf = ring->slots[tail & ring->mask];
+	ADSS_BUF_RING_BARRIER();
+	ring->tail = tail + 1;
 
-    return NULL;	
+	return pbuf;
 }
 
-uint8_t *adss_peek_get_tcp_empty_buf()
+/*
+ * Called by the consumer only. Blocks until at least 'level' buffers are
+ * queued (used to prefetch before starting DMA). Returns ADSS_FAILURE if
+ * the ring was aborted first.
+ */
+ADSS_RET_STATUS adss_buf_ring_wait_level(ADSS_BUF_RING_t *ring, uint32_t level)
 {
-	uint32_t num = 0;
-	ADSS_DATA_BUF_LINK_t  *p;
-	uint8_t  *pempty;
-	
-	do {
-		qurt_mutex_lock(&m_pAdssMem->buf_empty_mutex);
-		if (m_pAdssMem->m_pEmptyLink != NULL)
-		{
-			p = m_pAdssMem->m_pEmptyLink;
-			m_pAdssMem->m_pEmptyLink = p->next;
-			num = 1;
-		}	
-		qurt_mutex_unlock(&m_pAdssMem->buf_empty_mutex);	/* unlock */
-		if (num != 0)
+	uint32_t   signals;
+
+	if (level > ring->mask + 1)
+		level = ring->mask + 1;
+
+	while (1)
+	{
+		ring->wait_level = level;
+		ADSS_BUF_RING_BARRIER();
+
+		if (adss_buf_ring_level(ring) >= level)
+			break;
+
+		signals = qurt_signal_wait(&ring->signal, ADSS_BUF_RING_SIG_MASK, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+		if (signals & ADSS_BUF_RING_ABORT_SIG_MASK)
 		{
-			pempty = p->buf_ptr;
-			adss_release_buf_link(p);
-			return 	pempty;		
+			ring->wait_level = 0;
+			return ADSS_FAILURE;
 		}
-				
-//		qurt_signal_wait(&m_pAdssMem->buf_empty_signal, ADSS_USR_SEND_DONE_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);	
-	} while (0);
-	
-	return NULL;
+	}
+
+	ring->wait_level = 0;
+	return ADSS_SUCCESS;
 }
 
-void adss_put_tcp_empty_buf(uint8_t *pbuf)
+/*
+ * Called by the consumer only. Blocks until a buffer is available, returns
+ * NULL if the ring was aborted first.
+ */
+uint8_t *adss_buf_ring_wait_get(ADSS_BUF_RING_t *ring)
 {
-	ADSS_DATA_BUF_LINK_t  *p;
-	
-    p = adss_get_buf_link();	
-	p->buf_ptr = pbuf;
-	
-	qurt_mutex_lock(&m_pAdssMem->buf_empty_mutex);
-	if (m_pAdssMem->m_pEmptyLink != NULL)
+	if (ring->head == ring->tail)
 	{
-		p->next = m_pAdssMem->m_pEmptyLink;
+		if (adss_buf_ring_wait_level(ring, 1) != ADSS_SUCCESS)
+			return NULL;
 	}
-	else
-	{
-		p->next = NULL;
-	}
-	m_pAdssMem->m_pEmptyLink = p;
 
-#if  defined(STREAM_SPEED_CONTROL)
-	m_pAdssMem->buf_empty_count ++;
-#endif
-	
-	qurt_mutex_unlock(&m_pAdssMem->buf_empty_mutex);	/* unlock */
-		
-	qurt_signal_set(&m_pAdssMem->buf_empty_signal, ADSS_EMPTY_BUF_AVAIL_SIG_MASK);	
+	return adss_buf_ring_get(ring);
 }
 
-#if  defined(STREAM_SPEED_CONTROL)
-uint32_t adss_get_empty_buf_count()
+void adss_buf_ring_abort(ADSS_BUF_RING_t *ring)
 {
-	uint32_t   count;
-	
-	qurt_mutex_lock(&m_pAdssMem->buf_empty_mutex);
-	count = m_pAdssMem->buf_empty_count;
-	m_pAdssMem->buf_empty_count = 0;
-	qurt_mutex_unlock(&m_pAdssMem->buf_empty_mutex);	/* unlock */
-	
-	return count;
+	qurt_signal_set(&ring->signal, ADSS_BUF_RING_ABORT_SIG_MASK);
+}
+
+void adss_buf_ring_get_stats(ADSS_BUF_RING_t *ring, ADSS_BUF_RING_STATS_t *stats)
+{
+	stats->level     = adss_buf_ring_level(ring);
+	stats->overruns  = ring->overruns;
+	stats->underruns = ring->underruns;
+	stats->max_level = ring->max_level;
 }
-#endif
@@ -6,75 +6,60 @@
  */
 
 /**
-   @brief This function registers the ADSS demo commands with QCLI.
+   @brief Single producer / single consumer ring of audio buffer pointers.
+
+   The producer only writes head and the overrun/level counters, the
+   consumer only writes tail and the underrun counter, so neither side
+   takes a lock and any context (including a DMA callback) can read the
+   counters at any time. The buffers themselves come from the I2S buffer
+   pool and are therefore already DMA aligned.
 */
-   
+
 #ifndef __ADSS_MEM__H__
 #define __ADSS_MEM__H__
 
-typedef struct adss_data_buf_link_s {
-	struct adss_data_buf_link_s  *next;
-	uint8_t   *buf_ptr;
-} ADSS_DATA_BUF_LINK_t;
-
-#define ADSS_FTP_CMD_BUF_MAX                 256
-
-#define ADSS_EMPTY_BUF_AVAIL_SIG_MASK          0x01
-#define ADSS_DATA_BUF_AVAIL_SIG_MASK           0x02
-#define ADSS_USR_TASK_DONE_SIG_MASK            0x04
-
-#define ADSS_EMPTY_BUF_SIG_MASK     (ADSS_EMPTY_BUF_AVAIL_SIG_MASK | ADSS_USR_TASK_DONE_SIG_MASK)
-#define ADSS_DATA_BUF_SIG_MASK      (ADSS_DATA_BUF_AVAIL_SIG_MASK | ADSS_USR_TASK_DONE_SIG_MASK)
-
-#define ADSS_DMA_CALLBACK_SIG_MASK             0x08
-#define ADSS_WAV_FILE_DL_DONE_SIG_MASK         0x10
-
-#define ADSS_DMA_WAV_DL_SIG_MASK               (ADSS_DMA_CALLBACK_SIG_MASK | ADSS_WAV_FILE_DL_DONE_SIG_MASK)
-
-
-typedef struct adss_mem_session_s {
-
-	qurt_signal_t    buf_signal;
-
-	ADSS_DATA_BUF_LINK_t  *m_pEmptyLink;
-	qurt_mutex_t     buf_empty_mutex;
-	qurt_signal_t    buf_empty_signal;
-	
-	ADSS_DATA_BUF_LINK_t  *m_pDataLink;
-	ADSS_DATA_BUF_LINK_t  *m_pDataLink_Trail;
-	qurt_mutex_t     buf_data_mutex;
-	qurt_signal_t    buf_data_signal;
-
-#if  defined(STREAM_SPEED_CONTROL)	
-	uint32_t		 buf_empty_count;
-	uint32_t		 buf_data_count;
-#endif
+#include "qurt_signal.h"
 
-	ADSS_DATA_BUF_LINK_t  *m_pFreeLink;
-	qurt_mutex_t     buf_free_link_mutex;
+#define ADSS_BUF_RING_AVAIL_SIG_MASK           0x01
+#define ADSS_BUF_RING_ABORT_SIG_MASK           0x02
 
-	ADSS_DATA_BUF_LINK_t  *m_pLinkBuffAddr;	
-} ADSS_MEM_SESSION_t;
+#define ADSS_BUF_RING_SIG_MASK      (ADSS_BUF_RING_AVAIL_SIG_MASK | ADSS_BUF_RING_ABORT_SIG_MASK)
 
-extern ADSS_MEM_SESSION_t  *m_pAdssMem;
+typedef struct adss_buf_ring_s {
+	uint8_t           **slots;
+	uint32_t            mask;         /* number of slots - 1, slots is a power of two  */
+	volatile uint32_t   head;         /* next slot to fill, written by producer only   */
+	volatile uint32_t   tail;         /* next slot to drain, written by consumer only  */
+	volatile uint32_t   wait_level;   /* level the blocked consumer waits for, 0: none */
 
-#define  MEM_BUF_READY()  qurt_signal_set(&m_pAdssMem->buf_data_signal, ADSS_DATA_BUF_SIG_MASK);	
-#define  MEM_BUF_USR_TASK_DONE()  qurt_signal_set(&m_pAdssMem->buf_data_signal, ADSS_USR_TASK_DONE_SIG_MASK);
+	volatile uint32_t   overruns;     /* put found the ring full (producer)            */
+	volatile uint32_t   underruns;    /* get found the ring empty (consumer)           */
+	volatile uint32_t   max_level;    /* most buffers queued at once (producer)        */
 
+	qurt_signal_t       signal;
+} ADSS_BUF_RING_t;
 
-void adss_release_buf_link(ADSS_DATA_BUF_LINK_t *p);
-void adss_put_tcp_empty_buf(uint8_t *pbuf);
+typedef struct adss_buf_ring_stats_s {
+	uint32_t   level;
+	uint32_t   overruns;
+	uint32_t   underruns;
+	uint32_t   max_level;
+} ADSS_BUF_RING_STATS_t;
 
-uint8_t *adss_get_tcp_empty_buf();
-uint8_t *adss_get_tcp_data_buf();
-uint8_t *adss_peek_get_tcp_empty_buf();
-uint8_t *adss_put_tcp_data_buf(uint8_t *pbuf);
+ADSS_RET_STATUS adss_buf_ring_init(ADSS_BUF_RING_t *ring, uint32_t count);
+void adss_buf_ring_deinit(ADSS_BUF_RING_t *ring);
 
-ADSS_DATA_BUF_LINK_t  *adss_get_buf_link();
+/* producer side */
+ADSS_RET_STATUS adss_buf_ring_put(ADSS_BUF_RING_t *ring, uint8_t *pbuf);
 
-ADSS_RET_STATUS  adss_init_buf_link(int size);
-ADSS_RET_STATUS  adss_Deinit_buf_link();
+/* consumer side */
+uint8_t *adss_buf_ring_get(ADSS_BUF_RING_t *ring);
+uint8_t *adss_buf_ring_wait_get(ADSS_BUF_RING_t *ring);
+ADSS_RET_STATUS adss_buf_ring_wait_level(ADSS_BUF_RING_t *ring, uint32_t level);
 
-uint32_t adss_get_empty_buf_count();
+/* any context */
+void adss_buf_ring_abort(ADSS_BUF_RING_t *ring);
+uint32_t adss_buf_ring_level(ADSS_BUF_RING_t *ring);
+void adss_buf_ring_get_stats(ADSS_BUF_RING_t *ring, ADSS_BUF_RING_STATS_t *stats);
 
 #endif
@@ -23,6 +23,9 @@
 
 #define MAX_COUNTERS_TO_SEND_AT_ONCE 128
 
+// QCLI_Printf formats into a 256 byte buffer, longer folded lines are printed in pieces
+#define MAX_CHARACTERS_TO_PRINT_AT_ONCE 200
+
 
 #ifndef MIN
    #define  MIN( x, y ) ( ((x) < (y)) ? (x) : (y) )
@@ -49,10 +52,12 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_stop(uint32_t parameters_count, Q
 QCLI_Command_Status_t cpu_profiler_cli_handler_reset(uint32_t parameters_count, QCLI_Parameter_t * parameters);
 QCLI_Command_Status_t cpu_profiler_cli_send_results(uint32_t parameters_count, QCLI_Parameter_t * parameters);
 QCLI_Command_Status_t cpu_profiler_cli_print_results(uint32_t parameters_count, QCLI_Parameter_t * parameters);
+QCLI_Command_Status_t cpu_profiler_cli_print_stacks(uint32_t parameters_count, QCLI_Parameter_t * parameters);
+QCLI_Command_Status_t cpu_profiler_cli_print_threads(uint32_t parameters_count, QCLI_Parameter_t * parameters);
 
 const QCLI_Command_t cpu_profiler_cmd_list[] =
 {
-    {cpu_profiler_cli_handler_enable, false, "enable", "\n", "enable profiling\n"},
+    {cpu_profiler_cli_handler_enable, false, "enable", "[server_ip server_port]\n", "enable profiling, without a server the symbol table in the image is used\n"},
     {cpu_profiler_cli_handler_disable, false, "disable", "\n", "disable profiling\n"},
     {cpu_profiler_cli_handler_start, false, "start", "\n", "start profiling\n"},
     {cpu_profiler_cli_handler_stop, false, "stop", "\n", "stop profiling\n"},
@@ -60,6 +65,8 @@ const QCLI_Command_t cpu_profiler_cmd_list[] =
 
     {cpu_profiler_cli_send_results, false, "send_results", "\n", "send profiling results\n"},
     {cpu_profiler_cli_print_results, false, "print_results", "\n", "print profiling\n"},
+    {cpu_profiler_cli_print_stacks, false, "print_stacks", "\n", "print sampled call stacks in folded format\n"},
+    {cpu_profiler_cli_print_threads, false, "print_threads", "\n", "print samples per thread\n"},
 };
 
 const QCLI_Command_Group_t cpu_profiler_cmd_group =
@@ -89,6 +96,12 @@ void Initialize_CpuProfiler_Demo(void)
         QCLI_Printf(qcli_cpu_profiler_handle, "CpuProfiler Registered\n");
     }
 
+    // the block must also fit the function addresses of the embedded symbol table
+    const cpu_profiler_symbol_table_t * symbol_table = cpu_profiler_symbols_get_table();
+    if ( symbol_table && (symbol_table->symbols_count > g_cpu_profiler_number_of_functions) ) {
+        g_cpu_profiler_number_of_functions = symbol_table->symbols_count;
+    }
+
     g_cpu_profiler_memory_block_size = sizeof(uint32_t)*g_cpu_profiler_number_of_functions;
     g_cpu_profiler_memory_block = (uint32_t *) malloc(g_cpu_profiler_memory_block_size);
 
@@ -187,6 +200,8 @@ int cpu_profiler_cleanup()
         free(g_cpu_profiler_ctxt.function_samples);
         g_cpu_profiler_ctxt.function_samples = 0;
     }
+    cpu_profiler_stack_table_deinit(&g_cpu_profiler_ctxt.stack_table);
+    g_cpu_profiler_ctxt.stack_frames_to_capture = 0;
 #if 0
     if ( g_cpu_profiler_ctxt.function_addresses ) {
         free(g_cpu_profiler_ctxt.function_addresses);
@@ -197,6 +212,8 @@ int cpu_profiler_cleanup()
         qapi_socketclose(g_cpu_profiler_ctxt.sock);
         g_cpu_profiler_ctxt.sock = QAPI_ERROR;
     }
+    g_cpu_profiler_ctxt.local_symbols = 0;
+    g_cpu_profiler_ctxt.symbol_table = 0;
 
     return 0;
 }
@@ -222,15 +239,30 @@ extern uint32_t vectTable[255];
 extern void cpu_profiler_interrupt_irq_handler(void);
 
 int cpu_profiler_is_enabled() {
-    return ( QAPI_ERROR != g_cpu_profiler_ctxt.sock );
+    return ( (QAPI_ERROR != g_cpu_profiler_ctxt.sock) || g_cpu_profiler_ctxt.local_symbols );
 }
 
 
-int cpu_profiler_start(uint32_t time_between_samples_in_us, uint32_t time_to_run_profiler_in_seconds)
+int cpu_profiler_start(uint32_t time_between_samples_in_us, uint32_t time_to_run_profiler_in_seconds, uint32_t stack_frames_to_capture)
 {
     // the APSS_TM runs at 32MHz => each us = 32 ticks
     uint32_t sampling_period = 32 * time_between_samples_in_us;
 
+    if ( stack_frames_to_capture ) {
+        // stacks are stored as 16 bit function indices
+        if ( g_cpu_profiler_ctxt.functions_count > 0xffff ) {
+            CPU_PROFILER_DEMO_PRINTF("Too many functions (%d) to sample call stacks\r\n", g_cpu_profiler_ctxt.functions_count);
+            return -1;
+        }
+        if ( !g_cpu_profiler_ctxt.stack_table.entries ) {
+            if ( 0 != cpu_profiler_stack_table_init(&g_cpu_profiler_ctxt.stack_table, CPU_PROFILER_STACK_TABLE_LENGTH) ) {
+                CPU_PROFILER_DEMO_PRINTF("Failed to allocate the call stack table\r\n");
+                return -1;
+            }
+        }
+    }
+    g_cpu_profiler_ctxt.stack_frames_to_capture = stack_frames_to_capture;
+
     g_cpu_profiler_ctxt.count_of_pcs_captured = 0;
     g_cpu_profiler_ctxt.count_of_pcs_to_capture = 1000 * 1000 * time_to_run_profiler_in_seconds / time_between_samples_in_us;
 
@@ -297,6 +329,8 @@ int cpu_profiler_reset()
 
     g_cpu_profiler_ctxt.count_of_pcs_captured = 0;
 
+    cpu_profiler_stack_table_reset(&g_cpu_profiler_ctxt.stack_table);
+
     return 0;
 }
 
@@ -398,6 +432,51 @@ cpu_profiler_helper_connect_to_server_and_retrive_list_of_functions_on_error:
 }
 
 
+/*
+ * Takes the list of functions from the symbol table the build wrote into the
+ * image, so profiling works without a server. Results can only be printed.
+ */
+int cpu_profiler_helper_load_list_of_functions_from_image(void)
+{
+    const cpu_profiler_symbol_table_t * symbol_table = cpu_profiler_symbols_get_table();
+    uint32_t i;
+
+    if ( !symbol_table || (0 == symbol_table->symbols_count) ) {
+        CPU_PROFILER_DEMO_PRINTF("The image has no symbol table, build it with ENABLE_CPU_PROFILER=1 or use a server\r\n");
+        goto cpu_profiler_helper_load_list_of_functions_from_image_on_error;
+    }
+
+    if ( symbol_table->symbols_count*sizeof(uint32_t) > g_cpu_profiler_memory_block_size ) {
+        CPU_PROFILER_DEMO_PRINTF(
+            "Space necessary to fit the function_addresses in memory (%d) is larger than pre-allocated g_cpu_profiler_memory_block (%d)\r\n",
+            symbol_table->symbols_count*sizeof(uint32_t),
+            g_cpu_profiler_memory_block_size
+            );
+        goto cpu_profiler_helper_load_list_of_functions_from_image_on_error;
+    }
+
+    g_cpu_profiler_ctxt.functions_count = symbol_table->symbols_count;
+    g_cpu_profiler_ctxt.function_addresses = g_cpu_profiler_memory_block;
+    for ( i = 0; i < symbol_table->symbols_count; i++ ) {
+        g_cpu_profiler_ctxt.function_addresses[i] = symbol_table->symbols[i].address;
+    }
+
+    uint32_t function_samples_size = g_cpu_profiler_ctxt.functions_count*sizeof(g_cpu_profiler_ctxt.function_samples[0]);
+    g_cpu_profiler_ctxt.function_samples = (uint16_t *) malloc(function_samples_size);
+    if ( !g_cpu_profiler_ctxt.function_samples ) {
+        CPU_PROFILER_DEMO_PRINTF("Failed to allocate function_samples\r\n");
+        goto cpu_profiler_helper_load_list_of_functions_from_image_on_error;
+    }
+    memset(g_cpu_profiler_ctxt.function_samples, 0, function_samples_size);
+
+    g_cpu_profiler_ctxt.local_symbols = 1;
+
+    return 0;
+
+cpu_profiler_helper_load_list_of_functions_from_image_on_error:
+    cpu_profiler_cleanup();
+    return -1;
+}
 
 
 QCLI_Command_Status_t cpu_profiler_cli_handler_enable(uint32_t parameters_count, QCLI_Parameter_t * parameters)
@@ -413,9 +492,17 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_enable(uint32_t parameters_count,
     uint32_t server_ip;
     uint32_t server_port;
 
+    if ( 0 == parameters_count ) {
+        status = cpu_profiler_helper_load_list_of_functions_from_image();
+        if ( 0 != status ) {
+            goto cpu_profiler_cli_handler_enable_on_error;
+        }
+        goto cpu_profiler_cli_handler_enable_on_success;
+    }
+
     // Extract log server IP address and port from the CLI parameters
     if ( 2 != parameters_count ) {
-        CPU_PROFILER_DEMO_PRINTF("Invalid number of arguments, must be exactly 2\r\n");
+        CPU_PROFILER_DEMO_PRINTF("Invalid number of arguments, must be 0 or 2\r\n");
         goto cpu_profiler_cli_handler_enable_on_error;
     }
 
@@ -437,6 +524,10 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_enable(uint32_t parameters_count,
         goto cpu_profiler_cli_handler_enable_on_error;
     }
 
+cpu_profiler_cli_handler_enable_on_success:
+    // names are looked up by address, so they also apply to the list sent by the server
+    g_cpu_profiler_ctxt.symbol_table = cpu_profiler_symbols_get_table();
+
     memset(g_cpu_profiler_ctxt.function_info_list, 0, MAX_FUNCTION_INFO_LIST_LENGTH*sizeof(g_cpu_profiler_ctxt.function_info_list[0]));
     g_cpu_profiler_ctxt.function_info_list_length = 0;
 
@@ -444,7 +535,7 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_enable(uint32_t parameters_count,
 
 cpu_profiler_cli_handler_enable_on_error:
     cpu_profiler_cleanup();
-    CPU_PROFILER_DEMO_PRINTF("Usage: enable server_ip server_port\r\n");
+    CPU_PROFILER_DEMO_PRINTF("Usage: enable [server_ip server_port]\r\n");
     return QCLI_STATUS_ERROR_E;
 }
 
@@ -487,9 +578,11 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_start(uint32_t parameters_count,
     // list of parameters:
     // 1st: us_between_samples
     // 2nd: time in seconds to run the profiler
+    // 3rd: call stack frames to capture per sample, 0 samples only the PC
 
     uint32_t time_between_samples_in_us = 50;
     uint32_t time_to_run_profiler_in_seconds = 5;
+    uint32_t stack_frames_to_capture = 0;
 
     if ( parameters_count > 0 )
     {
@@ -511,7 +604,22 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_start(uint32_t parameters_count,
         }
     }
 
-    status = cpu_profiler_start(time_between_samples_in_us, time_to_run_profiler_in_seconds);
+    if ( parameters_count > 2 )
+    {
+        if ( 1 &&
+            parameters[2].Integer_Is_Valid &&
+            (parameters[2].Integer_Value >= 0) &&
+            (parameters[2].Integer_Value <= CPU_PROFILER_STACK_MAX_FRAMES)
+            )
+        {
+            stack_frames_to_capture = parameters[2].Integer_Value;
+        }
+        else {
+            goto cpu_profiler_cli_handler_start_on_error;
+        }
+    }
+
+    status = cpu_profiler_start(time_between_samples_in_us, time_to_run_profiler_in_seconds, stack_frames_to_capture);
     if ( 0 != status ) {
         CPU_PROFILER_DEMO_PRINTF("Failed on a call to cpu_profiler_start(), status=%d\r\n", status);
     }
@@ -519,9 +627,11 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_start(uint32_t parameters_count,
     return QCLI_STATUS_SUCCESS_E;
 
 cpu_profiler_cli_handler_start_on_error:
-    CPU_PROFILER_DEMO_PRINTF("Usage: start <time_between_samples_in_us> <time_to_run_profiler_in_seconds>\r\n");
+    CPU_PROFILER_DEMO_PRINTF("Usage: start <time_between_samples_in_us> <time_to_run_profiler_in_seconds> <stack_frames>\r\n");
     CPU_PROFILER_DEMO_PRINTF("\t<time_between_samples_in_us>: time in us between each PC (default=50us),\r\n");
     CPU_PROFILER_DEMO_PRINTF("\t<profiling_duration>: time in seconds to run the profiler (defaults=5s),\r\n");
+    CPU_PROFILER_DEMO_PRINTF("\t<stack_frames>: call stack frames to record per sample, 0..%d (default=0),\r\n", CPU_PROFILER_STACK_MAX_FRAMES);
+    CPU_PROFILER_DEMO_PRINTF("\t                stack sampling costs more per sample, use 500us or more between samples\r\n");
     return QCLI_STATUS_ERROR_E;
 }
 
@@ -559,6 +669,11 @@ QCLI_Command_Status_t cpu_profiler_cli_send_results(uint32_t parameters_count, Q
         return QCLI_STATUS_ERROR_E;
     }
 
+    if ( QAPI_ERROR == g_cpu_profiler_ctxt.sock ) {
+        CPU_PROFILER_DEMO_PRINTF("Enabled without a server, use print_results instead\r\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
     int status;
 
     // sends results to the server
@@ -614,6 +729,27 @@ cpu_profiler_cli_send_results_error:
 }
 
 
+/*
+ * Returns the name of the function from the embedded symbol table, or 0 when
+ * the image has no table or the address is not in it.
+ */
+static const char * helper_function_name(uint32_t function_index)
+{
+    int32_t symbol_index;
+
+    if ( !g_cpu_profiler_ctxt.symbol_table ) {
+        return 0;
+    }
+
+    symbol_index = cpu_profiler_symbols_lookup(g_cpu_profiler_ctxt.symbol_table, g_cpu_profiler_ctxt.function_addresses[function_index]);
+    if ( symbol_index < 0 ) {
+        return 0;
+    }
+
+    return cpu_profiler_symbols_name(g_cpu_profiler_ctxt.symbol_table, symbol_index);
+}
+
+
 static inline uint32_t helper_is_index_recorded_as_cpu_hogger(
     uint32_t * cpu_hogger_indices_array,
     uint32_t number_of_recorded_cpu_hoggers,
@@ -709,7 +845,7 @@ static int helper_print_top_most_cpu_hoggers(const int cpu_hoggers_to_print)
 
     // print the CPU hoggers
     CPU_PROFILER_DEMO_PRINTF("The %d top most CPU hoggers are:\r\n", cpu_hoggers_to_print);
-    CPU_PROFILER_DEMO_PRINTF("Function Address, CPU Utilization %% [Samples]:  thread_id [samples] ...\r\n");
+    CPU_PROFILER_DEMO_PRINTF("Function Address [Name], CPU Utilization %% [Samples]:  thread_id [samples] ...\r\n");
     for ( i = 0; i < cpu_hoggers_to_print; i++ ) {
         int cpu_hogger_index = cpu_hogger_indices_array[i];
         uint32_t function_address = g_cpu_profiler_ctxt.function_addresses[cpu_hogger_index];
@@ -725,9 +861,13 @@ static int helper_print_top_most_cpu_hoggers(const int cpu_hoggers_to_print)
         }
 
         uint32_t percent_cpu_utilization = (total_samples) ? (100 * function_samples / total_samples) : 0;
+        const char * function_name = helper_function_name(cpu_hogger_index);
+        CPU_PROFILER_DEMO_PRINTF("%08x", function_address);
+        if ( function_name ) {
+            CPU_PROFILER_DEMO_PRINTF(" [%.*s]", MAX_CHARACTERS_TO_PRINT_AT_ONCE, function_name);
+        }
         CPU_PROFILER_DEMO_PRINTF(
-            "%08x, %d [%d]",
-            function_address,
+            ", %d [%d]",
             percent_cpu_utilization,
             function_samples
             );
@@ -798,3 +938,113 @@ cpu_profiler_cli_print_results_on_error:
     CPU_PROFILER_DEMO_PRINTF("Usage: print_results number_of_top_cpu_hoggers_to_print\r\n");
     return QCLI_STATUS_ERROR_E;
 }
+
+
+static void helper_fold_function_name(uint32_t function_index, char * name, uint32_t size, void * arg)
+{
+    const char * function_name = helper_function_name(function_index);
+
+    if ( function_name ) {
+        snprintf(name, size, "%s", function_name);
+    }
+    else {
+        snprintf(name, size, "0x%08x", (unsigned int) g_cpu_profiler_ctxt.function_addresses[function_index]);
+    }
+}
+
+
+static void helper_fold_thread_name(uint32_t thread_id, char * name, uint32_t size, void * arg)
+{
+    if ( CPU_PROFILER_INTERRUPT_THREAD_ID == thread_id ) {
+        snprintf(name, size, "interrupts");
+    }
+    else {
+        snprintf(name, size, "thread_0x%08x", (unsigned int) thread_id);
+    }
+}
+
+
+static void helper_fold_print_line(const char * line, void * arg)
+{
+    int length = strlen(line);
+    int i;
+    for ( i = 0; i < length; i += MAX_CHARACTERS_TO_PRINT_AT_ONCE ) {
+        CPU_PROFILER_DEMO_PRINTF("%.*s", MIN(MAX_CHARACTERS_TO_PRINT_AT_ONCE, length - i), &line[i]);
+    }
+    CPU_PROFILER_DEMO_PRINTF("\r\n");
+}
+
+
+QCLI_Command_Status_t cpu_profiler_cli_print_stacks(uint32_t parameters_count, QCLI_Parameter_t * parameters)
+{
+    if ( !cpu_profiler_is_enabled() ) {
+        CPU_PROFILER_DEMO_PRINTF("Must enable the cpu_profiler first\r\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    if ( !g_cpu_profiler_ctxt.stack_table.entries ) {
+        CPU_PROFILER_DEMO_PRINTF("No call stacks were sampled, run: start <us> <seconds> <stack_frames>\r\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    const cpu_profiler_fold_ops_t fold_ops = {
+        .function_name = helper_fold_function_name,
+        .thread_name = helper_fold_thread_name,
+        .output = helper_fold_print_line,
+        .arg = 0,
+    };
+
+    // the lines between the markers can be fed to flamegraph.pl as they are
+    CPU_PROFILER_DEMO_PRINTF("# folded stacks begin\r\n");
+    if ( 0 != cpu_profiler_stack_fold(&g_cpu_profiler_ctxt.stack_table, &fold_ops) ) {
+        CPU_PROFILER_DEMO_PRINTF("Failed to allocate the folded line buffer\r\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+    CPU_PROFILER_DEMO_PRINTF("# folded stacks end\r\n");
+    CPU_PROFILER_DEMO_PRINTF(
+        "# %d samples, %d stacks, %d samples dropped (table full)\r\n",
+        g_cpu_profiler_ctxt.stack_table.samples,
+        g_cpu_profiler_ctxt.stack_table.used,
+        g_cpu_profiler_ctxt.stack_table.dropped
+        );
+
+    return QCLI_STATUS_SUCCESS_E;
+}
+
+
+QCLI_Command_Status_t cpu_profiler_cli_print_threads(uint32_t parameters_count, QCLI_Parameter_t * parameters)
+{
+    if ( !cpu_profiler_is_enabled() ) {
+        CPU_PROFILER_DEMO_PRINTF("Must enable the cpu_profiler first\r\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    if ( !g_cpu_profiler_ctxt.stack_table.entries ) {
+        CPU_PROFILER_DEMO_PRINTF("No call stacks were sampled, run: start <us> <seconds> <stack_frames>\r\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    cpu_profiler_stack_table_t * p_table = &g_cpu_profiler_ctxt.stack_table;
+    char name[32];
+    uint32_t i;
+
+    CPU_PROFILER_DEMO_PRINTF("Thread, CPU Utilization %% [Samples]\r\n");
+    for ( i = 0; i < p_table->threads_count; i++ ) {
+        helper_fold_thread_name(p_table->threads[i].thread_id, name, sizeof(name), 0);
+        CPU_PROFILER_DEMO_PRINTF(
+            "%s, %d [%d]\r\n",
+            name,
+            (p_table->samples) ? (100 * p_table->threads[i].count / p_table->samples) : 0,
+            p_table->threads[i].count
+            );
+    }
+    if ( p_table->other_threads_samples ) {
+        CPU_PROFILER_DEMO_PRINTF(
+            "other threads, %d [%d]\r\n",
+            100 * p_table->other_threads_samples / p_table->samples,
+            p_table->other_threads_samples
+            );
+    }
+
+    return QCLI_STATUS_SUCCESS_E;
+}
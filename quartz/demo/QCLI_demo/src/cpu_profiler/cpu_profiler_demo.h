@@ -7,6 +7,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "cpu_profiler_stack.h"
+#include "cpu_profiler_symbols.h"
+
 #define ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING 1
 
 #define MAX_FUNCTION_INFO_LIST_LENGTH 10
@@ -35,12 +38,21 @@ typedef struct cpu_profiler_ctxt_s {
     uint32_t * function_addresses;
     uint16_t * function_samples;
 
+    // names the functions when the build embedded a symbol table, 0 otherwise
+    const cpu_profiler_symbol_table_t * symbol_table;
+    // function_addresses came from symbol_table rather than from the server
+    uint32_t local_symbols;
+
     function_info_t function_info_list[MAX_FUNCTION_INFO_LIST_LENGTH];
     uint32_t function_info_list_length;
 
     uint32_t count_of_pcs_to_capture;
     uint32_t count_of_pcs_captured;
 
+    // 0 when only the interrupted PC is sampled
+    uint32_t stack_frames_to_capture;
+    cpu_profiler_stack_table_t stack_table;
+
     uint32_t original_isr;
 } cpu_profiler_ctxt_t;
 
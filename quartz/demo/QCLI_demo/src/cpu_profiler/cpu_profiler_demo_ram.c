@@ -27,6 +27,16 @@ extern cpu_profiler_ctxt_t g_cpu_profiler_ctxt;
 #define CPU_PROFILER_TIMER_INTCLR    0x4400102c
 #define CPU_PROFILER_TIMER_BGLOAD    0x44001038
 
+// words cpu_profiler_interrupt_irq_handler pushes before calling cpu_profiler_timer_isr
+#define CPU_PROFILER_HANDLER_PUSHED_WORDS 5
+
+#define EXCEPTION_FRAME_LR         5
+#define EXCEPTION_FRAME_PC         6
+#define EXCEPTION_FRAME_XPSR       7
+#define EXCEPTION_FRAME_WORDS      8
+#define EXCEPTION_FRAME_FPU_WORDS  26
+#define XPSR_STACK_ALIGN           0x200
+
 
 
 #define ASSERT_BREAK(x) \
@@ -56,6 +66,42 @@ static inline void __set_PRIMASK(uint32_t primask_val)
 }
 
 
+/*
+ * A stacked word is taken as a return address when it is a Thumb address
+ * inside the function table, is not the start of a function (that would be
+ * a function pointer) and follows a BL or BLX instruction.
+ */
+static int cpu_profiler_is_return_address(uint32_t address, void * arg)
+{
+    const uint32_t * function_addresses = g_cpu_profiler_ctxt.function_addresses;
+    uint32_t functions_count = g_cpu_profiler_ctxt.functions_count;
+
+    if ( !(address & 1) ) {
+        return 0;
+    }
+    address &= ~1;
+
+    // stay inside the code covered by the table before reading the call site
+    if ( (address < (function_addresses[0] & ~1) + 4) || (address >= (function_addresses[functions_count - 1] & ~1)) ) {
+        return 0;
+    }
+
+    uint32_t index = cpu_profiler_function_index(function_addresses, functions_count, address);
+    if ( (function_addresses[index] & ~1) == address ) {
+        return 0;
+    }
+
+    const uint16_t * call_site = (const uint16_t *) address;
+    if ( (call_site[-1] & 0xff87) == 0x4780 ) {
+        return 1;       // BLX Rm
+    }
+    if ( ((call_site[-2] & 0xf800) == 0xf000) && ((call_site[-1] & 0xc000) == 0xc000) ) {
+        return 1;       // BL / BLX imm
+    }
+    return 0;
+}
+
+
 void cpu_profiler_timer_isr(
     uint32_t ipsr_register_value,
     uint32_t lr_register_value,
@@ -68,32 +114,54 @@ void cpu_profiler_timer_isr(
         cpu_profiler_stop();
     }
 
-    uint32_t value;
+    uint32_t * exception_frame;
+    uint32_t thread_id;
     if ( (lr_register_value & 0xd) == 0xd ) {
-        value = ((uint32_t*) psp_register_value)[6];
+        exception_frame = (uint32_t*) psp_register_value;
+        thread_id = qurt_thread_get_id();
     }
     else {
-        value = ((uint32_t*) msp_register_value)[6];
+        // cpu_profiler_interrupt_irq_handler pushed R0-R3 and LR on the main stack before reading MSP
+        exception_frame = ((uint32_t*) msp_register_value) + CPU_PROFILER_HANDLER_PUSHED_WORDS;
+        thread_id = CPU_PROFILER_INTERRUPT_THREAD_ID;
     }
 
+    uint32_t value = exception_frame[EXCEPTION_FRAME_PC];
 
-    // binary search algorithm to find the index of the function PC belongs to
-    uint32_t low_index = 0;
-    uint32_t high_index = g_cpu_profiler_ctxt.functions_count;
-    uint32_t mid_index;
-    uint32_t mid_index_value;
+    if ( g_cpu_profiler_ctxt.stack_frames_to_capture ) {
+        uint32_t frames[CPU_PROFILER_STACK_MAX_FRAMES];
+        uint32_t depth;
 
-    while ( (high_index - low_index) > 1  ) {
-        mid_index = (low_index + high_index) / 2;
-        mid_index_value = g_cpu_profiler_ctxt.function_addresses[mid_index];
-        if ( value >= mid_index_value ) {
-            low_index = mid_index;
-        }
-        else {
-            high_index = mid_index;
+        // the interrupted stack starts right after the (basic or FPU) exception frame
+        uint32_t frame_words = (lr_register_value & 0x10) ? EXCEPTION_FRAME_WORDS : EXCEPTION_FRAME_FPU_WORDS;
+        if ( exception_frame[EXCEPTION_FRAME_XPSR] & XPSR_STACK_ALIGN ) {
+            frame_words++;
         }
+
+        // the main stack is only scanned for the interrupted LR, its end is not known here
+        depth = cpu_profiler_stack_unwind(
+            value,
+            exception_frame[EXCEPTION_FRAME_LR],
+            exception_frame + frame_words,
+            (thread_id == CPU_PROFILER_INTERRUPT_THREAD_ID) ? 0 : CPU_PROFILER_STACK_SCAN_WORDS,
+            frames,
+            g_cpu_profiler_ctxt.stack_frames_to_capture,
+            cpu_profiler_is_return_address,
+            0
+            );
+
+        cpu_profiler_stack_record(
+            &g_cpu_profiler_ctxt.stack_table,
+            thread_id,
+            g_cpu_profiler_ctxt.function_addresses,
+            g_cpu_profiler_ctxt.functions_count,
+            frames,
+            depth
+            );
     }
 
+    uint32_t low_index = cpu_profiler_function_index(g_cpu_profiler_ctxt.function_addresses, g_cpu_profiler_ctxt.functions_count, value);
+
     ASSERT_BREAK( low_index < g_cpu_profiler_ctxt.functions_count );
 
     g_cpu_profiler_ctxt.function_samples[low_index]++;
@@ -129,7 +197,6 @@ void cpu_profiler_timer_isr(
     }
 
     if ( p_function_info ) {
-        uint32_t thread_id = qurt_thread_get_id();
         int i;
         thread_info_t * p_thread_info = 0;
         for ( i = 0; i < p_function_info->thread_info_list_length; i++ ) {
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu_profiler_stack.h"
+
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+// room kept at the end of a folded line for " <count>" and the terminator
+#define FOLD_COUNT_LENGTH 12
+
+
+/*
+ * Binary search for the function the address belongs to. function_addresses
+ * is sorted, addresses below the first function resolve to index 0.
+ */
+uint32_t cpu_profiler_function_index(const uint32_t * function_addresses, uint32_t functions_count, uint32_t address)
+{
+    uint32_t low_index = 0;
+    uint32_t high_index = functions_count;
+    uint32_t mid_index;
+
+    while ( (high_index - low_index) > 1 ) {
+        mid_index = (low_index + high_index) / 2;
+        if ( address >= function_addresses[mid_index] ) {
+            low_index = mid_index;
+        }
+        else {
+            high_index = mid_index;
+        }
+    }
+
+    return low_index;
+}
+
+
+/*
+ * The code is built without frame pointers, so the caller chain is recovered
+ * by scanning the stack for words that look like return addresses. The
+ * interrupted PC is always the first frame and LR is the second one when it
+ * holds a return address (it does in leaf functions, in other functions it
+ * usually points back into the function itself and is folded away later).
+ * Stale return addresses left on the stack can show up as extra frames, the
+ * is_return_address callback is what keeps those rare.
+ */
+uint32_t cpu_profiler_stack_unwind(
+    uint32_t pc,
+    uint32_t lr,
+    const uint32_t * sp,
+    uint32_t sp_words,
+    uint32_t * frames,
+    uint32_t max_frames,
+    cpu_profiler_is_return_address_t is_return_address,
+    void * arg
+    )
+{
+    uint32_t depth = 0;
+    uint32_t i;
+
+    if ( 0 == max_frames ) {
+        return 0;
+    }
+
+    frames[depth++] = pc;
+
+    if ( (depth < max_frames) && is_return_address(lr, arg) ) {
+        frames[depth++] = lr;
+    }
+
+    for ( i = 0; (i < sp_words) && (depth < max_frames); i++ ) {
+        if ( is_return_address(sp[i], arg) ) {
+            frames[depth++] = sp[i];
+        }
+    }
+
+    return depth;
+}
+
+
+int cpu_profiler_stack_table_init(cpu_profiler_stack_table_t * table, uint32_t length)
+{
+    memset(table, 0, sizeof(*table));
+
+    // the hash is masked with length - 1
+    if ( (0 == length) || (length & (length - 1)) ) {
+        return -1;
+    }
+
+    table->entries = (cpu_profiler_stack_t *) malloc(length * sizeof(table->entries[0]));
+    if ( !table->entries ) {
+        return -1;
+    }
+    table->length = length;
+
+    cpu_profiler_stack_table_reset(table);
+
+    return 0;
+}
+
+
+void cpu_profiler_stack_table_deinit(cpu_profiler_stack_table_t * table)
+{
+    if ( table->entries ) {
+        free(table->entries);
+    }
+    memset(table, 0, sizeof(*table));
+}
+
+
+void cpu_profiler_stack_table_reset(cpu_profiler_stack_table_t * table)
+{
+    if ( table->entries ) {
+        memset(table->entries, 0, table->length * sizeof(table->entries[0]));
+    }
+
+    table->used = 0;
+    table->samples = 0;
+    table->dropped = 0;
+
+    memset(table->threads, 0, sizeof(table->threads));
+    table->threads_count = 0;
+    table->other_threads_samples = 0;
+}
+
+
+static void helper_count_thread_sample(cpu_profiler_stack_table_t * table, uint32_t thread_id)
+{
+    uint32_t i;
+
+    for ( i = 0; i < table->threads_count; i++ ) {
+        if ( table->threads[i].thread_id == thread_id ) {
+            table->threads[i].count++;
+            return;
+        }
+    }
+
+    if ( table->threads_count < CPU_PROFILER_MAX_THREADS ) {
+        table->threads[table->threads_count].thread_id = thread_id;
+        table->threads[table->threads_count].count = 1;
+        table->threads_count++;
+    }
+    else {
+        table->other_threads_samples++;
+    }
+}
+
+
+/*
+ * Resolve the frames to function indices and count the sample against its
+ * (thread, call stack) entry. Consecutive frames in the same function are
+ * merged, which drops the LR frame of non-leaf functions and any return
+ * address the function left in its own frame.
+ *
+ * Called from the sampling interrupt, so it neither allocates nor blocks.
+ */
+void cpu_profiler_stack_record(
+    cpu_profiler_stack_table_t * table,
+    uint32_t thread_id,
+    const uint32_t * function_addresses,
+    uint32_t functions_count,
+    const uint32_t * frames,
+    uint32_t depth
+    )
+{
+    uint16_t indices[CPU_PROFILER_STACK_MAX_FRAMES];
+    uint32_t indices_count = 0;
+    uint32_t hash = FNV_OFFSET_BASIS;
+    uint32_t i;
+    uint32_t slot;
+
+    table->samples++;
+    helper_count_thread_sample(table, thread_id);
+
+    if ( depth > CPU_PROFILER_STACK_MAX_FRAMES ) {
+        depth = CPU_PROFILER_STACK_MAX_FRAMES;
+    }
+
+    for ( i = 0; i < depth; i++ ) {
+        uint16_t index = (uint16_t) cpu_profiler_function_index(function_addresses, functions_count, frames[i]);
+        if ( (indices_count > 0) && (indices[indices_count - 1] == index) ) {
+            continue;
+        }
+        indices[indices_count++] = index;
+        hash = (hash ^ index) * FNV_PRIME;
+    }
+    hash = (hash ^ thread_id) * FNV_PRIME;
+
+    // open addressing with linear probing, entries are never removed while sampling
+    for ( i = 0; i < table->length; i++ ) {
+        slot = (hash + i) & (table->length - 1);
+        cpu_profiler_stack_t * p_stack = &table->entries[slot];
+
+        if ( 0 == p_stack->count ) {
+            p_stack->thread_id = thread_id;
+            p_stack->depth = indices_count;
+            memcpy(p_stack->frames, indices, indices_count * sizeof(indices[0]));
+            p_stack->count = 1;
+            table->used++;
+            return;
+        }
+
+        if ( 1 &&
+            (p_stack->thread_id == thread_id) &&
+            (p_stack->depth == indices_count) &&
+            (0 == memcmp(p_stack->frames, indices, indices_count * sizeof(indices[0])))
+            )
+        {
+            p_stack->count++;
+            return;
+        }
+    }
+
+    table->dropped++;
+}
+
+
+/*
+ * Write one folded stack line per table entry, outermost frame first, in
+ * the format flamegraph.pl and compatible tools expect:
+ *
+ *     thread;caller;callee count
+ */
+int cpu_profiler_stack_fold(const cpu_profiler_stack_table_t * table, const cpu_profiler_fold_ops_t * ops)
+{
+    char name[64];
+    char * line;
+    const uint32_t limit = CPU_PROFILER_FOLD_LINE_LENGTH - FOLD_COUNT_LENGTH;
+    uint32_t length;
+    uint32_t i;
+    int j;
+
+    line = (char *) malloc(CPU_PROFILER_FOLD_LINE_LENGTH);
+    if ( !line ) {
+        return -1;
+    }
+
+    for ( i = 0; i < table->length; i++ ) {
+        const cpu_profiler_stack_t * p_stack = &table->entries[i];
+        if ( 0 == p_stack->count ) {
+            continue;
+        }
+
+        // a line that does not fit loses its innermost frames, never the count
+        ops->thread_name(p_stack->thread_id, name, sizeof(name), ops->arg);
+        length = snprintf(line, limit, "%s", name);
+
+        for ( j = p_stack->depth - 1; (j >= 0) && (length < limit - 1); j-- ) {
+            ops->function_name(p_stack->frames[j], name, sizeof(name), ops->arg);
+            length += snprintf(&line[length], limit - length, ";%s", name);
+        }
+        if ( length > limit - 1 ) {
+            length = limit - 1;
+        }
+
+        snprintf(&line[length], CPU_PROFILER_FOLD_LINE_LENGTH - length, " %u", (unsigned int) p_stack->count);
+
+        ops->output(line, ops->arg);
+    }
+
+    free(line);
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+/*
+ * Call stack sampling for the CPU profiler.
+ *
+ * Every sample is unwound into a list of return addresses by scanning the
+ * interrupted stack, resolved to function indices and counted per unique
+ * (thread, call stack) pair. The table can be written out as folded stacks,
+ * one "thread;outer;...;inner count" line per entry, which flame graph tools
+ * read directly.
+ *
+ * Nothing in here depends on the RTOS or the hardware, so this file also
+ * builds on a host.
+ */
+
+#ifndef __CPU_PROFILER_STACK_H__
+#define __CPU_PROFILER_STACK_H__
+
+#include <stdint.h>
+
+#define CPU_PROFILER_STACK_MAX_FRAMES 8
+#define CPU_PROFILER_STACK_SCAN_WORDS 64
+#define CPU_PROFILER_STACK_TABLE_LENGTH 256
+#define CPU_PROFILER_MAX_THREADS 16
+#define CPU_PROFILER_FOLD_LINE_LENGTH 512
+
+// thread_id recorded for samples taken while an interrupt handler was running
+#define CPU_PROFILER_INTERRUPT_THREAD_ID 0
+
+
+// returns non-zero if address can be a return address pushed on the stack
+typedef int (*cpu_profiler_is_return_address_t)(uint32_t address, void * arg);
+
+
+typedef struct cpu_profiler_stack_s {
+    uint32_t thread_id;
+    uint32_t count;
+    uint16_t depth;
+    uint16_t frames[CPU_PROFILER_STACK_MAX_FRAMES];  // function indices, innermost first
+} cpu_profiler_stack_t;
+
+
+typedef struct cpu_profiler_thread_stats_s {
+    uint32_t thread_id;
+    uint32_t count;
+} cpu_profiler_thread_stats_t;
+
+
+typedef struct cpu_profiler_stack_table_s {
+    cpu_profiler_stack_t * entries;
+    uint32_t length;            // power of two
+    uint32_t used;
+
+    uint32_t samples;
+    uint32_t dropped;           // samples whose stack did not fit in the table
+
+    cpu_profiler_thread_stats_t threads[CPU_PROFILER_MAX_THREADS];
+    uint32_t threads_count;
+    uint32_t other_threads_samples;
+} cpu_profiler_stack_table_t;
+
+
+typedef struct cpu_profiler_fold_ops_s {
+    void (*function_name)(uint32_t function_index, char * name, uint32_t size, void * arg);
+    void (*thread_name)(uint32_t thread_id, char * name, uint32_t size, void * arg);
+    void (*output)(const char * line, void * arg);
+    void * arg;
+} cpu_profiler_fold_ops_t;
+
+
+uint32_t cpu_profiler_function_index(const uint32_t * function_addresses, uint32_t functions_count, uint32_t address);
+
+uint32_t cpu_profiler_stack_unwind(
+    uint32_t pc,
+    uint32_t lr,
+    const uint32_t * sp,
+    uint32_t sp_words,
+    uint32_t * frames,
+    uint32_t max_frames,
+    cpu_profiler_is_return_address_t is_return_address,
+    void * arg
+    );
+
+int cpu_profiler_stack_table_init(cpu_profiler_stack_table_t * table, uint32_t length);
+void cpu_profiler_stack_table_deinit(cpu_profiler_stack_table_t * table);
+void cpu_profiler_stack_table_reset(cpu_profiler_stack_table_t * table);
+
+void cpu_profiler_stack_record(
+    cpu_profiler_stack_table_t * table,
+    uint32_t thread_id,
+    const uint32_t * function_addresses,
+    uint32_t functions_count,
+    const uint32_t * frames,
+    uint32_t depth
+    );
+
+int cpu_profiler_stack_fold(const cpu_profiler_stack_table_t * table, const cpu_profiler_fold_ops_t * ops);
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "cpu_profiler_symbols.h"
+
+
+// Written into the ELF by build/scripts/cpuProfilerSymbolTable.py after linking,
+// the image keeps the EMPTY magic when the script did not run.
+const uint32_t g_cpu_profiler_symbol_table[CPU_PROFILER_SYMBOL_TABLE_SIZE / sizeof(uint32_t)] = {
+    CPU_PROFILER_SYMBOL_TABLE_EMPTY_MAGIC
+};
+
+
+/*
+ * Returns the embedded table, or 0 when the build did not write one.
+ */
+const cpu_profiler_symbol_table_t * cpu_profiler_symbols_get_table(void)
+{
+    const cpu_profiler_symbol_table_t * table = (const cpu_profiler_symbol_table_t *) g_cpu_profiler_symbol_table;
+
+    // the contents change after linking, keep the compiler from using the initializer above
+    __asm__ volatile("" : "+r" (table));
+
+    if ( 0 ||
+        (table->magic != CPU_PROFILER_SYMBOL_TABLE_MAGIC) ||
+        (table->table_size > CPU_PROFILER_SYMBOL_TABLE_SIZE) ||
+        (table->table_size < sizeof(*table)) ||
+        (table->symbols_count > (table->table_size - sizeof(*table)) / sizeof(table->symbols[0]))
+        )
+    {
+        return 0;
+    }
+
+    return table;
+}
+
+
+/*
+ * Binary search for the symbol containing address, returns its index or -1
+ * when the address is not inside any symbol.
+ */
+int32_t cpu_profiler_symbols_lookup(const cpu_profiler_symbol_table_t * table, uint32_t address)
+{
+    uint32_t low_index = 0;
+    uint32_t high_index = table->symbols_count;
+    uint32_t mid_index;
+
+    address &= ~1;
+
+    if ( (0 == high_index) || (address < table->symbols[0].address) ) {
+        return -1;
+    }
+
+    while ( (high_index - low_index) > 1 ) {
+        mid_index = (low_index + high_index) / 2;
+        if ( address >= table->symbols[mid_index].address ) {
+            low_index = mid_index;
+        }
+        else {
+            high_index = mid_index;
+        }
+    }
+
+    if ( (address - table->symbols[low_index].address) >= table->symbols[low_index].size ) {
+        return -1;
+    }
+
+    return low_index;
+}
+
+
+const char * cpu_profiler_symbols_name(const cpu_profiler_symbol_table_t * table, uint32_t index)
+{
+    if ( (index >= table->symbols_count) || (table->symbols[index].name_offset >= table->table_size) ) {
+        return 0;
+    }
+
+    return ((const char *) table) + table->symbols[index].name_offset;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+/*
+ * Symbol table embedded in the image for the CPU profiler.
+ *
+ * The build reserves CPU_PROFILER_SYMBOL_TABLE_SIZE bytes of read-only data
+ * and build/scripts/cpuProfilerSymbolTable.py writes the table into the ELF
+ * after linking. Little endian layout:
+ *
+ *     header      magic, symbols_count, table_size, reserved
+ *     symbols     symbols_count x (address, size, name_offset), sorted by address
+ *     names       NUL terminated strings, name_offset counts from the header
+ *
+ * Addresses have the Thumb bit cleared.
+ */
+
+#ifndef __CPU_PROFILER_SYMBOLS_H__
+#define __CPU_PROFILER_SYMBOLS_H__
+
+#include <stdint.h>
+
+#define CPU_PROFILER_SYMBOL_TABLE_MAGIC 0x4d595350          // "PSYM", a table was written
+#define CPU_PROFILER_SYMBOL_TABLE_EMPTY_MAGIC 0x59544d45    // "EMTY", nothing was written yet
+
+#ifndef CPU_PROFILER_SYMBOL_TABLE_SIZE
+#define CPU_PROFILER_SYMBOL_TABLE_SIZE (128 * 1024)
+#endif
+
+
+typedef struct cpu_profiler_symbol_s {
+    uint32_t address;
+    uint32_t size;
+    uint32_t name_offset;
+} cpu_profiler_symbol_t;
+
+
+typedef struct cpu_profiler_symbol_table_s {
+    uint32_t magic;
+    uint32_t symbols_count;
+    uint32_t table_size;
+    uint32_t reserved;
+    cpu_profiler_symbol_t symbols[];
+} cpu_profiler_symbol_table_t;
+
+
+const cpu_profiler_symbol_table_t * cpu_profiler_symbols_get_table(void);
+
+int32_t cpu_profiler_symbols_lookup(const cpu_profiler_symbol_table_t * table, uint32_t address);
+const char * cpu_profiler_symbols_name(const cpu_profiler_symbol_table_t * table, uint32_t index);
+
+#endif
@@ -0,0 +1,758 @@
+/*
+ * Copyright (c) 2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "qapi_status.h"
+#include "qapi_crypto.h"
+#include "qapi_ed25519.h"
+#include "crypto_bench.h"
+
+
+#define CRYPTO_BENCH_MAX_OBJECTS 4
+#define CRYPTO_BENCH_MAX_OPERATIONS 2
+
+// the clock is read once per batch, batches double until they take this long
+#define CRYPTO_BENCH_MIN_BATCH_MS 10
+#define CRYPTO_BENCH_MAX_BATCH 1024
+
+#define CRYPTO_BENCH_DIGEST_BYTES 32
+#define CRYPTO_BENCH_NONCE_BYTES 12
+#define CRYPTO_BENCH_TAG_BITS 128
+#define CRYPTO_BENCH_MAX_TAG_BYTES 16
+#define CRYPTO_BENCH_MAX_COORDINATE_BYTES QAPI_CRYPTO_ECC_P384_PUB_VAL_X_BYTES
+#define CRYPTO_BENCH_MAX_SIGNATURE_BYTES 512
+
+
+typedef struct crypto_bench_ctxt_s {
+    const crypto_bench_ops_t * ops;
+    uint32_t duration_ms;
+    uint32_t failed_cases;
+    uint8_t * input;
+    uint8_t * output;
+    uint8_t key[64];
+    uint8_t iv[16];
+} crypto_bench_ctxt_t;
+
+
+/*
+ * Everything one case sets up. Handles are recorded as they are allocated so
+ * the cleanup frees exactly those, whichever step failed.
+ */
+typedef struct crypto_bench_case_s {
+    qapi_Crypto_Obj_Hdl_t objs[CRYPTO_BENCH_MAX_OBJECTS];
+    uint32_t objs_count;
+    qapi_Crypto_Op_Hdl_t ops[CRYPTO_BENCH_MAX_OPERATIONS];
+    uint32_t ops_count;
+
+    qapi_Crypto_Op_Hdl_t op_hdl;            // the operation being measured
+    qapi_Crypto_Obj_Hdl_t derived_key_hdl;  // key agreement output
+    uint32_t buffer_size;
+
+    qapi_Crypto_Attrib_t peer_attrs[2];     // key agreement peer public value
+    uint32_t peer_attrs_count;
+    uint8_t peer_public_x[CRYPTO_BENCH_MAX_COORDINATE_BYTES];
+    uint8_t peer_public_y[CRYPTO_BENCH_MAX_COORDINATE_BYTES];
+
+    uint8_t signature[CRYPTO_BENCH_MAX_SIGNATURE_BYTES];
+    uint32_t signature_length;
+} crypto_bench_case_t;
+
+
+typedef int (*crypto_bench_iteration_t)(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case);
+
+
+typedef struct crypto_bench_symmetric_s {
+    const char * algorithm;
+    uint32_t category;
+    uint32_t alg;
+    uint32_t mode;
+    uint32_t obj_type;      // 0 for algorithms without a key
+    uint32_t key_bits;
+    crypto_bench_iteration_t iteration;
+} crypto_bench_symmetric_t;
+
+
+typedef struct crypto_bench_curve_s {
+    const char * sign_algorithm;
+    const char * verify_algorithm;
+    const char * derive_algorithm;
+    uint32_t curve_id;
+    uint32_t sign_alg;
+    uint32_t derive_alg;
+    uint32_t private_key_bits;
+    uint32_t public_key_bits;
+    uint32_t keypair_bits;
+    uint32_t shared_secret_bits;
+    uint32_t coordinate_bytes;
+} crypto_bench_curve_t;
+
+
+static int helper_cipher_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case);
+static int helper_ae_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case);
+static int helper_digest_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case);
+static int helper_mac_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case);
+
+
+static const uint32_t crypto_bench_buffer_sizes[] = {16, 64, 256, 1024, CRYPTO_BENCH_MAX_BUFFER_SIZE};
+
+static const crypto_bench_symmetric_t crypto_bench_symmetric_cases[] = {
+    {"aes-cbc encrypt", CRYPTO_BENCH_CIPHER, QAPI_CRYPTO_ALG_AES_CBC_NOPAD_E, QAPI_CRYPTO_MODE_ENCRYPT_E, QAPI_CRYPTO_OBJ_TYPE_AES_E, QAPI_CRYPTO_AES128_KEY_BITS, helper_cipher_iteration},
+    {"aes-cbc encrypt", CRYPTO_BENCH_CIPHER, QAPI_CRYPTO_ALG_AES_CBC_NOPAD_E, QAPI_CRYPTO_MODE_ENCRYPT_E, QAPI_CRYPTO_OBJ_TYPE_AES_E, QAPI_CRYPTO_AES256_KEY_BITS, helper_cipher_iteration},
+    {"aes-cbc decrypt", CRYPTO_BENCH_CIPHER, QAPI_CRYPTO_ALG_AES_CBC_NOPAD_E, QAPI_CRYPTO_MODE_DECRYPT_E, QAPI_CRYPTO_OBJ_TYPE_AES_E, QAPI_CRYPTO_AES128_KEY_BITS, helper_cipher_iteration},
+    {"aes-ctr", CRYPTO_BENCH_CIPHER, QAPI_CRYPTO_ALG_AES_CTR_E, QAPI_CRYPTO_MODE_ENCRYPT_E, QAPI_CRYPTO_OBJ_TYPE_AES_E, QAPI_CRYPTO_AES128_KEY_BITS, helper_cipher_iteration},
+    {"aes-ctr", CRYPTO_BENCH_CIPHER, QAPI_CRYPTO_ALG_AES_CTR_E, QAPI_CRYPTO_MODE_ENCRYPT_E, QAPI_CRYPTO_OBJ_TYPE_AES_E, QAPI_CRYPTO_AES256_KEY_BITS, helper_cipher_iteration},
+    {"aes-gcm encrypt", CRYPTO_BENCH_AE, QAPI_CRYPTO_ALG_AES_GCM_E, QAPI_CRYPTO_MODE_ENCRYPT_E, QAPI_CRYPTO_OBJ_TYPE_AES_E, QAPI_CRYPTO_AES128_KEY_BITS, helper_ae_iteration},
+    {"aes-gcm encrypt", CRYPTO_BENCH_AE, QAPI_CRYPTO_ALG_AES_GCM_E, QAPI_CRYPTO_MODE_ENCRYPT_E, QAPI_CRYPTO_OBJ_TYPE_AES_E, QAPI_CRYPTO_AES256_KEY_BITS, helper_ae_iteration},
+    {"aes-ccm encrypt", CRYPTO_BENCH_AE, QAPI_CRYPTO_ALG_AES_CCM_E, QAPI_CRYPTO_MODE_ENCRYPT_E, QAPI_CRYPTO_OBJ_TYPE_AES_E, QAPI_CRYPTO_AES128_KEY_BITS, helper_ae_iteration},
+    {"aes-ccm encrypt", CRYPTO_BENCH_AE, QAPI_CRYPTO_ALG_AES_CCM_E, QAPI_CRYPTO_MODE_ENCRYPT_E, QAPI_CRYPTO_OBJ_TYPE_AES_E, QAPI_CRYPTO_AES256_KEY_BITS, helper_ae_iteration},
+    {"chacha20-poly1305 encrypt", CRYPTO_BENCH_AE, QAPI_CRYPTO_ALG_CHACHA20_POLY1305_E, QAPI_CRYPTO_MODE_ENCRYPT_E, QAPI_CRYPTO_OBJ_TYPE_CHACHA20_E, QAPI_CRYPTO_CHACHA20_POLY1305_KEY_BITS, helper_ae_iteration},
+    {"md5", CRYPTO_BENCH_HASH, QAPI_CRYPTO_ALG_MD5_E, QAPI_CRYPTO_MODE_DIGEST_E, 0, 0, helper_digest_iteration},
+    {"sha1", CRYPTO_BENCH_HASH, QAPI_CRYPTO_ALG_SHA1_E, QAPI_CRYPTO_MODE_DIGEST_E, 0, 0, helper_digest_iteration},
+    {"sha256", CRYPTO_BENCH_HASH, QAPI_CRYPTO_ALG_SHA256_E, QAPI_CRYPTO_MODE_DIGEST_E, 0, 0, helper_digest_iteration},
+    {"sha384", CRYPTO_BENCH_HASH, QAPI_CRYPTO_ALG_SHA384_E, QAPI_CRYPTO_MODE_DIGEST_E, 0, 0, helper_digest_iteration},
+    {"sha512", CRYPTO_BENCH_HASH, QAPI_CRYPTO_ALG_SHA512_E, QAPI_CRYPTO_MODE_DIGEST_E, 0, 0, helper_digest_iteration},
+    {"hmac-sha256", CRYPTO_BENCH_MAC, QAPI_CRYPTO_ALG_HMAC_SHA256_E, QAPI_CRYPTO_MODE_MAC_E, QAPI_CRYPTO_OBJ_TYPE_HMAC_SHA256_E, 256, helper_mac_iteration},
+};
+
+static const crypto_bench_curve_t crypto_bench_curves[] = {
+    {
+        "ecdsa-p256 sign", "ecdsa-p256 verify", "ecdh-p256",
+        QAPI_CRYPTO_ECC_CURVE_NIST_P256, QAPI_CRYPTO_ALG_ECDSA_P256_E, QAPI_CRYPTO_ALG_ECDH_P256_E,
+        QAPI_CRYPTO_ECC_P256_PRIVATE_KEY_BITS, QAPI_CRYPTO_ECC_P256_PUBLIC_KEY_BITS, QAPI_CRYPTO_ECC_P256_KEYPAIR_BITS,
+        QAPI_CRYPTO_ECC_P256_SHARED_SECRET_BITS, QAPI_CRYPTO_ECC_P256_PUB_VAL_X_BYTES
+    },
+    {
+        "ecdsa-p384 sign", "ecdsa-p384 verify", "ecdh-p384",
+        QAPI_CRYPTO_ECC_CURVE_NIST_P384, QAPI_CRYPTO_ALG_ECDSA_P384_E, QAPI_CRYPTO_ALG_ECDH_P384_E,
+        QAPI_CRYPTO_ECC_P384_PRIVATE_KEY_BITS, QAPI_CRYPTO_ECC_P384_PUBLIC_KEY_BITS, QAPI_CRYPTO_ECC_P384_KEYPAIR_BITS,
+        QAPI_CRYPTO_ECC_P384_SHARED_SECRET_BITS, QAPI_CRYPTO_ECC_P384_PUB_VAL_X_BYTES
+    },
+};
+
+static const uint32_t crypto_bench_rsa_key_bits[] = {1024, 2048};
+
+// RFC 8032 test 1 keypair, private seed followed by the public key
+static const uint8_t crypto_bench_ed25519_keypair[QAPI_CRYPTO_ED25519_PRIVATE_KEY_BYTES] = {
+    0x9d, 0x61, 0xb1, 0x9d, 0xef, 0xfd, 0x5a, 0x60, 0xba, 0x84, 0x4a, 0xf4, 0x92, 0xec, 0x2c, 0xc4,
+    0x44, 0x49, 0xc5, 0x69, 0x7b, 0x32, 0x69, 0x19, 0x70, 0x3b, 0xac, 0x03, 0x1c, 0xae, 0x7f, 0x60,
+    0xd7, 0x5a, 0x98, 0x01, 0x82, 0xb1, 0x0a, 0xb7, 0xd5, 0x4b, 0xfe, 0xd3, 0xc9, 0x64, 0x07, 0x3a,
+    0x0e, 0xe1, 0x72, 0xf3, 0xda, 0xa6, 0x23, 0x25, 0xaf, 0x02, 0x1a, 0x68, 0xf7, 0x07, 0x51, 0x1a,
+};
+
+
+static void helper_ref_attr_init(qapi_Crypto_Attrib_t * attr, uint32_t id, const void * buffer, uint32_t length)
+{
+    attr->attrib_id = id;
+    attr->u.ref.len = length;
+    attr->u.ref.buf = (void *) buffer;
+}
+
+
+static void helper_val_attr_init(qapi_Crypto_Attrib_t * attr, uint32_t id, uint32_t a, uint32_t b)
+{
+    attr->attrib_id = id;
+    attr->u.val.a = a;
+    attr->u.val.b = b;
+}
+
+
+static int helper_obj_alloc(crypto_bench_case_t * p_case, uint32_t obj_type, uint32_t max_key_bits, qapi_Crypto_Obj_Hdl_t * p_obj_hdl)
+{
+    int status;
+
+    if ( p_case->objs_count >= CRYPTO_BENCH_MAX_OBJECTS ) {
+        return QAPI_ERR_NO_RESOURCE;
+    }
+
+    status = qapi_Crypto_Transient_Obj_Alloc(obj_type, max_key_bits, p_obj_hdl);
+    if ( QAPI_OK == status ) {
+        p_case->objs[p_case->objs_count++] = *p_obj_hdl;
+    }
+    return status;
+}
+
+
+static int helper_op_alloc(crypto_bench_case_t * p_case, uint32_t alg, uint32_t mode, uint32_t max_key_bits, qapi_Crypto_Obj_Hdl_t obj_hdl, qapi_Crypto_Op_Hdl_t * p_op_hdl)
+{
+    int status;
+
+    if ( p_case->ops_count >= CRYPTO_BENCH_MAX_OPERATIONS ) {
+        return QAPI_ERR_NO_RESOURCE;
+    }
+
+    status = qapi_Crypto_Op_Alloc(alg, mode, max_key_bits, p_op_hdl);
+    if ( QAPI_OK != status ) {
+        return status;
+    }
+    p_case->ops[p_case->ops_count++] = *p_op_hdl;
+
+    if ( 0 == max_key_bits ) {
+        return QAPI_OK;
+    }
+
+    return qapi_Crypto_Op_Key_Set(*p_op_hdl, obj_hdl);
+}
+
+
+static void helper_case_cleanup(crypto_bench_case_t * p_case)
+{
+    uint32_t i;
+
+    for ( i = 0; i < p_case->ops_count; i++ ) {
+        qapi_Crypto_Op_Free(p_case->ops[i]);
+    }
+    for ( i = 0; i < p_case->objs_count; i++ ) {
+        qapi_Crypto_Transient_Obj_Free(p_case->objs[i]);
+    }
+    memset(p_case, 0, sizeof(*p_case));
+}
+
+
+/*
+ * Runs iteration once untimed, so first call costs stay out of the numbers,
+ * then repeats it until ctxt->duration_ms has passed.
+ */
+static void helper_measure(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case, crypto_bench_iteration_t iteration, crypto_bench_result_t * p_result)
+{
+    uint32_t batch = 1;
+    uint32_t start_ms;
+    uint32_t batch_start_ms;
+    uint32_t now_ms;
+    uint32_t i;
+
+    p_result->iterations = 0;
+    p_result->elapsed_ms = 0;
+
+    p_result->status = iteration(ctxt, p_case);
+    if ( QAPI_OK != p_result->status ) {
+        return;
+    }
+
+    start_ms = ctxt->ops->get_time_ms(ctxt->ops->arg);
+    batch_start_ms = start_ms;
+
+    while ( p_result->elapsed_ms < ctxt->duration_ms ) {
+        for ( i = 0; i < batch; i++ ) {
+            p_result->status = iteration(ctxt, p_case);
+            if ( QAPI_OK != p_result->status ) {
+                return;
+            }
+        }
+        p_result->iterations += batch;
+
+        now_ms = ctxt->ops->get_time_ms(ctxt->ops->arg);
+        p_result->elapsed_ms = now_ms - start_ms;
+        if ( ((now_ms - batch_start_ms) < CRYPTO_BENCH_MIN_BATCH_MS) && (batch < CRYPTO_BENCH_MAX_BATCH) ) {
+            batch *= 2;
+        }
+        batch_start_ms = now_ms;
+    }
+}
+
+
+static void helper_report(crypto_bench_ctxt_t * ctxt, crypto_bench_result_t * p_result)
+{
+    if ( QAPI_OK != p_result->status ) {
+        ctxt->failed_cases++;
+    }
+    ctxt->ops->report(p_result, ctxt->ops->arg);
+}
+
+
+static int helper_cipher_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case)
+{
+    uint32_t output_length = p_case->buffer_size;
+    int status;
+
+    status = qapi_Crypto_Op_Cipher_Init(p_case->op_hdl, ctxt->iv, sizeof(ctxt->iv));
+    if ( QAPI_OK != status ) {
+        return status;
+    }
+
+    return qapi_Crypto_Op_Cipher_Final(p_case->op_hdl, ctxt->input, p_case->buffer_size, ctxt->output, &output_length);
+}
+
+
+static int helper_ae_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case)
+{
+    uint8_t tag[CRYPTO_BENCH_MAX_TAG_BYTES];
+    uint32_t tag_length = sizeof(tag);
+    uint32_t output_length = p_case->buffer_size;
+    int status;
+
+    status = qapi_Crypto_Op_AE_Init(p_case->op_hdl, ctxt->iv, CRYPTO_BENCH_NONCE_BYTES, CRYPTO_BENCH_TAG_BITS, 0, p_case->buffer_size);
+    if ( QAPI_OK != status ) {
+        return status;
+    }
+
+    return qapi_Crypto_Op_AE_Encrypt_Final(p_case->op_hdl, ctxt->input, p_case->buffer_size, ctxt->output, &output_length, tag, &tag_length);
+}
+
+
+// the operation returns to its initial state after the final call
+static int helper_digest_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case)
+{
+    uint32_t digest_length = QAPI_CRYPTO_SHA512_DIGEST_BYTES;
+
+    return qapi_Crypto_Op_Digest_Final(p_case->op_hdl, ctxt->input, p_case->buffer_size, ctxt->output, &digest_length);
+}
+
+
+static int helper_mac_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case)
+{
+    uint32_t mac_length = QAPI_CRYPTO_HMAC_SHA256_MAC_BYTES;
+    int status;
+
+    status = qapi_Crypto_Op_Mac_Init(p_case->op_hdl, NULL, 0);
+    if ( QAPI_OK != status ) {
+        return status;
+    }
+
+    return qapi_Crypto_Op_Mac_Final_Compute(p_case->op_hdl, ctxt->input, p_case->buffer_size, ctxt->output, &mac_length);
+}
+
+
+static int helper_sign_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case)
+{
+    p_case->signature_length = sizeof(p_case->signature);
+
+    return qapi_Crypto_Op_Sign_Digest(p_case->op_hdl, NULL, 0, ctxt->input, CRYPTO_BENCH_DIGEST_BYTES, p_case->signature, &p_case->signature_length);
+}
+
+
+static int helper_verify_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case)
+{
+    return qapi_Crypto_Op_Verify_Digest(p_case->op_hdl, NULL, 0, ctxt->input, CRYPTO_BENCH_DIGEST_BYTES, p_case->signature, p_case->signature_length);
+}
+
+
+static int helper_derive_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case)
+{
+    int status;
+
+    status = qapi_Crypto_Transient_Obj_Reset(p_case->derived_key_hdl);
+    if ( QAPI_OK != status ) {
+        return status;
+    }
+
+    return qapi_Crypto_Op_Key_Derive(p_case->op_hdl, p_case->peer_attrs, p_case->peer_attrs_count, p_case->derived_key_hdl);
+}
+
+
+static int helper_ed25519_tee_sign_iteration(crypto_bench_ctxt_t * ctxt, crypto_bench_case_t * p_case)
+{
+    size_t signature_length = sizeof(p_case->signature);
+    int status;
+
+    status = qapi_Ed25519_Sign(CRYPTO_BENCH_ED25519_TEE_KEY_ID, ctxt->input, CRYPTO_BENCH_DIGEST_BYTES, p_case->signature, &signature_length);
+    p_case->signature_length = signature_length;
+    return status;
+}
+
+
+static void helper_bench_symmetric(crypto_bench_ctxt_t * ctxt, const crypto_bench_symmetric_t * p_symmetric)
+{
+    crypto_bench_case_t bench_case;
+    crypto_bench_result_t result;
+    qapi_Crypto_Obj_Hdl_t obj_hdl = 0;
+    qapi_Crypto_Attrib_t attr;
+    uint32_t i;
+
+    memset(&bench_case, 0, sizeof(bench_case));
+
+    for ( i = 0; i < sizeof(crypto_bench_buffer_sizes)/sizeof(crypto_bench_buffer_sizes[0]); i++ ) {
+        memset(&result, 0, sizeof(result));
+        result.algorithm = p_symmetric->algorithm;
+        result.backend = "qapi";
+        result.key_bits = p_symmetric->key_bits;
+        result.buffer_size = crypto_bench_buffer_sizes[i];
+
+        // the key and the operation are set up once per buffer size, outside the measurement
+        if ( p_symmetric->obj_type ) {
+            result.status = helper_obj_alloc(&bench_case, p_symmetric->obj_type, p_symmetric->key_bits, &obj_hdl);
+            if ( QAPI_OK != result.status ) {
+                goto helper_bench_symmetric_report;
+            }
+
+            helper_ref_attr_init(&attr, QAPI_CRYPTO_ATTR_SECRET_VALUE_E, ctxt->key, p_symmetric->key_bits / 8);
+            result.status = qapi_Crypto_Transient_Obj_Populate(obj_hdl, &attr, 1);
+            if ( QAPI_OK != result.status ) {
+                goto helper_bench_symmetric_report;
+            }
+        }
+
+        result.status = helper_op_alloc(&bench_case, p_symmetric->alg, p_symmetric->mode, p_symmetric->key_bits, obj_hdl, &bench_case.op_hdl);
+        if ( QAPI_OK != result.status ) {
+            goto helper_bench_symmetric_report;
+        }
+
+        bench_case.buffer_size = result.buffer_size;
+        helper_measure(ctxt, &bench_case, p_symmetric->iteration, &result);
+
+helper_bench_symmetric_report:
+        helper_case_cleanup(&bench_case);
+        helper_report(ctxt, &result);
+    }
+}
+
+
+/*
+ * Measures sign on op_hdl and then verify of the last signature on
+ * verify_op_hdl. A failed sign skips verify since it has nothing to check.
+ */
+static void helper_bench_sign_verify(
+    crypto_bench_ctxt_t * ctxt,
+    crypto_bench_case_t * p_case,
+    crypto_bench_result_t * p_result,
+    const char * verify_algorithm,
+    qapi_Crypto_Op_Hdl_t verify_op_hdl
+    )
+{
+    helper_measure(ctxt, p_case, helper_sign_iteration, p_result);
+    helper_report(ctxt, p_result);
+    if ( QAPI_OK != p_result->status ) {
+        return;
+    }
+
+    p_result->algorithm = verify_algorithm;
+    p_case->op_hdl = verify_op_hdl;
+    helper_measure(ctxt, p_case, helper_verify_iteration, p_result);
+    helper_report(ctxt, p_result);
+}
+
+
+static void helper_bench_ecdsa(crypto_bench_ctxt_t * ctxt, const crypto_bench_curve_t * p_curve)
+{
+    crypto_bench_case_t bench_case;
+    crypto_bench_result_t result;
+    qapi_Crypto_Obj_Hdl_t keypair_hdl;
+    qapi_Crypto_Op_Hdl_t verify_op_hdl;
+    qapi_Crypto_Attrib_t attr;
+
+    memset(&bench_case, 0, sizeof(bench_case));
+    memset(&result, 0, sizeof(result));
+    result.algorithm = p_curve->sign_algorithm;
+    result.backend = "qapi";
+    result.key_bits = p_curve->private_key_bits;
+
+    result.status = helper_obj_alloc(&bench_case, QAPI_CRYPTO_OBJ_TYPE_ECDSA_KEYPAIR_E, p_curve->keypair_bits, &keypair_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdsa_on_error;
+    }
+
+    helper_val_attr_init(&attr, QAPI_CRYPTO_ATTR_ECC_CURVE_E, p_curve->curve_id, 0);
+    result.status = qapi_Crypto_Transient_Obj_Key_Gen(keypair_hdl, p_curve->keypair_bits, &attr, 1);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdsa_on_error;
+    }
+
+    result.status = helper_op_alloc(&bench_case, p_curve->sign_alg, QAPI_CRYPTO_MODE_SIGN_E, p_curve->private_key_bits, keypair_hdl, &bench_case.op_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdsa_on_error;
+    }
+
+    result.status = helper_op_alloc(&bench_case, p_curve->sign_alg, QAPI_CRYPTO_MODE_VERIFY_E, p_curve->public_key_bits, keypair_hdl, &verify_op_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdsa_on_error;
+    }
+
+    helper_bench_sign_verify(ctxt, &bench_case, &result, p_curve->verify_algorithm, verify_op_hdl);
+    helper_case_cleanup(&bench_case);
+    return;
+
+helper_bench_ecdsa_on_error:
+    helper_case_cleanup(&bench_case);
+    helper_report(ctxt, &result);
+}
+
+
+static void helper_bench_rsa(crypto_bench_ctxt_t * ctxt, uint32_t key_bits)
+{
+    crypto_bench_case_t bench_case;
+    crypto_bench_result_t result;
+    qapi_Crypto_Obj_Hdl_t keypair_hdl;
+    qapi_Crypto_Op_Hdl_t verify_op_hdl;
+
+    memset(&bench_case, 0, sizeof(bench_case));
+    memset(&result, 0, sizeof(result));
+    result.algorithm = "rsa-pkcs1-sha256 sign";
+    result.backend = "qapi";
+    result.key_bits = key_bits;
+
+    result.status = helper_obj_alloc(&bench_case, QAPI_CRYPTO_OBJ_TYPE_RSA_KEYPAIR_E, key_bits, &keypair_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_rsa_on_error;
+    }
+
+    // generating the key takes seconds for the larger sizes, it is not part of the measurement
+    result.status = qapi_Crypto_Transient_Obj_Key_Gen(keypair_hdl, key_bits, NULL, 0);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_rsa_on_error;
+    }
+
+    result.status = helper_op_alloc(&bench_case, QAPI_CRYPTO_ALG_RSASSA_PKCS1_V1_5_SHA256_E, QAPI_CRYPTO_MODE_SIGN_E, key_bits, keypair_hdl, &bench_case.op_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_rsa_on_error;
+    }
+
+    result.status = helper_op_alloc(&bench_case, QAPI_CRYPTO_ALG_RSASSA_PKCS1_V1_5_SHA256_E, QAPI_CRYPTO_MODE_VERIFY_E, key_bits, keypair_hdl, &verify_op_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_rsa_on_error;
+    }
+
+    helper_bench_sign_verify(ctxt, &bench_case, &result, "rsa-pkcs1-sha256 verify", verify_op_hdl);
+    helper_case_cleanup(&bench_case);
+    return;
+
+helper_bench_rsa_on_error:
+    helper_case_cleanup(&bench_case);
+    helper_report(ctxt, &result);
+}
+
+
+/*
+ * ed25519 signs both with a key handed to qapi_Crypto and with a keypair the
+ * TEE generates and holds, so the two paths show up next to each other.
+ */
+static void helper_bench_ed25519(crypto_bench_ctxt_t * ctxt)
+{
+    crypto_bench_case_t bench_case;
+    crypto_bench_result_t result;
+    qapi_Crypto_Obj_Hdl_t keypair_hdl;
+    qapi_Crypto_Op_Hdl_t verify_op_hdl;
+    qapi_Crypto_Attrib_t attrs[2];
+    uint8_t public_key[QAPI_CRYPTO_ED25519_PUBLIC_KEY_BYTES];
+    size_t public_key_size = sizeof(public_key);
+
+    memset(&bench_case, 0, sizeof(bench_case));
+    memset(&result, 0, sizeof(result));
+    result.algorithm = "ed25519 sign";
+    result.backend = "qapi";
+    result.key_bits = QAPI_CRYPTO_ED25519_PUBLIC_KEY_BYTES * 8;
+
+    result.status = helper_obj_alloc(&bench_case, QAPI_CRYPTO_OBJ_TYPE_ED25519_KEYPAIR_E, QAPI_CRYPTO_ED25519_PRIVATE_KEY_BITS, &keypair_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ed25519_on_error;
+    }
+
+    helper_ref_attr_init(&attrs[0], QAPI_CRYPTO_ATTR_ED25519_PRIVATE_VALUE_E, crypto_bench_ed25519_keypair, QAPI_CRYPTO_ED25519_PRIVATE_KEY_BYTES);
+    helper_ref_attr_init(&attrs[1], QAPI_CRYPTO_ATTR_ED25519_PUBLIC_VALUE_E, &crypto_bench_ed25519_keypair[QAPI_CRYPTO_ED25519_PRIVATE_KEY_BYTES - QAPI_CRYPTO_ED25519_PUBLIC_KEY_BYTES], QAPI_CRYPTO_ED25519_PUBLIC_KEY_BYTES);
+    result.status = qapi_Crypto_Transient_Obj_Populate(keypair_hdl, attrs, 2);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ed25519_on_error;
+    }
+
+    result.status = helper_op_alloc(&bench_case, QAPI_CRYPTO_ALG_ED25519_E, QAPI_CRYPTO_MODE_SIGN_E, QAPI_CRYPTO_ED25519_PRIVATE_KEY_BITS, keypair_hdl, &bench_case.op_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ed25519_on_error;
+    }
+
+    result.status = helper_op_alloc(&bench_case, QAPI_CRYPTO_ALG_ED25519_E, QAPI_CRYPTO_MODE_VERIFY_E, QAPI_CRYPTO_ED25519_PUBLIC_KEY_BITS, keypair_hdl, &verify_op_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ed25519_on_error;
+    }
+
+    helper_bench_sign_verify(ctxt, &bench_case, &result, "ed25519 verify", verify_op_hdl);
+    helper_case_cleanup(&bench_case);
+
+    memset(&result, 0, sizeof(result));
+    result.algorithm = "ed25519 sign";
+    result.backend = "tee";
+    result.key_bits = QAPI_CRYPTO_ED25519_PUBLIC_KEY_BYTES * 8;
+
+    result.status = qapi_Ed25519_Generate_Key_Pair(CRYPTO_BENCH_ED25519_TEE_KEY_ID, public_key, &public_key_size);
+    if ( QAPI_OK == result.status ) {
+        helper_measure(ctxt, &bench_case, helper_ed25519_tee_sign_iteration, &result);
+        qapi_Ed25519_Reset_Key(CRYPTO_BENCH_ED25519_TEE_KEY_ID);
+    }
+    helper_report(ctxt, &result);
+    return;
+
+helper_bench_ed25519_on_error:
+    helper_case_cleanup(&bench_case);
+    helper_report(ctxt, &result);
+}
+
+
+static void helper_bench_ecdh(crypto_bench_ctxt_t * ctxt, const crypto_bench_curve_t * p_curve)
+{
+    crypto_bench_case_t bench_case;
+    crypto_bench_result_t result;
+    qapi_Crypto_Obj_Hdl_t keypair_hdl;
+    qapi_Crypto_Obj_Hdl_t peer_keypair_hdl;
+    qapi_Crypto_Attrib_t attr;
+
+    memset(&bench_case, 0, sizeof(bench_case));
+    memset(&result, 0, sizeof(result));
+    result.algorithm = p_curve->derive_algorithm;
+    result.backend = "qapi";
+    result.key_bits = p_curve->private_key_bits;
+
+    helper_val_attr_init(&attr, QAPI_CRYPTO_ATTR_ECC_CURVE_E, p_curve->curve_id, 0);
+
+    result.status = helper_obj_alloc(&bench_case, QAPI_CRYPTO_OBJ_TYPE_ECDH_KEYPAIR_E, p_curve->keypair_bits, &keypair_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdh_report;
+    }
+    result.status = qapi_Crypto_Transient_Obj_Key_Gen(keypair_hdl, p_curve->keypair_bits, &attr, 1);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdh_report;
+    }
+
+    result.status = helper_obj_alloc(&bench_case, QAPI_CRYPTO_OBJ_TYPE_ECDH_KEYPAIR_E, p_curve->keypair_bits, &peer_keypair_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdh_report;
+    }
+    result.status = qapi_Crypto_Transient_Obj_Key_Gen(peer_keypair_hdl, p_curve->keypair_bits, &attr, 1);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdh_report;
+    }
+
+    result.status = qapi_Crypto_Obj_Buf_Attrib_Get(peer_keypair_hdl, QAPI_CRYPTO_ATTR_ECC_PUBLIC_VALUE_X_E, bench_case.peer_public_x, p_curve->coordinate_bytes);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdh_report;
+    }
+    result.status = qapi_Crypto_Obj_Buf_Attrib_Get(peer_keypair_hdl, QAPI_CRYPTO_ATTR_ECC_PUBLIC_VALUE_Y_E, bench_case.peer_public_y, p_curve->coordinate_bytes);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdh_report;
+    }
+    helper_ref_attr_init(&bench_case.peer_attrs[0], QAPI_CRYPTO_ATTR_ECC_PUBLIC_VALUE_X_E, bench_case.peer_public_x, p_curve->coordinate_bytes);
+    helper_ref_attr_init(&bench_case.peer_attrs[1], QAPI_CRYPTO_ATTR_ECC_PUBLIC_VALUE_Y_E, bench_case.peer_public_y, p_curve->coordinate_bytes);
+    bench_case.peer_attrs_count = 2;
+
+    result.status = helper_obj_alloc(&bench_case, QAPI_CRYPTO_OBJ_TYPE_GENERIC_SECRET_E, p_curve->shared_secret_bits, &bench_case.derived_key_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdh_report;
+    }
+
+    result.status = helper_op_alloc(&bench_case, p_curve->derive_alg, QAPI_CRYPTO_MODE_DERIVE_E, p_curve->shared_secret_bits, keypair_hdl, &bench_case.op_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_ecdh_report;
+    }
+
+    helper_measure(ctxt, &bench_case, helper_derive_iteration, &result);
+
+helper_bench_ecdh_report:
+    helper_case_cleanup(&bench_case);
+    helper_report(ctxt, &result);
+}
+
+
+static void helper_bench_curve25519(crypto_bench_ctxt_t * ctxt)
+{
+    crypto_bench_case_t bench_case;
+    crypto_bench_result_t result;
+    qapi_Crypto_Obj_Hdl_t keypair_hdl;
+    qapi_Crypto_Obj_Hdl_t peer_keypair_hdl;
+
+    memset(&bench_case, 0, sizeof(bench_case));
+    memset(&result, 0, sizeof(result));
+    result.algorithm = "curve25519";
+    result.backend = "qapi";
+    result.key_bits = QAPI_CRYPTO_CURVE25519_PRIVATE_KEY_BITS;
+
+    result.status = helper_obj_alloc(&bench_case, QAPI_CRYPTO_OBJ_TYPE_CURVE25519_KEYPAIR_E, QAPI_CRYPTO_CURVE25519_KEYPAIR_BITS, &keypair_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_curve25519_report;
+    }
+    result.status = qapi_Crypto_Transient_Obj_Key_Gen(keypair_hdl, QAPI_CRYPTO_CURVE25519_KEYPAIR_BITS, NULL, 0);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_curve25519_report;
+    }
+
+    result.status = helper_obj_alloc(&bench_case, QAPI_CRYPTO_OBJ_TYPE_CURVE25519_KEYPAIR_E, QAPI_CRYPTO_CURVE25519_KEYPAIR_BITS, &peer_keypair_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_curve25519_report;
+    }
+    result.status = qapi_Crypto_Transient_Obj_Key_Gen(peer_keypair_hdl, QAPI_CRYPTO_CURVE25519_KEYPAIR_BITS, NULL, 0);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_curve25519_report;
+    }
+
+    result.status = qapi_Crypto_Obj_Buf_Attrib_Get(peer_keypair_hdl, QAPI_CRYPTO_ATTR_CURVE25519_PUBLIC_VALUE_E, bench_case.peer_public_x, QAPI_CRYPTO_CURVE25519_PUBLIC_KEY_BYTES);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_curve25519_report;
+    }
+    helper_ref_attr_init(&bench_case.peer_attrs[0], QAPI_CRYPTO_ATTR_CURVE25519_PUBLIC_VALUE_E, bench_case.peer_public_x, QAPI_CRYPTO_CURVE25519_PUBLIC_KEY_BYTES);
+    bench_case.peer_attrs_count = 1;
+
+    result.status = helper_obj_alloc(&bench_case, QAPI_CRYPTO_OBJ_TYPE_GENERIC_SECRET_E, QAPI_CRYPTO_CURVE25519_SHARED_SECRET_BITS, &bench_case.derived_key_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_curve25519_report;
+    }
+
+    result.status = helper_op_alloc(&bench_case, QAPI_CRYPTO_ALG_CURVE25519_DERIVE_SHARED_SECRET_E, QAPI_CRYPTO_MODE_DERIVE_E, QAPI_CRYPTO_CURVE25519_SHARED_SECRET_BITS, keypair_hdl, &bench_case.op_hdl);
+    if ( QAPI_OK != result.status ) {
+        goto helper_bench_curve25519_report;
+    }
+
+    helper_measure(ctxt, &bench_case, helper_derive_iteration, &result);
+
+helper_bench_curve25519_report:
+    helper_case_cleanup(&bench_case);
+    helper_report(ctxt, &result);
+}
+
+
+int crypto_bench_run(uint32_t categories, uint32_t duration_ms, const crypto_bench_ops_t * ops)
+{
+    crypto_bench_ctxt_t ctxt;
+    uint32_t i;
+
+    memset(&ctxt, 0, sizeof(ctxt));
+    ctxt.ops = ops;
+    ctxt.duration_ms = duration_ms;
+
+    // room for the padding or tag some algorithms append to the output
+    ctxt.input = (uint8_t *) malloc(CRYPTO_BENCH_MAX_BUFFER_SIZE);
+    ctxt.output = (uint8_t *) malloc(CRYPTO_BENCH_MAX_BUFFER_SIZE + QAPI_CRYPTO_AES_BLOCK_BYTES);
+    if ( !ctxt.input || !ctxt.output ) {
+        free(ctxt.input);
+        free(ctxt.output);
+        return -1;
+    }
+
+    for ( i = 0; i < CRYPTO_BENCH_MAX_BUFFER_SIZE; i++ ) {
+        ctxt.input[i] = (uint8_t) i;
+    }
+    for ( i = 0; i < sizeof(ctxt.key); i++ ) {
+        ctxt.key[i] = (uint8_t) (0x40 + i);
+    }
+    for ( i = 0; i < sizeof(ctxt.iv); i++ ) {
+        ctxt.iv[i] = (uint8_t) i;
+    }
+
+    for ( i = 0; i < sizeof(crypto_bench_symmetric_cases)/sizeof(crypto_bench_symmetric_cases[0]); i++ ) {
+        if ( categories & crypto_bench_symmetric_cases[i].category ) {
+            helper_bench_symmetric(&ctxt, &crypto_bench_symmetric_cases[i]);
+        }
+    }
+
+    if ( categories & CRYPTO_BENCH_SIGN ) {
+        for ( i = 0; i < sizeof(crypto_bench_curves)/sizeof(crypto_bench_curves[0]); i++ ) {
+            helper_bench_ecdsa(&ctxt, &crypto_bench_curves[i]);
+        }
+        helper_bench_ed25519(&ctxt);
+        for ( i = 0; i < sizeof(crypto_bench_rsa_key_bits)/sizeof(crypto_bench_rsa_key_bits[0]); i++ ) {
+            helper_bench_rsa(&ctxt, crypto_bench_rsa_key_bits[i]);
+        }
+    }
+
+    if ( categories & CRYPTO_BENCH_AGREE ) {
+        for ( i = 0; i < sizeof(crypto_bench_curves)/sizeof(crypto_bench_curves[0]); i++ ) {
+            helper_bench_ecdh(&ctxt, &crypto_bench_curves[i]);
+        }
+        helper_bench_curve25519(&ctxt);
+    }
+
+    free(ctxt.input);
+    free(ctxt.output);
+
+    return ctxt.failed_cases;
+}
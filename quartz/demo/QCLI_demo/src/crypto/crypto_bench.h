@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+/*
+ * Throughput and latency benchmarks for the qapi_Crypto algorithms.
+ *
+ * Every case sets up its keys and operations first and then repeats a single
+ * operation until the requested duration has passed, so only the operation
+ * itself is measured. Symmetric ciphers, MACs and hashes are swept over
+ * buffer sizes and key sizes, sign, verify and key agreement over key sizes.
+ *
+ * Only qapi_crypto.h, qapi_ed25519.h and the C library are used, so this file
+ * also builds on a host against a stand-in qapi_Crypto implementation.
+ */
+
+#ifndef __CRYPTO_BENCH_H__
+#define __CRYPTO_BENCH_H__
+
+#include <stdint.h>
+
+#define CRYPTO_BENCH_CIPHER     0x01    // AES-CBC, AES-CTR
+#define CRYPTO_BENCH_AE         0x02    // AES-GCM, AES-CCM, ChaCha20-Poly1305
+#define CRYPTO_BENCH_HASH       0x04    // MD5, SHA-1, SHA-256, SHA-384, SHA-512
+#define CRYPTO_BENCH_MAC        0x08    // HMAC-SHA256
+#define CRYPTO_BENCH_SIGN       0x10    // ECDSA, ed25519, RSA sign and verify
+#define CRYPTO_BENCH_AGREE      0x20    // ECDH, curve25519
+#define CRYPTO_BENCH_ALL        0x3f
+
+#define CRYPTO_BENCH_DEFAULT_DURATION_MS 1000
+#define CRYPTO_BENCH_MAX_BUFFER_SIZE 4096
+
+// key id used for the keypair the TEE holds during the ed25519 cases
+#define CRYPTO_BENCH_ED25519_TEE_KEY_ID 0
+
+
+typedef struct crypto_bench_result_s {
+    const char * algorithm;     // e.g. "aes-cbc encrypt", "ecdsa-p256 sign"
+    const char * backend;       // "qapi" for qapi_Crypto, "tee" for keys held by the TEE
+    uint32_t key_bits;          // 0 for algorithms without a key
+    uint32_t buffer_size;       // bytes processed per operation, 0 for asymmetric operations
+    uint32_t iterations;
+    uint32_t elapsed_ms;
+    int status;                 // 0, or the status of the call that failed
+} crypto_bench_result_t;
+
+
+typedef struct crypto_bench_ops_s {
+    uint32_t (*get_time_ms)(void * arg);
+    void (*report)(const crypto_bench_result_t * result, void * arg);
+    void * arg;
+} crypto_bench_ops_t;
+
+
+/*
+ * Runs the cases of the selected CRYPTO_BENCH_* categories, calling
+ * ops->report once per case. Returns the number of cases that failed, or -1
+ * when the buffers could not be allocated.
+ */
+int crypto_bench_run(uint32_t categories, uint32_t duration_ms, const crypto_bench_ops_t * ops);
+
+#endif
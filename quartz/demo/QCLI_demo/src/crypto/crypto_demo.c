@@ -17,6 +17,10 @@
 #include "persistent_obj_demo.h"
 #include "qapi_attestation.h"
 #include "qapi_ns_utils.h"
+#ifdef CONFIG_CRYPTO_BENCH_DEMO
+#include "qurt_timer.h"
+#include "crypto_bench.h"
+#endif
 
 #define CRYPTO_DBG
 #ifdef CRYPTO_DBG
@@ -5051,6 +5055,9 @@ QCLI_Command_Status_t crypto_demo_persistent_objects(uint32_t parameters_count,
 #ifdef CONFIG_CRYPTO_ATTESTATION_DEMO
 QCLI_Command_Status_t crypto_demo_attestation(uint32_t parameters_count, QCLI_Parameter_t * parameters);
 #endif
+#ifdef CONFIG_CRYPTO_BENCH_DEMO
+QCLI_Command_Status_t crypto_demo_bench(uint32_t parameters_count, QCLI_Parameter_t * parameters);
+#endif
 
 const QCLI_Command_t crypto_cmd_list[] =
 {
@@ -5064,7 +5071,10 @@ const QCLI_Command_t crypto_cmd_list[] =
 	{crypto_demo_persistent_objects, false, "pobj", "persistent objects demo"},
 #endif
 #ifdef CONFIG_CRYPTO_ATTESTATION_DEMO
-    {crypto_demo_attestation, false, "attestation", "input_hexstring (16 bytes)\n", "Generates attestation token given input_hexstring\n"}
+    {crypto_demo_attestation, false, "attestation", "input_hexstring (16 bytes)\n", "Generates attestation token given input_hexstring\n"},
+#endif
+#ifdef CONFIG_CRYPTO_BENCH_DEMO
+    {crypto_demo_bench, false, "bench", "[all|cipher|ae|hash|mac|sign|agree] [duration_ms]\n", "measure throughput and latency of the crypto algorithms\n"},
 #endif
 };
 
@@ -5242,3 +5252,110 @@ crypto_demo_attestation_on_error:
     return QCLI_STATUS_ERROR_E;
 }
 #endif
+
+#ifdef CONFIG_CRYPTO_BENCH_DEMO
+
+typedef struct crypto_demo_bench_category_s {
+    const char * name;
+    uint32_t categories;
+} crypto_demo_bench_category_t;
+
+static const crypto_demo_bench_category_t crypto_demo_bench_categories[] = {
+    {"all", CRYPTO_BENCH_ALL},
+    {"cipher", CRYPTO_BENCH_CIPHER},
+    {"ae", CRYPTO_BENCH_AE},
+    {"hash", CRYPTO_BENCH_HASH},
+    {"mac", CRYPTO_BENCH_MAC},
+    {"sign", CRYPTO_BENCH_SIGN},
+    {"agree", CRYPTO_BENCH_AGREE},
+};
+
+
+static uint32_t crypto_demo_bench_get_time_ms(void * arg)
+{
+    return (uint32_t) qurt_timer_convert_ticks_to_time(qurt_timer_get_ticks(), QURT_TIME_MSEC);
+}
+
+
+/*
+ * Prints one row per case. Rows with a buffer size show MB/s, the others
+ * operations per second, both with two decimals.
+ */
+static void crypto_demo_bench_report(const crypto_bench_result_t * result, void * arg)
+{
+    uint32_t rate_hundredths = 0;
+    uint32_t us_hundredths = 0;
+
+    if ( QAPI_OK != result->status ) {
+        QCLI_Printf(qcli_crypto_handle, "%-26s %-4s %5u %5u failed, status=%d\r\n",
+            result->algorithm, result->backend, result->key_bits, result->buffer_size, result->status);
+        return;
+    }
+
+    if ( (0 != result->elapsed_ms) && (0 != result->iterations) ) {
+        if ( result->buffer_size ) {
+            // bytes per ms is kB/s, scaled to hundredths of MB/s
+            rate_hundredths = (uint32_t) (((uint64_t) result->buffer_size * result->iterations * 100) / ((uint64_t) result->elapsed_ms * 1000));
+        }
+        else {
+            rate_hundredths = (uint32_t) (((uint64_t) result->iterations * 1000 * 100) / result->elapsed_ms);
+        }
+        us_hundredths = (uint32_t) (((uint64_t) result->elapsed_ms * 1000 * 100) / result->iterations);
+    }
+
+    QCLI_Printf(qcli_crypto_handle, "%-26s %-4s %5u %5u %7u.%02u %-5s %7u.%02u\r\n",
+        result->algorithm, result->backend, result->key_bits, result->buffer_size,
+        rate_hundredths / 100, rate_hundredths % 100, result->buffer_size ? "MB/s" : "op/s",
+        us_hundredths / 100, us_hundredths % 100);
+}
+
+
+QCLI_Command_Status_t crypto_demo_bench(uint32_t parameters_count, QCLI_Parameter_t * parameters)
+{
+    crypto_bench_ops_t ops = {crypto_demo_bench_get_time_ms, crypto_demo_bench_report, 0};
+    uint32_t categories = CRYPTO_BENCH_ALL;
+    uint32_t duration_ms = CRYPTO_BENCH_DEFAULT_DURATION_MS;
+    uint32_t i;
+    int failed_cases;
+
+    if ( parameters_count > 2 ) {
+        goto crypto_demo_bench_on_error;
+    }
+
+    if ( parameters_count >= 1 ) {
+        for ( i = 0; i < sizeof(crypto_demo_bench_categories)/sizeof(crypto_demo_bench_categories[0]); i++ ) {
+            if ( 0 == strcmp(parameters[0].String_Value, crypto_demo_bench_categories[i].name) ) {
+                break;
+            }
+        }
+        if ( i == sizeof(crypto_demo_bench_categories)/sizeof(crypto_demo_bench_categories[0]) ) {
+            goto crypto_demo_bench_on_error;
+        }
+        categories = crypto_demo_bench_categories[i].categories;
+    }
+
+    if ( parameters_count == 2 ) {
+        if ( !parameters[1].Integer_Is_Valid || (parameters[1].Integer_Value <= 0) ) {
+            goto crypto_demo_bench_on_error;
+        }
+        duration_ms = parameters[1].Integer_Value;
+    }
+
+    QCLI_Printf(qcli_crypto_handle, "%-26s %-4s %5s %5s %16s %10s\r\n", "algorithm", "impl", "key", "size", "rate", "us/op");
+
+    failed_cases = crypto_bench_run(categories, duration_ms, &ops);
+    if ( failed_cases < 0 ) {
+        QCLI_Printf(qcli_crypto_handle, "Failed to allocate the bench buffers\r\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+    if ( failed_cases > 0 ) {
+        QCLI_Printf(qcli_crypto_handle, "%d cases failed\r\n", failed_cases);
+    }
+
+    return QCLI_STATUS_SUCCESS_E;
+
+crypto_demo_bench_on_error:
+    QCLI_Printf(qcli_crypto_handle, "Usage: bench [all|cipher|ae|hash|mac|sign|agree] [duration_ms]\r\n");
+    return QCLI_STATUS_USAGE_E;
+}
+#endif
@@ -245,6 +245,151 @@ void bench_common_print_test_results(THROUGHPUT_CXT *p_tCxt, STATS *pktStats)
     QCLI_Printf(qcli_net_handle, "\tThroughput: %u Kbits/sec\n", throughput);
 }
 
+/************************************************************************
+* NAME: bench_common_lat_bucket
+*
+* DESCRIPTION: Map a latency to its histogram bucket. Values below
+* BENCH_LAT_SUB_BUCKETS map to themselves; above that the top
+* BENCH_LAT_SUB_BUCKET_BITS+1 significant bits select the bucket.
+************************************************************************/
+static uint32_t bench_common_lat_bucket(uint32_t usec)
+{
+    uint32_t msb = 0;
+
+    if (usec < BENCH_LAT_SUB_BUCKETS)
+        return usec;
+
+    while ((usec >> msb) > 1)
+        msb++;
+
+    return ((msb - BENCH_LAT_SUB_BUCKET_BITS + 1) * BENCH_LAT_SUB_BUCKETS) +
+           ((usec >> (msb - BENCH_LAT_SUB_BUCKET_BITS)) & (BENCH_LAT_SUB_BUCKETS - 1));
+}
+
+/************************************************************************
+* NAME: bench_common_lat_bucket_max
+*
+* DESCRIPTION: Largest latency that maps to a histogram bucket.
+************************************************************************/
+static uint32_t bench_common_lat_bucket_max(uint32_t bucket)
+{
+    uint32_t shift, sub;
+
+    if (bucket < BENCH_LAT_SUB_BUCKETS)
+        return bucket;
+
+    shift = (bucket / BENCH_LAT_SUB_BUCKETS) - 1;
+    sub = bucket % BENCH_LAT_SUB_BUCKETS;
+
+    return (((BENCH_LAT_SUB_BUCKETS + sub + 1) << shift) - 1);
+}
+
+/************************************************************************
+************************************************************************/
+void bench_common_lat_init(bench_lat_stats_t *lat)
+{
+    memset(lat, 0, sizeof(bench_lat_stats_t));
+    lat->min_us = 0xFFFFFFFF;
+    rxreorder_udp_payload_init(&lat->reorder);
+}
+
+/************************************************************************
+* NAME: bench_common_lat_record
+*
+* DESCRIPTION: Add one round trip time to the histogram and update the
+* interarrival jitter estimate, J += (|D| - J)/16 as in RFC 3550.
+************************************************************************/
+void bench_common_lat_record(bench_lat_stats_t *lat, uint32_t usec)
+{
+    uint32_t delta;
+
+    lat->counts[bench_common_lat_bucket(usec)]++;
+    lat->sum_us += usec;
+
+    if (usec < lat->min_us)
+        lat->min_us = usec;
+    if (usec > lat->max_us)
+        lat->max_us = usec;
+
+    if (lat->samples)
+    {
+        delta = (usec > lat->last_us) ? (usec - lat->last_us) : (lat->last_us - usec);
+        /* jitter_x16 holds 16*J, so the update is 16*J += |D| - J */
+        lat->jitter_x16 = lat->jitter_x16 + delta - ((lat->jitter_x16 + 8) / 16);
+    }
+
+    lat->last_us = usec;
+    lat->samples++;
+}
+
+/************************************************************************
+* NAME: bench_common_lat_percentile
+*
+* DESCRIPTION: Return the latency below which per_10000/10000 of the
+* samples fall, rounded up to the end of its bucket.
+************************************************************************/
+uint32_t bench_common_lat_percentile(bench_lat_stats_t *lat, uint32_t per_10000)
+{
+    unsigned long long rank;
+    unsigned long long seen = 0;
+    uint32_t bucket;
+    uint32_t value;
+
+    if (lat->samples == 0)
+        return 0;
+
+    rank = ((unsigned long long)lat->samples * per_10000 + 9999) / 10000;
+    if (rank == 0)
+        rank = 1;
+
+    for (bucket = 0; bucket < BENCH_LAT_BUCKETS; bucket++)
+    {
+        seen += lat->counts[bucket];
+        if (seen >= rank)
+            break;
+    }
+
+    value = bench_common_lat_bucket_max(bucket);
+
+    return (value > lat->max_us) ? lat->max_us : value;
+}
+
+/************************************************************************
+************************************************************************/
+void bench_common_lat_print(bench_lat_stats_t *lat)
+{
+    uint32_t received = lat->samples;
+    uint32_t lost = (lat->sent > received) ? (lat->sent - received) : 0;
+
+    QCLI_Printf(qcli_net_handle, "\nLatency (round trip, usec):\n\n");
+
+    if (received == 0)
+    {
+        QCLI_Printf(qcli_net_handle, "\tNo responses received\n");
+    }
+    else
+    {
+        QCLI_Printf(qcli_net_handle, "\tmin=%u avg=%u max=%u\n",
+                lat->min_us, (uint32_t)(lat->sum_us / received), lat->max_us);
+        QCLI_Printf(qcli_net_handle, "\tp50=%u p90=%u p99=%u p99.9=%u\n",
+                bench_common_lat_percentile(lat, 5000),
+                bench_common_lat_percentile(lat, 9000),
+                bench_common_lat_percentile(lat, 9900),
+                bench_common_lat_percentile(lat, 9990));
+        QCLI_Printf(qcli_net_handle, "\tjitter=%u\n", lat->jitter_x16 / 16);
+    }
+
+    QCLI_Printf(qcli_net_handle, "\trequests=%u responses=%u lost=%u late=%u timeouts=%u\n",
+            lat->sent, received, lost, lat->late, lat->timeouts);
+
+    if (rxreorder_udp_payload_valid(&lat->reorder))
+    {
+        lat->reorder.pkts_plan = lat->sent;
+        lat->reorder.pkts_recvd = received;
+        rxreorder_udp_payload_report(&lat->reorder);
+    }
+}
+
 
 /************************************************************************
  ************************************************************************/
@@ -252,27 +397,30 @@ static void tx_help(uint32_t v6)
 {
     if (v6)
     {
-        QCLI_Printf(qcli_net_handle, "benchtx6 <Rx IP> <port> {tcp|tcpzc|udp|udpzc|ssl} <msg size> <mode> <arg> <delay in microseconds between msgs> [<tclass>]\n");
+        QCLI_Printf(qcli_net_handle, "benchtx6 <Rx IP> <port> {tcp|tcpzc|udp|udpzc|udplat|ssl} <msg size> <mode> <arg> <delay in microseconds between msgs> [<tclass>]\n");
         QCLI_Printf(qcli_net_handle, " <mode> can be 0 or 1.\n");
         QCLI_Printf(qcli_net_handle, " If <mode> is 0, <arg> is time to TX in seconds.\n");
         QCLI_Printf(qcli_net_handle, " If <mode> is 1, <arg> is number of msgs to TX.\n");
+        QCLI_Printf(qcli_net_handle, " udplat measures round trip latency against 'benchrx udpecho'.\n");
         QCLI_Printf(qcli_net_handle, "Examples:\n");
         QCLI_Printf(qcli_net_handle, " benchtx6 fe80::865d:d7ff:fe40:3498%%wlan1 2390 udp 1400 1 100 0 0xA0\n");
         QCLI_Printf(qcli_net_handle, " benchtx6 2001:db8:85a3:8d3:1319:8a2e:370:734 2390 tcpzc 512 0 30 5\n");
     }
     else
     {
-        QCLI_Printf(qcli_net_handle, "benchtx <Rx IP> <port> {tcp|tcpzc|udp|udpzc|ssl} <msg size> <mode> <arg> <delay in microseconds between msgs> [<tos>] <source IP>\n");
+        QCLI_Printf(qcli_net_handle, "benchtx <Rx IP> <port> {tcp|tcpzc|udp|udpzc|udplat|ssl} <msg size> <mode> <arg> <delay in microseconds between msgs> [<tos>] <source IP>\n");
         QCLI_Printf(qcli_net_handle, "benchtx <Rx IP> <protocol> raw <msg size> <mode> <arg> <delay in microseconds between msgs> [<tos>]\n");
         QCLI_Printf(qcli_net_handle, "benchtx <Rx IP> <protocol> rawh <msg size> <mode> <arg> <delay in microseconds between msgs> <tos> <source IP>\n");
         QCLI_Printf(qcli_net_handle, " <mode> can be 0 or 1.\n");
         QCLI_Printf(qcli_net_handle, " If <mode> is 0, <arg> is time to TX in seconds.\n");
         QCLI_Printf(qcli_net_handle, " If <mode> is 1, <arg> is number of msgs to TX.\n");
+        QCLI_Printf(qcli_net_handle, " udplat measures round trip latency against 'benchrx udpecho'.\n");
         QCLI_Printf(qcli_net_handle, "Examples:\n");
         QCLI_Printf(qcli_net_handle, " benchtx 192.168.1.20 2390 udp 1400 1 100 0 0xA0\n");
         QCLI_Printf(qcli_net_handle, " benchtx 255.255.255.255 5001 udp 1200 0 30 0 0xA0 192.168.1.145\n");
         QCLI_Printf(qcli_net_handle, " benchtx 192.168.1.20 26 raw 1400 0 60 0\n");
         QCLI_Printf(qcli_net_handle, " benchtx 192.168.1.20 26 rawh 1400 1 100 10 0xA0 192.168.1.100\n");
+        QCLI_Printf(qcli_net_handle, " benchtx 192.168.1.20 2390 udplat 64 1 1000 10000\n");
     }
 }
 uint32_t bench_common_IsTCP(THROUGHPUT_CXT *p_rxtCxt)
@@ -293,7 +441,7 @@ uint32_t bench_common_IsSSL(THROUGHPUT_CXT *p_rxtCxt)
 void bench_common_SetProtocol(THROUGHPUT_CXT *p_rxtCxt, const char* protocol)
 {
 	if (strcasecmp("udp", protocol) == 0 || strcasecmp("udpzc", protocol) == 0
-	        || strcasecmp("udpecho", protocol) == 0) {
+	        || strcasecmp("udpecho", protocol) == 0 || strcasecmp("udplat", protocol) == 0) {
 		p_rxtCxt->protocol = UDP;
 	}
 	else if (strcasecmp("tcp", protocol) == 0 || strcasecmp("tcpzc", protocol) == 0
@@ -322,6 +470,10 @@ void bench_common_SetProtocol(THROUGHPUT_CXT *p_rxtCxt, const char* protocol)
     if (strcasecmp("udpecho", protocol) == 0 || strcasecmp("tcpecho", protocol) == 0) {
         p_rxtCxt->echo = 1;
     }
+
+    if (strcasecmp("udplat", protocol) == 0) {
+        p_rxtCxt->latency = 1;
+    }
 }
 
 uint32_t bench_common_IsPortInUse(THROUGHPUT_CXT *p_rxtCxt, uint16_t port)
@@ -491,7 +643,10 @@ static QCLI_Command_Status_t bench_common_tx(THROUGHPUT_CXT *p_tCxt, uint32_t Pa
 				goto end;
 			}
    		}
-        bench_udp_tx(p_tCxt);
+        if (p_tCxt->latency)
+            bench_udp_lat(p_tCxt);
+        else
+            bench_udp_tx(p_tCxt);
 		break;
 		case IP_RAW:
 		p_tCxt->test_type = TX;
@@ -169,6 +169,7 @@ typedef struct throughput_cxt
     uint8_t is_iperf:1;
     uint8_t print_buf:1;
     uint8_t echo:1;
+    uint8_t latency:1;              /* request/response latency test */
 } THROUGHPUT_CXT;
 
 typedef struct {
@@ -347,6 +348,41 @@ typedef struct stat_udp_pattern
     char stat_valid;
 }stat_udp_pattern_t;
 
+/* udp latency test request, echoed back by "benchrx udpecho".
+ * The pattern header comes first so that the rxreorder_udp_payload_*
+ * functions can track reordering of the responses.
+ */
+typedef struct udp_latency_header{
+  UDP_PATTERN_PACKET pattern;
+  uint32_t seq;         /* full request number (network order) */
+  uint32_t tx_ticks;    /* system ticks when the request was sent */
+} UDP_LATENCY_HEADER;
+
+#define BENCH_LAT_RESPONSE_TIMEOUT_MS   (1000)
+
+/* Log-linear latency histogram: values below 2^BENCH_LAT_SUB_BUCKET_BITS
+ * have their own bucket, every larger power of two is split into
+ * BENCH_LAT_SUB_BUCKETS linear buckets (worst case error 1/16).
+ */
+#define BENCH_LAT_SUB_BUCKET_BITS       (4)
+#define BENCH_LAT_SUB_BUCKETS           (1 << BENCH_LAT_SUB_BUCKET_BITS)
+#define BENCH_LAT_BUCKETS               ((32 - BENCH_LAT_SUB_BUCKET_BITS + 1) * BENCH_LAT_SUB_BUCKETS)
+
+typedef struct bench_lat_stats
+{
+    uint32_t counts[BENCH_LAT_BUCKETS];
+    uint32_t samples;
+    uint32_t min_us;
+    uint32_t max_us;
+    unsigned long long sum_us;
+    uint32_t last_us;
+    uint32_t jitter_x16;            /* RFC 3550 style jitter, scaled by 16 */
+    uint32_t sent;
+    uint32_t late;                  /* responses that arrived after their timeout */
+    uint32_t timeouts;
+    stat_udp_pattern_t reorder;
+} bench_lat_stats_t;
+
 /* Dump command */
 extern uint8_t dump_enabled;
 extern uint8_t dump_flags;
@@ -382,6 +418,11 @@ void bench_udp_rx(THROUGHPUT_CXT *p_tCxt);
 void bench_udp_rx_zc(THROUGHPUT_CXT *p_tCxt);
 void bench_udp_tx(THROUGHPUT_CXT *p_tCxt);
 void bench_common_print_test_results(THROUGHPUT_CXT *p_tCxt, STATS *pktStats);
+void bench_common_lat_init(bench_lat_stats_t *lat);
+void bench_common_lat_record(bench_lat_stats_t *lat, uint32_t usec);
+uint32_t bench_common_lat_percentile(bench_lat_stats_t *lat, uint32_t per_10000);
+void bench_common_lat_print(bench_lat_stats_t *lat);
+void bench_udp_lat(THROUGHPUT_CXT *p_tCxt);
 uint32_t bench_common_check_test_time(THROUGHPUT_CXT *p_tCxt);
 int bench_common_wait_for_response(THROUGHPUT_CXT *p_tCxt, struct sockaddr *to, uint32_t tolen, uint32_t cur_packet_number);
 QCLI_Command_Status_t bench_uapsd_test(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
@@ -16,6 +16,7 @@ Qualcomm Atheros Confidential and Proprietary.
 #include "qapi_ns_gen_v6.h"
 #include "iperf.h"
 #include "qapi_delay.h"
+#include "qurt_timer.h"
 
 #ifdef CONFIG_NET_TXRX_DEMO
 
@@ -1827,4 +1828,241 @@ ERROR_1:
 
     return;
 }
+
+/************************************************************************
+* NAME: bench_udp_lat_wait_response
+*
+* DESCRIPTION: Wait for the echo of request 'seq'. Every valid response
+* that arrives meanwhile, including late echoes of earlier requests, is
+* added to the latency histogram.
+* Returns 1 if the response arrived, 0 on timeout, -1 on socket error.
+************************************************************************/
+static int bench_udp_lat_wait_response(THROUGHPUT_CXT *p_tCxt, bench_lat_stats_t *lat,
+                                       uint32_t seq, uint32_t ticks_per_sec)
+{
+    UDP_LATENCY_HEADER hdr;
+    time_struct_t start, now;
+    uint32_t waited, rtt_ticks;
+    int32_t received, conn_sock;
+    fd_set rset;
+
+    app_get_time(&start);
+
+    while (!benchtx_quit)
+    {
+        app_get_time(&now);
+        waited = app_get_time_difference(&start, &now);
+        if (waited >= BENCH_LAT_RESPONSE_TIMEOUT_MS)
+            return 0;
+
+        qapi_fd_zero(&rset);
+        qapi_fd_set(p_tCxt->sock_peer, &rset);
+
+        conn_sock = qapi_select(&rset, NULL, NULL, BENCH_LAT_RESPONSE_TIMEOUT_MS - waited);
+        if (conn_sock == A_ERROR)
+            return -1;
+        if (conn_sock == 0)
+            return 0;
+
+        received = qapi_recv(p_tCxt->sock_peer, p_tCxt->buffer, CFG_PACKET_SIZE_MAX_RX, 0);
+        if (received < 0)
+            return -1;
+
+        rtt_ticks = (uint32_t)qurt_timer_get_ticks();
+
+        if (received < (int32_t)sizeof(UDP_LATENCY_HEADER))
+            continue;
+
+        memcpy(&hdr, p_tCxt->buffer, sizeof(hdr));
+        if (hdr.pattern.code != CODE_UDP)
+            continue;
+
+        rtt_ticks -= hdr.tx_ticks;
+        bench_common_lat_record(lat, (uint32_t)(((uint64_t)rtt_ticks * 1000000) / ticks_per_sec));
+        rxreorder_udp_payload_statistics(&lat->reorder, p_tCxt->buffer, received);
+
+        if (ntohl(hdr.seq) == seq)
+            return 1;
+
+        lat->late++;
+    }
+
+    return 0;
+}
+
+/************************************************************************
+* NAME: bench_udp_lat
+*
+* DESCRIPTION: Request/response latency test. Each request carries a
+* sequence number and a send timestamp; the peer ("benchrx udpecho")
+* sends it back and the round trip time goes into a log-linear
+* histogram. One request is outstanding at a time.
+************************************************************************/
+void bench_udp_lat(THROUGHPUT_CXT *p_tCxt)
+{
+    struct sockaddr_in foreign_addr;
+    struct sockaddr_in6 foreign_addr6;
+    struct sockaddr *to;
+    uint32_t tolen;
+    char ip_str[48];
+    int family;
+    uint32_t packet_size = p_tCxt->params.tx_params.packet_size;
+    uint32_t ticks_per_sec;
+    uint32_t seq = 0;
+    int32_t send_bytes;
+    int result;
+    UDP_LATENCY_HEADER hdr;
+    bench_lat_stats_t *lat = NULL;
+
+    if (p_tCxt->params.tx_params.v6)
+    {
+        family = AF_INET6;
+        inet_ntop(family, p_tCxt->params.tx_params.v6addr, ip_str, sizeof(ip_str));
+
+        memset(&foreign_addr6, 0, sizeof(foreign_addr6));
+        memcpy(&foreign_addr6.sin_addr, p_tCxt->params.tx_params.v6addr, sizeof(foreign_addr6.sin_addr));
+        foreign_addr6.sin_port      = htons(p_tCxt->params.tx_params.port);
+        foreign_addr6.sin_family    = family;
+        foreign_addr6.sin_scope_id  = p_tCxt->params.tx_params.scope_id;
+
+        to = (struct sockaddr *)&foreign_addr6;
+        tolen = sizeof(foreign_addr6);
+    }
+    else
+    {
+        family = AF_INET;
+        inet_ntop(family, &p_tCxt->params.tx_params.ip_address, ip_str, sizeof(ip_str));
+
+        memset(&foreign_addr, 0, sizeof(foreign_addr));
+        foreign_addr.sin_addr.s_addr    = p_tCxt->params.tx_params.ip_address;
+        foreign_addr.sin_port           = htons(p_tCxt->params.tx_params.port);
+        foreign_addr.sin_family         = family;
+
+        to = (struct sockaddr *)&foreign_addr;
+        tolen = sizeof(foreign_addr);
+    }
+
+    if (packet_size < sizeof(UDP_LATENCY_HEADER))
+        packet_size = sizeof(UDP_LATENCY_HEADER);
+    else if (packet_size > CFG_PACKET_SIZE_MAX_RX)
+        packet_size = CFG_PACKET_SIZE_MAX_RX;
+
+    QCLI_Printf(qcli_net_handle, "****************************************************************\n");
+    QCLI_Printf(qcli_net_handle, "IOT UDP Latency Test\n");
+    QCLI_Printf(qcli_net_handle, "****************************************************************\n");
+    QCLI_Printf(qcli_net_handle, "Remote IP addr: %s\n", ip_str);
+    QCLI_Printf(qcli_net_handle, "Remote port: %d\n", p_tCxt->params.tx_params.port);
+    QCLI_Printf(qcli_net_handle, "Message size: %u\n", packet_size);
+    QCLI_Printf(qcli_net_handle, "Delay in microseconds: %u\n", p_tCxt->params.tx_params.interval_us);
+    QCLI_Printf(qcli_net_handle, "Type benchquit to terminate test\n");
+    QCLI_Printf(qcli_net_handle, "****************************************************************\n");
+
+    if ((lat = malloc(sizeof(bench_lat_stats_t))) == NULL ||
+        (p_tCxt->buffer = qapi_Net_Buf_Alloc(CFG_PACKET_SIZE_MAX_RX, QAPI_NETBUF_APP)) == NULL)
+    {
+        QCLI_Printf(qcli_net_handle, "Out of memory error\n");
+        goto ERROR_1;
+    }
+
+    bench_common_lat_init(lat);
+    ticks_per_sec = qurt_timer_convert_time_to_ticks(1000, QURT_TIME_MSEC);
+
+    if ((p_tCxt->sock_peer = qapi_socket(family, SOCK_DGRAM, 0)) == A_ERROR)
+    {
+        QCLI_Printf(qcli_net_handle, "Socket creation failed\n");
+        goto ERROR_1;
+    }
+
+    if (p_tCxt->params.tx_params.ip_tos > 0)
+    {
+        qapi_setsockopt(p_tCxt->sock_peer, IP_OPTIONS, p_tCxt->params.tx_params.v6 ? IPV6_TCLASS : IP_TOS,
+                        &p_tCxt->params.tx_params.ip_tos, sizeof(uint8_t));
+    }
+
+    if (qapi_connect(p_tCxt->sock_peer, to, tolen) == A_ERROR)
+    {
+        QCLI_Printf(qcli_net_handle, "Connection failed\n");
+        goto ERROR_2;
+    }
+
+    memset(p_tCxt->buffer, 0, packet_size);
+    bench_common_add_pattern(p_tCxt->buffer + sizeof(UDP_LATENCY_HEADER), packet_size - sizeof(UDP_LATENCY_HEADER));
+    hdr.pattern.code = CODE_UDP;
+
+    QCLI_Printf(qcli_net_handle, "Sending\n");
+    app_get_time(&p_tCxt->pktStats.first_time);
+
+    while (!benchtx_quit)
+    {
+        /* The buffer also receives the echoes; only the header changes */
+        hdr.pattern.seq = (unsigned short)(seq & IEEE80211_SN_MASK);
+        hdr.seq = htonl(seq);
+        hdr.tx_ticks = (uint32_t)qurt_timer_get_ticks();
+        memcpy(p_tCxt->buffer, &hdr, sizeof(hdr));
+
+        send_bytes = qapi_send(p_tCxt->sock_peer, p_tCxt->buffer, packet_size, 0);
+        if (send_bytes != packet_size)
+        {
+            QCLI_Printf(qcli_net_handle, "\nError: send_bytes=%d, errno=%d\n", send_bytes, qapi_errno(p_tCxt->sock_peer));
+            break;
+        }
+
+        p_tCxt->pktStats.bytes += send_bytes;
+        lat->sent++;
+
+        result = bench_udp_lat_wait_response(p_tCxt, lat, seq, ticks_per_sec);
+        if (result < 0)
+        {
+            QCLI_Printf(qcli_net_handle, "\nError: receive failed\n");
+            break;
+        }
+        if (result == 0 && !benchtx_quit)
+            lat->timeouts++;
+
+        seq++;
+
+        if ((seq % BENCH_UDP_PKTS_PER_DOT) == 0)
+            QCLI_Printf(qcli_net_handle, ".");
+
+        app_get_time(&p_tCxt->pktStats.last_time);
+        if (p_tCxt->params.tx_params.test_mode == PACKET_TEST)
+        {
+            if (seq >= (uint32_t)p_tCxt->params.tx_params.packet_number)
+                break;
+        }
+        else if (bench_common_check_test_time(p_tCxt))
+        {
+            break;
+        }
+
+        if (p_tCxt->params.tx_params.interval_us)
+            qapi_Task_Delay(p_tCxt->params.tx_params.interval_us);
+    }
+
+    app_get_time(&p_tCxt->pktStats.last_time);
+
+    /* Send endmark packet so the peer ends its test, and wait for its Ack */
+    if (bench_common_wait_for_response(p_tCxt, to, tolen, seq) != QAPI_OK)
+    {
+        QCLI_Printf(qcli_net_handle, "UDP Latency test: did not receive Ack from Peer\n");
+    }
+
+    bench_common_print_test_results(p_tCxt, &p_tCxt->pktStats);
+    bench_common_lat_print(lat);
+
+ERROR_2:
+    qapi_socketclose(p_tCxt->sock_peer);
+
+ERROR_1:
+    if (p_tCxt->buffer)
+    {
+        qapi_Net_Buf_Free(p_tCxt->buffer, QAPI_NETBUF_APP);
+        p_tCxt->buffer = NULL;
+    }
+
+    if (lat)
+        free(lat);
+
+    QCLI_Printf(qcli_net_handle, BENCH_TEST_COMPLETED);
+}
 #endif
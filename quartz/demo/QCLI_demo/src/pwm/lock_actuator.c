@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "qapi_types.h"
+#include "qapi_status.h"
+#include "qapi_pwm.h"
+#include "qurt_error.h"
+#include "qurt_mutex.h"
+#include "qurt_signal.h"
+#include "qurt_thread.h"
+#include "qurt_timer.h"
+
+#include "lock_actuator.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   PWM channel the servo is connected to.
+*/
+#define LOCK_ACTUATOR_PWM_CHANNEL                                       (QAPI_PWM_CHANNEL_1_E)
+
+/**
+   PWM frequency and phase used to drive the servo.
+*/
+#define LOCK_ACTUATOR_PWM_FREQUENCY                                     (5000)
+#define LOCK_ACTUATOR_PWM_PHASE                                         (2000)
+
+/**
+   PWM duty cycles for the open and closed servo positions.
+*/
+#define LOCK_ACTUATOR_OPEN_DUTY                                         (500)
+#define LOCK_ACTUATOR_CLOSE_DUTY                                        (750)
+
+/**
+   Time (in milliseconds) that the servo is driven after a command before
+   the PWM output is disabled again.
+*/
+#define LOCK_ACTUATOR_HOLD_TIME_MS                                      (1000)
+
+/**
+   Number of commands that can be waiting for the worker thread.
+*/
+#define LOCK_ACTUATOR_QUEUE_DEPTH                                       (4)
+
+#define LOCK_ACTUATOR_THREAD_PRIORITY                                   (20)
+#define LOCK_ACTUATOR_THREAD_STACK_SIZE                                 (1024)
+
+#define LOCK_ACTUATOR_COMMAND_QUEUED_EVENT_MASK                         0x00000001
+
+#define TAKE_LOCK(__lock__)                                             ((qurt_mutex_lock_timed(&(__lock__), QURT_TIME_WAIT_FOREVER)) == QURT_EOK)
+#define RELEASE_LOCK(__lock__)                                          do { qurt_mutex_unlock(&(__lock__)); } while(0)
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   This structure contains the context information for the lock actuator.
+*/
+typedef struct Lock_Actuator_Context_s
+{
+   qbool_t                    Initialized;                             /**< Indicates the worker thread has been started.     */
+   qurt_mutex_t               Mutex;                                   /**< Protects the command queue and counters.          */
+   qurt_signal_t              Event;                                   /**< Signals the worker that a command was queued.     */
+   qapi_PWM_Handle_t          Handle[1];                               /**< PWM channel handle, kept open by the worker.      */
+   Lock_Actuator_Command_t    Queue[LOCK_ACTUATOR_QUEUE_DEPTH];        /**< Ring of commands waiting for the worker.          */
+   uint32_t                   Queue_Head;                              /**< Index of the oldest queued command.               */
+   uint32_t                   Queue_Count;                             /**< Number of queued commands.                        */
+   Lock_Actuator_Statistics_t Statistics;                              /**< Counters reported by Lock_Actuator_Get_Statistics. */
+} Lock_Actuator_Context_t;
+
+static Lock_Actuator_Context_t Lock_Actuator_Context;
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function removes the oldest command from the queue.
+
+   @param Command is where the dequeued command will be stored.
+
+   @return
+    - true if a command was dequeued.
+    - false if the queue was empty.
+*/
+static qbool_t Dequeue_Command(Lock_Actuator_Command_t *Command)
+{
+   qbool_t Ret_Val = false;
+
+   if(TAKE_LOCK(Lock_Actuator_Context.Mutex))
+   {
+      if(Lock_Actuator_Context.Queue_Count != 0)
+      {
+         *Command = Lock_Actuator_Context.Queue[Lock_Actuator_Context.Queue_Head];
+
+         Lock_Actuator_Context.Queue_Head = (Lock_Actuator_Context.Queue_Head + 1) % LOCK_ACTUATOR_QUEUE_DEPTH;
+         Lock_Actuator_Context.Queue_Count --;
+
+         Ret_Val = true;
+      }
+
+      RELEASE_LOCK(Lock_Actuator_Context.Mutex);
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function checks whether any commands are waiting.
+
+   @return
+    - true if at least one command is queued.
+    - false if the queue is empty.
+*/
+static qbool_t Command_Pending(void)
+{
+   qbool_t Ret_Val = false;
+
+   if(TAKE_LOCK(Lock_Actuator_Context.Mutex))
+   {
+      Ret_Val = (qbool_t)(Lock_Actuator_Context.Queue_Count != 0);
+
+      RELEASE_LOCK(Lock_Actuator_Context.Mutex);
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function programs and enables the PWM channel for a command.
+
+   @param Command is the command to apply.
+
+   @return
+    - true if the PWM output was enabled.
+    - false if a PWM driver call failed.
+*/
+static qbool_t Apply_Command(Lock_Actuator_Command_t Command)
+{
+   qapi_PWM_Config_t Config;
+
+   Config.freq       = LOCK_ACTUATOR_PWM_FREQUENCY;
+   Config.duty       = (Command == LOCK_ACTUATOR_COMMAND_OPEN_E) ? LOCK_ACTUATOR_OPEN_DUTY : LOCK_ACTUATOR_CLOSE_DUTY;
+   Config.phase      = LOCK_ACTUATOR_PWM_PHASE;
+   Config.moduleType = 0;
+   Config.source_CLK = QAPI_PWM_SOURCE_CLK_NORMAL_MODE_E;
+
+   /* The channel must be disabled while its configuration is changed. */
+   qapi_PWM_Enable(Lock_Actuator_Context.Handle, 1, 0);
+
+   if(qapi_PWM_Channel_Set(Lock_Actuator_Context.Handle[0], &Config) != QAPI_OK)
+      return(false);
+
+   return(qapi_PWM_Enable(Lock_Actuator_Context.Handle, 1, 1) == QAPI_OK);
+}
+
+/**
+   @brief This function holds the servo position for the hold time, giving
+          way to a newer command.
+
+   The queued event bit may still be set by a command that was dequeued
+   before the hold started, so a wake-up only ends the hold if the queue
+   actually holds a command. Otherwise the wait resumes for the rest of the
+   hold time.
+
+   @param Hold_Ticks is the hold time in ticks.
+
+   @return
+    - true if a newer command is waiting.
+    - false if the hold time elapsed.
+*/
+static qbool_t Hold_Position(qurt_time_t Hold_Ticks)
+{
+   qurt_time_t Start_Ticks;
+   qurt_time_t Elapsed_Ticks;
+   uint32      Signal_Waiting;
+
+   Start_Ticks = qurt_timer_get_ticks();
+
+   while(!Command_Pending())
+   {
+      Elapsed_Ticks = qurt_timer_get_ticks() - Start_Ticks;
+      if(Elapsed_Ticks >= Hold_Ticks)
+         return(false);
+
+      if(qurt_signal_wait_timed(&Lock_Actuator_Context.Event, LOCK_ACTUATOR_COMMAND_QUEUED_EVENT_MASK, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK, &Signal_Waiting, Hold_Ticks - Elapsed_Ticks) != QURT_EOK)
+         return(Command_Pending());
+   }
+
+   return(true);
+}
+
+/**
+   @brief This function is the entry point for the lock actuator thread.
+
+   The thread owns the PWM channel. Each command drives the servo for
+   LOCK_ACTUATOR_HOLD_TIME_MS, after which the output is disabled. A newer
+   command arriving during the hold period is applied immediately.
+
+   @param Thread_Parameter is unused.
+*/
+static void Lock_Actuator_Thread(void *Thread_Parameter)
+{
+   Lock_Actuator_Command_t Command;
+   qurt_time_t             Hold_Ticks;
+   qbool_t                 Output_Enabled;
+   qbool_t                 Result;
+
+   Hold_Ticks = qurt_timer_convert_time_to_ticks(LOCK_ACTUATOR_HOLD_TIME_MS, QURT_TIME_MSEC);
+
+   Output_Enabled = false;
+
+   while(true)
+   {
+      if(!Dequeue_Command(&Command))
+      {
+         /* Never leave the servo driven while waiting for a command. */
+         if(Output_Enabled)
+         {
+            qapi_PWM_Enable(Lock_Actuator_Context.Handle, 1, 0);
+            Output_Enabled = false;
+         }
+
+         qurt_signal_wait(&Lock_Actuator_Context.Event, LOCK_ACTUATOR_COMMAND_QUEUED_EVENT_MASK, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+         continue;
+      }
+
+      /* Open the channel on first use and keep it open afterwards. */
+      if(Lock_Actuator_Context.Handle[0] == NULL)
+      {
+         if(qapi_PWM_Channel_Open(LOCK_ACTUATOR_PWM_CHANNEL, &(Lock_Actuator_Context.Handle[0])) != QAPI_OK)
+            Lock_Actuator_Context.Handle[0] = NULL;
+      }
+
+      /* A failed apply may still leave the channel enabled. */
+      Output_Enabled = (Lock_Actuator_Context.Handle[0] != NULL);
+      Result         = (Output_Enabled) ? Apply_Command(Command) : false;
+
+      if(TAKE_LOCK(Lock_Actuator_Context.Mutex))
+      {
+         if(Result)
+            Lock_Actuator_Context.Statistics.Executed ++;
+         else
+            Lock_Actuator_Context.Statistics.PWM_Errors ++;
+
+         RELEASE_LOCK(Lock_Actuator_Context.Mutex);
+      }
+
+      if(!Result)
+         continue;
+
+      /* Hold the position, but give way to a newer command. */
+      if(Hold_Position(Hold_Ticks))
+      {
+         if(TAKE_LOCK(Lock_Actuator_Context.Mutex))
+         {
+            Lock_Actuator_Context.Statistics.Preempted ++;
+
+            RELEASE_LOCK(Lock_Actuator_Context.Mutex);
+         }
+      }
+      else
+      {
+         qapi_PWM_Enable(Lock_Actuator_Context.Handle, 1, 0);
+         Output_Enabled = false;
+      }
+   }
+}
+
+qbool_t Lock_Actuator_Initialize(void)
+{
+   qurt_thread_attr_t Thread_Attribute;
+   qurt_thread_t      Thread_Handle;
+
+   if(Lock_Actuator_Context.Initialized)
+      return(true);
+
+   memset(&Lock_Actuator_Context, 0, sizeof(Lock_Actuator_Context));
+
+   qurt_mutex_create(&Lock_Actuator_Context.Mutex);
+
+   if(qurt_signal_create(&Lock_Actuator_Context.Event) != QURT_EOK)
+   {
+      qurt_mutex_delete(&Lock_Actuator_Context.Mutex);
+
+      return(false);
+   }
+
+   qurt_thread_attr_init(&Thread_Attribute);
+   qurt_thread_attr_set_name(&Thread_Attribute, "Lock Actuator");
+   qurt_thread_attr_set_priority(&Thread_Attribute, LOCK_ACTUATOR_THREAD_PRIORITY);
+   qurt_thread_attr_set_stack_size(&Thread_Attribute, LOCK_ACTUATOR_THREAD_STACK_SIZE);
+
+   if(qurt_thread_create(&Thread_Handle, &Thread_Attribute, Lock_Actuator_Thread, NULL) != QURT_EOK)
+   {
+      qurt_signal_delete(&Lock_Actuator_Context.Event);
+      qurt_mutex_delete(&Lock_Actuator_Context.Mutex);
+
+      return(false);
+   }
+
+   Lock_Actuator_Context.Initialized = true;
+
+   return(true);
+}
+
+qbool_t Lock_Actuator_Submit(Lock_Actuator_Command_t Command)
+{
+   uint32_t Tail;
+   qbool_t  Command_Merged = false;
+
+   if(!Lock_Actuator_Context.Initialized)
+      return(false);
+
+   if(!TAKE_LOCK(Lock_Actuator_Context.Mutex))
+      return(false);
+
+   Lock_Actuator_Context.Statistics.Submitted ++;
+
+   if(Lock_Actuator_Context.Queue_Count != 0)
+   {
+      Tail = (Lock_Actuator_Context.Queue_Head + Lock_Actuator_Context.Queue_Count - 1) % LOCK_ACTUATOR_QUEUE_DEPTH;
+
+      /* Only the latest requested position matters, so merge with the   */
+      /* newest queued command if it is identical or the queue is full.   */
+      if((Lock_Actuator_Context.Queue[Tail] == Command) || (Lock_Actuator_Context.Queue_Count == LOCK_ACTUATOR_QUEUE_DEPTH))
+      {
+         Lock_Actuator_Context.Queue[Tail] = Command;
+         Lock_Actuator_Context.Statistics.Coalesced ++;
+
+         Command_Merged = true;
+      }
+   }
+
+   if(!Command_Merged)
+   {
+      Tail = (Lock_Actuator_Context.Queue_Head + Lock_Actuator_Context.Queue_Count) % LOCK_ACTUATOR_QUEUE_DEPTH;
+
+      Lock_Actuator_Context.Queue[Tail] = Command;
+      Lock_Actuator_Context.Queue_Count ++;
+   }
+
+   RELEASE_LOCK(Lock_Actuator_Context.Mutex);
+
+   qurt_signal_set(&Lock_Actuator_Context.Event, LOCK_ACTUATOR_COMMAND_QUEUED_EVENT_MASK);
+
+   return(true);
+}
+
+void Lock_Actuator_Get_Statistics(Lock_Actuator_Statistics_t *Statistics)
+{
+   if(Statistics == NULL)
+      return;
+
+   if(TAKE_LOCK(Lock_Actuator_Context.Mutex))
+   {
+      *Statistics = Lock_Actuator_Context.Statistics;
+
+      RELEASE_LOCK(Lock_Actuator_Context.Mutex);
+   }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#ifndef __LOCK_ACTUATOR_H__
+#define __LOCK_ACTUATOR_H__
+
+#include <stdint.h>
+#include "qapi_types.h"
+
+/**
+   Commands that can be submitted to the lock actuator.
+*/
+typedef enum
+{
+   LOCK_ACTUATOR_COMMAND_OPEN_E,  /**< Drive the servo to the open position.   */
+   LOCK_ACTUATOR_COMMAND_CLOSE_E  /**< Drive the servo to the closed position. */
+} Lock_Actuator_Command_t;
+
+/**
+   Counters maintained by the lock actuator.
+*/
+typedef struct Lock_Actuator_Statistics_s
+{
+   uint32_t Submitted;   /**< Number of commands accepted by Lock_Actuator_Submit().          */
+   uint32_t Coalesced;   /**< Number of commands merged into an already queued command.       */
+   uint32_t Executed;    /**< Number of commands applied to the PWM channel.                  */
+   uint32_t Preempted;   /**< Number of hold periods cut short by a newer command.            */
+   uint32_t PWM_Errors;  /**< Number of failed qapi_PWM_* calls made by the worker thread.    */
+} Lock_Actuator_Statistics_t;
+
+/**
+   @brief This function starts the lock actuator worker thread.
+
+   The PWM channel is opened once by the worker and kept open for the
+   lifetime of the actuator. Calling this function more than once has no
+   effect.
+
+   @return
+    - true if the actuator is running.
+    - false if the thread or its resources could not be created.
+*/
+qbool_t Lock_Actuator_Initialize(void);
+
+/**
+   @brief This function queues a command for the lock actuator.
+
+   The function never blocks on the PWM driver and is safe to call from
+   stack callbacks. If the queue is full the newest queued command is
+   replaced, since only the most recent position request matters for the
+   servo.
+
+   @param Command is the command to queue.
+
+   @return
+    - true if the command was queued.
+    - false if the actuator has not been initialized.
+*/
+qbool_t Lock_Actuator_Submit(Lock_Actuator_Command_t Command);
+
+/**
+   @brief This function retrieves a snapshot of the actuator counters.
+
+   @param Statistics is where the counters will be copied.
+*/
+void Lock_Actuator_Get_Statistics(Lock_Actuator_Statistics_t *Statistics);
+
+#endif
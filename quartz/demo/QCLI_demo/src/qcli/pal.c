@@ -561,6 +561,13 @@ void app_start(qbool_t ColdBoot)
          PAL_CONSOLE_WRITE_STRING_LITERAL(PAL_OUTPUT_END_OF_LINE_STRING);
          PAL_CONSOLE_WRITE_STRING_LITERAL(PAL_OUTPUT_END_OF_LINE_STRING);
       }
+
+      /* Start the console logger and the command worker threads. */
+      if(!QCLI_Start())
+      {
+         PAL_CONSOLE_WRITE_STRING_LITERAL("Failed to start QCLI threads.");
+         PAL_CONSOLE_WRITE_STRING_LITERAL(PAL_OUTPUT_END_OF_LINE_STRING);
+      }
    }
 }
 
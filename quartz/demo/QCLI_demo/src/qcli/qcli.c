@@ -29,6 +29,7 @@
 #include "qcli.h"
 #include "qcli_api.h"
 #include "qcli_util.h"
+#include "qcli_log.h"
 
 /*-------------------------------------------------------------------------
  * Preprocessor Definitions and Constants
@@ -55,14 +56,33 @@
 #define MAXIMUM_PRINTF_LENGTH                                           (256)
 
 /**
-   This definition determines the maximum number of command threads that
-   the QCLI allows to be running at a time.
+   This definition determines the number of buckets in the hash table used
+   to look up commands and groups by name. It must be a power of two.
+*/
+#define COMMAND_INDEX_BUCKET_COUNT                                      (128)
+
+/**
+   This definition determines how long (in milliseconds) the QCLI waits for
+   queued console output to be written before freeing a group or exiting.
+*/
+#define QCLI_LOG_FLUSH_TIMEOUT_MS                                       (500)
+
+/**
+   This definition determines the number of worker threads in the command
+   pool, i.e. the maximum number of threaded commands that can be running
+   at a time.
 */
 #define MAXIMUM_THREAD_COUNT                                            (5)
 
+/**
+   This definition determines the number of threaded commands that can be
+   waiting for a free worker thread.
+*/
+#define COMMAND_QUEUE_DEPTH                                             (8)
+
 /**
    This definition determines the size of the stack (in bytes) that is used
-   for command threads.
+   for command worker threads.
 */
 #define THREAD_STACK_SIZE                                               (3072)
 
@@ -88,7 +108,7 @@
 /**
 for high throughput ensure that this runs at the same priority as netmain and wlan driver
 */
-#define THREAD_READY_EVENT_MASK                                         0x00000001
+#define COMMAND_QUEUED_EVENT_MASK                                       0x00000001
 
 /**
 */
@@ -101,6 +121,26 @@ for high throughput ensure that this runs at the same priority as netmain and wl
  * Type Declarations
  *-----------------------------------------------------------------------*/
 
+/**
+   This structure represents an entry in the command name index. Each
+   registered command and group has one entry, keyed by the group it is
+   found in and its case-folded name.
+*/
+typedef struct Command_Index_Entry_s
+{
+   struct Command_Index_Entry_s *Next_Index_Entry; /**< The next entry in the hash bucket. */
+   const struct Group_List_Entry_s *Owner_Group;   /**< The group the name is searched in. */
+   uint32_t                      Hash;             /**< The hash of the owner and case-folded name. */
+   const char                   *Name;             /**< The name of the command or group. */
+   qbool_t                       Is_Group;         /**< A flag indicating if the entry is a command or a group. */
+   uint32_t                      Order;            /**< Command list index or group registration order, used to resolve duplicate names. */
+   union
+   {
+      const QCLI_Command_t      *Command;          /**< The command if the entry is a command. */
+      struct Group_List_Entry_s *Group_List_Entry; /**< The group if the entry is a group. */
+   } Data;
+} Command_Index_Entry_t;
+
 /**
    This structure represents a command group list entry.
 */
@@ -110,6 +150,8 @@ typedef struct Group_List_Entry_s
    struct Group_List_Entry_s  *Parent_Group;          /**< the parent group for this subgroup. */
    struct Group_List_Entry_s  *Subgroup_List;         /**< The list of subgroups registerd for this group. */
    struct Group_List_Entry_s  *Next_Group_List_Entry; /**< The next entry in the list. */
+   Command_Index_Entry_t       Group_Index_Entry;     /**< The index entry for this group in its parent. */
+   Command_Index_Entry_t      *Command_Index_List;    /**< The index entries for the group's commands. */
 } Group_List_Entry_t;
 
 /**
@@ -126,17 +168,18 @@ typedef struct Find_Result_s
 } Find_Result_t;
 
 /**
-   This structure contains the information needed for starting a command
-   thread.
+   This structure contains the information needed by a worker thread to
+   execute a threaded command. The parameter strings point into the
+   structure's own copy of the input string.
 */
-typedef struct Thread_Info_s
+typedef struct Command_Work_Item_s
 {
-   qurt_signal_t         Thread_Ready_Event; /**< Event which indicates the thread no longer needs this information structure. */
-   uint32_t              Command_Index;      /**< The index of the command that will be executed. */
-   const QCLI_Command_t *Command;            /**< The command that will be executed. */
-   uint32_t              Parameter_Count;    /**< The number of parameters specified for the command. */
-   QCLI_Parameter_t     *Parameter_List;     /**< The list of paramters for the command. */
-} Thread_Info_t;
+   uint32_t              Command_Index;                                        /**< The index of the command that will be executed. */
+   const QCLI_Command_t *Command;                                              /**< The command that will be executed. */
+   uint32_t              Parameter_Count;                                      /**< The number of parameters specified for the command. */
+   QCLI_Parameter_t      Parameter_List[MAXIMUM_NUMBER_OF_PARAMETERS];         /**< The list of paramters for the command. */
+   char                  Input_String[MAXIMUM_QCLI_COMMAND_STRING_LENGTH + 1]; /**< Copy of the input string the parameters refer to. */
+} Command_Work_Item_t;
 
 /**
    This structure contains the context information for the QCLI module.
@@ -146,22 +189,43 @@ typedef struct QCLI_Context_s
    Group_List_Entry_t  Root_Group;                                           /**< The root of the group menu structure.                                    */
    Group_List_Entry_t *Current_Group;                                        /**< The current group.                                                       */
    Group_List_Entry_t *Executing_Group;                                      /**< Group of currently executing command. */
+   Command_Index_Entry_t *Command_Index[COMMAND_INDEX_BUCKET_COUNT];         /**< Hash table of registered command and group names.                        */
+   uint32_t            Group_Registration_Count;                             /**< Incremented for each registered group to order subgroups in the index.   */
 
    uint32_t            Input_Length;                                         /**< The length of the current console input string.                          */
    char                Input_String[MAXIMUM_QCLI_COMMAND_STRING_LENGTH + 1]; /**< Buffer containing the current console input string.                      */
    QCLI_Parameter_t    Parameter_List[MAXIMUM_NUMBER_OF_PARAMETERS + 1];     /**< List of parameters for input command.                                    */
 
-   uint32_t            Thread_Count;                                         /**< THe number of command threads that are currently running.                */
-   Thread_Info_t       Thread_Info;                                          /**< Information structure for passing information to command threads.        */
+   uint32_t            Thread_Count;                                         /**< THe number of worker threads that are currently running a command.       */
+   qbool_t             Workers_Started;                                      /**< Indicates the command worker threads have been created.                  */
+   qurt_mutex_t        Work_Mutex;                                           /**< The Mutex used to protect the command queue.                             */
+   qurt_signal_t       Work_Event;                                           /**< Signals the worker threads that a command was queued.                    */
+   uint32_t            Work_Queue_Head;                                      /**< Index of the oldest queued command.                                      */
+   uint32_t            Work_Queue_Count;                                     /**< The number of queued commands.                                           */
+   Command_Work_Item_t Work_Queue[COMMAND_QUEUE_DEPTH];                      /**< Threaded commands waiting for a worker thread.                           */
    qurt_mutex_t        CLI_Mutex;                                            /**< The Mutex used to protect shared resources of the module.                */
 
    char                Printf_Buffer[MAXIMUM_PRINTF_LENGTH];                 /**< The buffer used for formatted output strings.                            */
-   QCLI_Group_Handle_t Current_Printf_Group;                                 /**< The group handle that was last passed to QCLI_Printf().                  */
-   qbool_t             Printf_New_Line;                                      /**< Indicates that a newline should be displayed if a printf changes groups. */
 } QCLI_Context_t;
 
 QCLI_Context_t QCLI_Context;
 
+/**
+   This structure contains the state of the console output. It is only
+   used by Output_Message(), which runs on the logger's drain thread once
+   the logger is running and with CLI_Mutex held before that. The logger
+   is started with CLI_Mutex held, so the two never overlap and the state
+   needs no lock of its own. The drain thread must not take CLI_Mutex as
+   threads holding it wait for queued output to drain.
+*/
+typedef struct Output_Context_s
+{
+   QCLI_Group_Handle_t Current_Printf_Group;                                 /**< The group handle that was last passed to QCLI_Printf().                  */
+   qbool_t             Printf_New_Line;                                      /**< Indicates that a newline should be displayed if a printf changes groups. */
+} Output_Context_t;
+
+static Output_Context_t Output_Context;
+
 /*-------------------------------------------------------------------------
  * Function Declarations
  *-----------------------------------------------------------------------*/
@@ -173,11 +237,16 @@ static QCLI_Command_Status_t Command_Up(uint32_t Parameter_Count, QCLI_Parameter
 static QCLI_Command_Status_t Command_Root(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 
 static void Display_Group_Name(const Group_List_Entry_t *Group_List_Entry);
+static void Write_Group_Name(const Group_List_Entry_t *Group_List_Entry);
+static void Output_Message(QCLI_Group_Handle_t Group_Handle, uint32_t Length, const char *Buffer);
+static void Console_Write(uint32_t Length, const char *Buffer);
 static uint32_t Display_Help(Group_List_Entry_t *Command_Group, uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 static void Display_Usage(uint32_t Command_Index, const QCLI_Command_t *Command);
 static void Display_Command_List(const Group_List_Entry_t *Group_List_Entry);
 
+static void Copy_Work_Item(Command_Work_Item_t *Work_Item, uint32_t Command_Index, const QCLI_Command_t *Command, uint32_t Parameter_Count, const QCLI_Parameter_t *Parameter_List, const char *Input_String);
 static void Command_Thread(void *Thread_Parameter);
+static qbool_t Start_Command_Workers(void);
 
 static void Execute_Command(uint32_t Command_Index, const QCLI_Command_t *Command, uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter_t *Command_Parameter, Find_Result_t *Find_Result);
@@ -185,11 +254,17 @@ void Process_Command(void);
 void clear_buffer();
 static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry);
 
+static uint32_t Command_Index_Hash(const Group_List_Entry_t *Owner_Group, const char *Name);
+static void Command_Index_Add(Command_Index_Entry_t *Index_Entry);
+static void Command_Index_Remove(Command_Index_Entry_t *Index_Entry);
+static qbool_t Index_Command_Group(Group_List_Entry_t *Group_List_Entry);
+static const Command_Index_Entry_t *Command_Index_Find(const Group_List_Entry_t *Owner_Group, const char *Name, uint32_t String_Length);
+
 /* The following represents the list of global commands that are supported when
    not in a group. */
 const QCLI_Command_t Root_Command_List[] =
 {
-   {Command_Ver,  false, "Ver",  "",                     "Display Build Info"},
+   {Command_Ver,  false, "Ver",  "",                     "Display Build Info and logger statistics"},
    {Command_Help, false, "Help", "[Command (optional)]", "Display Command list or usage for a command"},
    {Command_Exit, false, "Exit", "[Restart (1=Yes)]",    "Exits the application."}
 };
@@ -200,7 +275,7 @@ const QCLI_Command_t Root_Command_List[] =
    in a group. */
 const QCLI_Command_t Common_Command_List[] =
 {
-   {Command_Ver,  false, "Ver",  "",                     "Display Build Info"},
+   {Command_Ver,  false, "Ver",  "",                     "Display Build Info and logger statistics"},
    {Command_Help, false, "Help", "[Command (optional)]", "Display Command list or usage for a command"},
    {Command_Up,   false, "Up",   "",                     "Exit command group (move to parent group)"},
    {Command_Root, false, "Root", "",                     "Move to top-level group list"}
@@ -214,12 +289,14 @@ uint16_t G_Cmd_Task_Prio   =   COMMAND_THREAD_PRIORITY;
  * Function Definitions
  *-----------------------------------------------------------------------*/
 /**
-   @brief This function is responsible for displaying build info.
+   @brief This function is responsible for displaying build info and the
+          output logger counters.
 */
 static QCLI_Command_Status_t Command_Ver(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
 {
    QCLI_Command_Status_t Ret_Val;
    qapi_FW_Info_t  info;
+   QCLI_Log_Statistics_t Log_Statistics;
 
    if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
    {
@@ -231,6 +308,15 @@ static QCLI_Command_Status_t Command_Ver(uint32_t Parameter_Count, QCLI_Paramete
                          (info.qapi_Version_Number&__QAPI_VERSION_NIT_MASK)>>__QAPI_VERSION_NIT_SHIFT  );
          QCLI_Printf(MAIN_PRINTF_HANDLE, "CRM  Num: %d\n", info.crm_Build_Number);
 
+         if(QCLI_Log_Is_Running())
+         {
+            QCLI_Log_Get_Statistics(&Log_Statistics);
+
+            QCLI_Printf(MAIN_PRINTF_HANDLE, "Log Msgs: %u written, %u truncated\n", Log_Statistics.Messages_Written, Log_Statistics.Messages_Truncated);
+            QCLI_Printf(MAIN_PRINTF_HANDLE, "Log Drop: %u msgs (%u bytes), %u no staging\n", Log_Statistics.Messages_Dropped, Log_Statistics.Bytes_Dropped, Log_Statistics.Staging_Exhausted);
+            QCLI_Printf(MAIN_PRINTF_HANDLE, "Log Peak: %u bytes\n", Log_Statistics.High_Water_Mark);
+         }
+
          Ret_Val = QCLI_STATUS_SUCCESS_E;
       }
       else
@@ -313,6 +399,9 @@ static QCLI_Command_Status_t Command_Exit(uint32_t Parameter_Count, QCLI_Paramet
    {
       if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
       {
+         /* Make sure pending console output is written first. */
+         QCLI_Log_Flush(QCLI_LOG_FLUSH_TIMEOUT_MS);
+
          /* Exit the application. */
          PAL_Exit();
 
@@ -332,6 +421,9 @@ static QCLI_Command_Status_t Command_Exit(uint32_t Parameter_Count, QCLI_Paramet
       {
          if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
          {
+            /* Make sure pending console output is written first. */
+            QCLI_Log_Flush(QCLI_LOG_FLUSH_TIMEOUT_MS);
+
             /* Reset the application. */
             PAL_Reset();
 
@@ -424,6 +516,146 @@ static void Display_Group_Name(const Group_List_Entry_t *Group_List_Entry)
    QCLI_Printf(MAIN_PRINTF_HANDLE, "%s", Group_List_Entry->Command_Group->Group_String);
 }
 
+/**
+   @brief This function writes the group name, recursively writing the
+          name of the groups parents, directly to the console.
+
+   Unlike Display_Group_Name(), this does not go through QCLI_Printf() so
+   it can be used while a message is being written to the console.
+
+   @param Group_List_Entry is the group list whose name should be
+          written.
+*/
+static void Write_Group_Name(const Group_List_Entry_t *Group_List_Entry)
+{
+   /* If the group's parent isn't the root, write the parent first. */
+   if(Group_List_Entry->Parent_Group != &(QCLI_Context.Root_Group))
+   {
+      Write_Group_Name(Group_List_Entry->Parent_Group);
+
+      PAL_Console_Write(1, "\\");
+   }
+
+   /* Write this group's name. */
+   PAL_Console_Write(strlen((char *)(Group_List_Entry->Command_Group->Group_String)), Group_List_Entry->Command_Group->Group_String);
+}
+
+/**
+   @brief This function writes a formatted message to the console.
+
+   Note that this function will also replace newline characters ('\n') with
+   the string specified by PAL_OUTPUT_END_OF_LINE_STRING. It is called by
+   the logger's drain thread, or directly from QCLI_Printf() with the mutex
+   held if the logger isn't running.
+
+   @param Group_Handle is the handle for the group associated with the
+          message, or NULL if the data should be written unmodified.
+   @param Length is the length of the message.
+   @param Buffer is the message to write.
+*/
+static void Output_Message(QCLI_Group_Handle_t Group_Handle, uint32_t Length, const char *Buffer)
+{
+   uint32_t            Index;
+   uint32_t            Next_Print_Index;
+   Group_List_Entry_t *Group_List_Entry;
+
+   if(Group_Handle == NULL)
+   {
+      /* Raw console data such as echoed input. */
+      PAL_Console_Write(Length, Buffer);
+      return;
+   }
+
+   Group_List_Entry = (Group_List_Entry_t *)Group_Handle;
+
+   /* Print the group name first. Note that the main handle indicates the
+      message is from the QCLI itself and as such doesn't print a group
+      name. */
+   if(Group_Handle != Output_Context.Current_Printf_Group)
+   {
+      if(Output_Context.Printf_New_Line)
+      {
+         PAL_Console_Write(sizeof(PAL_OUTPUT_END_OF_LINE_STRING) - 1, PAL_OUTPUT_END_OF_LINE_STRING);
+         Output_Context.Printf_New_Line = false;
+      }
+
+      if((Group_Handle != MAIN_PRINTF_HANDLE) && (Length != 0) && (Buffer[0] != '\n'))
+      {
+         Write_Group_Name(Group_List_Entry);
+         PAL_Console_Write(2, ": ");
+      }
+   }
+
+   Output_Context.Current_Printf_Group = Group_Handle;
+
+   /* Write the buffer to the console, setting EOL characters accordingly. */
+   Next_Print_Index = 0;
+   for(Index = 0; Index < Length; Index ++)
+   {
+      if(Buffer[Index] == '\n')
+      {
+         /* Print out the buffer so far and replace the '\n' with the
+            configured EOL string. */
+         if(Index != Next_Print_Index)
+         {
+            PAL_Console_Write(Index - Next_Print_Index, &(Buffer[Next_Print_Index]));
+         }
+
+         PAL_Console_Write(sizeof(PAL_OUTPUT_END_OF_LINE_STRING) - 1, PAL_OUTPUT_END_OF_LINE_STRING);
+
+         Next_Print_Index = Index + 1;
+
+         if(Length != (Index + 1))
+         {
+            /* Redsiplay the group name at the start of a new line if its
+               not immidiately succeeded by another new line. */
+            if(Buffer[Index + 1] != '\n')
+            {
+               if(Group_List_Entry->Command_Group != NULL)
+               {
+                  PAL_Console_Write(strlen((char *)(Group_List_Entry->Command_Group->Group_String)), Group_List_Entry->Command_Group->Group_String);
+                  PAL_Console_Write(2, ": ");
+               }
+            }
+         }
+         else
+         {
+            /* This printout stopped on the newline so set the current
+               print group to the main group to prompt the next line to
+               redisplay the group name. */
+            Output_Context.Current_Printf_Group = MAIN_PRINTF_HANDLE;
+         }
+
+         Output_Context.Printf_New_Line = false;
+      }
+      else
+      {
+         Output_Context.Printf_New_Line = true;
+      }
+   }
+
+   /* Print the remaining buffer after the last newline. */
+   if(Length != Next_Print_Index)
+   {
+      PAL_Console_Write(Length - Next_Print_Index, &(Buffer[Next_Print_Index]));
+   }
+}
+
+/**
+   @brief This function writes raw data to the console, keeping it in
+          order with messages queued by QCLI_Printf().
+
+   @param Length is the length of the data to be written.
+   @param Buffer is a pointer to the data to be written.
+*/
+static void Console_Write(uint32_t Length, const char *Buffer)
+{
+   if((!QCLI_Log_Is_Running()) || (!QCLI_Log_Write(NULL, Length, Buffer)))
+   {
+      PAL_Console_Write(Length, Buffer);
+   }
+}
+
 /**
    @brief This function will processes the help command, recursively
           decending groups if necessary.
@@ -596,49 +828,94 @@ static void Display_Command_List(const Group_List_Entry_t *Group_List_Entry)
 }
 
 /**
-   @brief This function is a wrapper for commands which start in their own
-          thread.
+   @brief This function fills in a work item for a threaded command.
+
+   The input string is copied into the work item and the parameter string
+   pointers are adjusted to point into that copy.
 
-   @param Thread_Parameter is the parameter specified when the thread was
-          started. It is expected to be a pointer to a Thread_Info_t
-          structure.
+   @param Work_Item is the work item to fill in.
+   @param Command_Index is the index of the command in its group.
+   @param Command is the command to be executed.
+   @param Parameter_Count is the number of parameters for the command.
+   @param Parameter_List is the parameter list for the command.
+   @param Input_String is the input string the parameters point into.
 */
-static void Command_Thread(void *Thread_Parameter)
+static void Copy_Work_Item(Command_Work_Item_t *Work_Item, uint32_t Command_Index, const QCLI_Command_t *Command, uint32_t Parameter_Count, const QCLI_Parameter_t *Parameter_List, const char *Input_String)
 {
-   uint32_t              Index;
-   Thread_Info_t        *Thread_Info;
-   char                  Input_String[MAXIMUM_QCLI_COMMAND_STRING_LENGTH + 1];
-   QCLI_Parameter_t      Parameter_List[MAXIMUM_NUMBER_OF_PARAMETERS];
-   uint32_t              Parameter_Count;
-   uint32_t              Command_Index;
-   const QCLI_Command_t *Command;
+   uint32_t Index;
+
+   if(Parameter_Count > MAXIMUM_NUMBER_OF_PARAMETERS)
+   {
+      Parameter_Count = MAXIMUM_NUMBER_OF_PARAMETERS;
+   }
+
+   Work_Item->Command_Index   = Command_Index;
+   Work_Item->Command         = Command;
+   Work_Item->Parameter_Count = Parameter_Count;
+
+   memscpy(Work_Item->Input_String, sizeof(Work_Item->Input_String), Input_String, sizeof(Work_Item->Input_String));
+   memscpy(Work_Item->Parameter_List, sizeof(Work_Item->Parameter_List), Parameter_List, Parameter_Count * sizeof(QCLI_Parameter_t));
 
+   /* Adjust the pointers in the paramter list for the copied input string. */
+   for(Index = 0; Index < Parameter_Count; Index ++)
+   {
+      Work_Item->Parameter_List[Index].String_Value = Work_Item->Input_String + (Parameter_List[Index].String_Value - Input_String);
+   }
+}
+
+/**
+   @brief This function is the entry point for the command worker threads.
+
+   Each worker takes threaded commands from the command queue and runs
+   them to completion, so no thread is created or destroyed per command.
+
+   @param Thread_Parameter is unused.
+*/
+static void Command_Thread(void *Thread_Parameter)
+{
+   Command_Work_Item_t   Work_Item;
+   qbool_t               Have_Work;
    QCLI_Command_Status_t Result;
 
-   if(Thread_Parameter)
+   while(true)
    {
-      memset(&Parameter_List, 0, sizeof(Parameter_List));
-
-      /* Copy the thread info to local storage. */
-      Thread_Info = (Thread_Info_t*)Thread_Parameter;
-      memscpy(&Input_String, sizeof(Input_String), QCLI_Context.Input_String, sizeof(QCLI_Context.Input_String));
-      memscpy(&Parameter_List, sizeof(Parameter_List), Thread_Info->Parameter_List, Thread_Info->Parameter_Count * sizeof(QCLI_Parameter_t));
-      Parameter_Count = Thread_Info->Parameter_Count;
-      Command         = Thread_Info->Command;
-      Command_Index   = Thread_Info->Command_Index;
-
-      /* Adjust the pointers in the paramter list for the local input string. */
-      for(Index = 0; Index < Thread_Info->Parameter_Count; Index ++)
+      Have_Work = false;
+
+      if(TAKE_LOCK(QCLI_Context.Work_Mutex))
+      {
+         if(QCLI_Context.Work_Queue_Count != 0)
+         {
+            Command_Work_Item_t *Queued_Item = &(QCLI_Context.Work_Queue[QCLI_Context.Work_Queue_Head]);
+
+            Copy_Work_Item(&Work_Item, Queued_Item->Command_Index, Queued_Item->Command, Queued_Item->Parameter_Count, Queued_Item->Parameter_List, Queued_Item->Input_String);
+
+            QCLI_Context.Work_Queue_Head = (QCLI_Context.Work_Queue_Head + 1) % COMMAND_QUEUE_DEPTH;
+            QCLI_Context.Work_Queue_Count --;
+            QCLI_Context.Thread_Count ++;
+
+            /* Wake another idle worker if more commands are waiting. */
+            if(QCLI_Context.Work_Queue_Count != 0)
+            {
+               qurt_signal_set(&(QCLI_Context.Work_Event), COMMAND_QUEUED_EVENT_MASK);
+            }
+
+            Have_Work = true;
+         }
+
+         RELEASE_LOCK(QCLI_Context.Work_Mutex);
+      }
+
+      if(!Have_Work)
       {
-         Parameter_List[Index].String_Value += (Input_String - QCLI_Context.Input_String);
+         qurt_signal_wait(&(QCLI_Context.Work_Event), COMMAND_QUEUED_EVENT_MASK, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+         continue;
       }
 
-      /* Signal that the thread is ready.  The Thread parameter should be
-         considered invalid after this point. */
-      qurt_signal_set(&(Thread_Info->Thread_Ready_Event), THREAD_READY_EVENT_MASK);
+      /* Pick up any change to the command priority. */
+      qurt_thread_set_priority(qurt_thread_get_id(), G_Cmd_Task_Prio);
 
       /* Execute the command. */
-      Result = (*(Command->Command_Function))(Parameter_Count, Parameter_List);
+      Result = (*(Work_Item.Command->Command_Function))(Work_Item.Parameter_Count, Work_Item.Parameter_List);
 
       /* Take the mutex before modifying any global variables. */
       if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
@@ -646,19 +923,58 @@ static void Command_Thread(void *Thread_Parameter)
          if(Result == QCLI_STATUS_USAGE_E)
          {
             /* Print the usage message. */
-            Display_Usage(Command_Index, Command);
+            Display_Usage(Work_Item.Command_Index, Work_Item.Command);
             QCLI_Display_Prompt();
          }
 
-         /* Decrement the number of active threads. */
+         RELEASE_LOCK(QCLI_Context.CLI_Mutex);
+      }
+
+      if(TAKE_LOCK(QCLI_Context.Work_Mutex))
+      {
+         /* Decrement the number of busy workers. */
          QCLI_Context.Thread_Count --;
 
-         RELEASE_LOCK(QCLI_Context.CLI_Mutex);
+         RELEASE_LOCK(QCLI_Context.Work_Mutex);
       }
    }
+}
+
+/**
+   @brief This function creates the command worker threads.
 
-   /* Terminate the thread. */
-   qurt_thread_stop();
+   @return
+    - true if all worker threads were created.
+    - false if a worker thread could not be created.
+*/
+static qbool_t Start_Command_Workers(void)
+{
+   qurt_thread_attr_t Thread_Attribte;
+   qurt_thread_t      Thread_Handle;
+   uint32_t           Index;
+
+   if(!QCLI_Context.Workers_Started)
+   {
+      qurt_thread_attr_init(&Thread_Attribte);
+      qurt_thread_attr_set_name(&Thread_Attribte, "Commad Thread");
+      qurt_thread_attr_set_priority(&Thread_Attribte, G_Cmd_Task_Prio);
+      qurt_thread_attr_set_stack_size(&Thread_Attribte, THREAD_STACK_SIZE);
+
+      for(Index = 0; Index < MAXIMUM_THREAD_COUNT; Index ++)
+      {
+         if(qurt_thread_create(&Thread_Handle, &Thread_Attribte, Command_Thread, NULL) != QURT_EOK)
+         {
+            break;
+         }
+      }
+
+      /* Any workers that were created will serve the queue. */
+      QCLI_Context.Workers_Started = (qbool_t)(Index != 0);
+
+      return((qbool_t)(Index == MAXIMUM_THREAD_COUNT));
+   }
+
+   return(true);
 }
 
 /**
@@ -676,52 +992,42 @@ static void Command_Thread(void *Thread_Parameter)
 static void Execute_Command(uint32_t Command_Index, const QCLI_Command_t *Command, uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
 {
    QCLI_Command_Status_t Result;
-   qurt_thread_attr_t    Thread_Attribte;
-   uint32                Signal_Waiting;
-   qurt_thread_t         Thread_Handle;
-   int                   Thread_Result;
+   qbool_t               Queued;
 
    if(Command->Start_Thread)
    {
-      /* Make sure we haven't maxed out the number of supported threads. */
-      if(QCLI_Context.Thread_Count < MAXIMUM_THREAD_COUNT)
+      Queued = false;
+
+      if(QCLI_Context.Workers_Started)
       {
-         QCLI_Context.Thread_Count ++;
+         if(TAKE_LOCK(QCLI_Context.Work_Mutex))
+         {
+            /* Make sure there is room in the command queue. */
+            if(QCLI_Context.Work_Queue_Count < COMMAND_QUEUE_DEPTH)
+            {
+               /* Pass the command to the worker pool. */
+               Copy_Work_Item(&(QCLI_Context.Work_Queue[(QCLI_Context.Work_Queue_Head + QCLI_Context.Work_Queue_Count) % COMMAND_QUEUE_DEPTH]), Command_Index, Command, Parameter_Count, Parameter_List, QCLI_Context.Input_String);
 
-         /* Make sure the running event semaphore is taken. */
-         qurt_signal_clear(&QCLI_Context.Thread_Info.Thread_Ready_Event, THREAD_READY_EVENT_MASK);
+               QCLI_Context.Work_Queue_Count ++;
 
-         /* Pass the function to the thread pool. */
-         QCLI_Context.Thread_Info.Command         = Command;
-         QCLI_Context.Thread_Info.Command_Index   = Command_Index;
-         QCLI_Context.Thread_Info.Parameter_Count = Parameter_Count;
-         QCLI_Context.Thread_Info.Parameter_List  = Parameter_List;
+               Queued = true;
+            }
 
-         /* Create a thread for the command. */
-         qurt_thread_attr_init(&Thread_Attribte);
-         qurt_thread_attr_set_name(&Thread_Attribte, "Commad Thread");
-         qurt_thread_attr_set_priority(&Thread_Attribte, G_Cmd_Task_Prio);
-         qurt_thread_attr_set_stack_size(&Thread_Attribte, THREAD_STACK_SIZE);
-         Thread_Result = qurt_thread_create(&Thread_Handle, &Thread_Attribte, Command_Thread, (void *)&(QCLI_Context.Thread_Info));
+            RELEASE_LOCK(QCLI_Context.Work_Mutex);
+         }
 
-         if(Thread_Result == QURT_EOK)
+         if(Queued)
          {
-            /* Wait for the thread to take over. */
-            if(qurt_signal_wait_timed(&QCLI_Context.Thread_Info.Thread_Ready_Event, THREAD_READY_EVENT_MASK, QURT_SIGNAL_ATTR_WAIT_ANY, &Signal_Waiting, QURT_TIME_WAIT_FOREVER) != QURT_EOK)
-            {
-               QCLI_Printf(MAIN_PRINTF_HANDLE, "Thread failed to start for command.\n");
-            }
+            qurt_signal_set(&(QCLI_Context.Work_Event), COMMAND_QUEUED_EVENT_MASK);
          }
          else
          {
-            QCLI_Printf(MAIN_PRINTF_HANDLE, "Failed to create thread for command (%d).\n", Thread_Result);
-
-            QCLI_Context.Thread_Count --;
+            QCLI_Printf(MAIN_PRINTF_HANDLE, "Command queue full.\n");
          }
       }
       else
       {
-         QCLI_Printf(MAIN_PRINTF_HANDLE, "Max threads reached.\n");
+         QCLI_Printf(MAIN_PRINTF_HANDLE, "Command workers not started.\n");
       }
    }
    else
@@ -762,9 +1068,10 @@ static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter
    uint32_t              Index;
    uint32_t              Command_Index;
    uint32_t              String_Length;
-   const QCLI_Command_t *Command_List;
-   uint32_t              Command_List_Length;
-   Group_List_Entry_t   *Subgroup_List_Entry;
+   const QCLI_Command_t        *Command_List;
+   uint32_t                     Command_List_Length;
+   Group_List_Entry_t          *Subgroup_List_Entry;
+   const Command_Index_Entry_t *Index_Entry;
 
    /* Get the size of the string. Include the null byte so the comparison
       doesn't match substrings. */
@@ -867,47 +1174,42 @@ static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter
             }
          }
 
-         /* Only search the command group if it isn't NULL. */
-         if((!Ret_Val) && (Group_List_Entry->Command_Group != NULL))
-         {
-            /* If the comamnd wasn't found yet, search the group's command list. */
-            for(Index = 0; (Index < Group_List_Entry->Command_Group->Command_Count) && (!Ret_Val); Index ++)
-            {
-               if(Memcmpi(Command_Parameter->String_Value, Group_List_Entry->Command_Group->Command_List[Index].Command_String, String_Length) == 0)
-               {
-                  /* Command found. */
-                  Ret_Val                           = true;
-                  Find_Result->Is_Group             = false;
-                  Find_Result->Data.Command         = &(Group_List_Entry->Command_Group->Command_List[Index]);
-                  Command_Parameter->Integer_Value  = Command_Index;
-               }
-               else
-               {
-                  Command_Index ++;
-               }
-            }
-         }
-
          if(!Ret_Val)
          {
-            /* If the comamnd wasn't found yet, search the group's subgroup
-               list. */
-            Subgroup_List_Entry = Group_List_Entry->Subgroup_List;
-            while((Subgroup_List_Entry != NULL) && (!Ret_Val))
+            /* If the comamnd wasn't found yet, look it up in the index of
+               the group's commands and subgroups. */
+            Index_Entry = Command_Index_Find(Group_List_Entry, (const char *)(Command_Parameter->String_Value), String_Length);
+            if(Index_Entry != NULL)
             {
-               if(Memcmpi(Command_Parameter->String_Value, Subgroup_List_Entry->Command_Group->Group_String, String_Length) == 0)
+               /* Command found. */
+               Ret_Val               = true;
+               Find_Result->Is_Group = Index_Entry->Is_Group;
+
+               if(Index_Entry->Is_Group)
                {
-                  /* Command found. */
-                  Ret_Val                            = true;
-                  Find_Result->Is_Group              = true;
-                  Find_Result->Data.Group_List_Entry = Subgroup_List_Entry;
-                  Command_Parameter->Integer_Value   = Command_Index;
+                  Find_Result->Data.Group_List_Entry = Index_Entry->Data.Group_List_Entry;
+
+                  if(Group_List_Entry->Command_Group != NULL)
+                  {
+                     Command_Index += Group_List_Entry->Command_Group->Command_Count;
+                  }
+
+                  /* Subgroups are numbered by their position in the list. */
+                  Subgroup_List_Entry = Group_List_Entry->Subgroup_List;
+                  while((Subgroup_List_Entry != NULL) && (Subgroup_List_Entry != Index_Entry->Data.Group_List_Entry))
+                  {
+                     Command_Index ++;
+                     Subgroup_List_Entry = Subgroup_List_Entry->Next_Group_List_Entry;
+                  }
                }
                else
                {
-                  Command_Index ++;
-                  Subgroup_List_Entry = Subgroup_List_Entry->Next_Group_List_Entry;
+                  Find_Result->Data.Command = Index_Entry->Data.Command;
+
+                  Command_Index += Index_Entry->Order;
                }
+
+               Command_Parameter->Integer_Value = Command_Index;
             }
          }
       }
@@ -1095,6 +1397,7 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry)
    qbool_t             Ret_Val;
    Group_List_Entry_t *Current_Entry;
    qbool_t             Group_Is_Valid;
+   uint32_t            Index;
 
    /* First, remove the group from its parent's list. */
    if(Group_List_Entry->Parent_Group->Subgroup_List == Group_List_Entry)
@@ -1137,6 +1440,10 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry)
          {
             Ret_Val = true;
          }
+
+         /* The subgroup removed itself from the list, so continue with the
+            new head of the list. */
+         Current_Entry = Group_List_Entry->Subgroup_List;
       }
 
       /* If this is the current group, move up to its parent. */
@@ -1146,6 +1453,26 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry)
          Ret_Val                    = true;
       }
 
+      /* Messages queued for the group reference it, so the group can't be
+         freed until they have been written. Keep waiting if the console
+         is slow to drain. */
+      while(!QCLI_Log_Flush(QCLI_LOG_FLUSH_TIMEOUT_MS))
+      {
+      }
+
+      /* Remove the group and its commands from the name index. */
+      Command_Index_Remove(&(Group_List_Entry->Group_Index_Entry));
+
+      if(Group_List_Entry->Command_Index_List != NULL)
+      {
+         for(Index = 0; Index < Group_List_Entry->Command_Group->Command_Count; Index ++)
+         {
+            Command_Index_Remove(&(Group_List_Entry->Command_Index_List[Index]));
+         }
+
+         free(Group_List_Entry->Command_Index_List);
+      }
+
       /* Free the resources for the group. */
       free(Group_List_Entry);
    }
@@ -1157,6 +1484,174 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry)
    return(Ret_Val);
 }
 
+/**
+   @brief This function calculates the index hash for a name.
+
+   The name is case-folded the same way as Memcmpi() so that names which
+   compare equal also hash equal.
+
+   @param Owner_Group is the group the name is searched in.
+   @param Name is the name to hash.
+
+   @return The hash of the group and name.
+*/
+static uint32_t Command_Index_Hash(const Group_List_Entry_t *Owner_Group, const char *Name)
+{
+   uint32_t Ret_Val;
+   uint8_t  Byte;
+
+   /* FNV-1a, seeded with the owning group so the same name in different
+      groups lands in different buckets. */
+   Ret_Val = 2166136261UL ^ (uint32_t)(uintptr_t)Owner_Group;
+
+   while(*Name != '\0')
+   {
+      Byte = (uint8_t)*Name;
+
+      if((Byte >= 'a') && (Byte <= 'z'))
+      {
+         Byte = Byte - ('a' - 'A');
+      }
+
+      Ret_Val = (Ret_Val ^ Byte) * 16777619UL;
+      Name ++;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function adds an entry to the command name index.
+
+   @param Index_Entry is the entry to add. Its Owner_Group and Name must
+          be set.
+*/
+static void Command_Index_Add(Command_Index_Entry_t *Index_Entry)
+{
+   uint32_t Bucket;
+
+   Index_Entry->Hash             = Command_Index_Hash(Index_Entry->Owner_Group, Index_Entry->Name);
+   Bucket                        = Index_Entry->Hash & (COMMAND_INDEX_BUCKET_COUNT - 1);
+   Index_Entry->Next_Index_Entry = QCLI_Context.Command_Index[Bucket];
+
+   QCLI_Context.Command_Index[Bucket] = Index_Entry;
+}
+
+/**
+   @brief This function removes an entry from the command name index.
+
+   @param Index_Entry is the entry to remove.
+*/
+static void Command_Index_Remove(Command_Index_Entry_t *Index_Entry)
+{
+   Command_Index_Entry_t **Current_Entry;
+
+   Current_Entry = &(QCLI_Context.Command_Index[Index_Entry->Hash & (COMMAND_INDEX_BUCKET_COUNT - 1)]);
+
+   while((*Current_Entry != NULL) && (*Current_Entry != Index_Entry))
+   {
+      Current_Entry = &((*Current_Entry)->Next_Index_Entry);
+   }
+
+   if(*Current_Entry != NULL)
+   {
+      *Current_Entry = Index_Entry->Next_Index_Entry;
+   }
+}
+
+/**
+   @brief This function adds a newly registered group and its commands to
+          the command name index.
+
+   @param Group_List_Entry is the group to index. Its Command_Group and
+          Parent_Group must be set.
+
+   @return
+    - true if the group was indexed.
+    - false if memory for the index entries could not be allocated.
+*/
+static qbool_t Index_Command_Group(Group_List_Entry_t *Group_List_Entry)
+{
+   uint32_t               Index;
+   Command_Index_Entry_t *Index_Entry;
+
+   Group_List_Entry->Command_Index_List = NULL;
+
+   if((Group_List_Entry->Command_Group != NULL) && (Group_List_Entry->Command_Group->Command_Count != 0))
+   {
+      Group_List_Entry->Command_Index_List = (Command_Index_Entry_t *)malloc(Group_List_Entry->Command_Group->Command_Count * sizeof(Command_Index_Entry_t));
+      if(Group_List_Entry->Command_Index_List == NULL)
+      {
+         return(false);
+      }
+
+      for(Index = 0; Index < Group_List_Entry->Command_Group->Command_Count; Index ++)
+      {
+         Index_Entry               = &(Group_List_Entry->Command_Index_List[Index]);
+         Index_Entry->Owner_Group  = Group_List_Entry;
+         Index_Entry->Name         = Group_List_Entry->Command_Group->Command_List[Index].Command_String;
+         Index_Entry->Is_Group     = false;
+         Index_Entry->Order        = Index;
+         Index_Entry->Data.Command = &(Group_List_Entry->Command_Group->Command_List[Index]);
+
+         Command_Index_Add(Index_Entry);
+      }
+   }
+
+   /* Groups are appended to their parent's list, so the registration count
+      preserves the list order. */
+   Index_Entry                        = &(Group_List_Entry->Group_Index_Entry);
+   Index_Entry->Owner_Group           = Group_List_Entry->Parent_Group;
+   Index_Entry->Name                  = (Group_List_Entry->Command_Group != NULL) ? Group_List_Entry->Command_Group->Group_String : "";
+   Index_Entry->Is_Group              = true;
+   Index_Entry->Order                 = QCLI_Context.Group_Registration_Count ++;
+   Index_Entry->Data.Group_List_Entry = Group_List_Entry;
+
+   Command_Index_Add(Index_Entry);
+
+   return(true);
+}
+
+/**
+   @brief This function looks up a command or subgroup name in the command
+          name index.
+
+   If several entries match, the one the linear search would have found
+   first is returned: commands before subgroups, then in list order.
+
+   @param Owner_Group is the group to search.
+   @param Name is the name to search for.
+   @param String_Length is the length of the name including the null
+          byte.
+
+   @return The matching index entry or NULL if no entry matched.
+*/
+static const Command_Index_Entry_t *Command_Index_Find(const Group_List_Entry_t *Owner_Group, const char *Name, uint32_t String_Length)
+{
+   uint32_t                     Hash;
+   const Command_Index_Entry_t *Index_Entry;
+   const Command_Index_Entry_t *Ret_Val;
+
+   Ret_Val     = NULL;
+   Hash        = Command_Index_Hash(Owner_Group, Name);
+   Index_Entry = QCLI_Context.Command_Index[Hash & (COMMAND_INDEX_BUCKET_COUNT - 1)];
+
+   while(Index_Entry != NULL)
+   {
+      if((Index_Entry->Hash == Hash) && (Index_Entry->Owner_Group == Owner_Group) && (Memcmpi(Name, Index_Entry->Name, String_Length) == 0))
+      {
+         if((Ret_Val == NULL) || ((Ret_Val->Is_Group) && (!Index_Entry->Is_Group)) || ((Ret_Val->Is_Group == Index_Entry->Is_Group) && (Index_Entry->Order < Ret_Val->Order)))
+         {
+            Ret_Val = Index_Entry;
+         }
+      }
+
+      Index_Entry = Index_Entry->Next_Index_Entry;
+   }
+
+   return(Ret_Val);
+}
+
 /**
    @brief This function is used to initialize the QCLI module.
 
@@ -1170,17 +1665,58 @@ qbool_t QCLI_Initialize(void)
 {
    /* Initialize the context information. */
    memset(&QCLI_Context, 0, sizeof(QCLI_Context));
+   memset(&Output_Context, 0, sizeof(Output_Context));
    QCLI_Context.Current_Group = &(QCLI_Context.Root_Group);
 
    /* Attempt to create a mutex for the QCLI module. */
    qurt_mutex_init(&(QCLI_Context.CLI_Mutex));
 
-   /* Initialize the thread ready event. */
-   qurt_signal_init(&QCLI_Context.Thread_Info.Thread_Ready_Event);
+   /* Initialize the command queue used by the worker threads. */
+   qurt_mutex_init(&(QCLI_Context.Work_Mutex));
+   qurt_signal_init(&(QCLI_Context.Work_Event));
+
+   /* Initialize the console logger. Output remains synchronous until the
+      platform starts the logger's drain thread. */
+   QCLI_Log_Initialize(Output_Message);
 
    return(true);
 }
 
+/**
+   @brief This function starts the threads used by the QCLI module.
+
+   @return
+    - true if all QCLI threads were started.
+    - false if a thread could not be started.
+*/
+qbool_t QCLI_Start(void)
+{
+   qbool_t Ret_Val;
+
+   /* Start the console logger so QCLI_Printf() no longer blocks on the
+      UART. Output stays synchronous if the logger can't be started. The
+      lock makes sure a synchronous print in progress finishes before the
+      drain thread takes over the output. */
+   if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
+   {
+      Ret_Val = QCLI_Log_Start();
+
+      RELEASE_LOCK(QCLI_Context.CLI_Mutex);
+   }
+   else
+   {
+      Ret_Val = false;
+   }
+
+   /* Create the worker threads used for threaded commands. */
+   if(!Start_Command_Workers())
+   {
+      Ret_Val = false;
+   }
+
+   return(Ret_Val);
+}
+
 void clear_buffer()
 {
    QCLI_Context.Input_Length = 0;
@@ -1218,7 +1754,7 @@ void QCLI_Process_Input_Data(uint32_t Length, char *Buffer)
             {
 #if ECHO_CHARACTERS
 
-               PAL_Console_Write(sizeof(PAL_OUTPUT_END_OF_LINE_STRING), PAL_OUTPUT_END_OF_LINE_STRING);
+               Console_Write(sizeof(PAL_OUTPUT_END_OF_LINE_STRING), PAL_OUTPUT_END_OF_LINE_STRING);
 
 #endif
 
@@ -1242,7 +1778,7 @@ void QCLI_Process_Input_Data(uint32_t Length, char *Buffer)
                   {
 #if ECHO_CHARACTERS
 
-                     PAL_Console_Write(3, "\b \b");
+                     Console_Write(3, "\b \b");
 
 #endif
 
@@ -1261,7 +1797,7 @@ void QCLI_Process_Input_Data(uint32_t Length, char *Buffer)
                      {
 #if ECHO_CHARACTERS
 
-                        PAL_Console_Write(1, Buffer);
+                        Console_Write(1, Buffer);
 
 #endif
 
@@ -1340,6 +1876,16 @@ QCLI_Group_Handle_t QCLI_Register_Command_Group(QCLI_Group_Handle_t Parent_Group
             New_Entry->Parent_Group = (Group_List_Entry_t *)Parent_Group;
          }
 
+         /* Add the group and its commands to the name index. */
+         if(!Index_Command_Group(New_Entry))
+         {
+            free(New_Entry);
+            New_Entry = NULL;
+         }
+      }
+
+      if(New_Entry)
+      {
          /* Add the new entry to its parents subgroup list. */
          if(New_Entry->Parent_Group->Subgroup_List == NULL)
          {
@@ -1417,7 +1963,7 @@ void QCLI_Display_Prompt(void)
       /* Display the current command string. */
       if(QCLI_Context.Input_Length != 0)
       {
-         PAL_Console_Write(QCLI_Context.Input_Length, QCLI_Context.Input_String);
+         Console_Write(QCLI_Context.Input_Length, QCLI_Context.Input_String);
       }
 
       RELEASE_LOCK(QCLI_Context.CLI_Mutex);
@@ -1438,103 +1984,39 @@ void QCLI_Display_Prompt(void)
 */
 void QCLI_Printf(QCLI_Group_Handle_t Group_Handle, const char *Format, ...)
 {
-   uint32_t            Index;
-   uint32_t            Next_Print_Index;
-   uint32_t            Length;
-   va_list             Arg_List;
-   Group_List_Entry_t *Group_List_Entry;
+   uint32_t Length;
+   va_list  Arg_List;
 
    if((Group_Handle != NULL) && (Format != NULL))
    {
-      if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
+      if(QCLI_Log_Is_Running())
       {
-         Group_List_Entry = (Group_List_Entry_t *)Group_Handle;
-
-         /* Print the group name first. Note that the main handle indicates the
-            message is from the QCLI itself and as such doesn't print a group
-            name. */
-         if(Group_Handle != QCLI_Context.Current_Printf_Group)
-         {
-            if(QCLI_Context.Printf_New_Line)
-            {
-               PAL_Console_Write(sizeof(PAL_OUTPUT_END_OF_LINE_STRING) - 1, PAL_OUTPUT_END_OF_LINE_STRING);
-               QCLI_Context.Printf_New_Line = false;
-            }
-
-            if((Group_Handle != MAIN_PRINTF_HANDLE) && (Format[0] != '\n'))
-            {
-               Display_Group_Name(Group_List_Entry);
-               PAL_Console_Write(2, ": ");
-            }
-         }
-
-         QCLI_Context.Current_Printf_Group = Group_Handle;
-
-         /* Print the string to the buffer. */
+         /* Queue the message for the logger's drain thread so the caller
+            never waits on the UART. */
          va_start(Arg_List, Format);
-         Length = vsnprintf((char *)(QCLI_Context.Printf_Buffer), sizeof(QCLI_Context.Printf_Buffer), (char *)Format, Arg_List);
+         QCLI_Log_VPrintf(Group_Handle, Format, Arg_List);
          va_end(Arg_List);
-
-         /* Make sure the length is not greater than the buffer size (taking the
-            NULL terminator into account). */
-         if(Length > sizeof(QCLI_Context.Printf_Buffer) - 1)
-         {
-            Length = sizeof(QCLI_Context.Printf_Buffer) - 1;
-         }
-
-         /* Write the buffer to the console, setting EOL characters accordingly. */
-         Next_Print_Index = 0;
-         for(Index = 0; Index < Length; Index ++)
+      }
+      else
+      {
+         if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
          {
-            if(QCLI_Context.Printf_Buffer[Index] == '\n')
+            /* Print the string to the buffer. */
+            va_start(Arg_List, Format);
+            Length = vsnprintf((char *)(QCLI_Context.Printf_Buffer), sizeof(QCLI_Context.Printf_Buffer), (char *)Format, Arg_List);
+            va_end(Arg_List);
+
+            /* Make sure the length is not greater than the buffer size
+               (taking the NULL terminator into account). */
+            if(Length > sizeof(QCLI_Context.Printf_Buffer) - 1)
             {
-               /* Print out the buffer so far and replace the '\n' with the
-                  configured EOL string. */
-               if(Index != Next_Print_Index)
-               {
-                  PAL_Console_Write(Index - Next_Print_Index, &(QCLI_Context.Printf_Buffer[Next_Print_Index]));
-               }
-
-               PAL_Console_Write(sizeof(PAL_OUTPUT_END_OF_LINE_STRING) - 1, PAL_OUTPUT_END_OF_LINE_STRING);
-
-               Next_Print_Index = Index + 1;
-
-               if(Length != (Index + 1))
-               {
-                  /* Redsiplay the group name at the start of a new line if its
-                     not immidiately succeeded by another new line. */
-                  if(QCLI_Context.Printf_Buffer[Index + 1] != '\n')
-                  {
-                     if(Group_List_Entry->Command_Group != NULL)
-                     {
-                        PAL_Console_Write(strlen((char *)(Group_List_Entry->Command_Group->Group_String)), Group_List_Entry->Command_Group->Group_String);
-                        PAL_Console_Write(2, ": ");
-                     }
-                  }
-               }
-               else
-               {
-                  /* This printout stopped on the newline so set the current
-                     print group to the main group to prompt the next line to
-                     redisplay the group name. */
-                  QCLI_Context.Current_Printf_Group = MAIN_PRINTF_HANDLE;
-               }
-
-               QCLI_Context.Printf_New_Line = false;
-            }
-            else
-            {
-               QCLI_Context.Printf_New_Line = true;
+               Length = sizeof(QCLI_Context.Printf_Buffer) - 1;
             }
-         }
 
-         /* Print the remaining buffer after the last newline. */
-         if(Length != Next_Print_Index)
-         {
-            PAL_Console_Write(Length - Next_Print_Index, &(QCLI_Context.Printf_Buffer[Next_Print_Index]));
-         }
+            Output_Message(Group_Handle, Length, QCLI_Context.Printf_Buffer);
 
-         RELEASE_LOCK(QCLI_Context.CLI_Mutex);
+            RELEASE_LOCK(QCLI_Context.CLI_Mutex);
+         }
       }
    }
 }
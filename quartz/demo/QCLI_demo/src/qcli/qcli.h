@@ -36,6 +36,19 @@
 */
 qbool_t QCLI_Initialize(void);
 
+/**
+   @brief This function starts the threads used by the QCLI module.
+
+   This starts the console logger and the worker threads that execute
+   threaded commands. It should be called once the platform is ready to
+   run commands.
+
+   @return
+    - true if all QCLI threads were started.
+    - false if a thread could not be started.
+*/
+qbool_t QCLI_Start(void);
+
 /**
    @brief This function passes characters input from the command line to
           the QCLI module for processing.
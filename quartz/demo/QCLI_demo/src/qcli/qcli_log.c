@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2015-2017 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "string.h"
+
+#include "qapi_types.h"
+#include "qurt_error.h"
+#include "qurt_signal.h"
+#include "qurt_thread.h"
+#include "qurt_timer.h"
+#include "qurt_types.h"
+
+#include "qcli_log.h"
+
+#if defined(__ICCARM__)
+   #include <intrinsics.h>
+#endif
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   This definition determines the granularity (in bytes) of records in the
+   ring. Every record, including padding records, is a multiple of this
+   size so a record header always fits before the end of the ring.
+*/
+#define QCLI_LOG_RECORD_ALIGNMENT                                       (16)
+
+/**
+   Priority and stack size of the drain thread. The drain thread runs below
+   the command and stack threads so console output never delays them.
+*/
+#define QCLI_LOG_THREAD_PRIORITY                                        (28)
+#define QCLI_LOG_THREAD_STACK_SIZE                                      (1536)
+
+/**
+   This definition determines how long a producer waits for ring space
+   under QCLI_LOG_OVERFLOW_WAIT_E before dropping its message. It is long
+   enough for the drain thread to write a full ring at 115200 baud.
+*/
+#define QCLI_LOG_OVERFLOW_WAIT_MS                                       (500)
+
+#define QCLI_LOG_EVENT_MASK_DATA                                        0x00000001
+#define QCLI_LOG_EVENT_MASK_SPACE                                       0x00000002
+
+#define RECORD_STATE_EMPTY                                              (0)
+#define RECORD_STATE_COMMITTED                                          (1)
+#define RECORD_STATE_PADDING                                            (2)
+
+#define ALIGN_RECORD_LENGTH(__length__)                                 ((((__length__) + QCLI_LOG_RECORD_ALIGNMENT - 1) / QCLI_LOG_RECORD_ALIGNMENT) * QCLI_LOG_RECORD_ALIGNMENT)
+
+#define STAGING_ALL_FREE_MASK                                           ((1UL << QCLI_LOG_STAGING_BUFFER_COUNT) - 1)
+
+/* Memory barrier and compare-and-swap primitives. On Cortex-M4 these map
+   to DMB and LDREX/STREX. */
+#if defined(__GNUC__)
+   #define MEMORY_BARRIER()                                             __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(__ICCARM__)
+   #define MEMORY_BARRIER()                                             __DMB()
+#else
+   #error "QCLI log requires a memory barrier for this compiler"
+#endif
+
+/* Interrupt context check. On Cortex-M the IPSR holds the active exception
+   number, which is zero in thread mode. */
+#if defined(__ICCARM__)
+   #define IN_INTERRUPT_CONTEXT()                                       (__get_IPSR() != 0)
+#elif defined(__GNUC__) && defined(__arm__)
+   #define IN_INTERRUPT_CONTEXT()                                       (({ uint32_t __ipsr__; __asm volatile ("mrs %0, ipsr" : "=r" (__ipsr__)); __ipsr__; }) != 0)
+#else
+   #define IN_INTERRUPT_CONTEXT()                                       (0)
+#endif
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   This structure is the header placed in front of every message in the
+   ring.
+*/
+typedef struct QCLI_Log_Record_s
+{
+   volatile uint32_t   State;        /**< One of the RECORD_STATE_* values.           */
+   uint16_t            Length;       /**< Length of the whole record, header included. */
+   uint16_t            Data_Length;  /**< Length of the message following the header.  */
+   QCLI_Group_Handle_t Group_Handle; /**< Group the message was printed for.           */
+} QCLI_Log_Record_t;
+
+/**
+   This structure contains the context information for the logger.
+
+   Reserve_Index and Read_Index are free running byte counters; their
+   difference is the number of bytes in use. Producers advance
+   Reserve_Index with compare-and-swap, and only the drain thread advances
+   Read_Index.
+*/
+typedef struct QCLI_Log_Context_s
+{
+   qbool_t                    Initialized;                                                               /**< Indicates QCLI_Log_Initialize() has completed.  */
+   volatile qbool_t           Running;                                                                   /**< Indicates the drain thread is running.          */
+   QCLI_Log_Output_Function_t Output_Function;                                                           /**< Function used to write messages to the console. */
+   QCLI_Log_Overflow_Policy_t Overflow_Policy;                                                           /**< What producers do when the ring is full.        */
+   qurt_signal_t              Event;                                                                     /**< Data available and space available events.      */
+   volatile uint32_t          Reserve_Index;                                                             /**< Bytes reserved by producers.                    */
+   volatile uint32_t          Read_Index;                                                                /**< Bytes consumed by the drain thread.             */
+   volatile uint32_t          Staging_Free_Mask;                                                         /**< Bit set for each staging buffer not in use.     */
+   QCLI_Log_Statistics_t      Statistics;                                                                /**< Logger counters.                                */
+   char                       Staging_Buffer[QCLI_LOG_STAGING_BUFFER_COUNT][QCLI_LOG_MAXIMUM_MESSAGE_LENGTH]; /**< Buffers producers format messages into. */
+   uint32_t                   Buffer[QCLI_LOG_BUFFER_SIZE / sizeof(uint32_t)];                          /**< The message ring.                               */
+} QCLI_Log_Context_t;
+
+static QCLI_Log_Context_t QCLI_Log_Context;
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function atomically replaces a value if it still holds the
+          expected value.
+
+   @param Address is the value to update.
+   @param Expected is the value Address must hold for the update to occur.
+   @param Desired is the new value.
+
+   @return
+    - true if the value was replaced.
+    - false if the value did not match or the exclusive access failed.
+*/
+static qbool_t Compare_And_Swap(volatile uint32_t *Address, uint32_t Expected, uint32_t Desired)
+{
+#if defined(__GNUC__)
+
+   return((qbool_t)__atomic_compare_exchange_n(Address, &Expected, Desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+
+#else
+
+   qbool_t Ret_Val;
+
+   if(__LDREX((unsigned long *)Address) == Expected)
+   {
+      Ret_Val = (qbool_t)(__STREX(Desired, (unsigned long *)Address) == 0);
+   }
+   else
+   {
+      __CLREX();
+      Ret_Val = false;
+   }
+
+   MEMORY_BARRIER();
+
+   return(Ret_Val);
+
+#endif
+}
+
+/**
+   @brief This function atomically adds to a counter.
+
+   @param Address is the counter to update.
+   @param Value is the amount to add.
+*/
+static void Atomic_Add(volatile uint32_t *Address, uint32_t Value)
+{
+   uint32_t Current;
+
+   do
+   {
+      Current = *Address;
+   } while(!Compare_And_Swap(Address, Current, Current + Value));
+}
+
+/**
+   @brief This function atomically raises a value to at least a given
+          level.
+
+   @param Address is the value to update.
+   @param Value is the new minimum.
+*/
+static void Atomic_Max(volatile uint32_t *Address, uint32_t Value)
+{
+   uint32_t Current;
+
+   do
+   {
+      Current = *Address;
+      if(Current >= Value)
+      {
+         break;
+      }
+   } while(!Compare_And_Swap(Address, Current, Value));
+}
+
+/**
+   @brief This function returns the record at a ring index.
+
+   @param Index is the free running ring index.
+*/
+static QCLI_Log_Record_t *Get_Record(uint32_t Index)
+{
+   return((QCLI_Log_Record_t *)(((uint8_t *)(QCLI_Log_Context.Buffer)) + (Index & (QCLI_LOG_BUFFER_SIZE - 1))));
+}
+
+/**
+   @brief This function reserves space for a record in the ring.
+
+   If the record would straddle the end of the ring, a padding record is
+   placed in front of it so that every record is contiguous.
+
+   @param Record_Length is the aligned length of the record, header
+          included.
+
+   @return The reserved record or NULL if the ring is full.
+*/
+static QCLI_Log_Record_t *Reserve_Record(uint32_t Record_Length)
+{
+   uint32_t           Start;
+   uint32_t           Padding;
+   uint32_t           In_Use;
+   QCLI_Log_Record_t *Record;
+
+   do
+   {
+      Start   = QCLI_Log_Context.Reserve_Index;
+      Padding = QCLI_LOG_BUFFER_SIZE - (Start & (QCLI_LOG_BUFFER_SIZE - 1));
+      if(Padding >= Record_Length)
+      {
+         Padding = 0;
+      }
+
+      MEMORY_BARRIER();
+
+      In_Use = Start + Padding + Record_Length - QCLI_Log_Context.Read_Index;
+      if(In_Use > QCLI_LOG_BUFFER_SIZE)
+      {
+         return(NULL);
+      }
+   } while(!Compare_And_Swap(&(QCLI_Log_Context.Reserve_Index), Start, Start + Padding + Record_Length));
+
+   Atomic_Max(&(QCLI_Log_Context.Statistics.High_Water_Mark), In_Use);
+
+   if(Padding != 0)
+   {
+      Record              = Get_Record(Start);
+      Record->Length      = (uint16_t)Padding;
+      Record->Data_Length = 0;
+
+      MEMORY_BARRIER();
+
+      Record->State = RECORD_STATE_PADDING;
+   }
+
+   return(Get_Record(Start + Padding));
+}
+
+/**
+   @brief This function is the entry point for the drain thread.
+
+   Messages are written in the order their space was reserved. The thread
+   clears each record after writing it so a reused header always reads as
+   empty until its producer commits it.
+
+   @param Thread_Parameter is unused.
+*/
+static void Drain_Thread(void *Thread_Parameter)
+{
+   uint32_t           Read_Index;
+   uint32_t           Record_Length;
+   QCLI_Log_Record_t *Record;
+
+   while(true)
+   {
+      Read_Index = QCLI_Log_Context.Read_Index;
+
+      MEMORY_BARRIER();
+
+      if(Read_Index == QCLI_Log_Context.Reserve_Index)
+      {
+         qurt_signal_wait(&(QCLI_Log_Context.Event), QCLI_LOG_EVENT_MASK_DATA, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+         continue;
+      }
+
+      Record = Get_Record(Read_Index);
+      if(Record->State == RECORD_STATE_EMPTY)
+      {
+         /* Space is reserved but the producer has not committed it yet. */
+         qurt_signal_wait(&(QCLI_Log_Context.Event), QCLI_LOG_EVENT_MASK_DATA, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+         continue;
+      }
+
+      MEMORY_BARRIER();
+
+      if(Record->State == RECORD_STATE_COMMITTED)
+      {
+         (*(QCLI_Log_Context.Output_Function))(Record->Group_Handle, Record->Data_Length, (const char *)(Record + 1));
+      }
+
+      Record_Length = Record->Length;
+      memset(Record, 0, Record_Length);
+
+      MEMORY_BARRIER();
+
+      QCLI_Log_Context.Read_Index = Read_Index + Record_Length;
+
+      qurt_signal_set(&(QCLI_Log_Context.Event), QCLI_LOG_EVENT_MASK_SPACE);
+   }
+}
+
+/**
+   @brief This function initializes the logger.
+
+   Messages are not accepted until QCLI_Log_Start() has been called.
+
+   @param Output_Function is called by the drain thread for each message.
+
+   @return
+    - true if the logger was initialized successfully.
+    - false if initialization failed.
+*/
+qbool_t QCLI_Log_Initialize(QCLI_Log_Output_Function_t Output_Function)
+{
+   if(Output_Function == NULL)
+   {
+      return(false);
+   }
+
+   memset(&QCLI_Log_Context, 0, sizeof(QCLI_Log_Context));
+
+   QCLI_Log_Context.Output_Function   = Output_Function;
+   QCLI_Log_Context.Overflow_Policy   = QCLI_LOG_DEFAULT_OVERFLOW_POLICY;
+   QCLI_Log_Context.Staging_Free_Mask = STAGING_ALL_FREE_MASK;
+
+   if(qurt_signal_create(&(QCLI_Log_Context.Event)) != QURT_EOK)
+   {
+      return(false);
+   }
+
+   QCLI_Log_Context.Initialized = true;
+
+   return(true);
+}
+
+/**
+   @brief This function starts the low priority drain thread.
+
+   @return
+    - true if the drain thread is running.
+    - false if the thread could not be created.
+*/
+qbool_t QCLI_Log_Start(void)
+{
+   qurt_thread_attr_t Thread_Attribte;
+   qurt_thread_t      Thread_Handle;
+
+   if(!QCLI_Log_Context.Initialized)
+   {
+      return(false);
+   }
+
+   if(!QCLI_Log_Context.Running)
+   {
+      qurt_thread_attr_init(&Thread_Attribte);
+      qurt_thread_attr_set_name(&Thread_Attribte, "QCLI Log");
+      qurt_thread_attr_set_priority(&Thread_Attribte, QCLI_LOG_THREAD_PRIORITY);
+      qurt_thread_attr_set_stack_size(&Thread_Attribte, QCLI_LOG_THREAD_STACK_SIZE);
+
+      if(qurt_thread_create(&Thread_Handle, &Thread_Attribte, Drain_Thread, NULL) != QURT_EOK)
+      {
+         return(false);
+      }
+
+      QCLI_Log_Context.Running = true;
+   }
+
+   return(true);
+}
+
+/**
+   @brief This function indicates if the drain thread is running and the
+          logger is accepting messages.
+*/
+qbool_t QCLI_Log_Is_Running(void)
+{
+   return(QCLI_Log_Context.Running);
+}
+
+/**
+   @brief This function places an already formatted buffer in the ring.
+
+   @param Group_Handle is the group the data is being printed for, or NULL
+          for raw console data.
+   @param Length is the length of the data.
+   @param Buffer is the data to queue.
+
+   @return
+    - true if the data was queued.
+    - false if the data was dropped.
+*/
+qbool_t QCLI_Log_Write(QCLI_Group_Handle_t Group_Handle, uint32_t Length, const char *Buffer)
+{
+   QCLI_Log_Record_t *Record;
+   uint32_t           Record_Length;
+   uint32             Signal_Waiting;
+   qbool_t            Can_Wait;
+   qurt_time_t        Wait_Ticks;
+   qurt_time_t        Start_Ticks;
+   qurt_time_t        Elapsed_Ticks;
+
+   if((!QCLI_Log_Context.Running) || (Buffer == NULL) || (Length == 0))
+   {
+      return(false);
+   }
+
+   if(Length > QCLI_LOG_MAXIMUM_MESSAGE_LENGTH)
+   {
+      Length = QCLI_LOG_MAXIMUM_MESSAGE_LENGTH;
+
+      Atomic_Add(&(QCLI_Log_Context.Statistics.Messages_Truncated), 1);
+   }
+
+   Record_Length = ALIGN_RECORD_LENGTH(sizeof(QCLI_Log_Record_t) + Length);
+   Can_Wait      = (qbool_t)((QCLI_Log_Context.Overflow_Policy == QCLI_LOG_OVERFLOW_WAIT_E) && (!IN_INTERRUPT_CONTEXT()));
+   Wait_Ticks    = 0;
+   Start_Ticks   = 0;
+
+   if(Can_Wait)
+   {
+      Wait_Ticks  = qurt_timer_convert_time_to_ticks(QCLI_LOG_OVERFLOW_WAIT_MS, QURT_TIME_MSEC);
+      Start_Ticks = qurt_timer_get_ticks();
+   }
+
+   while((Record = Reserve_Record(Record_Length)) == NULL)
+   {
+      /* Each record the drain thread frees wakes the producer, which may
+         not yet be enough space, so keep waiting until the deadline. */
+      Elapsed_Ticks = (Can_Wait) ? (qurt_timer_get_ticks() - Start_Ticks) : 0;
+
+      if((!Can_Wait) || (Elapsed_Ticks >= Wait_Ticks))
+      {
+         Atomic_Add(&(QCLI_Log_Context.Statistics.Messages_Dropped), 1);
+         Atomic_Add(&(QCLI_Log_Context.Statistics.Bytes_Dropped), Length);
+
+         return(false);
+      }
+
+      /* Clear the space event and retry once before waiting so a record
+         freed in between is not missed. */
+      qurt_signal_clear(&(QCLI_Log_Context.Event), QCLI_LOG_EVENT_MASK_SPACE);
+
+      if((Record = Reserve_Record(Record_Length)) != NULL)
+      {
+         break;
+      }
+
+      qurt_signal_wait_timed(&(QCLI_Log_Context.Event), QCLI_LOG_EVENT_MASK_SPACE, QURT_SIGNAL_ATTR_WAIT_ANY, &Signal_Waiting, Wait_Ticks - Elapsed_Ticks);
+   }
+
+   Record->Length       = (uint16_t)Record_Length;
+   Record->Data_Length  = (uint16_t)Length;
+   Record->Group_Handle = Group_Handle;
+   memcpy((Record + 1), Buffer, Length);
+
+   MEMORY_BARRIER();
+
+   Record->State = RECORD_STATE_COMMITTED;
+
+   Atomic_Add(&(QCLI_Log_Context.Statistics.Messages_Written), 1);
+
+   qurt_signal_set(&(QCLI_Log_Context.Event), QCLI_LOG_EVENT_MASK_DATA);
+
+   return(true);
+}
+
+/**
+   @brief This function formats a message into a staging buffer and places
+          it in the ring.
+
+   @param Group_Handle is the group the message is being printed for.
+   @param Format is the format string.
+   @param Arg_List is the argument list for the format string.
+
+   @return
+    - true if the message was queued.
+    - false if the message was dropped.
+*/
+qbool_t QCLI_Log_VPrintf(QCLI_Group_Handle_t Group_Handle, const char *Format, va_list Arg_List)
+{
+   qbool_t  Ret_Val;
+   uint32_t Free_Mask;
+   uint32_t Staging_Index;
+   int      Length;
+
+   if((!QCLI_Log_Context.Running) || (Format == NULL))
+   {
+      return(false);
+   }
+
+   /* Claim a staging buffer. */
+   do
+   {
+      Free_Mask = QCLI_Log_Context.Staging_Free_Mask;
+      if(Free_Mask == 0)
+      {
+         Atomic_Add(&(QCLI_Log_Context.Statistics.Staging_Exhausted), 1);
+
+         return(false);
+      }
+
+      for(Staging_Index = 0; (Free_Mask & (1UL << Staging_Index)) == 0; Staging_Index ++)
+      {
+      }
+   } while(!Compare_And_Swap(&(QCLI_Log_Context.Staging_Free_Mask), Free_Mask, Free_Mask & ~(1UL << Staging_Index)));
+
+   Length = vsnprintf(QCLI_Log_Context.Staging_Buffer[Staging_Index], QCLI_LOG_MAXIMUM_MESSAGE_LENGTH, Format, Arg_List);
+
+   if(Length > 0)
+   {
+      /* Make sure the length is not greater than the buffer size (taking
+         the NULL terminator into account). */
+      if(Length > QCLI_LOG_MAXIMUM_MESSAGE_LENGTH - 1)
+      {
+         Length = QCLI_LOG_MAXIMUM_MESSAGE_LENGTH - 1;
+
+         Atomic_Add(&(QCLI_Log_Context.Statistics.Messages_Truncated), 1);
+      }
+
+      Ret_Val = QCLI_Log_Write(Group_Handle, (uint32_t)Length, QCLI_Log_Context.Staging_Buffer[Staging_Index]);
+   }
+   else
+   {
+      Ret_Val = (qbool_t)(Length == 0);
+   }
+
+   /* Release the staging buffer. */
+   do
+   {
+      Free_Mask = QCLI_Log_Context.Staging_Free_Mask;
+   } while(!Compare_And_Swap(&(QCLI_Log_Context.Staging_Free_Mask), Free_Mask, Free_Mask | (1UL << Staging_Index)));
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function waits until all messages queued before the call
+          have been written.
+
+   Messages queued by other threads while waiting are not waited for, so
+   the flush completes even if output continues.
+
+   @param Timeout_Ms is the maximum time to wait in milliseconds.
+
+   @return
+    - true if the messages have been written.
+    - false if the timeout expired first.
+*/
+qbool_t QCLI_Log_Flush(uint32_t Timeout_Ms)
+{
+   qurt_time_t Remaining;
+   uint32_t    Flush_Index;
+
+   if(!QCLI_Log_Context.Running)
+   {
+      return(true);
+   }
+
+   Remaining   = qurt_timer_convert_time_to_ticks(Timeout_Ms, QURT_TIME_MSEC);
+   Flush_Index = QCLI_Log_Context.Reserve_Index;
+
+   while((int32_t)(QCLI_Log_Context.Read_Index - Flush_Index) < 0)
+   {
+      if(Remaining == 0)
+      {
+         return(false);
+      }
+
+      qurt_thread_sleep(1);
+      Remaining --;
+   }
+
+   return(true);
+}
+
+/**
+   @brief This function sets the policy used when the ring is full.
+
+   @param Policy is the new overflow policy.
+*/
+void QCLI_Log_Set_Overflow_Policy(QCLI_Log_Overflow_Policy_t Policy)
+{
+   QCLI_Log_Context.Overflow_Policy = Policy;
+}
+
+/**
+   @brief This function retrieves a snapshot of the logger counters.
+
+   @param Statistics is where the counters will be copied.
+*/
+void QCLI_Log_Get_Statistics(QCLI_Log_Statistics_t *Statistics)
+{
+   if(Statistics != NULL)
+   {
+      *Statistics = QCLI_Log_Context.Statistics;
+   }
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2015-2017 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#ifndef __QCLI_LOG_H__ // [
+#define __QCLI_LOG_H__
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdarg.h>
+#include "qapi_types.h"
+#include "qcli_api.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   This definition determines the size (in bytes) of the ring that holds
+   messages waiting to be written to the console. It must be a power of
+   two.
+*/
+#define QCLI_LOG_BUFFER_SIZE                                            (4096)
+
+/**
+   This definition determines the maximum length of a single formatted
+   message. Longer messages are truncated.
+*/
+#define QCLI_LOG_MAXIMUM_MESSAGE_LENGTH                                 (256)
+
+/**
+   This definition determines the number of staging buffers producers can
+   format messages into concurrently.
+*/
+#define QCLI_LOG_STAGING_BUFFER_COUNT                                   (4)
+
+/**
+   This definition determines what a producer does when the ring is full,
+   see QCLI_Log_Overflow_Policy_t. Waiting keeps long command output such
+   as help or scan results intact. Producers in interrupt context never
+   wait.
+*/
+#ifndef QCLI_LOG_DEFAULT_OVERFLOW_POLICY
+   #define QCLI_LOG_DEFAULT_OVERFLOW_POLICY                             QCLI_LOG_OVERFLOW_WAIT_E
+#endif
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   This enumeration represents what a producer does when the ring is full.
+*/
+typedef enum
+{
+   QCLI_LOG_OVERFLOW_DROP_E,  /**< Discard the new message immediately (never blocks).               */
+   QCLI_LOG_OVERFLOW_WAIT_E   /**< Wait a bounded time for the drain thread, then discard the message.
+                                   Messages from interrupt context are discarded immediately.          */
+} QCLI_Log_Overflow_Policy_t;
+
+/**
+   This structure contains the counters maintained by the logger.
+*/
+typedef struct QCLI_Log_Statistics_s
+{
+   uint32_t Messages_Written;   /**< Messages placed in the ring.                                 */
+   uint32_t Messages_Dropped;   /**< Messages discarded because the ring was full.                */
+   uint32_t Bytes_Dropped;      /**< Payload bytes discarded because the ring was full.           */
+   uint32_t Messages_Truncated; /**< Messages cut to QCLI_LOG_MAXIMUM_MESSAGE_LENGTH.             */
+   uint32_t Staging_Exhausted;  /**< Messages discarded because no staging buffer was available. */
+   uint32_t High_Water_Mark;    /**< Largest number of ring bytes in use at once.                 */
+} QCLI_Log_Statistics_t;
+
+/**
+   @brief Type of the function the drain thread uses to write a message to
+          the console.
+
+   @param Group_Handle is the group the message was printed for, or NULL
+          for raw console data.
+   @param Length is the length of the message.
+   @param Buffer is the message. It is not NULL terminated.
+*/
+typedef void (*QCLI_Log_Output_Function_t)(QCLI_Group_Handle_t Group_Handle, uint32_t Length, const char *Buffer);
+
+/*-------------------------------------------------------------------------
+ * Function Declarations and Documentation
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function initializes the logger.
+
+   Messages are not accepted until QCLI_Log_Start() has been called.
+
+   @param Output_Function is called by the drain thread for each message.
+
+   @return
+    - true if the logger was initialized successfully.
+    - false if initialization failed.
+*/
+qbool_t QCLI_Log_Initialize(QCLI_Log_Output_Function_t Output_Function);
+
+/**
+   @brief This function starts the low priority drain thread.
+
+   @return
+    - true if the drain thread is running.
+    - false if the thread could not be created.
+*/
+qbool_t QCLI_Log_Start(void);
+
+/**
+   @brief This function indicates if the drain thread is running and the
+          logger is accepting messages.
+*/
+qbool_t QCLI_Log_Is_Running(void);
+
+/**
+   @brief This function formats a message into a staging buffer and places
+          it in the ring.
+
+   @param Group_Handle is the group the message is being printed for.
+   @param Format is the format string.
+   @param Arg_List is the argument list for the format string.
+
+   @return
+    - true if the message was queued.
+    - false if the message was dropped.
+*/
+qbool_t QCLI_Log_VPrintf(QCLI_Group_Handle_t Group_Handle, const char *Format, va_list Arg_List);
+
+/**
+   @brief This function places an already formatted buffer in the ring.
+
+   @param Group_Handle is the group the data is being printed for, or NULL
+          for raw console data.
+   @param Length is the length of the data.
+   @param Buffer is the data to queue.
+
+   @return
+    - true if the data was queued.
+    - false if the data was dropped.
+*/
+qbool_t QCLI_Log_Write(QCLI_Group_Handle_t Group_Handle, uint32_t Length, const char *Buffer);
+
+/**
+   @brief This function waits until all messages queued before the call
+          have been written.
+
+   @param Timeout_Ms is the maximum time to wait in milliseconds.
+
+   @return
+    - true if the messages have been written.
+    - false if the timeout expired first.
+*/
+qbool_t QCLI_Log_Flush(uint32_t Timeout_Ms);
+
+/**
+   @brief This function sets the policy used when the ring is full.
+
+   @param Policy is the new overflow policy.
+*/
+void QCLI_Log_Set_Overflow_Policy(QCLI_Log_Overflow_Policy_t Policy);
+
+/**
+   @brief This function retrieves a snapshot of the logger counters.
+
+   @param Statistics is where the counters will be copied.
+*/
+void QCLI_Log_Get_Statistics(QCLI_Log_Statistics_t *Statistics);
+
+#endif // ] #ifndef __QCLI_LOG_H__
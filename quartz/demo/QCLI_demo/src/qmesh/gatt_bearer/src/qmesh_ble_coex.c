@@ -17,6 +17,7 @@ Qualcomm Technologies International, Ltd. Confidential and Proprietary.
 #include "qapi_ble_errors.h"
 
 #include "qmesh_ble_coex.h"
+#include "ble_conn_table.h"
 
 #include "qmesh_demo_config.h"
 #include "qmesh_demo_debug.h"
@@ -89,6 +90,16 @@ Qualcomm Technologies International, Ltd. Confidential and Proprietary.
                                                          /* Pairing.          */
 
 
+#ifndef MAX_SUPPORTED_REMOTE_DEVICES
+#define MAX_SUPPORTED_REMOTE_DEVICES             (8)     /* Denotes the       */
+                                                         /* maximum number of */
+                                                         /* remote devices    */
+                                                         /* (connected or     */
+                                                         /* bonded) that are  */
+                                                         /* supported by this */
+                                                         /* application.      */
+#endif
+
    /* The following MACRO is used to calculate if an ASCII              */
    /* characteristic is valid.                                          */
 #define CHECK_ASCII_VALID(_x)                         (((_x) >= ' ') && ((_x) <= '~'))
@@ -295,7 +306,6 @@ typedef struct _tagDeviceInfo_t
    qapi_BLE_GAP_LE_Resolving_List_Entry_t ResolvingListEntry;
    GAPS_Client_Info_t                     GAPSClientInfo;
    QMCT_Client_Info_t                     QMCTClientInfo;
-   struct _tagDeviceInfo_t               *NextDeviceInfoInfoPtr;
 } DeviceInfo_t;
 
 #define DEVICE_INFO_DATA_SIZE                            (sizeof(DeviceInfo_t))
@@ -450,8 +460,14 @@ const qapi_BLE_GATT_Service_Attribute_Entry_t CoEx_Service[] =
 static unsigned int        ConnectionCount;         /* Holds the number of connected   */
                                                     /* remote devices.                 */
 
-static DeviceInfo_t       *DeviceInfoList;          /* Holds the list head for the     */
-                                                    /* remote device info list         */
+static DeviceInfo_t        DeviceInfoPool[MAX_SUPPORTED_REMOTE_DEVICES];
+                                                    /* Holds the remote device info    */
+                                                    /* entries.                        */
+
+static BLE_Conn_Table_t    DeviceInfoTable = BLE_CONN_TABLE_INITIALIZER(DeviceInfoPool, DeviceInfo_t, RemoteAddress, ConnectionID);
+                                                    /* Indexes the remote device info  */
+                                                    /* entries by BD_ADDR and by GATT  */
+                                                    /* Connection ID.                  */
 
 typedef char               BoardStr_t[16];          /* User to represent a structure to*/
                                                     /* hold a BD_ADDR return from      */
@@ -570,10 +586,10 @@ static void GenerateRandomKeys(void);
 static void StrToBD_ADDR(char *BoardStr, qapi_BLE_BD_ADDR_t *Board_Address);
 
    /* Demo helper functions.                                            */
-static DeviceInfo_t *CreateNewDeviceInfoEntry(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress);
-static DeviceInfo_t *SearchDeviceInfoEntryByBD_ADDR(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress);
-static DeviceInfo_t *SearchDeviceInfoEntryByConnectionID(DeviceInfo_t **ListHead, unsigned int ConnectionID);
-static DeviceInfo_t *DeleteDeviceInfoEntry(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress);
+static DeviceInfo_t *CreateNewDeviceInfoEntry(qapi_BLE_BD_ADDR_t RemoteAddress);
+static DeviceInfo_t *SearchDeviceInfoEntryByBD_ADDR(qapi_BLE_BD_ADDR_t RemoteAddress);
+static DeviceInfo_t *SearchDeviceInfoEntryByConnectionID(unsigned int ConnectionID);
+static DeviceInfo_t *DeleteDeviceInfoEntry(qapi_BLE_BD_ADDR_t RemoteAddress);
 
 
 static void BD_ADDRToStr(qapi_BLE_BD_ADDR_t Board_Address, BoardStr_t BoardStr);
@@ -691,96 +707,51 @@ MESH_DATA_T g_mesh_data;
    /* Demo helper functions.                                            */
 
    /* The following function will create a device information entry and */
-   /* add it to the specified List.  This function, if successful, will */
-   /* return a pointer to the Entry that has been created and added to  */
-   /* the specified list.  This function will return NULL if NO Entry   */
-   /* was added.  This can occur if the element passed in was deemed    */
-   /* invalid or the actual List Head was invalid.                      */
+   /* add it to the remote device information table.  This function, if*/
+   /* successful, will return a pointer to the Entry that has been      */
+   /* created and added to the table.  This function will return NULL if*/
+   /* NO Entry was added.  This can occur if the element passed in was  */
+   /* deemed invalid or the table is full.                              */
    /* ** NOTE ** This function does not insert duplicate entries into   */
-   /*            the list.  An element is considered a duplicate if the */
+   /*            the table.  An element is considered a duplicate if the*/
    /*            RemoteAddress already exists for an entry.  When this  */
    /*            occurs, this function returns NULL.                    */
-static DeviceInfo_t *CreateNewDeviceInfoEntry(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress)
+static DeviceInfo_t *CreateNewDeviceInfoEntry(qapi_BLE_BD_ADDR_t RemoteAddress)
 {
-   DeviceInfo_t *ret_val = NULL;
-   boolean_t     Result;
-
-   /* Verify that the passed in parameters seem semi-valid.             */
-   if((ListHead) && (!QAPI_BLE_COMPARE_NULL_BD_ADDR(RemoteAddress)))
-   {
-      /* Allocate the memory for the entry.                             */
-      if((ret_val = malloc(sizeof(DeviceInfo_t))) != NULL)
-      {
-         /* Initialize the entry.                                       */
-         memset(ret_val, 0, sizeof(DeviceInfo_t));
-
-         /* Store the remote device address.                            */
-         ret_val->RemoteAddress = RemoteAddress;
-
-         Result = qapi_BLE_BSC_AddGenericListEntry_Actual(QAPI_BLE_EK_BD_ADDR_T_E, QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, RemoteAddress), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, NextDeviceInfoInfoPtr), (void **)(ListHead), (void *)(ret_val));
-         if(!Result)
-         {
-            /* Failed to add to list so we should free the memory that  */
-            /* we allocated for the entry.                              */
-            free(ret_val);
-         }
-      }
-   }
-
-   return(ret_val);
+   return((DeviceInfo_t *)BLE_Conn_Table_Add(&DeviceInfoTable, RemoteAddress));
 }
 
-   /* The following function searches the specified List for the        */
-   /* specified Connection BD_ADDR.  This function returns NULL if      */
-   /* either the List Head is invalid, the BD_ADDR is invalid, or the   */
-   /* Connection BD_ADDR was NOT found.                                 */
-static DeviceInfo_t *SearchDeviceInfoEntryByBD_ADDR(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress)
+   /* The following function searches the remote device information    */
+   /* table for the specified Connection BD_ADDR.  This function returns*/
+   /* NULL if either the BD_ADDR is invalid, or the Connection BD_ADDR  */
+   /* was NOT found.                                                    */
+static DeviceInfo_t *SearchDeviceInfoEntryByBD_ADDR(qapi_BLE_BD_ADDR_t RemoteAddress)
 {
-   DeviceInfo_t *ret_val = NULL;
-   DeviceInfo_t *DeviceInfo;
-
-   /* Verify the list head.                                             */
-   if(ListHead)
-   {
-      /* Loop through the device information.                           */
-      DeviceInfo = *ListHead;
-      while(DeviceInfo)
-      {
-         /* If the BD_ADDR is a match then we found the remote device   */
-         /* information.                                                */
-         if(QAPI_BLE_COMPARE_BD_ADDR(DeviceInfo->RemoteAddress, RemoteAddress))
-         {
-            /* Set the remote device information pointer to the return  */
-            /* value and break since we are done.                       */
-            ret_val = DeviceInfo;
-            break;
-         }
-         DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
-      }
-   }
-
-   return(ret_val);
+   return((DeviceInfo_t *)BLE_Conn_Table_Search_Address(&DeviceInfoTable, RemoteAddress));
 }
 
-   /* The following function searches the specified List for the        */
-   /* specified GATT Connection ID.  This function returns NULL if      */
-   /* either the List Head is invalid, the Connection ID is invalid, or */
-   /* the Connection ID was NOT found.                                  */
-static DeviceInfo_t *SearchDeviceInfoEntryByConnectionID(DeviceInfo_t **ListHead, unsigned int ConnectionID)
+   /* The following function searches the remote device information    */
+   /* table for the specified GATT Connection ID.  This function returns*/
+   /* NULL if either the Connection ID is invalid, or the Connection ID */
+   /* was NOT found.                                                    */
+static DeviceInfo_t *SearchDeviceInfoEntryByConnectionID(unsigned int ConnectionID)
 {
-   return(qapi_BLE_BSC_SearchGenericListEntry(QAPI_BLE_EK_UNSIGNED_INTEGER_E, (void *)(&ConnectionID), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, ConnectionID), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, NextDeviceInfoInfoPtr), (void **)(ListHead)));
+   return((DeviceInfo_t *)BLE_Conn_Table_Search_ConnectionID(&DeviceInfoTable, ConnectionID));
 }
 
-   /* The following function searches the specified Key Info List for   */
-   /* the specified BD_ADDR and removes it from the List.  This function*/
-   /* returns NULL if either the List Head is invalid, the BD_ADDR is   */
-   /* invalid, or the specified Entry was NOT present in the list.  The */
-   /* entry returned will have the Next Entry field set to NULL, and    */
-   /* the caller is responsible for deleting the memory associated with */
-   /* this entry by calling the FreeKeyEntryMemory() function.          */
-static DeviceInfo_t *DeleteDeviceInfoEntry(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress)
+   /* The following function searches the remote device information    */
+   /* table for the specified BD_ADDR and removes it from the table.    */
+   /* This function returns NULL if either the BD_ADDR is invalid, or   */
+   /* the specified Entry was NOT present in the table.  The entry      */
+   /* memory stays valid until another entry is created.                */
+static DeviceInfo_t *DeleteDeviceInfoEntry(qapi_BLE_BD_ADDR_t RemoteAddress)
 {
-   return(qapi_BLE_BSC_DeleteGenericListEntry(QAPI_BLE_EK_BD_ADDR_T_E, (void *)(&RemoteAddress), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, RemoteAddress), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, NextDeviceInfoInfoPtr), (void **)(ListHead)));
+   DeviceInfo_t *ret_val;
+
+   if((ret_val = (DeviceInfo_t *)BLE_Conn_Table_Search_Address(&DeviceInfoTable, RemoteAddress)) != NULL)
+      BLE_Conn_Table_Remove(&DeviceInfoTable, ret_val);
+
+   return(ret_val);
 }
 
    /* The following function is responsible for converting data of type */
@@ -1493,7 +1464,7 @@ static QCLI_Command_Status_t SelectRemoteDevice(uint32_t Parameter_Count, QCLI_P
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the remote device.            */
-               if((DeviceInfo = SearchDeviceInfoEntryByConnectionID(&DeviceInfoList, (unsigned int)(Parameter_List[0].Integer_Value))) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByConnectionID((unsigned int)(Parameter_List[0].Integer_Value))) != NULL)
                {
                   /* Simply update the address of the selected remote   */
                   /* device.                                            */
@@ -1563,7 +1534,7 @@ static QCLI_Command_Status_t DisplayRemoteDevices(uint32_t Parameter_Count, QCLI
    if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
    {
       /* Loop through the device information list.                      */
-      DeviceInfo = DeviceInfoList;
+      DeviceInfo = BLE_Conn_Table_First(&DeviceInfoTable);
       Index      = 0;
       while(DeviceInfo)
       {
@@ -1644,7 +1615,7 @@ static QCLI_Command_Status_t DisplayRemoteDevices(uint32_t Parameter_Count, QCLI
             }
          }
 
-         DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+         DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
       }
 
       /* Un-lock the Bluetooth Stack.                                   */
@@ -1764,7 +1735,7 @@ static void SendGattDataThread(void *Param)
     if(QMCTConnectionCount)
     {
         /* Get the device info for the connection device.        */
-        if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+        if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
         {
             while((duration < QMCTGattDuration) && (!Done) && (QMCTGattRunning))
             {
@@ -1839,7 +1810,7 @@ static void SendGattDataThread(void *Param)
                 QCLI_Display_Prompt();
             }
             /* Get the device info for the connected devices.        */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
             {
                 /* Add respective delay to disconnect the device */
                 qurt_thread_sleep(5);
@@ -1890,7 +1861,7 @@ static int DiscoverLEDeviceServices(qapi_BLE_BD_ADDR_t  BD_ADDR)
     BoardStr_t                             BoardStr;
 
     /* Get the device info for the connection device.              */
-    if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+    if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
     {
         /* Verify that no service discovery is outstanding for this */
         /* device.                                                  */
@@ -3340,7 +3311,7 @@ static QCLI_Command_Status_t DiscoverServices(uint32_t Parameter_Count, QCLI_Par
       if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
       {
          /* Get the device info for the connection device.              */
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
          {
             /* Verify that no service discovery is outstanding for this device */
             if(!(DeviceInfo->Flags & DEVICE_INFO_FLAGS_SERVICE_DISCOVERY_OUTSTANDING))
@@ -3963,11 +3934,11 @@ extern void QAPI_BLE_BTPSAPI BLE_COEX_GATT_Connection_Event_Callback(uint32_t Bl
                /* Let's try to find the remote device information.  This*/
                /* will be the case if we previously connected and bonded*/
                /* with the remote device.                               */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->RemoteDevice)) == NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->RemoteDevice)) == NULL)
                {
                   /* This MUST be a new remote device so we will create */
                   /* a remote device information entry.                 */
-                  if((DeviceInfo = CreateNewDeviceInfoEntry(&DeviceInfoList, GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->RemoteDevice)) == NULL)
+                  if((DeviceInfo = CreateNewDeviceInfoEntry(GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->RemoteDevice)) == NULL)
                      QCLI_LOGE(mesh_coex_group, "Failed to create remote device information.\n");
                }
 
@@ -3998,7 +3969,7 @@ extern void QAPI_BLE_BTPSAPI BLE_COEX_GATT_Connection_Event_Callback(uint32_t Bl
                   /*          update the selected remote device.        */
                   DeviceInfo->RemoteDeviceIsMaster = (LocalDeviceIsMaster) ? FALSE : TRUE;
                   DeviceInfo->RemoteAddressType    = RemoteAddressType;
-                  DeviceInfo->ConnectionID         = ConnectionID;
+                  BLE_Conn_Table_Set_ConnectionID(&DeviceInfoTable, DeviceInfo, ConnectionID);
 
                   /* Attempt to update the MTU to the maximum supported.*/
                   if(!qapi_BLE_GATT_Query_Maximum_Supported_MTU(BluetoothStackID, &MTU))
@@ -4031,7 +4002,7 @@ extern void QAPI_BLE_BTPSAPI BLE_COEX_GATT_Connection_Event_Callback(uint32_t Bl
                /*          request to each connected remote device.  It */
                /*          will also free the remote device information */
                /*          entries, so we do not need to handle it here.*/
-               if((ConnectionCount) && (DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->RemoteDevice)) != NULL)
+               if((ConnectionCount) && (DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->RemoteDevice)) != NULL)
                {
                   /* Decrement the number of connected remote devices.  */
                   ConnectionCount--;
@@ -4047,13 +4018,13 @@ extern void QAPI_BLE_BTPSAPI BLE_COEX_GATT_Connection_Event_Callback(uint32_t Bl
 
                      /* Reset the GATT Connection ID to indicate that   */
                      /* the remote device is no longer connected.       */
-                     DeviceInfo->ConnectionID = 0;
+                     BLE_Conn_Table_Set_ConnectionID(&DeviceInfoTable, DeviceInfo, 0);
                   }
                   else
                   {
                      /* Remove the remote device information entry from */
                      /* the list since it is no longer needed.          */
-                     if((DeviceInfo = DeleteDeviceInfoEntry(&DeviceInfoList, GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->RemoteDevice)) != NULL)
+                     if((DeviceInfo = DeleteDeviceInfoEntry(GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->RemoteDevice)) != NULL)
                      {
                         /* Inform the user the remote device information*/
                         /* is being deleted.                            */
@@ -4070,7 +4041,7 @@ extern void QAPI_BLE_BTPSAPI BLE_COEX_GATT_Connection_Event_Callback(uint32_t Bl
                if(ConnectionCount)
                {
                   /* Loop through the device information.               */
-                  DeviceInfo = DeviceInfoList;
+                  DeviceInfo = BLE_Conn_Table_First(&DeviceInfoTable);
                   while(DeviceInfo)
                   {
                      /* Simply check if the GATT Connection ID is       */
@@ -4091,7 +4062,7 @@ extern void QAPI_BLE_BTPSAPI BLE_COEX_GATT_Connection_Event_Callback(uint32_t Bl
                      }
 
                      /* Get the next remote device's information.       */
-                     DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+                     DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
                   }
                }
             }
@@ -4168,7 +4139,7 @@ static void QAPI_BLE_BTPSAPI BLE_COEX_GATT_Service_Discovery_Event_Callback(uint
    {
       DisplayPrompt = true;
 
-      if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+      if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
       {
          switch(GATT_Service_Discovery_Event_Data->Event_Data_Type)
          {
@@ -4300,7 +4271,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_GAPS(uint32_t BluetoothSta
             if(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data)
             {
                DisplayPrompt = false;
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL)
                {
                   if((uint16_t)CallbackParameter == DeviceInfo->GAPSClientInfo.DeviceNameHandle)
                   {
@@ -2117,6 +2117,7 @@ QCLI_Command_Status_t CreateDeviceInstance(uint32_t Parameter_Count, QCLI_Parame
             /* Initialize Model Common Code */
             QmeshModelInitMsgCache();
             QmeshInitDelayCache();
+            QmeshInitTransitionEngine();
 
             QmeshInitModelCommon(QmeshHandleModelEvents,&server_device_composition);
             /* Initialize Lighting and related server models */
@@ -5433,6 +5434,9 @@ extern QCLI_Command_Status_t SaveStateAndReset(uint32_t Parameter_Count, QCLI_Pa
         StopElementSequenceNoTimer ();
         StoreElementSequenceNo ();
         QCLI_LOGI (mesh_group, "Sequence number written to NVM\n");
+
+        /* Write model state changes still held by the NVM write cache */
+        NVMModelFlush ();
     }
 #endif
     QCLI_LOGI (mesh_group, "Performing Cold Reset.....\n");
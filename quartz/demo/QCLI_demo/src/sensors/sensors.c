@@ -23,6 +23,7 @@
 #include "sensors_demo.h"
 
 #include  "sensors.h"
+#include  "sensors_sampler.h"
 
 #define I2C_wait(msec)    do { \
                               qurt_time_t qtime;\
@@ -48,6 +49,7 @@ extern  QCLI_Group_Handle_t qcli_sensors_group;              /* Handle for our Q
 #define  I2CM_READY_SIG_MASK         0x10
 
 qurt_signal_t   i2c_ready_signal;
+volatile uint32_t i2c_transfer_status;	/* controller status of the last transfer */
 
 qapi_I2CM_Config_t config_humidity = {
     100,            /**< I2C bus speed in kHz. */
@@ -101,6 +103,7 @@ void I2CM_Transfer_cb(
     void *CB_Parameter
 )
 {
+   i2c_transfer_status = status;
    qurt_signal_set(&i2c_ready_signal, I2CM_READY_SIG_MASK);
 }
 
@@ -287,58 +290,15 @@ void write_humidity_reg(uint32_t reg_addr, uint8_t reg_val)
 
 int32_t sensors_humidity_get_measured_value()
 {
-	uint16_t   T0_DegCx8, T1_DegCx8, T_current;
-	uint8_t    T0_T1_MSB;
-	int16_t    T0_OUT_val, T1_OUT_val, T_OUT_val;
-	uint32_t   T0_DegCx8_f, T1_DegCx8_f, T_DegCx8_fx10;
-	uint16_t   H0_rHx2, H1_rHx2, H_current;
-	uint32_t   H_rHx2_fx10;
-	int16_t    H0_T0_OUT_val, H1_T0_OUT_val, H_OUT_val;
-
-	// read temperature
-	QCLI_Printf(qcli_sensors_group, "  ------  Temperature ------\n");
-	T_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_T_OUT);
-	
-	T0_DegCx8 = read_sensor_reg8(&config_humidity, HUMIDITY_I2C_REG_ADDR_T0_DegCx8);
-	T1_DegCx8 = read_sensor_reg8(&config_humidity, HUMIDITY_I2C_REG_ADDR_T1_DegCx8);
-	T0_T1_MSB = read_sensor_reg8(&config_humidity, HUMIDITY_I2C_REG_ADDR_T0_T1_MSB);
-	QCLI_Printf(qcli_sensors_group, "DegCx8 T0:0x%x  T1:0x%x  T0_T_MSB:%x\n", T0_DegCx8, T1_DegCx8, T0_T1_MSB);
-	
-	T0_DegCx8 |= ((uint16_t)(T0_T1_MSB & 3)) << 8;
-	T1_DegCx8 |= ((uint16_t)((T0_T1_MSB >> 2) & 3)) << 8;
-	QCLI_Printf(qcli_sensors_group, "DegCx8 with MSB T0:0x%x  T1:0x%x\n", T0_DegCx8, T1_DegCx8);
-	
-	T0_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_T0_OUT);
-	T1_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_T1_OUT);
-	QCLI_Printf(qcli_sensors_group, "register 2's comp T0:%d T1:%d T:%d\n", T0_OUT_val, T1_OUT_val, T_OUT_val);
-	
-	T0_DegCx8_f = T0_DegCx8;
-	T1_DegCx8_f = T1_DegCx8;
-	T_DegCx8_fx10 = (T1_DegCx8_f - T0_DegCx8_f)  * (T_OUT_val - T0_OUT_val) * 10 / (T1_OUT_val - T0_OUT_val) + T0_DegCx8_f * 10;
-	
-	QCLI_Printf(qcli_sensors_group, "DegCx8 T0:%d T1:%d Tx10:%d\n", T0_DegCx8_f, T1_DegCx8_f, T_DegCx8_fx10);
-	T_current = T_DegCx8_fx10 / 8;
-	QCLI_Printf(qcli_sensors_group, "Current Temperature:%d.%d\n", T_current / 10, T_current % 10);
-	
-	
-	// read humidity
-	QCLI_Printf(qcli_sensors_group, "\n------  Relative Humidity ------\n");
-	H_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_H_OUT);
-	
-	H0_rHx2 = read_sensor_reg8(&config_humidity, HUMIDITY_I2C_REG_ADDR_H0_rHx2);
-	H1_rHx2 = read_sensor_reg8(&config_humidity, HUMIDITY_I2C_REG_ADDR_H1_rHx2);
-	QCLI_Printf(qcli_sensors_group, "rHx2 H0:0x%x  H1:0x%x\n", H0_rHx2, H1_rHx2);
-		
-	H0_T0_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_H0_T0_OUT);
-	H1_T0_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_H1_T0_OUT);
-	QCLI_Printf(qcli_sensors_group, "2's comp H0_T0:%d H1_T0:%d H:%d\n", H0_T0_OUT_val, H1_T0_OUT_val, H_OUT_val);
-	
-	H_rHx2_fx10 = (H1_rHx2 - H0_rHx2)  * (H_OUT_val - H0_T0_OUT_val) * 10 / (H1_T0_OUT_val - H0_T0_OUT_val) + H0_rHx2 * 10;
-	
-	QCLI_Printf(qcli_sensors_group, "rHx2 Hx10:%d\n", H_rHx2_fx10);
-	H_current = H_rHx2_fx10 / 2;
-	QCLI_Printf(qcli_sensors_group, "Current rH:%d.%d%% rH\n", H_current / 10, H_current % 10);
-	
+	sensors_sample_set_t  set;
+	uint32_t  mask;
+
+	mask = sensors_sample_read(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_HUMIDITY));
+	if (mask == 0)
+		return -1;
+
+	sensors_sample_compute(mask, &set);
+	sensors_sample_print(mask, &set);
 	return 0;
 }
 
@@ -517,27 +477,12 @@ int32_t   bmp820_compensate_T(uint32_t ut, uint16_t dig_T1, int16_t dig_T2, int1
 
 void sensors_pressure_get_measured_values()
 {
-	uint32_t  ut, up;
-	union {
-		uint32_t   val32;
-		uint8_t    val8[4];
-	} reg_val32;
-	uint16_t   dig_T1;
-	int16_t	   dig_T2, dig_T3;
-	int32_t    T;
-	
-	reg_val32.val32 = sensors_pressure_read_sensor_bits24(&config_pressure, PRESSURE_I2C_REG_ADDR_PRESS);
-	up = (((uint32_t)(reg_val32.val8[0])) << 12) | (((uint32_t)(reg_val32.val8[1])) << 4) | ((((uint32_t)(reg_val32.val8[2])) >> 4) & 0x0F);
-	QCLI_Printf(qcli_sensors_group, "Pressure=0x%08X\n", up);
-										
-	reg_val32.val32 = sensors_pressure_read_sensor_bits24(&config_pressure, PRESSURE_I2C_REG_ADDR_TEMP);
-	ut = (((uint32_t)(reg_val32.val8[0])) << 12) | (((uint32_t)(reg_val32.val8[1])) << 4) | ((((uint32_t)(reg_val32.val8[2])) >> 4) & 0x0F);
-	QCLI_Printf(qcli_sensors_group, "Temp=0x%08X\n", ut);
-	dig_T1 = read_sensor_reg16(&config_pressure, PRESSURE_I2C_REG_ADDR_dig_T1);
-	dig_T2 = read_sensor_reg16(&config_pressure, PRESSURE_I2C_REG_ADDR_dig_T2);
-	dig_T3 = read_sensor_reg16(&config_pressure, PRESSURE_I2C_REG_ADDR_dig_T3);
-    T = bmp820_compensate_T(ut, dig_T1, dig_T2, dig_T3);
-	QCLI_Printf(qcli_sensors_group, "Current Temp DegC=%d.%d\n", T/100, T%100);
+	sensors_sample_set_t  set;
+	uint32_t  mask;
+
+	mask = sensors_sample_read(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_PRESSURE));
+	sensors_sample_compute(mask, &set);
+	sensors_sample_print(mask, &set);
 }
 
 int32_t sensors_pressure_driver_test( uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List )
@@ -699,13 +644,12 @@ void sensors_compass_get_parameters()
 
 void sensors_compass_get_measured_values()
 {
-	int16_t   hx, hy, hz;
-		
-    hx = read_sensor_reg16(&config_compass, COMPASS_I2C_REG_ADDR_HX);
-    hy = read_sensor_reg8(&config_compass, COMPASS_I2C_REG_ADDR_HY);
-    hz = read_sensor_reg8(&config_compass, COMPASS_I2C_REG_ADDR_HZ);
+	sensors_sample_set_t  set;
+	uint32_t  mask;
 
-	QCLI_Printf(qcli_sensors_group, "HX:%d   HY:%d   HZ:%d\n", hx, hy, hz);	
+	mask = sensors_sample_read(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_COMPASS));
+	sensors_sample_compute(mask, &set);
+	sensors_sample_print(mask, &set);
 }
 
 int32_t sensors_compass_driver_test( uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List )
@@ -805,20 +749,12 @@ void sensors_gyroscope_get_parameters()
 
 void sensors_gyroscope_get_measured_values()
 {
-	int16_t   OUT_TEMP_val, OUTX_G_val, OUTY_G_val, OUTZ_G_val;
-	int16_t   OUTX_XL_val, OUTY_XL_val, OUTZ_XL_val;
-	
-	OUT_TEMP_val = read_sensor_reg16(&config_gyroscope_LSM6DS3, LSM6DS3_I2C_REG_ADDR_OUT_TEMP);
-	OUTX_G_val = read_sensor_reg16(&config_gyroscope_LSM6DS3, LSM6DS3_I2C_REG_ADDR_OUTX_G);
-	OUTY_G_val = read_sensor_reg16(&config_gyroscope_LSM6DS3, LSM6DS3_I2C_REG_ADDR_OUTY_G);
-	OUTZ_G_val = read_sensor_reg16(&config_gyroscope_LSM6DS3, LSM6DS3_I2C_REG_ADDR_OUTZ_G);
-	QCLI_Printf(qcli_sensors_group, "TEMP:%d   X_G:%d   Y_G:%d   Z_G:%d\n", OUT_TEMP_val, OUTX_G_val, OUTY_G_val, OUTZ_G_val);	
-	
-	OUTX_XL_val = read_sensor_reg16(&config_gyroscope_LSM6DS3, LSM6DS3_I2C_REG_ADDR_OUTX_XL);
-	OUTY_XL_val = read_sensor_reg16(&config_gyroscope_LSM6DS3, LSM6DS3_I2C_REG_ADDR_OUTY_XL);
-	OUTZ_XL_val = read_sensor_reg16(&config_gyroscope_LSM6DS3, LSM6DS3_I2C_REG_ADDR_OUTZ_XL);
+	sensors_sample_set_t  set;
+	uint32_t  mask;
 
-	QCLI_Printf(qcli_sensors_group, "X_XL:%d   Y_XL:%d   Z_XL:%d\n", OUTX_XL_val, OUTY_XL_val, OUTZ_XL_val);	
+	mask = sensors_sample_read(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_GYROSCOPE));
+	sensors_sample_compute(mask, &set);
+	sensors_sample_print(mask, &set);
 }
  
 int32_t sensors_gyroscope_driver_test( uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List )
@@ -961,44 +897,12 @@ uint32_t sensors_light_LTR303ALS_read_sensor_bits32(qapi_I2CM_Config_t *pI2C_con
 
 void sensors_light_LTR303ALS_get_measured_values()
 {
-	union  {
-		uint32_t   ch_val32;
-		struct  {
-			uint16_t	ch1;
-			uint16_t    ch0;
-		} ch_val16;
-	} ch1_0_val;
-	uint8_t       ALS_CONTR_val, gain;
-	uint32_t       lux=0;
-	
-    ch1_0_val.ch_val32 = sensors_light_LTR303ALS_read_sensor_bits32(&config_light_LTR303ALS, LTR303ALS_I2C_REG_ADDR_ALS_DATA_CH1_0);
+	sensors_sample_set_t  set;
+	uint32_t  mask;
 
-	QCLI_Printf(qcli_sensors_group, "CH 1:%d   CH 0:%d\n", ch1_0_val.ch_val16.ch1, ch1_0_val.ch_val16.ch0);
-	ALS_CONTR_val = read_sensor_reg8(&config_light_LTR303ALS, LTR303ALS_I2C_REG_ADDR_ALS_CONTR);
-	gain = (ALS_CONTR_val >> 2) & 0x07;
-	
-	switch (gain)
-	{
-	case 0:
-	   lux = ch1_0_val.ch_val16.ch0;
-	   break;
-	case 1:
-	   lux = 5 * ch1_0_val.ch_val16.ch0 / 10;
-	   break;	
-	case 2:
-	   lux = 25 * ch1_0_val.ch_val16.ch0 / 100;
-	   break;
-	case 3:
-	   lux = 125 * ch1_0_val.ch_val16.ch0 / 1000;
-	   break;	
-	case 6:
-	   lux = 2 * ch1_0_val.ch_val16.ch0 / 100;
-	   break;	
-	case 7:
-	   lux = 1 * ch1_0_val.ch_val16.ch0 / 100;
-	   break;	
-	}
-	QCLI_Printf(qcli_sensors_group, "Light ch0 Lux=%d\n", lux);
+	mask = sensors_sample_read(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_LIGHT));
+	sensors_sample_compute(mask, &set);
+	sensors_sample_print(mask, &set);
 }
 
 int32_t sensors_light_driver_test( uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List )
@@ -1215,6 +1119,8 @@ QCLI_Command_Status_t sensors_pir_driver_test(uint32_t Parameter_Count, QCLI_Par
 QCLI_Command_Status_t sensors_read_all(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
 {
 	qapi_Status_t status;
+	sensors_sample_set_t  set;
+	uint32_t  mask;
 
 	status = qapi_I2CM_Open(QAPI_I2CM_INSTANCE_002_E, &h1);
 
@@ -1228,15 +1134,8 @@ QCLI_Command_Status_t sensors_read_all(uint32_t Parameter_Count, QCLI_Parameter_
 
 	activate_onboard_sensors();
 
-	sensors_humidity_get_measured_value();
-	QCLI_Printf(qcli_sensors_group, "\n  ------  Pressure Sensors ------\n");
-	sensors_pressure_get_measured_values();
-	QCLI_Printf(qcli_sensors_group, "\n  ------  Compass & Magenetometer Sensors ------\n");
-	sensors_compass_get_measured_values();
-	QCLI_Printf(qcli_sensors_group, "\n  ------  Gyro & Accelerometer Sensors ------\n");
-	sensors_gyroscope_get_measured_values();
-	QCLI_Printf(qcli_sensors_group, "\n  ------  Light Sensors ------\n");
-	sensors_light_LTR303ALS_get_measured_values();
+	// read every sensor back to back, the results are printed once the bus is closed
+	mask = sensors_sample_read(SENSORS_SAMPLE_ALL);
 
 	deactivate_onboard_sensors();
 
@@ -1246,6 +1145,19 @@ QCLI_Command_Status_t sensors_read_all(uint32_t Parameter_Count, QCLI_Parameter_
 		QCLI_Printf(qcli_sensors_group, "I2C close failed\n");
 		return -1;
 	}
+
+	sensors_sample_compute(mask, &set);
+
+	QCLI_Printf(qcli_sensors_group, "  ------  Humidity Sensors ------\n");
+	sensors_sample_print(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_HUMIDITY), &set);
+	QCLI_Printf(qcli_sensors_group, "\n  ------  Pressure Sensors ------\n");
+	sensors_sample_print(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_PRESSURE), &set);
+	QCLI_Printf(qcli_sensors_group, "\n  ------  Compass & Magenetometer Sensors ------\n");
+	sensors_sample_print(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_COMPASS), &set);
+	QCLI_Printf(qcli_sensors_group, "\n  ------  Gyro & Accelerometer Sensors ------\n");
+	sensors_sample_print(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_GYROSCOPE), &set);
+	QCLI_Printf(qcli_sensors_group, "\n  ------  Light Sensors ------\n");
+	sensors_sample_print(SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_LIGHT), &set);
 	return 0;
 }
 #endif
@@ -168,4 +168,6 @@ uint8_t write_sensor_reg8(qapi_I2CM_Config_t *pI2C_config, uint8 reg_addr_val, u
 uint16_t humidity_read_sensor_reg16(qapi_I2CM_Config_t *pI2C_config, uint8 reg_addr_val);
 uint32_t sensors_light_LTR303ALS_read_sensor_bits32(qapi_I2CM_Config_t *pI2C_config, uint8 reg_addr_val);
 
+int32_t bmp820_compensate_T(uint32_t ut, uint16_t dig_T1, int16_t dig_T2, int16_t dig_T3);
+
 #endif
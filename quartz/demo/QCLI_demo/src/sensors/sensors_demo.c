@@ -23,6 +23,7 @@ QCLI_Command_Status_t sensors_pressure(uint32_t Parameter_Count, QCLI_Parameter_
 QCLI_Command_Status_t sensors_compass(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 QCLI_Command_Status_t sensors_gyroscope(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 QCLI_Command_Status_t sensors_light(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+QCLI_Command_Status_t sensors_sample(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 #ifdef CONFIG_CDB_PLATFORM
 QCLI_Command_Status_t sensors_pir(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 QCLI_Command_Status_t sensors_read_all(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
@@ -36,6 +37,7 @@ const QCLI_Command_t sensors_cmd_list[] =
    { sensors_compass,      false,          "compass",                     "",                    "compass"   },
    { sensors_gyroscope,    false,          "gyroscope",                     "",                    "gyroscope"   },
    { sensors_light,        false,          "light",                     "",                    "light"   },
+   { sensors_sample,       false,          "sample",                       "<count> [humidity ms] [pressure ms] [compass ms] [gyroscope ms] [light ms]",   "sample sensors periodically"   },
 #ifdef CONFIG_CDB_PLATFORM
    { sensors_read_all,     false,          "read_sensors",                 "",                    "all sensor readings"   },
    { sensors_pir,          false,          "pir",                          "",                    "pir motion sensor"   },
@@ -152,3 +154,16 @@ QCLI_Command_Status_t sensors_light(uint32_t Parameter_Count, QCLI_Parameter_t *
     return QCLI_STATUS_SUCCESS_E;
 }
 
+QCLI_Command_Status_t sensors_sample(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    int32_t sensors_sampler_driver_test( uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List );
+    int32_t result;
+
+    result = sensors_sampler_driver_test(Parameter_Count, Parameter_List);
+    if (result != 0)
+    {
+        QCLI_Printf(qcli_sensors_group, "Sample fails\n");
+        return  QCLI_STATUS_ERROR_E;
+    }
+    return QCLI_STATUS_SUCCESS_E;
+}
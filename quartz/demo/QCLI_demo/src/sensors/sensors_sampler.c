@@ -0,0 +1,588 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * 2015-2016 Qualcomm Atheros, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#include <stdio.h>
+
+#include "qurt_signal.h"
+
+#include "qapi/qurt_thread.h"
+#include "stdint.h"
+#include <qcli.h>
+#include <qcli_api.h>
+#include <qurt_timer.h>
+
+#include    "qapi/qapi_status.h"
+
+#include <qapi_i2c_master.h>
+
+#include  "sensors.h"
+#include  "sensors_sampler.h"
+
+#define  I2CM_READY_SIG_MASK         0x10
+
+#define  SENSORS_SAMPLE_MAX_BURSTS		4
+#define  SENSORS_SAMPLE_RAW_SIZE		32
+
+#define  SENSORS_SAMPLER_DEFAULT_PERIOD_MS	1000
+
+extern  QCLI_Group_Handle_t qcli_sensors_group;              /* Handle for our QCLI Command Group. */
+extern  qurt_signal_t i2c_ready_signal;
+extern  volatile uint32_t i2c_transfer_status;
+extern  void    *h1;                                         /* I2C client handle */
+
+extern  qapi_I2CM_Config_t config_humidity;
+extern  qapi_I2CM_Config_t config_pressure;
+extern  qapi_I2CM_Config_t config_compass;
+extern  qapi_I2CM_Config_t config_gyroscope_LSM6DS3;
+extern  qapi_I2CM_Config_t config_light_LTR303ALS;
+
+extern  void I2CM_Transfer_cb(const uint32_t status, void *CB_Parameter);
+
+#ifdef CONFIG_CDB_PLATFORM
+extern  int32_t activate_onboard_sensors(void);
+extern  int32_t deactivate_onboard_sensors(void);
+#endif
+
+typedef struct sensors_reg_range {
+	uint8_t   reg;
+	uint8_t   len;
+} sensors_reg_range_t;
+
+typedef struct sensors_burst {
+	uint8_t   reg_addr;		/* register address sent to the sensor */
+	uint8_t   reg;			/* first register of the burst */
+	uint8_t   len;
+	uint8_t   offset;		/* offset of the first register in raw[] */
+} sensors_burst_t;
+
+typedef struct sensors_sampler_entry {
+	qapi_I2CM_Config_t         *config;
+	uint8_t                     auto_inc;		/* or'ed into reg_addr for bursts */
+	const sensors_reg_range_t  *calib_ranges;	/* read once, sorted by register */
+	uint8_t                     calib_count;
+	const sensors_reg_range_t  *data_ranges;	/* read every sample, sorted by register */
+	uint8_t                     data_count;
+
+	uint8_t                     calib_valid;
+	uint8_t                     num_calib_bursts;
+	uint8_t                     num_bursts;
+	sensors_burst_t             bursts[SENSORS_SAMPLE_MAX_BURSTS];
+	uint8_t                     raw[SENSORS_SAMPLE_RAW_SIZE];
+
+	uint32_t                    period_ms;
+	uint32_t                    next_ms;
+	uint8_t                     restart;
+} sensors_sampler_entry_t;
+
+/*
+ *  Registers read by each sensor
+ */
+static const sensors_reg_range_t humidity_calib[] = {
+	{ HUMIDITY_I2C_REG_ADDR_H0_rHx2, 4 },			/* H0_rHx2, H1_rHx2, T0_DegCx8, T1_DegCx8 */
+	{ HUMIDITY_I2C_REG_ADDR_T0_T1_MSB, 3 },		/* T0_T1_MSB, H0_T0_OUT */
+	{ HUMIDITY_I2C_REG_ADDR_H1_T0_OUT, 6 },		/* H1_T0_OUT, T0_OUT, T1_OUT */
+};
+
+static const sensors_reg_range_t humidity_data[] = {
+	{ HUMIDITY_I2C_REG_ADDR_H_OUT, 4 },			/* H_OUT, T_OUT */
+};
+
+static const sensors_reg_range_t pressure_calib[] = {
+	{ PRESSURE_I2C_REG_ADDR_dig_T1, 6 },			/* dig_T1, dig_T2, dig_T3 */
+};
+
+static const sensors_reg_range_t pressure_data[] = {
+	{ PRESSURE_I2C_REG_ADDR_PRESS, 3 },
+	{ PRESSURE_I2C_REG_ADDR_TEMP, 3 },
+};
+
+static const sensors_reg_range_t compass_data[] = {
+	{ COMPASS_I2C_REG_ADDR_ST1, 1 },
+	{ COMPASS_I2C_REG_ADDR_HX, 6 },
+	{ COMPASS_I2C_REG_ADDR_ST2, 1 },				/* reading ST2 ends the measurement */
+};
+
+static const sensors_reg_range_t gyroscope_data[] = {
+	{ LSM6DS3_I2C_REG_ADDR_OUT_TEMP, 14 },			/* temperature, gyroscope and accelerometer */
+};
+
+static const sensors_reg_range_t light_data[] = {
+	{ LTR303ALS_I2C_REG_ADDR_ALS_CONTR, 1 },		/* gain */
+	{ LTR303ALS_I2C_REG_ADDR_ALS_DATA_CH1_0, 4 },	/* CH1 must be read before CH0 */
+};
+
+#define  SENSORS_RANGES(ranges)		(ranges), (sizeof(ranges) / sizeof(ranges[0]))
+
+static sensors_sampler_entry_t sampler_entries[SENSORS_SAMPLE_NUM] = {
+	{ &config_humidity, 0x80, SENSORS_RANGES(humidity_calib), SENSORS_RANGES(humidity_data) },
+	{ &config_pressure, 0, SENSORS_RANGES(pressure_calib), SENSORS_RANGES(pressure_data) },
+	{ &config_compass, 0, NULL, 0, SENSORS_RANGES(compass_data) },
+	{ &config_gyroscope_LSM6DS3, 0, NULL, 0, SENSORS_RANGES(gyroscope_data) },
+	{ &config_light_LTR303ALS, 0, NULL, 0, SENSORS_RANGES(light_data) },
+};
+
+static uint8_t sampler_bursts_built = 0;
+
+/*
+ * Appends the ranges to the bursts of the entry, merging a range into the
+ * previous burst when it starts at most SENSORS_BURST_MAX_GAP registers after
+ * the end of that burst.
+ */
+static void sensors_sampler_merge(sensors_sampler_entry_t *entry, const sensors_reg_range_t *ranges, uint8_t count, uint8_t *offset)
+{
+	sensors_burst_t *burst = NULL;
+	uint32_t  end;
+	uint8_t   i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (burst != NULL && ranges[i].reg <= burst->reg + burst->len + SENSORS_BURST_MAX_GAP)
+		{
+			end = ranges[i].reg + ranges[i].len;
+			if (end > (uint32_t)(burst->reg + burst->len))
+			{
+				*offset += end - (burst->reg + burst->len);
+				burst->len = end - burst->reg;
+			}
+			continue;
+		}
+
+		if (entry->num_bursts >= SENSORS_SAMPLE_MAX_BURSTS || *offset + ranges[i].len > SENSORS_SAMPLE_RAW_SIZE)
+			break;
+
+		burst = &entry->bursts[entry->num_bursts++];
+		burst->reg_addr = ranges[i].reg | entry->auto_inc;
+		burst->reg = ranges[i].reg;
+		burst->len = ranges[i].len;
+		burst->offset = *offset;
+		*offset += ranges[i].len;
+	}
+}
+
+static void sensors_sampler_build_bursts()
+{
+	sensors_sampler_entry_t *entry;
+	uint8_t   offset;
+
+	if (sampler_bursts_built)
+		return;
+
+	for (entry = sampler_entries; entry < &sampler_entries[SENSORS_SAMPLE_NUM]; entry++)
+	{
+		offset = 0;
+		entry->num_bursts = 0;
+		sensors_sampler_merge(entry, entry->calib_ranges, entry->calib_count, &offset);
+		entry->num_calib_bursts = entry->num_bursts;
+		sensors_sampler_merge(entry, entry->data_ranges, entry->data_count, &offset);
+	}
+
+	sampler_bursts_built = 1;
+}
+
+/*
+ * Returns the value read from a register of the entry.
+ */
+static uint8_t sensors_sample_reg8(const sensors_sampler_entry_t *entry, uint8_t reg)
+{
+	const sensors_burst_t *burst;
+
+	for (burst = entry->bursts; burst < &entry->bursts[entry->num_bursts]; burst++)
+	{
+		if (reg >= burst->reg && reg < burst->reg + burst->len)
+			return entry->raw[burst->offset + reg - burst->reg];
+	}
+
+	return 0;
+}
+
+static uint16_t sensors_sample_reg16(const sensors_sampler_entry_t *entry, uint8_t reg)
+{
+	return sensors_sample_reg8(entry, reg) | ((uint16_t)sensors_sample_reg8(entry, reg + 1) << 8);
+}
+
+/*
+ * Reads all bursts of a sensor in a single transfer, the bursts being
+ * separated by repeated starts. The calibration bursts are only read until
+ * they have been read once.
+ */
+static int32_t sensors_sample_transfer(sensors_sampler_entry_t *entry)
+{
+	qapi_Status_t status;
+	qapi_I2CM_Descriptor_t desc[2 * SENSORS_SAMPLE_MAX_BURSTS];
+	sensors_burst_t *burst;
+	uint32_t  count = 0;
+	uint8_t   first;
+
+	first = entry->calib_valid ? entry->num_calib_bursts : 0;
+	for (burst = &entry->bursts[first]; burst < &entry->bursts[entry->num_bursts]; burst++)
+	{
+		desc[count].buffer = &burst->reg_addr;
+		desc[count].length = 1;
+		desc[count].transferred = 0;
+		desc[count].flags = QAPI_I2C_FLAG_START | QAPI_I2C_FLAG_WRITE;
+		count++;
+
+		desc[count].buffer = &entry->raw[burst->offset];
+		desc[count].length = burst->len;
+		desc[count].transferred = 0;
+		desc[count].flags = QAPI_I2C_FLAG_START | QAPI_I2C_FLAG_READ;
+		count++;
+	}
+
+	if (count == 0)
+		return 0;
+
+	desc[count - 1].flags |= QAPI_I2C_FLAG_STOP;
+	status = qapi_I2CM_Transfer(h1, entry->config, desc, count, I2CM_Transfer_cb, NULL);
+	if (status != QAPI_OK)
+	{
+		return -1;
+	}
+
+	qurt_signal_wait(&i2c_ready_signal, I2CM_READY_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);
+
+	// the callback runs in interrupt context, so the status is converted here
+	if (qapi_I2CM_Get_QStatus_Code(i2c_transfer_status) != QAPI_OK)
+		return -1;
+
+	entry->calib_valid = 1;
+	return 0;
+}
+
+uint32_t sensors_sample_read(uint32_t sensor_mask)
+{
+	uint32_t  read_mask = 0;
+	uint32_t  sensor;
+
+	sensors_sampler_build_bursts();
+
+	for (sensor = 0; sensor < SENSORS_SAMPLE_NUM; sensor++)
+	{
+		if ((sensor_mask & SENSORS_SAMPLE_MASK(sensor)) && sensors_sample_transfer(&sampler_entries[sensor]) == 0)
+			read_mask |= SENSORS_SAMPLE_MASK(sensor);
+	}
+
+	return read_mask;
+}
+
+/*
+ *  Compensation
+ */
+static void sensors_sample_compute_humidity(const sensors_sampler_entry_t *entry, sensors_sample_set_t *set)
+{
+	int32_t   T0_DegCx8, T1_DegCx8, H0_rHx2, H1_rHx2;
+	uint8_t   T0_T1_MSB;
+	int16_t   T0_OUT_val, T1_OUT_val, T_OUT_val;
+	int16_t   H0_T0_OUT_val, H1_T0_OUT_val, H_OUT_val;
+
+	T0_T1_MSB = sensors_sample_reg8(entry, HUMIDITY_I2C_REG_ADDR_T0_T1_MSB);
+	T0_DegCx8 = sensors_sample_reg8(entry, HUMIDITY_I2C_REG_ADDR_T0_DegCx8) | ((int32_t)(T0_T1_MSB & 3) << 8);
+	T1_DegCx8 = sensors_sample_reg8(entry, HUMIDITY_I2C_REG_ADDR_T1_DegCx8) | ((int32_t)((T0_T1_MSB >> 2) & 3) << 8);
+	T0_OUT_val = (int16_t)sensors_sample_reg16(entry, HUMIDITY_I2C_REG_ADDR_T0_OUT);
+	T1_OUT_val = (int16_t)sensors_sample_reg16(entry, HUMIDITY_I2C_REG_ADDR_T1_OUT);
+	T_OUT_val = (int16_t)sensors_sample_reg16(entry, HUMIDITY_I2C_REG_ADDR_T_OUT);
+
+	if (T1_OUT_val != T0_OUT_val)
+		set->humidity_temp_x10 = ((T1_DegCx8 - T0_DegCx8) * (T_OUT_val - T0_OUT_val) * 10 / (T1_OUT_val - T0_OUT_val) + T0_DegCx8 * 10) / 8;
+
+	H0_rHx2 = sensors_sample_reg8(entry, HUMIDITY_I2C_REG_ADDR_H0_rHx2);
+	H1_rHx2 = sensors_sample_reg8(entry, HUMIDITY_I2C_REG_ADDR_H1_rHx2);
+	H0_T0_OUT_val = (int16_t)sensors_sample_reg16(entry, HUMIDITY_I2C_REG_ADDR_H0_T0_OUT);
+	H1_T0_OUT_val = (int16_t)sensors_sample_reg16(entry, HUMIDITY_I2C_REG_ADDR_H1_T0_OUT);
+	H_OUT_val = (int16_t)sensors_sample_reg16(entry, HUMIDITY_I2C_REG_ADDR_H_OUT);
+
+	if (H1_T0_OUT_val != H0_T0_OUT_val)
+		set->humidity_rh_x10 = ((H1_rHx2 - H0_rHx2) * (H_OUT_val - H0_T0_OUT_val) * 10 / (H1_T0_OUT_val - H0_T0_OUT_val) + H0_rHx2 * 10) / 2;
+}
+
+static void sensors_sample_compute_pressure(const sensors_sampler_entry_t *entry, sensors_sample_set_t *set)
+{
+	set->pressure_up = ((uint32_t)sensors_sample_reg8(entry, PRESSURE_I2C_REG_ADDR_PRESS_MSB) << 12) |
+	                   ((uint32_t)sensors_sample_reg8(entry, PRESSURE_I2C_REG_ADDR_PRESS_LSB) << 4) |
+	                   ((sensors_sample_reg8(entry, PRESSURE_I2C_REG_ADDR_PRESS_XLSB) >> 4) & 0x0F);
+	set->pressure_ut = ((uint32_t)sensors_sample_reg8(entry, PRESSURE_I2C_REG_ADDR_TEMP_MSB) << 12) |
+	                   ((uint32_t)sensors_sample_reg8(entry, PRESSURE_I2C_REG_ADDR_TEMP_LSB) << 4) |
+	                   ((sensors_sample_reg8(entry, PRESSURE_I2C_REG_ADDR_TEMP_XLSB) >> 4) & 0x0F);
+
+	set->pressure_temp_x100 = bmp820_compensate_T(set->pressure_ut,
+	                                              sensors_sample_reg16(entry, PRESSURE_I2C_REG_ADDR_dig_T1),
+	                                              (int16_t)sensors_sample_reg16(entry, PRESSURE_I2C_REG_ADDR_dig_T2),
+	                                              (int16_t)sensors_sample_reg16(entry, PRESSURE_I2C_REG_ADDR_dig_T3));
+}
+
+static void sensors_sample_compute_compass(const sensors_sampler_entry_t *entry, sensors_sample_set_t *set)
+{
+	set->compass_hx = (int16_t)sensors_sample_reg16(entry, COMPASS_I2C_REG_ADDR_HX);
+	set->compass_hy = (int16_t)sensors_sample_reg16(entry, COMPASS_I2C_REG_ADDR_HY);
+	set->compass_hz = (int16_t)sensors_sample_reg16(entry, COMPASS_I2C_REG_ADDR_HZ);
+}
+
+static void sensors_sample_compute_gyroscope(const sensors_sampler_entry_t *entry, sensors_sample_set_t *set)
+{
+	set->gyroscope_temp = (int16_t)sensors_sample_reg16(entry, LSM6DS3_I2C_REG_ADDR_OUT_TEMP);
+	set->gyroscope_x = (int16_t)sensors_sample_reg16(entry, LSM6DS3_I2C_REG_ADDR_OUTX_G);
+	set->gyroscope_y = (int16_t)sensors_sample_reg16(entry, LSM6DS3_I2C_REG_ADDR_OUTY_G);
+	set->gyroscope_z = (int16_t)sensors_sample_reg16(entry, LSM6DS3_I2C_REG_ADDR_OUTZ_G);
+	set->accelerometer_x = (int16_t)sensors_sample_reg16(entry, LSM6DS3_I2C_REG_ADDR_OUTX_XL);
+	set->accelerometer_y = (int16_t)sensors_sample_reg16(entry, LSM6DS3_I2C_REG_ADDR_OUTY_XL);
+	set->accelerometer_z = (int16_t)sensors_sample_reg16(entry, LSM6DS3_I2C_REG_ADDR_OUTZ_XL);
+}
+
+static void sensors_sample_compute_light(const sensors_sampler_entry_t *entry, sensors_sample_set_t *set)
+{
+	uint8_t   gain;
+
+	set->light_ch1 = sensors_sample_reg16(entry, LTR303ALS_I2C_REG_ADDR_ALS_DATA_CH1_L);
+	set->light_ch0 = sensors_sample_reg16(entry, LTR303ALS_I2C_REG_ADDR_ALS_DATA_CH0_L);
+	gain = (sensors_sample_reg8(entry, LTR303ALS_I2C_REG_ADDR_ALS_CONTR) >> 2) & 0x07;
+
+	switch (gain)
+	{
+	case 0:
+	   set->light_lux = set->light_ch0;
+	   break;
+	case 1:
+	   set->light_lux = 5 * set->light_ch0 / 10;
+	   break;
+	case 2:
+	   set->light_lux = 25 * set->light_ch0 / 100;
+	   break;
+	case 3:
+	   set->light_lux = 125 * set->light_ch0 / 1000;
+	   break;
+	case 6:
+	   set->light_lux = 2 * set->light_ch0 / 100;
+	   break;
+	case 7:
+	   set->light_lux = 1 * set->light_ch0 / 100;
+	   break;
+	default:
+	   set->light_lux = 0;
+	   break;
+	}
+}
+
+void sensors_sample_compute(uint32_t sensor_mask, sensors_sample_set_t *set)
+{
+	set->sampled_mask = sensor_mask;
+
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_HUMIDITY))
+		sensors_sample_compute_humidity(&sampler_entries[SENSORS_SAMPLE_HUMIDITY], set);
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_PRESSURE))
+		sensors_sample_compute_pressure(&sampler_entries[SENSORS_SAMPLE_PRESSURE], set);
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_COMPASS))
+		sensors_sample_compute_compass(&sampler_entries[SENSORS_SAMPLE_COMPASS], set);
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_GYROSCOPE))
+		sensors_sample_compute_gyroscope(&sampler_entries[SENSORS_SAMPLE_GYROSCOPE], set);
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_LIGHT))
+		sensors_sample_compute_light(&sampler_entries[SENSORS_SAMPLE_LIGHT], set);
+}
+
+void sensors_sample_print(uint32_t sensor_mask, const sensors_sample_set_t *set)
+{
+	sensor_mask &= set->sampled_mask;
+
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_HUMIDITY))
+	{
+		QCLI_Printf(qcli_sensors_group, "Current Temperature:%d.%d\n", set->humidity_temp_x10 / 10, set->humidity_temp_x10 % 10);
+		QCLI_Printf(qcli_sensors_group, "Current rH:%d.%d%% rH\n", set->humidity_rh_x10 / 10, set->humidity_rh_x10 % 10);
+	}
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_PRESSURE))
+	{
+		QCLI_Printf(qcli_sensors_group, "Pressure=0x%08X\n", set->pressure_up);
+		QCLI_Printf(qcli_sensors_group, "Temp=0x%08X\n", set->pressure_ut);
+		QCLI_Printf(qcli_sensors_group, "Current Temp DegC=%d.%d\n", set->pressure_temp_x100 / 100, set->pressure_temp_x100 % 100);
+	}
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_COMPASS))
+	{
+		QCLI_Printf(qcli_sensors_group, "HX:%d   HY:%d   HZ:%d\n", set->compass_hx, set->compass_hy, set->compass_hz);
+	}
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_GYROSCOPE))
+	{
+		QCLI_Printf(qcli_sensors_group, "TEMP:%d   X_G:%d   Y_G:%d   Z_G:%d\n", set->gyroscope_temp, set->gyroscope_x, set->gyroscope_y, set->gyroscope_z);
+		QCLI_Printf(qcli_sensors_group, "X_XL:%d   Y_XL:%d   Z_XL:%d\n", set->accelerometer_x, set->accelerometer_y, set->accelerometer_z);
+	}
+	if (sensor_mask & SENSORS_SAMPLE_MASK(SENSORS_SAMPLE_LIGHT))
+	{
+		QCLI_Printf(qcli_sensors_group, "CH 1:%d   CH 0:%d\n", set->light_ch1, set->light_ch0);
+		QCLI_Printf(qcli_sensors_group, "Light ch0 Lux=%d\n", set->light_lux);
+	}
+}
+
+/*
+ *  Scheduler
+ */
+void sensors_sampler_set_period(uint32_t sensor, uint32_t period_ms)
+{
+	if (sensor >= SENSORS_SAMPLE_NUM)
+		return;
+
+	sampler_entries[sensor].period_ms = period_ms;
+	sampler_entries[sensor].restart = 1;
+}
+
+int32_t sensors_sampler_poll(uint32_t now_ms, sensors_sample_set_t *set, uint32_t *read_mask)
+{
+	qapi_Status_t status;
+	sensors_sampler_entry_t *entry;
+	uint32_t  due_mask = 0;
+	uint32_t  sensor;
+
+	*read_mask = 0;
+
+	for (sensor = 0; sensor < SENSORS_SAMPLE_NUM; sensor++)
+	{
+		entry = &sampler_entries[sensor];
+		if (entry->period_ms == 0)
+			continue;
+
+		if (entry->restart)
+		{
+			entry->next_ms = now_ms;
+			entry->restart = 0;
+		}
+
+		if ((int32_t)(now_ms - entry->next_ms) >= 0)
+			due_mask |= SENSORS_SAMPLE_MASK(sensor);
+	}
+
+	if (due_mask == 0)
+		return 0;
+
+	// read every due sensor on one acquisition of the bus
+#ifdef CONFIG_CDB_PLATFORM
+	status = qapi_I2CM_Open(QAPI_I2CM_INSTANCE_002_E, &h1);
+#else
+	status = qapi_I2CM_Open(QAPI_I2CM_INSTANCE_001_E, &h1);
+#endif
+	if (status != QAPI_OK)
+		return -1;
+
+	qurt_signal_init(&i2c_ready_signal);
+	*read_mask = sensors_sample_read(due_mask);
+	qurt_signal_delete(&i2c_ready_signal);
+	qapi_I2CM_Close(h1);
+
+	// compensate once the bus has been released
+	sensors_sample_compute(*read_mask, set);
+
+	for (sensor = 0; sensor < SENSORS_SAMPLE_NUM; sensor++)
+	{
+		entry = &sampler_entries[sensor];
+		if ((due_mask & SENSORS_SAMPLE_MASK(sensor)) == 0)
+			continue;
+
+		// skip the periods that were missed rather than sampling in a burst
+		entry->next_ms += entry->period_ms;
+		if ((int32_t)(now_ms - entry->next_ms) >= 0)
+			entry->next_ms = now_ms + entry->period_ms;
+	}
+
+	return 0;
+}
+
+uint32_t sensors_sampler_time_to_next(uint32_t now_ms)
+{
+	sensors_sampler_entry_t *entry;
+	uint32_t  wait_ms = 0xFFFFFFFF;
+	int32_t   delta;
+
+	for (entry = sampler_entries; entry < &sampler_entries[SENSORS_SAMPLE_NUM]; entry++)
+	{
+		if (entry->period_ms == 0)
+			continue;
+
+		delta = entry->restart ? 0 : (int32_t)(entry->next_ms - now_ms);
+		if (delta <= 0)
+			return 0;
+
+		if ((uint32_t)delta < wait_ms)
+			wait_ms = delta;
+	}
+
+	return wait_ms;
+}
+
+/*
+ * sample <count> [humidity ms] [pressure ms] [compass ms] [gyroscope ms] [light ms]
+ * Takes count sample sets. A sensor without a period is sampled every
+ * SENSORS_SAMPLER_DEFAULT_PERIOD_MS, a period of 0 disables it.
+ */
+int32_t sensors_sampler_driver_test(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+	sensors_sample_set_t set;
+	uint32_t  count, sensor, mask, now_ms, wait_ms;
+#ifdef CONFIG_CDB_PLATFORM
+	qapi_Status_t status;
+#endif
+
+	if (Parameter_Count < 1 || !Parameter_List[0].Integer_Is_Valid)
+	{
+		QCLI_Printf(qcli_sensors_group, "USAGE: sample <count> [humidity ms] [pressure ms] [compass ms] [gyroscope ms] [light ms]\n");
+		return -1;
+	}
+
+	count = Parameter_List[0].Integer_Value;
+	for (sensor = 0; sensor < SENSORS_SAMPLE_NUM; sensor++)
+	{
+		if (sensor + 1 < Parameter_Count && Parameter_List[sensor + 1].Integer_Is_Valid)
+			sensors_sampler_set_period(sensor, Parameter_List[sensor + 1].Integer_Value);
+		else
+			sensors_sampler_set_period(sensor, SENSORS_SAMPLER_DEFAULT_PERIOD_MS);
+	}
+
+#ifdef CONFIG_CDB_PLATFORM
+	status = qapi_I2CM_Open(QAPI_I2CM_INSTANCE_002_E, &h1);
+	if (status != QAPI_OK)
+		return -1;
+
+	qurt_signal_init(&i2c_ready_signal);
+	activate_onboard_sensors();
+	qurt_signal_delete(&i2c_ready_signal);
+	qapi_I2CM_Close(h1);
+#endif
+
+	while (count > 0)
+	{
+		now_ms = qurt_timer_convert_ticks_to_time(qurt_timer_get_ticks(), QURT_TIME_MSEC);
+		if (sensors_sampler_poll(now_ms, &set, &mask) != 0)
+		{
+			QCLI_Printf(qcli_sensors_group, "I2C open failed, sampling stopped\n");
+			break;
+		}
+
+		if (mask != 0)
+		{
+			QCLI_Printf(qcli_sensors_group, "\n  ------  Sample at %u ms ------\n", now_ms);
+			sensors_sample_print(mask, &set);
+			count--;
+			continue;
+		}
+
+		wait_ms = sensors_sampler_time_to_next(now_ms);
+		if (wait_ms == 0xFFFFFFFF)
+			break;
+
+		qurt_thread_sleep(qurt_timer_convert_time_to_ticks(wait_ms ? wait_ms : 1, QURT_TIME_MSEC));
+	}
+
+	for (sensor = 0; sensor < SENSORS_SAMPLE_NUM; sensor++)
+		sensors_sampler_set_period(sensor, 0);
+
+#ifdef CONFIG_CDB_PLATFORM
+	status = qapi_I2CM_Open(QAPI_I2CM_INSTANCE_002_E, &h1);
+	if (status != QAPI_OK)
+		return -1;
+
+	qurt_signal_init(&i2c_ready_signal);
+	deactivate_onboard_sensors();
+	qurt_signal_delete(&i2c_ready_signal);
+	qapi_I2CM_Close(h1);
+#endif
+
+	return 0;
+}
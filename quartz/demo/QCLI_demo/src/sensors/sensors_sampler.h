@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * 2015-2016 Qualcomm Atheros, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#ifndef __SENSORS_SAMPLER__H__
+#define __SENSORS_SAMPLER__H__
+
+#include "stdint.h"
+
+/*
+ * Sensors handled by the sampler
+ */
+#define  SENSORS_SAMPLE_HUMIDITY		0
+#define  SENSORS_SAMPLE_PRESSURE		1
+#define  SENSORS_SAMPLE_COMPASS			2
+#define  SENSORS_SAMPLE_GYROSCOPE		3
+#define  SENSORS_SAMPLE_LIGHT			4
+#define  SENSORS_SAMPLE_NUM				5
+
+#define  SENSORS_SAMPLE_MASK(sensor)	(1 << (sensor))
+#define  SENSORS_SAMPLE_ALL				((1 << SENSORS_SAMPLE_NUM) - 1)
+
+/*
+ * Registers of one sensor that are at most this many bytes apart are read
+ * in a single auto-increment burst. Clocking a few unused registers costs
+ * less than the restart, slave address and register address of another read.
+ */
+#define  SENSORS_BURST_MAX_GAP			4
+
+typedef struct sensors_sample_set {
+	uint32_t  sampled_mask;			/* sensors updated by the last read */
+
+	int32_t   humidity_temp_x10;	/* 0.1 DegC */
+	int32_t   humidity_rh_x10;		/* 0.1 %rH */
+
+	uint32_t  pressure_up;			/* raw 20 bit pressure */
+	uint32_t  pressure_ut;			/* raw 20 bit temperature */
+	int32_t   pressure_temp_x100;	/* 0.01 DegC */
+
+	int16_t   compass_hx;
+	int16_t   compass_hy;
+	int16_t   compass_hz;
+
+	int16_t   gyroscope_temp;
+	int16_t   gyroscope_x;
+	int16_t   gyroscope_y;
+	int16_t   gyroscope_z;
+	int16_t   accelerometer_x;
+	int16_t   accelerometer_y;
+	int16_t   accelerometer_z;
+
+	uint16_t  light_ch0;
+	uint16_t  light_ch1;
+	uint32_t  light_lux;
+} sensors_sample_set_t;
+
+/*
+ * Reads the registers of the sensors in sensor_mask, one I2C transfer per
+ * sensor. The I2C instance (h1) must already be open. Returns the mask of the
+ * sensors that were read.
+ */
+uint32_t sensors_sample_read(uint32_t sensor_mask);
+
+/*
+ * Converts the registers read by sensors_sample_read() into measured values.
+ * No I2C access is done so this can run after the bus has been released.
+ */
+void sensors_sample_compute(uint32_t sensor_mask, sensors_sample_set_t *set);
+
+void sensors_sample_print(uint32_t sensor_mask, const sensors_sample_set_t *set);
+
+/*
+ * Sets the sampling period of a sensor. A period of 0 stops sampling it.
+ */
+void sensors_sampler_set_period(uint32_t sensor, uint32_t period_ms);
+
+/*
+ * Samples every sensor that is due at now_ms. All of them are read back to
+ * back on one acquisition of the I2C bus and the compensation runs once the
+ * bus has been released. The mask of the sensors sampled is returned in
+ * read_mask. Returns -1 if the I2C bus could not be opened, 0 otherwise.
+ */
+int32_t sensors_sampler_poll(uint32_t now_ms, sensors_sample_set_t *set, uint32_t *read_mask);
+
+/*
+ * Returns the number of ms until the next sensor is due, 0xFFFFFFFF if no
+ * sensor is being sampled.
+ */
+uint32_t sensors_sampler_time_to_next(uint32_t now_ms);
+
+#endif
@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2016-2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#include <string.h>
+
+#include "ble_conn_table.h"
+
+#define HASH_MASK                                        (BLE_CONN_TABLE_HASH_SIZE - 1)
+#define NEXT_BUCKET(_x)                                  (((_x) + 1) & HASH_MASK)
+
+   /* The following MACROs return the entry stored at the specified     */
+   /* index and the keys stored in an entry.                            */
+#define ENTRY(_Table, _Index)                            ((void *)((_Table)->Pool + ((_Index) * (_Table)->EntrySize)))
+#define ENTRY_ADDRESS(_Table, _Entry)                    ((qapi_BLE_BD_ADDR_t *)((uint8_t *)(_Entry) + (_Table)->AddressOffset))
+#define ENTRY_CONNECTION_ID(_Table, _Entry)              ((unsigned int *)((uint8_t *)(_Entry) + (_Table)->ConnectionIDOffset))
+
+   /* Internal function prototypes.                                     */
+static unsigned int HashAddress(qapi_BLE_BD_ADDR_t Address);
+static unsigned int HashConnectionID(unsigned int ConnectionID);
+static unsigned int EntryIndex(BLE_Conn_Table_t *Table, void *Entry);
+static void IndexInsert(uint8_t *Index, unsigned int Bucket, unsigned int EntryIndex);
+static void IndexRemove(BLE_Conn_Table_t *Table, uint8_t *Index, unsigned int Bucket, unsigned int EntryIndex);
+
+   /* The following function returns the home bucket of a BD_ADDR.  The*/
+   /* low bytes of an address are the most random ones (and the only    */
+   /* random ones for static and private addresses) so all six bytes    */
+   /* are mixed together.                                               */
+static unsigned int HashAddress(qapi_BLE_BD_ADDR_t Address)
+{
+   uint32_t Hash;
+
+   Hash  = ((uint32_t)Address.BD_ADDR0) | ((uint32_t)Address.BD_ADDR1 << 8) | ((uint32_t)Address.BD_ADDR2 << 16) | ((uint32_t)Address.BD_ADDR3 << 24);
+   Hash ^= (((uint32_t)Address.BD_ADDR4) | ((uint32_t)Address.BD_ADDR5 << 8)) * 0x9E3779B1;
+   Hash *= 0x9E3779B1;
+
+   return((unsigned int)(Hash >> 16) & HASH_MASK);
+}
+
+   /* The following function returns the home bucket of a GATT          */
+   /* Connection ID.                                                    */
+static unsigned int HashConnectionID(unsigned int ConnectionID)
+{
+   return((unsigned int)(((uint32_t)ConnectionID * 0x9E3779B1) >> 16) & HASH_MASK);
+}
+
+   /* The following function returns the pool index of an entry.        */
+static unsigned int EntryIndex(BLE_Conn_Table_t *Table, void *Entry)
+{
+   return((unsigned int)((uint8_t *)Entry - Table->Pool) / Table->EntrySize);
+}
+
+   /* The following function stores an entry index in the first free    */
+   /* bucket of the probe sequence starting at the specified bucket.    */
+   /* * NOTE * An index never holds more than                           */
+   /*          BLE_CONN_TABLE_MAXIMUM_ENTRIES values so a free bucket   */
+   /*          always exists.                                           */
+static void IndexInsert(uint8_t *Index, unsigned int Bucket, unsigned int EntryIndex)
+{
+   while(Index[Bucket])
+      Bucket = NEXT_BUCKET(Bucket);
+
+   Index[Bucket] = (uint8_t)(EntryIndex + 1);
+}
+
+   /* The following function removes an entry index from an index.  The */
+   /* specified bucket is the home bucket of the key of the entry.  The */
+   /* entries that follow in the same probe run are shifted back so that*/
+   /* no deleted markers are needed and searches stay short.            */
+static void IndexRemove(BLE_Conn_Table_t *Table, uint8_t *Index, unsigned int Bucket, unsigned int EntryIndex)
+{
+   unsigned int Hole;
+   unsigned int Home;
+   void        *Entry;
+
+   /* Locate the bucket holding the entry.                              */
+   while((Index[Bucket]) && (Index[Bucket] != (uint8_t)(EntryIndex + 1)))
+      Bucket = NEXT_BUCKET(Bucket);
+
+   if(Index[Bucket])
+   {
+      Hole = Bucket;
+
+      while(Index[Bucket = NEXT_BUCKET(Bucket)])
+      {
+         /* Determine the home bucket of the entry stored here.         */
+         Entry = ENTRY(Table, Index[Bucket] - 1);
+         if(Index == Table->AddressIndex)
+            Home = HashAddress(*ENTRY_ADDRESS(Table, Entry));
+         else
+            Home = HashConnectionID(*ENTRY_CONNECTION_ID(Table, Entry));
+
+         /* The entry can move into the hole if its home bucket is not  */
+         /* cyclically between the hole and its current bucket.         */
+         if(((Bucket - Home) & HASH_MASK) >= ((Bucket - Hole) & HASH_MASK))
+         {
+            Index[Hole] = Index[Bucket];
+            Hole        = Bucket;
+         }
+      }
+
+      Index[Hole] = 0;
+   }
+}
+
+   /* The following function adds a new entry for the specified BD_ADDR */
+   /* to the table.  The entry is zero filled before the BD_ADDR is     */
+   /* stored in it.  This function returns NULL if the BD_ADDR is NULL, */
+   /* an entry for the BD_ADDR already exists or the table is full.     */
+void *BLE_Conn_Table_Add(BLE_Conn_Table_t *Table, qapi_BLE_BD_ADDR_t Address)
+{
+   void         *ret_val = NULL;
+   unsigned int  Index;
+
+   /* Verify that the passed in parameters seem semi-valid.             */
+   if((Table) && (!QAPI_BLE_COMPARE_NULL_BD_ADDR(Address)) && (BLE_Conn_Table_Search_Address(Table, Address) == NULL))
+   {
+      /* Find a free entry in the pool.                                 */
+      for(Index = 0; (Index < Table->NumberEntries) && (Index < BLE_CONN_TABLE_MAXIMUM_ENTRIES); Index++)
+      {
+         if(!Table->InUse[Index])
+         {
+            ret_val = ENTRY(Table, Index);
+
+            /* Initialize the entry.                                    */
+            memset(ret_val, 0, Table->EntrySize);
+            *ENTRY_ADDRESS(Table, ret_val) = Address;
+
+            /* Link the entry at the end of the table.                  */
+            Table->InUse[Index]    = 1;
+            Table->Next[Index]     = 0;
+            Table->Previous[Index] = Table->Tail;
+
+            if(Table->Tail)
+               Table->Next[Table->Tail - 1] = (uint8_t)(Index + 1);
+            else
+               Table->Head = (uint8_t)(Index + 1);
+
+            Table->Tail = (uint8_t)(Index + 1);
+            Table->EntryCount++;
+
+            /* A new entry is not connected, so only index the address. */
+            IndexInsert(Table->AddressIndex, HashAddress(Address), Index);
+            break;
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function removes the specified entry from the       */
+   /* table.  The memory of the entry is not modified until it is       */
+   /* reused by a later call to BLE_Conn_Table_Add().                   */
+void BLE_Conn_Table_Remove(BLE_Conn_Table_t *Table, void *Entry)
+{
+   unsigned int Index;
+
+   if((Table) && (Entry))
+   {
+      Index = EntryIndex(Table, Entry);
+
+      if((Index < BLE_CONN_TABLE_MAXIMUM_ENTRIES) && (Table->InUse[Index]))
+      {
+         /* Remove the entry from both indexes.                         */
+         IndexRemove(Table, Table->AddressIndex, HashAddress(*ENTRY_ADDRESS(Table, Entry)), Index);
+
+         if(*ENTRY_CONNECTION_ID(Table, Entry))
+            IndexRemove(Table, Table->ConnectionIDIndex, HashConnectionID(*ENTRY_CONNECTION_ID(Table, Entry)), Index);
+
+         /* Unlink the entry.                                           */
+         if(Table->Previous[Index])
+            Table->Next[Table->Previous[Index] - 1] = Table->Next[Index];
+         else
+            Table->Head = Table->Next[Index];
+
+         if(Table->Next[Index])
+            Table->Previous[Table->Next[Index] - 1] = Table->Previous[Index];
+         else
+            Table->Tail = Table->Previous[Index];
+
+         Table->InUse[Index] = 0;
+         Table->EntryCount--;
+      }
+   }
+}
+
+   /* The following function removes every entry from the table.        */
+void BLE_Conn_Table_Clear(BLE_Conn_Table_t *Table)
+{
+   if(Table)
+   {
+      Table->EntryCount = 0;
+      Table->Head       = 0;
+      Table->Tail       = 0;
+
+      memset(Table->InUse, 0, sizeof(Table->InUse));
+      memset(Table->AddressIndex, 0, sizeof(Table->AddressIndex));
+      memset(Table->ConnectionIDIndex, 0, sizeof(Table->ConnectionIDIndex));
+   }
+}
+
+   /* The following function returns the entry with the specified      */
+   /* BD_ADDR, or NULL if there is none.                                */
+void *BLE_Conn_Table_Search_Address(BLE_Conn_Table_t *Table, qapi_BLE_BD_ADDR_t Address)
+{
+   void         *ret_val = NULL;
+   void         *Entry;
+   unsigned int  Bucket;
+
+   if(Table)
+   {
+      Bucket = HashAddress(Address);
+
+      while(Table->AddressIndex[Bucket])
+      {
+         Entry = ENTRY(Table, Table->AddressIndex[Bucket] - 1);
+
+         if(QAPI_BLE_COMPARE_BD_ADDR(*ENTRY_ADDRESS(Table, Entry), Address))
+         {
+            ret_val = Entry;
+            break;
+         }
+
+         Bucket = NEXT_BUCKET(Bucket);
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the entry with the specified GATT  */
+   /* Connection ID, or NULL if there is none.  A Connection ID of zero */
+   /* never matches as it flags a disconnected remote device.           */
+void *BLE_Conn_Table_Search_ConnectionID(BLE_Conn_Table_t *Table, unsigned int ConnectionID)
+{
+   void         *ret_val = NULL;
+   void         *Entry;
+   unsigned int  Bucket;
+
+   if((Table) && (ConnectionID))
+   {
+      Bucket = HashConnectionID(ConnectionID);
+
+      while(Table->ConnectionIDIndex[Bucket])
+      {
+         Entry = ENTRY(Table, Table->ConnectionIDIndex[Bucket] - 1);
+
+         if(*ENTRY_CONNECTION_ID(Table, Entry) == ConnectionID)
+         {
+            ret_val = Entry;
+            break;
+         }
+
+         Bucket = NEXT_BUCKET(Bucket);
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function changes the BD_ADDR stored in an entry.    */
+void BLE_Conn_Table_Set_Address(BLE_Conn_Table_t *Table, void *Entry, qapi_BLE_BD_ADDR_t Address)
+{
+   unsigned int Index;
+
+   if((Table) && (Entry))
+   {
+      Index = EntryIndex(Table, Entry);
+
+      if((Index < BLE_CONN_TABLE_MAXIMUM_ENTRIES) && (Table->InUse[Index]) && (!QAPI_BLE_COMPARE_BD_ADDR(*ENTRY_ADDRESS(Table, Entry), Address)))
+      {
+         IndexRemove(Table, Table->AddressIndex, HashAddress(*ENTRY_ADDRESS(Table, Entry)), Index);
+
+         *ENTRY_ADDRESS(Table, Entry) = Address;
+
+         IndexInsert(Table->AddressIndex, HashAddress(Address), Index);
+      }
+   }
+}
+
+   /* The following function changes the GATT Connection ID stored in   */
+   /* an entry.  Zero flags that the remote device is disconnected.     */
+void BLE_Conn_Table_Set_ConnectionID(BLE_Conn_Table_t *Table, void *Entry, unsigned int ConnectionID)
+{
+   unsigned int Index;
+
+   if((Table) && (Entry))
+   {
+      Index = EntryIndex(Table, Entry);
+
+      if((Index < BLE_CONN_TABLE_MAXIMUM_ENTRIES) && (Table->InUse[Index]) && (*ENTRY_CONNECTION_ID(Table, Entry) != ConnectionID))
+      {
+         /* Only connected entries are kept in the Connection ID index. */
+         if(*ENTRY_CONNECTION_ID(Table, Entry))
+            IndexRemove(Table, Table->ConnectionIDIndex, HashConnectionID(*ENTRY_CONNECTION_ID(Table, Entry)), Index);
+
+         *ENTRY_CONNECTION_ID(Table, Entry) = ConnectionID;
+
+         if(ConnectionID)
+            IndexInsert(Table->ConnectionIDIndex, HashConnectionID(ConnectionID), Index);
+      }
+   }
+}
+
+   /* The following function returns the oldest entry of the table.     */
+void *BLE_Conn_Table_First(BLE_Conn_Table_t *Table)
+{
+   return(((Table) && (Table->Head)) ? ENTRY(Table, Table->Head - 1) : NULL);
+}
+
+   /* The following function returns the entry added after the specified*/
+   /* one.                                                              */
+void *BLE_Conn_Table_Next(BLE_Conn_Table_t *Table, void *Entry)
+{
+   void         *ret_val = NULL;
+   unsigned int  Index;
+
+   if((Table) && (Entry))
+   {
+      Index = EntryIndex(Table, Entry);
+
+      if((Index < BLE_CONN_TABLE_MAXIMUM_ENTRIES) && (Table->Next[Index]))
+         ret_val = ENTRY(Table, Table->Next[Index] - 1);
+   }
+
+   return(ret_val);
+}
+
+   /* The following function returns the number of entries in the table.*/
+unsigned int BLE_Conn_Table_Count(BLE_Conn_Table_t *Table)
+{
+   return((Table) ? Table->EntryCount : 0);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2016-2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ * Confidential and Proprietary - Qualcomm Technologies, Inc.
+ */
+
+#ifndef __BLECONNTABLEH__
+#define __BLECONNTABLEH__
+
+#include "qapi_types.h"
+#include "qapi_ble.h"
+
+   /* The following constant defines the maximum number of entries a    */
+   /* connection table can hold.  Entries are referenced by a one byte  */
+   /* index so this value MUST NOT be larger than 255.                  */
+#define BLE_CONN_TABLE_MAXIMUM_ENTRIES                   (32)
+
+   /* The following constant defines the number of buckets of each of   */
+   /* the two hash indexes.  This MUST be a power of two and at least   */
+   /* twice BLE_CONN_TABLE_MAXIMUM_ENTRIES so that probe sequences stay */
+   /* short.                                                            */
+#define BLE_CONN_TABLE_HASH_SIZE                         (64)
+
+   /* The following structure holds a connection table.  A connection   */
+   /* table is a fixed pool of caller defined entries (for example the  */
+   /* remote device information of a demo) that can be looked up in    */
+   /* constant time by the remote BD_ADDR and by the GATT Connection ID */
+   /* stored in each entry.  The table finds the two keys in an entry   */
+   /* through the structure offsets given to BLE_CONN_TABLE_INITIALIZER.*/
+   /* * NOTE * The table does no locking.  The caller is expected to    */
+   /*          hold the Bluetooth stack lock, as it did for the generic */
+   /*          lists this replaces.                                     */
+   /* * NOTE * The index fields hold an entry index plus one so that a  */
+   /*          zero filled table is a valid empty table.                */
+typedef struct _tagBLE_Conn_Table_t
+{
+   uint8_t      *Pool;
+   unsigned int  EntrySize;
+   unsigned int  NumberEntries;
+   unsigned int  AddressOffset;
+   unsigned int  ConnectionIDOffset;
+   unsigned int  EntryCount;
+   uint8_t       Head;
+   uint8_t       Tail;
+   uint8_t       InUse[BLE_CONN_TABLE_MAXIMUM_ENTRIES];
+   uint8_t       Next[BLE_CONN_TABLE_MAXIMUM_ENTRIES];
+   uint8_t       Previous[BLE_CONN_TABLE_MAXIMUM_ENTRIES];
+   uint8_t       AddressIndex[BLE_CONN_TABLE_HASH_SIZE];
+   uint8_t       ConnectionIDIndex[BLE_CONN_TABLE_HASH_SIZE];
+} BLE_Conn_Table_t;
+
+   /* The following MACRO is a utility MACRO that statically            */
+   /* initializes a connection table.  The first parameter is the array */
+   /* of entries that backs the table.  The second parameter is the     */
+   /* entry type.  The last two parameters are the names of the         */
+   /* qapi_BLE_BD_ADDR_t and unsigned int Connection ID members of the  */
+   /* entry type.                                                       */
+#define BLE_CONN_TABLE_INITIALIZER(_Pool, _Type, _Address, _ConnectionID)                 \
+   {                                                                                        \
+      (uint8_t *)(_Pool),                                                                   \
+      sizeof(_Type),                                                                        \
+      (sizeof(_Pool) / sizeof(_Type)),                                                      \
+      QAPI_BLE_BTPS_STRUCTURE_OFFSET(_Type, _Address),                                      \
+      QAPI_BLE_BTPS_STRUCTURE_OFFSET(_Type, _ConnectionID)                                  \
+   }
+
+   /* The following function adds a new entry for the specified BD_ADDR */
+   /* to the table.  The entry is zero filled before the BD_ADDR is     */
+   /* stored in it.  This function returns NULL if the BD_ADDR is NULL, */
+   /* an entry for the BD_ADDR already exists or the table is full.     */
+void *BLE_Conn_Table_Add(BLE_Conn_Table_t *Table, qapi_BLE_BD_ADDR_t Address);
+
+   /* The following function removes the specified entry from the       */
+   /* table.  The memory of the entry is not modified until it is       */
+   /* reused by a later call to BLE_Conn_Table_Add().                   */
+void BLE_Conn_Table_Remove(BLE_Conn_Table_t *Table, void *Entry);
+
+   /* The following function removes every entry from the table.        */
+void BLE_Conn_Table_Clear(BLE_Conn_Table_t *Table);
+
+   /* The following function returns the entry with the specified      */
+   /* BD_ADDR, or NULL if there is none.                                */
+void *BLE_Conn_Table_Search_Address(BLE_Conn_Table_t *Table, qapi_BLE_BD_ADDR_t Address);
+
+   /* The following function returns the entry with the specified GATT  */
+   /* Connection ID, or NULL if there is none.  A Connection ID of zero */
+   /* never matches as it flags a disconnected remote device.           */
+void *BLE_Conn_Table_Search_ConnectionID(BLE_Conn_Table_t *Table, unsigned int ConnectionID);
+
+   /* The following function changes the BD_ADDR stored in an entry.    */
+   /* * NOTE * The BD_ADDR member of an entry MUST only be changed with */
+   /*          this function.                                           */
+void BLE_Conn_Table_Set_Address(BLE_Conn_Table_t *Table, void *Entry, qapi_BLE_BD_ADDR_t Address);
+
+   /* The following function changes the GATT Connection ID stored in   */
+   /* an entry.  Zero flags that the remote device is disconnected.     */
+   /* * NOTE * The Connection ID member of an entry MUST only be        */
+   /*          changed with this function.                              */
+void BLE_Conn_Table_Set_ConnectionID(BLE_Conn_Table_t *Table, void *Entry, unsigned int ConnectionID);
+
+   /* The following functions walk the entries in the order they were   */
+   /* added.  BLE_Conn_Table_First() returns the oldest entry and       */
+   /* BLE_Conn_Table_Next() the entry added after the specified one.    */
+   /* Both return NULL at the end of the table.                         */
+void *BLE_Conn_Table_First(BLE_Conn_Table_t *Table);
+void *BLE_Conn_Table_Next(BLE_Conn_Table_t *Table, void *Entry);
+
+   /* The following function returns the number of entries in the table.*/
+unsigned int BLE_Conn_Table_Count(BLE_Conn_Table_t *Table);
+
+#endif
@@ -14,6 +14,8 @@
 #include "string.h"
 
 #define BLE_OTA_TIMEOUT                               (qurt_timer_convert_time_to_ticks(180000, QURT_TIME_MSEC))
+#define BLE_OTA_REQUEST_TIMEOUT                       (qurt_timer_convert_time_to_ticks(5000, QURT_TIME_MSEC))
+#define BLE_OTA_MAXIMUM_REQUEST_RETRIES               (3)
 
 #define READ_UNALIGNED_BYTE_LITTLE_ENDIAN(_x)   (((uint8_t *)(_x))[0])
 #define READ_UNALIGNED_WORD_LITTLE_ENDIAN(_x)   ((uint16_t)((((uint16_t)(((uint8_t *)(_x))[1])) << 8) | ((uint16_t)(((uint8_t *)(_x))[0]))))
@@ -73,6 +75,23 @@ typedef struct BLE_OTA_Server_Context_s
 #define BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_SUCCESS              0x0010
 #define BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_FAILURE              0x0020
 
+#define BLE_OTA_CLIENT_REQUEST_STATE_FREE                               0x00
+#define BLE_OTA_CLIENT_REQUEST_STATE_PENDING                            0x01
+#define BLE_OTA_CLIENT_REQUEST_STATE_RECEIVED                           0x02
+
+   /* One outstanding image data request.  State is written to PENDING */
+   /* by the reading thread and to RECEIVED by the indication callback, */
+   /* the other fields are only written while the request is not       */
+   /* pending.                                                          */
+typedef struct BLE_OTA_Client_Request_s
+{
+   volatile uint8_t State;
+   uint8_t          Retries;
+   uint16_t         DataLength;
+   uint32_t         FileOffset;
+   qurt_time_t      SendTime;
+} BLE_OTA_Client_Request_t;
+
 typedef struct BLE_OTA_Client_Service_Information_s
 {
    uint32_t ServerConnectionID;
@@ -90,10 +109,12 @@ typedef struct BLE_OTA_Client_Context_s
    uint16_t                             Discovered_Control_Point_CCD;
    qurt_signal_t                        Signal;
    qurt_mutex_t                         Mutex;
+   qurt_mutex_t                         RequestMutex;
    uint8_t                             *DataBuffer;
    uint32_t                             DataBufferLength;
    uint32_t                             CurrentImageOffset;
-   uint32_t                             BytesReceived;
+   volatile uint32_t                    BytesReceived;
+   BLE_OTA_Client_Request_t             Request[BLE_OTA_MAXIMUM_OUTSTANDING_REQUESTS];
    uint32_t                             QueriedImageID;
    uint32_t                             QueriedImageLength;
    uint32_t                             QueriedImageVersion;
@@ -180,8 +201,6 @@ static uint32_t GetNextImageID(void);
 
 static uint8_t  SendImageDataRequest(uint32_t BluetoothStackID, BLE_OTA_Client_Service_Information_t *ServiceInfo, uint32_t ImageID, uint32_t DataLength, uint32_t FileOffset);
 
-static uint32_t GetImageDataResponse(void);
-
 static BLE_OTA_Server_Client_Information_t *FindClientInformation(uint32_t ClientConnectionID)
 {
    uint8_t                              Index;
@@ -551,31 +570,50 @@ static void HandleImageQueryResponse(uint8_t *Data, uint16_t Length)
 
 static void HandleImageReadResponse(uint8_t *Data, uint16_t Length)
 {
-   uint32_t FileOffset;
-   uint32_t DataLength;
-   uint32_t CurrentImageOffset;
+   uint32_t                  Index;
+   uint32_t                  FileOffset;
+   uint32_t                  DataLength;
+   BLE_OTA_Client_Request_t *Request;
 
    if(READ_UNALIGNED_BYTE_LITTLE_ENDIAN(&((BLE_OTA_Command_Read_Image_Data_Response_t *)Data)->Status) == BLE_OTA_STATUS_SUCCESS)
    {
       FileOffset = READ_UNALIGNED_DWORD_LITTLE_ENDIAN(&((BLE_OTA_Command_Read_Image_Data_Response_t *)Data)->FileOffset);
       DataLength = READ_UNALIGNED_WORD_LITTLE_ENDIAN( &((BLE_OTA_Command_Read_Image_Data_Response_t *)Data)->DataLength);
 
-      CurrentImageOffset = BLEOTAClientContext.CurrentImageOffset;
-
-      if((FileOffset >= CurrentImageOffset) && ((FileOffset - CurrentImageOffset + DataLength) <= BLEOTAClientContext.DataBufferLength))
+      /* The request states and the caller's buffer are only changed   */
+      /* with the request mutex held, so the buffer cannot be released */
+      /* while the response is copied into it.                          */
+      if(qurt_mutex_lock_timed(&BLEOTAClientContext.RequestMutex, QURT_TIME_WAIT_FOREVER) == QURT_EOK)
       {
-         /* Copy the data. */
-         memcpy(&BLEOTAClientContext.DataBuffer[FileOffset - CurrentImageOffset], &((BLE_OTA_Command_Read_Image_Data_Response_t *)Data)->Data, DataLength);
+         /* Find the outstanding request this response answers.         */
+         /* Responses may arrive in any order, and a request that was    */
+         /* retried may be answered twice, so a response that does not   */
+         /* match a pending request is dropped.                          */
+         for(Index = 0, Request = NULL; Index < BLE_OTA_MAXIMUM_OUTSTANDING_REQUESTS; Index++)
+         {
+            if((BLEOTAClientContext.Request[Index].State == BLE_OTA_CLIENT_REQUEST_STATE_PENDING) && (BLEOTAClientContext.Request[Index].FileOffset == FileOffset) && (BLEOTAClientContext.Request[Index].DataLength == DataLength))
+            {
+               Request = &BLEOTAClientContext.Request[Index];
+               break;
+            }
+         }
 
-         BLEOTAClientContext.BytesReceived = DataLength;
+         if((Request) && (BLEOTAClientContext.DataBuffer) && (Length >= BLE_OTA_COMMAND_READ_IMAGE_DATA_RESPONSE_SIZE(DataLength)) && (FileOffset >= BLEOTAClientContext.CurrentImageOffset) && ((FileOffset - BLEOTAClientContext.CurrentImageOffset + DataLength) <= BLEOTAClientContext.DataBufferLength))
+         {
+            /* Copy the data to its place in the buffer. */
+            memcpy(&BLEOTAClientContext.DataBuffer[FileOffset - BLEOTAClientContext.CurrentImageOffset], &((BLE_OTA_Command_Read_Image_Data_Response_t *)Data)->Data, DataLength);
 
-         /* Success if we found the image. */
-         qurt_signal_set(&BLEOTAClientContext.Signal, BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_SUCCESS);
-      }
-      else
-      {
-         /* Signal failure if we got an unexpected value. */
-         qurt_signal_set(&BLEOTAClientContext.Signal, BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_FAILURE);
+            BLEOTAClientContext.BytesReceived += DataLength;
+            Request->State                     = BLE_OTA_CLIENT_REQUEST_STATE_RECEIVED;
+         }
+         else
+            Request = NULL;
+
+         qurt_mutex_unlock(&BLEOTAClientContext.RequestMutex);
+
+         /* Wake the reader so it can refill the window. */
+         if(Request)
+            qurt_signal_set(&BLEOTAClientContext.Signal, BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_SUCCESS);
       }
    }
    else
@@ -1032,6 +1070,7 @@ uint8_t BLE_OTA_Initialize_Client(uint32_t BluetoothStackID)
    {
       /* Create mutex/signal. */
       qurt_mutex_init(&BLEOTAClientContext.Mutex);
+      qurt_mutex_init(&BLEOTAClientContext.RequestMutex);
       qurt_signal_init(&BLEOTAClientContext.Signal);
 
       /* Register for connection events. */
@@ -1049,6 +1088,7 @@ uint8_t BLE_OTA_Initialize_Client(uint32_t BluetoothStackID)
       else
       {
          qurt_mutex_destroy(&BLEOTAClientContext.Mutex);
+         qurt_mutex_destroy(&BLEOTAClientContext.RequestMutex);
          qurt_signal_destroy(&BLEOTAClientContext.Signal);
          RetVal = BLE_OTA_STATUS_FAILURE;
       }
@@ -1065,6 +1105,7 @@ void BLE_OTA_Cleanup_Client(uint32_t BluetoothStackID)
    {
       /* Cleanup mutex/signal. */
       qurt_mutex_destroy(&BLEOTAClientContext.Mutex);
+      qurt_mutex_destroy(&BLEOTAClientContext.RequestMutex);
       qurt_signal_destroy(&BLEOTAClientContext.Signal);
 
       /* Unregister for events. */
@@ -1293,35 +1334,17 @@ static uint8_t SendImageDataRequest(uint32_t BluetoothStackID, BLE_OTA_Client_Se
    return(RetVal);
 }
 
-static uint32_t GetImageDataResponse(void)
-{
-   int       Result;
-   uint32_t  CurrSignals;
-   uint32_t  RetVal;
-
-   /* Wait on the result. */
-   Result = qurt_signal_wait_timed(&BLEOTAClientContext.Signal, (BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_SUCCESS | BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_FAILURE), QURT_SIGNAL_ATTR_CLEAR_MASK, &CurrSignals, BLE_OTA_TIMEOUT);
-
-   /* Check if an image was found. */
-   if((Result == QURT_EOK) && (CurrSignals & BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_SUCCESS))
-   {
-      /* Return success. */
-      RetVal = BLEOTAClientContext.BytesReceived;
-   }
-   else
-   {
-      RetVal = 0;
-   }
-
-   return(RetVal);
-}
-
 uint8_t BLE_OTA_Read_Image_Data(uint32_t BluetoothStackID, uint32_t ConnectionID, uint32_t ImageID, uint8_t *DataBuffer, uint32_t *DataLength, uint32_t FileOffset)
 {
+   int                                   Result;
    uint8_t                               RetVal;
-   uint32_t                              BytesRemaining;
-   uint32_t                              RequestDataLength;
-   uint32_t                              ResponseDataLength;
+   uint32_t                              Index;
+   uint32_t                              CurrSignals;
+   uint32_t                              ChunkLength;
+   uint32_t                              NextOffset;
+   uint32_t                              EndOffset;
+   qurt_time_t                           CurrentTime;
+   BLE_OTA_Client_Request_t             *Request;
    BLE_OTA_Client_Service_Information_t *ServiceInfo;
 
    if((BluetoothStackID) && (ImageID) && (DataBuffer) && (DataLength) && (BLEOTAClientContext.Flags & BLE_OTA_CLIENT_CONTEXT_FLAGS_INITIALIZED))
@@ -1332,49 +1355,127 @@ uint8_t BLE_OTA_Read_Image_Data(uint32_t BluetoothStackID, uint32_t ConnectionID
          /* Get the context mutex. */
          if(qurt_mutex_lock_timed(&BLEOTAClientContext.Mutex, QURT_TIME_WAIT_FOREVER) == QURT_EOK)
          {
-            /* Initialize variables. */
+            NextOffset = FileOffset;
+            EndOffset  = FileOffset + *DataLength;
+
+            /* Clear any stale request before the new buffer is          */
+            /* published so a late response cannot match against it.     */
+            qurt_mutex_lock_timed(&BLEOTAClientContext.RequestMutex, QURT_TIME_WAIT_FOREVER);
+
+            for(Index = 0; Index < BLE_OTA_MAXIMUM_OUTSTANDING_REQUESTS; Index++)
+               BLEOTAClientContext.Request[Index].State = BLE_OTA_CLIENT_REQUEST_STATE_FREE;
+
             BLEOTAClientContext.CurrentImageOffset =  FileOffset;
             BLEOTAClientContext.DataBuffer         =  DataBuffer;
             BLEOTAClientContext.DataBufferLength   = *DataLength;
-            BytesRemaining                         = *DataLength;
+            BLEOTAClientContext.BytesReceived      =  0;
+
+            qurt_mutex_unlock(&BLEOTAClientContext.RequestMutex);
+
+            qurt_signal_clear(&BLEOTAClientContext.Signal, (BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_SUCCESS | BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_FAILURE));
 
             if(qapi_BLE_GATT_Query_Connection_MTU(BluetoothStackID, ConnectionID, &ServiceInfo->MTU) == 0)
             {
-               while(BytesRemaining)
+               /* Size each request so its response fills the MTU. */
+               ChunkLength = (ServiceInfo->MTU-3) - BLE_OTA_COMMAND_READ_IMAGE_DATA_RESPONSE_SIZE(0);
+               RetVal      = BLE_OTA_STATUS_SUCCESS;
+
+               while((RetVal == BLE_OTA_STATUS_SUCCESS) && (BLEOTAClientContext.BytesReceived < BLEOTAClientContext.DataBufferLength))
                {
-                  /* Make sure the response will be equal to the MTU size when possible. */
-                  if(BLE_OTA_COMMAND_READ_IMAGE_DATA_RESPONSE_SIZE(BytesRemaining) > (ServiceInfo->MTU-3))
-                     RequestDataLength = (ServiceInfo->MTU-3) - BLE_OTA_COMMAND_READ_IMAGE_DATA_RESPONSE_SIZE(0);
-                  else
-                     RequestDataLength = BytesRemaining;
+                  CurrentTime = qurt_timer_get_ticks();
 
-                  /* Send a data request. */
-                  if(SendImageDataRequest(BluetoothStackID, ServiceInfo, ImageID, RequestDataLength, (BLEOTAClientContext.CurrentImageOffset + (*DataLength - BytesRemaining))) == BLE_OTA_STATUS_SUCCESS)
+                  /* Keep the window full and resend only the requests */
+                  /* that have gone unanswered for too long.           */
+                  for(Index = 0; (RetVal == BLE_OTA_STATUS_SUCCESS) && (Index < BLE_OTA_MAXIMUM_OUTSTANDING_REQUESTS); Index++)
                   {
-                     /* Wait for the response. */
-                     if((ResponseDataLength = GetImageDataResponse()) > 0)
+                     Request = &BLEOTAClientContext.Request[Index];
+
+                     /* The request is updated with the request mutex    */
+                     /* held, but it is released before the request is  */
+                     /* sent so the stack is never called with it held.  */
+                     qurt_mutex_lock_timed(&BLEOTAClientContext.RequestMutex, QURT_TIME_WAIT_FOREVER);
+
+                     if(Request->State != BLE_OTA_CLIENT_REQUEST_STATE_PENDING)
                      {
-                        BytesRemaining -= RequestDataLength;
+                        if(NextOffset == EndOffset)
+                        {
+                           qurt_mutex_unlock(&BLEOTAClientContext.RequestMutex);
+                           continue;
+                        }
+
+                        Request->FileOffset = NextOffset;
+                        Request->Retries    = 0;
+
+                        if((EndOffset - NextOffset) > ChunkLength)
+                           Request->DataLength = ChunkLength;
+                        else
+                           Request->DataLength = EndOffset - NextOffset;
+
+                        NextOffset += Request->DataLength;
                      }
                      else
                      {
-                        RetVal = BLE_OTA_STATUS_FAILURE;
-                        break;
+                        if((CurrentTime - Request->SendTime) < BLE_OTA_REQUEST_TIMEOUT)
+                        {
+                           qurt_mutex_unlock(&BLEOTAClientContext.RequestMutex);
+                           continue;
+                        }
+
+                        if(Request->Retries++ == BLE_OTA_MAXIMUM_REQUEST_RETRIES)
+                        {
+                           qurt_mutex_unlock(&BLEOTAClientContext.RequestMutex);
+                           RetVal = BLE_OTA_STATUS_FAILURE;
+                           break;
+                        }
                      }
+
+                     /* Send a data request. */
+                     Request->SendTime = CurrentTime;
+                     Request->State    = BLE_OTA_CLIENT_REQUEST_STATE_PENDING;
+
+                     qurt_mutex_unlock(&BLEOTAClientContext.RequestMutex);
+
+                     if(SendImageDataRequest(BluetoothStackID, ServiceInfo, ImageID, Request->DataLength, Request->FileOffset) != BLE_OTA_STATUS_SUCCESS)
+                        RetVal = BLE_OTA_STATUS_OUT_OF_MEMORY;
                   }
-                  else
+
+                  if((RetVal == BLE_OTA_STATUS_SUCCESS) && (BLEOTAClientContext.BytesReceived < BLEOTAClientContext.DataBufferLength))
                   {
-                     RetVal = BLE_OTA_STATUS_OUT_OF_MEMORY;
-                     break;
+                     /* Wait for the next response, or until a request */
+                     /* may need to be resent.                         */
+                     Result = qurt_signal_wait_timed(&BLEOTAClientContext.Signal, (BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_SUCCESS | BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_FAILURE), QURT_SIGNAL_ATTR_CLEAR_MASK, &CurrSignals, BLE_OTA_REQUEST_TIMEOUT);
+
+                     if((Result == QURT_EOK) && (CurrSignals & BLE_OTA_CLIENT_EVENT_FLAGS_READ_IMAGE_DATA_FAILURE))
+                        RetVal = BLE_OTA_STATUS_FAILURE;
                   }
                }
 
-               /* Flag success if all data was read. */
-               if(!BytesRemaining)
-                  RetVal = BLE_OTA_STATUS_SUCCESS;
+               /* Drop any request still outstanding and forget the     */
+               /* caller's buffer so a late response is not copied to   */
+               /* it.  On failure only the data up to the first missing */
+               /* request is reported.                                   */
+               qurt_mutex_lock_timed(&BLEOTAClientContext.RequestMutex, QURT_TIME_WAIT_FOREVER);
+
+               for(Index = 0; Index < BLE_OTA_MAXIMUM_OUTSTANDING_REQUESTS; Index++)
+               {
+                  Request = &BLEOTAClientContext.Request[Index];
+
+                  if(Request->State == BLE_OTA_CLIENT_REQUEST_STATE_PENDING)
+                  {
+                     Request->State = BLE_OTA_CLIENT_REQUEST_STATE_FREE;
+
+                     if(Request->FileOffset < NextOffset)
+                        NextOffset = Request->FileOffset;
+                  }
+               }
+
+               BLEOTAClientContext.DataBuffer       = NULL;
+               BLEOTAClientContext.DataBufferLength = 0;
+
+               qurt_mutex_unlock(&BLEOTAClientContext.RequestMutex);
 
-               /* Decrement the number of bytes read. */
-               *DataLength = (*DataLength - BytesRemaining);
+               /* Return the number of bytes read. */
+               *DataLength = NextOffset - FileOffset;
             }
             else
                RetVal = BLE_OTA_STATUS_FAILURE;
@@ -18,6 +18,7 @@
 #define BLE_OTA_MAXIMUM_FILE_NAME_LENGTH            (50)
 #define BLE_OTA_MAXIMUM_NUMBER_SERVERS              (5)
 #define BLE_OTA_MAXIMUM_NUMBER_CLIENTS              (5)
+#define BLE_OTA_MAXIMUM_OUTSTANDING_REQUESTS        (4)
 
 /* Structure for describing an image registered with an OTA server. */
 typedef struct BLE_OTA_Server_Image_Data_s
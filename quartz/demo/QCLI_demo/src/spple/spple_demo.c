@@ -12,9 +12,11 @@
 #include "qapi_timer.h"
 #include "qurt_timer.h"    /* Timer for Throughput Calculation.         */
 #include "spple_demo.h"    /* Main Application Prototypes and Constants.*/
+#include "ble_conn_table.h" /* Remote device information table.          */
 #include "qcli_util.h"
 
 #include "ble_ota_service.h" /* OTA service API.                        */
+#include "lock_actuator.h"  /* Non-blocking servo control.               */
 
 #include "qapi_fs.h"
 
@@ -115,6 +117,16 @@
                                                          /* supported by this */
                                                          /* application.      */
 
+#ifndef MAX_SUPPORTED_REMOTE_DEVICES
+#define MAX_SUPPORTED_REMOTE_DEVICES               (8)   /* Denotes the       */
+                                                         /* maximum number of */
+                                                         /* remote devices    */
+                                                         /* (connected or     */
+                                                         /* bonded) that are  */
+                                                         /* supported by this */
+                                                         /* application.      */
+#endif
+
 #define HIDS_MAXIMUM_NUMBER_REPORTS                (5)   /* Denotes the       */
                                                          /* maximum number of */
                                                          /* supported HIDS    */
@@ -189,6 +201,20 @@
                                                          /* number of credits */
                                                          /* in an SPPLE Buffer*/
 
+#define SPPLE_BUFFERS_PER_QUEUE   ((SPPLE_DATA_CREDITS + SPPLE_DATA_BUFFER_LENGTH - 1) / SPPLE_DATA_BUFFER_LENGTH)
+                                                         /* Defines the       */
+                                                         /* maximum number of */
+                                                         /* pool buffers an   */
+                                                         /* SPPLE Buffer can  */
+                                                         /* hold.             */
+
+#ifndef SPPLE_BUFFER_POOL_SIZE
+#define SPPLE_BUFFER_POOL_SIZE    (MAX_SUPPORTED_REMOTE_DEVICES * 2 * SPPLE_BUFFERS_PER_QUEUE)
+                                                         /* Defines the number*/
+                                                         /* of buffers in the */
+                                                         /* SPPLE buffer pool.*/
+#endif
+
    /* Generic Access Profile (GAP) structures.                          */
 
    /* Structure used to hold all of the GAP LE Parameters.              */
@@ -437,16 +463,31 @@ typedef struct _tagSend_Info_t
 {
    uint32_t BytesToSend;
    uint32_t BytesSent;
+   uint32_t DataStrIndex;
 } Send_Info_t;
 
-   /* The following defines the format of a SPPLE Data Buffer.          */
+   /* The following defines the format of a buffer of the SPPLE buffer  */
+   /* pool.  Data holds Length bytes of which the first Offset bytes    */
+   /* have already been consumed.                                       */
+typedef struct __tagSPPLE_Buffer_t
+{
+   struct __tagSPPLE_Buffer_t *Next;
+   unsigned int                Offset;
+   unsigned int                Length;
+   uint8_t                     Data[SPPLE_DATA_BUFFER_LENGTH];
+} SPPLE_Buffer_t;
+
+   /* The following defines the format of a SPPLE Data Buffer.  A SPPLE */
+   /* Data Buffer is a queue of buffers from the SPPLE buffer pool.     */
+   /* BytesFree is the number of bytes that may still be queued and is  */
+   /* only given back when a pool buffer has been completely consumed   */
+   /* and released.                                                     */
 typedef struct __tagSPPLE_Data_Buffer_t
 {
-   unsigned int  InIndex;
-   unsigned int  OutIndex;
-   unsigned int  BytesFree;
-   unsigned int  BufferSize;
-   uint8_t       Buffer[SPPLE_DATA_BUFFER_LENGTH*3];
+   SPPLE_Buffer_t *Head;
+   SPPLE_Buffer_t *Tail;
+   unsigned int    BytesFree;
+   unsigned int    BufferSize;
 } SPPLE_Data_Buffer_t;
 
    /* Generic Access Profile Service (GAPS) structures.                 */
@@ -593,11 +634,11 @@ typedef struct _tagDeviceInfo_t
    SPPLE_Client_Info_t                    ClientInfo;
    SPPLE_Server_Info_t                    ServerInfo;
    unsigned int                           TransmitCredits;
+   uint16_t                               MTU;
    SPPLE_Data_Buffer_t                    ReceiveBuffer;
    SPPLE_Data_Buffer_t                    TransmitBuffer;
    XferInfo_t                             XferInfo;
    boolean_t                              ThroughputModeActive;
-   struct _tagDeviceInfo_t               *NextDeviceInfoInfoPtr;
 } DeviceInfo_t;
 
 #define DEVICE_INFO_DATA_SIZE                            (sizeof(DeviceInfo_t))
@@ -650,8 +691,14 @@ static qapi_BLE_HCI_DriverInformation_t HCI_DriverInformation;
 static unsigned int        ConnectionCount;         /* Holds the number of connected   */
                                                     /* remote devices.                 */
 
-static DeviceInfo_t       *DeviceInfoList;          /* Holds the list head for the     */
-                                                    /* remote device info list         */
+static DeviceInfo_t        DeviceInfoPool[MAX_SUPPORTED_REMOTE_DEVICES];
+                                                    /* Holds the remote device info    */
+                                                    /* entries.                        */
+
+static BLE_Conn_Table_t    DeviceInfoTable = BLE_CONN_TABLE_INITIALIZER(DeviceInfoPool, DeviceInfo_t, RemoteAddress, ConnectionID);
+                                                    /* Indexes the remote device info  */
+                                                    /* entries by BD_ADDR and by GATT  */
+                                                    /* Connection ID.                  */
 
 typedef char               BoardStr_t[16];          /* User to represent a structure to*/
                                                     /* hold a BD_ADDR return from      */
@@ -1053,9 +1100,20 @@ static uint32_t            SPPLEServiceID;          /* The following holds the S
                                                     /* qapi_BLE_GATT_Register_Service()*/
 
 static uint8_t             SPPLEBuffer[SPPLE_DATA_BUFFER_LENGTH+1];  /* Buffer that is */
-                                                    /* used for Sending/Receiving      */
+                                                    /* used for Reading and Displaying */
                                                     /* SPPLE Service Data.             */
 
+static SPPLE_Buffer_t      SPPLEBufferPool[SPPLE_BUFFER_POOL_SIZE];
+                                                    /* Pool of buffers used to queue   */
+                                                    /* SPPLE Service Data.             */
+
+static SPPLE_Buffer_t     *SPPLEBufferFreeList;     /* List of released buffers of the */
+                                                    /* SPPLE buffer pool.              */
+
+static unsigned int        SPPLEBufferPoolUsed;     /* Number of buffers of the SPPLE  */
+                                                    /* buffer pool that have been      */
+                                                    /* handed out at least once.       */
+
 static Send_Info_t         SendInfo;                /* Variable that contains          */
                                                     /* information about a data        */
                                                     /* transfer process.               */
@@ -1347,13 +1405,13 @@ static QCLI_Command_Status_t GetVersion(uint32_t Parameter_Count, QCLI_Parameter
 static QCLI_Command_Status_t SetBLERadio(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 
    /* Demo helper functions.                                            */
-static DeviceInfo_t *CreateNewDeviceInfoEntry(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress);
-static DeviceInfo_t *SearchDeviceInfoEntryByBD_ADDR(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress);
-static DeviceInfo_t *SearchDeviceInfoEntryTypeAddress(DeviceInfo_t **ListHead, qapi_BLE_GAP_LE_Address_Type_t AddressType, qapi_BLE_BD_ADDR_t RemoteAddress);
-static DeviceInfo_t *SearchDeviceInfoEntryByConnectionID(DeviceInfo_t **ListHead, unsigned int ConnectionID);
-static DeviceInfo_t *DeleteDeviceInfoEntry(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress);
+static DeviceInfo_t *CreateNewDeviceInfoEntry(qapi_BLE_BD_ADDR_t RemoteAddress);
+static DeviceInfo_t *SearchDeviceInfoEntryByBD_ADDR(qapi_BLE_BD_ADDR_t RemoteAddress);
+static DeviceInfo_t *SearchDeviceInfoEntryTypeAddress(qapi_BLE_GAP_LE_Address_Type_t AddressType, qapi_BLE_BD_ADDR_t RemoteAddress);
+static DeviceInfo_t *SearchDeviceInfoEntryByConnectionID(unsigned int ConnectionID);
+static DeviceInfo_t *DeleteDeviceInfoEntry(qapi_BLE_BD_ADDR_t RemoteAddress);
 static void FreeDeviceInfoEntryMemory(DeviceInfo_t *EntryToFree);
-static void FreeDeviceInfoList(DeviceInfo_t **ListHead);
+static void FreeDeviceInfoList(void);
 
 static void BD_ADDRToStr(qapi_BLE_BD_ADDR_t Board_Address, BoardStr_t BoardStr);
 static unsigned int StringToUnsignedInteger(char *StringInteger);
@@ -1592,14 +1650,22 @@ static QCLI_Command_Status_t SetThroughputMode(uint32_t Parameter_Count, QCLI_Pa
 static void DisplayThroughput(DeviceInfo_t *DeviceInfo);
 static char *SecondsToString(uint32_t Seconds, uint8_t BufferLength, char *Buffer);
 static void SPPLEPopulateHandles(SPPLE_Client_Info_t *ClientInfo, qapi_BLE_GATT_Service_Discovery_Indication_Data_t *ServiceInfo);
+static SPPLE_Buffer_t *AllocateBuffer(void);
+static void ReleaseBuffer(SPPLE_Buffer_t *Buffer);
+static uint8_t *ReserveBufferSpace(SPPLE_Data_Buffer_t *DataBuffer, unsigned int *Length);
+static void CommitBufferSpace(SPPLE_Data_Buffer_t *DataBuffer, unsigned int Length);
+static uint8_t *PeekBuffer(SPPLE_Data_Buffer_t *DataBuffer, unsigned int *Length);
+static unsigned int ConsumeBuffer(SPPLE_Data_Buffer_t *DataBuffer, unsigned int Length);
 static unsigned int AddDataToBuffer(SPPLE_Data_Buffer_t *DataBuffer, unsigned int DataLength, uint8_t *Data);
-static unsigned int RemoveDataFromBuffer(SPPLE_Data_Buffer_t *DataBuffer, unsigned int BufferLength, uint8_t *Buffer);
+static void FreeBuffer(SPPLE_Data_Buffer_t *DataBuffer);
 static void InitializeBuffer(SPPLE_Data_Buffer_t *DataBuffer);
-static unsigned int FillBufferWithString(SPPLE_Data_Buffer_t *DataBuffer, unsigned *CurrentBufferLength, unsigned int MaxLength, uint8_t *Buffer);
+static unsigned int FillBufferWithString(SPPLE_Data_Buffer_t *DataBuffer, unsigned int Length);
+static unsigned int GetMaximumDataLength(DeviceInfo_t *DeviceInfo);
+static int WriteSPPLEData(DeviceInfo_t *DeviceInfo, unsigned int DataLength, uint8_t *Data);
 static void SendProcess(DeviceInfo_t *DeviceInfo);
 static void SendCredits(DeviceInfo_t *DeviceInfo, unsigned int DataLength);
 static boolean_t ReceiveCreditEvent(DeviceInfo_t *DeviceInfo, unsigned int Credits);
-static boolean_t SendData(DeviceInfo_t *DeviceInfo, unsigned int DataLength, uint8_t *Data);
+static unsigned int SendData(DeviceInfo_t *DeviceInfo, unsigned int DataLength, uint8_t *Data);
 static boolean_t DataIndicationEvent(DeviceInfo_t *DeviceInfo, unsigned int DataLength, uint8_t *Data);
 static int ReadData(DeviceInfo_t *DeviceInfo, unsigned int BufferLength, uint8_t *Buffer);
 
@@ -2130,137 +2196,109 @@ static QCLI_Command_Status_t SetBLERadio(uint32_t Parameter_Count, QCLI_Paramete
    /* Demo helper functions.                                            */
 
    /* The following function will create a device information entry and */
-   /* add it to the specified List.  This function, if successful, will */
-   /* return a pointer to the Entry that has been created and added to  */
-   /* the specified list.  This function will return NULL if NO Entry   */
-   /* was added.  This can occur if the element passed in was deemed    */
-   /* invalid or the actual List Head was invalid.                      */
+   /* add it to the remote device information table.  This function, if*/
+   /* successful, will return a pointer to the Entry that has been      */
+   /* created and added to the table.  This function will return NULL if*/
+   /* NO Entry was added.  This can occur if the element passed in was  */
+   /* deemed invalid or the table is full.                              */
    /* ** NOTE ** This function does not insert duplicate entries into   */
-   /*            the list.  An element is considered a duplicate if the */
+   /*            the table.  An element is considered a duplicate if the*/
    /*            RemoteAddress already exists for an entry.  When this  */
    /*            occurs, this function returns NULL.                    */
-static DeviceInfo_t *CreateNewDeviceInfoEntry(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress)
+static DeviceInfo_t *CreateNewDeviceInfoEntry(qapi_BLE_BD_ADDR_t RemoteAddress)
 {
-   DeviceInfo_t *ret_val = NULL;
-   boolean_t     Result;
-
-   /* Verify that the passed in parameters seem semi-valid.             */
-   if((ListHead) && (!QAPI_BLE_COMPARE_NULL_BD_ADDR(RemoteAddress)))
-   {
-      /* Allocate the memory for the entry.                             */
-      if((ret_val = malloc(sizeof(DeviceInfo_t))) != NULL)
-      {
-         /* Initialize the entry.                                       */
-         memset(ret_val, 0, sizeof(DeviceInfo_t));
-
-         /* Store the remote device address.                            */
-         ret_val->RemoteAddress = RemoteAddress;
-
-         Result = qapi_BLE_BSC_AddGenericListEntry_Actual(QAPI_BLE_EK_BD_ADDR_T_E, QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, RemoteAddress), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, NextDeviceInfoInfoPtr), (void **)(ListHead), (void *)(ret_val));
-         if(!Result)
-         {
-            /* Failed to add to list so we should free the memory that  */
-            /* we allocated for the entry.                              */
-            free(ret_val);
-         }
-      }
-   }
-
-   return(ret_val);
+   /* The entry is taken from the fixed pool and is zero filled with the*/
+   /* remote device address stored.                                     */
+   return((DeviceInfo_t *)BLE_Conn_Table_Add(&DeviceInfoTable, RemoteAddress));
 }
 
-   /* The following function searches the specified List for the        */
-   /* specified Connection BD_ADDR.  This function returns NULL if      */
-   /* either the List Head is invalid, the BD_ADDR is invalid, or the   */
-   /* Connection BD_ADDR was NOT found.                                 */
-static DeviceInfo_t *SearchDeviceInfoEntryByBD_ADDR(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress)
+   /* The following function searches the remote device information    */
+   /* table for the specified Connection BD_ADDR.  This function returns*/
+   /* NULL if either the BD_ADDR is invalid, or the Connection BD_ADDR  */
+   /* was NOT found.                                                    */
+static DeviceInfo_t *SearchDeviceInfoEntryByBD_ADDR(qapi_BLE_BD_ADDR_t RemoteAddress)
 {
    BoardStr_t    BoardStr;
-   DeviceInfo_t *ret_val = NULL;
+   DeviceInfo_t *ret_val;
    DeviceInfo_t *DeviceInfo;
 
-   /* Verify the list head.                                             */
-   if(ListHead)
+   /* If the BD_ADDR is a match then we found the remote device         */
+   /* information.                                                      */
+   if((ret_val = (DeviceInfo_t *)BLE_Conn_Table_Search_Address(&DeviceInfoTable, RemoteAddress)) == NULL)
    {
-      /* Loop through the device information.                           */
-      DeviceInfo = *ListHead;
-      while(DeviceInfo)
+      /* Determine if the remote device is using a resolvable private   */
+      /* address (RPA).  This is the only case where the device         */
+      /* information needs to be walked.                                */
+      if(QAPI_BLE_GAP_LE_TEST_RESOLVABLE_ADDRESS_BITS(RemoteAddress))
       {
-         /* If the BD_ADDR is a match then we found the remote device   */
-         /* information.                                                */
-         if(QAPI_BLE_COMPARE_BD_ADDR(DeviceInfo->RemoteAddress, RemoteAddress))
+         /* Loop through the device information.                        */
+         DeviceInfo = BLE_Conn_Table_First(&DeviceInfoTable);
+         while(DeviceInfo)
          {
-            /* Set the remote device information pointer to the return  */
-            /* value and break since we are done.                       */
-            ret_val = DeviceInfo;
-            break;
-         }
-         else
-         {
-            /* Determine if the remote device is using a resolvable     */
-            /* private address (RPA).                                   */
-            if(QAPI_BLE_GAP_LE_TEST_RESOLVABLE_ADDRESS_BITS(RemoteAddress))
+            /* Check if we stored the Identity Resolving Key (IRK) for  */
+            /* the remote device.                                       */
+            if(DeviceInfo->Flags & DEVICE_INFO_FLAGS_IRK_VALID)
             {
-               /* Check if we stored the Identity Resolving Key (IRK)   */
-               /* for the remote device.                                */
-               if(DeviceInfo->Flags & DEVICE_INFO_FLAGS_IRK_VALID)
+               /* Use the IRK to resolve the address.                   */
+               if(qapi_BLE_GAP_LE_Resolve_Address(BluetoothStackID, &(DeviceInfo->IRK), RemoteAddress))
                {
-                  /* Use the IRK to resolve the address.                */
-                  if(qapi_BLE_GAP_LE_Resolve_Address(BluetoothStackID, &(DeviceInfo->IRK), RemoteAddress))
-                  {
-                     /* If we resolved the address let's update the     */
-                     /* Bluetooth address stored for the remote device. */
-                     /* * NOTE * We are doing this so we don't have to  */
-                     /*          re-resolve the remote device address   */
-                     /*          for future connections.  However, if   */
-                     /*          the resolvable address changes we will */
-                     /*          need to resolve it again.              */
-                     DeviceInfo->RemoteAddress     = RemoteAddress;
-                     DeviceInfo->RemoteAddressType = QAPI_BLE_LAT_RANDOM_E;
-
-                     /* Inform the user we resolved the address.        */
-                     QCLI_Printf(ble_group, "\n");
-                     QCLI_Printf(ble_group, "Resolved Address (");
-                     BD_ADDRToStr(DeviceInfo->RemoteAddress, BoardStr);
-                     QCLI_Printf(ble_group, "%s", BoardStr);
-                     QCLI_Printf(ble_group, ")\n");
-                     QCLI_Printf(ble_group, "   Identity Address:       ");
-                     BD_ADDRToStr(DeviceInfo->IdentityAddressBD_ADDR, BoardStr);
-                     QCLI_Printf(ble_group, "%s\n", BoardStr);
-                     QCLI_Printf(ble_group, "   Identity Address Type:  %s\n", ((DeviceInfo->IdentityAddressType == QAPI_BLE_LAT_PUBLIC_IDENTITY_E) ? "Public Identity" : "Random Identity"));
-
-                     /* Set the remote device information pointer to the*/
-                     /* return value and break since we are done.       */
-                     ret_val = DeviceInfo;
-                     break;
-                  }
+                  /* If we resolved the address let's update the        */
+                  /* Bluetooth address stored for the remote device.    */
+                  /* * NOTE * We are doing this so we don't have to     */
+                  /*          re-resolve the remote device address for  */
+                  /*          future connections.  However, if the      */
+                  /*          resolvable address changes we will need to*/
+                  /*          resolve it again.                         */
+                  BLE_Conn_Table_Set_Address(&DeviceInfoTable, DeviceInfo, RemoteAddress);
+                  DeviceInfo->RemoteAddressType = QAPI_BLE_LAT_RANDOM_E;
+
+                  /* Inform the user we resolved the address.           */
+                  QCLI_Printf(ble_group, "\n");
+                  QCLI_Printf(ble_group, "Resolved Address (");
+                  BD_ADDRToStr(DeviceInfo->RemoteAddress, BoardStr);
+                  QCLI_Printf(ble_group, "%s", BoardStr);
+                  QCLI_Printf(ble_group, ")\n");
+                  QCLI_Printf(ble_group, "   Identity Address:       ");
+                  BD_ADDRToStr(DeviceInfo->IdentityAddressBD_ADDR, BoardStr);
+                  QCLI_Printf(ble_group, "%s\n", BoardStr);
+                  QCLI_Printf(ble_group, "   Identity Address Type:  %s\n", ((DeviceInfo->IdentityAddressType == QAPI_BLE_LAT_PUBLIC_IDENTITY_E) ? "Public Identity" : "Random Identity"));
+
+                  /* Set the remote device information pointer to the   */
+                  /* return value and break since we are done.          */
+                  ret_val = DeviceInfo;
+                  break;
                }
             }
-         }
 
-         DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+            DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
+         }
       }
    }
 
    return(ret_val);
 }
 
-   /* The following function searches the specified List for the        */
-   /* specified Address and Type.  This function returns NULL if        */
-   /* either the List Head is invalid, the BD_ADDR is invalid, or the   */
-   /* Connection BD_ADDR was NOT found.                                 */
-static DeviceInfo_t *SearchDeviceInfoEntryTypeAddress(DeviceInfo_t **ListHead, qapi_BLE_GAP_LE_Address_Type_t AddressType, qapi_BLE_BD_ADDR_t RemoteAddress)
+   /* The following function searches the remote device information    */
+   /* table for the specified Address and Type.  This function returns  */
+   /* NULL if either the BD_ADDR is invalid, or the Connection BD_ADDR  */
+   /* was NOT found.                                                    */
+static DeviceInfo_t *SearchDeviceInfoEntryTypeAddress(qapi_BLE_GAP_LE_Address_Type_t AddressType, qapi_BLE_BD_ADDR_t RemoteAddress)
 {
    BoardStr_t                      BoardStr;
-   DeviceInfo_t                   *ret_val = NULL;
+   DeviceInfo_t                   *ret_val;
    DeviceInfo_t                   *DeviceInfo;
    qapi_BLE_GAP_LE_Address_Type_t  TempType;
 
-   /* Verify the list head.                                             */
-   if(ListHead)
+   /* Check the table index first for the same BD_ADDR and type.        */
+   if(((ret_val = (DeviceInfo_t *)BLE_Conn_Table_Search_Address(&DeviceInfoTable, RemoteAddress)) != NULL) && (ret_val->RemoteAddressType != AddressType))
+      ret_val = NULL;
+
+   /* Only identity and resolvable private addresses need the device    */
+   /* information to be walked.                                         */
+   if(!ret_val)
    {
       /* Loop through the device information.                           */
-      DeviceInfo = *ListHead;
+      DeviceInfo = BLE_Conn_Table_First(&DeviceInfoTable);
       while(DeviceInfo)
       {
          /* If the BD_ADDR is a match then we found the remote device   */
@@ -2291,7 +2329,7 @@ static DeviceInfo_t *SearchDeviceInfoEntryTypeAddress(DeviceInfo_t **ListHead, q
                   {
                      /* Update the address field for this entry.        */
                      DeviceInfo->RemoteAddressType = AddressType;
-                     DeviceInfo->RemoteAddress     = DeviceInfo->IdentityAddressBD_ADDR;
+                     BLE_Conn_Table_Set_Address(&DeviceInfoTable, DeviceInfo, DeviceInfo->IdentityAddressBD_ADDR);
 
                      /* Set the remote device information pointer to the*/
                      /* return value and break since we are done.       */
@@ -2322,7 +2360,7 @@ static DeviceInfo_t *SearchDeviceInfoEntryTypeAddress(DeviceInfo_t **ListHead, q
                          /*          However, if the resolvable address */
                          /*          changes we will need to resolve it */
                          /*          again.                             */
-                         DeviceInfo->RemoteAddress     = RemoteAddress;
+                         BLE_Conn_Table_Set_Address(&DeviceInfoTable, DeviceInfo, RemoteAddress);
                          DeviceInfo->RemoteAddressType = QAPI_BLE_LAT_RANDOM_E;
 
                          /* Inform the user we resolved the address.    */
@@ -2347,75 +2385,82 @@ static DeviceInfo_t *SearchDeviceInfoEntryTypeAddress(DeviceInfo_t **ListHead, q
             }
          }
 
-         DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+         DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
       }
    }
 
    return(ret_val);
 }
 
-   /* The following function searches the specified List for the        */
-   /* specified GATT Connection ID.  This function returns NULL if      */
-   /* either the List Head is invalid, the Connection ID is invalid, or */
-   /* the Connection ID was NOT found.                                  */
-static DeviceInfo_t *SearchDeviceInfoEntryByConnectionID(DeviceInfo_t **ListHead, unsigned int ConnectionID)
+   /* The following function searches the remote device information    */
+   /* table for the specified GATT Connection ID.  This function returns*/
+   /* NULL if either the Connection ID is invalid, or the Connection ID */
+   /* was NOT found.                                                    */
+static DeviceInfo_t *SearchDeviceInfoEntryByConnectionID(unsigned int ConnectionID)
 {
-   return(qapi_BLE_BSC_SearchGenericListEntry(QAPI_BLE_EK_UNSIGNED_INTEGER_E, (void *)(&ConnectionID), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, ConnectionID), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, NextDeviceInfoInfoPtr), (void **)(ListHead)));
+   return((DeviceInfo_t *)BLE_Conn_Table_Search_ConnectionID(&DeviceInfoTable, ConnectionID));
 }
 
-   /* The following function searches the specified Key Info List for   */
-   /* the specified BD_ADDR and removes it from the List.  This function*/
-   /* returns NULL if either the List Head is invalid, the BD_ADDR is   */
-   /* invalid, or the specified Entry was NOT present in the list.  The */
-   /* entry returned will have the Next Entry field set to NULL, and    */
-   /* the caller is responsible for deleting the memory associated with */
-   /* this entry by calling the FreeKeyEntryMemory() function.          */
-static DeviceInfo_t *DeleteDeviceInfoEntry(DeviceInfo_t **ListHead, qapi_BLE_BD_ADDR_t RemoteAddress)
+   /* The following function searches the remote device information    */
+   /* table for the specified BD_ADDR and removes it from the table.    */
+   /* This function returns NULL if either the BD_ADDR is invalid, or   */
+   /* the specified Entry was NOT present in the table.  The caller is  */
+   /* responsible for freeing the memory associated with this entry by  */
+   /* calling the FreeDeviceInfoEntryMemory() function before another   */
+   /* entry is created.                                                 */
+static DeviceInfo_t *DeleteDeviceInfoEntry(qapi_BLE_BD_ADDR_t RemoteAddress)
 {
-   return(qapi_BLE_BSC_DeleteGenericListEntry(QAPI_BLE_EK_BD_ADDR_T_E, (void *)(&RemoteAddress), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, RemoteAddress), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, NextDeviceInfoInfoPtr), (void **)(ListHead)));
+   DeviceInfo_t *ret_val;
+
+   if((ret_val = (DeviceInfo_t *)BLE_Conn_Table_Search_Address(&DeviceInfoTable, RemoteAddress)) != NULL)
+      BLE_Conn_Table_Remove(&DeviceInfoTable, ret_val);
+
+   return(ret_val);
 }
 
    /* This function frees the specified Key Info Information member     */
    /* memory.                                                           */
+   /* * NOTE * The entry itself belongs to the fixed pool of the remote */
+   /*          device information table so only the memory it points to */
+   /*          is freed.                                                */
 static void FreeDeviceInfoEntryMemory(DeviceInfo_t *EntryToFree)
 {
    unsigned int InstanceID;
 
+   /* Return any queued SPPLE data to the buffer pool.                  */
+   FreeBuffer(&(EntryToFree->ReceiveBuffer));
+   FreeBuffer(&(EntryToFree->TransmitBuffer));
+
    /* Loop through all HIDS instance.                                   */
    for(InstanceID = 0; InstanceID < MAX_SUPPORTED_HID_INSTANCES; InstanceID++)
    {
       /* Free the report map.                                           */
       if(EntryToFree->HIDSClientInfo[InstanceID].ReportMap)
+      {
          free(EntryToFree->HIDSClientInfo[InstanceID].ReportMap);
-   }
 
-   qapi_BLE_BSC_FreeGenericListEntryMemory((void *)(EntryToFree));
+         EntryToFree->HIDSClientInfo[InstanceID].ReportMap = NULL;
+      }
+   }
 }
 
    /* The following function deletes (and frees all memory) every       */
-   /* element of the specified Key Info List. Upon return of this       */
-   /* function, the Head Pointer is set to NULL.                        */
-static void FreeDeviceInfoList(DeviceInfo_t **ListHead)
+   /* element of the remote device information table.  Upon return of   */
+   /* this function, the table is empty.                                */
+static void FreeDeviceInfoList(void)
 {
    DeviceInfo_t *DeviceInfo;
-   unsigned int  InstanceID;
 
-   DeviceInfo = *ListHead;
+   DeviceInfo = BLE_Conn_Table_First(&DeviceInfoTable);
 
    while(DeviceInfo)
    {
-      /* Loop through all HIDS instance.                                */
-      for(InstanceID = 0; InstanceID < MAX_SUPPORTED_HID_INSTANCES; InstanceID++)
-      {
-         /* Free the report map.                                        */
-         if(DeviceInfo->HIDSClientInfo[InstanceID].ReportMap)
-            free(DeviceInfo->HIDSClientInfo[InstanceID].ReportMap);
-      }
+      FreeDeviceInfoEntryMemory(DeviceInfo);
 
-      DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+      DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
    }
 
-   qapi_BLE_BSC_FreeGenericListEntryList((void **)(ListHead), QAPI_BLE_BTPS_STRUCTURE_OFFSET(DeviceInfo_t, NextDeviceInfoInfoPtr));
+   BLE_Conn_Table_Clear(&DeviceInfoTable);
 }
 
    /* The following function is responsible for converting data of type */
@@ -2651,7 +2696,7 @@ static int OpenStack(qapi_BLE_HCI_DriverInformation_t *HCI_DriverInformation)
             qapi_BLE_GAP_LE_Diversify_Function(BluetoothStackID, (qapi_BLE_Encryption_Key_t *)(&IR), 3, 0, &DHK);
 
             /* Flag that we have no Key Information in the Key List.    */
-            DeviceInfoList = NULL;
+            BLE_Conn_Table_Clear(&DeviceInfoTable);
 
             /* Attempt to initialize our persistent storage context.    */
             /* * NOTE * /spinor/ is default mount point for the flash   */
@@ -2831,7 +2876,7 @@ static int CloseStack(void)
             /* We need to loop through the remote device information    */
             /* entries and disconnect any remote devices that are still */
             /* connected.                                               */
-            DeviceInfo = DeviceInfoList;
+            DeviceInfo = BLE_Conn_Table_First(&DeviceInfoTable);
             while(DeviceInfo)
             {
                /* If the GATT Connection ID is valid, then we are       */
@@ -2839,13 +2884,13 @@ static int CloseStack(void)
                if(DeviceInfo->ConnectionID)
                {
                   /* Flag that the remote device is no longer connected.*/
-                  DeviceInfo->ConnectionID = 0;
+                  BLE_Conn_Table_Set_ConnectionID(&DeviceInfoTable, DeviceInfo, 0);
 
                   /* Send the disconnection request.                    */
                   qapi_BLE_GAP_LE_Disconnect(BluetoothStackID, DeviceInfo->RemoteAddress);
                }
 
-               DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+               DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
             }
 
             /* Un-lock the Bluetooth Stack.                             */
@@ -2988,8 +3033,7 @@ static int CloseStack(void)
       QCLI_Printf(ble_group, "Stack Shutdown.\n");
 
       /* Free all remote device information entries.                    */
-      FreeDeviceInfoList(&DeviceInfoList);
-      DeviceInfoList   = NULL;
+      FreeDeviceInfoList();
 
       /* Flag that the Stack is no longer initialized.                  */
       BluetoothStackID = 0;
@@ -4438,7 +4482,7 @@ static QCLI_Command_Status_t AdvertiseLE(uint32_t Parameter_Count, QCLI_Paramete
                         /*          remote device to the resolving list */
                         /*          so we need to make sure that it is  */
                         /*          valid                               */
-                        if((RemoteDevice = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+                        if((RemoteDevice = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
                         {
                            /* Make sure the remote device was added to  */
                            /* the resolving list.                       */
@@ -4841,7 +4885,7 @@ static QCLI_Command_Status_t UnPairRemoteDevice(uint32_t Parameter_Count, QCLI_P
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the remote device.            */
-               if((DeviceInfo = SearchDeviceInfoEntryByConnectionID(&DeviceInfoList, (unsigned int)(Parameter_List[0].Integer_Value))) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByConnectionID((unsigned int)(Parameter_List[0].Integer_Value))) != NULL)
                {
                   /* We will simply flag that the LTK key is no longer  */
                   /* valid. This will cause the remote device           */
@@ -4919,7 +4963,7 @@ static QCLI_Command_Status_t SelectRemoteDevice(uint32_t Parameter_Count, QCLI_P
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the remote device.            */
-               if((DeviceInfo = SearchDeviceInfoEntryByConnectionID(&DeviceInfoList, (unsigned int)(Parameter_List[0].Integer_Value))) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByConnectionID((unsigned int)(Parameter_List[0].Integer_Value))) != NULL)
                {
                   /* Simply update the address of the selected remote   */
                   /* device.                                            */
@@ -4987,7 +5031,7 @@ static QCLI_Command_Status_t DisplayRemoteDevices(uint32_t Parameter_Count, QCLI
    if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
    {
       /* Loop through the device information list.                      */
-      DeviceInfo = DeviceInfoList;
+      DeviceInfo = BLE_Conn_Table_First(&DeviceInfoTable);
       Index      = 0;
       while(DeviceInfo)
       {
@@ -5068,7 +5112,7 @@ static QCLI_Command_Status_t DisplayRemoteDevices(uint32_t Parameter_Count, QCLI
             }
          }
 
-         DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+         DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
       }
 
       /* Un-lock the Bluetooth Stack.                                   */
@@ -5127,7 +5171,7 @@ static QCLI_Command_Status_t AddDeviceToWhiteList(uint32_t Parameter_Count, QCLI
             if(AddressType != QAPI_BLE_LAT_ANONYMOUS_E)
             {
                /* Get the device info for the remote device.            */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
                {
                   /* Make sure the remote device is NOT already in the  */
                   /* white list.                                        */
@@ -5262,7 +5306,7 @@ static QCLI_Command_Status_t RemoveDeviceFromWhiteList(uint32_t Parameter_Count,
             if(!QAPI_BLE_COMPARE_NULL_BD_ADDR(BD_ADDR))
             {
                /* Get the device info for the remote device.            */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
                {
                   /* Make sure the remote device has been added to the  */
                   /* white list.                                        */
@@ -5379,7 +5423,7 @@ static QCLI_Command_Status_t AddDeviceToResolvingList(uint32_t Parameter_Count,
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the remote device.               */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
             {
                /* Make sure the remote device is NOT already in the     */
                /* resolving list.                                       */
@@ -5474,7 +5518,7 @@ static QCLI_Command_Status_t RemoveDeviceFromResolvingList(uint32_t Parameter_Co
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the remote device.               */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
             {
                /* Make sure the remote device has been added to the     */
                /* resolving list.                                       */
@@ -6163,13 +6207,13 @@ static QCLI_Command_Status_t StorePersistentData(uint32_t Parameter_Count, QCLI_
       {
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
-            DeviceInfo    = DeviceInfoList;
+            DeviceInfo    = BLE_Conn_Table_First(&DeviceInfoTable);
             NumberDevices = 0;
 
             while(DeviceInfo)
             {
                ++NumberDevices;
-               DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+               DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
             }
 
             if((PersistentData = (PersistentData_t *)malloc(PERSISTENT_DATA_SIZE(NumberDevices))) != NULL)
@@ -6179,7 +6223,7 @@ static QCLI_Command_Status_t StorePersistentData(uint32_t Parameter_Count, QCLI_
                PersistentData->LocalAddress        = LocalBD_ADDR;
                PersistentData->NumberRemoteDevices = NumberDevices;
 
-               DeviceInfo = DeviceInfoList;
+               DeviceInfo = BLE_Conn_Table_First(&DeviceInfoTable);
                Index      = 0;
 
                while(DeviceInfo)
@@ -6203,7 +6247,7 @@ static QCLI_Command_Status_t StorePersistentData(uint32_t Parameter_Count, QCLI_
                   }
 
                   ++Index;
-                  DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+                  DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
                }
 
                Result = qapi_Persist_Put(PersistHandle, PERSISTENT_DATA_SIZE(NumberDevices), (uint8_t *)PersistentData);
@@ -6271,7 +6315,7 @@ static QCLI_Command_Status_t LoadPersistentData(uint32_t Parameter_Count, QCLI_P
          {
             /* Don't proceed if there are devices in the list unless a  */
             /* "force" was specified"                                   */
-            if(((Parameter_Count >= 1) && (Parameter_List[0].Integer_Is_Valid) && (Parameter_List[0].Integer_Value)) || (!DeviceInfoList))
+            if(((Parameter_Count >= 1) && (Parameter_List[0].Integer_Is_Valid) && (Parameter_List[0].Integer_Value)) || (!BLE_Conn_Table_Count(&DeviceInfoTable)))
             {
                /* Attempt to read the data.                             */
                Result = qapi_Persist_Get(PersistHandle, &DataSize, (uint8_t **)&PersistentData);
@@ -6287,11 +6331,10 @@ static QCLI_Command_Status_t LoadPersistentData(uint32_t Parameter_Count, QCLI_P
                      {
                         /* Clear the list if it is not empty (user      */
                         /* specified "force").                          */
-                        if(DeviceInfoList)
+                        if(BLE_Conn_Table_Count(&DeviceInfoTable))
                         {
                            QCLI_Printf(ble_group, "Warning: Device List is not empty. It will be cleared.\n");
-                           FreeDeviceInfoList(&DeviceInfoList);
-                           DeviceInfoList = NULL;
+                           FreeDeviceInfoList();
                         }
 
                         /* Data all seems valid, so build the device    */
@@ -6300,7 +6343,7 @@ static QCLI_Command_Status_t LoadPersistentData(uint32_t Parameter_Count, QCLI_P
                         {
                            /* Attempt to create a new list entry for the*/
                            /* device.                                   */
-                           if((DeviceInfo = CreateNewDeviceInfoEntry(&DeviceInfoList, PersistentData->RemoteDevices[Index].LastAddress)) != NULL)
+                           if((DeviceInfo = CreateNewDeviceInfoEntry(PersistentData->RemoteDevices[Index].LastAddress)) != NULL)
                            {
                               /* Note the address type of the address   */
                               /* used to create the entry.              */
@@ -7805,7 +7848,7 @@ static QCLI_Command_Status_t DiscoverServices(uint32_t Parameter_Count, QCLI_Par
       if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
       {
          /* Get the device info for the connection device.              */
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
          {
             /* Verify that no service discovery is outstanding for this */
             /* device.                                                  */
@@ -8229,7 +8272,7 @@ static QCLI_Command_Status_t ConfigureRemoteAIOS(uint32_t Parameter_Count, QCLI_
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the selected remote device.      */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                QCLI_Printf(aios_group, "Attempting to configure CCCDs...\n");
 
@@ -8302,7 +8345,7 @@ static QCLI_Command_Status_t ReadAIOSCharacteristic(uint32_t Parameter_Count, QC
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the selected remote device.      */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Get a pointer to the instance information that has    */
                /* been specified by the user.                           */
@@ -8413,7 +8456,7 @@ static QCLI_Command_Status_t WriteAIOSDigitalOutput(uint32_t Parameter_Count, QC
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the selected remote device.   */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                {
                   /* Get a pointer to the instance information that has */
                   /* been specified by the user.                        */
@@ -8519,7 +8562,7 @@ static QCLI_Command_Status_t WriteAIOSAnalogOutput(uint32_t Parameter_Count, QCL
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the selected remote device.   */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                {
                   /* Get a pointer to the instance information that has */
                   /* been specified by the user.                        */
@@ -8606,7 +8649,7 @@ static QCLI_Command_Status_t ReadAIOSPresentationFormat(uint32_t Parameter_Count
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the selected remote device.      */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Get a pointer to the instance information that has    */
                /* been specified by the user.                           */
@@ -8685,7 +8728,7 @@ static QCLI_Command_Status_t ReadAIOSNumberOfDigitals(uint32_t Parameter_Count,
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the selected remote device.      */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Get a pointer to the instance information that has    */
                /* been specified by the user.                           */
@@ -8861,7 +8904,7 @@ static QCLI_Command_Status_t NotifyAIOSCharacteristic(uint32_t Parameter_Count,
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the selected remote device.   */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                {
                   /* Get a pointer to the instance data that has been   */
                   /* specified by the user.                             */
@@ -9694,7 +9737,7 @@ static QCLI_Command_Status_t ConfigureRemoteBAS(uint32_t Parameter_Count, QCLI_P
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the connection device.        */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                {
                   QCLI_Printf(bas_group, "Attempting to configure CCCDs...\n");
 
@@ -9797,7 +9840,7 @@ static QCLI_Command_Status_t GetBatteryLevel(uint32_t Parameter_Count, QCLI_Para
             if(ConnectionCount)
             {
                /* Get the device info for the connection device.        */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                {
                   /* Verify that the client has received a valid Battery*/
                   /* Level Attribute Handle.                            */
@@ -9936,7 +9979,7 @@ static QCLI_Command_Status_t NotifyBatteryLevel(uint32_t Parameter_Count, QCLI_P
                /* Lock the Bluetooth stack.                             */
                if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
                {
-                  if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+                  if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                   {
                      if(DeviceInfo->BASServerInfo[InstanceID].Battery_Level_Client_Configuration & QAPI_BLE_GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_NOTIFY_ENABLE)
                      {
@@ -10049,7 +10092,7 @@ static QCLI_Command_Status_t GetBatteryLevelPresentationFormat(uint32_t Paramete
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the connection device.        */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                {
                   /* Verify that the client has received a valid Battery*/
                   /* Level Presentation Format Attribute Handle.        */
@@ -10395,7 +10438,7 @@ static QCLI_Command_Status_t ReadRemoteName(uint32_t Parameter_Count, QCLI_Param
       if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
       {
          /* Get the device info for the connection device.              */
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
          {
             /* Verify that we discovered the Device Name Handle.        */
             if(DeviceInfo->GAPSClientInfo.DeviceNameHandle)
@@ -10566,7 +10609,7 @@ static QCLI_Command_Status_t ReadRemoteAppearance(uint32_t Parameter_Count, QCLI
       if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
       {
          /* Get the device info for the connection device.              */
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
          {
             /* Verify that we discovered the Device Name Handle.        */
             if(DeviceInfo->GAPSClientInfo.DeviceAppearanceHandle)
@@ -10859,7 +10902,7 @@ static QCLI_Command_Status_t ConfigureHIDS(uint32_t Parameter_Count, QCLI_Parame
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the connection device.           */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Make sure encryption is enabled.                      */
                if((qapi_BLE_GAP_LE_Query_Encryption_Mode(BluetoothStackID, SelectedRemoteBD_ADDR, &GAPEncryptionMode) == 0) && (GAPEncryptionMode == QAPI_BLE_EM_ENABLED_E))
@@ -10982,7 +11025,7 @@ static QCLI_Command_Status_t ReadHIDSConfiguration(uint32_t Parameter_Count, QCL
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the connection device.           */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Make sure encryption is enabled.                      */
                if((qapi_BLE_GAP_LE_Query_Encryption_Mode(BluetoothStackID, SelectedRemoteBD_ADDR, &GAPEncryptionMode) == 0) && (GAPEncryptionMode == QAPI_BLE_EM_ENABLED_E))
@@ -11096,7 +11139,7 @@ static QCLI_Command_Status_t GetReport(uint32_t Parameter_Count, QCLI_Parameter_
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the connection device.           */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Set the Instance ID.                                  */
                InstanceID = (Parameter_List[0].Integer_Value - 1);
@@ -11153,7 +11196,7 @@ static QCLI_Command_Status_t SetReport(uint32_t Parameter_Count, QCLI_Parameter_
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the connection device.           */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Set the Instance ID.                                  */
                InstanceID = (Parameter_List[0].Integer_Value - 1);
@@ -11234,7 +11277,7 @@ static QCLI_Command_Status_t SetSuspend(uint32_t Parameter_Count, QCLI_Parameter
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the connection device.           */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Set the Instance ID.                                  */
                InstanceID = (Parameter_List[0].Integer_Value - 1);
@@ -11313,7 +11356,7 @@ static QCLI_Command_Status_t SetProtocolMode(uint32_t Parameter_Count, QCLI_Para
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the connection device.           */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Set the Instance ID.                                  */
                InstanceID = (Parameter_List[0].Integer_Value - 1);
@@ -11392,7 +11435,7 @@ static QCLI_Command_Status_t SendReport(uint32_t Parameter_Count, QCLI_Parameter
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Find the device info.                                    */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Check that we are encrypted.                          */
                if((qapi_BLE_GAP_LE_Query_Encryption_Mode(BluetoothStackID, SelectedRemoteBD_ADDR, &GAPEncryptionMode) == 0) && (GAPEncryptionMode == QAPI_BLE_EM_ENABLED_E))
@@ -11533,7 +11576,7 @@ static QCLI_Command_Status_t SendKeyString(uint32_t Parameter_Count, QCLI_Parame
    if((Parameter_List) && (Parameter_Count > 0) && (Parameter_List[0].String_Value))
    {
       /* Search for the device info structure for this device.          */
-      if((HIDSInstanceID) && ((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL))
+      if((HIDSInstanceID) && ((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL))
       {
          /* Check that we are encrypted.                                */
          if(DeviceInfo->Flags & DEVICE_INFO_FLAGS_LTK_VALID)
@@ -12255,7 +12298,7 @@ static QCLI_Command_Status_t ConfigureRemoteHRS(uint32_t Parameter_Count, QCLI_P
          if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
          {
             /* Get the device info for the connection device.           */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                QCLI_Printf(hrs_group, "Attempting to configure CCCDs...\n");
 
@@ -12818,7 +12861,7 @@ static QCLI_Command_Status_t DiscoverOTA(uint32_t Parameter_Count, QCLI_Paramete
          StrToBD_ADDR((char *)(Parameter_List[0].String_Value), &BD_ADDR);
 
          /* Get the device info for the connection device.              */
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
          {
             /* Discover the OTA service.                                */
             Result = BLE_OTA_Discover_OTA_Service(BluetoothStackID, DeviceInfo->ConnectionID);
@@ -12866,7 +12909,7 @@ static QCLI_Command_Status_t QueryOTAImage(uint32_t Parameter_Count, QCLI_Parame
          /* Convert the parameter to a Bluetooth Device Address.        */
          StrToBD_ADDR((char *)(Parameter_List[0].String_Value), &BD_ADDR);
 
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
          {
             Version = Parameter_List[2].Integer_Value;
 
@@ -12919,7 +12962,7 @@ static QCLI_Command_Status_t ReadOTAImage(uint32_t Parameter_Count, QCLI_Paramet
          /* Convert the parameter to a Bluetooth Device Address.        */
          StrToBD_ADDR((char *)(Parameter_List[0].String_Value), &BD_ADDR);
 
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BD_ADDR)) != NULL)
          {
             ImageID    = Parameter_List[1].Integer_Value;
             DataLength = Parameter_List[2].Integer_Value;
@@ -13124,7 +13167,7 @@ static QCLI_Command_Status_t ConnectSLoWPNode(uint32_t Parameter_Count, QCLI_Par
       if(ConnectionCount)
       {
          /* Get the device information.                                 */
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
          {
             /* Set the applications channel parameters for the Node.    */
             /* * NOTE * If we want to manually control credits for the  */
@@ -13401,7 +13444,7 @@ static QCLI_Command_Status_t ConfigureRemoteSCPS(uint32_t Parameter_Count, QCLI_
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the connection device.        */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                {
                   QCLI_Printf(scps_group, "Attempting to configure CCCDs...\n");
 
@@ -13488,7 +13531,7 @@ static QCLI_Command_Status_t SetScanIntervalWindow(uint32_t Parameter_Count, QCL
             if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
             {
                /* Get the device info for the connection device.        */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                {
                   /* Verify that the client has received a valid Scan   */
                   /* Interval Window Attribute Handle.                  */
@@ -13557,7 +13600,7 @@ static QCLI_Command_Status_t NotifyScanRefresh(uint32_t Parameter_Count, QCLI_Pa
          {
             /* Find the device information for the selected connected   */
             /* BLE remote device.                                       */
-            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+            if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
             {
                /* Verify that the client has registered for             */
                /* notifications.                                        */
@@ -13773,7 +13816,7 @@ static QCLI_Command_Status_t ConfigureSPPLE(uint32_t Parameter_Count, QCLI_Param
       if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
       {
          /* Get the device info for the connection device.              */
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
          {
             /* Verify that we are not already acting as a Server.       */
             if(!(DeviceInfo->Flags & DEVICE_INFO_FLAGS_SPPLE_SERVER))
@@ -13861,7 +13904,7 @@ static QCLI_Command_Status_t SendDataCommand(uint32_t Parameter_Count, QCLI_Para
             if(!SendInfo.BytesToSend)
             {
                /* Get the device info for the connection device.        */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
                {
                   /* Verify that we are a Client or Server.             */
                   if(DeviceInfo->Flags & (DEVICE_INFO_FLAGS_SPPLE_CLIENT | DEVICE_INFO_FLAGS_SPPLE_SERVER))
@@ -13869,6 +13912,7 @@ static QCLI_Command_Status_t SendDataCommand(uint32_t Parameter_Count, QCLI_Para
                      /* Get the count of the number of bytes to send.   */
                      SendInfo.BytesToSend  = (uint32_t)Parameter_List[0].Integer_Value;
                      SendInfo.BytesSent    = 0;
+                     SendInfo.DataStrIndex = 0;
 
                      /* Kick start the send process.                    */
                      SendProcess(DeviceInfo);
@@ -13938,7 +13982,7 @@ static QCLI_Command_Status_t ReadDataCommand(uint32_t Parameter_Count, QCLI_Para
       if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
       {
          /* Get the device info for the connection device.              */
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
          {
             /* Verify that we are a Client or Server.                   */
             if(DeviceInfo->Flags & (DEVICE_INFO_FLAGS_SPPLE_CLIENT | DEVICE_INFO_FLAGS_SPPLE_SERVER))
@@ -14156,7 +14200,7 @@ static QCLI_Command_Status_t SetThroughputMode(uint32_t Parameter_Count, QCLI_Pa
       if (ConnectionCount)
       {
          /* Get the device info for the connection device.              */
-         if ((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+         if ((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
          {
             /* Next check to see if the parameters required for the     */
             /* execution of this function appear to be semi-valid.      */
@@ -14392,123 +14436,229 @@ static void SPPLEPopulateHandles(SPPLE_Client_Info_t *ClientInfo, qapi_BLE_GATT_
    }
 }
 
-   /* The following function is a utility function that is used to add  */
-   /* data (using InIndex as the buffer index) from the buffer specified*/
-   /* by the DataBuffer parameter.  The second and third parameters     */
-   /* specified the length of the data to add and the pointer to the    */
-   /* data to add to the buffer.  This function returns the actual      */
-   /* number of bytes that were added to the buffer (or 0 if none were  */
-   /* added).                                                           */
-static unsigned int AddDataToBuffer(SPPLE_Data_Buffer_t *DataBuffer, unsigned int DataLength, uint8_t *Data)
+   /* The following function is a utility function that is used to      */
+   /* allocate a buffer from the SPPLE buffer pool.  This function      */
+   /* returns a pointer to the buffer, or NULL if the pool is empty.    */
+static SPPLE_Buffer_t *AllocateBuffer(void)
 {
-   unsigned int BytesAdded = 0;
-   unsigned int Count;
+   SPPLE_Buffer_t *ret_val;
 
-   /* Verify that the input parameters are valid.                       */
-   if((DataBuffer) && (DataLength) && (Data))
+   /* Reuse a released buffer if there is one, otherwise hand out a     */
+   /* buffer that has never been used.                                  */
+   if(SPPLEBufferFreeList)
    {
-      /* Loop while we have data AND space in the buffer.               */
-      while(DataLength)
-      {
-         /* Get the number of bytes that can be placed in the buffer    */
-         /* until it wraps.                                             */
-         Count = DataBuffer->BufferSize - DataBuffer->InIndex;
+      ret_val             = SPPLEBufferFreeList;
+      SPPLEBufferFreeList = ret_val->Next;
+   }
+   else
+   {
+      if(SPPLEBufferPoolUsed < SPPLE_BUFFER_POOL_SIZE)
+         ret_val = &SPPLEBufferPool[SPPLEBufferPoolUsed++];
+      else
+         ret_val = NULL;
+   }
 
-         /* Determine if the number of bytes free is less than the      */
-         /* number of bytes till we wrap and choose the smaller of the  */
-         /* numbers.                                                    */
-         Count = (DataBuffer->BytesFree < Count)?DataBuffer->BytesFree:Count;
+   if(ret_val)
+   {
+      ret_val->Next   = NULL;
+      ret_val->Offset = 0;
+      ret_val->Length = 0;
+   }
 
-         /* Cap the Count that we add to buffer to the length of the    */
-         /* data provided by the caller.                                */
-         Count = (Count > DataLength)?DataLength:Count;
+   return(ret_val);
+}
 
-         if(Count)
+   /* The following function is a utility function that is used to      */
+   /* return a buffer to the SPPLE buffer pool.                         */
+static void ReleaseBuffer(SPPLE_Buffer_t *Buffer)
+{
+   Buffer->Next        = SPPLEBufferFreeList;
+   SPPLEBufferFreeList = Buffer;
+}
+
+   /* The following function is a utility function that is used to      */
+   /* reserve space at the end of the buffer specified by the DataBuffer*/
+   /* parameter so that data can be written directly into it.  The     */
+   /* second parameter specifies the number of bytes the caller wants   */
+   /* and, on return, holds the number of contiguous bytes that may be  */
+   /* written.  This function returns a pointer to the reserved space,  */
+   /* or NULL if none is available.                                     */
+   /* * NOTE * Nothing is added to the buffer until the caller commits  */
+   /*          the bytes it has written with CommitBufferSpace().       */
+static uint8_t *ReserveBufferSpace(SPPLE_Data_Buffer_t *DataBuffer, unsigned int *Length)
+{
+   uint8_t        *ret_val = NULL;
+   unsigned int    Count;
+   SPPLE_Buffer_t *Buffer;
+
+   /* Verify that the input parameters are valid.                       */
+   if((DataBuffer) && (Length) && (*Length) && (DataBuffer->BytesFree))
+   {
+      /* Append to the last buffer in the queue while it has room,      */
+      /* otherwise queue a new buffer from the pool.                    */
+      if((DataBuffer->Tail) && (DataBuffer->Tail->Length < SPPLE_DATA_BUFFER_LENGTH))
+         Buffer = DataBuffer->Tail;
+      else
+      {
+         if((Buffer = AllocateBuffer()) != NULL)
          {
-            /* Copy the data into the buffer.                           */
-            memcpy(&DataBuffer->Buffer[DataBuffer->InIndex], Data, Count);
+            if(DataBuffer->Tail)
+               DataBuffer->Tail->Next = Buffer;
+            else
+               DataBuffer->Head       = Buffer;
 
-            /* Update the counts.                                       */
-            DataBuffer->InIndex   += Count;
-            DataBuffer->BytesFree -= Count;
-            DataLength            -= Count;
-            BytesAdded            += Count;
-            Data                  += Count;
-
-            /* Wrap the InIndex if necessary.                           */
-            if(DataBuffer->InIndex >= DataBuffer->BufferSize)
-               DataBuffer->InIndex = 0;
+            DataBuffer->Tail = Buffer;
          }
-         else
-            break;
+      }
+
+      if(Buffer)
+      {
+         /* Cap the space at what is left in the buffer and what may    */
+         /* still be queued.                                            */
+         Count   = SPPLE_DATA_BUFFER_LENGTH - Buffer->Length;
+         Count   = (DataBuffer->BytesFree < Count)?DataBuffer->BytesFree:Count;
+         *Length = (*Length > Count)?Count:*Length;
+
+         ret_val = &(Buffer->Data[Buffer->Length]);
       }
    }
 
-   return(BytesAdded);
+   return(ret_val);
+}
+
+   /* The following function is a utility function that is used to add  */
+   /* the specified number of bytes, written into the space returned by */
+   /* a previous call to ReserveBufferSpace(), to the buffer specified  */
+   /* by the DataBuffer parameter.                                      */
+static void CommitBufferSpace(SPPLE_Data_Buffer_t *DataBuffer, unsigned int Length)
+{
+   DataBuffer->Tail->Length += Length;
+   DataBuffer->BytesFree    -= Length;
+}
+
+   /* The following function is a utility function that is used to      */
+   /* access the oldest data in the buffer specified by the DataBuffer  */
+   /* parameter without removing it.  The second parameter is used to   */
+   /* return the number of contiguous bytes available.  This function   */
+   /* returns a pointer to the data, or NULL if the buffer is empty.    */
+static uint8_t *PeekBuffer(SPPLE_Data_Buffer_t *DataBuffer, unsigned int *Length)
+{
+   uint8_t *ret_val;
+
+   if((DataBuffer) && (DataBuffer->Head) && (DataBuffer->Head->Offset < DataBuffer->Head->Length))
+   {
+      *Length = DataBuffer->Head->Length - DataBuffer->Head->Offset;
+      ret_val = &(DataBuffer->Head->Data[DataBuffer->Head->Offset]);
+   }
+   else
+      ret_val = NULL;
+
+   return(ret_val);
 }
 
    /* The following function is a utility function that is used to      */
-   /* removed data (using OutIndex as the buffer index) from the buffer */
-   /* specified by the DataBuffer parameter The second parameter        */
-   /* specifies the length of the Buffer that is pointed to by the third*/
-   /* parameter.  This function returns the actual number of bytes that */
-   /* were removed from the DataBuffer (or 0 if none were added).       */
-   /* * NOTE * Buffer is optional and if not specified up to            */
-   /*          BufferLength bytes will be deleted from the Buffer.      */
-static unsigned int RemoveDataFromBuffer(SPPLE_Data_Buffer_t *DataBuffer, unsigned int BufferLength, uint8_t *Buffer)
-{
-   unsigned int Count;
-   unsigned int BytesRemoved = 0;
-   unsigned int MaxRemove;
+   /* remove the specified number of bytes from the front of the buffer */
+   /* specified by the DataBuffer parameter.  Every pool buffer that    */
+   /* has been completely consumed is released back to the pool.  This */
+   /* function returns the number of bytes released, which is the       */
+   /* number of bytes that BytesFree grew by.                           */
+   /* * NOTE * A pool buffer is only released once all of its data has */
+   /*          been consumed, so the value returned is always a whole   */
+   /*          number of pool buffers and may be zero.                  */
+static unsigned int ConsumeBuffer(SPPLE_Data_Buffer_t *DataBuffer, unsigned int Length)
+{
+   unsigned int    Count;
+   unsigned int    BytesReleased = 0;
+   SPPLE_Buffer_t *Buffer;
 
    /* Verify that the input parameters are valid.                       */
-   if((DataBuffer) && (BufferLength))
+   if(DataBuffer)
    {
-      /* Loop while we have data to remove and space in the buffer to   */
-      /* place it.                                                      */
-      while(BufferLength)
+      while((Buffer = DataBuffer->Head) != NULL)
       {
-         /* Determine the number of bytes that are present in the       */
-         /* buffer.                                                     */
-         Count = DataBuffer->BufferSize - DataBuffer->BytesFree;
-         if(Count)
+         /* Consume as much of this buffer as requested.                */
+         Count           = Buffer->Length - Buffer->Offset;
+         Count           = (Count > Length)?Length:Count;
+         Buffer->Offset += Count;
+         Length         -= Count;
+
+         /* Release the buffer once all of its data has been consumed.  */
+         if(Buffer->Offset == Buffer->Length)
          {
-            /* Calculate the maximum number of bytes that I can remove  */
-            /* from the buffer before it wraps.                         */
-            MaxRemove = DataBuffer->BufferSize - DataBuffer->OutIndex;
+            DataBuffer->Head = Buffer->Next;
+            if(!DataBuffer->Head)
+               DataBuffer->Tail = NULL;
 
-            /* Cap max we can remove at the BufferLength of the caller's*/
-            /* buffer.                                                  */
-            MaxRemove = (MaxRemove > BufferLength)?BufferLength:MaxRemove;
+            DataBuffer->BytesFree += Buffer->Length;
+            BytesReleased         += Buffer->Length;
 
-            /* Cap the number of bytes I will remove in this iteration  */
-            /* at the maximum I can remove or the number of bytes that  */
-            /* are in the buffer.                                       */
-            Count = (Count > MaxRemove)?MaxRemove:Count;
+            ReleaseBuffer(Buffer);
+         }
+         else
+            break;
+      }
+   }
 
-            /* Copy the data into the caller's buffer (If specified).   */
-            if(Buffer)
-            {
-               memcpy(Buffer, &DataBuffer->Buffer[DataBuffer->OutIndex], Count);
-               Buffer += Count;
-            }
+   return(BytesReleased);
+}
+
+   /* The following function is a utility function that is used to add  */
+   /* data to the end of the buffer specified by the DataBuffer         */
+   /* parameter.  The second and third parameters specified the length  */
+   /* of the data to add and the pointer to the data to add to the      */
+   /* buffer.  This function returns the actual number of bytes that    */
+   /* were added to the buffer (or 0 if none were added).               */
+static unsigned int AddDataToBuffer(SPPLE_Data_Buffer_t *DataBuffer, unsigned int DataLength, uint8_t *Data)
+{
+   uint8_t      *Space;
+   unsigned int  BytesAdded = 0;
+   unsigned int  Count;
+
+   /* Verify that the input parameters are valid.                       */
+   if((DataBuffer) && (DataLength) && (Data))
+   {
+      /* Loop while we have data AND space in the buffer.               */
+      while(DataLength)
+      {
+         Count = DataLength;
+         if((Space = ReserveBufferSpace(DataBuffer, &Count)) != NULL)
+         {
+            /* Copy the data into the buffer.                           */
+            memcpy(Space, Data, Count);
+            CommitBufferSpace(DataBuffer, Count);
 
             /* Update the counts.                                       */
-            DataBuffer->OutIndex  += Count;
-            DataBuffer->BytesFree += Count;
-            BytesRemoved          += Count;
-            BufferLength          -= Count;
-
-            /* Wrap the OutIndex if necessary.                          */
-            if(DataBuffer->OutIndex >= DataBuffer->BufferSize)
-               DataBuffer->OutIndex = 0;
+            DataLength -= Count;
+            BytesAdded += Count;
+            Data       += Count;
          }
          else
             break;
       }
    }
 
-   return(BytesRemoved);
+   return(BytesAdded);
+}
+
+   /* The following function is used to release every pool buffer held */
+   /* by the specified buffer.                                          */
+static void FreeBuffer(SPPLE_Data_Buffer_t *DataBuffer)
+{
+   SPPLE_Buffer_t *Buffer;
+
+   /* Verify that the input parameters are valid.                       */
+   if(DataBuffer)
+   {
+      while((Buffer = DataBuffer->Head) != NULL)
+      {
+         DataBuffer->Head       = Buffer->Next;
+         DataBuffer->BytesFree += Buffer->Length;
+
+         ReleaseBuffer(Buffer);
+      }
+
+      DataBuffer->Tail = NULL;
+   }
 }
 
    /* The following function is used to initialize the specified buffer */
@@ -14518,205 +14668,179 @@ static void InitializeBuffer(SPPLE_Data_Buffer_t *DataBuffer)
    /* Verify that the input parameters are valid.                       */
    if(DataBuffer)
    {
+      /* Release anything left over from a previous connection.         */
+      FreeBuffer(DataBuffer);
+
       DataBuffer->BufferSize = SPPLE_DATA_CREDITS;
       DataBuffer->BytesFree  = SPPLE_DATA_CREDITS;
-      DataBuffer->InIndex    = 0;
-      DataBuffer->OutIndex   = 0;
    }
 }
 
    /* The following function is a utility function that exists to fill  */
    /* the specified buffer with the DataStr that is used to send data.  */
-   /* This function will fill from the CurrentBufferLength up to Max    */
-   /* Length in Buffer.  CurrentBufferLength is used to return the total*/
-   /* length of the buffer.  The first parameter specifies the          */
-   /* DeviceInfo which is used to fill any remainder of the string so   */
-   /* that there are no breaks in the pattern.  This function returns   */
-   /* the number of bytes added to the transmit buffer of the specified */
-   /* device.                                                           */
-static unsigned int FillBufferWithString(SPPLE_Data_Buffer_t *DataBuffer, unsigned *CurrentBufferLength, unsigned int MaxLength, uint8_t *Buffer)
+   /* The pattern is written directly into the buffer and continues     */
+   /* where the previous call left off (SendInfo.DataStrIndex) so that  */
+   /* there are no breaks in the pattern.  This function returns the    */
+   /* number of bytes added to the buffer.                              */
+static unsigned int FillBufferWithString(SPPLE_Data_Buffer_t *DataBuffer, unsigned int Length)
 {
-   unsigned int DataCount;
-   unsigned int Length;
-   unsigned int Added2Buffer = 0;
+   uint8_t      *Space;
+   unsigned int  Added2Buffer = 0;
+   unsigned int  SpaceLength;
+   unsigned int  DataCount;
 
    /* Verify that the input parameter is semi-valid.                    */
-   if((DataBuffer) && (CurrentBufferLength) && (MaxLength) && (Buffer))
+   if((DataBuffer) && (Length))
    {
-      /* Copy as much of the DataStr into the Transmit buffer as is     */
-      /* possible.                                                      */
-      while(*CurrentBufferLength < MaxLength)
+      while(Length)
       {
-         /* Cap the data to copy at the maximum of the string length and*/
-         /* the remaining amount that can be placed in the buffer.      */
-         DataCount = (DataStrLen > (MaxLength-*CurrentBufferLength))?(MaxLength-*CurrentBufferLength):DataStrLen;
+         SpaceLength = Length;
+         if((Space = ReserveBufferSpace(DataBuffer, &SpaceLength)) != NULL)
+         {
+            Length       -= SpaceLength;
+            Added2Buffer += SpaceLength;
 
-         /* Build the data string into the SPPLEBuffer.                 */
-         memcpy(&Buffer[*CurrentBufferLength], DataStr, DataCount);
+            /* Copy the DataStr into the reserved space, wrapping at    */
+            /* the end of the string.                                   */
+            while(SpaceLength)
+            {
+               DataCount = DataStrLen - SendInfo.DataStrIndex;
+               DataCount = (DataCount > SpaceLength)?SpaceLength:DataCount;
 
-         /* Increment the index.                                        */
-         *CurrentBufferLength += DataCount;
+               memcpy(Space, &DataStr[SendInfo.DataStrIndex], DataCount);
 
-         /* Add whatever bytes remaining in the DataStr into the        */
-         /* transmit buffer to keep the pattern consistent.             */
-         Length = DataStrLen-DataCount;
-         if(Length)
-         {
-            /* Add the bytes remaining in the string.                   */
-            Added2Buffer += AddDataToBuffer(DataBuffer, Length, (uint8_t *)&DataStr[DataCount]);
+               CommitBufferSpace(DataBuffer, DataCount);
+
+               Space                 += DataCount;
+               SpaceLength           -= DataCount;
+               SendInfo.DataStrIndex += DataCount;
+               if(SendInfo.DataStrIndex >= DataStrLen)
+                  SendInfo.DataStrIndex = 0;
+            }
          }
+         else
+            break;
       }
    }
 
    return(Added2Buffer);
 }
 
+   /* The following function returns the largest number of SPPLE data  */
+   /* bytes that fit in a single notification or write to the specified */
+   /* device.                                                           */
+static unsigned int GetMaximumDataLength(DeviceInfo_t *DeviceInfo)
+{
+   unsigned int ret_val;
+
+   /* Until the ATT MTU is known let the stack decide how much is sent.*/
+   if(DeviceInfo->MTU > QAPI_BLE_ATT_HANDLE_VALUE_NOTIFICATION_PDU_SIZE(0))
+   {
+      ret_val = DeviceInfo->MTU - QAPI_BLE_ATT_HANDLE_VALUE_NOTIFICATION_PDU_SIZE(0);
+      ret_val = (ret_val > SPPLE_DATA_BUFFER_LENGTH)?SPPLE_DATA_BUFFER_LENGTH:ret_val;
+   }
+   else
+      ret_val = SPPLE_DATA_BUFFER_LENGTH;
+
+   return(ret_val);
+}
+
+   /* The following function sends the specified data to the specified  */
+   /* device using the correct API for the SPPLE role of the device.    */
+   /* This function returns the number of bytes sent, zero if the       */
+   /* device is not configured to receive data or a negative error code.*/
+static int WriteSPPLEData(DeviceInfo_t *DeviceInfo, unsigned int DataLength, uint8_t *Data)
+{
+   int ret_val;
+
+   /* Use the correct API based on device role for SPPLE.               */
+   if(DeviceInfo->Flags & DEVICE_INFO_FLAGS_SPPLE_SERVER)
+   {
+      /* We are acting as SPPLE Server, so notify the Tx Characteristic.*/
+      if(DeviceInfo->ServerInfo.Tx_Client_Configuration_Descriptor == QAPI_BLE_GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_NOTIFY_ENABLE)
+         ret_val = qapi_BLE_GATT_Handle_Value_Notification(BluetoothStackID, SPPLEServiceID, DeviceInfo->ConnectionID, SPPLE_TX_CHARACTERISTIC_ATTRIBUTE_OFFSET, (uint16_t)DataLength, Data);
+      else
+         ret_val = 0;
+   }
+   else
+   {
+      /* We are acting as SPPLE Client, so write to the Rx              */
+      /* Characteristic.                                                */
+      if(DeviceInfo->ClientInfo.Tx_Characteristic)
+         ret_val = qapi_BLE_GATT_Write_Without_Response_Request(BluetoothStackID, DeviceInfo->ConnectionID, DeviceInfo->ClientInfo.Rx_Characteristic, (uint16_t)DataLength, Data);
+      else
+         ret_val = 0;
+   }
+
+   return(ret_val);
+}
+
    /* The following function is responsible for handling a Send Process.*/
+   /* The data string is written directly into the transmit buffer, one */
+   /* notification at a time, and sent from there.                      */
 static void SendProcess(DeviceInfo_t *DeviceInfo)
 {
-   int          Result;
-   boolean_t    Done = FALSE;
-   unsigned int TransmitIndex;
-   unsigned int DataCount;
-   unsigned int MaxLength;
-   unsigned int SPPLEBufferLength;
-   unsigned int Added2Buffer;
+   int           Result;
+   uint8_t      *Data;
+   boolean_t     Done = FALSE;
+   unsigned int  DataCount;
+   unsigned int  MaxLength;
 
    /* Verify that the input parameter is semi-valid.                    */
    if(DeviceInfo)
    {
       /* Loop while we have data to send and we have not used up all    */
       /* Transmit Credits.                                              */
-      TransmitIndex     = 0;
-      SPPLEBufferLength = 0;
-      Added2Buffer      = 0;
       while((SendInfo.BytesToSend) && (DeviceInfo->TransmitCredits) && (!Done))
       {
          /* Get the maximum length of what we can send in this          */
          /* transaction.                                                */
          MaxLength = (SendInfo.BytesToSend > DeviceInfo->TransmitCredits)?DeviceInfo->TransmitCredits:SendInfo.BytesToSend;
-         MaxLength = (MaxLength > SPPLE_DATA_BUFFER_LENGTH)?SPPLE_DATA_BUFFER_LENGTH:MaxLength;
+         MaxLength = (MaxLength > GetMaximumDataLength(DeviceInfo))?GetMaximumDataLength(DeviceInfo):MaxLength;
 
-         /* If we do not have any outstanding data get some more data.  */
-         if(!SPPLEBufferLength)
-         {
-            /* Send any buffered data first.                            */
-            if(DeviceInfo->TransmitBuffer.BytesFree != DeviceInfo->TransmitBuffer.BufferSize)
-            {
-               /* Remove the queued data from the Transmit Buffer.      */
-               SPPLEBufferLength = RemoveDataFromBuffer(&(DeviceInfo->TransmitBuffer), MaxLength, SPPLEBuffer);
-
-               /* If we added some data to the transmit buffer decrement*/
-               /* what we just removed.                                 */
-               if(Added2Buffer)
-                  Added2Buffer -= SPPLEBufferLength;
-            }
-
-            /* Fill up the rest of the buffer with the data string.     */
-            Added2Buffer     += FillBufferWithString(&(DeviceInfo->TransmitBuffer), &SPPLEBufferLength, MaxLength, SPPLEBuffer);
-
-            /* Set the count of data that we can send.                  */
-            DataCount         = SPPLEBufferLength;
+         /* Send any buffered data first, otherwise build the next      */
+         /* notification in the transmit buffer.                        */
+         if(DeviceInfo->TransmitBuffer.BytesFree == DeviceInfo->TransmitBuffer.BufferSize)
+            FillBufferWithString(&(DeviceInfo->TransmitBuffer), MaxLength);
 
-            /* Reset the Transmit Index to 0.                           */
-            TransmitIndex     = 0;
-         }
-         else
+         if((Data = PeekBuffer(&(DeviceInfo->TransmitBuffer), &DataCount)) != NULL)
          {
-            /* Move the data that to the beginning of the buffer.       */
-            memmove(SPPLEBuffer, &SPPLEBuffer[TransmitIndex], SPPLEBufferLength);
-
-            /* Send any buffered data first.                            */
-            if(DeviceInfo->TransmitBuffer.BytesFree != DeviceInfo->TransmitBuffer.BufferSize)
-            {
-               /* Remove the queued data from the Transmit Buffer.      */
-               TransmitIndex = RemoveDataFromBuffer(&(DeviceInfo->TransmitBuffer), MaxLength-SPPLEBufferLength, &SPPLEBuffer[SPPLEBufferLength]);
-
-               /* If we added some data to the transmit buffer decrement*/
-               /* what we just removed.                                 */
-               if(Added2Buffer)
-                  Added2Buffer -= TransmitIndex;
+            /* Cap the data at the maximum that can be transmitted.     */
+            DataCount = (DataCount > MaxLength)?MaxLength:DataCount;
 
-               /* Increment the buffer length.                          */
-               SPPLEBufferLength += TransmitIndex;
-            }
-
-            /* Reset the Transmit Index to 0.                           */
-            TransmitIndex     = 0;
-
-            /* Fill up the rest of the buffer with the data string.     */
-            Added2Buffer += FillBufferWithString(&(DeviceInfo->TransmitBuffer), &SPPLEBufferLength, MaxLength, SPPLEBuffer);
-
-            /* We have data to send so cap it at the maximum that can be*/
-            /* transmitted.                                             */
-            DataCount     = (SPPLEBufferLength > MaxLength)?MaxLength:SPPLEBufferLength;
-         }
-
-         /* Use the correct API based on device role for SPPLE.         */
-         if(DeviceInfo->Flags & DEVICE_INFO_FLAGS_SPPLE_SERVER)
-         {
-            /* We are acting as SPPLE Server, so notify the Tx          */
-            /* Characteristic.                                          */
-            if(DeviceInfo->ServerInfo.Tx_Client_Configuration_Descriptor == QAPI_BLE_GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_NOTIFY_ENABLE)
-               Result = qapi_BLE_GATT_Handle_Value_Notification(BluetoothStackID, SPPLEServiceID, DeviceInfo->ConnectionID, SPPLE_TX_CHARACTERISTIC_ATTRIBUTE_OFFSET, (uint16_t)DataCount, SPPLEBuffer);
-            else
-            {
-               /* Not configured for notifications so exit the loop.    */
-               Done = TRUE;
-            }
-         }
-         else
-         {
-            /* We are acting as SPPLE Client, so write to the Rx        */
-            /* Characteristic.                                          */
-            if(DeviceInfo->ClientInfo.Tx_Characteristic)
-               Result = qapi_BLE_GATT_Write_Without_Response_Request(BluetoothStackID, DeviceInfo->ConnectionID, DeviceInfo->ClientInfo.Rx_Characteristic, (uint16_t)DataCount, SPPLEBuffer);
-            else
-            {
-               /* We have not discovered the Tx Characteristic, so exit */
-               /* the loop.                                             */
-               Done = TRUE;
-            }
-         }
-
-         /* Check to see if any data was written.                       */
-         if(!Done)
-         {
             /* Check to see if the data was written successfully.       */
-            if(Result >= 0)
+            if((Result = WriteSPPLEData(DeviceInfo, DataCount, Data)) > 0)
             {
                /* Adjust the counters.                                  */
                SendInfo.BytesToSend        -= (unsigned int)Result;
                SendInfo.BytesSent          += (unsigned int)Result;
-               TransmitIndex               += (unsigned int)Result;
-               SPPLEBufferLength           -= (unsigned int)Result;
                DeviceInfo->TransmitCredits -= (unsigned int)Result;
 
-               /* If we have no more remaining Tx Credits AND we have   */
-               /* data built up to send, we need to queue this in the Tx*/
-               /* Buffer.                                               */
-               if((!(DeviceInfo->TransmitCredits)) && (SPPLEBufferLength))
-               {
-                  /* Add the remaining data to the transmit buffer.     */
-                  AddDataToBuffer(&(DeviceInfo->TransmitBuffer), SPPLEBufferLength, &SPPLEBuffer[TransmitIndex]);
-
-                  SPPLEBufferLength = 0;
-               }
+               /* Anything that did not go out stays queued in the      */
+               /* transmit buffer.                                      */
+               ConsumeBuffer(&(DeviceInfo->TransmitBuffer), (unsigned int)Result);
             }
             else
             {
-               QCLI_Printf(spple_group, "SEND failed with error %d\n", Result);
+               if(Result < 0)
+               {
+                  QCLI_Printf(spple_group, "SEND failed with error %d\n", Result);
 
-               SendInfo.BytesToSend  = 0;
+                  SendInfo.BytesToSend  = 0;
+               }
+
+               /* Exit the loop.                                        */
+               Done = TRUE;
             }
          }
+         else
+         {
+            /* The buffer pool is exhausted, so wait for the queued     */
+            /* data to go out.                                          */
+            Done = TRUE;
+         }
       }
 
-      /* If we have added more bytes to the transmit buffer than we can */
-      /* send in this process remove the extra.                         */
-      if(Added2Buffer > SendInfo.BytesToSend)
-         RemoveDataFromBuffer(&(DeviceInfo->TransmitBuffer), Added2Buffer-SendInfo.BytesToSend, NULL);
-
       /* Display a message if we have sent all required data.           */
       if((!SendInfo.BytesToSend) && (SendInfo.BytesSent))
       {
@@ -14788,172 +14912,104 @@ static boolean_t ReceiveCreditEvent(DeviceInfo_t *DeviceInfo, unsigned int Credi
 
    /* The following function sends the specified data to the specified  */
    /* data.  This function will queue any of the data that does not go  */
-   /* out.  This function returns TRUE if all the data was sent, or     */
-   /* FALSE.                                                            */
+   /* out.  This function returns the number of bytes of Data that were */
+   /* either sent or queued, which may be less than DataLength if the   */
+   /* transmit buffer is full.                                          */
    /* * NOTE * If DataLength is 0 and Data is NULL then all queued data */
    /*          will be sent.                                            */
-static boolean_t SendData(DeviceInfo_t *DeviceInfo, unsigned int DataLength, uint8_t *Data)
+   /* * NOTE * Queued data is sent directly from the transmit buffer    */
+   /*          and the specified data directly from Data, so data is    */
+   /*          only copied if it has to be queued.                      */
+static unsigned int SendData(DeviceInfo_t *DeviceInfo, unsigned int DataLength, uint8_t *Data)
 {
-   int          Result;
-   boolean_t    DataSent = FALSE;
-   boolean_t    Done;
-   unsigned int DataCount;
-   unsigned int MaxLength;
-   unsigned int TransmitIndex;
-   unsigned int SPPLEBufferLength;
+   int           Result;
+   uint8_t      *QueuedData;
+   unsigned int  BytesAccepted = 0;
+   boolean_t     Done;
+   unsigned int  DataCount;
+   unsigned int  MaxLength;
 
    /* Verify that the input parameters are semi-valid.                  */
    if(DeviceInfo)
    {
       /* Loop while we have data to send and we can send it.            */
-      Done              = FALSE;
-      TransmitIndex     = 0;
-      SPPLEBufferLength = 0;
-      while(!Done)
+      Done = FALSE;
+      while((!Done) && (DeviceInfo->TransmitCredits))
       {
-         /* Check to see if we have credits to use to transmit the data.*/
-         if(DeviceInfo->TransmitCredits)
-         {
-            /* Get the maximum length of what we can send in this       */
-            /* transaction.                                             */
-            MaxLength = (SPPLE_DATA_BUFFER_LENGTH > DeviceInfo->TransmitCredits)?DeviceInfo->TransmitCredits:SPPLE_DATA_BUFFER_LENGTH;
+         /* Get the maximum length of what we can send in this          */
+         /* transaction.                                                */
+         MaxLength = GetMaximumDataLength(DeviceInfo);
+         MaxLength = (MaxLength > DeviceInfo->TransmitCredits)?DeviceInfo->TransmitCredits:MaxLength;
 
-            /* If we do not have any outstanding data get some more     */
-            /* data.                                                    */
-            if(!SPPLEBufferLength)
+         /* Send any buffered data first.                               */
+         if((QueuedData = PeekBuffer(&(DeviceInfo->TransmitBuffer), &DataCount)) != NULL)
+         {
+            DataCount = (DataCount > MaxLength)?MaxLength:DataCount;
+            Result    = WriteSPPLEData(DeviceInfo, DataCount, QueuedData);
+            if(Result > 0)
+               ConsumeBuffer(&(DeviceInfo->TransmitBuffer), (unsigned int)Result);
+         }
+         else
+         {
+            /* Check to see if we have data to send.                    */
+            if((DataLength) && (Data))
             {
-               /* Send any buffered data first.                         */
-               if(DeviceInfo->TransmitBuffer.BytesFree != DeviceInfo->TransmitBuffer.BufferSize)
+               DataCount = (DataLength > MaxLength)?MaxLength:DataLength;
+               Result    = WriteSPPLEData(DeviceInfo, DataCount, Data);
+               if(Result > 0)
                {
-                  /* Remove the queued data from the Transmit Buffer.   */
-                  SPPLEBufferLength = RemoveDataFromBuffer(&(DeviceInfo->TransmitBuffer), MaxLength, SPPLEBuffer);
+                  DataLength    -= (unsigned int)Result;
+                  Data          += Result;
+                  BytesAccepted += (unsigned int)Result;
                }
-               else
-               {
-                  /* Check to see if we have data to send.              */
-                  if((DataLength) && (Data))
-                  {
-                     /* Copy the data to send into the SPPLEBuffer.     */
-                     SPPLEBufferLength = (DataLength > MaxLength)?MaxLength:DataLength;
-                     memcpy(SPPLEBuffer, Data, SPPLEBufferLength);
-
-                     DataLength -= SPPLEBufferLength;
-                     Data       += SPPLEBufferLength;
-                  }
-                  else
-                  {
-                     /* No data queued or data left to send so exit the */
-                     /* loop.                                           */
-                     Done = TRUE;
-                  }
-               }
-
-               /* Set the count of data that we can send.               */
-               DataCount         = SPPLEBufferLength;
-
-               /* Reset the Transmit Index to 0.                        */
-               TransmitIndex     = 0;
             }
             else
             {
-               /* We have data to send so cap it at the maximum that can*/
-               /* be transmitted.                                       */
-               DataCount = (SPPLEBufferLength > MaxLength)?MaxLength:SPPLEBufferLength;
+               /* No data queued or data left to send so exit the loop. */
+               break;
             }
+         }
 
-            /* Try to write data if not exiting the loop.               */
-            if(!Done)
-            {
-               /* Use the correct API based on device role for SPPLE.   */
-               if(DeviceInfo->Flags & DEVICE_INFO_FLAGS_SPPLE_SERVER)
-               {
-                  /* We are acting as SPPLE Server, so notify the Tx    */
-                  /* Characteristic.                                    */
-                  if(DeviceInfo->ServerInfo.Tx_Client_Configuration_Descriptor == QAPI_BLE_GATT_CLIENT_CONFIGURATION_CHARACTERISTIC_NOTIFY_ENABLE)
-                     Result = qapi_BLE_GATT_Handle_Value_Notification(BluetoothStackID, SPPLEServiceID, DeviceInfo->ConnectionID, SPPLE_TX_CHARACTERISTIC_ATTRIBUTE_OFFSET, (uint16_t)DataCount, &SPPLEBuffer[TransmitIndex]);
-                  else
-                  {
-                     /* Not configured for notifications so exit the    */
-                     /* loop.                                           */
-                     Done = TRUE;
-                  }
-               }
-               else
-               {
-                  /* We are acting as SPPLE Client, so write to the Rx  */
-                  /* Characteristic.                                    */
-                  if(DeviceInfo->ClientInfo.Tx_Characteristic)
-                     Result = qapi_BLE_GATT_Write_Without_Response_Request(BluetoothStackID, DeviceInfo->ConnectionID, DeviceInfo->ClientInfo.Rx_Characteristic, (uint16_t)DataCount, &SPPLEBuffer[TransmitIndex]);
-                  else
-                  {
-                     /* We have not discovered the Tx Characteristic, so*/
-                     /* exit the loop.                                  */
-                     Done = TRUE;
-                  }
-               }
-
-               /* Check to see if any data was written.                 */
-               if(!Done)
-               {
-                  /* Check to see if the data was written successfully. */
-                  if(Result >= 0)
-                  {
-                     /* Adjust the counters.                            */
-                     TransmitIndex               += (unsigned int)Result;
-                     SPPLEBufferLength           -= (unsigned int)Result;
-                     DeviceInfo->TransmitCredits -= (unsigned int)Result;
-
-                     /* Flag that data was sent.                        */
-                     DataSent                     = TRUE;
-
-                     /* If we have no more remaining Tx Credits AND we  */
-                     /* have data built up to send, we need to queue    */
-                     /* this in the Tx Buffer.                          */
-                     if((!(DeviceInfo->TransmitCredits)) && (SPPLEBufferLength))
-                     {
-                        /* Add the remaining data to the transmit       */
-                        /* buffer.                                      */
-                        AddDataToBuffer(&(DeviceInfo->TransmitBuffer), SPPLEBufferLength, &SPPLEBuffer[TransmitIndex]);
-
-                        SPPLEBufferLength = 0;
-                     }
-                  }
-                  else
-                  {
-                     QCLI_Printf(spple_group, "SEND failed with error %d\n", Result);
-
-                     DataSent  = FALSE;
-                  }
-               }
-            }
+         /* Check to see if the data was written successfully.          */
+         if(Result > 0)
+         {
+            /* Adjust the counters.                                     */
+            DeviceInfo->TransmitCredits -= (unsigned int)Result;
          }
          else
          {
-            /* We have no transmit credits, so buffer the data.         */
-            DataCount = AddDataToBuffer(&(DeviceInfo->TransmitBuffer), DataLength, Data);
-            if(DataCount == DataLength)
-               DataSent = TRUE;
-            else
-               DataSent = FALSE;
+            if(Result < 0)
+            {
+               QCLI_Printf(spple_group, "SEND failed with error %d\n", Result);
+
+               DataLength = 0;
+            }
 
             /* Exit the loop.                                           */
-            Done = TRUE;
+            Done     = TRUE;
          }
       }
+
+      /* Queue whatever could not be sent.                              */
+      if((DataLength) && (Data))
+         BytesAccepted += AddDataToBuffer(&(DeviceInfo->TransmitBuffer), DataLength, Data);
    }
 
-   return(DataSent);
+   return(BytesAccepted);
 }
 
    /* The following function is responsible for handling a data         */
    /* indication event.                                                 */
+   /* * NOTE * The data is only valid for the duration of the GATT      */
+   /*          event callback, so anything that cannot be sent or       */
+   /*          consumed straight away is copied into the receive buffer.*/
 static boolean_t DataIndicationEvent(DeviceInfo_t *DeviceInfo, unsigned int DataLength, uint8_t *Data)
 {
-   uint64_t     CurrentTime;
-   boolean_t    ret_val;
-   boolean_t    Done;
-   unsigned int ReadLength;
-   unsigned int Length;
+   uint64_t      CurrentTime;
+   uint8_t      *QueuedData;
+   boolean_t     ret_val;
+   unsigned int  ReadLength;
+   unsigned int  Length;
 
    ret_val = false;
 
@@ -14986,34 +15042,33 @@ static boolean_t DataIndicationEvent(DeviceInfo_t *DeviceInfo, unsigned int Data
       if((AutomaticReadActive) || (LoopbackActive))
       {
          /* Loop until we read all of the data queued.                  */
-         Done = FALSE;
-         while(!Done)
+         while((QueuedData = PeekBuffer(&(DeviceInfo->ReceiveBuffer), &Length)) != NULL)
          {
-            /* If in loopback mode cap what we remove at the max of what*/
-            /* we can send or queue.                                    */
+            /* If in loopback mode cap what we remove at what we can    */
+            /* send or queue and send it straight from the receive      */
+            /* buffer.  Only what SendData() accepted is removed, the   */
+            /* rest stays where it is until more credits arrive.        */
             if(LoopbackActive)
-               ReadLength = (SPPLE_DATA_BUFFER_LENGTH > (DeviceInfo->TransmitCredits + DeviceInfo->TransmitBuffer.BytesFree))?(DeviceInfo->TransmitCredits + DeviceInfo->TransmitBuffer.BytesFree):SPPLE_DATA_BUFFER_LENGTH;
-            else
-               ReadLength = SPPLE_DATA_BUFFER_LENGTH;
+            {
+               Length = (Length > (DeviceInfo->TransmitCredits + DeviceInfo->TransmitBuffer.BytesFree))?(DeviceInfo->TransmitCredits + DeviceInfo->TransmitBuffer.BytesFree):Length;
+
+               if((!Length) || ((Length = SendData(DeviceInfo, Length, QueuedData)) == 0))
+                  break;
+            }
 
-            /* Read all queued data.                                    */
-            Length = ReadData(DeviceInfo, ReadLength, SPPLEBuffer);
-            if(Length > 0)
+            /* If we are displaying the data then do that here.         */
+            if(DisplayRawData)
             {
-               /* If loopback is active, loopback the data.             */
-               if(LoopbackActive)
-                  SendData(DeviceInfo, Length, SPPLEBuffer);
+               Length = (Length > SPPLE_DATA_BUFFER_LENGTH)?SPPLE_DATA_BUFFER_LENGTH:Length;
 
-               /* If we are displaying the data then do that here.      */
-               if(DisplayRawData)
-               {
-                  SPPLEBuffer[Length] = '\0';
-                  QCLI_Printf(spple_group, "%s", (char *)SPPLEBuffer);
-                  ret_val = true;
-               }
+               memcpy(SPPLEBuffer, QueuedData, Length);
+               SPPLEBuffer[Length] = '\0';
+               QCLI_Printf(spple_group, "%s", (char *)SPPLEBuffer);
+               ret_val = true;
             }
-            else
-               Done = TRUE;
+
+            /* Credit every receive buffer that has been emptied.       */
+            SendCredits(DeviceInfo, ConsumeBuffer(&(DeviceInfo->ReceiveBuffer), Length));
          }
 
          /* Only send/display data just received if any is specified in */
@@ -15037,11 +15092,16 @@ static boolean_t DataIndicationEvent(DeviceInfo_t *DeviceInfo, unsigned int Data
                if(LoopbackActive)
                {
                   /* Only queue the data in the receive buffer that we  */
-                  /* cannot send.                                       */
-                  ReadLength = (DataLength > (DeviceInfo->TransmitCredits + DeviceInfo->TransmitBuffer.BytesFree))?(DeviceInfo->TransmitCredits + DeviceInfo->TransmitBuffer.BytesFree):DataLength;
+                  /* cannot send.  Nothing may overtake data that is    */
+                  /* already queued.                                    */
+                  if(DeviceInfo->ReceiveBuffer.BytesFree == DeviceInfo->ReceiveBuffer.BufferSize)
+                     ReadLength = (DataLength > (DeviceInfo->TransmitCredits + DeviceInfo->TransmitBuffer.BytesFree))?(DeviceInfo->TransmitCredits + DeviceInfo->TransmitBuffer.BytesFree):DataLength;
+                  else
+                     ReadLength = 0;
 
-                  /* Send the data.                                     */
-                  if(SendData(DeviceInfo, ReadLength, Data))
+                  /* Send the data.  Only what SendData() sent or queued*/
+                  /* is removed, the rest is queued below.              */
+                  if((ReadLength) && ((ReadLength = SendData(DeviceInfo, ReadLength, Data)) != 0))
                   {
                      /* Credit the data we just sent.                   */
                      SendCredits(DeviceInfo, ReadLength);
@@ -15113,31 +15173,31 @@ static boolean_t DataIndicationEvent(DeviceInfo_t *DeviceInfo, unsigned int Data
    /* negative error code.                                              */
 static int ReadData(DeviceInfo_t *DeviceInfo, unsigned int BufferLength, uint8_t *Buffer)
 {
-   int          ret_val;
-   boolean_t    Done;
-   unsigned int Length;
-   unsigned int TotalLength;
+   int           ret_val;
+   uint8_t      *QueuedData;
+   unsigned int  Length;
+   unsigned int  TotalLength;
+   unsigned int  BytesReleased;
 
    /* Verify that the input parameters are semi-valid.                  */
    if((DeviceInfo) && (BufferLength) && (Buffer))
    {
-      Done        = FALSE;
-      TotalLength = 0;
-      while(!Done)
+      TotalLength   = 0;
+      BytesReleased = 0;
+      while((BufferLength) && ((QueuedData = PeekBuffer(&(DeviceInfo->ReceiveBuffer), &Length)) != NULL))
       {
-         Length = RemoveDataFromBuffer(&(DeviceInfo->ReceiveBuffer), BufferLength, Buffer);
-         if(Length > 0)
-         {
-            BufferLength -= Length;
-            Buffer       += Length;
-            TotalLength   = Length;
-         }
-         else
-            Done = TRUE;
+         Length = (Length > BufferLength)?BufferLength:Length;
+
+         memcpy(Buffer, QueuedData, Length);
+
+         BytesReleased += ConsumeBuffer(&(DeviceInfo->ReceiveBuffer), Length);
+         BufferLength  -= Length;
+         Buffer        += Length;
+         TotalLength   += Length;
       }
 
-      /* Credit what we read.                                           */
-      SendCredits(DeviceInfo, TotalLength);
+      /* Credit every receive buffer that has been emptied.             */
+      SendCredits(DeviceInfo, BytesReleased);
 
       /* Return the total number of bytes read.                         */
       ret_val = (int)TotalLength;
@@ -15554,7 +15614,7 @@ static void QAPI_BLE_BTPSAPI GAP_LE_Event_Callback(uint32_t BluetoothStackID, qa
                   /* address type.  This function will update the entry */
                   /* if it is found to already exist and resolution is  */
                   /* now being done in the controller.                  */
-                  if((DeviceInfo = SearchDeviceInfoEntryTypeAddress(&DeviceInfoList, GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data->Peer_Address_Type, GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data->Peer_Address)) != NULL)
+                  if((DeviceInfo = SearchDeviceInfoEntryTypeAddress(GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data->Peer_Address_Type, GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data->Peer_Address)) != NULL)
                   {
                      uint8_t            Peer_Identity_Address_Type;
                      uint8_t            StatusResult;
@@ -15715,7 +15775,7 @@ static void QAPI_BLE_BTPSAPI GAP_LE_Event_Callback(uint32_t BluetoothStackID, qa
                      {
                         /* Search for the entry for this slave to store */
                         /* the information into.                        */
-                        if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, Authentication_Event_Data->BD_ADDR)) != NULL)
+                        if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(Authentication_Event_Data->BD_ADDR)) != NULL)
                         {
                            /* Check to see if the LTK is valid.         */
                            if(DeviceInfo->Flags & DEVICE_INFO_FLAGS_LTK_VALID)
@@ -15782,7 +15842,7 @@ static void QAPI_BLE_BTPSAPI GAP_LE_Event_Callback(uint32_t BluetoothStackID, qa
                         /* the device.  If we have paired we will       */
                         /* attempt to re-establish security using a     */
                         /* previously exchanged LTK.                    */
-                        if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, Authentication_Event_Data->BD_ADDR)) != NULL)
+                        if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(Authentication_Event_Data->BD_ADDR)) != NULL)
                         {
                            /* Determine if a Valid Long Term Key is     */
                            /* stored for this device.                   */
@@ -16157,7 +16217,7 @@ static void QAPI_BLE_BTPSAPI GAP_LE_Event_Callback(uint32_t BluetoothStackID, qa
                      /* delete the LTK.                                 */
                      if(Authentication_Event_Data->Authentication_Event_Data.Security_Establishment_Complete.Status == QAPI_BLE_GAP_LE_SECURITY_ESTABLISHMENT_STATUS_CODE_LONG_TERM_KEY_ERROR)
                      {
-                        if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, Authentication_Event_Data->BD_ADDR)) != NULL)
+                        if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(Authentication_Event_Data->BD_ADDR)) != NULL)
                         {
                            /* Clear the flag indicating the LTK is      */
                            /* valid.                                    */
@@ -16232,7 +16292,7 @@ static void QAPI_BLE_BTPSAPI GAP_LE_Event_Callback(uint32_t BluetoothStackID, qa
 
                      /* Search for the entry for this slave to store the*/
                      /* information into.                               */
-                     if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, Authentication_Event_Data->BD_ADDR)) != NULL)
+                     if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(Authentication_Event_Data->BD_ADDR)) != NULL)
                      {
                         memcpy(&(DeviceInfo->LTK), &(Authentication_Event_Data->Authentication_Event_Data.Encryption_Information.LTK), sizeof(DeviceInfo->LTK));
                         DeviceInfo->EDIV              = Authentication_Event_Data->Authentication_Event_Data.Encryption_Information.EDIV;
@@ -16251,7 +16311,7 @@ static void QAPI_BLE_BTPSAPI GAP_LE_Event_Callback(uint32_t BluetoothStackID, qa
 
                      /* Search for the entry for this slave to store the*/
                      /* information into.                               */
-                     if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, Authentication_Event_Data->BD_ADDR)) != NULL)
+                     if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(Authentication_Event_Data->BD_ADDR)) != NULL)
                      {
                         /* Store the identity information for the remote*/
                         /* device.                                      */
@@ -16389,11 +16449,11 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
                /* Let's try to find the remote device information.  This*/
                /* will be the case if we previously connected and bonded*/
                /* with the remote device.                               */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->RemoteDevice)) == NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->RemoteDevice)) == NULL)
                {
                   /* This MUST be a new remote device so we will create */
                   /* a remote device information entry.                 */
-                  if((DeviceInfo = CreateNewDeviceInfoEntry(&DeviceInfoList, GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->RemoteDevice)) == NULL)
+                  if((DeviceInfo = CreateNewDeviceInfoEntry(GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->RemoteDevice)) == NULL)
                      QCLI_Printf(ble_group, "Failed to create remote device information.\n");
                }
 
@@ -16424,7 +16484,7 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
                   /*          update the selected remote device.        */
                   DeviceInfo->RemoteDeviceIsMaster = (LocalDeviceIsMaster) ? FALSE : TRUE;
                   DeviceInfo->RemoteAddressType    = RemoteAddressType;
-                  DeviceInfo->ConnectionID         = ConnectionID;
+                  BLE_Conn_Table_Set_ConnectionID(&DeviceInfoTable, DeviceInfo, ConnectionID);
 
                   /* Set the HIDS Protocol Mode to Report by default.   */
                   HIDS_Protocol_Mode = QAPI_BLE_PM_REPORT_E;
@@ -16436,6 +16496,9 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
                   /* Initialize the Transmit Credits count.             */
                   DeviceInfo->TransmitCredits = 0;
 
+                  /* Store the ATT MTU of the connection.               */
+                  DeviceInfo->MTU = GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_Data->MTU;
+
                   /* Attempt to update the MTU to the maximum supported.*/
                   if(!qapi_BLE_GATT_Query_Maximum_Supported_MTU(BluetoothStackID, &MTU))
                      qapi_BLE_GATT_Exchange_MTU_Request(BluetoothStackID, DeviceInfo->ConnectionID, MTU, GATT_ClientEventCallback_GAPS, 0);
@@ -16480,7 +16543,7 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
                /*          request to each connected remote device.  It */
                /*          will also free the remote device information */
                /*          entries, so we do not need to handle it here.*/
-               if((ConnectionCount) && (DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->RemoteDevice)) != NULL)
+               if((ConnectionCount) && (DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->RemoteDevice)) != NULL)
                {
                   /* Decrement the number of connected remote devices.  */
                   ConnectionCount--;
@@ -16489,6 +16552,10 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
                   /* printed before the disconnection.                  */
                   DisplayThroughput(DeviceInfo);
 
+                  /* Return any queued SPPLE data to the buffer pool.   */
+                  FreeBuffer(&(DeviceInfo->ReceiveBuffer));
+                  FreeBuffer(&(DeviceInfo->TransmitBuffer));
+
                   /* If we have paired with the remote device, then the */
                   /* LTK will be valid and the device information MUST  */
                   /* persist between connections.                       */
@@ -16500,13 +16567,13 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
 
                      /* Reset the GATT Connection ID to indicate that   */
                      /* the remote device is no longer connected.       */
-                     DeviceInfo->ConnectionID = 0;
+                     BLE_Conn_Table_Set_ConnectionID(&DeviceInfoTable, DeviceInfo, 0);
                   }
                   else
                   {
                      /* Remove the remote device information entry from */
                      /* the list since it is no longer needed.          */
-                     if((DeviceInfo = DeleteDeviceInfoEntry(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+                     if((DeviceInfo = DeleteDeviceInfoEntry(SelectedRemoteBD_ADDR)) != NULL)
                      {
                         /* Inform the user the remote device information*/
                         /* is being deleted.                            */
@@ -16526,7 +16593,7 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
                if(ConnectionCount)
                {
                   /* Loop through the device information.               */
-                  DeviceInfo = DeviceInfoList;
+                  DeviceInfo = BLE_Conn_Table_First(&DeviceInfoTable);
                   while(DeviceInfo)
                   {
                      /* Simply check if the GATT Connection ID is       */
@@ -16549,13 +16616,28 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
                      }
 
                      /* Get the next remote device's information.       */
-                     DeviceInfo = DeviceInfo->NextDeviceInfoInfoPtr;
+                     DeviceInfo = BLE_Conn_Table_Next(&DeviceInfoTable, DeviceInfo);
                   }
                }
             }
             else
                QCLI_Printf(ble_group, "Error - Null Disconnection Data.\n");
             break;
+         case QAPI_BLE_ET_GATT_CONNECTION_DEVICE_CONNECTION_MTU_UPDATE_E:
+            if(GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_MTU_Update_Data)
+            {
+               QCLI_Printf(ble_group, "etGATT_Connection_Device_Connection_MTU_Update with size %u: \n", GATT_Connection_Event_Data->Event_Data_Size);
+               QCLI_Printf(ble_group, "   Connection ID:   %u.\n", GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_MTU_Update_Data->ConnectionID);
+               QCLI_Printf(ble_group, "   MTU:             %u.\n", GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_MTU_Update_Data->MTU);
+
+               /* Store the new ATT MTU so that SPPLE data is sent in   */
+               /* notifications of the full size.                       */
+               if((DeviceInfo = SearchDeviceInfoEntryByConnectionID(GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_MTU_Update_Data->ConnectionID)) != NULL)
+                  DeviceInfo->MTU = GATT_Connection_Event_Data->Event_Data.GATT_Device_Connection_MTU_Update_Data->MTU;
+            }
+            else
+               QCLI_Printf(ble_group, "Error - Null MTU Update Data.\n");
+            break;
          case QAPI_BLE_ET_GATT_CONNECTION_SERVER_NOTIFICATION_E:
             if(GATT_Connection_Event_Data->Event_Data.GATT_Server_Notification_Data)
             {
@@ -16563,7 +16645,7 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
 
                /* Find the Device Info for the device that has sent us  */
                /* the notification.                                     */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Connection_Event_Data->Event_Data.GATT_Server_Notification_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Connection_Event_Data->Event_Data.GATT_Server_Notification_Data->RemoteDevice)) != NULL)
                {
                   /* Handle the AIOS notifications.                     */
 
@@ -16802,7 +16884,7 @@ static void QAPI_BLE_BTPSAPI GATT_Service_Discovery_Event_Callback(uint32_t Blue
    {
       DisplayPrompt = true;
 
-      if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+      if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
       {
          switch(GATT_Service_Discovery_Event_Data->Event_Data_Type)
          {
@@ -16869,38 +16951,20 @@ static void QAPI_BLE_BTPSAPI GATT_Service_Discovery_Event_Callback(uint32_t Blue
    }
 }
 
+   /* The following functions queue a servo position change with the   */
+   /* lock actuator.  They return immediately so they may be called     */
+   /* from the AIOS server event callback; the PWM output is driven by  */
+   /* the actuator's worker thread.                                     */
 void open_lock()
 {
-	QCLI_Parameter_t param[5];
-	param[0].Integer_Value = 5000;
-	param[0].Integer_Is_Valid = true;
-	param[1].Integer_Value = 500;
-	param[1].Integer_Is_Valid = true;
-	param[2].Integer_Value = 2000;
-	param[2].Integer_Is_Valid = true;
-	param[3].Integer_Value = 1;
-	param[3].Integer_Is_Valid = true;
-	param[4].Integer_Value = 1;
-	param[4].Integer_Is_Valid = true;
-	
-	pwm_driver_test(5, param);
+   if(!Lock_Actuator_Submit(LOCK_ACTUATOR_COMMAND_OPEN_E))
+      QCLI_Printf(aios_group, "Lock actuator not running.\n");
 }
 
 void close_lock()
 {
-	QCLI_Parameter_t param[5];
-	param[0].Integer_Value = 5000;
-	param[0].Integer_Is_Valid = true;
-	param[1].Integer_Value = 750;
-	param[1].Integer_Is_Valid = true;
-	param[2].Integer_Value = 2000;
-	param[2].Integer_Is_Valid = true;
-	param[3].Integer_Value = 1;
-	param[3].Integer_Is_Valid = true;
-	param[4].Integer_Value = 1;
-	param[4].Integer_Is_Valid = true;
-	
-	pwm_driver_test(5, param);
+   if(!Lock_Actuator_Submit(LOCK_ACTUATOR_COMMAND_CLOSE_E))
+      QCLI_Printf(aios_group, "Lock actuator not running.\n");
 }
 
    /* Generic Attribute Profile (GATT) Service Event Callback function  */
@@ -17167,7 +17231,7 @@ static void QAPI_BLE_BTPSAPI AIOS_EventCallback(uint32_t BluetoothStackID, qapi_
                DisplayAIOSCharacteristicInfo(CharacteristicInfo);
 
                /* Make sure we can get the device information.          */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(RemoteDevice)) != NULL)
                {
                   /* Determine the Characteristic type so we know what  */
                   /* CCCD to send in the response.                      */
@@ -17233,7 +17297,7 @@ static void QAPI_BLE_BTPSAPI AIOS_EventCallback(uint32_t BluetoothStackID, qapi_
                   case QAPI_BLE_ACT_DIGITAL_E:
                   case QAPI_BLE_ACT_ANALOG_E:
                      /* Make sure we can get the device information.    */
-                     if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, RemoteDevice)) != NULL)
+                     if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(RemoteDevice)) != NULL)
                      {
                         /* We will only accept notify or disabled (0).  */
                         if((!ClientConfiguration) || (ClientConfiguration & QAPI_BLE_AIOS_CLIENT_CHARACTERISTIC_CONFIGURATION_NOTIFY_ENABLE))
@@ -17424,7 +17488,7 @@ static void QAPI_BLE_BTPSAPI BAS_EventCallback(uint32_t BluetoothStackID, qapi_B
                QCLI_Printf(bas_group, "   Connection Type:  %s.\n", ((BAS_Event_Data->Event_Data.BAS_Read_Client_Configuration_Data->ConnectionType == QAPI_BLE_GCT_LE_E)?"LE":"BR/EDR"));
                QCLI_Printf(bas_group, "   Remote Device:    %s.\n", BoardStr);
 
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BAS_Event_Data->Event_Data.BAS_Read_Client_Configuration_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BAS_Event_Data->Event_Data.BAS_Read_Client_Configuration_Data->RemoteDevice)) != NULL)
                {
                   switch(BAS_Event_Data->Event_Data.BAS_Read_Client_Configuration_Data->ClientConfigurationType)
                   {
@@ -17460,7 +17524,7 @@ static void QAPI_BLE_BTPSAPI BAS_EventCallback(uint32_t BluetoothStackID, qapi_B
                QCLI_Printf(bas_group, "   Connection Type:  %s.\n", ((BAS_Event_Data->Event_Data.BAS_Client_Configuration_Update_Data->ConnectionType == QAPI_BLE_GCT_LE_E)?"LE":"BR/EDR"));
                QCLI_Printf(bas_group, "   Remote Device:    %s.\n", BoardStr);
 
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, BAS_Event_Data->Event_Data.BAS_Client_Configuration_Update_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(BAS_Event_Data->Event_Data.BAS_Client_Configuration_Update_Data->RemoteDevice)) != NULL)
                {
                   switch(BAS_Event_Data->Event_Data.BAS_Client_Configuration_Update_Data->ClientConfigurationType)
                   {
@@ -17557,7 +17621,7 @@ static void QAPI_BLE_BTPSAPI HIDS_Event_Callback(uint32_t BluetoothStackID, qapi
             if(HIDS_Event_Data->Event_Data.HIDS_Read_Client_Configuration_Data)
             {
                /* Search for the Device entry.                          */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, HIDS_Event_Data->Event_Data.HIDS_Read_Client_Configuration_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(HIDS_Event_Data->Event_Data.HIDS_Read_Client_Configuration_Data->RemoteDevice)) != NULL)
                {
                   QCLI_Printf(hids_group, "HIDS Read Client Configuration Request: %u.\n", HIDS_Event_Data->Event_Data.HIDS_Read_Client_Configuration_Data->ReportType);
 
@@ -17579,7 +17643,7 @@ static void QAPI_BLE_BTPSAPI HIDS_Event_Callback(uint32_t BluetoothStackID, qapi
                QCLI_Printf(hids_group, "HIDS Client Configuration Update: %u.\n", HIDS_Event_Data->Event_Data.HIDS_Client_Configuration_Update_Data->ReportType);
 
                /* Search for the Device entry.                          */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, HIDS_Event_Data->Event_Data.HIDS_Client_Configuration_Update_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(HIDS_Event_Data->Event_Data.HIDS_Client_Configuration_Update_Data->RemoteDevice)) != NULL)
                {
                   if(HIDS_Event_Data->Event_Data.HIDS_Client_Configuration_Update_Data->ReportType == QAPI_BLE_RT_BOOT_KEYBOARD_INPUT_REPORT_E)
                   {
@@ -18123,7 +18187,7 @@ static void QAPI_BLE_BTPSAPI SCPS_EventCallback(uint32_t BluetoothStackID, qapi_
                QCLI_Printf(scps_group, "   Connection Type:  %s.\n", ((SCPS_Event_Data->Event_Data.SCPS_Read_Client_Configuration_Data->ConnectionType == QAPI_BLE_GCT_LE_E)?"LE":"BR/EDR"));
                QCLI_Printf(scps_group, "   Remote Device:    %s.\n", BoardStr);
 
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SCPS_Event_Data->Event_Data.SCPS_Read_Client_Configuration_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SCPS_Event_Data->Event_Data.SCPS_Read_Client_Configuration_Data->RemoteDevice)) != NULL)
                {
                   if(SCPSInstanceID == SCPS_Event_Data->Event_Data.SCPS_Read_Client_Configuration_Data->InstanceID)
                   {
@@ -18167,7 +18231,7 @@ static void QAPI_BLE_BTPSAPI SCPS_EventCallback(uint32_t BluetoothStackID, qapi_
                QCLI_Printf(scps_group, "   Connection Type:  %s.\n", ((SCPS_Event_Data->Event_Data.SCPS_Client_Configuration_Update_Data->ConnectionType == QAPI_BLE_GCT_LE_E)?"LE":"BR/EDR"));
                QCLI_Printf(scps_group, "   Remote Device:    %s.\n", BoardStr);
 
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SCPS_Event_Data->Event_Data.SCPS_Client_Configuration_Update_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SCPS_Event_Data->Event_Data.SCPS_Client_Configuration_Update_Data->RemoteDevice)) != NULL)
                {
                   if(SCPS_Event_Data->Event_Data.SCPS_Client_Configuration_Update_Data->InstanceID == SCPSInstanceID)
                   {
@@ -18266,7 +18330,7 @@ static void QAPI_BLE_BTPSAPI GATT_ServerEventCallback_SPPLE(uint32_t BluetoothSt
       DisplayPrompt = false;
 
       /* Grab the device for the currently connected device.            */
-      if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, SelectedRemoteBD_ADDR)) != NULL)
+      if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(SelectedRemoteBD_ADDR)) != NULL)
       {
          switch(GATT_ServerEventData->Event_Data_Type)
          {
@@ -18661,7 +18725,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_AIOS(uint32_t BluetoothSta
                QCLI_Printf(aios_group, "   Value Length:     %u.\n", ValueLength);
 
                /* Make sure we can get the device information.          */
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(RemoteDevice)) != NULL)
                {
                   /* Process the request depending on the attribute     */
                   /* handle type we set before issuing the read request.*/
@@ -18858,7 +18922,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_BAS(uint32_t BluetoothStac
                ValueLength = GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->AttributeValueLength;
                if(ValueLength != 0)
                {
-                  if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
+                  if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
                   {
                      if(IsBatteryLevelHandle((uint16_t)CallbackParameter, DeviceInfo))
                      {
@@ -18931,7 +18995,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_BAS(uint32_t BluetoothStac
                /* If we know about this device and a callback parameter */
                /* exists, then check if we know what write response this*/
                /* is.                                                   */
-               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
+               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
                {
                   if(IsBASClientConfigurationHandle((uint16_t)CallbackParameter, DeviceInfo))
                      QCLI_Printf(bas_group, "\nWrite Battery Level CC Compete.\n");
@@ -19002,7 +19066,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_HIDS(uint32_t BluetoothSta
             if(GATT_Client_Event_Data->Event_Data.GATT_Request_Error_Data)
             {
                /* Get the device info.                                  */
-               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Request_Error_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
+               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Request_Error_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
                {
                   /* Loop through the HIDS client information array and */
                   /* find the service for this callback parameter.      */
@@ -19135,7 +19199,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_HIDS(uint32_t BluetoothSta
                /* If we know about this device and a callback parameter */
                /* exists, then check if we know what read long response */
                /* this is.                                              */
-               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Read_Long_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
+               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Read_Long_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
                {
                   /* Loop through the HIDS client information array and */
                   /* find the service for this callback parameter.      */
@@ -19262,7 +19326,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_HIDS(uint32_t BluetoothSta
                if(AttributeValueLength != 0)
                {
                   /* Get the device info.                               */
-                  if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
+                  if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
                   {
                      /* Loop through the HIDS client information array  */
                      /* and find the service for this callback          */
@@ -19456,7 +19520,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_HIDS(uint32_t BluetoothSta
                /* If we know about this device and a callback parameter */
                /* exists, then check if we know what write response     */
                /* this is.                                              */
-               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Write_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
+               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Write_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
                {
                   /* Loop through the HIDS client information array and */
                   /* find the service for this callback parameter.      */
@@ -19613,7 +19677,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_GAPS(uint32_t BluetoothSta
             if(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data)
             {
                DisplayPrompt = false;
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL)
                {
                   if((uint16_t)CallbackParameter == DeviceInfo->GAPSClientInfo.DeviceNameHandle)
                   {
@@ -19737,7 +19801,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_HRS(uint32_t BluetoothStac
                /* If we know about this device and a callback parameter */
                /* exists, then check if we know what write response this*/
                /* is.                                                   */
-               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
+               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
                {
                   if(CallbackParameter == DeviceInfo->HRSClientInfo.Heart_Rate_Measurement_Client_Configuration)
                      QCLI_Printf(hrs_group, "\nWrite HRS Measurement CC Complete.\n");
@@ -19848,7 +19912,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_SCPS(uint32_t BluetoothSta
                /* If we know about this device and a callback parameter */
                /* exists, then check if we know what write response this*/
                /* is.                                                   */
-               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
+               if(((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL) && (CallbackParameter != 0))
                {
                   if(CallbackParameter == DeviceInfo->SCPSClientInfo.Scan_Refresh_Client_Configuration)
                      QCLI_Printf(scps_group, "\nWrite Refresh Scan CC Complete.\n");
@@ -19939,7 +20003,7 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_SPPLE(uint32_t BluetoothSt
             {
                DisplayPrompt = false;
 
-               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL)
+               if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(GATT_Client_Event_Data->Event_Data.GATT_Read_Response_Data->RemoteDevice)) != NULL)
                {
                   if((uint16_t)CallbackParameter == DeviceInfo->ClientInfo.Rx_Credit_Characteristic)
                   {
@@ -20199,6 +20263,11 @@ void Initialize_SPPLE_Demo(void)
 
          /* Set the HCI driver information.                             */
          QAPI_BLE_HCI_DRIVER_SET_COMM_INFORMATION(&HCI_DriverInformation, 1, 115200, QAPI_BLE_COMM_PROTOCOL_UART_E);
+
+         /* Start the lock actuator so AIOS writes do not block on the  */
+         /* PWM driver.                                                 */
+         if(!Lock_Actuator_Initialize())
+            QCLI_Printf(aios_group, "Error - failed to start the lock actuator.\n");
       }
       else
       {
@@ -20229,7 +20298,7 @@ unsigned int GetConnectionID(qapi_BLE_BD_ADDR_t RemoteDevice)
    DeviceInfo_t *DeviceInfo;
 
    /* Get the device info for the remote device.                        */
-   if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, RemoteDevice)) != NULL)
+   if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(RemoteDevice)) != NULL)
       RetVal = DeviceInfo->ConnectionID;
    return(RetVal);
 }
@@ -45,6 +45,23 @@ extern "C" {
 
 #define HTC_BLK_SIZE_NEG_COMPLETE_EVT     0x01
 
+/*
+ * Bundling: up to HTC_BUNDLE_FRAMES_MAX frames, each padded to its own block,
+ * are moved in a single multi-block transfer through the extended mailbox
+ * window of the endpoint. The upper bits of the length field in the HTC
+ * header count the frames that follow in the same bundle, so the receiver
+ * knows from the lookahead how many blocks it can read at once.
+ */
+#ifndef HTC_BUNDLE_FRAMES_MAX
+#define HTC_BUNDLE_FRAMES_MAX              8
+#endif
+#define HTC_HEADER_LENGTH_MASK             0x0FFF
+#define HTC_HEADER_BUNDLE_SHIFT            12
+
+#if (HTC_BUNDLE_FRAMES_MAX - 1) > (0xFFFF >> HTC_HEADER_BUNDLE_SHIFT)
+#error "HTC_BUNDLE_FRAMES_MAX does not fit in the HTC header"
+#endif
+
 /* Useful macros */
 #define GET_ENDPOINT_ID(endPoint) (endPoint - endPoint->target->endPoint)
 
@@ -85,6 +102,7 @@ typedef struct htc_reg_buffer HTC_REG_BUFFER;
 typedef struct htc_data_request_queue HTC_DATA_REQUEST_QUEUE;
 typedef struct htc_reg_request_list HTC_REG_REQUEST_LIST;
 typedef struct htc_endpoint HTC_ENDPOINT;
+typedef struct htc_bundle HTC_BUNDLE;
 
 
 
@@ -209,6 +227,18 @@ struct htc_data_request_queue {
     HTC_DATA_REQUEST_ELEMENT  element[HTC_DATA_REQUEST_RING_BUFFER_SIZE];
 };
 
+/* A multi-frame transfer in flight. The request element is what HIF gets as
+the context and completes, the frames are the queue elements of the frames
+carried in the bundle. Frames are copied in and out of buffer, one block
+each. */
+struct htc_bundle {
+    HTC_DATA_REQUEST_ELEMENT     request;   /* must be first */
+    OSAL_BOOL                    busy;
+    OSAL_UINT32                  framesCount;
+    HTC_DATA_REQUEST_ELEMENT    *frames[HTC_BUNDLE_FRAMES_MAX];
+    OSAL_UINT8                  *buffer;
+};
+
 /* This is a list of 'free' register read/write requests. When a request has to 
 be issued an element is taken from this list and after the completion of the 
 request is added back to the list */
@@ -259,6 +289,17 @@ struct htc_endpoint {
 
     /* Stating address of the endpoint */
     OSAL_UINT32                 address;
+
+    /* 
+     * Extended mailbox window for transfers longer than a block and the 
+     * largest bundle it takes. The bundles are NULL when the endpoint does 
+     * not bundle.
+     */
+    OSAL_UINT32                 extendedAddress;
+    OSAL_UINT32                 extendedSize;
+    OSAL_UINT32                 bundleFramesMax;
+    HTC_BUNDLE                 *txBundle;
+    HTC_BUNDLE                 *rxBundle;
 };
 
 /* ------- Target Related Data structures ------- */
@@ -321,6 +362,13 @@ htcReceiveFrame(HTC_ENDPOINT *endPoint);
 OSAL_UINT32
 htcGetFrameLength(HTC_ENDPOINT *endPoint);
 
+OSAL_UINT32
+htcGetFramesFollowing(HTC_ENDPOINT *endPoint);
+
+htc_status_t
+htcRxBundleCompletionCB(HTC_DATA_REQUEST_ELEMENT *element,
+                        htc_status_t status);
+
 
 /* ------- Function Prototypes for Transmit -------- */
 void 
@@ -329,6 +377,10 @@ htcSendFrame(HTC_ENDPOINT *endPoint);
 void
 htcSendBlkSize(HTC_ENDPOINT *endPoint);
 
+htc_status_t
+htcTxBundleCompletionCB(HTC_DATA_REQUEST_ELEMENT *element,
+                        htc_status_t status);
+
 
 /* ------- Function Prototypes for Events and Callbacks  ------- */
 htc_status_t
@@ -347,6 +399,10 @@ htc_status_t
 htcRxCompletionCB(HTC_DATA_REQUEST_ELEMENT *element, 
                   htc_status_t status);
 
+htc_status_t
+htcDeliverRxFrame(HTC_DATA_REQUEST_ELEMENT *element, 
+                  htc_status_t status);
+
 htc_status_t
 htcRegCompletionCB(HTC_REG_REQUEST_ELEMENT *element,
                    htc_status_t status);
@@ -466,6 +522,12 @@ dumpRegisters(HTC_TARGET *target);
 
 htc_status_t getTargetTransport (HTC_TARGET *target, HTC_TARGET_TRANSPORT *trans);
 
+HTC_BUNDLE *
+allocateBundle(HTC_ENDPOINT *endPoint, htc_status_t (*completionCB)(HTC_QUEUE_ELEMENT *element, htc_status_t status));
+
+void
+freeBundle(HTC_BUNDLE *bundle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -533,6 +533,13 @@ htc_status_t htc_host_shutdown(HTC_TARGET *target)
         handle->ready = FALSE;
 
 
+        /* Free the bundles of the endpoints */
+        for (count = ENDPOINT1; count <= ENDPOINT4; count ++)
+        {
+            freeBundle(handle->endPoint[count].txBundle);
+            freeBundle(handle->endPoint[count].rxBundle);
+        }
+
         /* Freeing handle memory */
         delTargetInstance(handle);
 
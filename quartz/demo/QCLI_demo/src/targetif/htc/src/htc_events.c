@@ -240,12 +240,11 @@ htc_status_t htcBlkSzNegCompletionCB(HTC_DATA_REQUEST_ELEMENT *element,
 htc_status_t htcRxCompletionCB(HTC_DATA_REQUEST_ELEMENT *element, 
                   htc_status_t status)
 {
+#ifdef SPI
     HTC_TARGET *target;
     HTC_ENDPOINT *endPoint;
-    HTC_EVENT_INFO eventInfo;
     HTC_ENDPOINT_ID endPointId;
     HTC_ENDPOINT_BUFFER *endpointBuffer;
-#ifdef SPI
 #ifdef MULTIPLE_FRAMES_PER_INTERRUPT
     htc_status_t ret;
     OSAL_UINT32 address;
@@ -256,6 +255,7 @@ htc_status_t htcRxCompletionCB(HTC_DATA_REQUEST_ELEMENT *element,
     HTC_DEBUG_PRINTF(HTC_DEBUG_TRC | HTC_DEBUG_SEND, 
             ("htcRxCompletionCB - Enter\n"));
 
+#ifdef SPI
     /* Get the context */
     endpointBuffer = GET_ENDPOINT_BUFFER(element);
     HTC_DEBUG_ASSERT(endpointBuffer != NULL);
@@ -265,7 +265,6 @@ htc_status_t htcRxCompletionCB(HTC_DATA_REQUEST_ELEMENT *element,
     HTC_DEBUG_ASSERT(target != NULL);
     endPointId = GET_ENDPOINT_ID(endPoint);
 
-#ifdef SPI
 #ifdef MULTIPLE_FRAMES_PER_INTERRUPT
     /* 
      * Scan the lookahead register to see if there are any more 
@@ -290,6 +289,31 @@ htc_status_t htcRxCompletionCB(HTC_DATA_REQUEST_ELEMENT *element,
     OSAL_MUTEX_UNLOCK(&target->statusCS);
 #endif /* MULTIPLE_FRAMES_PER_INTERRUPT */
 #endif /* SPI */
+    return htcDeliverRxFrame(element, status);
+}
+
+/* 
+ * Returns a received frame to the user. Called once per frame, whether the
+ * frame came in its own transfer or in a bundle.
+ */
+htc_status_t htcDeliverRxFrame(HTC_DATA_REQUEST_ELEMENT *element, 
+                  htc_status_t status)
+{
+    HTC_TARGET *target;
+    HTC_ENDPOINT *endPoint;
+    HTC_EVENT_INFO eventInfo;
+    HTC_ENDPOINT_ID endPointId;
+    HTC_ENDPOINT_BUFFER *endpointBuffer;
+
+    /* Get the context */
+    endpointBuffer = GET_ENDPOINT_BUFFER(element);
+    HTC_DEBUG_ASSERT(endpointBuffer != NULL);
+    endPoint = endpointBuffer->endPoint;
+    HTC_DEBUG_ASSERT(endPoint != NULL);
+    target = endPoint->target;
+    HTC_DEBUG_ASSERT(target != NULL);
+    endPointId = GET_ENDPOINT_ID(endPoint);
+
     HTC_DEBUG_PRINTF(HTC_DEBUG_INF | HTC_DEBUG_RECV,
             ("endpointBuffer: 0x%p, buffer: 0x%p, endPoint(%d): 0x%p, target: 0x%p\n", endpointBuffer, endpointBuffer->buffer, endPointId, endPoint, target));
 
@@ -331,7 +355,7 @@ htc_status_t htcRxCompletionCB(HTC_DATA_REQUEST_ELEMENT *element,
      * pointer to the upper layer.
      */
     endpointBuffer->actualLength = ((endpointBuffer->buffer[0] << 0) | 
-            (endpointBuffer->buffer[1] << 8));
+            (endpointBuffer->buffer[1] << 8)) & HTC_HEADER_LENGTH_MASK;
     endpointBuffer->buffer += HTC_HEADER_LEN;
 
     /* 
@@ -657,7 +681,7 @@ htc_status_t htcTargetInsertedHandler(void *context, void *hif_handle, OSAL_BOOL
     HTC_ENDPOINT_BUFFER *endpointBuffer;
     HTC_REG_REQUEST_LIST *regList;
     HTC_DATA_REQUEST_QUEUE *sendQueue, *recvQueue;
-    OSAL_UINT32 address[HTC_MAILBOX_NUM_MAX];
+    HIF_DEVICE_ENDPOINT_INFO endpointInfo;
     OSAL_UINT32 blockSize[HTC_MAILBOX_NUM_MAX];
     HTC_CALLBACKS htcCallbacks;
     htc_status_t status = HTC_OK;
@@ -751,12 +775,37 @@ htc_status_t htcTargetInsertedHandler(void *context, void *hif_handle, OSAL_BOOL
     /* Populate the block size for each of the end points */
     HIFConfigureDevice((HIF_DEVICE *) hif_handle, HIF_DEVICE_GET_ENDPOINT_BLOCK_SIZE, 
             &blockSize, sizeof(blockSize));
+    /* 
+     * HIFs that only report the endpoint addresses leave the extended 
+     * windows zeroed, which keeps bundling off.
+     */
+    OSAL_MEMZERO(&endpointInfo, sizeof(endpointInfo));
     HIFConfigureDevice((HIF_DEVICE *) hif_handle, HIF_DEVICE_GET_ENDPOINT_ADDR, 
-            &address, sizeof(address));
+            &endpointInfo, sizeof(endpointInfo));
     for (count1 = ENDPOINT1; count1 <= ENDPOINT4; count1 ++) {
         endPoint = &target->endPoint[count1];
         endPoint->blockSize = blockSize[count1];
-        endPoint->address = address[count1];
+        endPoint->address = endpointInfo.EndpointAddresses[count1];
+        endPoint->extendedAddress = endpointInfo.EndpointProp[count1].ExtendedAddress;
+        endPoint->extendedSize = endpointInfo.EndpointProp[count1].ExtendedSize;
+        endPoint->bundleFramesMax = 0;
+        endPoint->txBundle = NULL;
+        endPoint->rxBundle = NULL;
+
+        if ((endPoint->blockSize > 1) &&
+                !(endpointInfo.Flags & HIF_ENDPOINT_FLAG_NO_BUNDLING)) {
+            endPoint->bundleFramesMax = endPoint->extendedSize / endPoint->blockSize;
+            if (endPoint->bundleFramesMax > HTC_BUNDLE_FRAMES_MAX) {
+                endPoint->bundleFramesMax = HTC_BUNDLE_FRAMES_MAX;
+            }
+        }
+        if (endPoint->bundleFramesMax > 1) {
+            endPoint->txBundle = allocateBundle(endPoint, htcTxBundleCompletionCB);
+            endPoint->rxBundle = allocateBundle(endPoint, htcRxBundleCompletionCB);
+        }
+        HTC_DEBUG_PRINTF(HTC_DEBUG_INF, 
+                ("endPoint[%d]: bundles of up to %d frames\n", count1, 
+                 (endPoint->txBundle != NULL) ? endPoint->bundleFramesMax : 1));
     }
 
     /* Initialize the shadow copy of the target register table */
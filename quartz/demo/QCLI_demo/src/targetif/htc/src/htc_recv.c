@@ -96,12 +96,72 @@ htc_status_t htc_host_buffer_receive(HTC_TARGET *target,
     return HTC_OK;
 }
 
+/* 
+ * Reads framesCount frames, a block each, in one transfer into the receive 
+ * bundle of the endpoint. The posted buffers are taken off the queue now 
+ * and filled by htcRxBundleCompletionCB.
+ */
+static htc_status_t htcReceiveBundle(HTC_ENDPOINT *endPoint, 
+                 OSAL_UINT32 framesCount)
+{
+    htc_status_t status;
+    OSAL_UINT32 address;
+    OSAL_UINT32 length;
+    OSAL_UINT32 count;
+    HTC_BUNDLE *bundle;
+    HTC_TARGET *target;
+    HTC_DATA_REQUEST_QUEUE *recvQueue;
+
+    target = endPoint->target;
+    recvQueue = &endPoint->recvQueue;
+    bundle = endPoint->rxBundle;
+
+    for (count = 0; count < framesCount; count ++) {
+        bundle->frames[count] = removeFromEndpointQueue(target, recvQueue);
+    }
+    bundle->framesCount = framesCount;
+    bundle->busy = TRUE;
+    bundle->request.buffer.free = FALSE;
+
+    HTC_DEBUG_PRINTF(HTC_DEBUG_INF | HTC_DEBUG_RECV, 
+            ("Bundle of %d frames\n", framesCount));
+
+    /* Like a write, the read ends on the last byte of the extended window */
+    length = framesCount * endPoint->blockSize;
+    address = endPoint->extendedAddress + endPoint->extendedSize - length;
+    status = HIFReadWrite(target->device, address, bundle->buffer, length, 
+            HIF_RD_ASYNC_BLOCK_INC, &bundle->request);
+#ifndef HTC_SYNC
+    if (status != HTC_OK)
+#else
+    if (status != HTC_OK && status != HTC_PENDING)
+#endif
+    {
+        HTC_DEBUG_PRINTF(HTC_DEBUG_ERR | HTC_DEBUG_RECV, 
+                ("Bundle reception failed\n"));
+        /* Return the buffers unless the callback did it already */
+        if (bundle->busy) {
+            htcRxBundleCompletionCB(&bundle->request, HTC_ECANCELED);
+        }
+        return status;
+    }
+#ifdef HTC_SYNC
+    else if (status == HTC_OK)
+    {
+        bundle->request.completionCB(&bundle->request, status);
+    }
+#endif
+
+    return status;
+}
+
 htc_status_t htcReceiveFrame(HTC_ENDPOINT *endPoint)
 {
     htc_status_t status = HTC_OK;
     OSAL_UINT32 address;
     OSAL_UINT32 paddedLength;
     OSAL_UINT32 frameLength;
+    OSAL_UINT32 framesCount;
     OSAL_UINT32 request;
     HTC_ENDPOINT_ID endPointId;
     HTC_QUEUE_ELEMENT *element;
@@ -163,6 +223,26 @@ htc_status_t htcReceiveFrame(HTC_ENDPOINT *endPoint)
     paddedLength = (frameLength + (endPoint->blockSize - 1)) &
         (~(endPoint->blockSize - 1));
 
+    /* 
+     * Pull the frames the target bundled behind this one in the same 
+     * transfer when there are buffers posted for them.
+     */
+    framesCount = 1 + htcGetFramesFollowing(endPoint);
+    if (framesCount > recvQueue->size) {
+        framesCount = recvQueue->size;
+    }
+    if (framesCount > endPoint->bundleFramesMax) {
+        framesCount = endPoint->bundleFramesMax;
+    }
+    if ((framesCount > 1) && (paddedLength == endPoint->blockSize) &&
+            (endPoint->rxBundle != NULL) && !endPoint->rxBundle->busy)
+    {
+        status = htcReceiveBundle(endPoint, framesCount);
+        HTC_DEBUG_PRINTF(HTC_DEBUG_TRC | HTC_DEBUG_RECV, 
+                ("htcReceiveFrame - Exit\n"));
+        return status;
+    }
+
     /* 
      * Receive the frame(s). Pull an empty buffer from the head of the 
      * Pending Receive Queue.
@@ -240,11 +320,88 @@ OSAL_UINT32 htcGetFrameLength(HTC_ENDPOINT *endPoint)
     }  
 
     /* The length is contained in the first two bytes - HTC_HEADER_LEN */
-    frameLength = (target->table.rx_lookahead[endPointId] & 0xFFFF) +
-        HTC_HEADER_LEN;
+    frameLength = (target->table.rx_lookahead[endPointId] & 
+            HTC_HEADER_LENGTH_MASK) + HTC_HEADER_LEN;
     HTC_DEBUG_ASSERT(frameLength);
     HTC_DEBUG_PRINTF(HTC_DEBUG_WARN | HTC_DEBUG_RECV,
             ("frameLength = %x\n", frameLength));
 
     return frameLength;
 }
+
+/* 
+ * Returns the number of frames the target bundled behind the one in the 
+ * lookahead. Only valid after htcGetFrameLength.
+ */
+OSAL_UINT32 htcGetFramesFollowing(HTC_ENDPOINT *endPoint)
+{
+    HTC_TARGET *target;
+    HTC_ENDPOINT_ID endPointId;
+
+    target = endPoint->target;
+    endPointId = GET_ENDPOINT_ID(endPoint);
+
+    return (target->table.rx_lookahead[endPointId] & 0xFFFF) >> 
+        HTC_HEADER_BUNDLE_SHIFT;
+}
+
+/* 
+ * Splits a received bundle into the posted buffers and returns them to the 
+ * user in order. The first frame completes like a frame received on its 
+ * own, which also acknowledges the interrupt on SPI.
+ */
+htc_status_t htcRxBundleCompletionCB(HTC_DATA_REQUEST_ELEMENT *element,
+                 htc_status_t status)
+{
+    HTC_BUNDLE *bundle = (HTC_BUNDLE *)element;
+    HTC_ENDPOINT *endPoint;
+    HTC_ENDPOINT_BUFFER *endpointBuffer;
+    HTC_QUEUE_ELEMENT *frame;
+    OSAL_UINT8 *source;
+    OSAL_UINT32 frameLength;
+    OSAL_UINT32 count;
+    htc_status_t frameStatus;
+
+    HTC_DEBUG_PRINTF(HTC_DEBUG_TRC | HTC_DEBUG_RECV, 
+            ("htcRxBundleCompletionCB - Enter\n"));
+    HTC_DEBUG_ASSERT(bundle->busy);
+    endPoint = (GET_ENDPOINT_BUFFER(element))->endPoint;
+
+    /* 
+     * Stay busy while the frames are returned, frames read from the 
+     * handlers meanwhile are read one by one.
+     */
+    for (count = 0; count < bundle->framesCount; count ++) {
+        frame = bundle->frames[count];
+        endpointBuffer = GET_ENDPOINT_BUFFER(frame);
+        frameStatus = status;
+        if (frameStatus == HTC_OK) {
+            source = bundle->buffer + count * endPoint->blockSize;
+            frameLength = (((source[0] << 0) | (source[1] << 8)) & 
+                    HTC_HEADER_LENGTH_MASK) + HTC_HEADER_LEN;
+            if ((frameLength > endPoint->blockSize) || 
+                    (frameLength > endpointBuffer->bufferLength))
+            {
+                HTC_DEBUG_PRINTF(HTC_DEBUG_ERR | HTC_DEBUG_RECV, 
+                        ("Bundled frame too long: %d\n", frameLength));
+                frameStatus = HTC_ECANCELED;
+            } else {
+                OSAL_MEMCPY(endpointBuffer->buffer, source, frameLength);
+                endpointBuffer->actualLength = frameLength;
+            }
+        }
+        if (count == 0) {
+            htcRxCompletionCB(frame, frameStatus);
+        } else {
+            htcDeliverRxFrame(frame, frameStatus);
+        }
+    }
+    bundle->framesCount = 0;
+    bundle->request.buffer.free = TRUE;
+    bundle->busy = FALSE;
+
+    HTC_DEBUG_PRINTF(HTC_DEBUG_TRC | HTC_DEBUG_RECV, 
+            ("htcRxBundleCompletionCB - Exit\n"));
+
+    return HTC_OK;
+}
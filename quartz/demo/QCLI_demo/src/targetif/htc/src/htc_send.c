@@ -109,8 +109,13 @@ htc_host_buffer_send(HTC_TARGET *target,
 }
 
 
-void 
-htcSendFrame(HTC_ENDPOINT *endPoint) 
+/* 
+ * Sends the frame at the head of the send queue in its own transfer. 
+ * Returns HTC_ERROR when the transfer could not be queued, the frame has 
+ * then been returned to the user.
+ */
+static htc_status_t
+htcSendSingleFrame(HTC_ENDPOINT *endPoint)
 {
     htc_status_t status;
     OSAL_UINT32 address;
@@ -119,6 +124,239 @@ htcSendFrame(HTC_ENDPOINT *endPoint)
     OSAL_UINT32 paddedLength;
     HTC_EVENT_INFO eventInfo;
     OSAL_UINT32 request;
+    HTC_ENDPOINT_ID endPointId;
+    HTC_QUEUE_ELEMENT *element;
+    HTC_ENDPOINT_BUFFER *endpointBuffer;
+    HTC_DATA_REQUEST_QUEUE *sendQueue;
+
+    endPointId = GET_ENDPOINT_ID(endPoint);
+    target = endPoint->target;
+    sendQueue = &endPoint->sendQueue;
+
+    /* Get the request buffer from the Pending Send Queue */
+    element = removeFromEndpointQueue(target, sendQueue);
+    endpointBuffer = GET_ENDPOINT_BUFFER(element);
+
+    /* 
+     * Prepend the actual length in the first 2 bytes of the outgoing 
+     * packet.
+     */
+    endpointBuffer->buffer -= HTC_HEADER_LEN;
+    OSAL_MEMCPY(endpointBuffer->buffer, &endpointBuffer->bufferLength, HTC_HEADER_LEN);
+
+    /* 
+     * Adjust the length in the block mode only when its not an integral 
+     * multiple of the block size. Assumption is that the block size is
+     * a power of 2.
+     */
+    frameLength = endpointBuffer->bufferLength + HTC_HEADER_LEN;
+    paddedLength = (frameLength + (endPoint->blockSize - 1)) & 
+        (~(endPoint->blockSize - 1));
+    endpointBuffer->actualLength = paddedLength;
+    HTC_DEBUG_PRINTF(HTC_DEBUG_INF | HTC_DEBUG_SEND,  
+            ("Original frame length: %d, Padded frame length: %d\n", frameLength, paddedLength));
+
+    HTC_DEBUG_PRINTBUF(endpointBuffer->buffer, endpointBuffer->actualLength);
+
+    /* Create the interface request */
+    request = (endPoint->blockSize > 1) ?
+        HIF_WR_ASYNC_BLOCK_INC : HIF_WR_ASYNC_BYTE_INC;
+    address = endPoint->address;
+    /* Send the data to the bus driver */
+    status = HIFReadWrite(target->device, address, endpointBuffer->buffer, 
+            endpointBuffer->actualLength, request, element);
+#ifndef HTC_SYNC
+    if (status != HTC_OK)
+#else
+    if (status != HTC_OK && status != HTC_PENDING)
+#endif
+    {
+        /* DEBUG Start */
+        if ((endpointBuffer->buffer == NULL) || (endpointBuffer->cookie == NULL) ||
+                (endpointBuffer->bufferLength == 0) || (element->buffer.free))
+        {
+            HTC_DEBUG_PRINTF(HTC_DEBUG_INF, ("(hSF)element: 0x%p, endpointBuffer: 0x%p, status: %d, free: %d\n", element, endpointBuffer, status, element->buffer.free));
+            printEndpointQueueElement(element);
+            printEndpointQueue(&endPoint->sendQueue);
+        }
+        /* DEBUG End */
+
+        HTC_DEBUG_PRINTF(HTC_DEBUG_ERR | HTC_DEBUG_SEND, 
+                ("Frame transmission failed\n"));
+        HTC_DEBUG_PRINTF(HTC_DEBUG_ERR | HTC_DEBUG_SEND, 
+                ("EndPoint: %d, Tx credits available: %d\n", 
+                 endPointId, GET_TX_CREDITS_AVAILABLE(endPoint)));
+        /* 
+         * We need to check just in case the callback routine was called
+         * with the error status before we reach this point and in that
+         * context we fee up the buffer so its just a conservative design.
+         */
+        if (!IS_ELEMENT_FREE(element)) {
+            endpointBuffer->buffer += HTC_HEADER_LEN;
+            FRAME_EVENT(eventInfo, endpointBuffer->buffer, 
+                    endpointBuffer->bufferLength, 
+                    endpointBuffer->actualLength, 
+                    HTC_ECANCELED, endpointBuffer->cookie);
+            RECYCLE_DATA_REQUEST_ELEMENT(element);
+            dispatchEvent(target, endPointId, HTC_BUFFER_SENT, &eventInfo);
+        }
+        return HTC_ERROR;
+    }
+#ifdef HTC_SYNC
+    else if (status == HTC_OK) {
+        element->completionCB(element, status);
+    }
+#endif
+
+    return HTC_OK;
+}
+
+/* 
+ * Sends up to creditsAvailable frames from the head of the send queue in 
+ * one transfer. Each frame keeps its HTC header and is padded to a block of 
+ * its own, so the target sees the same frames as when they are sent one by 
+ * one, one credit each. *framesSent is 0 when fewer than two frames can be 
+ * bundled, the caller then sends the head frame on its own.
+ */
+static htc_status_t
+htcSendBundle(HTC_ENDPOINT *endPoint, OSAL_UINT32 creditsAvailable, 
+              OSAL_UINT32 *framesSent)
+{
+    htc_status_t status;
+    OSAL_UINT32 address;
+    HTC_TARGET *target;
+    HTC_BUNDLE *bundle;
+    OSAL_UINT32 framesCount;
+    OSAL_UINT32 frameLength;
+    OSAL_UINT32 header;
+    OSAL_UINT32 count;
+    HTC_QUEUE_ELEMENT *element;
+    HTC_ENDPOINT_BUFFER *endpointBuffer;
+    HTC_DATA_REQUEST_QUEUE *sendQueue;
+
+    *framesSent = 0;
+    target = endPoint->target;
+    sendQueue = &endPoint->sendQueue;
+    bundle = endPoint->txBundle;
+
+    /* The previous bundle still owns the buffer until it completes */
+    if ((bundle == NULL) || bundle->busy) {
+        return HTC_OK;
+    }
+
+    /* Count the frames at the head of the queue that fit in a block each */
+    framesCount = 0;
+    while ((framesCount < sendQueue->size) && 
+            (framesCount < creditsAvailable) &&
+            (framesCount < endPoint->bundleFramesMax))
+    {
+        element = &sendQueue->element[(sendQueue->head + framesCount) % 
+            HTC_DATA_REQUEST_RING_BUFFER_SIZE];
+        frameLength = (GET_ENDPOINT_BUFFER(element))->bufferLength + HTC_HEADER_LEN;
+        if (frameLength > endPoint->blockSize) {
+            break;
+        }
+        framesCount ++;
+    }
+    if (framesCount < 2) {
+        return HTC_OK;
+    }
+
+    for (count = 0; count < framesCount; count ++) {
+        element = removeFromEndpointQueue(target, sendQueue);
+        endpointBuffer = GET_ENDPOINT_BUFFER(element);
+
+        /* The header also tells how many frames of the bundle follow */
+        header = endpointBuffer->bufferLength | 
+            ((framesCount - 1 - count) << HTC_HEADER_BUNDLE_SHIFT);
+        endpointBuffer->buffer -= HTC_HEADER_LEN;
+        endpointBuffer->buffer[0] = (OSAL_UINT8)(header & 0xFF);
+        endpointBuffer->buffer[1] = (OSAL_UINT8)(header >> 8);
+        endpointBuffer->actualLength = endPoint->blockSize;
+
+        OSAL_MEMCPY(bundle->buffer + count * endPoint->blockSize, 
+                endpointBuffer->buffer, endpointBuffer->bufferLength + HTC_HEADER_LEN);
+        bundle->frames[count] = element;
+    }
+    bundle->framesCount = framesCount;
+    bundle->busy = TRUE;
+    bundle->request.buffer.free = FALSE;
+
+    HTC_DEBUG_PRINTF(HTC_DEBUG_INF | HTC_DEBUG_SEND,  
+            ("Bundle of %d frames, %d bytes\n", framesCount, 
+             framesCount * endPoint->blockSize));
+    HTC_DEBUG_PRINTBUF(bundle->buffer, framesCount * endPoint->blockSize);
+
+    /* 
+     * The transfer ends on the last byte of the extended window, which 
+     * marks the end of the message for the target.
+     */
+    address = endPoint->extendedAddress + endPoint->extendedSize - 
+        framesCount * endPoint->blockSize;
+    status = HIFReadWrite(target->device, address, bundle->buffer, 
+            framesCount * endPoint->blockSize, HIF_WR_ASYNC_BLOCK_INC, 
+            &bundle->request);
+#ifndef HTC_SYNC
+    if (status != HTC_OK)
+#else
+    if (status != HTC_OK && status != HTC_PENDING)
+#endif
+    {
+        HTC_DEBUG_PRINTF(HTC_DEBUG_ERR | HTC_DEBUG_SEND, 
+                ("Bundle transmission failed\n"));
+        /* Return the frames unless the callback did it already */
+        if (bundle->busy) {
+            htcTxBundleCompletionCB(&bundle->request, HTC_ECANCELED);
+        }
+        return HTC_ERROR;
+    }
+#ifdef HTC_SYNC
+    else if (status == HTC_OK) {
+        bundle->request.completionCB(&bundle->request, status);
+    }
+#endif
+
+    *framesSent = framesCount;
+    return HTC_OK;
+}
+
+/* Completes every frame of a bundle with the status of the transfer */
+htc_status_t
+htcTxBundleCompletionCB(HTC_DATA_REQUEST_ELEMENT *element,
+                        htc_status_t status)
+{
+    HTC_BUNDLE *bundle = (HTC_BUNDLE *)element;
+    OSAL_UINT32 count;
+
+    HTC_DEBUG_PRINTF(HTC_DEBUG_TRC | HTC_DEBUG_SEND, 
+            ("htcTxBundleCompletionCB - Enter\n"));
+    HTC_DEBUG_ASSERT(bundle->busy);
+
+    /* 
+     * Stay busy while the frames are returned, the users may send again 
+     * from their handlers and those frames go out one by one meanwhile.
+     */
+    for (count = 0; count < bundle->framesCount; count ++) {
+        htcTxCompletionCB(bundle->frames[count], status);
+    }
+    bundle->framesCount = 0;
+    bundle->request.buffer.free = TRUE;
+    bundle->busy = FALSE;
+
+    HTC_DEBUG_PRINTF(HTC_DEBUG_TRC | HTC_DEBUG_SEND, 
+            ("htcTxBundleCompletionCB - Exit\n"));
+
+    return HTC_OK;
+}
+
+
+void 
+htcSendFrame(HTC_ENDPOINT *endPoint) 
+{
+    htc_status_t status;
+    OSAL_UINT32 address;
+    HTC_TARGET *target;
+    OSAL_UINT32 framesSent;
 #ifndef SPI
     OSAL_UINT8 txCreditsConsumed;
     OSAL_UINT8 txCreditsAvailable;
@@ -128,7 +366,6 @@ htcSendFrame(HTC_ENDPOINT *endPoint)
 #endif
     HTC_ENDPOINT_ID endPointId;
     HTC_QUEUE_ELEMENT *element;
-    HTC_ENDPOINT_BUFFER *endpointBuffer;
     HTC_REG_REQUEST_LIST *regList;
     HTC_DATA_REQUEST_QUEUE *sendQueue;
 #ifdef HTC_SYNC
@@ -179,86 +416,25 @@ htcSendFrame(HTC_ENDPOINT *endPoint)
      */
     while((!IS_DATA_QUEUE_EMPTY(sendQueue)) && txCreditsAvailable)
     {
-        /* Get the request buffer from the Pending Send Queue */
-        element = removeFromEndpointQueue(target, sendQueue);
-        endpointBuffer = GET_ENDPOINT_BUFFER(element);
-
-        /* 
-         * Prepend the actual length in the first 2 bytes of the outgoing 
-         * packet.
-         */
-        endpointBuffer->buffer -= HTC_HEADER_LEN;
-        OSAL_MEMCPY(endpointBuffer->buffer, &endpointBuffer->bufferLength, HTC_HEADER_LEN);
-
         /* 
-         * Adjust the length in the block mode only when its not an integral 
-         * multiple of the block size. Assumption is that the block size is
-         * a power of 2.
+         * Move as many frames as the credits allow in a single bundle and
+         * fall back to a transfer per frame when they cannot be bundled.
+         * Either way the credits of all the frames sent are taken at once.
          */
-        frameLength = endpointBuffer->bufferLength + HTC_HEADER_LEN;
-        paddedLength = (frameLength + (endPoint->blockSize - 1)) & 
-            (~(endPoint->blockSize - 1));
-        endpointBuffer->actualLength = paddedLength;
-        HTC_DEBUG_PRINTF(HTC_DEBUG_INF | HTC_DEBUG_SEND,  
-                ("Original frame length: %d, Padded frame length: %d\n", frameLength, paddedLength));
-
-        HTC_DEBUG_PRINTBUF(endpointBuffer->buffer, endpointBuffer->actualLength);
         HTC_DEBUG_PRINTF(HTC_DEBUG_INF | HTC_DEBUG_SEND,  
                 ("Available Tx credits: %d\n", txCreditsAvailable));
-
-        /* Create the interface request */
-        request = (endPoint->blockSize > 1) ?
-            HIF_WR_ASYNC_BLOCK_INC : HIF_WR_ASYNC_BYTE_INC;
-        address = endPoint->address;
-        /* Send the data to the bus driver */
-        status = HIFReadWrite(target->device, address, endpointBuffer->buffer, 
-                endpointBuffer->actualLength, request, element);
-#ifndef HTC_SYNC
-        if (status != HTC_OK)
-#else
-            if (status != HTC_OK && status != HTC_PENDING)
-#endif
-            {
-                /* DEBUG Start */
-                if ((endpointBuffer->buffer == NULL) || (endpointBuffer->cookie == NULL) ||
-                        (endpointBuffer->bufferLength == 0) || (element->buffer.free))
-                {
-                    HTC_DEBUG_PRINTF(HTC_DEBUG_INF, ("(hSF)element: 0x%p, endpointBuffer: 0x%p, status: %d, free: %d\n", element, endpointBuffer, status, element->buffer.free));
-                    printEndpointQueueElement(element);
-                    printEndpointQueue(&endPoint->sendQueue);
-                }
-                /* DEBUG End */
-
-                HTC_DEBUG_PRINTF(HTC_DEBUG_ERR | HTC_DEBUG_SEND, 
-                        ("Frame transmission failed\n"));
-                HTC_DEBUG_PRINTF(HTC_DEBUG_ERR | HTC_DEBUG_SEND, 
-                        ("EndPoint: %d, Tx credits available: %d\n", 
-                         endPointId, GET_TX_CREDITS_AVAILABLE(endPoint)));
-                /* 
-                 * We need to check just in case the callback routine was called
-                 * with the error status before we reach this point and in that
-                 * context we fee up the buffer so its just a conservative design.
-                 */
-                if (!IS_ELEMENT_FREE(element)) {
-                    endpointBuffer->buffer += HTC_HEADER_LEN;
-                    FRAME_EVENT(eventInfo, endpointBuffer->buffer, 
-                            endpointBuffer->bufferLength, 
-                            endpointBuffer->actualLength, 
-                            HTC_ECANCELED, endpointBuffer->cookie);
-                    RECYCLE_DATA_REQUEST_ELEMENT(element);
-                    dispatchEvent(target, endPointId, HTC_BUFFER_SENT, &eventInfo);
-                }
-                HTC_DEBUG_PRINTF(HTC_DEBUG_TRC | HTC_DEBUG_SEND, 
-                        ("htcSendFrame - Exit\n"));
-                return;
-            }
-#ifdef HTC_SYNC
-            else if (status == HTC_OK) {
-                element->completionCB(element, status);
-            }
-#endif
-        txCreditsAvailable -= 1;
-        txCreditsConsumed += 1;
+        status = htcSendBundle(endPoint, txCreditsAvailable, &framesSent);
+        if ((status == HTC_OK) && (framesSent == 0)) {
+            status = htcSendSingleFrame(endPoint);
+            framesSent = 1;
+        }
+        if (status != HTC_OK) {
+            HTC_DEBUG_PRINTF(HTC_DEBUG_TRC | HTC_DEBUG_SEND, 
+                    ("htcSendFrame - Exit\n"));
+            return;
+        }
+        txCreditsAvailable -= framesSent;
+        txCreditsConsumed += framesSent;
 
 
         if ((txCreditsAvailable == 0) && (trans != HTC_TRANSPORT_SPI))
@@ -385,6 +385,38 @@ freeRegRequestElement(HTC_REG_REQUEST_ELEMENT *element) {
     OSAL_MUTEX_UNLOCK(&target->instanceCS);
 }
 
+/* 
+ * Allocates a bundle with room for endPoint->bundleFramesMax blocks. The
+ * buffer follows the structure in the same allocation.
+ */
+HTC_BUNDLE *
+allocateBundle(HTC_ENDPOINT *endPoint, htc_status_t (*completionCB)(HTC_QUEUE_ELEMENT *element, htc_status_t status)) {
+    HTC_BUNDLE *bundle;
+
+    bundle = (HTC_BUNDLE *)OSAL_MALLOC(sizeof(HTC_BUNDLE) + 
+            endPoint->bundleFramesMax * endPoint->blockSize);
+    if (bundle == NULL) {
+        HTC_DEBUG_PRINTF(HTC_DEBUG_ERR, ("Unable to allocate bundle memory\n"));
+        return NULL;
+    }
+    OSAL_MEMZERO(bundle, sizeof(HTC_BUNDLE));
+    bundle->buffer = (OSAL_UINT8 *)(bundle + 1);
+    bundle->busy = FALSE;
+    bundle->request.buffer.free = TRUE;
+    bundle->request.completionCB = completionCB;
+    (GET_ENDPOINT_BUFFER(&bundle->request))->endPoint = endPoint;
+
+    return bundle;
+}
+
+void
+freeBundle(HTC_BUNDLE *bundle) {
+    if (bundle != NULL) {
+        HTC_DEBUG_ASSERT(!bundle->busy);
+        OSAL_FREE(bundle);
+    }
+}
+
 void
 htcReportFailure(htc_status_t status)
 {
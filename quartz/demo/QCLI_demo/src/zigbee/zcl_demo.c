@@ -44,7 +44,13 @@
 #include "zcl_illuminance_demo.h"
 #include "zcl_relhumid_demo.h"
 
-#define CLUSTER_LIST_SIZE                                               (16)
+#define CLUSTER_LIST_SIZE                                               (32)
+
+/* Number of buckets in each of the cluster list indexes.  This must be a power
+   of two and at least twice CLUSTER_LIST_SIZE so that probe sequences stay
+   short.  Buckets hold a cluster list index plus one so zero marks an empty
+   bucket. */
+#define CLUSTER_INDEX_SIZE                                              (64)
 
 #define MAXIMUM_ATTRIUBTE_LENGTH                                        (8)
 #define MAXIMUM_DISCOVER_LENGTH                                         (16)
@@ -83,6 +89,8 @@ typedef struct ZCL_Demo_Context_s
    QCLI_Group_Handle_t     QCLI_Handle;                     /* QCLI handle for the cluster demo. */
    uint16_t                Cluster_Count;                   /* The number of the clusters used in the demo. */
    ZCL_Demo_Cluster_Info_t Cluster_List[CLUSTER_LIST_SIZE]; /* The list of the clusters used in the demo. */
+   uint8_t                 HandleIndex[CLUSTER_INDEX_SIZE]; /* Index of the cluster list by cluster handle. */
+   uint8_t                 KeyIndex[CLUSTER_INDEX_SIZE];    /* Index of the cluster list by endpoint and cluster ID. */
    uint16_t                DiscoverAttr_NextId;             /* Keeps track the next start attribute ID for the "DiscoverAttributes" command. */
    qbool_t                 ZCL_CB_Registered;               /* Flag indicating if the general cluster command callback has been registered. */
 } ZCL_Demo_Context_t;
@@ -186,6 +194,10 @@ static const ZCL_Endpoint_Descriptor_t EndpointDescriptorList[] =
 static void DisplayGeneralReceiveInfo(const qapi_ZB_CL_General_Receive_Info_t *Receive_Info);
 static qbool_t ZCL_InitializeClusters(uint8_t Endpoint, const char *DeviceName, qbool_t ServerList, const uint16_t *ClusterList, uint8_t ClusterCount);
 static void ZCL_RemoveClusterByEndpoint(uint8_t Endpoint);
+static uint32_t ZCL_HandleHash(qapi_ZB_Cluster_t Handle);
+static uint32_t ZCL_KeyHash(uint8_t Endpoint, uint16_t ClusterID);
+static void ZCL_IndexCluster(uint16_t ClusterIndex);
+static void ZCL_RebuildClusterIndex(void);
 
 static QCLI_Command_Status_t cmd_ZB_CL_ListClusterTypes(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 static QCLI_Command_Status_t cmd_ZB_CL_ListEndpointTypes(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
@@ -367,6 +379,90 @@ static void ZCL_RemoveClusterByEndpoint(uint8_t Endpoint)
          Index ++;
       }
    }
+
+   /* Removing entries shifted the list so the indexes need to be rebuilt. */
+   ZCL_RebuildClusterIndex();
+}
+
+/**
+   @brief Calculates the index hash for a cluster handle.
+
+   @param Handle is the handle of the cluster.
+
+   @return The hash of the handle.
+*/
+static uint32_t ZCL_HandleHash(qapi_ZB_Cluster_t Handle)
+{
+   uint32_t Ret_Val;
+
+   /* The handles are pointers so the low bits carry little information.
+      Multiplicative hashing mixes them into the top bits which are used as
+      the bucket. */
+   Ret_Val = (uint32_t)(uintptr_t)Handle * 2654435761UL;
+
+   return(Ret_Val >> 16);
+}
+
+/**
+   @brief Calculates the index hash for an endpoint and cluster ID.
+
+   @param Endpoint  is the endpoint of the cluster.
+   @param ClusterID is the ID of the cluster.
+
+   @return The hash of the endpoint and cluster ID.
+*/
+static uint32_t ZCL_KeyHash(uint8_t Endpoint, uint16_t ClusterID)
+{
+   uint32_t Ret_Val;
+
+   Ret_Val = (((uint32_t)Endpoint << 16) | ClusterID) * 2654435761UL;
+
+   return(Ret_Val >> 16);
+}
+
+/**
+   @brief Adds an entry of the cluster list to the handle and key indexes.
+
+   @param ClusterIndex is the index of the entry in the cluster list.
+*/
+static void ZCL_IndexCluster(uint16_t ClusterIndex)
+{
+   ZCL_Demo_Cluster_Info_t *ClusterInfo;
+   uint32_t                 Bucket;
+
+   ClusterInfo = &(ZCL_Demo_Context.Cluster_List[ClusterIndex]);
+
+   /* The list never holds more entries than half the buckets so a free bucket
+      is always found. */
+   Bucket = ZCL_HandleHash(ClusterInfo->Handle) & (CLUSTER_INDEX_SIZE - 1);
+   while(ZCL_Demo_Context.HandleIndex[Bucket] != 0)
+   {
+      Bucket = (Bucket + 1) & (CLUSTER_INDEX_SIZE - 1);
+   }
+   ZCL_Demo_Context.HandleIndex[Bucket] = (uint8_t)(ClusterIndex + 1);
+
+   Bucket = ZCL_KeyHash(ClusterInfo->Endpoint, ClusterInfo->ClusterID) & (CLUSTER_INDEX_SIZE - 1);
+   while(ZCL_Demo_Context.KeyIndex[Bucket] != 0)
+   {
+      Bucket = (Bucket + 1) & (CLUSTER_INDEX_SIZE - 1);
+   }
+   ZCL_Demo_Context.KeyIndex[Bucket] = (uint8_t)(ClusterIndex + 1);
+}
+
+/**
+   @brief Rebuilds the handle and key indexes from the cluster list.
+*/
+static void ZCL_RebuildClusterIndex(void)
+{
+   uint16_t Index;
+
+   memset(ZCL_Demo_Context.HandleIndex, 0, sizeof(ZCL_Demo_Context.HandleIndex));
+   memset(ZCL_Demo_Context.KeyIndex, 0, sizeof(ZCL_Demo_Context.KeyIndex));
+
+   for(Index = 0; Index < ZCL_Demo_Context.Cluster_Count; Index ++)
+   {
+      ZCL_IndexCluster(Index);
+   }
 }
 
 /**
@@ -1751,6 +1847,7 @@ int16_t ZB_Cluster_AddCluster(const ZCL_Demo_Cluster_Info_t *Cluster_Info)
          ZCL_Demo_Context.Cluster_Count ++;
 
          memscpy(&(ZCL_Demo_Context.Cluster_List[Ret_Val]), sizeof(ZCL_Demo_Cluster_Info_t), Cluster_Info, sizeof(ZCL_Demo_Cluster_Info_t));
+         ZCL_IndexCluster(Ret_Val);
 
          /* Register the ZCL callback if it hasn't already been done. */
          if(!(ZCL_Demo_Context.ZCL_CB_Registered))
@@ -1808,6 +1905,7 @@ void ZB_Cluster_Cleanup(void)
 
    /* Set the cluster count to zero. */
    ZCL_Demo_Context.Cluster_Count = 0;
+   ZCL_RebuildClusterIndex();
 }
 
 /**
@@ -1847,19 +1945,44 @@ ZCL_Demo_Cluster_Info_t *ZCL_FindClusterByIndex(uint16_t ClusterIndex, uint16_t
 ZCL_Demo_Cluster_Info_t *ZCL_FindClusterByEndpoint(uint8_t Endpoint, uint16_t ClusterID, ZCL_Demo_ClusterType_t ClusterType)
 {
    ZCL_Demo_Cluster_Info_t *Ret_Val;
-   uint16_t           Index;
+   ZCL_Demo_Cluster_Info_t *ClusterInfo;
+   uint16_t                 Index;
+   uint32_t                 Bucket;
 
    Ret_Val = NULL;
 
-   /* Try to find the cluster entry to be moved. */
-   for(Index = 0; Index < ZCL_Demo_Context.Cluster_Count; Index ++)
+   if(ClusterID == ZCL_DEMO_IGNORE_CLUSTER_ID)
    {
-      if((ZCL_Demo_Context.Cluster_List[Index].Endpoint == Endpoint) &&
-         ((ClusterID == ZCL_DEMO_IGNORE_CLUSTER_ID) || (ClusterID == ZCL_Demo_Context.Cluster_List[Index].ClusterID)) &&
-         ((ClusterType == ZCL_DEMO_CLUSTERTYPE_UNKNOWN) || (ClusterType == ZCL_Demo_Context.Cluster_List[Index].ClusterType)))
+      /* The key index needs the cluster ID, so search the list for any
+         cluster on the endpoint. */
+      for(Index = 0; Index < ZCL_Demo_Context.Cluster_Count; Index ++)
       {
-         Ret_Val = &(ZCL_Demo_Context.Cluster_List[Index]);
-         break;
+         if((ZCL_Demo_Context.Cluster_List[Index].Endpoint == Endpoint) &&
+            ((ClusterType == ZCL_DEMO_CLUSTERTYPE_UNKNOWN) || (ClusterType == ZCL_Demo_Context.Cluster_List[Index].ClusterType)))
+         {
+            Ret_Val = &(ZCL_Demo_Context.Cluster_List[Index]);
+            break;
+         }
+      }
+   }
+   else
+   {
+      /* Probe the key index.  A server and a client of the same cluster on
+         the same endpoint share a key, so keep probing until the type also
+         matches. */
+      Bucket = ZCL_KeyHash(Endpoint, ClusterID) & (CLUSTER_INDEX_SIZE - 1);
+      while(ZCL_Demo_Context.KeyIndex[Bucket] != 0)
+      {
+         ClusterInfo = &(ZCL_Demo_Context.Cluster_List[ZCL_Demo_Context.KeyIndex[Bucket] - 1]);
+
+         if((ClusterInfo->Endpoint == Endpoint) && (ClusterInfo->ClusterID == ClusterID) &&
+            ((ClusterType == ZCL_DEMO_CLUSTERTYPE_UNKNOWN) || (ClusterType == ClusterInfo->ClusterType)))
+         {
+            Ret_Val = ClusterInfo;
+            break;
+         }
+
+         Bucket = (Bucket + 1) & (CLUSTER_INDEX_SIZE - 1);
       }
    }
 
@@ -1876,18 +1999,24 @@ ZCL_Demo_Cluster_Info_t *ZCL_FindClusterByEndpoint(uint8_t Endpoint, uint16_t Cl
 ZCL_Demo_Cluster_Info_t *ZCL_FindClusterByHandle(qapi_ZB_Cluster_t Handle)
 {
    ZCL_Demo_Cluster_Info_t *Ret_Val;
-   uint16_t           Index;
+   ZCL_Demo_Cluster_Info_t *ClusterInfo;
+   uint32_t                 Bucket;
 
    Ret_Val = NULL;
 
-   /* Try to find the cluster entry to be moved. */
-   for(Index = 0; Index < ZCL_Demo_Context.Cluster_Count; Index ++)
+   /* Probe the handle index. */
+   Bucket = ZCL_HandleHash(Handle) & (CLUSTER_INDEX_SIZE - 1);
+   while(ZCL_Demo_Context.HandleIndex[Bucket] != 0)
    {
-      if(ZCL_Demo_Context.Cluster_List[Index].Handle == Handle)
+      ClusterInfo = &(ZCL_Demo_Context.Cluster_List[ZCL_Demo_Context.HandleIndex[Bucket] - 1]);
+
+      if(ClusterInfo->Handle == Handle)
       {
-         Ret_Val = &(ZCL_Demo_Context.Cluster_List[Index]);
+         Ret_Val = ClusterInfo;
          break;
       }
+
+      Bucket = (Bucket + 1) & (CLUSTER_INDEX_SIZE - 1);
    }
 
    return(Ret_Val);
@@ -114,6 +114,7 @@ SET LIBSFILE="%OutDir%\LinkerLibs.txt"
 SET ThirdpartyDir=..\..\..\..
 SET EcosystemRoot=..\..\..\ecosystem
 SET MeshModelsCommonCode=..\..\..\..\qmesh\models\common
+SET MeshPlatformCode=..\..\..\..\qmesh\platform\qca402x\src
 SET MeshClientModels=..\..\..\..\qmesh\models\client
 SET MeshServerModels=..\..\..\..\qmesh\models\server
 
@@ -247,10 +248,13 @@ rem 	SET CSrcs=!CSrcs! qmesh\mesh\mesh_osal_ut.c
 	SET CSrcs=!CSrcs! !MeshClientModels!\generic_power_level_client.c
 	SET CSrcs=!CSrcs! !MeshClientModels!\light_lightness_client.c
 	SET CSrcs=!CSrcs! !MeshClientModels!\light_hsl_client.c
+	REM The timing wheel soft timers replace the ones of the prebuilt qmesh.lib.
+	IF /I "%CFG_FEATURE_QMESH_TIMER_WHEEL%" == "true" (SET CSrcs=!CSrcs! !MeshPlatformCode!\qmesh_soft_timers.c)
 	SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_cache_mgmt.c
 	SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_delay_cache.c
 	SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_model_common.c
 	SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_model_debug.c
+	SET CSrcs=!CSrcs! !MeshModelsCommonCode!\qmesh_transition_engine.c
 	SET CSrcs=!CSrcs! !MeshServerModels!\qmesh_generic_default_transition_time_handler.c
 	SET CSrcs=!CSrcs! !MeshServerModels!\qmesh_generic_poweronoff_handler.c
 	SET CSrcs=!CSrcs! !MeshServerModels!\qmesh_generic_level_handler.c
@@ -111,6 +111,7 @@ SET LinkerScriptDir=%RootDir%\build\scripts\linkerScripts
 SET LINKFILE="%OutDir%\%Project%.ld"
 SET LIBSFILE="%OutDir%\LinkerLibs.txt"
 SET MeshModelsCommonCode=..\..\..\..\qmesh\models\common
+SET MeshPlatformCode=..\..\..\..\qmesh\platform\qca402x\src
 SET MeshClientModels=..\..\..\..\qmesh\models\client
 SET MeshServerModels=..\..\..\..\qmesh\models\server
 
@@ -201,10 +202,13 @@ SET CWallSrcs=!CWallSrcs! !MeshClientModels!\generic_level_client.c
 SET CWallSrcs=!CWallSrcs! !MeshClientModels!\generic_power_level_client.c
 SET CWallSrcs=!CWallSrcs! !MeshClientModels!\light_lightness_client.c
 SET CWallSrcs=!CWallSrcs! !MeshClientModels!\light_hsl_client.c
+REM The timing wheel soft timers replace the ones of the prebuilt qmesh.lib.
+IF /I "%CFG_FEATURE_QMESH_TIMER_WHEEL%" == "true" (SET CWallSrcs=!CWallSrcs! !MeshPlatformCode!\qmesh_soft_timers.c)
 SET CWallSrcs=!CWallSrcs! !MeshModelsCommonCode!\qmesh_cache_mgmt.c
 SET CWallSrcs=!CWallSrcs! !MeshModelsCommonCode!\qmesh_delay_cache.c
 SET CWallSrcs=!CWallSrcs! !MeshModelsCommonCode!\qmesh_model_common.c
 SET CWallSrcs=!CWallSrcs! !MeshModelsCommonCode!\qmesh_model_debug.c
+SET CWallSrcs=!CWallSrcs! !MeshModelsCommonCode!\qmesh_transition_engine.c
 SET CWallSrcs=!CWallSrcs! !MeshModelsCommonCode!\qmesh_model_nvm.c
 SET CWallSrcs=!CWallSrcs! !MeshServerModels!\qmesh_generic_default_transition_time_handler.c
 SET CWallSrcs=!CWallSrcs! !MeshServerModels!\qmesh_generic_poweronoff_handler.c
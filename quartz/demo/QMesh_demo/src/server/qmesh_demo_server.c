@@ -17,6 +17,7 @@
 
 //#include "model_client_common.h"
 #include "qmesh_cache_mgmt.h"
+#include "qmesh_transition_engine.h"
 #include "qmesh_generic_onoff_handler.h"
 #include "qmesh_demo_server.h"
 /******************************************************************************
@@ -555,6 +556,7 @@ QmeshResult InitializeMesh(QMESHAPP_CONTEXT_T *app_context)
     /* Initialize Model Common Code */
     QmeshModelInitMsgCache();
     QmeshInitDelayCache();
+    QmeshInitTransitionEngine();
 
     /* Initialize Generic OnOff server model */
     QmeshGenericOnOffServerAppInit(&g_onoff_model_context);
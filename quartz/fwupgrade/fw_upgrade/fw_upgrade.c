@@ -10,6 +10,7 @@
 /*****************************************************************************************************************************/
 #include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #include <stringl.h>
 #include <qapi/qapi_crypto.h>
@@ -57,6 +58,8 @@ extern int fs_umount(const char *mount_dir);
 #define MIN( a, b ) ((a)<(b)) ? (a) : (b)
 #endif
 
+#define FW_UPGRADE_MEMORY_BARRIER()     __sync_synchronize()
+
 /*************************************************************************************************************/
 /* Firmware Upgrade Globals                                                                                               */
 /*************************************************************************************************************/
@@ -64,6 +67,7 @@ fw_Upgrade_Context_t   *fw_upgrade_sess_cxt  = NULL;
 fw_Upgrade_Image_Hdr_t *fw_upgrade_image_hdr = NULL;     /* fw upgrade image header */
 qurt_mutex_t   Fw_Upgrade_Mutex;
 uint8 Fw_Upgrade_Mutex_Init = 0;
+static fw_Upgrade_Pipe_t fw_upgrade_pipe;
 
 /*************************************************************************************************************/
 /*************************************************************************************************************/
@@ -72,8 +76,13 @@ static void fw_Upgrade_Set_Error_Code(uint32_t err_code);
 static uint32_t fw_Upgrade_Get_Error_Code(void);
 static void fw_Upgrade_Update_Callback(uint32_t state, uint32_t status);
 static void fw_Upgrade_Set_State(qapi_Fw_Upgrade_State_t state);
+static void fw_Upgrade_Digest_Cache_Load(fw_Upgrade_Digest_Cache_t *cache, uint8_t fwd_idx);
+static void fw_Upgrade_Digest_Cache_Save(fw_Upgrade_Digest_Cache_t *cache);
+static fw_Upgrade_Digest_Entry_t *fw_Upgrade_Digest_Cache_Find(fw_Upgrade_Digest_Cache_t *cache, uint32_t image_id, uint32_t start, uint32_t size);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Config_File(uint8_t *buf);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Verify_Image_Hash(fw_Upgrade_Image_Hdr_t *image_hdr);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Write_Image_Data(uint8_t *data, uint32_t len, uint32_t block_size, uint32_t image_length);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Delta_Data(fw_Upgrade_Image_Hdr_t *img_hdr, uint8_t *data, uint32_t len, uint32_t block_size);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *buffer);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Duplicate_FS(uint32_t flags);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Duplicate_Images(void);
@@ -87,6 +96,12 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Fin(void);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Recv_Data(uint8_t *buffer, uint32_t buf_len, uint32_t *ret_size);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Abort(void);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Resume(void);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Init(void);
+static void fw_Upgrade_Pipe_Deinit(void);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Start(void);
+static void fw_Upgrade_Pipe_Stop(void);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Get(uint8_t **buf, uint32_t *len);
+static void fw_Upgrade_Pipe_Release(void);
 
 /*************************************************************************************************************/
 /*************************************************************************************************************/
@@ -301,7 +316,7 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
 {
     qapi_Fw_Upgrade_Status_Code_t rtn = QAPI_FW_UPGRADE_OK_E;
     fw_Upgrade_Context_t *fw_upgrade_cxt;
-    uint8_t *buffer = NULL;
+    uint8_t *buffer = NULL, *data = NULL;
     uint8_t  run = 1;
     uint32_t received, param;
 
@@ -336,6 +351,12 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
         FW_UPGRADE_D_PRINTF("Out of memory error\r\n");
         return QAPI_FW_UPGRADE_ERR_INSUFFICIENT_MEMORY_E;
     }
+    data = buffer;
+
+    /*Allocate pipeline buffers, the session still works without them */
+    if( fw_Upgrade_Pipe_Init() != QAPI_FW_UPGRADE_OK_E ) {
+        FW_UPGRADE_D_PRINTF("pipeline disabled\r\n");
+    }
 
     while( (run == 1) && (fw_Upgrade_Get_Session_Status() == FW_UPGRADE_SESSION_RUNNING_E) )
     {
@@ -587,8 +608,20 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
 
             case QAPI_FW_UPGRADE_STATE_RECEIVE_DATA_E:
                 fw_Upgrade_Update_Callback(fw_Upgrade_Get_State(), fw_Upgrade_Get_Error_Code());
+                /* image data is received ahead by the pipeline once the config file is done */
+                if( (fw_upgrade_cxt->is_first == 0) && (fw_upgrade_pipe.buf_num != 0) && (fw_upgrade_pipe.running == 0) ) {
+                    if( fw_Upgrade_Pipe_Start() != QAPI_FW_UPGRADE_OK_E ) {
+                        fw_Upgrade_Pipe_Deinit();
+                    }
+                }
+
                 /* Receiving data from FTP server.*/
-                rtn = fw_Upgrade_Plugin_Recv_Data((uint8_t *)buffer, FW_UPGRADE_BUF_SIZE, &received);
+                if( fw_upgrade_pipe.running ) {
+                    rtn = fw_Upgrade_Pipe_Get(&data, &received);
+                } else {
+                    data = buffer;
+                    rtn = fw_Upgrade_Plugin_Recv_Data((uint8_t *)buffer, FW_UPGRADE_BUF_SIZE, &received);
+                }
                 if( (rtn == QAPI_FW_UPGRADE_OK_E) && (received > 0) ) {
                     /* handle data */
                     fw_upgrade_cxt->buf_len = received;
@@ -619,7 +652,14 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
                 
             case  QAPI_FW_UPGRADE_STATE_PROCESS_IMAGE_E:
                 fw_Upgrade_Update_Callback(fw_Upgrade_Get_State(), fw_Upgrade_Get_Error_Code());
-                if( (rtn = fw_Upgrade_Process_Receive_Image(buffer)) != QAPI_FW_UPGRADE_OK_E ) {
+                rtn = fw_Upgrade_Process_Receive_Image(data);
+                if( data != buffer ) {
+                    //the buffer is fully consumed, let the receive thread refill it
+                    fw_Upgrade_Pipe_Release();
+                    data = buffer;
+                }
+                if( rtn != QAPI_FW_UPGRADE_OK_E ) {
+                    fw_Upgrade_Pipe_Stop();
                     fw_Upgrade_Plugin_Abort();
                     run = 0;
                 } else if(  fw_Upgrade_Get_State() == QAPI_FW_UPGRADE_STATE_PROCESS_IMAGE_E){
@@ -630,6 +670,7 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
 
             case QAPI_FW_UPGRADE_STATE_DISCONNECT_SERVER_E:
                 fw_Upgrade_Update_Callback(fw_Upgrade_Get_State(), fw_Upgrade_Get_Error_Code());
+                fw_Upgrade_Pipe_Stop();
                 fw_Upgrade_Plugin_Fin();
                 fw_Upgrade_Set_State(QAPI_FW_UPGRADE_STATE_PREPARE_CONNECT_E);
                 break;
@@ -667,6 +708,10 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
 
     }  //while(...
 
+    /* receive thread must be gone before the plugin is finished */
+    fw_Upgrade_Pipe_Stop();
+    fw_Upgrade_Pipe_Deinit();
+
     /* free bufer */
     if(buffer) {
     	free(buffer);
@@ -674,6 +719,193 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
     return (rtn);
 }
 
+/*
+ * allocate download pipeline buffers
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Init(void)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+    uint32_t i, buf_num;
+
+    memset(pipe, 0, sizeof(fw_Upgrade_Pipe_t));
+
+    if( fw_Upgrade_Get_Scheme_Param(FW_UPGRADE_SCHEME_PROP_PIPELINE_BUF_NUM_ID, &buf_num) != QAPI_FW_UPGRADE_OK_E ) {
+        buf_num = FW_UPGRADE_PIPE_DEFAULT_BUF_NUM;
+    }
+    if( buf_num < 2 ) {
+        return QAPI_FW_UPGRADE_OK_E;
+    }
+    if( buf_num > FW_UPGRADE_PIPE_MAX_BUF_NUM ) {
+        buf_num = FW_UPGRADE_PIPE_MAX_BUF_NUM;
+    }
+
+    for( i = 0; i < buf_num; i++ )
+    {
+        if( (pipe->buf[i] = malloc(FW_UPGRADE_BUF_SIZE)) == NULL ) {
+            fw_Upgrade_Pipe_Deinit();
+            return QAPI_FW_UPGRADE_ERR_INSUFFICIENT_MEMORY_E;
+        }
+    }
+
+    qurt_signal_create(&pipe->signal);
+    pipe->buf_num = buf_num;
+    return QAPI_FW_UPGRADE_OK_E;
+}
+
+/*
+ * free download pipeline buffers
+ */
+static void fw_Upgrade_Pipe_Deinit(void)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+    uint32_t i;
+
+    if( pipe->buf_num != 0 ) {
+        qurt_signal_delete(&pipe->signal);
+    }
+
+    for( i = 0; i < FW_UPGRADE_PIPE_MAX_BUF_NUM; i++ )
+    {
+        if( pipe->buf[i] != NULL ) {
+            free(pipe->buf[i]);
+            pipe->buf[i] = NULL;
+        }
+    }
+    pipe->buf_num = 0;
+}
+
+/*
+ * receive thread, keeps the pipeline buffers filled until the plugin has no more data
+ */
+static void fw_Upgrade_Pipe_Thread(void *param)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+    qapi_Fw_Upgrade_Status_Code_t rtn = QAPI_FW_UPGRADE_OK_E;
+    uint32_t idx, received = 0;
+
+    while( pipe->stop == 0 )
+    {
+        //all buffers are waiting to be flashed
+        if( (pipe->head - pipe->tail) >= pipe->buf_num ) {
+            pipe->rx_waits++;
+            qurt_signal_wait(&pipe->signal, FW_UPGRADE_PIPE_SIG_SPACE, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+            continue;
+        }
+
+        idx = pipe->head % pipe->buf_num;
+        rtn = fw_Upgrade_Plugin_Recv_Data(pipe->buf[idx], FW_UPGRADE_BUF_SIZE, &received);
+        if( (rtn != QAPI_FW_UPGRADE_OK_E) || (received == 0) ) {
+            break;
+        }
+
+        pipe->len[idx] = received;
+        FW_UPGRADE_MEMORY_BARRIER();
+        pipe->head++;
+        qurt_signal_set(&pipe->signal, FW_UPGRADE_PIPE_SIG_DATA);
+    }
+
+    pipe->rx_rtn = rtn;
+    FW_UPGRADE_MEMORY_BARRIER();
+    pipe->rx_done = 1;
+    qurt_signal_set(&pipe->signal, FW_UPGRADE_PIPE_SIG_DATA | FW_UPGRADE_PIPE_SIG_EXIT);
+    qurt_thread_stop();
+}
+
+/*
+ * start receive thread for the current connection
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Start(void)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+    qurt_thread_attr_t attr;
+    qurt_thread_t thread;
+
+    pipe->head = 0;
+    pipe->tail = 0;
+    pipe->stop = 0;
+    pipe->rx_done = 0;
+    pipe->rx_rtn = QAPI_FW_UPGRADE_OK_E;
+    qurt_signal_clear(&pipe->signal, FW_UPGRADE_PIPE_SIG_DATA | FW_UPGRADE_PIPE_SIG_SPACE | FW_UPGRADE_PIPE_SIG_EXIT);
+
+    //same priority as the session so neither side starves the other
+    qurt_thread_attr_init(&attr);
+    qurt_thread_attr_set_name(&attr, "fwup_rx");
+    qurt_thread_attr_set_priority(&attr, qurt_thread_get_priority(qurt_thread_get_id()));
+    qurt_thread_attr_set_stack_size(&attr, FW_UPGRADE_PIPE_THREAD_STACK_SIZE);
+    if( qurt_thread_create(&thread, &attr, fw_Upgrade_Pipe_Thread, NULL) != QURT_EOK ) {
+        //fall back to receiving from the session thread
+        FW_UPGRADE_D_PRINTF("can't start pipeline thread\r\n");
+        return QAPI_FW_UPGRADE_ERROR_E;
+    }
+
+    pipe->running = 1;
+    return QAPI_FW_UPGRADE_OK_E;
+}
+
+/*
+ * stop receive thread, data not flashed yet is dropped and received again on resume
+ */
+static void fw_Upgrade_Pipe_Stop(void)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+
+    if( pipe->running == 0 ) {
+        return;
+    }
+
+    //the plugin call in progress finishes or times out first
+    pipe->stop = 1;
+    qurt_signal_set(&pipe->signal, FW_UPGRADE_PIPE_SIG_SPACE);
+    qurt_signal_wait(&pipe->signal, FW_UPGRADE_PIPE_SIG_EXIT, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+    pipe->running = 0;
+
+    FW_UPGRADE_D_PRINTF("pipeline: %d buffers, flash waited %d, receive waited %d\r\n", pipe->head, pipe->flash_waits, pipe->rx_waits);
+}
+
+/*
+ * get next received buffer, len is 0 when the plugin has no more data
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Get(uint8_t **buf, uint32_t *len)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+    uint8_t  rx_done;
+    uint32_t idx;
+
+    while(1)
+    {
+        //read rx_done first, head is final once it is set
+        rx_done = pipe->rx_done;
+        FW_UPGRADE_MEMORY_BARRIER();
+
+        if( pipe->head != pipe->tail ) {
+            idx = pipe->tail % pipe->buf_num;
+            *buf = pipe->buf[idx];
+            *len = pipe->len[idx];
+            return QAPI_FW_UPGRADE_OK_E;
+        }
+
+        if( rx_done ) {
+            *len = 0;
+            return pipe->rx_rtn;
+        }
+
+        pipe->flash_waits++;
+        qurt_signal_wait(&pipe->signal, FW_UPGRADE_PIPE_SIG_DATA, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+    }
+}
+
+/*
+ * give buffer returned by fw_Upgrade_Pipe_Get back to receive thread
+ */
+static void fw_Upgrade_Pipe_Release(void)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+
+    FW_UPGRADE_MEMORY_BARRIER();
+    pipe->tail++;
+    qurt_signal_set(&pipe->signal, FW_UPGRADE_PIPE_SIG_SPACE);
+}
+
 /*
  * finalize fw upgrade session
  */
@@ -778,6 +1010,81 @@ static void fw_Upgrade_Set_State(qapi_Fw_Upgrade_State_t state)
     }
 }
 
+/*
+ * load digest cache of the active FWD, start an empty one if the file is missing or stale
+ */
+static void fw_Upgrade_Digest_Cache_Load(fw_Upgrade_Digest_Cache_t *cache, uint8_t fwd_idx)
+{
+    uint32_t rank = 0, version = 0, num_read = 0;
+    int fd = -1;
+
+    qapi_Fw_Upgrade_Get_FWD_Rank(fwd_idx, &rank);
+    qapi_Fw_Upgrade_Get_FWD_Version(fwd_idx, &version);
+
+    if( qapi_Fs_Open(FW_UPGRADE_DIGEST_CACHE_FILE, QAPI_FS_O_RDONLY, &fd) == QAPI_OK ) {
+        if( qapi_Fs_Read(fd, (uint8_t *)cache, sizeof(fw_Upgrade_Digest_Cache_t), &num_read) != QAPI_OK ) {
+            num_read = 0;
+        }
+        qapi_Fs_Close(fd);
+    }
+
+    if(     (num_read < offsetof(fw_Upgrade_Digest_Cache_t, entry))
+        ||  (cache->magic != FW_UPGRADE_DIGEST_CACHE_MAGIC)
+        ||  (cache->fwd_idx != fwd_idx)
+        ||  (cache->fwd_rank != rank)
+        ||  (cache->fwd_version != version)
+        ||  (cache->num_entries > FW_UPGRADE_MAX_IMAGES_NUM)
+        ||  (num_read != offsetof(fw_Upgrade_Digest_Cache_t, entry) + cache->num_entries * sizeof(fw_Upgrade_Digest_Entry_t)) ) {
+        memset(cache, 0, offsetof(fw_Upgrade_Digest_Cache_t, entry));
+        cache->magic = FW_UPGRADE_DIGEST_CACHE_MAGIC;
+        cache->fwd_idx = fwd_idx;
+        cache->fwd_rank = rank;
+        cache->fwd_version = version;
+        //drop the stale file even if nothing gets added
+        cache->dirty = (num_read != 0);
+    }
+}
+
+/*
+ * write digest cache back if entries were added
+ */
+static void fw_Upgrade_Digest_Cache_Save(fw_Upgrade_Digest_Cache_t *cache)
+{
+    uint32_t len, num_write = 0;
+    int fd = -1;
+
+    if( cache->dirty == 0 )
+        return;
+    cache->dirty = 0;
+
+    len = offsetof(fw_Upgrade_Digest_Cache_t, entry) + cache->num_entries * sizeof(fw_Upgrade_Digest_Entry_t);
+    if( qapi_Fs_Open(FW_UPGRADE_DIGEST_CACHE_FILE, QAPI_FS_O_CREAT | QAPI_FS_O_WRONLY | QAPI_FS_O_TRUNC, &fd) != QAPI_OK ) {
+        FW_UPGRADE_D_PRINTF("can't open digest cache\r\n");
+        return;
+    }
+    if( (qapi_Fs_Write(fd, (uint8_t *)cache, len, &num_write) != QAPI_OK) || (num_write != len) ) {
+        //a short file is rejected at next load
+        FW_UPGRADE_D_PRINTF("can't write digest cache\r\n");
+    }
+    qapi_Fs_Close(fd);
+}
+
+/*
+ * find cached digest of one partition
+ */
+static fw_Upgrade_Digest_Entry_t *fw_Upgrade_Digest_Cache_Find(fw_Upgrade_Digest_Cache_t *cache, uint32_t image_id, uint32_t start, uint32_t size)
+{
+    uint32_t i;
+
+    for( i = 0; i < cache->num_entries; i++ )
+    {
+        if( (cache->entry[i].image_id == image_id) && (cache->entry[i].start == start) && (cache->entry[i].size == size) ) {
+            return &cache->entry[i];
+        }
+    }
+    return NULL;
+}
+
 /*
  * process fw upgrade conifg file
  * 
@@ -788,6 +1095,7 @@ static void fw_Upgrade_Set_State(qapi_Fw_Upgrade_State_t state)
  *     save image entries to AON
  *     check if fields are valid at each image entry
  *     calc hash at current image and determine if the image need to be downloaded.
+ *     (the hash of the current image comes from the digest cache when it is still valid)
  *     image will only be downloaded if the hash of the new image is different from the hash of the current image.
  *
  * All-in-one Upgrade Flow:
@@ -814,6 +1122,9 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Config_File(uint8_t *buf
     uint32_t i, len, offset, block_size, disk_size, nbytes;
     uint8_t  hash[FW_UPGRADE_HASH_LEN], *hash_buf=NULL;
     uint8_t  active_fwd;
+    uint32_t disk_start;
+    fw_Upgrade_Digest_Cache_t *cache = NULL;
+    fw_Upgrade_Digest_Entry_t *cache_entry;
     fw_Upgrade_ImageSet_Hdr_Part1_t *imgset_hdr;
     fw_Upgrade_Context_t     *fw_upgrade_cxt;
     fw_Upgrade_Image_Hdr_t   *img_hdr;
@@ -1028,10 +1339,12 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Config_File(uint8_t *buf
     qapi_Fw_Upgrade_Get_Flash_Block_Size(&block_size);    
     active_fwd = qapi_Fw_Upgrade_Get_Active_FWD(NULL, NULL);    
     hash_buf = (uint8_t *) malloc(block_size);
-    if( hash_buf == NULL ) {
+    cache = (fw_Upgrade_Digest_Cache_t *) malloc(sizeof(fw_Upgrade_Digest_Cache_t));
+    if( (hash_buf == NULL) || (cache == NULL) ) {
         rtn = QAPI_FW_UPGRADE_ERR_INSUFFICIENT_MEMORY_E;
         goto parse_img_hdr_end;
     }    
+    fw_Upgrade_Digest_Cache_Load(cache, active_fwd);
 
     /* check images if need download */
     for(i = 0, img_hdr = fw_upgrade_image_hdr; i < fw_upgrade_cxt->total_images; i++, img_hdr++  )
@@ -1041,24 +1354,40 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Config_File(uint8_t *buf
             if( qapi_Fw_Upgrade_Find_Partition(active_fwd, img_hdr->image_id, &hdl) != QAPI_OK )
                 continue;
 
-            /* calc hash */
-            if (qapi_Crypto_Op_Reset(fw_upgrade_cxt->digest_ctx) != QAPI_OK ) {
+            qapi_Fw_Upgrade_Get_Partition_Size(hdl, &disk_size);
+            qapi_Fw_Upgrade_Get_Partition_Start(hdl, &disk_start);
+
+            cache_entry = fw_Upgrade_Digest_Cache_Find(cache, img_hdr->image_id, disk_start, disk_size);
+            if( cache_entry != NULL ) {
                 qapi_Fw_Upgrade_Close_Partition(hdl);
+                memcpy(hash, cache_entry->hash, FW_UPGRADE_HASH_LEN);
+            } else {
+                /* calc hash */
+                if (qapi_Crypto_Op_Reset(fw_upgrade_cxt->digest_ctx) != QAPI_OK ) {
+                    qapi_Fw_Upgrade_Close_Partition(hdl);
+                    
+                    rtn = QAPI_FW_UPGRADE_ERR_CRYPTO_FAIL_E;
+                    goto parse_img_hdr_end;     
+                }
                 
-                rtn = QAPI_FW_UPGRADE_ERR_CRYPTO_FAIL_E;
-                goto parse_img_hdr_end;     
+                for( offset = 0; offset < disk_size; offset += block_size )
+                {
+                    qapi_Fw_Upgrade_Read_Partition(hdl, offset, (char *)hash_buf, block_size, &nbytes);
+                    qapi_Crypto_Op_Digest_Update(fw_upgrade_cxt->digest_ctx, hash_buf, block_size);                
+                }
+                qapi_Fw_Upgrade_Close_Partition(hdl);
+                qapi_Crypto_Op_Digest_Final(fw_upgrade_cxt->digest_ctx, NULL, 0, (uint8_t *)hash, &len );
+
+                if( cache->num_entries < FW_UPGRADE_MAX_IMAGES_NUM ) {
+                    cache_entry = &cache->entry[cache->num_entries++];
+                    cache_entry->image_id = img_hdr->image_id;
+                    cache_entry->start = disk_start;
+                    cache_entry->size = disk_size;
+                    memcpy(cache_entry->hash, hash, FW_UPGRADE_HASH_LEN);
+                    cache->dirty = 1;
+                }
             }
             
-            qapi_Fw_Upgrade_Get_Partition_Size(hdl, &disk_size);
-            
-            for( offset = 0; offset < disk_size; offset += block_size )
-            {
-                qapi_Fw_Upgrade_Read_Partition(hdl, offset, (char *)hash_buf, block_size, &nbytes);
-                qapi_Crypto_Op_Digest_Update(fw_upgrade_cxt->digest_ctx, hash_buf, block_size);                
-            }
-            qapi_Fw_Upgrade_Close_Partition(hdl);
-            qapi_Crypto_Op_Digest_Final(fw_upgrade_cxt->digest_ctx, NULL, 0, (uint8_t *)hash, &len );
-            
             //compare firmware upgrade image Header HASH
             if( memcmp(img_hdr->hash, hash, FW_UPGRADE_HASH_LEN) == 0 ) {
                 fw_upgrade_cxt->download_flag[i] = 0;  
@@ -1066,8 +1395,12 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Config_File(uint8_t *buf
         }
     }
     
+    fw_Upgrade_Digest_Cache_Save(cache);
+
     if(hash_buf != NULL)
         free(hash_buf);
+    if(cache != NULL)
+        free(cache);
     
     //config file is fully received, move to next stage 
     fw_upgrade_cxt->is_first = 0;
@@ -1081,6 +1414,8 @@ parse_img_hdr_end:
     }
     if(hash_buf != NULL)
         free(hash_buf);
+    if(cache != NULL)
+        free(cache);
     return rtn;
 }
 
@@ -1104,7 +1439,7 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Verify_Image_Hash(fw_Upgrade_Ima
     hash_org = (uint8_t *) image_hdr + sizeof(fw_Upgrade_Image_Hdr_t) - FW_UPGRADE_HASH_LEN;
 
     if( fw_upgrade_cxt->format == FW_UPGRADE_FORAMT_PARTIAL_UPGRADE ) {
-        len = image_hdr->disk_size - image_hdr->image_length;
+        len = image_hdr->disk_size - fw_upgrade_cxt->image_wrt_count;
         hash_buf = (uint8_t *) malloc(len);
         if( hash_buf == NULL ) {
             return QAPI_FW_UPGRADE_ERR_INSUFFICIENT_MEMORY_E;    
@@ -1128,6 +1463,245 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Verify_Image_Hash(fw_Upgrade_Ima
     return rtn;
 }
 
+/*
+ * write image data to the trial partition, erasing blocks ahead of the write
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Write_Image_Data(uint8_t *data, uint32_t len, uint32_t block_size, uint32_t image_length)
+{
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    uint32_t first_block, last_block;
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL )
+      return QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+
+    if( len == 0 )
+        return QAPI_FW_UPGRADE_OK_E;
+
+    //update firmware upgrade image HASH
+    qapi_Crypto_Op_Digest_Update(fw_upgrade_cxt->digest_ctx, data, len);
+
+    //check flash block if need erase first
+    if(  (fw_upgrade_cxt->image_wrt_count / block_size) != ((fw_upgrade_cxt->image_wrt_count + len - 1) / block_size ) ) {
+        first_block = fw_upgrade_cxt->image_wrt_count / block_size+1;
+
+        last_block = (fw_upgrade_cxt->image_wrt_count + len) / block_size;
+        if(((fw_upgrade_cxt->image_wrt_count + len) % block_size) != 0 ) last_block++;
+        // erase blocks
+        if( qapi_Fw_Upgrade_Erase_Partition(fw_upgrade_cxt->partition_hdl, first_block*block_size, (last_block-first_block)*block_size) != QAPI_OK ) {
+            return QAPI_FW_UPGRADE_ERR_FLASH_ERASE_PARTITION_E;
+        }
+    }
+
+    //write flash
+    if( qapi_Fw_Upgrade_Write_Partition(fw_upgrade_cxt->partition_hdl, fw_upgrade_cxt->image_wrt_count, (char *)data, len) != QAPI_OK ) {
+        return QAPI_FW_UPGRADE_ERR_FLASH_WRITE_PARTITION_E;
+    }
+    fw_upgrade_cxt->image_wrt_count += len;
+
+    //check if need erase block for next round
+    if( ((fw_upgrade_cxt->image_wrt_count % block_size) == 0) && (fw_upgrade_cxt->image_wrt_count < image_length) ) {
+        // erase block
+        if( qapi_Fw_Upgrade_Erase_Partition(fw_upgrade_cxt->partition_hdl, fw_upgrade_cxt->image_wrt_count, block_size) != QAPI_OK ) {
+            return QAPI_FW_UPGRADE_ERR_FLASH_ERASE_PARTITION_E;
+        }
+    }
+
+    return QAPI_FW_UPGRADE_OK_E;
+}
+
+/*
+ * open the active image a delta applies to and check it is the one the delta was made against
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Delta_Open_Source(fw_Upgrade_Image_Hdr_t *img_hdr, qapi_Part_Hdl_t *src_hdl, uint8_t *work_buf, uint8_t check_hash)
+{
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    fw_Upgrade_Delta_Hdr_t *hdr;
+    uint8_t  hash[FW_UPGRADE_HASH_LEN];
+    uint32_t offset, len, nbytes, size;
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL )
+      return QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+
+    hdr = &fw_upgrade_cxt->delta.hdr;
+
+    if( qapi_Fw_Upgrade_Find_Partition(qapi_Fw_Upgrade_Get_Active_FWD(NULL, NULL), img_hdr->image_id, src_hdl) != QAPI_OK ) {
+        *src_hdl = NULL;
+        return QAPI_FW_UPGRADE_ERR_FLASH_IMAGE_NOT_FOUND_E;
+    }
+
+    qapi_Fw_Upgrade_Get_Partition_Size(*src_hdl, &size);
+    if( hdr->source_length > size ) {
+        return QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_LENGTH_E;
+    }
+
+    if( check_hash == 0 ) {
+        return QAPI_FW_UPGRADE_OK_E;
+    }
+
+    //no target data has been hashed yet, so the digest can be borrowed
+    if (qapi_Crypto_Op_Reset(fw_upgrade_cxt->digest_ctx) != QAPI_OK) {
+        return QAPI_FW_UPGRADE_ERR_CRYPTO_FAIL_E;
+    }
+
+    for( offset = 0; offset < hdr->source_length; offset += nbytes )
+    {
+        len = MIN(FW_UPGRADE_DELTA_BUF_SIZE, hdr->source_length - offset);
+        if( (qapi_Fw_Upgrade_Read_Partition(*src_hdl, offset, (char *)work_buf, len, &nbytes) != QAPI_OK) || (nbytes == 0) ) {
+            return QAPI_FW_UPGRADE_ERR_FLASH_READ_FAIL_E;
+        }
+        qapi_Crypto_Op_Digest_Update(fw_upgrade_cxt->digest_ctx, work_buf, nbytes);
+    }
+    qapi_Crypto_Op_Digest_Final(fw_upgrade_cxt->digest_ctx, NULL, 0, hash, &len);
+
+    if( memcmp(hdr->source_hash, hash, FW_UPGRADE_HASH_LEN) != 0 ) {
+        FW_UPGRADE_D_PRINTF("delta source does not match active image\r\n");
+        return QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_CHECKSUM_E;
+    }
+
+    if (qapi_Crypto_Op_Reset(fw_upgrade_cxt->digest_ctx) != QAPI_OK) {
+        return QAPI_FW_UPGRADE_ERR_CRYPTO_FAIL_E;
+    }
+
+    return QAPI_FW_UPGRADE_OK_E;
+}
+
+/*
+ * apply received delta data, the data may split the header and commands anywhere
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Delta_Data(fw_Upgrade_Image_Hdr_t *img_hdr, uint8_t *data, uint32_t len, uint32_t block_size)
+{
+    qapi_Fw_Upgrade_Status_Code_t rtn = QAPI_FW_UPGRADE_OK_E;
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    fw_Upgrade_Delta_State_t *delta;
+    fw_Upgrade_Delta_Cmd_t *cmd;
+    qapi_Part_Hdl_t src_hdl = NULL;
+    uint8_t  *work_buf;
+    uint32_t n, nbytes, target_length;
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL )
+      return QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+
+    delta = &fw_upgrade_cxt->delta;
+    cmd = &delta->cmd;
+
+    if((work_buf = malloc(FW_UPGRADE_DELTA_BUF_SIZE)) == NULL) {
+        return QAPI_FW_UPGRADE_ERR_INSUFFICIENT_MEMORY_E;
+    }
+
+    while( (rtn == QAPI_FW_UPGRADE_OK_E) && (len > 0) )
+    {
+        target_length = delta->hdr.target_length;
+
+        switch( delta->stage )
+        {
+            case FW_UPGRADE_DELTA_STAGE_HDR_E:
+                n = MIN(len, sizeof(fw_Upgrade_Delta_Hdr_t) - delta->fill);
+                memcpy((uint8_t *)&delta->hdr + delta->fill, data, n);
+                delta->fill += n;
+                data += n;
+                len -= n;
+                if( delta->fill < sizeof(fw_Upgrade_Delta_Hdr_t) )
+                    break;
+
+                if( (delta->hdr.magic != FW_UPGRADE_DELTA_MAGIC) || (delta->hdr.target_length > img_hdr->disk_size) ) {
+                    rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_HDR_E;
+                    break;
+                }
+                if( (rtn = fw_Upgrade_Delta_Open_Source(img_hdr, &src_hdl, work_buf, 1)) != QAPI_FW_UPGRADE_OK_E ) {
+                    break;
+                }
+                delta->fill = 0;
+                delta->stage = FW_UPGRADE_DELTA_STAGE_CMD_E;
+                break;
+
+            case FW_UPGRADE_DELTA_STAGE_CMD_E:
+                n = MIN(len, sizeof(fw_Upgrade_Delta_Cmd_t) - delta->fill);
+                memcpy((uint8_t *)cmd + delta->fill, data, n);
+                delta->fill += n;
+                data += n;
+                len -= n;
+                if( delta->fill < sizeof(fw_Upgrade_Delta_Cmd_t) )
+                    break;
+                delta->fill = 0;
+
+                if( cmd->op == FW_UPGRADE_DELTA_OP_END ) {
+                    if( fw_upgrade_cxt->image_wrt_count != target_length ) {
+                        rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_LENGTH_E;
+                        break;
+                    }
+                    delta->stage = FW_UPGRADE_DELTA_STAGE_DONE_E;
+                    break;
+                }
+
+                if( (cmd->op > FW_UPGRADE_DELTA_OP_FILL) || (cmd->length > target_length - fw_upgrade_cxt->image_wrt_count) ) {
+                    rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_HDR_E;
+                    break;
+                }
+                if( (cmd->op == FW_UPGRADE_DELTA_OP_COPY) &&
+                    ((cmd->offset > delta->hdr.source_length) || (cmd->length > delta->hdr.source_length - cmd->offset)) ) {
+                    rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_HDR_E;
+                    break;
+                }
+
+                //COPY and FILL carry no payload, apply them now
+                while( (cmd->op != FW_UPGRADE_DELTA_OP_INSERT) && (cmd->length > 0) )
+                {
+                    n = MIN(cmd->length, FW_UPGRADE_DELTA_BUF_SIZE);
+                    if( cmd->op == FW_UPGRADE_DELTA_OP_FILL ) {
+                        memset(work_buf, (uint8_t)cmd->offset, n);
+                    } else {
+                        //source is opened here again after a suspend
+                        if( (src_hdl == NULL) && ((rtn = fw_Upgrade_Delta_Open_Source(img_hdr, &src_hdl, work_buf, 0)) != QAPI_FW_UPGRADE_OK_E) ) {
+                            break;
+                        }
+                        if( (qapi_Fw_Upgrade_Read_Partition(src_hdl, cmd->offset, (char *)work_buf, n, &nbytes) != QAPI_OK) || (nbytes == 0) ) {
+                            rtn = QAPI_FW_UPGRADE_ERR_FLASH_READ_FAIL_E;
+                            break;
+                        }
+                        n = nbytes;
+                        cmd->offset += n;
+                    }
+                    if( (rtn = fw_Upgrade_Write_Image_Data(work_buf, n, block_size, target_length)) != QAPI_FW_UPGRADE_OK_E ) {
+                        break;
+                    }
+                    cmd->length -= n;
+                }
+
+                if( cmd->length > 0 ) {
+                    delta->stage = FW_UPGRADE_DELTA_STAGE_DATA_E;
+                }
+                break;
+
+            case FW_UPGRADE_DELTA_STAGE_DATA_E:
+                n = MIN(len, cmd->length);
+                if( (rtn = fw_Upgrade_Write_Image_Data(data, n, block_size, target_length)) != QAPI_FW_UPGRADE_OK_E ) {
+                    break;
+                }
+                cmd->length -= n;
+                data += n;
+                len -= n;
+                if( cmd->length == 0 ) {
+                    delta->stage = FW_UPGRADE_DELTA_STAGE_CMD_E;
+                }
+                break;
+
+            default:
+                //data after END
+                rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_LENGTH_E;
+                break;
+        }
+    }
+
+    if( src_hdl != NULL ) {
+        qapi_Fw_Upgrade_Close_Partition(src_hdl);
+    }
+    free(work_buf);
+    return rtn;
+}
+
 /*
  * process firmware upgrade image
  */
@@ -1163,7 +1737,15 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *b
         
         if(fw_upgrade_cxt->image_wrt_length == 0 )  {//image entry not init
             fw_upgrade_cxt->image_wrt_count = 0;
+            fw_upgrade_cxt->image_rcv_count = 0;
             fw_upgrade_cxt->image_wrt_length = img_hdr->image_length;
+            memset(&fw_upgrade_cxt->delta, 0, sizeof(fw_Upgrade_Delta_State_t));
+
+            //file system images are duplicated from the active FS, they can't be delta
+            if( (img_hdr->hash_type & FW_UPGRADE_IMAGE_FLAG_DELTA) && ((img_hdr->image_id == FS1_IMG_ID) || (img_hdr->image_id == FS2_IMG_ID)) ) {
+                rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_HDR_E;
+                break;
+            }
           
             //create one image entry
             if(img_hdr->image_id == FS1_IMG_ID) {
@@ -1239,47 +1821,39 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *b
         if( fw_upgrade_cxt->format == FW_UPGRADE_FORAMT_PARTIAL_UPGRADE ) {
             write_len = fw_upgrade_cxt->buf_len;
             fw_upgrade_cxt->buf_offset = 0;
-            if( write_len  > (fw_upgrade_cxt->image_wrt_length - fw_upgrade_cxt->image_wrt_count) ) {
+            if( write_len  > (fw_upgrade_cxt->image_wrt_length - fw_upgrade_cxt->image_rcv_count) ) {
                 rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_LENGTH_E;
                 break;
             }
         } else {
-            write_len = MIN(buf_len, (fw_upgrade_cxt->image_wrt_length - fw_upgrade_cxt->image_wrt_count));
+            write_len = MIN(buf_len, (fw_upgrade_cxt->image_wrt_length - fw_upgrade_cxt->image_rcv_count));
         }
 
-        //update firmware upgrade image HASH
-        qapi_Crypto_Op_Digest_Update(fw_upgrade_cxt->digest_ctx, (uint8_t *)&buffer[fw_upgrade_cxt->buf_offset], write_len);
-
-        //check flash block if need erase first
-        {
-            uint32_t first_block, last_block;
-        
-            if(  (fw_upgrade_cxt->image_wrt_count / block_size) != ((fw_upgrade_cxt->image_wrt_count + write_len - 1) / block_size ) ) {
-                first_block = fw_upgrade_cxt->image_wrt_count / block_size+1;
-                
-                last_block = (fw_upgrade_cxt->image_wrt_count + write_len) / block_size;
-                if(((fw_upgrade_cxt->image_wrt_count + write_len) % block_size) != 0 ) last_block++;
-                // erase blocks
-                if( qapi_Fw_Upgrade_Erase_Partition(fw_upgrade_cxt->partition_hdl, first_block*block_size, (last_block-first_block)*block_size) != QAPI_OK ) {
-                    rtn = QAPI_FW_UPGRADE_ERR_FLASH_ERASE_PARTITION_E;
-                    break;
-                }
-            }
+        //write flash, a delta image is rebuilt from the active image as it arrives
+        if( img_hdr->hash_type & FW_UPGRADE_IMAGE_FLAG_DELTA ) {
+            rtn = fw_Upgrade_Process_Delta_Data(img_hdr, &buffer[fw_upgrade_cxt->buf_offset], write_len, block_size);
+        } else {
+            rtn = fw_Upgrade_Write_Image_Data(&buffer[fw_upgrade_cxt->buf_offset], write_len, block_size, img_hdr->image_length);
         }
-        
-        //write flash
-        if( qapi_Fw_Upgrade_Write_Partition(fw_upgrade_cxt->partition_hdl, fw_upgrade_cxt->image_wrt_count, (char *)&buffer[fw_upgrade_cxt->buf_offset], write_len) != QAPI_OK ) {
-            rtn = QAPI_FW_UPGRADE_ERR_FLASH_WRITE_PARTITION_E;
+        if( rtn != QAPI_FW_UPGRADE_OK_E ) {
             break;
         }
         
         //update record
         fw_upgrade_cxt->buf_offset += write_len;
         fw_upgrade_cxt->file_read_count += write_len;
-        fw_upgrade_cxt->image_wrt_count += write_len;
+        fw_upgrade_cxt->image_rcv_count += write_len;
     
         //flash one image, move to next one 
-        if( fw_upgrade_cxt->image_wrt_count >= fw_upgrade_cxt->image_wrt_length ) {
+        if( fw_upgrade_cxt->image_rcv_count >= fw_upgrade_cxt->image_wrt_length ) {
+            if( img_hdr->hash_type & FW_UPGRADE_IMAGE_FLAG_DELTA ) {
+                if( fw_upgrade_cxt->delta.stage != FW_UPGRADE_DELTA_STAGE_DONE_E ) {
+                    rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_LENGTH_E;
+                    break;
+                }
+                FW_UPGRADE_D_PRINTF("delta image %x: %d bytes received, %d bytes written\r\n", img_hdr->image_id, fw_upgrade_cxt->image_rcv_count, fw_upgrade_cxt->image_wrt_count);
+            }
+
             //verify image HASH
             if( (rtn = fw_Upgrade_Verify_Image_Hash(img_hdr)) != QAPI_FW_UPGRADE_OK_E ) {
                 break;              
@@ -1311,15 +1885,6 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *b
             }
         }
         
-        //check if need erase block for next round
-        if(  ((fw_upgrade_cxt->image_wrt_count % block_size) == 0) && (fw_upgrade_cxt->image_wrt_length >0) ) {
-            // erase block
-            if( qapi_Fw_Upgrade_Erase_Partition(fw_upgrade_cxt->partition_hdl, fw_upgrade_cxt->image_wrt_count, block_size) != QAPI_OK ) {
-                rtn = QAPI_FW_UPGRADE_ERR_FLASH_ERASE_PARTITION_E;
-                break;
-            }
-        }
-
         if( fw_upgrade_cxt->format == FW_UPGRADE_FORAMT_PARTIAL_UPGRADE ) {
             /* it is done for this round */
             break;
@@ -7,6 +7,7 @@
 #ifndef _FW_UPGRADE_H
 #define _FW_UPGRADE_H
 #include <qapi/qapi_crypto.h>
+#include "qurt_signal.h"
 
 /**********************************************************************************************************/
 /* Firmware Upgrade definition                                                                            */      
@@ -23,6 +24,64 @@
 #define FW_UPGRADE_MAX_IMAGES_NUM           30
 #define FW_UPGRADE_FORAMT_PARTIAL_UPGRADE   1
 
+/*
+ * Delta images
+ *
+ * An image entry whose hash_type has FW_UPGRADE_IMAGE_FLAG_DELTA set carries a
+ * delta against the same image in the active FWD instead of the image itself.
+ * image_length is the length of the delta, hash is the hash of the
+ * reconstructed image (padded to disk_size for partial upgrade).
+ *
+ * Delta payload (little endian):
+ *     fw_Upgrade_Delta_Hdr_t
+ *     fw_Upgrade_Delta_Cmd_t, followed by length bytes for INSERT
+ *     ....
+ *     fw_Upgrade_Delta_Cmd_t with op END
+ *
+ * Commands only read the active image and the target is written front to
+ * back into the trial FWD, so the source is never modified while it is
+ * still referenced and RAM use is bounded by FW_UPGRADE_DELTA_BUF_SIZE.
+ * The source is read once to check source_hash before anything is erased, so
+ * a delta costs about two reads of the source image and one write of the
+ * target.
+ */
+#define FW_UPGRADE_IMAGE_FLAG_DELTA         0x80000000
+#define FW_UPGRADE_DELTA_MAGIC              0x544C4446      /* "FDLT" */
+#define FW_UPGRADE_DELTA_BUF_SIZE           512
+
+#define FW_UPGRADE_DELTA_OP_END             0   /* end of delta */
+#define FW_UPGRADE_DELTA_OP_COPY            1   /* copy length bytes from source at offset */
+#define FW_UPGRADE_DELTA_OP_INSERT          2   /* insert the length bytes that follow */
+#define FW_UPGRADE_DELTA_OP_FILL            3   /* repeat byte (low 8 bits of offset) length times */
+
+/*
+ * Digest cache
+ *
+ * Hashes of the active images are kept in a file so a partial upgrade check
+ * does not rescan every partition. The file belongs to one FWD index, rank and
+ * version, which change whenever the FWD is rewritten, and each entry is also
+ * tied to the partition start and size.
+ */
+#define FW_UPGRADE_DIGEST_CACHE_FILE        "/spinor/fw_upgrade_digest.bin"
+#define FW_UPGRADE_DIGEST_CACHE_MAGIC       0x48444746      /* "FGDH" */
+
+/*
+ * Download pipeline
+ *
+ * While image data is streamed, a receive thread pulls buffers from the plugin
+ * into a small ring and the session thread erases and programs them, so the
+ * link and the flash are busy at the same time. The number of buffers comes
+ * from FW_UPGRADE_SCHEME_PROP_PIPELINE_BUF_NUM_ID, less than 2 disables the
+ * pipeline and data is received and flashed in turn.
+ */
+#define FW_UPGRADE_PIPE_DEFAULT_BUF_NUM     3
+#define FW_UPGRADE_PIPE_MAX_BUF_NUM         4
+#define FW_UPGRADE_PIPE_THREAD_STACK_SIZE   2048
+
+#define FW_UPGRADE_PIPE_SIG_DATA            0x01    /* buffer filled or receive finished */
+#define FW_UPGRADE_PIPE_SIG_SPACE           0x02    /* buffer released or stop requested */
+#define FW_UPGRADE_PIPE_SIG_EXIT            0x04    /* receive thread exited */
+
 #define QAPI_FU_FWD_RANK_TRIAL		0xFFFFFFFF
 #define QAPI_FU_FWD_RANK_GOLDEN		0x00000000
 #define QAPI_FU_FWD_STATUS_VALID	0x01
@@ -70,6 +129,81 @@ typedef struct {
     uint8_t  hash[FW_UPGRADE_HASH_LEN];
 } __attribute__ ((packed)) fw_Upgrade_Image_Hdr_t;
 
+/*
+ * Delta image header
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t source_length;                     /* length of the active image the delta was made against */
+    uint32_t target_length;                     /* length of the reconstructed image */
+    uint8_t  source_hash[FW_UPGRADE_HASH_LEN];  /* hash of the first source_length bytes of the active image */
+} __attribute__ ((packed)) fw_Upgrade_Delta_Hdr_t;
+
+/*
+ * Delta image command
+ */
+typedef struct {
+    uint8_t  op;
+    uint32_t offset;
+    uint32_t length;
+} __attribute__ ((packed)) fw_Upgrade_Delta_Cmd_t;
+
+/*
+ * Delta decoder state, kept in the session context so it survives suspend
+ */
+typedef enum {
+    FW_UPGRADE_DELTA_STAGE_HDR_E = 0,
+    FW_UPGRADE_DELTA_STAGE_CMD_E,
+    FW_UPGRADE_DELTA_STAGE_DATA_E,
+    FW_UPGRADE_DELTA_STAGE_DONE_E,
+} fw_Upgrade_Delta_Stage_t;
+
+typedef struct {
+    fw_Upgrade_Delta_Stage_t stage;
+    uint32_t fill;                  /* bytes collected for the header or command being parsed */
+    fw_Upgrade_Delta_Hdr_t hdr;
+    fw_Upgrade_Delta_Cmd_t cmd;     /* current command, length counts down while it is applied */
+} fw_Upgrade_Delta_State_t;
+
+/*
+ * Digest cache file
+ */
+typedef struct {
+    uint32_t image_id;
+    uint32_t start;
+    uint32_t size;
+    uint8_t  hash[FW_UPGRADE_HASH_LEN];         /* hash of the whole partition */
+} __attribute__ ((packed)) fw_Upgrade_Digest_Entry_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t fwd_rank;
+    uint32_t fwd_version;
+    uint8_t  fwd_idx;
+    uint8_t  num_entries;
+    uint8_t  dirty;                             /* entries added since load, 0 in the file */
+    uint8_t  reserved;
+    fw_Upgrade_Digest_Entry_t entry[FW_UPGRADE_MAX_IMAGES_NUM];
+} __attribute__ ((packed)) fw_Upgrade_Digest_Cache_t;
+
+/*
+ * Download pipeline, only used while the session runs so it is not kept in AON
+ */
+typedef struct {
+    uint8_t  *buf[FW_UPGRADE_PIPE_MAX_BUF_NUM];
+    uint32_t len[FW_UPGRADE_PIPE_MAX_BUF_NUM];
+    uint32_t buf_num;                           /* 0: pipeline disabled */
+    volatile uint32_t head;                     /* next buffer to fill, written by receive thread only */
+    volatile uint32_t tail;                     /* next buffer to flash, written by session thread only */
+    volatile uint8_t  running;
+    volatile uint8_t  stop;
+    volatile uint8_t  rx_done;                  /* no more data, rx_rtn holds the reason */
+    volatile qapi_Fw_Upgrade_Status_Code_t rx_rtn;
+    uint32_t flash_waits;                       /* session thread found no data */
+    uint32_t rx_waits;                          /* receive thread found no free buffer */
+    qurt_signal_t signal;
+} fw_Upgrade_Pipe_t;
+
 /*
  * Data context for firmware upgrade session
  */
@@ -83,6 +217,7 @@ typedef struct {
     uint32_t image_index;       /* image index number */
     uint32_t image_wrt_count;   /* image flashed length */
     uint32_t image_wrt_length;  /* image total length */
+    uint32_t image_rcv_count;   /* image received length, differs from image_wrt_count for delta images */
     uint32_t total_images;      /* total number of images */
     uint32_t file_read_count;   /* received length from remote file */
     
@@ -106,6 +241,7 @@ typedef struct {
     qapi_Fw_Upgrade_CB_t     fw_upgrade_cb;
     qapi_Crypto_Op_Hdl_t     digest_ctx;        /* crypto ctx */
     uint8_t  *config_buf;    /* buffer to store config file before parse */
+    fw_Upgrade_Delta_State_t delta;   /* delta image decoder */
 } fw_Upgrade_Context_t;
 
 /*************************************************************************************************************/
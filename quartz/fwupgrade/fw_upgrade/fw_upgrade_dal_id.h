@@ -27,6 +27,7 @@ when         who     what, where, why
 #define FW_UPGRADE_SCHEME_PROP_FWD_SUPPORT_NUM_ID              0x26001
 #define FW_UPGRADE_SCHEME_PROP_BATTERY_CHECK_ID                0x26002
 #define FW_UPGRADE_SCHEME_PROP_BATTERY_REF_LEVEL_ID            0x26003
+#define FW_UPGRADE_SCHEME_PROP_PIPELINE_BUF_NUM_ID             0x26004
 
 #endif   
 